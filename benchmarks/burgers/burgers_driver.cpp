@@ -11,8 +11,13 @@
 // the public, perform publicly and display publicly, and to permit others to do so.
 //========================================================================================
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 // Local Includes
@@ -47,6 +52,99 @@ BurgersDriver::BurgersDriver(ParameterInput *pin, ApplicationInput *app_in, Mesh
   // warn if these fields aren't specified in the input file
   pin->CheckDesired("parthenon/mesh", "refinement");
   pin->CheckDesired("parthenon/mesh", "numlevel");
+
+  // Optional machine readable summary of the run for scaling studies, written as CSV if
+  // the file name ends in ".csv" and as JSON otherwise
+  scaling_report_ = pin->GetOrAddString("burgers", "scaling_report", "");
+  perf_cycle_offset_ = pin->GetOrAddInteger("parthenon/time", "perf_cycle_offset", 0);
+  for (auto &t : phase_ns_)
+    t = 0;
+}
+
+template <class F>
+auto BurgersDriver::Timed(Phase phase, F f) {
+  return [this, phase, f](auto &&...args) {
+    Kokkos::Timer timer;
+    auto status = f(std::forward<decltype(args)>(args)...);
+    // Kernels are asynchronous on devices, so only a fence makes the split between
+    // computation and communication meaningful. This is only done for scaling reports.
+    if (phase == Phase::compute && !scaling_report_.empty()) Kokkos::fence();
+    phase_ns_[phase] += static_cast<std::int64_t>(timer.seconds() * 1e9);
+    return status;
+  };
+}
+
+TaskListStatus BurgersDriver::Step() {
+  // Match the start of the measurement of the EvolutionDriver
+  if (tm.ncycle == perf_cycle_offset_) {
+    for (auto &t : phase_ns_)
+      t = 0;
+  }
+  return MultiStageDriver::Step();
+}
+
+void BurgersDriver::PostExecute(DriverStatus status) {
+  if (!scaling_report_.empty()) WriteScalingReport();
+  MultiStageDriver::PostExecute(status);
+}
+
+void BurgersDriver::WriteScalingReport() {
+  // Phase times are the maximum over ranks, the task times are summed over all task
+  // executions of a rank (and can exceed the wall time with several threads)
+  std::array<double, 4> phases{phase_ns_[Phase::compute] * 1e-9,
+                               phase_ns_[Phase::comm] * 1e-9, time_remesh_total_,
+                               time_outputs_total_};
+#ifdef MPI_PARALLEL
+  PARTHENON_MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, phases.data(), phases.size(),
+                                    MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD));
+#endif
+  if (parthenon::Globals::my_rank != 0) return;
+
+  const double walltime = timer_main.seconds();
+  const double zone_cycles =
+      static_cast<double>(pmesh->mbcnt) * pmesh->GetNumberOfMeshBlockCells();
+  const auto &mesh = pmesh->mesh_size;
+  const auto &block = pmesh->GetDefaultBlockSize();
+  const std::vector<std::pair<std::string, double>> entries{
+      {"nranks", parthenon::Globals::nranks},
+      {"concurrency", parthenon::DevExecSpace().concurrency()},
+      {"mesh_nx1", mesh.nx(parthenon::X1DIR)},
+      {"mesh_nx2", mesh.nx(parthenon::X2DIR)},
+      {"mesh_nx3", mesh.nx(parthenon::X3DIR)},
+      {"meshblock_nx1", block.nx(parthenon::X1DIR)},
+      {"meshblock_nx2", block.nx(parthenon::X2DIR)},
+      {"meshblock_nx3", block.nx(parthenon::X3DIR)},
+      {"pack_size", pinput->GetInteger("parthenon/mesh", "pack_size")},
+      {"nblocks", pmesh->nbtotal},
+      {"ncycles", std::max(tm.ncycle - perf_cycle_offset_, 0)},
+      {"walltime", walltime},
+      {"zone_cycles_per_wallsecond", walltime > 0.0 ? zone_cycles / walltime : 0.0},
+      {"time_compute", phases[0]},
+      {"time_comm", phases[1]},
+      {"time_remesh", phases[2]},
+      {"time_output", phases[3]}};
+
+  std::ofstream os(scaling_report_);
+  PARTHENON_REQUIRE_THROWS(os.is_open(), "Could not open " + scaling_report_);
+  os.precision(10);
+  const std::string ext = ".csv";
+  const bool csv = scaling_report_.size() >= ext.size() &&
+                   scaling_report_.compare(scaling_report_.size() - ext.size(),
+                                           ext.size(), ext) == 0;
+  if (csv) {
+    for (int n = 0; n < entries.size(); ++n)
+      os << (n > 0 ? "," : "") << entries[n].first;
+    os << "\n";
+    for (int n = 0; n < entries.size(); ++n)
+      os << (n > 0 ? "," : "") << entries[n].second;
+    os << "\n";
+  } else {
+    os << "{\n";
+    for (int n = 0; n < entries.size(); ++n)
+      os << "  \"" << entries[n].first << "\": " << entries[n].second
+         << (n + 1 < entries.size() ? ",\n" : "\n");
+    os << "}\n";
+  }
 }
 
 // See the burgers.hpp declaration for a description of how this function gets called.
@@ -85,44 +183,56 @@ TaskCollection BurgersDriver::MakeTaskCollection(BlockList_t &blocks, const int
 
     const auto any = parthenon::BoundaryType::any;
 
-    auto start_bnd = tl.AddTask(none, parthenon::StartReceiveBoundBufs<any>, mc1);
-    auto start_flx_recv = tl.AddTask(none, parthenon::StartReceiveFluxCorrections, mc0);
+    auto start_bnd =
+        tl.AddTask(none, Timed(comm, parthenon::StartReceiveBoundBufs<any>), mc1);
+    auto start_flx_recv =
+        tl.AddTask(none, Timed(comm, parthenon::StartReceiveFluxCorrections), mc0);
 
     // this is the main task where most of the real work is done
-    auto flx = tl.AddTask(none, burgers_package::CalculateFluxes, mc0.get());
+    auto flx =
+        tl.AddTask(none, Timed(compute, burgers_package::CalculateFluxes), mc0.get());
 
-    auto send_flx = tl.AddTask(flx, parthenon::LoadAndSendFluxCorrections, mc0);
-    auto recv_flx = tl.AddTask(start_flx_recv, parthenon::ReceiveFluxCorrections, mc0);
-    auto set_flx = tl.AddTask(recv_flx, parthenon::SetFluxCorrections, mc0);
+    auto send_flx =
+        tl.AddTask(flx, Timed(comm, parthenon::LoadAndSendFluxCorrections), mc0);
+    auto recv_flx =
+        tl.AddTask(start_flx_recv, Timed(comm, parthenon::ReceiveFluxCorrections), mc0);
+    auto set_flx = tl.AddTask(recv_flx, Timed(comm, parthenon::SetFluxCorrections), mc0);
 
     // compute the divergence of fluxes of conserved variables
-    auto flux_div =
-        tl.AddTask(set_flx, FluxDivergence<MeshData<Real>>, mc0.get(), mdudt.get());
+    auto flux_div = tl.AddTask(set_flx, Timed(compute, FluxDivergence<MeshData<Real>>),
+                               mc0.get(), mdudt.get());
 
-    auto avg_data = tl.AddTask(flux_div, AverageIndependentData<MeshData<Real>>,
-                               mc0.get(), mbase.get(), beta);
+    auto avg_data =
+        tl.AddTask(flux_div, Timed(compute, AverageIndependentData<MeshData<Real>>),
+                   mc0.get(), mbase.get(), beta);
     // apply du/dt to all independent fields in the container
-    auto update = tl.AddTask(avg_data, UpdateIndependentData<MeshData<Real>>, mc0.get(),
-                             mdudt.get(), beta * dt, mc1.get());
+    auto update =
+        tl.AddTask(avg_data, Timed(compute, UpdateIndependentData<MeshData<Real>>),
+                   mc0.get(), mdudt.get(), beta * dt, mc1.get());
 
     // do boundary exchange
     const auto local = parthenon::BoundaryType::local;
     const auto nonlocal = parthenon::BoundaryType::nonlocal;
-    auto send = tl.AddTask(update, parthenon::SendBoundBufs<nonlocal>, mc1);
+    auto send = tl.AddTask(update, Timed(comm, parthenon::SendBoundBufs<nonlocal>), mc1);
 
-    auto send_local = tl.AddTask(update, parthenon::SendBoundBufs<local>, mc1);
-    auto recv_local = tl.AddTask(update, parthenon::ReceiveBoundBufs<local>, mc1);
-    auto set_local = tl.AddTask(recv_local, parthenon::SetBounds<local>, mc1);
+    auto send_local =
+        tl.AddTask(update, Timed(comm, parthenon::SendBoundBufs<local>), mc1);
+    auto recv_local =
+        tl.AddTask(update, Timed(comm, parthenon::ReceiveBoundBufs<local>), mc1);
+    auto set_local =
+        tl.AddTask(recv_local, Timed(comm, parthenon::SetBounds<local>), mc1);
 
-    auto recv =
-        tl.AddTask(start_bnd | update, parthenon::ReceiveBoundBufs<nonlocal>, mc1);
-    auto set = tl.AddTask(recv, parthenon::SetBounds<nonlocal>, mc1);
+    auto recv = tl.AddTask(start_bnd | update,
+                           Timed(comm, parthenon::ReceiveBoundBufs<nonlocal>), mc1);
+    auto set = tl.AddTask(recv, Timed(comm, parthenon::SetBounds<nonlocal>), mc1);
 
-    auto fill_deriv = tl.AddTask(update, FillDerived<MeshData<Real>>, mc1.get());
+    auto fill_deriv =
+        tl.AddTask(update, Timed(compute, FillDerived<MeshData<Real>>), mc1.get());
 
     // estimate next time step
     if (stage == integrator->nstages) {
-      auto new_dt = tl.AddTask(update, EstimateTimestep<MeshData<Real>>, mc1.get());
+      auto new_dt = tl.AddTask(
+          update, Timed(compute, EstimateTimestep<MeshData<Real>>), mc1.get());
     }
   }
 
@@ -134,7 +244,8 @@ TaskCollection BurgersDriver::MakeTaskCollection(BlockList_t &blocks, const int
     auto &sc1 = pmb->meshblock_data.Get(stage_name[stage]);
 
     // set physical boundaries
-    auto set_bc = tl.AddTask(none, parthenon::ApplyBoundaryConditions, sc1);
+    auto set_bc =
+        tl.AddTask(none, Timed(compute, parthenon::ApplyBoundaryConditions), sc1);
 
     if (stage == integrator->nstages) {
       // Update refinement
@@ -14,7 +14,11 @@
 #ifndef BENCHMARKS_BURGERS_BURGERS_DRIVER_HPP_
 #define BENCHMARKS_BURGERS_BURGERS_DRIVER_HPP_
 
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include <parthenon/driver.hpp>
@@ -34,6 +38,24 @@ class BurgersDriver : public MultiStageDriver {
   //       DriverUtils::ConstructAndExecuteTaskLists (driver.hpp)
   //         BurgersDriver::MakeTaskCollection (advection_driver.cpp)
   TaskCollection MakeTaskCollection(BlockList_t &blocks, int stage);
+  TaskListStatus Step() override;
+
+ protected:
+  // Writes the scaling report (if requested) before the usual final diagnostics
+  void PostExecute(DriverStatus status) override;
+
+ private:
+  // Phases of the per task timings of the scaling report. Remeshing and outputs are
+  // timed by the EvolutionDriver.
+  enum Phase { compute = 0, comm = 1, nphases = 2 };
+  // Wraps a task function so that its execution time is added to phase
+  template <class F>
+  auto Timed(Phase phase, F f);
+  void WriteScalingReport();
+
+  std::string scaling_report_;
+  int perf_cycle_offset_;
+  std::array<std::atomic<std::int64_t>, nphases> phase_ns_;
 };
 
 void ProblemGenerator(MeshBlock *pmb, parthenon::ParameterInput *pin);
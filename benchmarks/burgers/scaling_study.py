@@ -0,0 +1,120 @@
+#!/usr/bin/env python
+# ========================================================================================
+# (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+#
+# This program was produced under U.S. Government contract 89233218CNA000001 for Los
+# Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+# for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+# in the program are reserved by Triad National Security, LLC, and the U.S. Department
+# of Energy/National Nuclear Security Administration. The Government is granted for
+# itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+# license in this material to reproduce, prepare derivative works, distribute copies to
+# the public, perform publicly and display publicly, and to permit others to do so.
+# ========================================================================================
+
+"""
+Run a weak or strong scaling study of Parthenon-VIBE and tabulate the results.
+
+    scaling_study.py run sweep.json      runs all cases of the sweep spec
+    scaling_study.py table sweep.json    prints the scaling table of the finished runs
+
+The sweep spec is a JSON file like
+
+    {
+      "mode": "weak",
+      "launcher": "mpirun -n {nranks}",
+      "executable": "./burgers-benchmark",
+      "input": "burgers.pin",
+      "output_dir": "scaling",
+      "parameters": {"parthenon/time/nlim": 50},
+      "runs": [
+        {"nranks": 1, "parameters": {"parthenon/mesh/nx1": 64}},
+        {"nranks": 8, "parameters": {"parthenon/mesh/nx1": 128}}
+      ]
+    }
+
+where "parameters" are input parameter overrides (common and per run), and every run may
+also override "launcher". Each run writes its report (see <burgers>/scaling_report) to
+output_dir/run<N>.json. The table lists the throughput, parallel efficiency relative to
+the first run, and the maximum over ranks of the time in each phase.
+"""
+
+import argparse
+import json
+import os
+import shlex
+import subprocess
+import sys
+
+PHASES = ["time_compute", "time_comm", "time_remesh", "time_output"]
+
+
+def report_path(spec, n):
+    return os.path.join(spec.get("output_dir", "."), "run{}.json".format(n))
+
+
+def run(spec):
+    os.makedirs(spec.get("output_dir", "."), exist_ok=True)
+    for n, r in enumerate(spec["runs"]):
+        params = dict(spec.get("parameters", {}))
+        params.update(r.get("parameters", {}))
+        params["burgers/scaling_report"] = report_path(spec, n)
+        launcher = r.get("launcher", spec.get("launcher", "")).format(**r)
+        cmd = shlex.split(launcher) + [spec["executable"], "-i", spec["input"]]
+        cmd += ["{}={}".format(k, v) for k, v in params.items()]
+        print(" ".join(cmd), flush=True)
+        with open(report_path(spec, n) + ".log", "w") as log:
+            status = subprocess.call(cmd, stdout=log, stderr=subprocess.STDOUT)
+        if status != 0:
+            print("run {} failed with status {}".format(n, status), file=sys.stderr)
+
+
+def table(spec, out=sys.stdout):
+    reports = []
+    for n in range(len(spec["runs"])):
+        path = report_path(spec, n)
+        if os.path.exists(path):
+            with open(path) as f:
+                reports.append(json.load(f))
+    if len(reports) == 0:
+        print("no finished runs", file=out)
+        return
+
+    # With zone-cycles per wallsecond as the metric, the parallel efficiency is the
+    # throughput per rank relative to the first run for both weak and strong scaling.
+    # The mode determines which workload is expected to stay fixed.
+    weak = spec.get("mode", "weak") == "weak"
+    ref = reports[0]
+    header = ["nranks", "nblocks", "walltime", "zc/ws", "speedup", "efficiency"]
+    print(" ".join("{:>14}".format(h) for h in header + PHASES), file=out)
+    for r in reports:
+        speedup = r["zone_cycles_per_wallsecond"] / ref["zone_cycles_per_wallsecond"]
+        eff = speedup * ref["nranks"] / r["nranks"]
+        row = [r["nranks"], r["nblocks"], r["walltime"]]
+        row += [r["zone_cycles_per_wallsecond"], speedup, eff] + [r[p] for p in PHASES]
+        print(" ".join("{:>14.4g}".format(v) for v in row), file=out)
+
+        work, ref_work = r["nblocks"], ref["nblocks"]
+        if weak:
+            work, ref_work = work / r["nranks"], ref_work / ref["nranks"]
+        if work != ref_work:
+            print(
+                "  warning: {} blocks{} differ from the first run".format(
+                    work, " per rank" if weak else ""
+                ),
+                file=out,
+            )
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter
+    )
+    parser.add_argument("command", choices=["run", "table"])
+    parser.add_argument("spec", help="JSON sweep spec")
+    args = parser.parse_args()
+    with open(args.spec) as f:
+        spec = json.load(f)
+    if args.command == "run":
+        run(spec)
+    table(spec)
@@ -0,0 +1,258 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include "io_benchmark.hpp"
+
+#include <sys/stat.h>
+
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "outputs/async_writer.hpp"
+#include "outputs/outputs.hpp"
+#include "outputs/raw_block_data.hpp"
+#include "outputs/restart_hdf5.hpp"
+#include "utils/instrument.hpp"
+
+namespace io_benchmark {
+using namespace parthenon;
+
+Packages_t ProcessPackages(std::unique_ptr<ParameterInput> &pin) {
+  auto pkg = std::make_shared<StateDescriptor>("io_benchmark");
+  const int nvars = pin->GetOrAddInteger("io_benchmark", "nvars", 4);
+  const int ncomp = pin->GetOrAddInteger("io_benchmark", "ncomp", 1);
+  const int nparticles = pin->GetOrAddInteger("io_benchmark", "nparticles", 0);
+  const int nswarm_vars = pin->GetOrAddInteger("io_benchmark", "nswarm_vars", 2);
+  PARTHENON_REQUIRE_THROWS(nvars > 0 && ncomp > 0,
+                           "nvars and ncomp of io_benchmark must be positive");
+  pkg->AddParam<>("nparticles", nparticles);
+  pkg->AddParam<>("nswarm_vars", nswarm_vars);
+
+  Metadata m({Metadata::Cell, Metadata::Independent, Metadata::Restart,
+              Metadata::FillGhost},
+             std::vector<int>{ncomp});
+  for (int n = 0; n < nvars; ++n)
+    pkg->AddField(FieldName(n), m);
+
+  if (nparticles > 0) {
+    pkg->AddSwarm(swarm_name, Metadata({Metadata::Provides, Metadata::None}));
+    for (int n = 0; n < nswarm_vars; ++n)
+      pkg->AddSwarmValue("value_" + std::to_string(n), swarm_name,
+                         Metadata({Metadata::Real}));
+  }
+
+  Packages_t packages;
+  packages.Add(pkg);
+  return packages;
+}
+
+// Smooth fields, including the ghost zones, so that compression sees realistic data,
+// and particles at random positions of the blocks
+void ProblemGenerator(MeshBlock *pmb, ParameterInput *pin) {
+  auto &data = pmb->meshblock_data.Get();
+  auto pkg = pmb->packages.Get("io_benchmark");
+  const IndexRange ib = pmb->cellbounds.GetBoundsI(IndexDomain::entire);
+  const IndexRange jb = pmb->cellbounds.GetBoundsJ(IndexDomain::entire);
+  const IndexRange kb = pmb->cellbounds.GetBoundsK(IndexDomain::entire);
+  auto coords = pmb->coords;
+  auto q = data->PackVariables(std::vector<MetadataFlag>{Metadata::Independent});
+  const int nvars = q.GetDim(4);
+  pmb->par_for(
+      PARTHENON_AUTO_LABEL, 0, nvars - 1, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+      KOKKOS_LAMBDA(const int n, const int k, const int j, const int i) {
+        const Real x = coords.Xc<1>(i);
+        const Real y = coords.Xc<2>(j);
+        const Real z = coords.Xc<3>(k);
+        q(n, k, j, i) = 1.0 + 0.5 * std::sin(2.0 * M_PI * (x + 0.1 * n)) *
+                                  std::cos(2.0 * M_PI * y) * std::cos(2.0 * M_PI * z);
+      });
+
+  const int nparticles = pkg->Param<int>("nparticles");
+  if (nparticles == 0) return;
+  auto swarm = data->GetSwarmData()->Get(swarm_name);
+  auto new_particles = swarm->AddEmptyParticles(nparticles);
+  const IndexRange ibi = pmb->cellbounds.GetBoundsI(IndexDomain::interior);
+  const IndexRange jbi = pmb->cellbounds.GetBoundsJ(IndexDomain::interior);
+  const IndexRange kbi = pmb->cellbounds.GetBoundsK(IndexDomain::interior);
+  const Real xmin = coords.Xf<1>(ibi.s), xmax = coords.Xf<1>(ibi.e + 1);
+  const Real ymin = coords.Xf<2>(jbi.s), ymax = coords.Xf<2>(jbi.e + 1);
+  const Real zmin = coords.Xf<3>(kbi.s), zmax = coords.Xf<3>(kbi.e + 1);
+  auto &x = swarm->Get<Real>(swarm_position::x::name()).Get();
+  auto &y = swarm->Get<Real>(swarm_position::y::name()).Get();
+  auto &z = swarm->Get<Real>(swarm_position::z::name()).Get();
+  const RandomStreams rng(pmb->gid);
+  const int gid = pmb->gid;
+  pmb->par_for(
+      PARTHENON_AUTO_LABEL, 0, new_particles.GetNewParticlesMaxIndex(),
+      KOKKOS_LAMBDA(const int new_n) {
+        const int n = new_particles.GetNewParticleIndex(new_n);
+        auto gen = rng.Get(gid, new_n, 0);
+        x(n) = gen.drand(xmin, xmax);
+        y(n) = gen.drand(ymin, ymax);
+        z(n) = gen.drand(zmin, zmax);
+      });
+  for (int v = 0; v < pkg->Param<int>("nswarm_vars"); ++v) {
+    auto &value = swarm->Get<Real>("value_" + std::to_string(v)).Get();
+    pmb->par_for(
+        PARTHENON_AUTO_LABEL, 0, new_particles.GetNewParticlesMaxIndex(),
+        KOKKOS_LAMBDA(const int new_n) {
+          const int n = new_particles.GetNewParticleIndex(new_n);
+          value(n) = rng.Get(gid, new_n, v + 1).drand();
+        });
+  }
+}
+
+namespace {
+// Wall time of f(), which is the same on all ranks since they are synchronized before
+// and after
+template <class F>
+double TimeCollective(F &&f) {
+  Kokkos::fence();
+#ifdef MPI_PARALLEL
+  PARTHENON_MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+#endif
+  Kokkos::Timer timer;
+  f();
+  Kokkos::fence();
+#ifdef MPI_PARALLEL
+  PARTHENON_MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+#endif
+  return timer.seconds();
+}
+
+// Name of the next file of a time based output, as in PHDF5Output
+std::string NextFilename(const OutputParameters &op, const bool restart) {
+  std::stringstream filename;
+  filename << op.file_basename << "." << op.file_id << "."
+           << std::setw(op.file_number_width) << std::setfill('0') << op.file_number
+           << (restart ? ".rhdf" : ".phdf");
+  return filename.str();
+}
+
+double FileSize(const std::string &filename) {
+  struct stat st;
+  return stat(filename.c_str(), &st) == 0 ? static_cast<double>(st.st_size) : 0.0;
+}
+
+std::string Describe(const OutputParameters &op) {
+  std::string description = op.file_type;
+  description += op.half_precision_output     ? " half"
+                 : op.single_precision_output ? " single"
+                                              : " double";
+  if (op.include_ghost_zones) description += " ghosts";
+  if (op.hdf5_compression_level > 0 && op.hdf5_compressor != "none")
+    description += " " + op.hdf5_compressor + "(" +
+                   std::to_string(op.hdf5_compression_level) + ")";
+  if (!op.swarms.empty()) description += " swarms";
+  if (op.raw_block_data) description += " raw";
+  return description;
+}
+
+struct Result {
+  std::string block, description;
+  double bytes = 0.0;                 // size of the HDF5 file
+  double write = 0.0, xdmf = 0.0;     // mean seconds per output
+  double read = 0.0;                  // mean seconds per restart
+};
+} // namespace
+
+void RunBenchmark(ParthenonManager &pman) {
+  Mesh *pmesh = pman.pmesh.get();
+  ParameterInput *pin = pman.pinput.get();
+  const int nrepeat = pin->GetOrAddInteger("io_benchmark", "nrepeat", 3);
+  const bool keep_files = pin->GetOrAddBoolean("io_benchmark", "keep_files", false);
+  PARTHENON_REQUIRE_THROWS(nrepeat > 0, "nrepeat of io_benchmark must be positive");
+
+  SimTime tm(0.0, 1.0, -1, 0, 1, 0, 1.0);
+  Outputs outputs(pmesh, pin, &tm);
+  // genXDMF is timed by the TimerRegistry
+  const bool timers = TimerRegistry::Enabled();
+  TimerRegistry::Enable(true);
+
+  std::vector<Result> results;
+  std::vector<std::string> written, raw;
+  for (auto *output = outputs.GetFirstOutputType(); output != nullptr;
+       output = output->pnext_type) {
+    const auto &op = output->output_params;
+    const bool restart = op.file_type == "rst";
+    if (!restart && op.file_type != "hdf5") continue;
+    Result result;
+    result.block = op.block_name;
+    result.description = Describe(op);
+
+    std::string filename;
+    for (int r = 0; r < nrepeat; ++r) {
+      filename = NextFilename(op, restart);
+      written.push_back(filename);
+      if (op.raw_block_data)
+        raw.push_back(RawBlockData::Filename(filename, Globals::my_rank));
+      const double xdmf = TimerRegistry::Seconds("genXDMF");
+      // Asynchronous writes are timed until they are done
+      result.write += TimeCollective([&]() {
+        output->WriteOutputFile(pmesh, pin, &tm, SignalHandler::OutputSignal::none);
+        AsyncWriter::Instance().Wait();
+      });
+      result.xdmf += TimerRegistry::Seconds("genXDMF") - xdmf;
+    }
+    result.write /= nrepeat;
+    result.xdmf /= nrepeat;
+    result.bytes = FileSize(filename);
+
+    if (restart) {
+      for (int r = 0; r < nrepeat; ++r) {
+        RestartReaderHDF5 reader(filename.c_str());
+        result.read += TimeCollective([&]() { pman.RestartPackages(*pmesh, reader); });
+      }
+      result.read /= nrepeat;
+    }
+    results.push_back(result);
+  }
+  TimerRegistry::Enable(timers);
+
+  if (!keep_files) {
+    for (const auto &filename : raw)
+      std::remove(filename.c_str());
+  }
+#ifdef MPI_PARALLEL
+  PARTHENON_MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+#endif
+  if (Globals::my_rank != 0) return;
+  if (!keep_files) {
+    for (const auto &filename : written) {
+      for (const auto &suffix : {"", ".xdmf", ".swarm.xdmf"})
+        std::remove((filename + suffix).c_str());
+    }
+  }
+
+  printf("I/O benchmark\n");
+  printf("  ranks: %i, blocks: %i, cells: %lld, outputs written %i times\n",
+         Globals::nranks, pmesh->nbtotal, static_cast<long long>(pmesh->GetTotalCells()),
+         nrepeat);
+  printf("  %-20s  %-32s  %10s  %10s  %10s  %10s  %10s  %10s\n", "block", "output",
+         "size [MB]", "write [s]", "[GB/s]", "xdmf [s]", "read [s]", "[GB/s]");
+  for (const auto &r : results) {
+    printf("  %-20s  %-32s  %10.3f  %10.3e  %10.3f  %10.3e", r.block.c_str(),
+           r.description.c_str(), 1.0e-6 * r.bytes, r.write, 1.0e-9 * r.bytes / r.write,
+           r.xdmf);
+    if (r.read > 0.0) {
+      printf("  %10.3e  %10.3f\n", r.read, 1.0e-9 * r.bytes / r.read);
+    } else {
+      printf("  %10s  %10s\n", "-", "-");
+    }
+  }
+}
+
+} // namespace io_benchmark
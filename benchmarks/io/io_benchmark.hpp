@@ -0,0 +1,38 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef BENCHMARKS_IO_IO_BENCHMARK_HPP_
+#define BENCHMARKS_IO_IO_BENCHMARK_HPP_
+
+#include <memory>
+#include <string>
+
+#include <parthenon/package.hpp>
+#include <parthenon_manager.hpp>
+
+namespace io_benchmark {
+using namespace parthenon::package::prelude;
+
+inline const std::string swarm_name = "particles";
+inline std::string FieldName(const int n) { return "field_" + std::to_string(n); }
+
+// The synthetic fields and swarm with the sizes given in <io_benchmark>
+parthenon::Packages_t ProcessPackages(std::unique_ptr<parthenon::ParameterInput> &pin);
+void ProblemGenerator(parthenon::MeshBlock *pmb, parthenon::ParameterInput *pin);
+
+// Writes every hdf5 and rst output of the input nrepeat times, reads the last restart
+// file back as many times, and reports the times and bandwidths on rank 0
+void RunBenchmark(parthenon::ParthenonManager &pman);
+
+} // namespace io_benchmark
+
+#endif // BENCHMARKS_IO_IO_BENCHMARK_HPP_
@@ -0,0 +1,239 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include "remesh_benchmark.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "amr_criteria/refinement_package.hpp"
+#include "utils/instrument.hpp"
+#include "utils/random.hpp"
+
+namespace remesh_benchmark {
+using namespace parthenon;
+
+Packages_t ProcessPackages(std::unique_ptr<ParameterInput> &pin) {
+  auto pkg = std::make_shared<StateDescriptor>("remesh_benchmark");
+  const int nvars = pin->GetOrAddInteger("remesh_benchmark", "nvars", 4);
+  const int ncomp = pin->GetOrAddInteger("remesh_benchmark", "ncomp", 1);
+  PARTHENON_REQUIRE_THROWS(nvars > 0 && ncomp > 0,
+                           "nvars and ncomp of remesh_benchmark must be positive");
+
+  const auto pattern = pin->GetOrAddString("remesh_benchmark", "pattern", "sphere");
+  PARTHENON_REQUIRE_THROWS(pattern == "sphere" || pattern == "random",
+                           "Unknown pattern " + pattern + " of remesh_benchmark");
+  pkg->AddParam<>("pattern", pattern);
+  // A spherical shell moving on a circle around the center of the domain, with the
+  // radius and the radius of the orbit in units of the domain size
+  pkg->AddParam<>("radius", pin->GetOrAddReal("remesh_benchmark", "radius", 0.2));
+  pkg->AddParam<>("orbit_radius",
+                  pin->GetOrAddReal("remesh_benchmark", "orbit_radius", 0.2));
+  pkg->AddParam<>("orbit_steps",
+                  pin->GetOrAddInteger("remesh_benchmark", "orbit_steps", 64));
+  // Or blocks randomly tagged for refinement and derefinement every step
+  pkg->AddParam<>("refine_fraction",
+                  pin->GetOrAddReal("remesh_benchmark", "refine_fraction", 0.05));
+  pkg->AddParam<>("derefine_fraction",
+                  pin->GetOrAddReal("remesh_benchmark", "derefine_fraction", 0.2));
+  pkg->AddParam<>("rng",
+                  RandomStreams(pin->GetOrAddInteger("remesh_benchmark", "seed", 2024)));
+  pkg->AddParam<>("step", 0, Params::Mutability::Mutable);
+  pkg->CheckRefinementBlock = CheckRefinement;
+
+  Metadata m({Metadata::Cell, Metadata::Independent, Metadata::FillGhost},
+             std::vector<int>{ncomp});
+  for (int n = 0; n < nvars; ++n)
+    pkg->AddField(FieldName(n), m);
+
+  Packages_t packages;
+  packages.Add(pkg);
+  return packages;
+}
+
+void ProblemGenerator(MeshBlock *pmb, ParameterInput *pin) {
+  auto &data = pmb->meshblock_data.Get();
+  const IndexRange ib = pmb->cellbounds.GetBoundsI(IndexDomain::entire);
+  const IndexRange jb = pmb->cellbounds.GetBoundsJ(IndexDomain::entire);
+  const IndexRange kb = pmb->cellbounds.GetBoundsK(IndexDomain::entire);
+  auto coords = pmb->coords;
+  auto q = data->PackVariables(std::vector<MetadataFlag>{Metadata::Independent});
+  const int nvars = q.GetDim(4);
+  pmb->par_for(
+      PARTHENON_AUTO_LABEL, 0, nvars - 1, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+      KOKKOS_LAMBDA(const int n, const int k, const int j, const int i) {
+        const Real x = coords.Xc<1>(i);
+        const Real y = coords.Xc<2>(j);
+        const Real z = coords.Xc<3>(k);
+        q(n, k, j, i) = 1.0 + 0.5 * std::sin(2.0 * M_PI * (x + 0.1 * n)) *
+                                  std::cos(2.0 * M_PI * y) * std::cos(2.0 * M_PI * z);
+      });
+}
+
+AmrTag CheckRefinement(MeshBlockData<Real> *rc) {
+  auto pmb = rc->GetBlockPointer();
+  auto pkg = pmb->packages.Get("remesh_benchmark");
+  const int step = pkg->Param<int>("step");
+
+  if (pkg->Param<std::string>("pattern") == "random") {
+    // Keyed by the location, so that the tags do not depend on the distribution of the
+    // blocks
+    const auto &loc = pmb->loc;
+    const auto index = static_cast<int>(std::hash<LogicalLocation>()(loc));
+    auto rng = pkg->Param<RandomStreams>("rng").Get(loc.level(), index, step);
+    const Real u = rng.drand();
+    if (u < pkg->Param<Real>("refine_fraction")) return AmrTag::refine;
+    if (u >= 1.0 - pkg->Param<Real>("derefine_fraction")) return AmrTag::derefine;
+    return AmrTag::same;
+  }
+
+  // Refine the blocks intersecting the shell, in coordinates normalized to the domain
+  const auto &mesh_size = pmb->pmy_mesh->mesh_size;
+  const auto &block_size = pmb->block_size;
+  const Real phase = 2.0 * M_PI * step / pkg->Param<int>("orbit_steps");
+  const Real orbit = pkg->Param<Real>("orbit_radius");
+  const std::array<Real, 3> center{0.5 + orbit * std::cos(phase),
+                                   0.5 + orbit * std::sin(phase), 0.5};
+  Real dmin2 = 0.0, dmax2 = 0.0;
+  for (int d = 0; d < pmb->pmy_mesh->ndim; ++d) {
+    const auto dir = static_cast<CoordinateDirection>(d + 1);
+    const Real length = mesh_size.xmax(dir) - mesh_size.xmin(dir);
+    const Real lo = (block_size.xmin(dir) - mesh_size.xmin(dir)) / length - center[d];
+    const Real hi = (block_size.xmax(dir) - mesh_size.xmin(dir)) / length - center[d];
+    const Real nearest = lo > 0.0 ? lo : (hi < 0.0 ? hi : 0.0);
+    const Real farthest = std::max(std::abs(lo), std::abs(hi));
+    dmin2 += nearest * nearest;
+    dmax2 += farthest * farthest;
+  }
+  const Real radius = pkg->Param<Real>("radius");
+  return dmin2 <= radius * radius && radius * radius <= dmax2 ? AmrTag::refine
+                                                              : AmrTag::derefine;
+}
+
+namespace {
+// Wall time of f() on this rank, starting once all ranks arrived
+template <class F>
+double Time(F &&f) {
+  Kokkos::fence();
+#ifdef MPI_PARALLEL
+  PARTHENON_MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+#endif
+  Kokkos::Timer timer;
+  f();
+  Kokkos::fence();
+  return timer.seconds();
+}
+
+// The phases of a remesh that are timed by named regions of the mesh
+struct Phase {
+  const char *name;
+  const char *region;
+};
+constexpr std::array<Phase, 5> phases{
+    {{"tree update", "Mesh::UpdateMeshBlockTree"},
+     {"partitioning", "Mesh::CalculateLoadBalance"},
+     {"migration", "Mesh::Migration"},
+     {"buffer rebuild", "Mesh::BuildTagMapAndBoundaryBuffers"},
+     {"neighbor setup", "Mesh::SetMeshBlockNeighbors"}}};
+} // namespace
+
+void RunBenchmark(ParthenonManager &pman) {
+  Mesh *pmesh = pman.pmesh.get();
+  ParameterInput *pin = pman.pinput.get();
+  auto pkg = pmesh->packages.Get("remesh_benchmark");
+  const int nsteps = pin->GetOrAddInteger("remesh_benchmark", "nsteps", 32);
+  const int warmup = pin->GetOrAddInteger("remesh_benchmark", "warmup", 2);
+  PARTHENON_REQUIRE_THROWS(pmesh->adaptive,
+                           "The remesh benchmark requires refinement = adaptive");
+  PARTHENON_REQUIRE_THROWS(nsteps > 0, "nsteps of remesh_benchmark must be positive");
+
+  // Tagging, the phases, the remaining time, and the total time of the remeshes
+  std::array<double, phases.size() + 3> times{};
+  std::uint64_t migrated_bytes = 0;
+  int remeshes = 0, created = 0, destroyed = 0, max_blocks = pmesh->nbtotal;
+  const int initial_blocks = pmesh->nbtotal;
+
+  const bool timers = TimerRegistry::Enabled();
+  TimerRegistry::Enable(true);
+  for (int step = 0; step < warmup + nsteps; ++step) {
+    pkg->UpdateParam("step", step);
+    const bool record = step >= warmup;
+
+    const double tagging = Time([&]() {
+      for (int i = 0; i < pmesh->DefaultNumPartitions(); ++i)
+        Refinement::Tag(pmesh->mesh_data.GetOrAdd("base", i).get());
+    });
+
+    std::array<double, phases.size()> start;
+    for (int p = 0; p < phases.size(); ++p)
+      start[p] = TimerRegistry::Seconds(phases[p].region);
+    const auto bytes = pmesh->GetMigratedBytes();
+    const int nbnew = pmesh->nbnew, nbdel = pmesh->nbdel;
+    pmesh->step_since_lb++;
+    const double remesh = Time([&]() {
+      pmesh->LoadBalancingAndAdaptiveMeshRefinement(pin, pman.app_input.get());
+    });
+    if (!record) continue;
+
+    times[0] += tagging;
+    double other = remesh;
+    for (int p = 0; p < phases.size(); ++p) {
+      const double seconds = TimerRegistry::Seconds(phases[p].region) - start[p];
+      times[p + 1] += seconds;
+      other -= seconds;
+    }
+    times[phases.size() + 1] += other;
+    times[phases.size() + 2] += remesh;
+    migrated_bytes += pmesh->GetMigratedBytes() - bytes;
+    remeshes += pmesh->modified;
+    created += pmesh->nbnew - nbnew;
+    destroyed += pmesh->nbdel - nbdel;
+    max_blocks = std::max(max_blocks, pmesh->nbtotal);
+  }
+  TimerRegistry::Enable(timers);
+
+  // Report the slowest rank of every phase
+#ifdef MPI_PARALLEL
+  PARTHENON_MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, times.data(), times.size(), MPI_DOUBLE,
+                                    MPI_MAX, MPI_COMM_WORLD));
+#endif
+  if (Globals::my_rank != 0) return;
+  printf("Remesh benchmark (%s pattern)\n", pkg->Param<std::string>("pattern").c_str());
+  printf("  ranks: %i, steps: %i (after %i warmup steps), remeshes: %i\n",
+         Globals::nranks, nsteps, warmup, remeshes);
+  printf("  blocks: %i initially, %i finally, %i at most, %i created, %i destroyed\n",
+         initial_blocks, pmesh->nbtotal, max_blocks, created, destroyed);
+  printf("  migrated: %.3f MB in total, %.3f MB per step, %.3f GB/s\n",
+         1.0e-6 * migrated_bytes, 1.0e-6 * migrated_bytes / nsteps,
+         times[3] > 0.0 ? 1.0e-9 * migrated_bytes / times[3] : 0.0);
+  printf("  %-16s  %12s  %12s  %10s\n", "phase", "total [s]", "per step [ms]",
+         "of remesh");
+  const double total = times[phases.size() + 2];
+  auto row = [&](const char *name, const double seconds) {
+    printf("  %-16s  %12.4e  %12.4f  %9.1f%%\n", name, seconds, 1.0e3 * seconds / nsteps,
+           total > 0.0 ? 100.0 * seconds / total : 0.0);
+  };
+  row("tagging", times[0]);
+  for (int p = 0; p < phases.size(); ++p)
+    row(phases[p].name, times[p + 1]);
+  row("other", times[phases.size() + 1]);
+  row("remesh", total);
+}
+
+} // namespace remesh_benchmark
@@ -61,9 +61,14 @@ TaskCollection AdvectionDriver::MakeTaskCollection(BlockList_t &blocks, const in
   const Real beta = integrator->beta[stage - 1];
   const Real dt = integrator->dt;
   const auto &stage_name = integrator->stage_name;
-
-  auto partitions = pmesh->GetDefaultBlockPartitions();
-  int num_partitions = partitions.size();
+  // Handles of the stages, which cache the MeshData of every partition until a remesh
+  auto &mesh_data = pmesh->mesh_data;
+  const auto base = mesh_data.GetStageHandle("base");
+  const auto stage0 = mesh_data.GetStageHandle(stage_name[stage - 1]);
+  const auto stage1 = mesh_data.GetStageHandle(stage_name[stage]);
+  const auto dudt = mesh_data.GetStageHandle("dUdt");
+
+  const int num_partitions = pmesh->GetDefaultBlockPartitions().size();
   // note that task within this region that contains one tasklist per pack
   // could still be executed in parallel
   TaskRegion &single_tasklist_per_pack_region2 = tc.AddRegion(num_partitions);
@@ -72,16 +77,19 @@ TaskCollection AdvectionDriver::MakeTaskCollection(BlockList_t &blocks, const in
     // Initialize the base MeshData for this partition
     // (this automatically initializes the MeshBlockData objects
     // required by this MeshData object)
-    auto &mbase = pmesh->mesh_data.Add("base", partitions[i]);
+    auto &mbase = mesh_data.GetOrAdd(base, i);
     // Initialize other MeshData objects based on the base container
-    auto &mc0 = pmesh->mesh_data.Add(stage_name[stage - 1], mbase);
-    auto &mc1 = pmesh->mesh_data.Add(stage_name[stage], mbase);
-    auto &mdudt = pmesh->mesh_data.Add("dUdt", mbase);
+    auto &mc0 = mesh_data.GetOrAdd(stage0, i);
+    auto &mc1 = mesh_data.GetOrAdd(stage1, i);
+    auto &mdudt = mesh_data.GetOrAdd(dudt, i);
 
     const auto any = parthenon::BoundaryType::any;
 
-    tl.AddTask(none, parthenon::StartReceiveBoundBufs<any>, mc1);
-    tl.AddTask(none, parthenon::StartReceiveFluxCorrections, mc0);
+    // Post the receives before any other work of the step
+    const auto first = TaskQualifier::high_priority;
+    tl.AddTask(first, none, parthenon::StartReceiveBoundBufs<any>, mc1);
+    tl.AddTask(first, none, parthenon::StartReceiveFluxCorrections, mc0);
+    tl.AddTask(none, AcquireFluxes, mc0.get());
   }
 
   // Number of task lists that can be executed independently and thus *may*
@@ -113,16 +121,17 @@ TaskCollection AdvectionDriver::MakeTaskCollection(BlockList_t &blocks, const in
   TaskRegion &single_tasklist_per_pack_region = tc.AddRegion(num_partitions);
   for (int i = 0; i < num_partitions; i++) {
     auto &tl = single_tasklist_per_pack_region[i];
-    auto &mbase = pmesh->mesh_data.Add("base", partitions[i]);
-    auto &mc0 = pmesh->mesh_data.Add(stage_name[stage - 1], mbase);
-    auto &mc1 = pmesh->mesh_data.Add(stage_name[stage], mbase);
-    auto &mdudt = pmesh->mesh_data.Add("dUdt", mbase);
+    auto &mbase = mesh_data.GetOrAdd(base, i);
+    auto &mc0 = mesh_data.GetOrAdd(stage0, i);
+    auto &mc1 = mesh_data.GetOrAdd(stage1, i);
+    auto &mdudt = mesh_data.GetOrAdd(dudt, i);
 
     auto set_flx = parthenon::AddFluxCorrectionTasks(none, tl, mc0, pmesh->multilevel);
 
     // compute the divergence of fluxes of conserved variables
     auto flux_div =
         tl.AddTask(set_flx, FluxDivergence<MeshData<Real>>, mc0.get(), mdudt.get());
+    tl.AddTask(flux_div, ReleaseFluxes, mc0.get());
 
     auto avg_data = tl.AddTask(flux_div, AverageIndependentData<MeshData<Real>>,
                                mc0.get(), mbase.get(), beta);
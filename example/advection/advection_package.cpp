@@ -523,13 +523,15 @@ TaskStatus CalculateFluxes(std::shared_ptr<MeshBlockData<Real>> &rc) {
   const int scratch_level = 1; // 0 is actual scratch (tiny); 1 is HBM
   const int nx1 = pmb->cellbounds.ncellsi(IndexDomain::entire);
   const int nvar = v.GetDim(4);
-  size_t scratch_size_in_bytes = parthenon::ScratchPad2D<Real>::shmem_size(nvar, nx1);
+  const parthenon::TeamScratchPads<2> scratch_lr(nvar, nx1, scratch_level);
+  const parthenon::TeamScratchPads<3> scratch_lru(nvar, nx1, scratch_level);
   // get x-fluxes
   pmb->par_for_outer(
-      PARTHENON_AUTO_LABEL, 2 * scratch_size_in_bytes, scratch_level, kb.s, kb.e, jb.s,
+      PARTHENON_AUTO_LABEL, scratch_lr.shmem_size(), scratch_level, kb.s, kb.e, jb.s,
       jb.e, KOKKOS_LAMBDA(parthenon::team_mbr_t member, const int k, const int j) {
-        parthenon::ScratchPad2D<Real> ql(member.team_scratch(scratch_level), nvar, nx1);
-        parthenon::ScratchPad2D<Real> qr(member.team_scratch(scratch_level), nvar, nx1);
+        auto pads = scratch_lr.Get(member);
+        auto &ql = pads[0];
+        auto &qr = pads[1];
         // get reconstructed state on faces
         parthenon::DonorCellX1(member, k, j, ib.s - 1, ib.e + 1, v, ql, qr);
         // Sync all threads in the team so that scratch memory is consistent
@@ -559,17 +561,17 @@ TaskStatus CalculateFluxes(std::shared_ptr<MeshBlockData<Real>> &rc) {
   // get y-fluxes
   if (pmb->pmy_mesh->ndim >= 2) {
     pmb->par_for_outer(
-        PARTHENON_AUTO_LABEL, 3 * scratch_size_in_bytes, scratch_level, kb.s, kb.e, jb.s,
+        PARTHENON_AUTO_LABEL, scratch_lru.shmem_size(), scratch_level, kb.s, kb.e, jb.s,
         jb.e + 1, KOKKOS_LAMBDA(parthenon::team_mbr_t member, const int k, const int j) {
           // the overall algorithm/use of scratch pad here is clear inefficient and kept
           // just for demonstrating purposes. The key point is that we cannot reuse
           // reconstructed arrays for different `j` with `j` being part of the outer
           // loop given that this loop can be handled by multiple threads simultaneously.
 
-          parthenon::ScratchPad2D<Real> ql(member.team_scratch(scratch_level), nvar, nx1);
-          parthenon::ScratchPad2D<Real> qr(member.team_scratch(scratch_level), nvar, nx1);
-          parthenon::ScratchPad2D<Real> q_unused(member.team_scratch(scratch_level), nvar,
-                                                 nx1);
+          auto pads = scratch_lru.Get(member);
+          auto &ql = pads[0];
+          auto &qr = pads[1];
+          auto &q_unused = pads[2];
           // get reconstructed state on faces
           parthenon::DonorCellX2(member, k, j - 1, ib.s, ib.e, v, ql, q_unused);
           parthenon::DonorCellX2(member, k, j, ib.s, ib.e, v, q_unused, qr);
@@ -602,7 +604,7 @@ TaskStatus CalculateFluxes(std::shared_ptr<MeshBlockData<Real>> &rc) {
   // get z-fluxes
   if (pmb->pmy_mesh->ndim == 3) {
     pmb->par_for_outer(
-        PARTHENON_AUTO_LABEL, 3 * scratch_size_in_bytes, scratch_level, kb.s, kb.e + 1,
+        PARTHENON_AUTO_LABEL, scratch_lru.shmem_size(), scratch_level, kb.s, kb.e + 1,
         jb.s, jb.e,
         KOKKOS_LAMBDA(parthenon::team_mbr_t member, const int k, const int j) {
           // the overall algorithm/use of scratch pad here is clear inefficient and kept
@@ -610,10 +612,10 @@ TaskStatus CalculateFluxes(std::shared_ptr<MeshBlockData<Real>> &rc) {
           // reconstructed arrays for different `j` with `j` being part of the outer
           // loop given that this loop can be handled by multiple threads simultaneously.
 
-          parthenon::ScratchPad2D<Real> ql(member.team_scratch(scratch_level), nvar, nx1);
-          parthenon::ScratchPad2D<Real> qr(member.team_scratch(scratch_level), nvar, nx1);
-          parthenon::ScratchPad2D<Real> q_unused(member.team_scratch(scratch_level), nvar,
-                                                 nx1);
+          auto pads = scratch_lru.Get(member);
+          auto &ql = pads[0];
+          auto &qr = pads[1];
+          auto &q_unused = pads[2];
           // get reconstructed state on faces
           parthenon::DonorCellX3(member, k - 1, j, ib.s, ib.e, v, ql, q_unused);
           parthenon::DonorCellX3(member, k, j, ib.s, ib.e, v, q_unused, qr);
@@ -12,6 +12,7 @@
 //========================================================================================
 
 // Standard Includes
+#include <cmath>
 #include <iostream>
 #include <limits>
 #include <memory>
@@ -101,15 +102,83 @@ TaskStatus SetBlockValues(MeshData<Real> *md) {
   return TaskStatus::complete;
 }
 
+void ProblemGenerator(MeshBlock *pmb, ParameterInput *pin) {
+  auto pkg = pmb->packages.Get("boundary_exchange");
+  if (!pkg->Param<bool>("benchmark")) return;
+  const int nvars = pkg->Param<int>("nvars");
+  const bool sparse = pkg->Param<bool>("sparse");
+  // Spread the blocks with allocated sparse fields evenly over the mesh with the golden
+  // ratio sequence of their global ids
+  const bool allocate =
+      std::fmod(pmb->gid * 0.6180339887498949, 1.0) < pkg->Param<Real>("sparse_fraction");
+
+  auto &rc = pmb->meshblock_data.Get();
+  IndexRange ib = pmb->cellbounds.GetBoundsI(IndexDomain::interior);
+  IndexRange jb = pmb->cellbounds.GetBoundsJ(IndexDomain::interior);
+  IndexRange kb = pmb->cellbounds.GetBoundsK(IndexDomain::interior);
+  for (int v = 0; v < nvars; ++v) {
+    const std::string label = parthenon::MakeVarLabel(benchmark_field, v);
+    if (sparse) {
+      if (!allocate) continue;
+      pmb->AllocateSparse(label);
+    }
+    auto q = rc->Get(label).data;
+    const int ncomp = q.GetDim(4);
+    pmb->par_for(
+        "SetBenchmarkValues", 0, ncomp - 1, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+        KOKKOS_LAMBDA(const int n, const int k, const int j, const int i) {
+          q(n, k, j, i) = 1.0 + n + i + j + k;
+        });
+  }
+}
+
 std::shared_ptr<StateDescriptor> Initialize(ParameterInput *pin) {
   auto package = std::make_shared<StateDescriptor>("boundary_exchange");
   Params &params = package->AllParams();
 
-  Metadata m({Metadata::Cell, Metadata::Independent, Metadata::FillGhost},
-             std::vector<int>{8});
+  const bool benchmark = pin->GetOrAddBoolean("boundary_exchange", "benchmark", false);
+  params.Add("benchmark", benchmark);
+  if (!benchmark) {
+    Metadata m({Metadata::Cell, Metadata::Independent, Metadata::FillGhost},
+               std::vector<int>{8});
+    m.RegisterRefinementOps<parthenon::refinement_ops::ProlongatePiecewiseConstant,
+                            parthenon::refinement_ops::RestrictAverage>();
+    package->AddField(neighbor_info::name(), m);
+    return package;
+  }
+
+  // The benchmark exchanges nvars fields with ncomp components each. If the fields are
+  // sparse, they are initially allocated on the fraction sparse_fraction of the blocks.
+  const int nvars = pin->GetOrAddInteger("boundary_exchange", "nvars", 1);
+  const int ncomp = pin->GetOrAddInteger("boundary_exchange", "ncomp", 1);
+  const Real sparse_fraction =
+      pin->GetOrAddReal("boundary_exchange", "sparse_fraction", 1.0);
+  PARTHENON_REQUIRE_THROWS(nvars > 0 && ncomp > 0,
+                           "boundary_exchange/nvars and ncomp must be positive");
+  PARTHENON_REQUIRE_THROWS(sparse_fraction >= 0.0 && sparse_fraction <= 1.0,
+                           "boundary_exchange/sparse_fraction must be in [0, 1]");
+  const bool sparse = sparse_fraction < 1.0;
+  params.Add("nvars", nvars);
+  params.Add("sparse", sparse);
+  params.Add("sparse_fraction", sparse_fraction);
+  params.Add("ncycles", pin->GetOrAddInteger("boundary_exchange", "ncycles", 100));
+  params.Add("nwarmup", pin->GetOrAddInteger("boundary_exchange", "nwarmup", 5));
+
+  std::vector<parthenon::MetadataFlag> flags{Metadata::Cell, Metadata::Independent,
+                                             Metadata::FillGhost};
+  if (sparse) flags.push_back(Metadata::Sparse);
+  Metadata m(flags, std::vector<int>{ncomp});
   m.RegisterRefinementOps<parthenon::refinement_ops::ProlongatePiecewiseConstant,
                           parthenon::refinement_ops::RestrictAverage>();
-  package->AddField(neighbor_info::name(), m);
+  if (sparse) {
+    parthenon::SparsePool pool(benchmark_field, m);
+    for (int v = 0; v < nvars; ++v)
+      pool.Add(v);
+    package->AddSparsePool(pool);
+  } else {
+    for (int v = 0; v < nvars; ++v)
+      package->AddField(parthenon::MakeVarLabel(benchmark_field, v), m);
+  }
 
   return package;
 }
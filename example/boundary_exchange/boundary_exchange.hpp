@@ -34,7 +34,12 @@ struct neighbor_info : public parthenon::variable_names::base_t<false, 4> {
   static std::string name() { return "neighbor_info"; }
 };
 
+// Base name of the fields exchanged by the benchmark
+inline const std::string benchmark_field = "bench";
+
 TaskStatus SetBlockValues(MeshData<Real> *rc);
+// Allocates and fills the fields of the benchmark
+void ProblemGenerator(MeshBlock *pmb, ParameterInput *pin);
 std::shared_ptr<StateDescriptor> Initialize(ParameterInput *pin);
 
 } // namespace boundary_exchange
@@ -12,6 +12,9 @@
 //========================================================================================
 
 // Standard Includes
+#include <algorithm>
+#include <array>
+#include <cstdio>
 #include <fstream>
 #include <memory>
 #include <string>
@@ -26,6 +29,7 @@
 #include "boundary_exchange_driver.hpp"
 #include "mesh/forest/forest_node.hpp"
 #include "mesh/forest/forest_topology.hpp"
+#include "utils/comm_statistics.hpp"
 
 // Preludes
 using namespace parthenon::driver::prelude;
@@ -33,11 +37,13 @@ using namespace parthenon::driver::prelude;
 using boundary_exchange::BoundaryExchangeDriver;
 
 Packages_t ProcessPackages(std::unique_ptr<ParameterInput> &pin);
+void InitializeForestMesh(ParthenonManager &pman);
 
 int main(int argc, char *argv[]) {
   ParthenonManager pman;
 
   pman.app_input->ProcessPackages = ProcessPackages;
+  pman.app_input->ProblemGenerator = boundary_exchange::ProblemGenerator;
 
   // This is called on each mesh block whenever the mesh changes.
   // pman.app_input->InitMeshBlockUserData = &calculate_pi::SetInOrOutBlock;
@@ -52,50 +58,12 @@ int main(int argc, char *argv[]) {
     return 1;
   }
 
-  // Create the nodes for the forest, the x-y positions are only used for
-  // visualizing the forest configuration and *do not* determine the global
-  // coordinates of the trees.
-  std::unordered_map<uint64_t, std::shared_ptr<parthenon::forest::Node>> nodes;
-  nodes[0] = parthenon::forest::Node::create(0, {0.0, 0.0});
-  nodes[1] = parthenon::forest::Node::create(1, {1.0, 0.0});
-  nodes[2] = parthenon::forest::Node::create(2, {1.0, 1.0});
-  nodes[3] = parthenon::forest::Node::create(3, {0.0, 1.0});
-  nodes[4] = parthenon::forest::Node::create(4, {2.0, 0.0});
-  nodes[5] = parthenon::forest::Node::create(5, {2.0, 1.0});
-  nodes[6] = parthenon::forest::Node::create(6, {0.0, 2.0});
-  nodes[7] = parthenon::forest::Node::create(7, {1.0, 2.0});
-  nodes[8] = parthenon::forest::Node::create(8, {2.0, 2.0});
-
-  auto &n = nodes;
-  parthenon::forest::ForestDefinition forest_def;
-
-  using edge_t = parthenon::forest::Edge;
-  using ar3_t = std::array<Real, 3>;
-  using ai3_t = std::array<int, 3>;
-  forest_def.AddFace(0, {n[1], n[2], n[0], n[3]}, ar3_t{0.0, 0.0, 0.0},
-                     ar3_t{1.0, 1.0, 1.0});
-  // forest_def.AddFace(0, {n[0], n[1], n[3], n[2]}, ar3_t{0.0, 0.0, 0.0},
-  // ar3_t{1.0, 1.0, 1.0});
-  forest_def.AddBC(edge_t({n[0], n[1]}), parthenon::BoundaryFlag::outflow);
-  forest_def.AddBC(edge_t({n[0], n[3]}), parthenon::BoundaryFlag::outflow);
-
-  forest_def.AddFace(1, {n[1], n[4], n[2], n[5]}, ar3_t{2.0, 0.0, 0.0},
-                     ar3_t{3.0, 1.0, 1.0});
-  forest_def.AddBC(edge_t({n[1], n[4]}), parthenon::BoundaryFlag::outflow);
-  forest_def.AddBC(edge_t({n[4], n[5]}), parthenon::BoundaryFlag::outflow);
-
-  forest_def.AddFace(3, {n[3], n[2], n[6], n[7]}, ar3_t{0.0, 2.0, 0.0},
-                     ar3_t{1.0, 3.0, 1.0});
-  forest_def.AddBC(edge_t({n[6], n[7]}), parthenon::BoundaryFlag::outflow);
-  forest_def.AddBC(edge_t({n[3], n[6]}), parthenon::BoundaryFlag::outflow);
-
-  forest_def.AddFace(4, {n[2], n[5], n[7], n[8]}, ar3_t{2.0, 2.0, 0.0},
-                     ar3_t{3.0, 3.0, 1.0});
-  forest_def.AddBC(edge_t({n[5], n[8]}), parthenon::BoundaryFlag::outflow);
-  forest_def.AddBC(edge_t({n[7], n[8]}), parthenon::BoundaryFlag::outflow);
-
-  forest_def.AddInitialRefinement(parthenon::LogicalLocation(0, 1, 0, 0, 0));
-  pman.ParthenonInitPackagesAndMesh(forest_def);
+  if (pman.pinput->GetOrAddBoolean("boundary_exchange", "benchmark", false)) {
+    // The benchmark runs on the mesh defined in the input file
+    pman.ParthenonInitPackagesAndMesh();
+  } else {
+    InitializeForestMesh(pman);
+  }
 
   // This needs to be scoped so that the driver object is destructed before Finalize
   {
@@ -125,6 +93,11 @@ Packages_t ProcessPackages(std::unique_ptr<ParameterInput> &pin) {
 //}
 
 parthenon::DriverStatus BoundaryExchangeDriver::Execute() {
+  if (pmesh->packages.Get("boundary_exchange")->Param<bool>("benchmark")) {
+    RunBenchmark();
+    return DriverStatus::complete;
+  }
+
   // this is where the main work is orchestrated
   // No evolution in this driver.  Just calculates something once.
   // For evolution, look at the EvolutionDriver
@@ -160,3 +133,195 @@ TaskCollection BoundaryExchangeDriver::MakeTaskCollection(T &blocks) {
 
   return tc;
 }
+
+namespace {
+using bound_task_t = TaskStatus (*)(std::shared_ptr<MeshData<Real>> &);
+
+// Runs the boundary communication task f and adds its wall time to time. The device is
+// fenced, so that the time includes the kernels launched by f.
+TaskStatus Timed(double *time, bound_task_t f, std::shared_ptr<MeshData<Real>> &md) {
+  Kokkos::Timer timer;
+  const TaskStatus status = f(md);
+  Kokkos::fence();
+  *time += timer.seconds();
+  return status;
+}
+} // namespace
+
+// The exchange of AddBoundaryExchangeTasks, split into local and nonlocal neighbors so
+// that their packing and unpacking can be timed separately
+TaskCollection BoundaryExchangeDriver::MakeBenchmarkTaskCollection() {
+  using parthenon::BoundaryType;
+  constexpr auto local = BoundaryType::local;
+  constexpr auto nonlocal = BoundaryType::nonlocal;
+  const int num_partitions = pmesh->DefaultNumPartitions();
+  exchange_times_.assign(num_partitions, ExchangeTimes());
+
+  TaskCollection tc;
+  TaskRegion &region = tc.AddRegion(num_partitions);
+  for (int i = 0; i < num_partitions; i++) {
+    auto &tl = region[i];
+    auto &md = pmesh->mesh_data.GetOrAdd("base", i);
+    auto &times = exchange_times_[i];
+    TaskID none(0);
+    tl.AddTask(TaskQualifier::high_priority, none, Timed, &times.nonlocal[0],
+               &parthenon::SendBoundBufs<nonlocal>, md);
+    tl.AddTask(TaskQualifier::high_priority, none, Timed, &times.local[0],
+               &parthenon::SendBoundBufs<local>, md);
+    auto recv_nonlocal = tl.AddTask(none, parthenon::ReceiveBoundBufs<nonlocal>, md);
+    auto set_nonlocal = tl.AddTask(recv_nonlocal, Timed, &times.nonlocal[1],
+                                   &parthenon::SetBounds<nonlocal>, md);
+    auto recv_local = tl.AddTask(none, parthenon::ReceiveBoundBufs<local>, md);
+    auto set_local =
+        tl.AddTask(recv_local, Timed, &times.local[1], &parthenon::SetBounds<local>, md);
+
+    auto set = set_local | set_nonlocal;
+    if (pmesh->multilevel) {
+      auto cbound =
+          tl.AddTask(set, parthenon::ApplyBoundaryConditionsOnCoarseOrFineMD, md, true);
+      set = tl.AddTask(cbound, parthenon::ProlongateBounds<local>, md) |
+            tl.AddTask(cbound, parthenon::ProlongateBounds<nonlocal>, md);
+    }
+    tl.AddTask(set, parthenon::ApplyBoundaryConditionsOnCoarseOrFineMD, md, false);
+  }
+  return tc;
+}
+
+void BoundaryExchangeDriver::RunBenchmark() {
+  using parthenon::CommStatistics;
+  using parthenon::Globals::my_rank;
+  auto pkg = pmesh->packages.Get("boundary_exchange");
+  const int ncycles = pkg->Param<int>("ncycles");
+  const int nwarmup = pkg->Param<int>("nwarmup");
+
+  // The first exchanges build the buffers and caches
+  TaskCollection tc = MakeBenchmarkTaskCollection();
+  for (int c = 0; c < nwarmup; ++c)
+    tc.Execute();
+  std::fill(exchange_times_.begin(), exchange_times_.end(), ExchangeTimes());
+
+  // The messages and bytes sent are counted by the communication statistics
+  const bool collect_statistics = CommStatistics::Enabled();
+  auto &statistics = CommStatistics::Instance();
+  CommStatistics::Enable(true);
+  statistics.Clear();
+  Kokkos::fence();
+#ifdef MPI_PARALLEL
+  PARTHENON_MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+#endif
+  Kokkos::Timer timer;
+  for (int c = 0; c < ncycles; ++c)
+    tc.Execute();
+  Kokkos::fence();
+#ifdef MPI_PARALLEL
+  PARTHENON_MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+#endif
+  const double wall = timer.seconds();
+  CommStatistics::Enable(collect_statistics);
+
+  // Summed over the ranks: the messages sent to local and nonlocal neighbors, the bytes
+  // sent to them, the number of blocks, and the number of blocks on which the first
+  // field is allocated
+  std::array<double, 6> sums{};
+  for (const auto &[rank, peer] : statistics.GetPeers()) {
+    const int nonlocal = rank != my_rank;
+    sums[nonlocal] += peer.messages_sent;
+    sums[2 + nonlocal] += peer.bytes_sent;
+  }
+  const auto first_field = parthenon::MakeVarLabel(boundary_exchange::benchmark_field, 0);
+  for (const auto &pmb : pmesh->block_list) {
+    sums[4] += 1;
+    sums[5] += pmb->IsAllocated(first_field);
+  }
+  // Maximum over the ranks: the pack and unpack times of local and nonlocal neighbors
+  // summed over the partitions of a rank, and the number of ranks per node
+  std::array<double, 5> maxs{};
+  for (const auto &t : exchange_times_) {
+    maxs[0] += t.local[0];
+    maxs[1] += t.local[1];
+    maxs[2] += t.nonlocal[0];
+    maxs[3] += t.nonlocal[1];
+  }
+  maxs[4] = 1;
+#ifdef MPI_PARALLEL
+  MPI_Comm node_comm;
+  PARTHENON_MPI_CHECK(MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, my_rank,
+                                          MPI_INFO_NULL, &node_comm));
+  int node_size;
+  PARTHENON_MPI_CHECK(MPI_Comm_size(node_comm, &node_size));
+  PARTHENON_MPI_CHECK(MPI_Comm_free(&node_comm));
+  maxs[4] = node_size;
+  PARTHENON_MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, sums.data(), sums.size(), MPI_DOUBLE,
+                                    MPI_SUM, MPI_COMM_WORLD));
+  PARTHENON_MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, maxs.data(), maxs.size(), MPI_DOUBLE,
+                                    MPI_MAX, MPI_COMM_WORLD));
+#endif
+  if (my_rank != 0) return;
+
+  printf("Boundary exchange benchmark\n");
+  printf("  ranks: %i (%i per node), blocks: %i of %i x %i x %i cells, levels: %i\n",
+         parthenon::Globals::nranks, static_cast<int>(maxs[4]), static_cast<int>(sums[4]),
+         pinput->GetInteger("parthenon/meshblock", "nx1"),
+         pinput->GetOrAddInteger("parthenon/meshblock", "nx2", 1),
+         pinput->GetOrAddInteger("parthenon/meshblock", "nx3", 1),
+         pmesh->GetCurrentLevel() - pmesh->GetRootLevel() + 1);
+  printf("  fields: %i with %i components, allocated on %.1f%% of the blocks\n",
+         pkg->Param<int>("nvars"), pinput->GetInteger("boundary_exchange", "ncomp"),
+         100.0 * sums[5] / sums[4]);
+  printf("  cycles: %i, wall time per cycle: %.3e s\n", ncycles, wall / ncycles);
+  printf("              messages/s  bandwidth [GB/s]  pack [s/cycle]"
+         "  unpack [s/cycle]\n");
+  for (const int nonlocal : {0, 1}) {
+    printf("  %-10s  %10.3e  %16.3e  %14.3e  %16.3e\n", nonlocal ? "nonlocal" : "local",
+           sums[nonlocal] / wall, 1.0e-9 * sums[2 + nonlocal] / wall,
+           maxs[2 * nonlocal] / ncycles, maxs[2 * nonlocal + 1] / ncycles);
+  }
+}
+
+// Mesh of five trees with different orientations that checks the exchange between them
+void InitializeForestMesh(ParthenonManager &pman) {
+  // Create the nodes for the forest, the x-y positions are only used for
+  // visualizing the forest configuration and *do not* determine the global
+  // coordinates of the trees.
+  std::unordered_map<uint64_t, std::shared_ptr<parthenon::forest::Node>> nodes;
+  nodes[0] = parthenon::forest::Node::create(0, {0.0, 0.0});
+  nodes[1] = parthenon::forest::Node::create(1, {1.0, 0.0});
+  nodes[2] = parthenon::forest::Node::create(2, {1.0, 1.0});
+  nodes[3] = parthenon::forest::Node::create(3, {0.0, 1.0});
+  nodes[4] = parthenon::forest::Node::create(4, {2.0, 0.0});
+  nodes[5] = parthenon::forest::Node::create(5, {2.0, 1.0});
+  nodes[6] = parthenon::forest::Node::create(6, {0.0, 2.0});
+  nodes[7] = parthenon::forest::Node::create(7, {1.0, 2.0});
+  nodes[8] = parthenon::forest::Node::create(8, {2.0, 2.0});
+
+  auto &n = nodes;
+  parthenon::forest::ForestDefinition forest_def;
+
+  using edge_t = parthenon::forest::Edge;
+  using ar3_t = std::array<Real, 3>;
+  using ai3_t = std::array<int, 3>;
+  forest_def.AddFace(0, {n[1], n[2], n[0], n[3]}, ar3_t{0.0, 0.0, 0.0},
+                     ar3_t{1.0, 1.0, 1.0});
+  // forest_def.AddFace(0, {n[0], n[1], n[3], n[2]}, ar3_t{0.0, 0.0, 0.0},
+  // ar3_t{1.0, 1.0, 1.0});
+  forest_def.AddBC(edge_t({n[0], n[1]}), parthenon::BoundaryFlag::outflow);
+  forest_def.AddBC(edge_t({n[0], n[3]}), parthenon::BoundaryFlag::outflow);
+
+  forest_def.AddFace(1, {n[1], n[4], n[2], n[5]}, ar3_t{2.0, 0.0, 0.0},
+                     ar3_t{3.0, 1.0, 1.0});
+  forest_def.AddBC(edge_t({n[1], n[4]}), parthenon::BoundaryFlag::outflow);
+  forest_def.AddBC(edge_t({n[4], n[5]}), parthenon::BoundaryFlag::outflow);
+
+  forest_def.AddFace(3, {n[3], n[2], n[6], n[7]}, ar3_t{0.0, 2.0, 0.0},
+                     ar3_t{1.0, 3.0, 1.0});
+  forest_def.AddBC(edge_t({n[6], n[7]}), parthenon::BoundaryFlag::outflow);
+  forest_def.AddBC(edge_t({n[3], n[6]}), parthenon::BoundaryFlag::outflow);
+
+  forest_def.AddFace(4, {n[2], n[5], n[7], n[8]}, ar3_t{2.0, 2.0, 0.0},
+                     ar3_t{3.0, 3.0, 1.0});
+  forest_def.AddBC(edge_t({n[5], n[8]}), parthenon::BoundaryFlag::outflow);
+  forest_def.AddBC(edge_t({n[7], n[8]}), parthenon::BoundaryFlag::outflow);
+
+  forest_def.AddInitialRefinement(parthenon::LogicalLocation(0, 1, 0, 0, 0));
+  pman.ParthenonInitPackagesAndMesh(forest_def);
+}
@@ -14,6 +14,7 @@
 #ifndef EXAMPLE_BOUNDARY_EXCHANGE_BOUNDARY_EXCHANGE_DRIVER_HPP_
 #define EXAMPLE_BOUNDARY_EXCHANGE_BOUNDARY_EXCHANGE_DRIVER_HPP_
 
+#include <array>
 #include <memory>
 #include <vector>
 
@@ -42,6 +43,19 @@ class BoundaryExchangeDriver : public Driver {
   DriverStatus Execute() override;
 
  protected:
+  // Wall times [s] of the tasks packing and sending (index 0) and unpacking (index 1)
+  // the buffers of local and nonlocal neighbors, with the device work they launched
+  struct ExchangeTimes {
+    std::array<double, 2> local{}, nonlocal{};
+  };
+
+  // Exchanges the boundaries of the benchmark fields once per execution
+  TaskCollection MakeBenchmarkTaskCollection();
+  // Runs the benchmark and reports the results of all ranks on rank 0
+  void RunBenchmark();
+
+  // Measured by the tasks of each partition
+  std::vector<ExchangeTimes> exchange_times_;
 };
 
 } // namespace boundary_exchange
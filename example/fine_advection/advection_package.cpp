@@ -12,6 +12,7 @@
 //========================================================================================
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <iostream>
 #include <limits>
@@ -95,7 +96,9 @@ std::shared_ptr<StateDescriptor> Initialize(ParameterInput *pin) {
       Metadata({Metadata::Cell, Metadata::Derived, Metadata::OneCopy}));
 
   pkg->CheckRefinementBlock = CheckRefinement;
-  pkg->EstimateTimestepMesh = EstimateTimestep;
+  // Evaluated together with the criteria of other packages by Update::EstimateTimestep
+  pkg->timestep_criteria.emplace_back(TimestepCriterion::Type::signal_speed,
+                                      std::array<Real, 3>{vx, vy, vz}, cfl / 2.0);
   pkg->FillDerivedMesh = FillDerived;
   return pkg;
 }
@@ -133,40 +136,6 @@ AmrTag CheckRefinement(MeshBlockData<Real> *rc) {
   return AmrTag::same;
 }
 
-Real EstimateTimestep(MeshData<Real> *md) {
-  std::shared_ptr<StateDescriptor> pkg =
-      md->GetMeshPointer()->packages.Get("advection_package");
-  const auto &cfl = pkg->Param<Real>("cfl");
-  const auto &vx = pkg->Param<Real>("vx");
-  const auto &vy = pkg->Param<Real>("vy");
-  const auto &vz = pkg->Param<Real>("vz");
-
-  static auto desc = parthenon::MakePackDescriptor<Conserved::phi>(md);
-  auto pack = desc.GetPack(md);
-
-  IndexRange ib = md->GetBoundsI(IndexDomain::interior);
-  IndexRange jb = md->GetBoundsJ(IndexDomain::interior);
-  IndexRange kb = md->GetBoundsK(IndexDomain::interior);
-
-  // This is obviously overkill for this constant velocity problem
-  Real min_dt;
-  parthenon::par_reduce(
-      parthenon::loop_pattern_mdrange_tag, PARTHENON_AUTO_LABEL, DevExecSpace(), 0,
-      pack.GetNBlocks() - 1, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
-      KOKKOS_LAMBDA(const int b, const int k, const int j, const int i, Real &lmin_dt) {
-        auto &coords = pack.GetCoordinates(b);
-        lmin_dt = std::min(
-            lmin_dt, parthenon::robust::ratio(coords.Dxc<X1DIR>(k, j, i), std::abs(vx)));
-        lmin_dt = std::min(
-            lmin_dt, parthenon::robust::ratio(coords.Dxc<X2DIR>(k, j, i), std::abs(vy)));
-        lmin_dt = std::min(
-            lmin_dt, parthenon::robust::ratio(coords.Dxc<X3DIR>(k, j, i), std::abs(vz)));
-      },
-      Kokkos::Min<Real>(min_dt));
-
-  return cfl * min_dt / 2.0;
-}
-
 TaskStatus FillDerived(MeshData<Real> *md) {
   static auto desc =
       parthenon::MakePackDescriptor<Conserved::phi_fine, Conserved::phi_fine_restricted,
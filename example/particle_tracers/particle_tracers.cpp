@@ -37,8 +37,6 @@
 using namespace parthenon::driver::prelude;
 using namespace parthenon::Update;
 
-typedef Kokkos::Random_XorShift64_Pool<> RNGPool;
-
 namespace tracers_example {
 
 // Add multiple packages, one for the advected background and one for the tracer
@@ -314,8 +312,8 @@ void ProblemGenerator(MeshBlock *pmb, ParameterInput *pin) {
   auto &advected = mbd->Get("advected").data;
   auto &swarm = pmb->meshblock_data.Get()->GetSwarmData()->Get("tracers");
   const auto num_tracers = tr_pkg->Param<int>("num_tracers");
-  auto rng_pool =
-      RNGPool(pmb->gid); // Seed is meshblock gid for consistency across MPI decomposition
+  // Keyed by meshblock gid for consistency across MPI decomposition
+  const RandomStreams rng_streams;
 
   const int ndim = pmb->pmy_mesh->ndim;
   PARTHENON_REQUIRE(ndim <= 2, "Tracer particles example only supports <= 2D!");
@@ -379,7 +377,7 @@ void ProblemGenerator(MeshBlock *pmb, ParameterInput *pin) {
       PARTHENON_AUTO_LABEL, 0, new_particles_context.GetNewParticlesMaxIndex(),
       KOKKOS_LAMBDA(const int new_n) {
         const int n = new_particles_context.GetNewParticleIndex(new_n);
-        auto rng_gen = rng_pool.get_state();
+        auto rng_gen = rng_streams.Get(gid, new_n, 0);
 
         // Rejection sample the x position
         Real val;
@@ -391,8 +389,6 @@ void ProblemGenerator(MeshBlock *pmb, ParameterInput *pin) {
         y(n) = y_min + rng_gen.drand() * (y_max - y_min);
         z(n) = z_min + rng_gen.drand() * (z_max - z_min);
         id(n) = num_tracers * gid + n;
-
-        rng_pool.free_state(rng_gen);
       });
 }
 
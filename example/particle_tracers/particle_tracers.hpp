@@ -19,8 +19,6 @@
 
 #include <memory>
 
-#include "Kokkos_Random.hpp"
-
 #include <parthenon/driver.hpp>
 #include <parthenon/package.hpp>
 
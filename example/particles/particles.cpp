@@ -12,6 +12,10 @@
 //========================================================================================
 
 #include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
 #include <limits>
 #include <memory>
 #include <string>
@@ -34,7 +38,7 @@ Packages_t ProcessPackages(std::unique_ptr<ParameterInput> &pin) {
   return packages;
 }
 
-enum class DepositionMethod { per_particle, per_cell };
+enum class DepositionMethod { per_particle, per_cell, shape };
 
 // *************************************************//
 // define the "physics" package particles_package, *//
@@ -68,19 +72,27 @@ std::shared_ptr<StateDescriptor> Initialize(ParameterInput *pin) {
     pkg->AddParam<>("deposition_method", DepositionMethod::per_particle);
   } else if (deposition_method == "per_cell") {
     pkg->AddParam<>("deposition_method", DepositionMethod::per_cell);
+  } else if (deposition_method == "shape") {
+    pkg->AddParam<>("deposition_method", DepositionMethod::shape);
   } else {
     PARTHENON_THROW("deposition method not recognized");
   }
 
+  // Only used by the shape deposition, which deposits densities instead of weights
+  pkg->AddParam<>("deposition_shape",
+                  DepositionShapeFromString(
+                      pin->GetOrAddString("Particles", "deposition_shape", "cic")));
+
   bool orbiting_particles =
       pin->GetOrAddBoolean("Particles", "orbiting_particles", false);
   pkg->AddParam<>("orbiting_particles", orbiting_particles);
 
-  // Initialize random number generator pool
+  // Initialize counter-based random number streams, one for creating and one for
+  // destroying particles
   int rng_seed = pin->GetInteger("Particles", "rng_seed");
   pkg->AddParam<>("rng_seed", rng_seed);
-  RNGPool rng_pool(rng_seed);
-  pkg->AddParam<>("rng_pool", rng_pool);
+  pkg->AddParam<>("rng_create", RandomStreams(rng_seed, 0));
+  pkg->AddParam<>("rng_destroy", RandomStreams(rng_seed, 1));
 
   std::string swarm_name = "my_particles";
   Metadata swarm_metadata({Metadata::Provides, Metadata::None});
@@ -118,12 +130,13 @@ Real EstimateTimestepBlock(MeshBlockData<Real> *rc) {
 // *************************************************//
 // first some helper tasks
 
-TaskStatus DestroySomeParticles(MeshBlock *pmb) {
+TaskStatus DestroySomeParticles(MeshBlock *pmb, const int ncycle) {
   PARTHENON_INSTRUMENT
 
   auto pkg = pmb->packages.Get("particles_package");
   auto swarm = pmb->meshblock_data.Get()->GetSwarmData()->Get("my_particles");
-  auto rng_pool = pkg->Param<RNGPool>("rng_pool");
+  auto rng_streams = pkg->Param<RandomStreams>("rng_destroy");
+  const int gid = pmb->gid;
   const auto destroy_particles_frac = pkg->Param<Real>("destroy_particles_frac");
 
   // The swarm mask is managed internally and should always be treated as constant. This
@@ -134,11 +147,10 @@ TaskStatus DestroySomeParticles(MeshBlock *pmb) {
   pmb->par_for(
       PARTHENON_AUTO_LABEL, 0, swarm->GetMaxActiveIndex(), KOKKOS_LAMBDA(const int n) {
         if (swarm_d.IsActive(n)) {
-          auto rng_gen = rng_pool.get_state();
+          auto rng_gen = rng_streams.Get(gid, n, ncycle);
           if (rng_gen.drand() > 1.0 - destroy_particles_frac) {
             swarm_d.MarkParticleForRemoval(n);
           }
-          rng_pool.free_state(rng_gen);
         }
       });
 
@@ -166,6 +178,11 @@ TaskStatus DepositParticles(MeshBlock *pmb) {
 
   auto pkg = pmb->packages.Get("particles_package");
   const auto deposition_method = pkg->Param<DepositionMethod>("deposition_method");
+  if (deposition_method == DepositionMethod::shape) {
+    parthenon::DepositParticles(swarm.get(), "weight", "particle_deposition",
+                                pkg->Param<DepositionShape>("deposition_shape"));
+    return TaskStatus::complete;
+  }
 
   // Meshblock geometry
   const IndexRange &ib = pmb->cellbounds.GetBoundsI(IndexDomain::interior);
@@ -229,12 +246,13 @@ TaskStatus DepositParticles(MeshBlock *pmb) {
   return TaskStatus::complete;
 }
 
-TaskStatus CreateSomeParticles(MeshBlock *pmb, const double t0) {
+TaskStatus CreateSomeParticles(MeshBlock *pmb, const double t0, const int ncycle) {
   PARTHENON_INSTRUMENT
 
   auto pkg = pmb->packages.Get("particles_package");
   auto swarm = pmb->meshblock_data.Get()->GetSwarmData()->Get("my_particles");
-  auto rng_pool = pkg->Param<RNGPool>("rng_pool");
+  auto rng_streams = pkg->Param<RandomStreams>("rng_create");
+  const int gid = pmb->gid;
   auto num_particles = pkg->Param<int>("num_particles");
   auto vel = pkg->Param<Real>("particle_speed");
   const auto orbiting_particles = pkg->Param<bool>("orbiting_particles");
@@ -270,7 +288,7 @@ TaskStatus CreateSomeParticles(MeshBlock *pmb, const double t0) {
         PARTHENON_AUTO_LABEL, 0, newParticlesContext.GetNewParticlesMaxIndex(),
         KOKKOS_LAMBDA(const int new_n) {
           const int n = newParticlesContext.GetNewParticleIndex(new_n);
-          auto rng_gen = rng_pool.get_state();
+          auto rng_gen = rng_streams.Get(gid, new_n, ncycle);
 
           // Randomly sample in space in this meshblock while staying within 0.5 of
           // origin
@@ -306,15 +324,13 @@ TaskStatus CreateSomeParticles(MeshBlock *pmb, const double t0) {
           t(n) = t0;
 
           weight(n) = 1.0;
-
-          rng_pool.free_state(rng_gen);
         });
   } else {
     pmb->par_for(
         PARTHENON_AUTO_LABEL, 0, newParticlesContext.GetNewParticlesMaxIndex(),
         KOKKOS_LAMBDA(const int new_n) {
           const int n = newParticlesContext.GetNewParticleIndex(new_n);
-          auto rng_gen = rng_pool.get_state();
+          auto rng_gen = rng_streams.Get(gid, new_n, ncycle);
 
           // Randomly sample in space in this meshblock
           x(n) = minx_i + nx_i * dx_i * rng_gen.drand();
@@ -332,8 +348,6 @@ TaskStatus CreateSomeParticles(MeshBlock *pmb, const double t0) {
           t(n) = t0;
 
           weight(n) = 1.0;
-
-          rng_pool.free_state(rng_gen);
         });
   }
 
@@ -466,6 +480,58 @@ TaskStatus TransportParticles(MeshBlock *pmb, const StagedIntegrator *integrator
   return TaskStatus::complete;
 }
 
+namespace {
+// Runs the task f(args...) and adds its wall time to time. The device is fenced, so that
+// the time includes the kernels launched by f.
+template <class F, class... Args>
+TaskStatus Timed(double *time, F f, Args... args) {
+  Kokkos::Timer timer;
+  const TaskStatus status = std::invoke(f, args...);
+  Kokkos::fence();
+  *time += timer.seconds();
+  return status;
+}
+
+// Adds the task f(args...), which is timed with Timed unless time is null
+template <class F, class... Args>
+TaskID AddTimedTask(TaskList &tl, TaskID dependence, double *time, F f, Args... args) {
+  if (time == nullptr) return tl.AddTask(dependence, f, args...);
+  return tl.AddTask(dependence, &Timed<F, Args...>, time, f, args...);
+}
+
+// Counts the particles of a block that the next transport task pushes
+TaskStatus CountPushes(MeshBlock *pmb, ParticleBenchmark *benchmark) {
+  auto swarm = pmb->meshblock_data.Get()->GetSwarmData()->Get("my_particles");
+  benchmark->pushes += swarm->GetNumActive();
+  return TaskStatus::complete;
+}
+
+// Counts the particles that the last send of a block sent to its neighbors
+TaskStatus CountSentParticles(MeshBlock *pmb, ParticleBenchmark *benchmark) {
+  auto swarm = pmb->meshblock_data.Get()->GetSwarmData()->Get("my_particles");
+  const int particle_size = swarm->vbswarm->particle_size;
+  if (particle_size == 0) return TaskStatus::complete;
+  for (const auto &nb : pmb->neighbors) {
+    const std::int64_t sent = swarm->vbswarm->send_size[nb.bufid] / particle_size;
+    if (nb.rank == Globals::my_rank) {
+      benchmark->sent_local += sent;
+    } else {
+      benchmark->sent_nonlocal += sent;
+    }
+  }
+  return TaskStatus::complete;
+}
+
+// Counts the steps in which the pool of a block grew
+TaskStatus CountPoolGrowth(MeshBlock *pmb, ParticleBenchmark *benchmark) {
+  auto swarm = pmb->meshblock_data.Get()->GetSwarmData()->Get("my_particles");
+  const int pool_max = swarm->GetPoolMax();
+  benchmark->pool_growths += pool_max > benchmark->pool_max;
+  benchmark->pool_max = pool_max;
+  return TaskStatus::complete;
+}
+} // namespace
+
 // Custom step function to allow for looping over MPI-related tasks until complete
 TaskListStatus ParticleDriver::Step() {
   TaskListStatus status;
@@ -474,6 +540,22 @@ TaskListStatus ParticleDriver::Step() {
   BlockList_t &blocks = pmesh->block_list;
   auto num_task_lists_executed_independently = blocks.size();
 
+  // The measurements of the benchmark start after the warmup steps, keeping the pool
+  // sizes to detect growth
+  if (benchmark_ &&
+      (tm.ncycle <= benchmark_warmup_ || block_benchmarks_.size() != blocks.size())) {
+    block_benchmarks_.resize(blocks.size());
+    for (auto &benchmark : block_benchmarks_) {
+      ParticleBenchmark reset;
+      reset.pool_max = benchmark.pool_max;
+      benchmark = reset;
+    }
+    benchmark_wall_ = 0.0;
+    benchmark_steps_ = 0;
+    benchmark_comm_rounds_ = 0;
+  }
+  Kokkos::Timer timer;
+
   // Create all the particles that will be created during the step
   status = MakeParticlesCreationTaskCollection().Execute();
 
@@ -483,6 +565,7 @@ TaskListStatus ParticleDriver::Step() {
   bool particles_update_done = false;
   while (!particles_update_done) {
     status = MakeParticlesUpdateTaskCollection().Execute();
+    benchmark_comm_rounds_++;
 
     particles_update_done = true;
     for (auto &block : blocks) {
@@ -498,9 +581,74 @@ TaskListStatus ParticleDriver::Step() {
   // Use a more traditional task list for predictable post-MPI evaluations.
   status = MakeFinalizationTaskCollection().Execute();
 
+  if (benchmark_) {
+    Kokkos::fence();
+    benchmark_wall_ += timer.seconds();
+    benchmark_steps_++;
+  }
   return status;
 }
 
+void ParticleDriver::PostExecute(DriverStatus status) {
+  if (benchmark_) ReportBenchmark();
+  EvolutionDriver::PostExecute(status);
+}
+
+// Collective, as the measurements are reduced over all ranks
+void ParticleDriver::ReportBenchmark() {
+  if (benchmark_steps_ == 0) return;
+  // Summed over the ranks: the particles pushed, sent to blocks on the same and on other
+  // ranks, the pool growths, the active particles and the pool sizes at the end, and the
+  // number of blocks
+  std::array<double, 7> sums{};
+  // Maximum over the ranks: the push, communication, sort, defrag, and step times
+  std::array<double, 5> maxs{};
+  for (int b = 0; b < block_benchmarks_.size(); b++) {
+    const auto &benchmark = block_benchmarks_[b];
+    auto swarm =
+        pmesh->block_list[b]->meshblock_data.Get()->GetSwarmData()->Get("my_particles");
+    sums[0] += benchmark.pushes;
+    sums[1] += benchmark.sent_local;
+    sums[2] += benchmark.sent_nonlocal;
+    sums[3] += benchmark.pool_growths;
+    sums[4] += swarm->GetNumActive();
+    sums[5] += swarm->GetPoolMax();
+    sums[6] += 1;
+    maxs[0] += benchmark.push;
+    maxs[1] += benchmark.comm;
+    maxs[2] += benchmark.sort;
+    maxs[3] += benchmark.defrag;
+  }
+  maxs[4] = benchmark_wall_;
+#ifdef MPI_PARALLEL
+  PARTHENON_MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, sums.data(), sums.size(), MPI_DOUBLE,
+                                    MPI_SUM, MPI_COMM_WORLD));
+  PARTHENON_MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, maxs.data(), maxs.size(), MPI_DOUBLE,
+                                    MPI_MAX, MPI_COMM_WORLD));
+#endif
+  if (Globals::my_rank != 0) return;
+
+  const double nsteps = benchmark_steps_;
+  const double wall = maxs[4];
+  printf("Particle benchmark\n");
+  printf("  ranks: %i, blocks: %i, steps: %i after %i warmup steps, "
+         "transport rounds per step: %.2f\n",
+         Globals::nranks, static_cast<int>(sums[6]), benchmark_steps_, benchmark_warmup_,
+         benchmark_comm_rounds_ / nsteps);
+  printf("  particles at the end: %.3e, pool occupancy: %.1f%%, pool growths per block "
+         "and step: %.3e\n",
+         sums[4], 100.0 * sums[4] / std::max(sums[5], 1.0), sums[3] / sums[6] / nsteps);
+  printf("  pushes/s: %.3e of the push kernels, %.3e of the steps\n",
+         sums[0] / std::max(maxs[0], 1.0e-30), sums[0] / wall);
+  printf("  particles sent per step: %.3e within ranks, %.3e across ranks "
+         "(%.3e and %.3e per s)\n",
+         sums[1] / nsteps, sums[2] / nsteps, sums[1] / wall, sums[2] / wall);
+  printf("  time per step [s]: %.3e, push %.3e, communication %.3e, sort %.3e, "
+         "defrag %.3e\n",
+         wall / nsteps, maxs[0] / nsteps, maxs[1] / nsteps, maxs[2] / nsteps,
+         maxs[3] / nsteps);
+}
+
 // TODO(BRR) This should really be in parthenon/src... but it can't just live in Swarm
 // because of the loop over blocks
 TaskStatus StopCommunicationMesh(const BlockList_t &blocks) {
@@ -571,13 +719,14 @@ TaskCollection ParticleDriver::MakeParticlesCreationTaskCollection() const {
   for (int i = 0; i < blocks.size(); i++) {
     auto &pmb = blocks[i];
     auto &tl = async_region0[i];
-    auto create_some_particles = tl.AddTask(none, CreateSomeParticles, pmb.get(), t0);
+    auto create_some_particles =
+        tl.AddTask(none, CreateSomeParticles, pmb.get(), t0, tm.ncycle);
   }
 
   return tc;
 }
 
-TaskCollection ParticleDriver::MakeParticlesUpdateTaskCollection() const {
+TaskCollection ParticleDriver::MakeParticlesUpdateTaskCollection() {
   TaskCollection tc;
   TaskID none(0);
   const double t0 = tm.time;
@@ -592,26 +741,44 @@ TaskCollection ParticleDriver::MakeParticlesUpdateTaskCollection() const {
     auto &sc = pmb->meshblock_data.Get()->GetSwarmData();
 
     auto &tl = async_region0[i];
+    auto *benchmark = benchmark_ ? &block_benchmarks_[i] : nullptr;
 
+    auto count_pushes = none;
+    if (benchmark) count_pushes = tl.AddTask(none, CountPushes, pmb.get(), benchmark);
     auto transport_particles =
-        tl.AddTask(none, TransportParticles, pmb.get(), &integrator, t0);
+        AddTimedTask(tl, count_pushes, benchmark ? &benchmark->push : nullptr,
+                     TransportParticles, pmb.get(), &integrator, t0);
 
-    auto send = tl.AddTask(transport_particles, &SwarmContainer::Send, sc.get(),
-                           BoundaryCommSubset::all);
+    auto send = AddTimedTask(tl, transport_particles,
+                             benchmark ? &benchmark->comm : nullptr,
+                             &SwarmContainer::Send, sc.get(), BoundaryCommSubset::all);
+    if (benchmark) send = tl.AddTask(send, CountSentParticles, pmb.get(), benchmark);
     auto receive =
-        tl.AddTask(send, &SwarmContainer::Receive, sc.get(), BoundaryCommSubset::all);
+        AddTimedTask(tl, send, benchmark ? &benchmark->comm : nullptr,
+                     &SwarmContainer::Receive, sc.get(), BoundaryCommSubset::all);
   }
 
   TaskRegion &sync_region0 = tc.AddRegion(1);
   {
     auto &tl = sync_region0[0];
-    auto stop_comm = tl.AddTask(none, StopCommunicationMesh, blocks);
+    // The global reduction of the rank is counted with its first block
+    auto *benchmark =
+        benchmark_ && !blocks.empty() ? &block_benchmarks_[0].comm : nullptr;
+    auto stop_comm = AddTimedTask(tl, none, benchmark, StopCommunicationMesh, blocks);
   }
 
   return tc;
 }
 
-TaskCollection ParticleDriver::MakeFinalizationTaskCollection() const {
+TaskStatus AccumulateDepositionGhostZones(Mesh *pmesh) {
+  auto pkg = pmesh->packages.Get("particles_package");
+  if (pkg->Param<DepositionMethod>("deposition_method") == DepositionMethod::shape) {
+    AccumulateGhostZones(pmesh, "particle_deposition");
+  }
+  return TaskStatus::complete;
+}
+
+TaskCollection ParticleDriver::MakeFinalizationTaskCollection() {
   TaskCollection tc;
   TaskID none(0);
   BlockList_t &blocks = pmesh->block_list;
@@ -624,22 +791,31 @@ TaskCollection ParticleDriver::MakeFinalizationTaskCollection() const {
     auto &sc = pmb->meshblock_data.Get()->GetSwarmData();
     auto &sc1 = pmb->meshblock_data.Get();
     auto &tl = async_region1[i];
+    auto *benchmark = benchmark_ ? &block_benchmarks_[i] : nullptr;
 
-    auto destroy_some_particles = tl.AddTask(none, DestroySomeParticles, pmb.get());
+    auto destroy_some_particles =
+        tl.AddTask(none, DestroySomeParticles, pmb.get(), tm.ncycle);
 
-    auto sort_particles = tl.AddTask(destroy_some_particles,
-                                     SortParticlesIfUsingPerCellDeposition, pmb.get());
+    auto sort_particles =
+        AddTimedTask(tl, destroy_some_particles, benchmark ? &benchmark->sort : nullptr,
+                     SortParticlesIfUsingPerCellDeposition, pmb.get());
 
     auto deposit_particles = tl.AddTask(sort_particles, DepositParticles, pmb.get());
 
     // Defragment if swarm memory pool occupancy is 90%
-    auto defrag = tl.AddTask(deposit_particles, &SwarmContainer::Defrag, sc.get(), 0.9);
+    auto defrag =
+        AddTimedTask(tl, deposit_particles, benchmark ? &benchmark->defrag : nullptr,
+                     &SwarmContainer::Defrag, sc.get(), 0.9);
+    if (benchmark) tl.AddTask(defrag, CountPoolGrowth, pmb.get(), benchmark);
 
     // estimate next time step
     auto new_dt = tl.AddTask(
         defrag, parthenon::Update::EstimateTimestep<MeshBlockData<Real>>, sc1.get());
   }
 
+  TaskRegion &sync_region = tc.AddRegion(1);
+  sync_region[0].AddTask(none, AccumulateDepositionGhostZones, pmesh);
+
   return tc;
 }
 
@@ -13,9 +13,9 @@
 #ifndef EXAMPLE_PARTICLES_PARTICLES_HPP_
 #define EXAMPLE_PARTICLES_PARTICLES_HPP_
 
+#include <cstdint>
 #include <memory>
-
-#include "Kokkos_Random.hpp"
+#include <vector>
 
 #include <parthenon/driver.hpp>
 #include <parthenon/package.hpp>
@@ -26,19 +26,44 @@ using namespace parthenon;
 
 namespace particles_example {
 
-typedef Kokkos::Random_XorShift64_Pool<> RNGPool;
+// Measurements of the benchmark mode on one block, see <Particles>/benchmark. The times
+// are wall times of the tasks, which are fenced in the benchmark mode.
+struct ParticleBenchmark {
+  double push = 0.0, comm = 0.0, sort = 0.0, defrag = 0.0; // [s]
+  std::int64_t pushes = 0;        // particles passed to the push, once per round
+  std::int64_t sent_local = 0;    // particles sent to blocks on the same rank
+  std::int64_t sent_nonlocal = 0; // particles sent to blocks on other ranks
+  std::int64_t pool_growths = 0;  // steps at the end of which the pool was larger
+  int pool_max = 0;               // pool size at the end of the last step
+};
 
 class ParticleDriver : public EvolutionDriver {
  public:
   ParticleDriver(ParameterInput *pin, ApplicationInput *app_in, Mesh *pm)
-      : EvolutionDriver(pin, app_in, pm), integrator(pin) {}
+      : EvolutionDriver(pin, app_in, pm), integrator(pin) {
+    benchmark_ = pin->GetOrAddBoolean("Particles", "benchmark", false);
+    benchmark_warmup_ = pin->GetOrAddInteger("Particles", "benchmark_warmup", 1);
+  }
   TaskCollection MakeParticlesCreationTaskCollection() const;
-  TaskCollection MakeParticlesUpdateTaskCollection() const;
-  TaskCollection MakeFinalizationTaskCollection() const;
+  TaskCollection MakeParticlesUpdateTaskCollection();
+  TaskCollection MakeFinalizationTaskCollection();
   TaskListStatus Step();
 
+ protected:
+  void PostExecute(DriverStatus status) override;
+
  private:
   LowStorageIntegrator integrator;
+
+  // Particle throughput, communication, and pool statistics of the steps after the
+  // warmup, by block. Collected with <Particles>/benchmark = true and reported at the
+  // end of the run.
+  bool benchmark_;
+  int benchmark_warmup_;
+  std::vector<ParticleBenchmark> block_benchmarks_;
+  double benchmark_wall_ = 0.0; // [s]
+  int benchmark_steps_ = 0, benchmark_comm_rounds_ = 0;
+  void ReportBenchmark();
 };
 
 Packages_t ProcessPackages(std::unique_ptr<ParameterInput> &pin);
@@ -12,8 +12,11 @@
 //========================================================================================
 
 #include <algorithm>
+#include <array>
+#include <cstdio>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 // Local Includes
@@ -29,6 +32,7 @@
 #include "prolong_restrict/prolong_restrict.hpp"
 #include "solvers/bicgstab_solver.hpp"
 #include "solvers/mg_solver.hpp"
+#include "solvers/pipelined_cg_solver.hpp"
 
 using namespace parthenon::driver::prelude;
 
@@ -39,7 +43,11 @@ parthenon::DriverStatus PoissonDriver::Execute() {
   using namespace poisson_package;
 
   pouts->MakeOutputs(pmesh, pinput);
-  ConstructAndExecuteTaskLists<>(this);
+  if (pinput->GetOrAddBoolean("poisson", "benchmark", false)) {
+    RunBenchmark();
+  } else {
+    ConstructAndExecuteTaskLists<>(this);
+  }
   pouts->MakeOutputs(pmesh, pinput);
 
   // After running, retrieve the final residual for checking in tests
@@ -50,6 +58,11 @@ parthenon::DriverStatus PoissonDriver::Execute() {
         pkg->MutableParam<parthenon::solvers::BiCGSTABSolver<u, rhs, PoissonEquation>>(
             "MGBiCGSTABsolver");
     final_rms_residual = bicgstab_solver->GetFinalResidual();
+  } else if (solver == "PCG") {
+    auto *pcg_solver =
+        pkg->MutableParam<parthenon::solvers::PipelinedCGSolver<u, rhs, PoissonEquation>>(
+            "MGPCGsolver");
+    final_rms_residual = pcg_solver->GetFinalResidual();
   } else if (solver == "MG") {
     auto *mg_solver =
         pkg->MutableParam<parthenon::solvers::MGSolver<u, rhs, PoissonEquation>>(
@@ -60,6 +73,114 @@ parthenon::DriverStatus PoissonDriver::Execute() {
   return DriverStatus::complete;
 }
 
+void PoissonDriver::RunBenchmark() {
+  using namespace parthenon;
+  using namespace poisson_package;
+  using mg_solver_t = solvers::MGSolver<u, rhs, PoissonEquation>;
+  auto pkg = pmesh->packages.Get("poisson_package");
+  PARTHENON_REQUIRE_THROWS(pkg->Param<std::string>("solver") == "MG",
+                           "The Poisson benchmark requires solver = MG");
+  auto *mg_solver = pkg->MutableParam<mg_solver_t>("MGsolver");
+  const int nsolves = pinput->GetOrAddInteger("poisson", "nsolves", 10);
+  // Time per V-cycle of a run on one rank with the same number of cells per rank
+  const Real reference_time = pinput->GetOrAddReal("poisson", "reference_time", 0.0);
+  const std::string json_file = pinput->GetOrAddString("poisson", "json_file", "");
+  PARTHENON_REQUIRE_THROWS(nsolves > 0, "nsolves must be positive");
+
+  // The first solve builds the hierarchy, buffers, and caches
+  mg_solver->TimePhases(false);
+  ConstructAndExecuteTaskLists<>(this);
+
+  // The solves without phase timers give the time per V-cycle, since the timers fence,
+  // and the same number of solves with the timers its breakdown
+  auto solve = [&]() {
+    int vcycles = 0;
+    Kokkos::fence();
+#ifdef MPI_PARALLEL
+    PARTHENON_MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+#endif
+    Kokkos::Timer timer;
+    for (int n = 0; n < nsolves; ++n) {
+      ConstructAndExecuteTaskLists<>(this);
+      vcycles += mg_solver->GetFinalIterations();
+    }
+    Kokkos::fence();
+#ifdef MPI_PARALLEL
+    PARTHENON_MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+#endif
+    return std::make_pair(timer.seconds(), std::max(vcycles, 1));
+  };
+  const auto [wall, vcycles] = solve();
+  mg_solver->TimePhases(true);
+  mg_solver->ClearPhaseTimes();
+  const auto [timed_wall, timed_vcycles] = solve();
+  mg_solver->TimePhases(false);
+
+  // Maximum over the ranks of the phase times on every level
+  constexpr int nphases = mg_solver_t::nphases;
+  const int min_level = pmesh->GetGMGMinLevel();
+  const int nlevels = pmesh->GetGMGMaxLevel() - min_level + 1;
+  std::vector<double> times(nlevels * nphases, 0.0);
+  for (const auto &[level, level_times] : mg_solver->GetPhaseTimes()) {
+    for (int p = 0; p < nphases; ++p)
+      times[(level - min_level) * nphases + p] = level_times[p] / timed_vcycles;
+  }
+#ifdef MPI_PARALLEL
+  PARTHENON_MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, times.data(), times.size(), MPI_DOUBLE,
+                                    MPI_MAX, MPI_COMM_WORLD));
+#endif
+  if (Globals::my_rank != 0) return;
+
+  const double per_vcycle = wall / vcycles;
+  const double cells_per_rank =
+      static_cast<double>(pmesh->GetTotalCells()) / Globals::nranks;
+  const double efficiency = reference_time > 0.0 ? reference_time / per_vcycle : 0.0;
+  const std::array<const char *, nphases> names{"smoothing", "restriction",
+                                                "prolongation", "boundary_exchange",
+                                                "coarse_solve"};
+  printf("Poisson multigrid benchmark\n");
+  printf("  ranks: %i, cells per rank: %.0f, levels: %i\n", Globals::nranks,
+         cells_per_rank, nlevels);
+  printf("  solves: %i, V-cycles to tolerance: %i, final residual: %e\n", nsolves,
+         mg_solver->GetFinalIterations(), mg_solver->GetFinalResidual());
+  printf("  wall time per V-cycle: %.3e s", per_vcycle);
+  if (reference_time > 0.0) printf(", weak scaling efficiency: %.3f", efficiency);
+  printf("\n  phase times per V-cycle [s], maximum over the ranks, with timers "
+         "%.3e s per V-cycle:\n",
+         timed_wall / timed_vcycles);
+  printf("  level");
+  for (const char *name : names)
+    printf("  %17s", name);
+  printf("\n");
+  for (int l = nlevels - 1; l >= 0; --l) {
+    printf("  %5i", l + min_level);
+    for (int p = 0; p < nphases; ++p)
+      printf("  %17.3e", times[l * nphases + p]);
+    printf("\n");
+  }
+
+  if (json_file.empty()) return;
+  std::FILE *json = std::fopen(json_file.c_str(), "w");
+  PARTHENON_REQUIRE_THROWS(json != nullptr, "Failed to open " + json_file);
+  fprintf(json, "{\n  \"ranks\": %i,\n  \"cells_per_rank\": %.0f,\n", Globals::nranks,
+          cells_per_rank);
+  fprintf(json, "  \"solves\": %i,\n  \"vcycles_to_tolerance\": %i,\n", nsolves,
+          mg_solver->GetFinalIterations());
+  fprintf(json, "  \"final_residual\": %.6e,\n  \"time_per_vcycle\": %.6e,\n",
+          mg_solver->GetFinalResidual(), per_vcycle);
+  if (reference_time > 0.0)
+    fprintf(json, "  \"weak_scaling_efficiency\": %.6f,\n", efficiency);
+  fprintf(json, "  \"levels\": [");
+  for (int l = nlevels - 1; l >= 0; --l) {
+    fprintf(json, "%s\n    {\"level\": %i", l == nlevels - 1 ? "" : ",", l + min_level);
+    for (int p = 0; p < nphases; ++p)
+      fprintf(json, ", \"%s\": %.6e", names[p], times[l * nphases + p]);
+    fprintf(json, "}");
+  }
+  fprintf(json, "\n  ]\n}\n");
+  std::fclose(json);
+}
+
 TaskCollection PoissonDriver::MakeTaskCollection(BlockList_t &blocks) {
   using namespace parthenon;
   using namespace poisson_package;
@@ -76,6 +197,9 @@ TaskCollection PoissonDriver::MakeTaskCollection(BlockList_t &blocks) {
   auto *bicgstab_solver =
       pkg->MutableParam<parthenon::solvers::BiCGSTABSolver<u, rhs, PoissonEquation>>(
           "MGBiCGSTABsolver");
+  auto *pcg_solver =
+      pkg->MutableParam<parthenon::solvers::PipelinedCGSolver<u, rhs, PoissonEquation>>(
+          "MGPCGsolver");
 
   auto partitions = pmesh->GetDefaultBlockPartitions();
   const int num_partitions = partitions.size();
@@ -102,6 +226,9 @@ TaskCollection PoissonDriver::MakeTaskCollection(BlockList_t &blocks) {
     if (solver == "BiCGSTAB") {
       auto setup = bicgstab_solver->AddSetupTasks(tl, zero_u, i, pmesh);
       solve = bicgstab_solver->AddTasks(tl, setup, pmesh, i);
+    } else if (solver == "PCG") {
+      auto setup = pcg_solver->AddSetupTasks(tl, zero_u, i, pmesh);
+      solve = pcg_solver->AddTasks(tl, setup, pmesh, i);
     } else if (solver == "MG") {
       auto setup = mg_solver->AddSetupTasks(tl, zero_u, i, pmesh);
       solve = mg_solver->AddTasks(tl, setup, pmesh, i);
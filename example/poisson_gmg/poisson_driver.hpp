@@ -38,6 +38,9 @@ class PoissonDriver : public Driver {
   Real final_rms_error, final_rms_residual;
 
  private:
+  // Times the V-cycles of repeated multigrid solves, see <poisson>/benchmark
+  void RunBenchmark();
+
   // Necessary reductions for checking error from exact solution
   AllReduce<Real> err;
 };
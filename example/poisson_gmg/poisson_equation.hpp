@@ -20,6 +20,7 @@
 
 #include <kokkos_abstraction.hpp>
 #include <parthenon/package.hpp>
+#include <solvers/solver_utils.hpp>
 
 #include "poisson_package.hpp"
 
@@ -101,6 +102,130 @@ class PoissonEquation {
     return TaskStatus::complete;
   }
 
+  // Matrix-free version of Ax for a single cell, which MGSolver uses to fuse the
+  // matrix application with its smoother. It skips the flux correction, just as Ax on
+  // two_level_composite grids, which are the only grids multigrid smooths on.
+  template <class x_t>
+  struct Stencil {
+    parthenon::SparsePack<x_t, D> pack;
+    Real alpha;
+    int ndim;
+
+    KOKKOS_INLINE_FUNCTION Real operator()(const int b, const int c, const int k,
+                                           const int j, const int i) const {
+      using TE = parthenon::TopologicalElement;
+      const auto &coords = pack.GetCoordinates(b);
+      const Real x0 = pack(b, TE::CC, x_t(c), k, j, i);
+      Real ax = -alpha * x0;
+      Real dx1 = coords.template Dxc<X1DIR>(k, j, i);
+      ax += (pack(b, TE::F1, D(), k, j, i) * (pack(b, TE::CC, x_t(c), k, j, i - 1) - x0) -
+             pack(b, TE::F1, D(), k, j, i + 1) *
+                 (x0 - pack(b, TE::CC, x_t(c), k, j, i + 1))) /
+            (dx1 * dx1);
+      if (ndim > 1) {
+        Real dx2 = coords.template Dxc<X2DIR>(k, j, i);
+        ax +=
+            (pack(b, TE::F2, D(), k, j, i) * (pack(b, TE::CC, x_t(c), k, j - 1, i) - x0) -
+             pack(b, TE::F2, D(), k, j + 1, i) *
+                 (x0 - pack(b, TE::CC, x_t(c), k, j + 1, i))) /
+            (dx2 * dx2);
+      }
+      if (ndim > 2) {
+        Real dx3 = coords.template Dxc<X3DIR>(k, j, i);
+        ax +=
+            (pack(b, TE::F3, D(), k, j, i) * (pack(b, TE::CC, x_t(c), k - 1, j, i) - x0) -
+             pack(b, TE::F3, D(), k + 1, j, i) *
+                 (x0 - pack(b, TE::CC, x_t(c), k + 1, j, i))) /
+            (dx3 * dx3);
+      }
+      return ax;
+    }
+  };
+
+  template <class x_t>
+  Stencil<x_t> AxStencil(std::shared_ptr<parthenon::MeshData<Real>> &md,
+                         std::vector<bool> &include_block) {
+    auto pkg = md->GetMeshPointer()->packages.Get("poisson_package");
+    static auto desc = parthenon::MakePackDescriptor<x_t, D>(md.get());
+    return Stencil<x_t>{desc.GetPack(md.get(), include_block),
+                        pkg->Param<Real>("diagonal_alpha"), md->GetMeshPointer()->ndim};
+  }
+
+  // Coefficients of A coupling every cell to its neighbors in direction dir, which the
+  // line smoothers of MGSolver solve for exactly along the lines in that direction
+  template <class lo_t, class up_t>
+  parthenon::TaskStatus
+  SetLineCoefficients(std::shared_ptr<parthenon::MeshData<Real>> &md, int dir) {
+    using namespace parthenon;
+    using TE = parthenon::TopologicalElement;
+    TE te = TE::CC;
+    IndexRange ib = md->GetBoundsI(IndexDomain::interior, te);
+    IndexRange jb = md->GetBoundsJ(IndexDomain::interior, te);
+    IndexRange kb = md->GetBoundsK(IndexDomain::interior, te);
+    const TE face = dir == X1DIR ? TE::F1 : (dir == X2DIR ? TE::F2 : TE::F3);
+    const int di = dir == X1DIR;
+    const int dj = dir == X2DIR;
+    const int dk = dir == X3DIR;
+
+    auto desc = parthenon::MakePackDescriptor<lo_t, up_t, D>(md.get());
+    auto pack = desc.GetPack(md.get());
+    parthenon::par_for(
+        "SetLineCoefficients", 0, pack.GetNBlocks() - 1, kb.s, kb.e, jb.s, jb.e, ib.s,
+        ib.e, KOKKOS_LAMBDA(const int b, const int k, const int j, const int i) {
+          const auto &coords = pack.GetCoordinates(b);
+          const Real dx = coords.DxcFA(dir, k, j, i);
+          pack(b, te, lo_t(), k, j, i) = pack(b, face, D(), k, j, i) / (dx * dx);
+          pack(b, te, up_t(), k, j, i) =
+              pack(b, face, D(), k + dk, j + dj, i + di) / (dx * dx);
+        });
+    return TaskStatus::complete;
+  }
+
+  // Coefficients of A in the stencil_t components of a 7- or 27-point stencil (see
+  // parthenon::solvers::utils::StencilOffset) for MGSolver with stored stencils. The
+  // discretization only couples face neighbors, so other points of a 27-point stencil
+  // are zero.
+  template <class stencil_t>
+  parthenon::TaskStatus SetStencil(std::shared_ptr<parthenon::MeshData<Real>> &md,
+                                   int npoints) {
+    using namespace parthenon;
+    using parthenon::solvers::utils::StencilIndex;
+    const int ndim = md->GetMeshPointer()->ndim;
+    using TE = parthenon::TopologicalElement;
+    TE te = TE::CC;
+    IndexRange ib = md->GetBoundsI(IndexDomain::interior, te);
+    IndexRange jb = md->GetBoundsJ(IndexDomain::interior, te);
+    IndexRange kb = md->GetBoundsK(IndexDomain::interior, te);
+
+    auto pkg = md->GetMeshPointer()->packages.Get("poisson_package");
+    const auto alpha = pkg->Param<Real>("diagonal_alpha");
+
+    auto desc = parthenon::MakePackDescriptor<stencil_t, D>(md.get());
+    auto pack = desc.GetPack(md.get());
+    parthenon::par_for(
+        "SetStencil", 0, pack.GetNBlocks() - 1, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+        KOKKOS_LAMBDA(const int b, const int k, const int j, const int i) {
+          const auto &coords = pack.GetCoordinates(b);
+          for (int n = 0; n < npoints; ++n)
+            pack(b, te, stencil_t(n), k, j, i) = 0.0;
+          Real center = -alpha;
+          for (int dir = X1DIR; dir <= ndim; ++dir) {
+            const TE face = dir == X1DIR ? TE::F1 : (dir == X2DIR ? TE::F2 : TE::F3);
+            const int di = dir == X1DIR;
+            const int dj = dir == X2DIR;
+            const int dk = dir == X3DIR;
+            const Real dx = coords.DxcFA(dir, k, j, i);
+            const Real lo = pack(b, face, D(), k, j, i) / (dx * dx);
+            const Real up = pack(b, face, D(), k + dk, j + dj, i + di) / (dx * dx);
+            pack(b, te, stencil_t(StencilIndex(npoints, -dk, -dj, -di)), k, j, i) = lo;
+            pack(b, te, stencil_t(StencilIndex(npoints, dk, dj, di)), k, j, i) = up;
+            center -= lo + up;
+          }
+          pack(b, te, stencil_t(StencilIndex(npoints, 0, 0, 0)), k, j, i) = center;
+        });
+    return TaskStatus::complete;
+  }
+
   template <class var_t>
   static parthenon::TaskStatus
   CalculateFluxes(std::shared_ptr<parthenon::MeshData<Real>> &md) {
@@ -24,6 +24,7 @@
 #include <parthenon/package.hpp>
 #include <solvers/bicgstab_solver.hpp>
 #include <solvers/mg_solver.hpp>
+#include <solvers/pipelined_cg_solver.hpp>
 #include <solvers/solver_utils.hpp>
 
 #include "defs.hpp"
@@ -108,6 +109,11 @@ std::shared_ptr<StateDescriptor> Initialize(ParameterInput *pin) {
   pkg->AddParam<>("MGBiCGSTABsolver", bicg_solver,
                   parthenon::Params::Mutability::Mutable);
 
+  parthenon::solvers::PipelinedCGParams pcg_params(pin, "poisson/solver_params");
+  parthenon::solvers::PipelinedCGSolver<u, rhs, PoissonEquation> pcg_solver(
+      pkg.get(), pcg_params, eq);
+  pkg->AddParam<>("MGPCGsolver", pcg_solver, parthenon::Params::Mutability::Mutable);
+
   using namespace parthenon::refinement_ops;
   auto mD = Metadata(
       {Metadata::Independent, Metadata::OneCopy, Metadata::Face, Metadata::GMGRestrict});
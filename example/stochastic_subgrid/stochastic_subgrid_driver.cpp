@@ -69,7 +69,7 @@ TaskCollection StochasticSubgridDriver::MakeTaskCollection(BlockList_t &blocks,
     TaskRegion &async_region = tc.AddRegion(num_partitions);
     for (int i = 0; i < num_partitions; i++) {
       auto &md = pmesh->mesh_data.Add("base", partitions[i]);
-      async_region[i].AddTask(none, ComputeNumIter, md, pmesh->packages);
+      async_region[i].AddTask(none, ComputeNumIter, md, pmesh->packages, tm.ncycle);
     }
   }
 
@@ -21,14 +21,13 @@
 #include <string>
 #include <vector>
 
-#include <Kokkos_Random.hpp>
-
 #include <coordinates/coordinates.hpp>
 #include <parthenon/package.hpp>
 
 #include "kokkos_abstraction.hpp"
 #include "reconstruct/dc_inline.hpp"
 #include "utils/alias_method.hpp"
+#include "utils/random.hpp"
 
 using namespace parthenon::package::prelude;
 using namespace parthenon::AliasMethod;
@@ -180,8 +179,8 @@ std::shared_ptr<StateDescriptor> Initialize(ParameterInput *pin) {
     if (seed == 0)
       seed = std::chrono::high_resolution_clock::now().time_since_epoch().count();
 
-    Kokkos::Random_XorShift64_Pool<parthenon::DevExecSpace> rand_pool(seed);
-    pkg->AddParam("random_pool", rand_pool);
+    // counter-based, so there is no generator state to store or move with blocks
+    pkg->AddParam("random_streams", RandomStreams(seed));
   }
 
   // add fields
@@ -244,14 +243,21 @@ AmrTag CheckRefinement(MeshBlockData<Real> *rc) {
 
 // randomly sample an interation number for each cell from the discrete power-law
 // distribution
-TaskStatus ComputeNumIter(std::shared_ptr<MeshData<Real>> &md, Packages_t &packages) {
+TaskStatus ComputeNumIter(std::shared_ptr<MeshData<Real>> &md, Packages_t &packages,
+                          const int ncycle) {
   PARTHENON_INSTRUMENT
 
   auto pack = md->PackVariables(std::vector<std::string>({"num_iter"}));
 
   auto pkg = packages.Get("stochastic_subgrid_package");
-  const auto &pool =
-      pkg->Param<Kokkos::Random_XorShift64_Pool<parthenon::DevExecSpace>>("random_pool");
+  const auto &streams = pkg->Param<RandomStreams>("random_streams");
+
+  // the numbers of a cell only depend on its block, its index, and the cycle
+  parthenon::ParArray1D<int> gids("gids", md->NumBlocks());
+  auto gids_h = gids.GetHostMirror();
+  for (int b = 0; b < md->NumBlocks(); b++)
+    gids_h(b) = md->GetBlockData(b)->GetBlockPointer()->gid;
+  gids.DeepCopy(gids_h);
 
   auto pmb = md->GetBlockData(0)->GetBlockPointer();
   const IndexRange ib = pmb->cellbounds.GetBoundsI(IndexDomain::interior);
@@ -260,15 +266,18 @@ TaskStatus ComputeNumIter(std::shared_ptr<MeshData<Real>> &md, Packages_t &packa
 
   auto alias = pkg->Param<AliasMethod>("alias_method");
   int N_min = pkg->Param<int>("N_min");
+  const int nx1 = pmb->cellbounds.ncellsi(IndexDomain::entire);
+  const int nx2 = pmb->cellbounds.ncellsj(IndexDomain::entire);
+  const int nx3 = pmb->cellbounds.ncellsk(IndexDomain::entire);
 
   par_for(
       parthenon::loop_pattern_mdrange_tag, PARTHENON_AUTO_LABEL,
       parthenon::DevExecSpace(), 0, pack.GetDim(5) - 1, 0, pack.GetDim(4) - 1, kb.s, kb.e,
       jb.s, jb.e, ib.s, ib.e, KOKKOS_LAMBDA(int b, int v, int k, int j, int i) {
-        auto rng = pool.get_state();
+        const int idx = i + nx1 * (j + nx2 * (k + nx3 * v));
+        auto rng = streams.Get(gids(b), idx, ncycle);
         double rand1 = rng.drand();
         double rand2 = rng.drand();
-        pool.free_state(rng);
 
         int num_iter = N_min + alias.Sample(rand1, rand2);
         pack(b, v, k, j, i) = num_iter;
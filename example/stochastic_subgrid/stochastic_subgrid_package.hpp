@@ -24,7 +24,8 @@ using parthenon::Packages_t;
 
 std::shared_ptr<StateDescriptor> Initialize(ParameterInput *pin);
 AmrTag CheckRefinement(MeshBlockData<Real> *rc);
-TaskStatus ComputeNumIter(std::shared_ptr<MeshData<Real>> &md, Packages_t &packages);
+TaskStatus ComputeNumIter(std::shared_ptr<MeshData<Real>> &md, Packages_t &packages,
+                          const int ncycle);
 void DoLotsOfWork(MeshBlockData<Real> *rc);
 Real EstimateTimestepBlock(MeshBlockData<Real> *rc);
 TaskStatus CalculateFluxes(std::shared_ptr<MeshBlockData<Real>> &rc);
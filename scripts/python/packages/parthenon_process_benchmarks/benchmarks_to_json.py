@@ -0,0 +1,56 @@
+# =========================================================================================
+# (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+#
+# This program was produced under U.S. Government contract 89233218CNA000001 for Los
+# Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+# for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+# in the program are reserved by Triad National Security, LLC, and the U.S. Department
+# of Energy/National Nuclear Security Administration. The Government is granted for
+# itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+# license in this material to reproduce, prepare derivative works, distribute copies to
+# the public, perform publicly and display publicly, and to permit others to do so.
+# =========================================================================================
+
+"""
+Convert the XML report of the Catch2 benchmarks in tst/performance, i.e. the output of
+    performance_tests "[performance]" --reporter xml --out benchmarks.xml
+into a flat JSON list with one entry per benchmark for regression tracking. Times are in
+nanoseconds.
+"""
+
+import argparse
+import json
+import xml.etree.ElementTree as ET
+
+
+def collect(node, path, out):
+    for child in node:
+        if child.tag in ("TestCase", "Section"):
+            collect(child, path + [child.get("name")], out)
+        elif child.tag == "BenchmarkResults":
+            entry = {
+                "name": "/".join(path + [child.get("name")]),
+                "samples": int(child.get("samples")),
+                "iterations": int(child.get("iterations")),
+            }
+            for stat in ("mean", "standardDeviation"):
+                s = child.find(stat)
+                if s is not None:
+                    entry[stat] = float(s.get("value"))
+                    entry[stat + "LowerBound"] = float(s.get("lowerBound"))
+                    entry[stat + "UpperBound"] = float(s.get("upperBound"))
+            out.append(entry)
+        else:
+            collect(child, path, out)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("xml", help="Catch2 XML report")
+    parser.add_argument("json", help="Output JSON file")
+    args = parser.parse_args()
+
+    results = []
+    collect(ET.parse(args.xml).getroot(), [], results)
+    with open(args.json, "w") as f:
+        json.dump(results, f, indent=2)
@@ -501,6 +501,34 @@ class phdf:
             print(f"Block id: {ib} with bounds {myibBounds} not found in {other.file}")
         return None  # block index not found
 
+    def _GroupOf(self, variable):
+        """Returns the dataset of the group of a variable and its index in the
+        group in files written with hdf5_group_variables, or None."""
+        info = self.fid["Info"]
+        if variable in self.fid or "GroupedVariables" not in info.attrs:
+            return None
+        labels = list(np.array(info.attrs["GroupedVariables"]).ravel().astype(str))
+        if variable not in labels:
+            return None
+        datasets = np.array(info.attrs["GroupedVariableDatasets"]).ravel().astype(str)
+        dset = self.fid[datasets[labels.index(variable)]]
+        names = list(np.array(dset.attrs["VariableNames"]).ravel().astype(str))
+        return dset, names.index(variable)
+
+    def _ReadVariable(self, variable):
+        """Reads the dataset of a variable, which is a slice of the dataset of
+        its group in files written with hdf5_group_variables."""
+        group = self._GroupOf(variable)
+        if group is None:
+            return self.fid[variable][:]
+        dset, n = group
+        offset = int(np.array(dset.attrs["VariableOffsets"]).ravel()[n])
+        ncomp = int(np.array(dset.attrs["VariableComponents"]).ravel()[n])
+        shapes = np.array(dset.attrs["VariableShapes"]).ravel().astype(str)
+        shape = [int(d) for d in shapes[n].split()]
+        data = dset[:, offset : offset + ncomp, ...]
+        return data.reshape([data.shape[0]] + shape)
+
     def Get(self, variable, flatten=True, interior=False, average_to_cell_centers=True):
         """Reads data for the named variable from file.
 
@@ -526,7 +554,7 @@ class phdf:
         """
         try:
             if self.varData.get(variable) is None:
-                self.varData[variable] = self.fid[variable][:]
+                self.varData[variable] = self._ReadVariable(variable)
                 vShape = self.varData[variable].shape
                 if self.OutputFormatVersion < 3:
                     raise ValueError("Unsupported output version")
@@ -541,9 +569,9 @@ class phdf:
             return None
 
         try:
-            self.varTopology[variable] = (
-                self.fid[variable].attrs["TopologicalLocation"].astype(str)
-            )
+            group = self._GroupOf(variable)
+            dset = self.fid[variable] if group is None else group[0]
+            self.varTopology[variable] = dset.attrs["TopologicalLocation"].astype(str)
         except:
             self.varTopology[variable] = "Cell"
         average_able = (self.varTopology[variable] != "Cell") and (
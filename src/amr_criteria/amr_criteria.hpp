@@ -43,18 +43,24 @@ struct AMRCriteria {
   static std::shared_ptr<AMRCriteria>
   MakeAMRCriteria(std::string &criteria, ParameterInput *pin, std::string &block_name);
   AMRBounds GetBounds(const MeshBlockData<Real> *rc) const;
+  // Order of the derivative of the predefined criteria, which are evaluated for all
+  // blocks of a MeshData in a single kernel by Refinement::CheckAllCriteria. Other
+  // criteria return 0 and are evaluated block by block.
+  virtual int DerivativeOrder() const { return 0; }
 };
 
 struct AMRFirstDerivative : public AMRCriteria {
   AMRFirstDerivative(ParameterInput *pin, std::string &block_name)
       : AMRCriteria(pin, block_name) {}
   AmrTag operator()(const MeshBlockData<Real> *rc) const override;
+  int DerivativeOrder() const override { return 1; }
 };
 
 struct AMRSecondDerivative : public AMRCriteria {
   AMRSecondDerivative(ParameterInput *pin, std::string &block_name)
       : AMRCriteria(pin, block_name) {}
   AmrTag operator()(const MeshBlockData<Real> *rc) const override;
+  int DerivativeOrder() const override { return 2; }
 };
 
 } // namespace parthenon
@@ -16,9 +16,12 @@
 #include <algorithm>
 #include <exception>
 #include <memory>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "amr_criteria/amr_criteria.hpp"
+#include "interface/make_pack_descriptor.hpp"
 #include "interface/mesh_data.hpp"
 #include "interface/meshblock_data.hpp"
 #include "interface/state_descriptor.hpp"
@@ -47,22 +50,21 @@ std::shared_ptr<StateDescriptor> Initialize(ParameterInput *pin) {
   return ref;
 }
 
-AmrTag CheckAllRefinement(MeshBlockData<Real> *rc) {
-  // Check all refinement criteria and return the maximum recommended change in
-  // refinement level:
-  //   delta_level = -1 => recommend derefinement
-  //   delta_level = 0  => leave me alone
-  //   delta_level = 1  => recommend refinement
-  // NOTE: recommendations from this routine are NOT always followed because
-  //    1) the code will not refine more than the global maximum level defined in
-  //       <parthenon/mesh>/numlevel in the input
-  //    2) the code must maintain proper nesting, which sometimes means a block that is
-  //       tagged as "derefine" must be left alone (or possibly refined?) because of
-  //       neighboring blocks.  Similarly for "do nothing"
-  PARTHENON_INSTRUMENT
+namespace {
+// Derivative criteria on dense fields are evaluated for all blocks at once, sparse fields
+// are left to the criteria themselves
+bool IsBatched_(const AMRCriteria &amr, const MeshBlockData<Real> *rc) {
+  return amr.DerivativeOrder() > 0 &&
+         rc->GetBlockPointer()->resolved_packages->FieldPresent(amr.field) &&
+         rc->HasVariable(amr.field);
+}
+
+// Combine delta_level with the refinement checks of the packages and their registered
+// criteria, skipping the criteria already evaluated by CheckAllCriteria if batched
+AmrTag CheckAllRefinement_(MeshBlockData<Real> *rc, AmrTag delta_level,
+                           const bool batched) {
   MeshBlock *pmb = rc->GetBlockPointer();
-  // delta_level holds the max over all criteria.  default to derefining.
-  AmrTag delta_level = AmrTag::derefine;
+  if (delta_level == AmrTag::refine) return AmrTag::refine;
   for (auto &pkg : pmb->packages.AllPackages()) {
     auto &desc = pkg.second;
     delta_level = std::max(delta_level, desc->CheckRefinement(rc));
@@ -72,6 +74,7 @@ AmrTag CheckAllRefinement(MeshBlockData<Real> *rc) {
     }
     // call parthenon criteria that were registered
     for (auto &amr : desc->amr_criteria) {
+      if (batched && IsBatched_(*amr, rc)) continue;
       // get the recommended change in refinement level from this criteria
       AmrTag temp_delta = (*amr)(rc);
       if ((temp_delta == AmrTag::refine) && pmb->loc.level() >= amr->max_level) {
@@ -89,6 +92,158 @@ AmrTag CheckAllRefinement(MeshBlockData<Real> *rc) {
   return delta_level;
 }
 
+// A derivative criterion as evaluated on the device by CheckAllCriteria
+struct BatchedCriterion {
+  int var;   // variable group in the pack
+  int comp;  // flattened component within the variable
+  int order; // of the derivative
+  Real refine_criteria, derefine_criteria;
+  int max_level;
+};
+
+template <class Pack>
+KOKKOS_INLINE_FUNCTION Real FirstDerivativeAt(const Pack &q, const int b, const int v,
+                                              const int k, const int j, const int i,
+                                              const int ndim) {
+  Real scale = std::abs(q(b, v, k, j, i));
+  Real d = 0.5 * std::abs((q(b, v, k, j, i + 1) - q(b, v, k, j, i - 1))) /
+           (scale + TINY_NUMBER);
+  Real maxd = d;
+  if (ndim > 1) {
+    d = 0.5 * std::abs((q(b, v, k, j + 1, i) - q(b, v, k, j - 1, i))) /
+        (scale + TINY_NUMBER);
+    maxd = (d > maxd ? d : maxd);
+  }
+  if (ndim > 2) {
+    d = 0.5 * std::abs((q(b, v, k + 1, j, i) - q(b, v, k - 1, j, i))) /
+        (scale + TINY_NUMBER);
+    maxd = (d > maxd ? d : maxd);
+  }
+  return maxd;
+}
+
+template <class Pack>
+KOKKOS_INLINE_FUNCTION Real SecondDerivativeAt(const Pack &q, const int b, const int v,
+                                               const int k, const int j, const int i,
+                                               const int ndim) {
+  Real aqt = std::abs(q(b, v, k, j, i)) + TINY_NUMBER;
+  Real qavg = 0.5 * (q(b, v, k, j, i + 1) + q(b, v, k, j, i - 1));
+  Real maxd = std::abs(qavg - q(b, v, k, j, i)) / (std::abs(qavg) + aqt);
+  if (ndim > 1) {
+    qavg = 0.5 * (q(b, v, k, j + 1, i) + q(b, v, k, j - 1, i));
+    Real d = std::abs(qavg - q(b, v, k, j, i)) / (std::abs(qavg) + aqt);
+    maxd = (d > maxd ? d : maxd);
+  }
+  if (ndim > 2) {
+    qavg = 0.5 * (q(b, v, k + 1, j, i) + q(b, v, k - 1, j, i));
+    Real d = std::abs(qavg - q(b, v, k, j, i)) / (std::abs(qavg) + aqt);
+    maxd = (d > maxd ? d : maxd);
+  }
+  return maxd;
+}
+} // namespace
+
+ParArray1D<AmrTag> CheckAllCriteria(MeshData<Real> *md) {
+  PARTHENON_INSTRUMENT
+  const int nblocks = md->NumBlocks();
+  ParArray1D<AmrTag> tags("AMR tags", nblocks);
+  Kokkos::deep_copy(md->exec_space, tags, AmrTag::derefine);
+  if (nblocks == 0) return tags;
+
+  // Collect the derivative criteria of all packages, with one variable group in the
+  // pack per field
+  auto pmesh = md->GetMeshPointer();
+  std::vector<std::string> fields;
+  std::vector<BatchedCriterion> criteria;
+  for (auto &[name, pkg] : pmesh->packages.AllPackages()) {
+    for (auto &amr : pkg->amr_criteria) {
+      if (!IsBatched_(*amr, md->GetBlockData(0).get())) continue;
+      auto it = std::find(fields.begin(), fields.end(), amr->field);
+      const int var = it - fields.begin();
+      if (it == fields.end()) fields.push_back(amr->field);
+      // Components are packed with the last index fastest
+      const auto &v = md->GetBlockData(0)->Get(amr->field);
+      const int comp = amr->comp4 + v.GetDim(4) * (amr->comp5 + v.GetDim(5) * amr->comp6);
+      criteria.push_back(BatchedCriterion{var, comp, amr->DerivativeOrder(),
+                                          amr->refine_criteria, amr->derefine_criteria,
+                                          amr->max_level});
+    }
+  }
+  const int ncriteria = criteria.size();
+  if (ncriteria == 0) return tags;
+
+  ParArray1D<BatchedCriterion> criteria_d("AMR criteria", ncriteria);
+  auto criteria_h = criteria_d.GetHostMirror();
+  for (int c = 0; c < ncriteria; ++c)
+    criteria_h(c) = criteria[c];
+  criteria_d.DeepCopy(criteria_h);
+
+  auto desc = MakePackDescriptor(pmesh->resolved_packages.get(), fields);
+  auto pack = desc.GetPack(md);
+  const auto &levels = md->GetBlockMetadata().level;
+  const AMRBounds bnds(md->GetBoundsI(IndexDomain::interior),
+                       md->GetBoundsJ(IndexDomain::interior),
+                       md->GetBoundsK(IndexDomain::interior));
+  const int ndim = 1 + (bnds.je > bnds.js) + (bnds.ke > bnds.ks);
+  const int ni = bnds.ie - bnds.is + 1;
+  const int nj = bnds.je - bnds.js + 1;
+  const int nk = bnds.ke - bnds.ks + 1;
+  const int is = bnds.is, js = bnds.js, ks = bnds.ks;
+
+  // One team per block loops over all criteria, reducing the derivative of each over
+  // the cells of the block
+  Kokkos::parallel_for(
+      PARTHENON_AUTO_LABEL, Kokkos::TeamPolicy<>(md->exec_space, nblocks, Kokkos::AUTO),
+      KOKKOS_LAMBDA(parthenon::team_mbr_t team_member) {
+        const int b = team_member.league_rank();
+        AmrTag tag = AmrTag::derefine;
+        for (int c = 0; c < ncriteria; ++c) {
+          const auto &crit = criteria_d(c);
+          const int v = pack.GetLowerBound(b, PackIdx(crit.var)) + crit.comp;
+          Real maxd = 0.0;
+          Kokkos::parallel_reduce(
+              Kokkos::TeamThreadRange<>(team_member, nk * nj * ni),
+              [&](const int idx, Real &lmaxd) {
+                const int k = ks + idx / (nj * ni);
+                const int j = js + (idx / ni) % nj;
+                const int i = is + idx % ni;
+                const Real d = crit.order == 1
+                                   ? FirstDerivativeAt(pack, b, v, k, j, i, ndim)
+                                   : SecondDerivativeAt(pack, b, v, k, j, i, ndim);
+                lmaxd = (d > lmaxd ? d : lmaxd);
+              },
+              Kokkos::Max<Real>(maxd));
+          AmrTag crit_tag = AmrTag::same;
+          if (maxd > crit.refine_criteria) {
+            // don't refine if we're at the max level
+            crit_tag = levels(b) >= crit.max_level ? AmrTag::same : AmrTag::refine;
+          } else if (maxd < crit.derefine_criteria) {
+            crit_tag = AmrTag::derefine;
+          }
+          tag = (tag < crit_tag) ? crit_tag : tag;
+        }
+        Kokkos::single(Kokkos::PerTeam(team_member), [&]() { tags(b) = tag; });
+      });
+  return tags;
+}
+
+AmrTag CheckAllRefinement(MeshBlockData<Real> *rc) {
+  // Check all refinement criteria and return the maximum recommended change in
+  // refinement level:
+  //   delta_level = -1 => recommend derefinement
+  //   delta_level = 0  => leave me alone
+  //   delta_level = 1  => recommend refinement
+  // NOTE: recommendations from this routine are NOT always followed because
+  //    1) the code will not refine more than the global maximum level defined in
+  //       <parthenon/mesh>/numlevel in the input
+  //    2) the code must maintain proper nesting, which sometimes means a block that is
+  //       tagged as "derefine" must be left alone (or possibly refined?) because of
+  //       neighboring blocks.  Similarly for "do nothing"
+  PARTHENON_INSTRUMENT
+  // delta_level holds the max over all criteria.  default to derefining.
+  return CheckAllRefinement_(rc, AmrTag::derefine, false);
+}
+
 AmrTag FirstDerivative(const AMRBounds &bnds, const ParArray3D<Real> &q,
                        const Real refine_criteria, const Real derefine_criteria) {
   PARTHENON_INSTRUMENT
@@ -164,8 +319,16 @@ TaskStatus Tag(MeshBlockData<Real> *rc) {
 template <>
 TaskStatus Tag(MeshData<Real> *rc) {
   PARTHENON_INSTRUMENT
+  // The derivative criteria of all blocks are evaluated on the device at once, so that
+  // only the package refinement functions and other criteria remain per block
+  auto tags = CheckAllCriteria(rc);
+  auto tags_h = Kokkos::create_mirror_view(HostMemSpace(), tags);
+  Kokkos::deep_copy(rc->exec_space, tags_h, tags);
+  rc->exec_space.fence();
   for (int i = 0; i < rc->NumBlocks(); i++) {
-    SetRefinement_(rc->GetBlockData(i).get());
+    auto *pmbd = rc->GetBlockData(i).get();
+    pmbd->GetBlockPointer()->pmr->SetRefinement(
+        CheckAllRefinement_(pmbd, tags_h(i), true));
   }
   return TaskStatus::complete;
 }
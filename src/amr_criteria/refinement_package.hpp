@@ -39,6 +39,11 @@ TaskStatus Tag(T *rc);
 
 AmrTag CheckAllRefinement(MeshBlockData<Real> *rc);
 
+// Evaluate the predefined derivative criteria of all packages for all blocks of md in a
+// single kernel. Returns the maximum tag over these criteria for every block, or
+// AmrTag::derefine if there are none.
+ParArray1D<AmrTag> CheckAllCriteria(MeshData<Real> *md);
+
 AmrTag FirstDerivative(const AMRBounds &bnds, const ParArray3D<Real> &q,
                        const Real refine_criteria, const Real derefine_criteria);
 
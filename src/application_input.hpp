@@ -22,12 +22,15 @@
 #include "bvals/boundary_conditions.hpp"
 #include "defs.hpp"
 #include "interface/state_descriptor.hpp"
+#include "mesh/load_balance.hpp"
 #include "outputs/output_parameters.hpp"
 #include "parameter_input.hpp"
 #include "parthenon_arrays.hpp"
 
 namespace parthenon {
 
+struct InSituData;
+
 struct ApplicationInput {
  public:
   // ParthenonManager functions
@@ -49,6 +52,8 @@ struct ApplicationInput {
       UserMeshWorkBeforeOutput = nullptr;
   std::function<void(Mesh *, ParameterInput *, SimTime const &, OutputParameters *)>
       UserWorkBeforeRestartOutput = nullptr;
+  // Consumer of "insitu" outputs, see outputs/insitu.hpp
+  std::function<void(Mesh *, const InSituData &)> InSituOutput = nullptr;
 
   std::function<void(Mesh *, ParameterInput *, SimTime const &)>
       PreStepDiagnosticsInLoop = nullptr;
@@ -58,7 +63,17 @@ struct ApplicationInput {
   std::function<void(Mesh *, ParameterInput *, SimTime &)> UserWorkAfterLoop = nullptr;
   std::function<void(Mesh *, ParameterInput *, SimTime &)> UserWorkBeforeLoop = nullptr;
   BValFunc boundary_conditions[BOUNDARY_NFACES] = {nullptr};
+  // Set together with boundary_conditions by BoundaryFunction::EnrollFunctorBC
+  MDBValFunc boundary_conditions_md[BOUNDARY_NFACES] = {nullptr};
   SBValFunc swarm_boundary_conditions[BOUNDARY_NFACES] = {nullptr};
+  // Used with <parthenon/loadbalancing>/partitioner = user, e.g. to hook up a graph
+  // partitioner
+  loadbalance::PartitionerFunc_t UserPartitioner = nullptr;
+  // Called during remeshing with the blocks that kept their rank and refinement level,
+  // while the data of migrated and (de)refined blocks is still in flight
+  std::function<void(Mesh *, ParameterInput *,
+                     const std::vector<std::shared_ptr<MeshBlock>> &)>
+      UserWorkDuringMigration = nullptr;
 
   // MeshBlock functions
   std::function<std::unique_ptr<MeshBlockApplicationData>(MeshBlock *, ParameterInput *)>
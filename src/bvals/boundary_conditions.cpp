@@ -12,17 +12,25 @@
 //========================================================================================
 
 #include <memory>
+#include <set>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "bvals/boundary_conditions.hpp"
 #include "bvals/boundary_conditions_generic.hpp"
 #include "bvals/neighbor_block.hpp"
 #include "defs.hpp"
+#include "interface/make_pack_descriptor.hpp"
 #include "interface/meshblock_data.hpp"
+#include "interface/sparse_pack.hpp"
+#include "kokkos_abstraction.hpp"
 #include "mesh/domain.hpp"
 #include "mesh/mesh.hpp"
 #include "mesh/mesh_refinement.hpp"
 #include "mesh/meshblock.hpp"
+#include "utils/indexer.hpp"
 
 namespace parthenon {
 
@@ -31,6 +39,9 @@ bool DoPhysicalBoundary_(const BoundaryFlag flag, const BoundaryFace face,
                          const int ndim);
 bool DoPhysicalSwarmBoundary_(const BoundaryFlag flag, const BoundaryFace face,
                               const int ndim);
+void ApplyBuiltinBoundaryConditionsMD_(std::shared_ptr<MeshData<Real>> &pmd, bool coarse,
+                                       CoordinateDirection dir,
+                                       const std::vector<bool> &do_block);
 } // namespace boundary_cond_impl
 
 TaskStatus ApplyBoundaryConditionsOnCoarseOrFine(std::shared_ptr<MeshBlockData<Real>> &rc,
@@ -40,6 +51,9 @@ TaskStatus ApplyBoundaryConditionsOnCoarseOrFine(std::shared_ptr<MeshBlockData<R
   MeshBlock *pmb = rc->GetBlockPointer();
   Mesh *pmesh = pmb->pmy_mesh;
   const int ndim = pmesh->ndim;
+  // Blocks without coarser neighbors may not have coarse buffers, but also don't need
+  // coarse boundary conditions since nothing is prolongated into their ghosts
+  if (coarse && !pmb->CoarseBuffersAllocated()) return TaskStatus::complete;
 
   auto &tree_bnd_func = pmesh->forest.GetTreePtr(pmb->loc.tree())->MeshBndryFnctn;
   auto &tree_bnd_func_user =
@@ -59,19 +73,108 @@ TaskStatus ApplyBoundaryConditionsOnCoarseOrFine(std::shared_ptr<MeshBlockData<R
 }
 
 TaskStatus ApplySwarmBoundaryConditions(std::shared_ptr<Swarm> &swarm) {
+  return ApplySwarmBoundaryConditions(std::vector<std::shared_ptr<Swarm>>{swarm});
+}
+
+namespace boundary_cond_impl {
+// A swarm with built-in conditions on some faces of its block, the bits of outflow and
+// periodic are the faces with the respective condition
+struct SwarmBCEntry {
+  SwarmDeviceContext swarm_d;
+  ParArrayND<Real> x, y, z;
+  int max_active_index;
+  int outflow, periodic;
+};
+
+// Same as GenericSwarmBC for all faces of a swarm, one after the other
+KOKKOS_INLINE_FUNCTION void ApplyBuiltinSwarmBCs_(const SwarmBCEntry &e, const int n) {
+  const auto &swarm_d = e.swarm_d;
+  if (!swarm_d.IsActive(n)) return;
+  const Real xmin[3] = {swarm_d.x_min_global_, swarm_d.y_min_global_,
+                        swarm_d.z_min_global_};
+  const Real xmax[3] = {swarm_d.x_max_global_, swarm_d.y_max_global_,
+                        swarm_d.z_max_global_};
+  for (int f = 0; f < BOUNDARY_NFACES; ++f) {
+    const bool outflow = (e.outflow >> f) & 1;
+    const bool periodic = (e.periodic >> f) & 1;
+    if (!(outflow || periodic)) continue;
+    const int d = f / 2;
+    const bool inner = f % 2 == 0;
+    Real &x = (d == 0) ? e.x(n) : ((d == 1) ? e.y(n) : e.z(n));
+    if (inner) {
+      if (periodic && x > xmax[d]) x = xmin[d] + (x - xmax[d]);
+      if (outflow && x < xmin[d]) swarm_d.MarkParticleForRemoval(n);
+    } else {
+      if (periodic && x < xmin[d]) x = xmax[d] - (xmin[d] - x);
+      if (outflow && x > xmax[d]) swarm_d.MarkParticleForRemoval(n);
+    }
+  }
+}
+} // namespace boundary_cond_impl
+
+TaskStatus ApplySwarmBoundaryConditions(const std::vector<std::shared_ptr<Swarm>> &swarms) {
   PARTHENON_INSTRUMENT
   using namespace boundary_cond_impl;
-  const auto pmb = swarm->GetBlockPointer();
-  Mesh *pmesh = pmb->pmy_mesh;
+  if (swarms.empty()) return TaskStatus::complete;
+  Mesh *pmesh = swarms[0]->GetBlockPointer()->pmy_mesh;
   const int ndim = pmesh->ndim;
 
-  auto &tree_bnd_func = pmesh->forest.GetTreePtr(pmb->loc.tree())->SwarmBndryFnctn;
-  auto &tree_bnd_func_user =
-      pmesh->forest.GetTreePtr(pmb->loc.tree())->UserSwarmBoundaryFunctions;
-  for (int i = 0; i < BOUNDARY_NFACES; i++) {
-    if (DoPhysicalSwarmBoundary_(pmb->boundary_flag[i], static_cast<BoundaryFace>(i),
-                                 ndim)) {
-      tree_bnd_func[i](swarm);
+  // Table of the swarms with built-in conditions, which are applied by one team per
+  // swarm, and the faces of every swarm with other conditions
+  std::vector<SwarmBCEntry> entries;
+  std::vector<int> other_faces(swarms.size(), 0);
+  for (int s = 0; s < swarms.size(); ++s) {
+    const auto &swarm = swarms[s];
+    const auto pmb = swarm->GetBlockPointer();
+    SwarmBCEntry e{};
+    for (int i = 0; i < BOUNDARY_NFACES; i++) {
+      const auto flag = pmb->boundary_flag[i];
+      if (!DoPhysicalSwarmBoundary_(flag, static_cast<BoundaryFace>(i), ndim)) continue;
+      if (flag == BoundaryFlag::outflow) {
+        e.outflow |= 1 << i;
+      } else if (flag == BoundaryFlag::periodic) {
+        e.periodic |= 1 << i;
+      } else {
+        other_faces[s] |= 1 << i;
+      }
+    }
+    if (e.outflow == 0 && e.periodic == 0) continue;
+    e.swarm_d = swarm->GetDeviceContext();
+    e.x = swarm->Get<Real>(swarm_position::x::name()).Get();
+    e.y = swarm->Get<Real>(swarm_position::y::name()).Get();
+    e.z = swarm->Get<Real>(swarm_position::z::name()).Get();
+    e.max_active_index = swarm->GetMaxActiveIndex();
+    entries.push_back(e);
+  }
+
+  const int nentries = entries.size();
+  if (nentries > 0) {
+    ParArray1D<SwarmBCEntry> table("ApplySwarmBoundaryConditions table", nentries);
+    auto table_h = Kokkos::create_mirror_view(table);
+    for (int e = 0; e < nentries; ++e)
+      table_h(e) = entries[e];
+    Kokkos::deep_copy(table, table_h);
+    par_for_outer(
+        PARTHENON_AUTO_LABEL, 0, 0, 0, nentries - 1,
+        KOKKOS_LAMBDA(team_mbr_t member, const int e) {
+          const auto &entry = table(e);
+          par_for_inner(member, 0, entry.max_active_index,
+                        [&](const int n) { ApplyBuiltinSwarmBCs_(entry, n); });
+        });
+  }
+
+  // User conditions of the tree and of the packages, in the order of the faces
+  for (int s = 0; s < swarms.size(); ++s) {
+    auto swarm = swarms[s];
+    const auto pmb = swarm->GetBlockPointer();
+    auto &tree_bnd_func = pmesh->forest.GetTreePtr(pmb->loc.tree())->SwarmBndryFnctn;
+    auto &tree_bnd_func_user =
+        pmesh->forest.GetTreePtr(pmb->loc.tree())->UserSwarmBoundaryFunctions;
+    for (int i = 0; i < BOUNDARY_NFACES; i++) {
+      if (!DoPhysicalSwarmBoundary_(pmb->boundary_flag[i], static_cast<BoundaryFace>(i),
+                                    ndim))
+        continue;
+      if ((other_faces[s] >> i) & 1) tree_bnd_func[i](swarm);
       for (auto &bnd_func : tree_bnd_func_user[i]) {
         bnd_func(swarm);
       }
@@ -80,16 +183,85 @@ TaskStatus ApplySwarmBoundaryConditions(std::shared_ptr<Swarm> &swarm) {
   return TaskStatus::complete;
 }
 
+TaskStatus ApplySwarmBoundaryConditionsMD(std::shared_ptr<MeshData<Real>> &pmd) {
+  // Swarms live in the base container of the blocks
+  std::vector<std::shared_ptr<Swarm>> swarms;
+  for (int b = 0; b < pmd->NumBlocks(); ++b) {
+    MeshBlock *pmb = pmd->GetBlockData(b)->GetBlockPointer();
+    for (const auto &swarm : pmb->meshblock_data.Get()->GetAllSwarms())
+      swarms.push_back(swarm);
+  }
+  return ApplySwarmBoundaryConditions(swarms);
+}
+
 TaskStatus ApplyBoundaryConditionsMD(std::shared_ptr<MeshData<Real>> &pmd) {
-  for (int b = 0; b < pmd->NumBlocks(); ++b)
-    ApplyBoundaryConditions(pmd->GetBlockData(b));
-  return TaskStatus::complete;
+  return ApplyBoundaryConditionsOnCoarseOrFineMD(pmd, false);
 }
 
 TaskStatus ApplyBoundaryConditionsOnCoarseOrFineMD(std::shared_ptr<MeshData<Real>> &pmd,
                                                    bool coarse) {
-  for (int b = 0; b < pmd->NumBlocks(); ++b)
-    ApplyBoundaryConditionsOnCoarseOrFine(pmd->GetBlockData(b), coarse);
+  PARTHENON_INSTRUMENT
+  using namespace boundary_cond_impl;
+  const int nblocks = pmd->NumBlocks();
+  if (nblocks == 0) return TaskStatus::complete;
+  Mesh *pmesh = pmd->GetMeshPointer();
+  const int ndim = pmesh->ndim;
+
+  // The built-in outflow and reflecting conditions of all blocks are applied together,
+  // one direction at a time. Faces of a later direction fill their ghost zones from the
+  // ghosts of earlier directions, so this keeps the order (and the corners) of doing
+  // one face of one block after the other. User conditions of a direction are applied
+  // after the built-in ones of that direction, block by block unless they were enrolled
+  // as functors.
+  std::vector<bool> do_block(nblocks);
+  for (int b = 0; b < nblocks; ++b) {
+    // Blocks without coarser neighbors may not have coarse buffers, but also don't need
+    // coarse boundary conditions since nothing is prolongated into their ghosts
+    MeshBlock *pmb = pmd->GetBlockData(b)->GetBlockPointer();
+    do_block[b] = !coarse || pmb->CoarseBuffersAllocated();
+  }
+  for (auto dir : {X1DIR, X2DIR, X3DIR}) {
+    if (dir > ndim) break;
+    ApplyBuiltinBoundaryConditionsMD_(pmd, coarse, dir, do_block);
+    // User conditions enrolled as functors are fused over the blocks as well
+    std::vector<bool> fused(nblocks * BOUNDARY_NFACES, false);
+    for (int i = 2 * (dir - 1); i < 2 * dir; ++i) {
+      MDBValFunc func = nullptr;
+      std::vector<int> blocks;
+      for (int b = 0; b < nblocks; ++b) {
+        MeshBlock *pmb = pmd->GetBlockData(b)->GetBlockPointer();
+        auto &func_b = pmesh->forest.GetTreePtr(pmb->loc.tree())->MeshBndryFnctnMD[i];
+        if (!do_block[b] || pmb->boundary_flag[i] != BoundaryFlag::user ||
+            func_b == nullptr || !DoPhysicalBoundary_(BoundaryFlag::user,
+                                                      static_cast<BoundaryFace>(i), ndim))
+          continue;
+        // All trees share the user conditions of the ApplicationInput
+        if (func == nullptr) func = func_b;
+        blocks.push_back(b);
+        fused[b * BOUNDARY_NFACES + i] = true;
+      }
+      if (!blocks.empty()) func(pmd, coarse, blocks);
+    }
+    for (int b = 0; b < nblocks; ++b) {
+      if (!do_block[b]) continue;
+      auto &rc = pmd->GetBlockData(b);
+      MeshBlock *pmb = rc->GetBlockPointer();
+      auto *ptree = pmesh->forest.GetTreePtr(pmb->loc.tree()).get();
+      for (int i = 2 * (dir - 1); i < 2 * dir; ++i) {
+        const auto flag = pmb->boundary_flag[i];
+        if (!DoPhysicalBoundary_(flag, static_cast<BoundaryFace>(i), ndim)) continue;
+        if (flag != BoundaryFlag::outflow && flag != BoundaryFlag::reflect &&
+            !fused[b * BOUNDARY_NFACES + i]) {
+          PARTHENON_DEBUG_REQUIRE(ptree->MeshBndryFnctn[i] != nullptr,
+                                  "boundary function must not be null");
+          ptree->MeshBndryFnctn[i](rc, coarse);
+        }
+        for (auto &bnd_func : ptree->UserBoundaryFunctions[i]) {
+          bnd_func(rc, coarse);
+        }
+      }
+    }
+  }
   return TaskStatus::complete;
 }
 
@@ -218,6 +390,47 @@ bool DoPhysicalSwarmBoundary_(const BoundaryFlag flag, const BoundaryFace face,
   return true; // outflow, periodic, user, dims (particles always 3D) correct
 }
 
+// The built-in outflow and reflecting conditions as point functors for FusedBC
+template <bool REFLECT>
+struct BuiltinBC {
+  template <class pack_t>
+  KOKKOS_INLINE_FUNCTION void operator()(const pack_t &q,
+                                         const BoundaryFunction::BCFace &fc,
+                                         const TopologicalElement el, const int l,
+                                         const int k, const int j, const int i) const {
+    const bool X1 = fc.dir == X1DIR, X2 = fc.dir == X2DIR, X3 = fc.dir == X3DIR;
+    const int b = fc.b;
+    if constexpr (REFLECT) {
+      const bool flip = (q(b, el, l).vector_component == fc.dir);
+      q(b, el, l, k, j, i) =
+          (flip ? -1.0 : 1.0) * q(b, el, l, X3 ? fc.Mirror(k) : k, X2 ? fc.Mirror(j) : j,
+                                  X1 ? fc.Mirror(i) : i);
+    } else {
+      q(b, el, l, k, j, i) =
+          q(b, el, l, X3 ? fc.ref : k, X2 ? fc.ref : j, X1 ? fc.ref : i);
+    }
+  }
+};
+
+void ApplyBuiltinBoundaryConditionsMD_(std::shared_ptr<MeshData<Real>> &pmd, bool coarse,
+                                       CoordinateDirection dir,
+                                       const std::vector<bool> &do_block) {
+  const int ndim = pmd->GetMeshPointer()->ndim;
+  std::vector<std::pair<int, BoundaryFace>> outflow, reflect;
+  for (int b = 0; b < pmd->NumBlocks(); ++b) {
+    if (!do_block[b]) continue;
+    MeshBlock *pmb = pmd->GetBlockData(b)->GetBlockPointer();
+    for (int i = 2 * (dir - 1); i < 2 * dir; ++i) {
+      const auto flag = pmb->boundary_flag[i];
+      if (!DoPhysicalBoundary_(flag, static_cast<BoundaryFace>(i), ndim)) continue;
+      if (flag == BoundaryFlag::outflow) outflow.emplace_back(b, BoundaryFace(i));
+      if (flag == BoundaryFlag::reflect) reflect.emplace_back(b, BoundaryFace(i));
+    }
+  }
+  BoundaryFunction::FusedBC(pmd.get(), coarse, outflow, BuiltinBC<false>());
+  BoundaryFunction::FusedBC(pmd.get(), coarse, reflect, BuiltinBC<true>());
+}
+
 } // namespace boundary_cond_impl
 
 } // namespace parthenon
@@ -17,6 +17,7 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "basic_types.hpp"
 #include "interface/meshblock_data.hpp"
@@ -29,6 +30,10 @@ namespace parthenon {
 
 using BValFunc = std::function<void(std::shared_ptr<MeshBlockData<Real>> &, bool)>;
 using SBValFunc = std::function<void(std::shared_ptr<Swarm> &)>;
+// Boundary condition of one face applied to the blocks of a MeshData with the given
+// indices at once, see BoundaryFunction::EnrollFunctorBC
+using MDBValFunc = std::function<void(std::shared_ptr<MeshData<Real>> &, bool,
+                                      const std::vector<int> &)>;
 
 TaskStatus ApplyBoundaryConditionsOnCoarseOrFine(std::shared_ptr<MeshBlockData<Real>> &rc,
                                                  bool coarse);
@@ -42,9 +47,13 @@ TaskStatus ApplyBoundaryConditionsMD(std::shared_ptr<MeshData<Real>> &pmd);
 TaskStatus ApplyBoundaryConditionsOnCoarseOrFineMD(std::shared_ptr<MeshData<Real>> &pmd,
                                                    bool coarse);
 
+// The built-in (outflow and periodic) conditions of all faces of all swarms on the
+// blocks of pmd are applied in a single kernel, user conditions are applied afterwards
+// swarm by swarm
 TaskStatus ApplySwarmBoundaryConditionsMD(std::shared_ptr<MeshData<Real>> &pmd);
 
 TaskStatus ApplySwarmBoundaryConditions(std::shared_ptr<Swarm> &swarm);
+TaskStatus ApplySwarmBoundaryConditions(const std::vector<std::shared_ptr<Swarm>> &swarms);
 
 namespace BoundaryFunction {
 
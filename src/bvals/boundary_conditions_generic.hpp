@@ -23,14 +23,17 @@
 #include <utility>
 #include <vector>
 
+#include "application_input.hpp"
 #include "basic_types.hpp"
 #include "interface/make_pack_descriptor.hpp"
 #include "interface/meshblock_data.hpp"
 #include "interface/sparse_pack.hpp"
 #include "interface/swarm_default_names.hpp"
+#include "kokkos_abstraction.hpp"
 #include "mesh/domain.hpp"
 #include "mesh/mesh.hpp"
 #include "mesh/meshblock.hpp"
+#include "utils/indexer.hpp"
 
 namespace parthenon {
 namespace BoundaryFunction {
@@ -261,6 +264,128 @@ void GenericBC(std::shared_ptr<MeshBlockData<Real>> &rc, bool coarse, Real val =
     GenericBC<DIR, SIDE, TYPE, var_ts...>(rc, coarse, el, val);
 }
 
+// A physical boundary face of a block in a fused boundary kernel
+struct BCFace {
+  int b; // index of the block in the pack
+  BoundaryFace face;
+  CoordinateDirection dir;
+  bool inner;
+  IndexRange kb, jb, ib; // ghost zones of the face
+  int ref;               // index of the interior cells next to the face in direction dir
+  // Index in direction dir of the interior cell that is the mirror image of ghost index n
+  KOKKOS_INLINE_FUNCTION int Mirror(const int n) const {
+    return 2 * ref + (inner ? -1 : 1) - n;
+  }
+};
+
+namespace impl {
+inline MeshBlock *GetBlockPointer(MeshData<Real> *md, const int b) {
+  return md->GetBlockData(b)->GetBlockPointer();
+}
+inline MeshBlock *GetBlockPointer(MeshBlockData<Real> *rc, const int) {
+  return rc->GetBlockPointer();
+}
+} // namespace impl
+
+// Apply a point-wise boundary condition to the FillGhost variables in the ghost zones
+// of all given (block, face) pairs of data, a MeshData or MeshBlockData, with one kernel
+// per topological element. The faces should be in the same direction, see
+// ApplyBoundaryConditionsOnCoarseOrFineMD. func must be device callable as
+//
+//   template <class pack_t>
+//   KOKKOS_INLINE_FUNCTION void operator()(const pack_t &q, const BCFace &face,
+//                                          TopologicalElement el, int l, int k, int j,
+//                                          int i) const
+//
+// and set q(face.b, el, l, k, j, i), e.g., from q.GetCoordinates(face.b) or from the
+// interior cell face.Mirror(i) for a face in X1DIR.
+template <class Functor, class T>
+void FusedBC(T *data, bool coarse, const std::vector<std::pair<int, BoundaryFace>> &faces,
+             const Functor &func) {
+  PARTHENON_INSTRUMENT
+  using TE = TopologicalElement;
+  if (faces.empty()) return;
+  Mesh *pmesh = impl::GetBlockPointer(data, faces[0].first)->pmy_mesh;
+  auto *psd = pmesh->resolved_packages.get();
+
+  const int nfaces = faces.size();
+  ParArray1D<BCFace> faces_d("Boundary faces", nfaces);
+  auto faces_h = Kokkos::create_mirror_view(HostMemSpace(), faces_d);
+  for (auto el : {TE::CC, TE::F1, TE::F2, TE::F3, TE::E1, TE::E2, TE::E3, TE::NN}) {
+    for (auto fine : {false, true}) {
+      const MetadataFlag elements[] = {Metadata::Cell, Metadata::Face, Metadata::Edge,
+                                       Metadata::Node};
+      std::vector<MetadataFlag> flags{
+          Metadata::FillGhost, elements[static_cast<int>(GetTopologicalType(el))]};
+      if (fine) flags.push_back(Metadata::Fine);
+      std::set<PDOpt> opts;
+      if (coarse) opts.insert(PDOpt::Coarse);
+      auto q = MakePackDescriptor<variable_names::any>(psd, flags, opts).GetPack(data);
+      if (q.GetMaxNumberOfVars() == 0) continue;
+
+      for (int f = 0; f < nfaces; ++f) {
+        const auto [b, face] = faces[f];
+        MeshBlock *pmb = impl::GetBlockPointer(data, b);
+        const auto &bounds = fine ? (coarse ? pmb->cellbounds : pmb->f_cellbounds)
+                                  : (coarse ? pmb->c_cellbounds : pmb->cellbounds);
+        BCFace fc;
+        fc.b = b;
+        fc.face = face;
+        fc.dir = static_cast<CoordinateDirection>(face / 2 + 1);
+        fc.inner = face % 2 == 0;
+        const auto domain = static_cast<IndexDomain>(
+            static_cast<int>(IndexDomain::inner_x1) + static_cast<int>(face));
+        fc.kb = bounds.GetBoundsK(domain, el);
+        fc.jb = bounds.GetBoundsJ(domain, el);
+        fc.ib = bounds.GetBoundsI(domain, el);
+        const auto range = fc.dir == X1DIR ? bounds.GetBoundsI(IndexDomain::interior, el)
+                           : fc.dir == X2DIR
+                               ? bounds.GetBoundsJ(IndexDomain::interior, el)
+                               : bounds.GetBoundsK(IndexDomain::interior, el);
+        fc.ref = fc.inner ? range.s : range.e;
+        faces_h(f) = fc;
+      }
+      Kokkos::deep_copy(faces_d, faces_h);
+
+      par_for_outer(
+          DEFAULT_OUTER_LOOP_PATTERN, PARTHENON_AUTO_LABEL, DevExecSpace(), 0, 0, 0,
+          nfaces - 1, KOKKOS_LAMBDA(team_mbr_t team_member, const int f) {
+            const auto &fc = faces_d(f);
+            const int lstart = q.GetLowerBound(fc.b);
+            const int lend = q.GetUpperBound(fc.b);
+            if (lend < lstart) return;
+            Indexer4D idxer({lstart, lend}, {fc.kb.s, fc.kb.e}, {fc.jb.s, fc.jb.e},
+                            {fc.ib.s, fc.ib.e});
+            par_for_inner(DEFAULT_INNER_LOOP_PATTERN, team_member, 0, idxer.size() - 1,
+                          [&](const int ii) {
+                            const auto [l, k, j, i] = idxer(ii);
+                            func(q, fc, el, l, k, j, i);
+                          });
+          });
+    }
+  }
+}
+
+// Enroll a device callable point functor (see FusedBC) as the user boundary condition
+// of face. ApplyBoundaryConditions*MD apply it to all blocks of a MeshData in one kernel
+// per topological element instead of calling a host function for every block.
+template <class Functor>
+void EnrollFunctorBC(ApplicationInput *app_in, const BoundaryFace face,
+                     const Functor &func) {
+  app_in->boundary_conditions[face] =
+      [face, func](std::shared_ptr<MeshBlockData<Real>> &rc, bool coarse) {
+        FusedBC(rc.get(), coarse, {{0, face}}, func);
+      };
+  app_in->boundary_conditions_md[face] = [face, func](
+                                             std::shared_ptr<MeshData<Real>> &md,
+                                             bool coarse, const std::vector<int> &blocks) {
+    std::vector<std::pair<int, BoundaryFace>> faces;
+    for (const int b : blocks)
+      faces.emplace_back(b, face);
+    FusedBC(md.get(), coarse, faces, func);
+  };
+}
+
 } // namespace BoundaryFunction
 } // namespace parthenon
 
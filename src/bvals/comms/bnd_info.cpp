@@ -101,6 +101,70 @@ GetFluxCorrectionElements(const std::shared_ptr<Variable<Real>> &v,
   return elements;
 }
 
+// Number of ghost layers exchanged with a neighbor. Variables can request fewer layers
+// than Globals::nghost, which only applies to neighbors on the same level since
+// prolongation and restriction need the full stencil
+int ExchangedGhostDepth(const NeighborBlock &nb, MeshBlock *pmb,
+                        const std::shared_ptr<Variable<Real>> &v) {
+  const int depth = v->metadata().GetGhostDepth();
+  if (depth == 0 || depth >= Globals::nghost || nb.loc.level() != pmb->loc.level())
+    return Globals::nghost;
+  return depth;
+}
+
+bool DeduplicatesSharedElements(MeshBlock *pmb, const NeighborBlock &nb,
+                                const std::shared_ptr<Variable<Real>> &v) {
+  // The index ranges of sender and receiver have to map onto each other without a
+  // change of orientation, so that both can drop the same planes
+  const auto &trans = nb.lcoord_trans;
+  for (int dir = 0; dir < 3; ++dir) {
+    if (trans.dir_connection[dir] != dir || trans.dir_flip[dir]) return false;
+  }
+  return pmb->pmy_mesh->do_deduplicate_shared_elements && !v->IsSet(Metadata::Cell) &&
+         !v->IsSet(Metadata::Flux) && nb.loc.level() == pmb->loc.level() &&
+         !nb.offsets.IsCell() && nb.ownership.initialized &&
+         nb.origin_ownership.initialized;
+}
+
+// Drops the outermost planes of the index range s..e that the receiver mask excludes
+// entirely, i.e., shared elements that the receiver takes from another block or owns
+// itself. The mask entries of the planes that become the new boundary of the range are
+// those of the interior they came from, so the remaining elements keep their masks.
+void TrimUnownedPlanes(std::array<int, 3> &s, std::array<int, 3> &e,
+                       block_ownership_t &mask) {
+  for (int dir = 0; dir < 3; ++dir) {
+    for (int side : {-1, 1}) {
+      // Ranges need to keep distinct first and last planes for the masks to apply
+      if (e[dir] - s[dir] < 2) continue;
+      bool any_active = false;
+      std::array<int, 3> o;
+      o[dir] = side;
+      for (int a : {-1, 0, 1}) {
+        for (int b : {-1, 0, 1}) {
+          o[(dir + 1) % 3] = a;
+          o[(dir + 2) % 3] = b;
+          any_active = any_active || mask(o[0], o[1], o[2]);
+        }
+      }
+      if (any_active) continue;
+      if (side > 0) {
+        e[dir]--;
+      } else {
+        s[dir]++;
+      }
+      for (int a : {-1, 0, 1}) {
+        for (int b : {-1, 0, 1}) {
+          std::array<int, 3> interior;
+          interior[dir] = 0;
+          o[(dir + 1) % 3] = interior[(dir + 1) % 3] = a;
+          o[(dir + 2) % 3] = interior[(dir + 2) % 3] = b;
+          mask(o[0], o[1], o[2]) = mask(interior[0], interior[1], interior[2]);
+        }
+      }
+    }
+  }
+}
+
 SpatiallyMaskedIndexer6D
 CalcIndices(const NeighborBlock &nb, MeshBlock *pmb,
             const std::shared_ptr<Variable<Real>> &v, TopologicalElement el,
@@ -148,10 +212,9 @@ CalcIndices(const NeighborBlock &nb, MeshBlock *pmb,
                                 TopologicalOffsetK(el)};
   std::array<int, 3> block_offset = nb.offsets;
 
-  int interior_offset =
-      ir_type == IndexRangeType::BoundaryInteriorSend ? Globals::nghost : 0;
-  int exterior_offset =
-      ir_type == IndexRangeType::BoundaryExteriorRecv ? Globals::nghost : 0;
+  const int depth = prores ? Globals::nghost : ExchangedGhostDepth(nb, pmb, v);
+  int interior_offset = ir_type == IndexRangeType::BoundaryInteriorSend ? depth : 0;
+  int exterior_offset = ir_type == IndexRangeType::BoundaryExteriorRecv ? depth : 0;
   if (prores) {
     // The coarse ghosts cover twice as much volume as the fine ghosts, so when working in
     // the exterior (i.e. ghosts) we must only go over the coarse ghosts that have
@@ -245,28 +308,64 @@ CalcIndices(const NeighborBlock &nb, MeshBlock *pmb,
     }
     owns = GetIndexRangeMaskFromOwnership(el, nb.ownership, sox1, sox2, sox3);
   }
+
+  // Shared elements that the receiver would mask out are not put in the buffer at all.
+  // The sender determines the mask of the receiver from its own ownership, which the
+  // receiver knows as the ownership of its neighbor.
+  const bool boundary = ir_type == IndexRangeType::BoundaryInteriorSend ||
+                        ir_type == IndexRangeType::BoundaryExteriorRecv;
+  if (boundary && !prores && DeduplicatesSharedElements(pmb, nb, v)) {
+    if (ir_type == IndexRangeType::BoundaryInteriorSend) {
+      block_ownership_t receiver_mask = GetIndexRangeMaskFromOwnership(
+          el, nb.origin_ownership, block_offset[0], block_offset[1], block_offset[2]);
+      TrimUnownedPlanes(s, e, receiver_mask);
+    } else {
+      TrimUnownedPlanes(s, e, owns);
+    }
+  }
   return SpatiallyMaskedIndexer6D(owns, {0, tensor_shape[0] - 1},
                                   {0, tensor_shape[1] - 1}, {0, tensor_shape[2] - 1},
                                   {s[2], e[2]}, {s[1], e[1]}, {s[0], e[0]});
 }
 
 int GetBufferSize(MeshBlock *pmb, const NeighborBlock &nb,
-                  std::shared_ptr<Variable<Real>> v) {
-  // This does not do a careful job of calculating the buffer size, in many
-  // cases there will be some extra storage that is not required, but there
-  // will always be enough storage
-  auto &cb = v->IsSet(Metadata::Fine) ? pmb->f_cellbounds : pmb->cellbounds;
-  int topo_comp = (v->IsSet(Metadata::Face) || v->IsSet(Metadata::Edge)) ? 3 : 1;
-  const IndexDomain in = IndexDomain::entire;
-  // The plus 2 instead of 1 is to account for the possible size of face, edge, and nodal
-  // fields
-  const int isize = cb.ie(in) - cb.is(in) + 2;
-  const int jsize = cb.je(in) - cb.js(in) + 2;
-  const int ksize = cb.ke(in) - cb.ks(in) + 2;
-  return (nb.offsets(X1DIR) == 0 ? isize : Globals::nghost + 1) *
-         (nb.offsets(X2DIR) == 0 ? jsize : Globals::nghost + 1) *
-         (nb.offsets(X3DIR) == 0 ? ksize : Globals::nghost + 1) * v->GetDim(6) *
-         v->GetDim(5) * v->GetDim(4) * topo_comp;
+                  std::shared_ptr<Variable<Real>> v, bool send) {
+  int nvals = 0;
+  if (DeduplicatesSharedElements(pmb, nb, v)) {
+    // The index ranges of sender and receiver differ in the shared planes they drop, so
+    // all topological elements are counted exactly, which gives the same size on both
+    // sides. The orientation of the neighbor is the same, so that no transformation of
+    // the elements is required on the receiving side.
+    const auto ir_type =
+        send ? IndexRangeType::BoundaryInteriorSend : IndexRangeType::BoundaryExteriorRecv;
+    for (auto el : v->GetTopologicalElements())
+      nvals += CalcIndices(nb, pmb, v, el, ir_type, false, nb.lcoord_trans).size();
+  } else {
+    // This does not do a careful job of calculating the buffer size, in many
+    // cases there will be some extra storage that is not required, but there
+    // will always be enough storage
+    auto &cb = v->IsSet(Metadata::Fine) ? pmb->f_cellbounds : pmb->cellbounds;
+    int topo_comp = (v->IsSet(Metadata::Face) || v->IsSet(Metadata::Edge)) ? 3 : 1;
+    const IndexDomain in = IndexDomain::entire;
+    // The plus 2 instead of 1 is to account for the possible size of face, edge, and
+    // nodal fields
+    const int isize = cb.ie(in) - cb.is(in) + 2;
+    const int jsize = cb.je(in) - cb.js(in) + 2;
+    const int ksize = cb.ke(in) - cb.ks(in) + 2;
+    const int depth = ExchangedGhostDepth(nb, pmb, v);
+    nvals = (nb.offsets(X1DIR) == 0 ? isize : depth + 1) *
+            (nb.offsets(X2DIR) == 0 ? jsize : depth + 1) *
+            (nb.offsets(X3DIR) == 0 ? ksize : depth + 1) * v->GetDim(6) * v->GetDim(5) *
+            v->GetDim(4) * topo_comp;
+  }
+  // Buffers are arrays of Reals, so reduced precision values are packed into fewer of
+  // them
+  if (v->IsSet(Metadata::HalfPrecisionComms))
+    return (nvals * sizeof(Kokkos::Experimental::half_t) + sizeof(Real) - 1) /
+           sizeof(Real);
+  if (v->IsSet(Metadata::SinglePrecisionComms))
+    return (nvals * sizeof(float) + sizeof(Real) - 1) / sizeof(Real);
+  return nvals;
 }
 
 BndInfo::BndInfo(MeshBlock *pmb, const NeighborBlock &nb,
@@ -278,6 +377,8 @@ BndInfo::BndInfo(MeshBlock *pmb, const NeighborBlock &nb,
 
   buf = combuf->buffer();
   same_to_same = pmb->gid == nb.gid && nb.offsets.IsCell();
+  half_precision = v->IsSet(Metadata::HalfPrecisionComms);
+  single_precision = !half_precision && v->IsSet(Metadata::SinglePrecisionComms);
   lcoord_trans = nb.lcoord_trans;
   if (!allocated) return;
 
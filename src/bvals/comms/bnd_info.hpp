@@ -18,11 +18,14 @@
 #ifndef BVALS_COMMS_BND_INFO_HPP_
 #define BVALS_COMMS_BND_INFO_HPP_
 
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "basic_types.hpp"
+#include "bvals/comms/coalesced_buffers.hpp"
+#include "bvals/comms/sparse_null_masks.hpp"
 #include "bvals/neighbor_block.hpp"
 #include "coordinates/coordinates.hpp"
 #include "interface/variable_state.hpp"
@@ -60,11 +63,23 @@ struct BndInfo {
   bool buf_allocated = true;
   int alloc_status;
   bool same_to_same = false;
+  // The buffer holds floats instead of Reals, see Metadata::SinglePrecisionComms
+  bool single_precision = false;
+  // The buffer holds IEEE half precision values, see Metadata::HalfPrecisionComms
+  bool half_precision = false;
+  // The receiver reads straight from the variable of the sender instead of the buffer,
+  // which is not packed by the sender, see IsDirectLocalCopy
+  bool direct = false;
 
   buf_pool_t<Real>::weak_t buf;        // comm buffer from pool
   ParArrayND<Real, VariableState> var; // data variable used for comms
   Coordinates_t coords;
 
+  // Send side element, indices, and variable of the sender for direct copies
+  TE src_topo_idx[3]{TE::CC, TE::CC, TE::CC};
+  SpatiallyMaskedIndexer6D src_idxer[3];
+  ParArrayND<Real, VariableState> src_var;
+
   KOKKOS_DEFAULTED_FUNCTION
   BndInfo() = default;
   KOKKOS_DEFAULTED_FUNCTION
@@ -124,8 +139,15 @@ struct ProResInfo {
                                         std::shared_ptr<Variable<Real>> v);
 };
 
+// Size of the buffer sent from pmb to nb, or of the buffer received by pmb from nb if
+// send is false
 int GetBufferSize(MeshBlock *pmb, const NeighborBlock &nb,
-                  std::shared_ptr<Variable<Real>> v);
+                  std::shared_ptr<Variable<Real>> v, bool send = true);
+
+// Whether the elements v shares with nb are only exchanged from the block owning them,
+// see Mesh::do_deduplicate_shared_elements
+bool DeduplicatesSharedElements(MeshBlock *pmb, const NeighborBlock &nb,
+                                const std::shared_ptr<Variable<Real>> &v);
 
 using BndInfoArr_t = ParArray1D<BndInfo>;
 using BndInfoArrHost_t = typename BndInfoArr_t::HostMirror;
@@ -165,6 +187,10 @@ struct BvarsSubCache_t {
   void clear() {
     buf_vec.clear();
     idx_vec.clear();
+    coalesced_segments.clear();
+    null_mask_segments.clear();
+    null_mask_layout_ids.clear();
+    stream_ordered_segments.clear();
     if (sending_non_zero_flags.KokkosView().is_allocated())
       sending_non_zero_flags = ParArray1D<bool>{};
     if (sending_non_zero_flags_h.KokkosView().is_allocated())
@@ -178,6 +204,17 @@ struct BvarsSubCache_t {
 
   std::vector<std::size_t> idx_vec;
   std::vector<CommBuffer<buf_pool_t<Real>::owner_t> *> buf_vec;
+  // Subset of the buffers in buf_vec that are communicated as part of coalesced messages
+  std::vector<CoalescedBuffers::Segment> coalesced_segments;
+  // Subset of the buffers in buf_vec whose null sends are signalled through null masks
+  // and the layout ids of these masks that have been announced to each rank
+  std::vector<SparseNullMasks::Segment> null_mask_segments;
+  std::map<int, int> null_mask_layout_ids;
+  // Subset of the buffers in buf_vec that are exchanged in stream order
+  std::vector<CoalescedBuffers::Segment> stream_ordered_segments;
+  // Set while the buffers have been filled but their coalesced send is still waiting
+  // for the other boundary type of a combined exchange
+  bool send_deferred = false;
   ParArray1D<bool> sending_non_zero_flags;
   // Cache both host and device buffer info. Reduces mallocs, and
   // also means the bounds values are available on host if needed.
@@ -20,6 +20,7 @@
 #include <memory>
 #include <random>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "bnd_info.hpp"
@@ -45,58 +46,22 @@ namespace parthenon {
 using namespace loops;
 using namespace loops::shorthands;
 
-template <BoundaryType bound_type>
-TaskStatus SendBoundBufs(std::shared_ptr<MeshData<Real>> &md) {
-  PARTHENON_INSTRUMENT
-
-  Mesh *pmesh = md->GetMeshPointer();
-  auto &cache = md->GetBvarsCache().GetSubCache(bound_type, true);
-
-  if (cache.buf_vec.size() == 0)
-    InitializeBufferCache<bound_type>(md, &(pmesh->boundary_comm_map), &cache, SendKey,
-                                      true);
-
-  auto [rebuild, nbound, other_communication_unfinished] =
-      CheckSendBufferCacheForRebuild<bound_type, true>(md);
-
-  if (nbound == 0) {
-    return TaskStatus::complete;
-  }
-  if (other_communication_unfinished) {
-    return TaskStatus::incomplete;
-  }
-
-  if (rebuild) {
-    if constexpr (bound_type == BoundaryType::gmg_restrict_send) {
-      RebuildBufferCache<bound_type, true>(md, nbound, BndInfo::GetSendBndInfo,
-                                           ProResInfo::GetInteriorRestrict);
-    } else if constexpr (bound_type == BoundaryType::gmg_prolongate_send) {
-      RebuildBufferCache<bound_type, true>(md, nbound, BndInfo::GetSendBndInfo,
-                                           ProResInfo::GetNull);
-    } else {
-      RebuildBufferCache<bound_type, true>(md, nbound, BndInfo::GetSendBndInfo,
-                                           ProResInfo::GetSend);
-    }
-  }
-  // Restrict
-  auto pmb = md->GetBlockData(0)->GetBlockPointer();
-  StateDescriptor *resolved_packages = pmb->resolved_packages.get();
-  refinement::Restrict(resolved_packages, cache.prores_cache, pmb->cellbounds,
-                       pmb->c_cellbounds);
-
-  // Load buffer data
+namespace {
+// Packs the boundary buffers of cache and flags the ones that carry nonzero data, with
+// the loops instantiated for a mesh of DIM dimensions
+template <BoundaryType bound_type, int DIM>
+void LoadBuffers(MeshData<Real> *md, BvarsSubCache_t &cache, const int nbound) {
   auto &bnd_info = cache.bnd_info;
   PARTHENON_DEBUG_REQUIRE(bnd_info.size() == nbound, "Need same size for boundary info");
   auto &sending_nonzero_flags = cache.sending_non_zero_flags;
-  auto &sending_nonzero_flags_h = cache.sending_non_zero_flags_h;
 
   Kokkos::parallel_for(
       PARTHENON_AUTO_LABEL,
-      Kokkos::TeamPolicy<>(parthenon::DevExecSpace(), nbound, Kokkos::AUTO),
+      Kokkos::TeamPolicy<>(md->exec_space, nbound, Kokkos::AUTO),
       KOKKOS_LAMBDA(parthenon::team_mbr_t team_member) {
         const int b = team_member.league_rank();
 
-        if (!bnd_info(b).allocated || bnd_info(b).same_to_same) {
+        if (!bnd_info(b).allocated || bnd_info(b).same_to_same || bnd_info(b).direct) {
           Kokkos::single(Kokkos::PerTeam(team_member),
                          [&]() { sending_nonzero_flags(b) = false; });
           return;
@@ -111,18 +76,34 @@ TaskStatus SendBoundBufs(std::shared_ptr<MeshData<Real>> &md) {
           Kokkos::parallel_reduce(
               Kokkos::TeamThreadRange<>(team_member, idxer.size() / Ni),
               [&](const int idx, bool &lnon_zero) {
-                const auto [t, u, v, k, j, i] = idxer(idx * Ni);
+                const auto [t, u, v, k, j, i] = idxer.template GetIndices<DIM>(idx * Ni);
                 Real *var = &bnd_info(b).var(iel, t, u, v, k, j, i);
-                Real *buf = &bnd_info(b).buf(idx * Ni + idx_offset);
-
-                Kokkos::parallel_for(Kokkos::ThreadVectorRange<>(team_member, Ni),
-                                     [&](int m) { buf[m] = var[m]; });
+                if (bnd_info(b).half_precision) {
+                  using Kokkos::Experimental::half_t;
+                  half_t *buf = reinterpret_cast<half_t *>(bnd_info(b).buf.data()) +
+                                idx * Ni + idx_offset;
+                  Kokkos::parallel_for(
+                      Kokkos::ThreadVectorRange<>(team_member, Ni), [&](int m) {
+                        buf[m] = Kokkos::Experimental::cast_to_half(
+                            static_cast<float>(var[m]));
+                      });
+                } else if (bnd_info(b).single_precision) {
+                  float *buf = reinterpret_cast<float *>(bnd_info(b).buf.data()) +
+                               idx * Ni + idx_offset;
+                  Kokkos::parallel_for(
+                      Kokkos::ThreadVectorRange<>(team_member, Ni),
+                      [&](int m) { buf[m] = static_cast<float>(var[m]); });
+                } else {
+                  Real *buf = &bnd_info(b).buf(idx * Ni + idx_offset);
+                  Kokkos::parallel_for(Kokkos::ThreadVectorRange<>(team_member, Ni),
+                                       [&](int m) { buf[m] = var[m]; });
+                }
 
                 bool mnon_zero = false;
                 Kokkos::parallel_reduce(
                     Kokkos::ThreadVectorRange<>(team_member, Ni),
                     [&](int m, bool &llnon_zero) {
-                      llnon_zero = llnon_zero || (std::abs(buf[m]) >= threshold);
+                      llnon_zero = llnon_zero || (std::abs(var[m]) >= threshold);
                     },
                     Kokkos::LOr<bool, parthenon::DevMemSpace>(mnon_zero));
 
@@ -136,14 +117,190 @@ TaskStatus SendBoundBufs(std::shared_ptr<MeshData<Real>> &md) {
           sending_nonzero_flags(b) = non_zero[0] || non_zero[1] || non_zero[2];
         });
       });
+}
+
+// Unpacks the boundary buffers of cache into the variables, with the loops instantiated
+// for a mesh of DIM dimensions
+template <BoundaryType bound_type, int DIM>
+void UnpackBuffers(MeshData<Real> *md, BvarsSubCache_t &cache, const int nbound) {
+  auto &bnd_info = cache.bnd_info;
+  Kokkos::parallel_for(
+      PARTHENON_AUTO_LABEL,
+      Kokkos::TeamPolicy<>(md->exec_space, nbound, Kokkos::AUTO),
+      KOKKOS_LAMBDA(parthenon::team_mbr_t team_member) {
+        const int b = team_member.league_rank();
+        if (bnd_info(b).same_to_same) return;
+        int idx_offset = 0;
+        for (int it = 0; it < bnd_info(b).ntopological_elements; ++it) {
+          auto &idxer = bnd_info(b).idxer[it];
+          auto &lcoord_trans = bnd_info(b).lcoord_trans;
+          auto &var = bnd_info(b).var;
+          const auto [tel, ftemp] =
+              lcoord_trans.InverseTransform(bnd_info(b).topo_idx[it]);
+          Real fac = ftemp; // Can't capture structured bindings
+          const int iel = static_cast<int>(tel) % 3;
+          const int Ni = idxer.template EndIdx<5>() - idxer.template StartIdx<5>() + 1;
+          if (bnd_info(b).direct) {
+            // Read the values the sender would have packed at the same buffer position
+            auto &src_idxer = bnd_info(b).src_idxer[it];
+            auto &src_var = bnd_info(b).src_var;
+            const int src_iel = static_cast<int>(bnd_info(b).src_topo_idx[it]) % 3;
+            Kokkos::parallel_for(
+                Kokkos::TeamThreadRange<>(team_member, idxer.size() / Ni),
+                [&](const int idx) {
+                  const auto [t, u, v, k, j, i] =
+                      idxer.template GetIndices<DIM>(idx * Ni);
+                  const int tt = t;
+                  const int uu = u;
+                  const int vv = v;
+                  const int kk = k;
+                  const int jj = j;
+                  const int ii = i;
+                  Kokkos::parallel_for(
+                      Kokkos::ThreadVectorRange<>(team_member, Ni), [&](int m) {
+                        const auto [il, jl, kl] =
+                            lcoord_trans.InverseTransform({ii + m, jj, kk});
+                        if (idxer.IsActive(kl, jl, il)) {
+                          const auto [st, su, sv, sk, sj, si] =
+                              src_idxer.template GetIndices<DIM>(idx * Ni + m);
+                          var(iel, tt, uu, vv, kl, jl, il) =
+                              fac * src_var(src_iel, st, su, sv, sk, sj, si);
+                        }
+                      });
+                });
+          } else if (bnd_info(b).buf_allocated && bnd_info(b).allocated) {
+            Kokkos::parallel_for(
+                Kokkos::TeamThreadRange<>(team_member, idxer.size() / Ni),
+                [&](const int idx) {
+                  using Kokkos::Experimental::half_t;
+                  const bool single_precision = bnd_info(b).single_precision;
+                  const bool half_precision = bnd_info(b).half_precision;
+                  const Real *buf = (single_precision || half_precision)
+                                        ? nullptr
+                                        : &bnd_info(b).buf(idx * Ni + idx_offset);
+                  const float *fbuf =
+                      reinterpret_cast<const float *>(bnd_info(b).buf.data()) +
+                      idx * Ni + idx_offset;
+                  const half_t *hbuf =
+                      reinterpret_cast<const half_t *>(bnd_info(b).buf.data()) +
+                      idx * Ni + idx_offset;
+                  const auto [t, u, v, k, j, i] =
+                      idxer.template GetIndices<DIM>(idx * Ni);
+                  // Have to do this because of some weird issue about structure bindings
+                  // being captured
+                  const int tt = t;
+                  const int uu = u;
+                  const int vv = v;
+                  const int kk = k;
+                  const int jj = j;
+                  const int ii = i;
+                  Kokkos::parallel_for(
+                      Kokkos::ThreadVectorRange<>(team_member, Ni), [&](int m) {
+                        const auto [il, jl, kl] =
+                            lcoord_trans.InverseTransform({ii + m, jj, kk});
+                        if (!idxer.IsActive(kl, jl, il)) return;
+                        Real val;
+                        if (half_precision) {
+                          val = Kokkos::Experimental::cast_from_half<float>(hbuf[m]);
+                        } else if (single_precision) {
+                          val = fbuf[m];
+                        } else {
+                          val = buf[m];
+                        }
+                        var(iel, tt, uu, vv, kl, jl, il) = fac * val;
+                      });
+                });
+          } else if (bnd_info(b).allocated && bound_type != BoundaryType::flxcor_recv) {
+            const Real default_val = bnd_info(b).var.sparse_default_val;
+            Kokkos::parallel_for(
+                Kokkos::TeamThreadRange<>(team_member, idxer.size() / Ni),
+                [&](const int idx) {
+                  const auto [t, u, v, k, j, i] =
+                      idxer.template GetIndices<DIM>(idx * Ni);
+                  const int tt = t;
+                  const int uu = u;
+                  const int vv = v;
+                  const int kk = k;
+                  const int jj = j;
+                  const int ii = i;
+                  Kokkos::parallel_for(
+                      Kokkos::ThreadVectorRange<>(team_member, Ni), [&](int m) {
+                        const auto [il, jl, kl] =
+                            lcoord_trans.InverseTransform({ii + m, jj, kk});
+                        if (idxer.IsActive(kl, jl, il))
+                          var(iel, tt, uu, vv, kl, jl, il) = default_val;
+                      });
+                });
+          }
+          idx_offset += idxer.size();
+        }
+      });
+}
 
-  // Send buffers
+// Fills and sends the buffers of bound_type. If post_coalesced is false, the coalesced
+// part of the send is left to the caller, which can then merge the segments of several
+// boundary types into a single message per rank.
+template <BoundaryType bound_type>
+TaskStatus SendBoundBufsImpl(std::shared_ptr<MeshData<Real>> &md,
+                             const bool post_coalesced) {
+  Mesh *pmesh = md->GetMeshPointer();
+  auto &cache = md->GetBvarsCache().GetSubCache(bound_type, true);
+
+  if (cache.buf_vec.size() == 0)
+    InitializeBufferCache<bound_type>(md, &(pmesh->boundary_comm_map), &cache, SendKey,
+                                      true);
+
+  auto [rebuild, nbound, other_communication_unfinished] =
+      CheckSendBufferCacheForRebuild<bound_type, true>(md);
+
+  if (nbound == 0) {
+    // Every rank has to take part in each neighborhood collective
+    if (post_coalesced && pmesh->UseNeighborCollectives(bound_type))
+      pmesh->coalesced_buffers.Send({}, md->exec_space, true);
+    return TaskStatus::complete;
+  }
+  if (other_communication_unfinished) {
+    return TaskStatus::incomplete;
+  }
+
+  if (rebuild) {
+    if constexpr (bound_type == BoundaryType::gmg_restrict_send) {
+      RebuildBufferCache<bound_type, true>(md, nbound, BndInfo::GetSendBndInfo,
+                                           ProResInfo::GetInteriorRestrict);
+    } else if constexpr (bound_type == BoundaryType::gmg_prolongate_send) {
+      RebuildBufferCache<bound_type, true>(md, nbound, BndInfo::GetSendBndInfo,
+                                           ProResInfo::GetNull);
+    } else {
+      RebuildBufferCache<bound_type, true>(md, nbound, BndInfo::GetSendBndInfo,
+                                           ProResInfo::GetSend);
+    }
+  }
+  // Restrict
+  auto pmb = md->GetBlockData(0)->GetBlockPointer();
+  StateDescriptor *resolved_packages = pmb->resolved_packages.get();
+  refinement::Restrict(resolved_packages, cache.prores_cache, pmb->cellbounds,
+                       pmb->c_cellbounds, md->exec_space);
+
+  // Load buffer data
+  DispatchNDim(md->GetNDim(), [&](auto dim) {
+    LoadBuffers<bound_type, decltype(dim)::value>(md.get(), cache, nbound);
+  });
+  auto &sending_nonzero_flags = cache.sending_non_zero_flags;
+  auto &sending_nonzero_flags_h = cache.sending_non_zero_flags_h;
+
+  // Send buffers. With several execution space instances, local receivers can unpack
+  // on a different instance, so the data has to be in the buffers before they are sent.
+  bool fence = Globals::sparse_config.enabled || pmesh->NumExecSpaceInstances() > 1;
   if (Globals::sparse_config.enabled)
-    Kokkos::deep_copy(sending_nonzero_flags_h, sending_nonzero_flags);
+    Kokkos::deep_copy(md->exec_space, sending_nonzero_flags_h, sending_nonzero_flags);
 #ifdef MPI_PARALLEL
-  if (bound_type == BoundaryType::any || bound_type == BoundaryType::nonlocal)
-    Kokkos::fence();
+  // Stream ordered sends wait for the packing kernel on the device
+  if ((bound_type == BoundaryType::any || bound_type == BoundaryType::nonlocal) &&
+      !pmesh->UseStreamOrderedComms(bound_type))
+    fence = true;
 #endif
+  // Only wait for the kernels of this partition, others may still be running
+  if (fence) md->exec_space.fence();
 
   for (int ibuf = 0; ibuf < cache.buf_vec.size(); ++ibuf) {
     auto &buf = *cache.buf_vec[ibuf];
@@ -152,9 +309,31 @@ TaskStatus SendBoundBufs(std::shared_ptr<MeshData<Real>> &md) {
     else
       buf.SendNull();
   }
+  if (post_coalesced && pmesh->UseCoalescedComms(bound_type))
+    pmesh->coalesced_buffers.Send(cache.coalesced_segments, md->exec_space,
+                                  pmesh->UseNeighborCollectives(bound_type));
+  if (pmesh->UseStreamOrderedComms(bound_type)) {
+    // Receives are posted in the same group as the sends
+    auto &recv_cache = md->GetBvarsCache().GetSubCache(bound_type, false);
+    if (recv_cache.buf_vec.size() == 0)
+      InitializeBufferCache<bound_type>(md, &(pmesh->boundary_comm_map), &recv_cache,
+                                        ReceiveKey, false);
+    pmesh->stream_ordered_buffers.Exchange(cache.stream_ordered_segments,
+                                           recv_cache.stream_ordered_segments,
+                                           md->exec_space);
+  }
+  if (pmesh->do_null_masks)
+    pmesh->null_masks.Send(cache.null_mask_segments, &cache.null_mask_layout_ids);
 
   return TaskStatus::complete;
 }
+} // namespace
+
+template <BoundaryType bound_type>
+TaskStatus SendBoundBufs(std::shared_ptr<MeshData<Real>> &md) {
+  PARTHENON_INSTRUMENT
+  return SendBoundBufsImpl<bound_type>(md, true);
+}
 
 template TaskStatus SendBoundBufs<BoundaryType::any>(std::shared_ptr<MeshData<Real>> &);
 template TaskStatus SendBoundBufs<BoundaryType::local>(std::shared_ptr<MeshData<Real>> &);
@@ -167,6 +346,39 @@ SendBoundBufs<BoundaryType::gmg_prolongate_send>(std::shared_ptr<MeshData<Real>>
 template TaskStatus
 SendBoundBufs<BoundaryType::flxcor_send>(std::shared_ptr<MeshData<Real>> &);
 
+TaskStatus SendBoundBufsAndFluxCorrections(std::shared_ptr<MeshData<Real>> &md) {
+  PARTHENON_INSTRUMENT
+  using BT = BoundaryType;
+  Mesh *pmesh = md->GetMeshPointer();
+  auto &flx_cache = md->GetBvarsCache().GetSubCache(BT::flxcor_send, true);
+  auto &cache = md->GetBvarsCache().GetSubCache(BT::any, true);
+
+  // The flux correction buffers are only filled once, even if the ghost buffers are not
+  // ready to be written yet and this task has to be retried
+  if (!flx_cache.send_deferred) {
+    if (SendBoundBufsImpl<BT::flxcor_send>(md, false) == TaskStatus::incomplete)
+      return TaskStatus::incomplete;
+    flx_cache.send_deferred = true;
+  }
+  if (SendBoundBufsImpl<BT::any>(md, false) == TaskStatus::incomplete)
+    return TaskStatus::incomplete;
+  flx_cache.send_deferred = false;
+
+  // One message per rank carrying both the ghost zones and the restricted fine fluxes
+  std::vector<CoalescedBuffers::Segment> segments;
+  if (pmesh->UseCoalescedComms(BT::any))
+    segments.insert(segments.end(), cache.coalesced_segments.begin(),
+                    cache.coalesced_segments.end());
+  if (pmesh->UseCoalescedComms(BT::flxcor_send))
+    segments.insert(segments.end(), flx_cache.coalesced_segments.begin(),
+                    flx_cache.coalesced_segments.end());
+  const bool collective = pmesh->UseNeighborCollectives(BT::any) ||
+                          pmesh->UseNeighborCollectives(BT::flxcor_send);
+  if (segments.size() > 0 || collective)
+    pmesh->coalesced_buffers.Send(segments, md->exec_space, collective);
+  return TaskStatus::complete;
+}
+
 template <BoundaryType bound_type>
 TaskStatus StartReceiveBoundBufs(std::shared_ptr<MeshData<Real>> &md) {
   PARTHENON_INSTRUMENT
@@ -205,6 +417,9 @@ TaskStatus ReceiveBoundBufs(std::shared_ptr<MeshData<Real>> &md) {
     InitializeBufferCache<bound_type>(md, &(pmesh->boundary_comm_map), &cache, ReceiveKey,
                                       false);
 
+  if (pmesh->UseCoalescedComms(bound_type)) pmesh->coalesced_buffers.TryReceive();
+  if (pmesh->do_null_masks) pmesh->null_masks.TryReceive();
+
   bool all_received = true;
   std::for_each(
       std::begin(cache.buf_vec), std::end(cache.buf_vec),
@@ -245,6 +460,16 @@ ReceiveBoundBufs<BoundaryType::gmg_prolongate_recv>(std::shared_ptr<MeshData<Rea
 template TaskStatus
 ReceiveBoundBufs<BoundaryType::flxcor_recv>(std::shared_ptr<MeshData<Real>> &);
 
+TaskStatus ReceiveBoundBufsAndFluxCorrections(std::shared_ptr<MeshData<Real>> &md) {
+  PARTHENON_INSTRUMENT
+  // Both calls have to be made every time, since each of them drains the coalesced
+  // messages that have arrived into the receive buffers
+  const bool ghosts = ReceiveBoundBufs<BoundaryType::any>(md) == TaskStatus::complete;
+  const bool fluxes =
+      ReceiveBoundBufs<BoundaryType::flxcor_recv>(md) == TaskStatus::complete;
+  return (ghosts && fluxes) ? TaskStatus::complete : TaskStatus::incomplete;
+}
+
 template <BoundaryType bound_type>
 TaskStatus SetBounds(std::shared_ptr<MeshData<Real>> &md) {
   PARTHENON_INSTRUMENT
@@ -266,72 +491,12 @@ TaskStatus SetBounds(std::shared_ptr<MeshData<Real>> &md) {
                                             ProResInfo::GetSet);
     }
   }
-  // const Real threshold = Globals::sparse_config.allocation_threshold;
-  auto &bnd_info = cache.bnd_info;
-  Kokkos::parallel_for(
-      PARTHENON_AUTO_LABEL,
-      Kokkos::TeamPolicy<>(parthenon::DevExecSpace(), nbound, Kokkos::AUTO),
-      KOKKOS_LAMBDA(parthenon::team_mbr_t team_member) {
-        const int b = team_member.league_rank();
-        if (bnd_info(b).same_to_same) return;
-        int idx_offset = 0;
-        for (int it = 0; it < bnd_info(b).ntopological_elements; ++it) {
-          auto &idxer = bnd_info(b).idxer[it];
-          auto &lcoord_trans = bnd_info(b).lcoord_trans;
-          auto &var = bnd_info(b).var;
-          const auto [tel, ftemp] =
-              lcoord_trans.InverseTransform(bnd_info(b).topo_idx[it]);
-          Real fac = ftemp; // Can't capture structured bindings
-          const int iel = static_cast<int>(tel) % 3;
-          const int Ni = idxer.template EndIdx<5>() - idxer.template StartIdx<5>() + 1;
-          if (bnd_info(b).buf_allocated && bnd_info(b).allocated) {
-            Kokkos::parallel_for(
-                Kokkos::TeamThreadRange<>(team_member, idxer.size() / Ni),
-                [&](const int idx) {
-                  Real *buf = &bnd_info(b).buf(idx * Ni + idx_offset);
-                  const auto [t, u, v, k, j, i] = idxer(idx * Ni);
-                  // Have to do this because of some weird issue about structure bindings
-                  // being captured
-                  const int tt = t;
-                  const int uu = u;
-                  const int vv = v;
-                  const int kk = k;
-                  const int jj = j;
-                  const int ii = i;
-                  Kokkos::parallel_for(
-                      Kokkos::ThreadVectorRange<>(team_member, Ni), [&](int m) {
-                        const auto [il, jl, kl] =
-                            lcoord_trans.InverseTransform({ii + m, jj, kk});
-                        if (idxer.IsActive(kl, jl, il))
-                          var(iel, tt, uu, vv, kl, jl, il) = fac * buf[m];
-                      });
-                });
-          } else if (bnd_info(b).allocated && bound_type != BoundaryType::flxcor_recv) {
-            const Real default_val = bnd_info(b).var.sparse_default_val;
-            Kokkos::parallel_for(
-                Kokkos::TeamThreadRange<>(team_member, idxer.size() / Ni),
-                [&](const int idx) {
-                  const auto [t, u, v, k, j, i] = idxer(idx * Ni);
-                  const int tt = t;
-                  const int uu = u;
-                  const int vv = v;
-                  const int kk = k;
-                  const int jj = j;
-                  const int ii = i;
-                  Kokkos::parallel_for(
-                      Kokkos::ThreadVectorRange<>(team_member, Ni), [&](int m) {
-                        const auto [il, jl, kl] =
-                            lcoord_trans.InverseTransform({ii + m, jj, kk});
-                        if (idxer.IsActive(kl, jl, il))
-                          var(iel, tt, uu, vv, kl, jl, il) = default_val;
-                      });
-                });
-          }
-          idx_offset += idxer.size();
-        }
-      });
+  DispatchNDim(md->GetNDim(), [&](auto dim) {
+    UnpackBuffers<bound_type, decltype(dim)::value>(md.get(), cache, nbound);
+  });
 #ifdef MPI_PARALLEL
-  Kokkos::fence();
+  // Stream ordered receives into the buffers wait for the kernel on the device
+  if (!pmesh->UseStreamOrderedComms(bound_type)) md->exec_space.fence();
 #endif
   std::for_each(std::begin(cache.buf_vec), std::end(cache.buf_vec),
                 [](auto pbuf) { pbuf->Stale(); });
@@ -340,7 +505,7 @@ TaskStatus SetBounds(std::shared_ptr<MeshData<Real>> &md) {
     auto pmb = md->GetBlockData(0)->GetBlockPointer();
     StateDescriptor *resolved_packages = pmb->resolved_packages.get();
     refinement::Restrict(resolved_packages, cache.prores_cache, pmb->cellbounds,
-                         pmb->c_cellbounds);
+                         pmb->c_cellbounds, md->exec_space);
   }
   return TaskStatus::complete;
 }
@@ -383,9 +548,9 @@ TaskStatus ProlongateBounds(std::shared_ptr<MeshData<Real>> &md) {
 
     // Prolongate from coarse buffer
     refinement::ProlongateShared(resolved_packages, cache.prores_cache, pmb->cellbounds,
-                                 pmb->c_cellbounds);
+                                 pmb->c_cellbounds, md->exec_space);
     refinement::ProlongateInternal(resolved_packages, cache.prores_cache, pmb->cellbounds,
-                                   pmb->c_cellbounds);
+                                   pmb->c_cellbounds, md->exec_space);
   }
   return TaskStatus::complete;
 }
@@ -401,8 +566,9 @@ ProlongateBounds<BoundaryType::gmg_prolongate_recv>(std::shared_ptr<MeshData<Rea
 
 // Adds all relevant boundary communication to a single task list
 template <BoundaryType bounds>
-TaskID AddBoundaryExchangeTasks(TaskID dependency, TaskList &tl,
-                                std::shared_ptr<MeshData<Real>> &md, bool multilevel) {
+std::pair<TaskID, TaskID>
+AddSplitBoundaryExchangeTasks(TaskID dependency, TaskList &tl,
+                              std::shared_ptr<MeshData<Real>> &md, bool multilevel) {
   // TODO(LFR): Splitting up the boundary tasks while doing prolongation can cause some
   //            possible issues for sparse fields. In particular, the order in which
   //            fields are allocated and then set could potentially result in different
@@ -428,7 +594,8 @@ TaskID AddBoundaryExchangeTasks(TaskID dependency, TaskList &tl,
 
   // auto out = (pro_local | pro);
 
-  auto send = tl.AddTask(dependency, TF(SendBoundBufs<bounds>), md);
+  auto send =
+      tl.AddTask(TaskQualifier::high_priority, dependency, TF(SendBoundBufs<bounds>), md);
   auto recv = tl.AddTask(dependency, TF(ReceiveBoundBufs<bounds>), md);
   auto set = tl.AddTask(recv, TF(SetBounds<bounds>), md);
 
@@ -439,7 +606,20 @@ TaskID AddBoundaryExchangeTasks(TaskID dependency, TaskList &tl,
   }
   auto fbound = tl.AddTask(pro, TF(ApplyBoundaryConditionsOnCoarseOrFineMD), md, false);
 
-  return fbound;
+  return {send, fbound};
+}
+template std::pair<TaskID, TaskID>
+AddSplitBoundaryExchangeTasks<BoundaryType::any>(TaskID, TaskList &,
+                                                 std::shared_ptr<MeshData<Real>> &, bool);
+template std::pair<TaskID, TaskID>
+AddSplitBoundaryExchangeTasks<BoundaryType::gmg_same>(TaskID, TaskList &,
+                                                      std::shared_ptr<MeshData<Real>> &,
+                                                      bool);
+
+template <BoundaryType bounds>
+TaskID AddBoundaryExchangeTasks(TaskID dependency, TaskList &tl,
+                                std::shared_ptr<MeshData<Real>> &md, bool multilevel) {
+  return AddSplitBoundaryExchangeTasks<bounds>(dependency, tl, md, multilevel).second;
 }
 template TaskID
 AddBoundaryExchangeTasks<BoundaryType::any>(TaskID, TaskList &,
@@ -452,9 +632,29 @@ AddBoundaryExchangeTasks<BoundaryType::gmg_same>(TaskID, TaskList &,
 TaskID AddFluxCorrectionTasks(TaskID dependency, TaskList &tl,
                               std::shared_ptr<MeshData<Real>> &md, bool multilevel) {
   if (!multilevel) return dependency;
-  tl.AddTask(dependency, TF(SendBoundBufs<BoundaryType::flxcor_send>), md);
+  tl.AddTask(TaskQualifier::high_priority, dependency,
+             TF(SendBoundBufs<BoundaryType::flxcor_send>), md);
   auto receive =
       tl.AddTask(dependency, TF(ReceiveBoundBufs<BoundaryType::flxcor_recv>), md);
   return tl.AddTask(receive, TF(SetBounds<BoundaryType::flxcor_recv>), md);
 }
+
+TaskID AddCombinedBoundaryExchangeTasks(TaskID dependency, TaskList &tl,
+                                        std::shared_ptr<MeshData<Real>> &md,
+                                        bool multilevel) {
+  if (!multilevel) return AddBoundaryExchangeTasks(dependency, tl, md, multilevel);
+  tl.AddTask(TaskQualifier::high_priority, dependency,
+             TF(SendBoundBufsAndFluxCorrections), md);
+  auto recv = tl.AddTask(dependency, TF(ReceiveBoundBufsAndFluxCorrections), md);
+  auto set_flx = tl.AddTask(recv, TF(SetBounds<BoundaryType::flxcor_recv>), md);
+  auto set = tl.AddTask(recv, TF(SetBounds<BoundaryType::any>), md);
+
+  auto pro = set;
+  if (md->GetMeshPointer()->multilevel) {
+    auto cbound = tl.AddTask(set, TF(ApplyBoundaryConditionsOnCoarseOrFineMD), md, true);
+    pro = tl.AddTask(cbound, TF(ProlongateBounds<BoundaryType::any>), md);
+  }
+  auto fbound = tl.AddTask(pro, TF(ApplyBoundaryConditionsOnCoarseOrFineMD), md, false);
+  return fbound | set_flx;
+}
 } // namespace parthenon
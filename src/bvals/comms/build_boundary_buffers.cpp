@@ -32,6 +32,7 @@
 #include "mesh/mesh_refinement.hpp"
 #include "mesh/meshblock.hpp"
 #include "utils/error_checking.hpp"
+#include "utils/object_pool.hpp"
 #include "utils/loop_utils.hpp"
 
 namespace parthenon {
@@ -44,26 +45,47 @@ template <BoundaryType BTYPE>
 void BuildBoundaryBufferSubset(std::shared_ptr<MeshData<Real>> &md,
                                Mesh::comm_buf_map_t &buf_map) {
   Mesh *pmesh = md->GetMeshPointer();
-  ForEachBoundary<BTYPE>(md, [&](auto pmb, sp_mbd_t /*rc*/, nb_t &nb, const sp_cv_t v) {
-    // Calculate the required size of the buffer for this boundary
+  // Buffers are shared by all stages, so they have to be built independent of the
+  // stages a variable is exchanged in
+  constexpr bool all_stages = true;
+  ForEachBoundary<BTYPE, all_stages>(md, [&](auto pmb, sp_mbd_t /*rc*/, nb_t &nb,
+                                             const sp_cv_t v) {
+    // Calculate the required size of the buffers for this boundary. Both directions
+    // have the same size unless shared elements are only sent by their owner.
+    const bool deduplicated = DeduplicatesSharedElements(pmb, nb, v);
     int buf_size = GetBufferSize(pmb, nb, v);
     if (pmb->gid == nb.gid && nb.offsets.IsCell()) buf_size = 0;
+    const int recv_buf_size = deduplicated ? GetBufferSize(pmb, nb, v, false) : buf_size;
 
-    // Add a buffer pool if one does not exist for this size
-    if (pmesh->pool_map.count(buf_size) == 0) {
+    // Add a buffer pool if one does not exist for this size class. Buffers of similar
+    // sizes share a pool and are views of the first buf_size elements of a pool object
+    auto add_pool = [pmesh](const int pool_size) {
+      if (pmesh->pool_map.count(pool_size) > 0) return;
       pmesh->pool_map.emplace(std::make_pair(
-          buf_size, buf_pool_t<Real>([buf_size](buf_pool_t<Real> *pool) {
+          pool_size, buf_pool_t<Real>([pmesh, pool_size](buf_pool_t<Real> *pool) {
             using buf_t = buf_pool_t<Real>::base_t;
             // TODO(LFR): Make nbuf a user settable parameter
             const int nbuf = 200;
-            buf_t chunk("pool buffer", buf_size * nbuf);
+            buf_t chunk;
+            try {
+              chunk = buf_t("pool buffer", pool_size * nbuf);
+            } catch (const std::exception &) {
+              // Out of memory (reported as std::bad_alloc or std::runtime_error depending
+              // on the Kokkos version), so drop the unused buffers of all pools and retry
+              pmesh->TrimBufferPools(0);
+              chunk = buf_t("pool buffer", pool_size * nbuf);
+            }
             for (int i = 1; i < nbuf; ++i) {
               pool->AddFreeObjectToPool(
-                  buf_t(chunk, std::make_pair(i * buf_size, (i + 1) * buf_size)));
+                  buf_t(chunk, std::make_pair(i * pool_size, (i + 1) * pool_size)));
             }
-            return buf_t(chunk, std::make_pair(0, buf_size));
+            return buf_t(chunk, std::make_pair(0, pool_size));
           })));
-    }
+    };
+    const int pool_size = PoolSizeClass(buf_size);
+    const int recv_pool_size = PoolSizeClass(recv_buf_size);
+    add_pool(pool_size);
+    add_pool(recv_pool_size);
 
     const int receiver_rank = nb.rank;
     const int sender_rank = Globals::my_rank;
@@ -81,27 +103,83 @@ void BuildBoundaryBufferSubset(std::shared_ptr<MeshData<Real>> &md,
 #endif
 
     bool use_sparse_buffers = v->IsSet(Metadata::Sparse);
-    auto get_resource_method = [pmesh, buf_size]() {
-      return buf_pool_t<Real>::owner_t(pmesh->pool_map.at(buf_size).Get());
+    auto get_resource_method = [pmesh, buf_size, pool_size]() {
+      return buf_pool_t<Real>::owner_t(pmesh->pool_map.at(pool_size).Get(buf_size));
     };
+    auto get_recv_resource_method = [pmesh, recv_buf_size, recv_pool_size]() {
+      return buf_pool_t<Real>::owner_t(
+          pmesh->pool_map.at(recv_pool_size).Get(recv_buf_size));
+    };
+
+    // Non-local buffers are exchanged through combined messages in coalesced mode
+    const bool coalesced =
+        pmesh->UseCoalescedComms(BTYPE) && sender_rank != receiver_rank;
+    // Non-local ghost buffers are sent and received in stream order if requested
+    const bool stream_ordered =
+        pmesh->UseStreamOrderedComms(BTYPE) && sender_rank != receiver_rank;
+    // Non-sparse buffers to other ranks on the same node are exchanged through shared
+    // memory if possible
+    const bool node_shared = !coalesced && !stream_ordered && !use_sparse_buffers &&
+                             pmesh->node_shared_buffers.SharesNode(receiver_rank);
+    // Non-sparse buffers to other ranks go through pinned host memory if MPI can't
+    // access device memory
+    const bool host_staged = pmesh->host_staging.Enabled() && !coalesced &&
+                             !node_shared && !stream_ordered && !use_sparse_buffers &&
+                             sender_rank != receiver_rank;
+    // The size of messages is only fixed for non-sparse variables
+    const bool persistent = pmesh->do_persistent_comms && !coalesced && !node_shared &&
+                            !stream_ordered && !host_staged && !use_sparse_buffers &&
+                            sender_rank != receiver_rank;
+    // Null sends of sparse variables are signalled through the null masks
+    const bool null_masked = pmesh->do_null_masks && !coalesced && use_sparse_buffers &&
+                             sender_rank != receiver_rank;
 
     // Build send buffer (unless this is a receiving flux boundary)
     if constexpr (IsSender(BTYPE)) {
       auto s_key = SendKey(pmb, nb, v, BTYPE);
-      if (buf_map.count(s_key) == 0)
+      if (buf_map.count(s_key) == 0) {
         buf_map[s_key] = CommBuffer<buf_pool_t<Real>::owner_t>(
             tag, sender_rank, receiver_rank, comm, get_resource_method,
             use_sparse_buffers);
+        buf_map[s_key].SetCoalesced(coalesced);
+        buf_map[s_key].SetPersistent(persistent);
+        buf_map[s_key].SetNullMasked(null_masked);
+        buf_map[s_key].SetStreamOrdered(stream_ordered);
+        if (host_staged) buf_map[s_key].SetHostStaged(&(pmesh->host_staging));
+        if (node_shared)
+          pmesh->node_shared_buffers.Add(receiver_rank, s_key, &buf_map[s_key], buf_size,
+                                         true);
+        if (stream_ordered)
+          pmesh->stream_ordered_buffers.Add(receiver_rank, s_key, &buf_map[s_key],
+                                            buf_size, true);
+      } else {
+        // Kept from before the last remesh, but the tags have been reassigned
+        buf_map[s_key].SetTag(tag);
+      }
     }
 
     // Also build the non-local receive buffers here
     if constexpr (IsReceiver(BTYPE)) {
       if (sender_rank != receiver_rank) {
         auto r_key = ReceiveKey(pmb, nb, v, BTYPE);
-        if (buf_map.count(r_key) == 0)
+        if (buf_map.count(r_key) == 0) {
           buf_map[r_key] = CommBuffer<buf_pool_t<Real>::owner_t>(
-              tag, receiver_rank, sender_rank, comm, get_resource_method,
+              tag, receiver_rank, sender_rank, comm, get_recv_resource_method,
               use_sparse_buffers);
+          buf_map[r_key].SetCoalesced(coalesced);
+          buf_map[r_key].SetPersistent(persistent);
+          buf_map[r_key].SetNullMasked(null_masked);
+          buf_map[r_key].SetStreamOrdered(stream_ordered);
+          if (host_staged) buf_map[r_key].SetHostStaged(&(pmesh->host_staging));
+          if (node_shared)
+            pmesh->node_shared_buffers.Add(receiver_rank, r_key, &buf_map[r_key], 0,
+                                           false);
+          if (stream_ordered)
+            pmesh->stream_ordered_buffers.Add(receiver_rank, r_key, &buf_map[r_key], 0,
+                                              false);
+        } else {
+          buf_map[r_key].SetTag(tag);
+        }
       }
     }
   });
@@ -20,6 +20,7 @@
 
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "basic_types.hpp"
@@ -84,10 +85,33 @@ template <BoundaryType bounds = BoundaryType::any>
 TaskID AddBoundaryExchangeTasks(TaskID dependency, TaskList &tl,
                                 std::shared_ptr<MeshData<Real>> &md, bool multilevel);
 
+// Same as AddBoundaryExchangeTasks, but additionally returns the id of the task sending
+// the boundary buffers as the first element of the pair. Work on the core regions of
+// the blocks (see IndexShape::GetCoreRegion) only needs to depend on this task and
+// overlaps with the communication, while work on the rim regions has to depend on the
+// completed exchange returned as the second element.
+template <BoundaryType bounds = BoundaryType::any>
+std::pair<TaskID, TaskID>
+AddSplitBoundaryExchangeTasks(TaskID dependency, TaskList &tl,
+                              std::shared_ptr<MeshData<Real>> &md, bool multilevel);
+
 // Adds all relevant flux correction tasks to a single task list
 TaskID AddFluxCorrectionTasks(TaskID dependency, TaskList &tl,
                               std::shared_ptr<MeshData<Real>> &md, bool multilevel);
 
+// Exchanges the ghost zones and the flux corrections in a single communication round.
+// The restricted fine fluxes are sent together with the ghost zones, in the same
+// coalesced message per rank pair if coalesced communication is enabled. This is only
+// valid for schemes that tolerate the ghost zones of fine blocks next to coarse blocks
+// being filled before the coarse fluxes are corrected, and that apply the corrected
+// fluxes themselves (e.g. as a fix-up of the coarse cells next to the fine-coarse
+// faces). Falls back to AddBoundaryExchangeTasks without mesh refinement.
+TaskStatus SendBoundBufsAndFluxCorrections(std::shared_ptr<MeshData<Real>> &md);
+TaskStatus ReceiveBoundBufsAndFluxCorrections(std::shared_ptr<MeshData<Real>> &md);
+TaskID AddCombinedBoundaryExchangeTasks(TaskID dependency, TaskList &tl,
+                                        std::shared_ptr<MeshData<Real>> &md,
+                                        bool multilevel);
+
 // These tasks should not be called in down stream code
 TaskStatus BuildBoundaryBuffers(std::shared_ptr<MeshData<Real>> &md);
 TaskStatus BuildGMGBoundaryBuffers(std::shared_ptr<MeshData<Real>> &md);
@@ -27,6 +27,7 @@
 
 #include "bvals/comms/bnd_info.hpp"
 #include "bvals/comms/bvals_in_one.hpp"
+#include "globals.hpp"
 #include "interface/variable.hpp"
 #include "mesh/domain.hpp"
 #include "mesh/mesh.hpp"
@@ -87,7 +88,7 @@ void InitializeBufferCache(std::shared_ptr<MeshData<Real>> &md, COMM_MAP *comm_m
   using namespace loops::shorthands;
   Mesh *pmesh = md->GetMeshPointer();
 
-  std::vector<std::tuple<int, int, Mesh::channel_key_t>> key_order;
+  std::vector<std::tuple<int, int, Mesh::channel_key_t, int>> key_order;
 
   int boundary_idx = 0;
   ForEachBoundary<bound_type>(md, [&](auto pmb, sp_mbd_t rc, nb_t &nb, const sp_cv_t v) {
@@ -97,7 +98,7 @@ void InitializeBufferCache(std::shared_ptr<MeshData<Real>> &md, COMM_MAP *comm_m
     // Create a unique index by combining receiver gid (second element of the key
     // tuple) and geometric element index (fourth element of the key tuple)
     int recvr_idx = 27 * GetReceiverGid(key) + GetLocIdx(key);
-    key_order.push_back({recvr_idx, boundary_idx, key});
+    key_order.push_back({recvr_idx, boundary_idx, key, nb.rank});
     ++boundary_idx;
   });
 
@@ -113,6 +114,10 @@ void InitializeBufferCache(std::shared_ptr<MeshData<Real>> &md, COMM_MAP *comm_m
 
   int buff_idx = 0;
   pcache->buf_vec.clear();
+  pcache->coalesced_segments.clear();
+  pcache->null_mask_segments.clear();
+  pcache->null_mask_layout_ids.clear();
+  pcache->stream_ordered_segments.clear();
   pcache->idx_vec = std::vector<std::size_t>(key_order.size());
   std::for_each(std::begin(key_order), std::end(key_order), [&](auto &t) {
     if (comm_map->count(std::get<2>(t)) == 0) {
@@ -124,6 +129,15 @@ void InitializeBufferCache(std::shared_ptr<MeshData<Real>> &md, COMM_MAP *comm_m
     }
     pcache->buf_vec.push_back(&((*comm_map)[std::get<2>(t)]));
     (pcache->idx_vec)[std::get<1>(t)] = buff_idx++;
+    if (pcache->buf_vec.back()->IsCoalesced())
+      pcache->coalesced_segments.push_back(
+          {std::get<3>(t), std::get<2>(t), pcache->buf_vec.back()});
+    if (pcache->buf_vec.back()->IsNullMasked())
+      pcache->null_mask_segments.push_back(
+          {std::get<3>(t), std::get<2>(t), pcache->buf_vec.back()});
+    if (pcache->buf_vec.back()->IsStreamOrdered())
+      pcache->stream_ordered_segments.push_back(
+          {std::get<3>(t), std::get<2>(t), pcache->buf_vec.back()});
   });
 
   const int nbound = pcache->buf_vec.size();
@@ -136,6 +150,15 @@ void InitializeBufferCache(std::shared_ptr<MeshData<Real>> &md, COMM_MAP *comm_m
   }
 }
 
+// Without sparse variables, every variable is allocated and every buffer is active from
+// the start, so allocation statuses and buffer resources can only change when the
+// boundary buffers are rebuilt, which also clears the cache. Once the cache info has been
+// built, the checks of the individual boundaries can then be skipped.
+inline bool BufferCacheIsCurrent(const BvarsSubCache_t &cache) {
+  return !Globals::sparse_config.enabled && cache.buf_vec.size() > 0 &&
+         cache.bnd_info_h.size() == cache.buf_vec.size();
+}
+
 template <BoundaryType BOUND_TYPE, bool SENDER>
 inline auto CheckSendBufferCacheForRebuild(std::shared_ptr<MeshData<Real>> md) {
   using namespace loops;
@@ -145,6 +168,12 @@ inline auto CheckSendBufferCacheForRebuild(std::shared_ptr<MeshData<Real>> md) {
   bool rebuild = false;
   bool other_communication_unfinished = false;
   int nbound = 0;
+  if (BufferCacheIsCurrent(cache)) {
+    for (auto pbuf : cache.buf_vec)
+      if (!pbuf->IsAvailableForWrite()) other_communication_unfinished = true;
+    nbound = cache.idx_vec.size();
+    return std::make_tuple(rebuild, nbound, other_communication_unfinished);
+  }
   ForEachBoundary<BOUND_TYPE>(md, [&](auto pmb, sp_mbd_t rc, nb_t &nb, const sp_cv_t v) {
     const std::size_t ibuf = cache.idx_vec[nbound];
     auto &buf = *(cache.buf_vec[ibuf]);
@@ -176,6 +205,10 @@ inline auto CheckReceiveBufferCacheForRebuild(std::shared_ptr<MeshData<Real>> md
 
   bool rebuild = false;
   int nbound = 0;
+  if (BufferCacheIsCurrent(cache)) {
+    nbound = cache.idx_vec.size();
+    return std::make_tuple(rebuild, nbound);
+  }
 
   ForEachBoundary<BOUND_TYPE>(md, [&](auto pmb, sp_mbd_t rc, nb_t &nb, const sp_cv_t v) {
     const std::size_t ibuf = cache.idx_vec[nbound];
@@ -201,6 +234,60 @@ inline auto CheckReceiveBufferCacheForRebuild(std::shared_ptr<MeshData<Real>> md
   return std::make_tuple(rebuild, nbound);
 }
 
+// Ghost zones of cell centered variables that are exchanged between two blocks of the
+// same MeshData object can be set straight from the variable of the sending block,
+// skipping the pack into and the unpack from their (local) buffer. Since all blocks of
+// md are updated by the same tasks, the interior of the sender cannot change before the
+// ghost zones of the receiver have been set. Other topological elements are excluded
+// since shared elements belong to the send region of one block and to the receive region
+// of its neighbor, which are then set in the same kernel. Without sparse variables,
+// no null sends have to be detected while packing. Sender and receiver both have to
+// come to the same conclusion, so this only depends on md, nb, and v.
+template <BoundaryType BOUND_TYPE>
+inline bool IsDirectLocalCopy(std::shared_ptr<MeshData<Real>> &md,
+                              const NeighborBlock &nb,
+                              const std::shared_ptr<Variable<Real>> &v) {
+  if constexpr (BOUND_TYPE != BoundaryType::any && BOUND_TYPE != BoundaryType::local) {
+    return false;
+  } else {
+    return md->GetMeshPointer()->do_direct_local_copies &&
+           !Globals::sparse_config.enabled && nb.rank == Globals::my_rank &&
+           v->IsSet(Metadata::Cell) && !v->IsSet(Metadata::SinglePrecisionComms) &&
+           !v->IsSet(Metadata::HalfPrecisionComms) && md->ContainsGid(nb.gid);
+  }
+}
+
+// Fill the send side of the receiving BndInfo info for a direct copy from the
+// neighbor nb of pmb
+template <BoundaryType BOUND_TYPE>
+inline void SetDirectLocalCopySource(std::shared_ptr<MeshData<Real>> &md, MeshBlock *pmb,
+                                     const NeighborBlock &nb,
+                                     const std::shared_ptr<Variable<Real>> &v,
+                                     CommBuffer<buf_pool_t<Real>::owner_t> *buf,
+                                     BndInfo *info) {
+  for (int block = 0; block < md->NumBlocks(); ++block) {
+    auto &rc = md->GetBlockData(block);
+    auto spmb = rc->GetBlockPointer();
+    if (spmb->gid != nb.gid) continue;
+    auto sv = rc->GetVarPtr(v->label());
+    const auto key = ReceiveKey(pmb, nb, v, BOUND_TYPE);
+    for (auto &snb : spmb->neighbors) {
+      if (snb.gid != pmb->gid || SendKey(spmb, snb, sv, BOUND_TYPE) != key) continue;
+      auto src = BndInfo::GetSendBndInfo(spmb, snb, sv, buf);
+      PARTHENON_REQUIRE(src.ntopological_elements == info->ntopological_elements,
+                        "Sender and receiver of a direct copy disagree on the elements.");
+      for (int it = 0; it < src.ntopological_elements; ++it) {
+        info->src_topo_idx[it] = src.topo_idx[it];
+        info->src_idxer[it] = src.idxer[it];
+      }
+      info->src_var = src.var;
+      info->direct = true;
+      return;
+    }
+  }
+  PARTHENON_FAIL("Could not find the sender of a direct local copy.");
+}
+
 using F_BND_INFO = std::function<BndInfo(MeshBlock *pmb, const NeighborBlock &nb,
                                          std::shared_ptr<Variable<Real>> v,
                                          CommBuffer<buf_pool_t<Real>::owner_t> *buf)>;
@@ -231,6 +318,14 @@ inline void RebuildBufferCache(std::shared_ptr<MeshData<Real>> md, int nbound,
     // bnd_info
     const std::size_t ibuf = cache.idx_vec[ibound];
     cache.bnd_info_h(ibuf) = BndInfoCreator(pmb, nb, v, cache.buf_vec[ibuf]);
+    if (IsDirectLocalCopy<BOUND_TYPE>(md, nb, v)) {
+      if constexpr (SENDER) {
+        cache.bnd_info_h(ibuf).direct = true;
+      } else {
+        SetDirectLocalCopySource<BOUND_TYPE>(md, pmb, nb, v, cache.buf_vec[ibuf],
+                                             &cache.bnd_info_h(ibuf));
+      }
+    }
 
     // subsets ordering is same as in cache.bnd_info
     // RefinementFunctions_t owns all relevant functionality, so
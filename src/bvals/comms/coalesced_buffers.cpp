@@ -0,0 +1,377 @@
+//========================================================================================
+// Parthenon performance portable AMR framework
+// Copyright(C) 2024 The Parthenon collaboration
+// Licensed under the 3-clause BSD License, see LICENSE file for details
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bvals/comms/coalesced_buffers.hpp"
+#include "globals.hpp"
+#include "interface/state_descriptor.hpp"
+#include "mesh/mesh.hpp"
+#include "utils/comm_statistics.hpp"
+#include "utils/error_checking.hpp"
+
+namespace parthenon {
+
+namespace {
+// Number of entries in the header for every buffer
+constexpr int nheader = 6;
+} // namespace
+
+void CoalescedBuffers::Initialize(Mesh *pmesh) {
+  pmesh_ = pmesh;
+  // Variables are identified by their position in the (globally consistent) sorted list
+  // of all field labels
+  var_labels_.clear();
+  var_ids_.clear();
+  for (auto &pair : pmesh->resolved_packages->AllFields())
+    var_labels_.push_back(pair.first.label());
+  std::sort(var_labels_.begin(), var_labels_.end());
+  for (int i = 0; i < var_labels_.size(); ++i)
+    var_ids_[var_labels_[i]] = i;
+
+#ifdef MPI_PARALLEL
+  // The graph changes with every remesh
+  FreeGraphComms();
+  neighbors_.clear();
+  if (!pmesh->do_neighbor_collective_comms) return;
+  PARTHENON_REQUIRE_THROWS(pmesh->DefaultNumPartitions() == 1,
+                           "neighbor_collective_comms requires a single partition per "
+                           "rank.");
+  // Boundary communication is symmetric, so every rank that this rank sends coalesced
+  // buffers to also sends coalesced buffers to this rank
+  std::set<int> neighbors;
+  for (auto &[key, buf] : pmesh->boundary_comm_map)
+    if (buf.IsCoalesced()) neighbors.insert(buf.GetOtherRank());
+  neighbors_.assign(neighbors.begin(), neighbors.end());
+  const int n = neighbors_.size();
+  PARTHENON_MPI_CHECK(MPI_Dist_graph_create_adjacent(
+      MPI_COMM_WORLD, n, neighbors_.data(), MPI_UNWEIGHTED, n, neighbors_.data(),
+      MPI_UNWEIGHTED, MPI_INFO_NULL, 0, &graph_comms_[0]));
+  PARTHENON_MPI_CHECK(MPI_Comm_dup(graph_comms_[0], &graph_comms_[1]));
+#endif
+}
+
+#ifdef MPI_PARALLEL
+std::size_t CoalescedBuffers::PackHeader(const std::vector<const Segment *> &segs,
+                                         std::vector<int> *header) const {
+  header->push_back(segs.size());
+  std::size_t total_size = 0;
+  for (auto pseg : segs) {
+    auto &key = pseg->key;
+    auto &buf = *(pseg->buf);
+    const int size = buf.GetState() == BufferState::sending ? buf.buffer().size() : 0;
+    header->insert(header->end(), {std::get<0>(key), std::get<1>(key),
+                                   var_ids_.at(std::get<2>(key)), std::get<3>(key),
+                                   std::get<4>(key), size});
+    total_size += size;
+  }
+  return total_size;
+}
+#endif
+
+void CoalescedBuffers::Send(const std::vector<Segment> &segments,
+                            const DevExecSpace &exec_space, const bool collective) {
+#ifdef MPI_PARALLEL
+  // Get rid of messages that have already been delivered
+  for (auto it = sends_.begin(); it != sends_.end();) {
+    int flag;
+    PARTHENON_MPI_CHECK(MPI_Testall(2, it->requests, &flag, MPI_STATUSES_IGNORE));
+    it = flag ? sends_.erase(it) : std::next(it);
+  }
+  if (collective) ProgressExchanges(false);
+  if (segments.size() == 0 && !collective) return;
+
+  std::map<int, std::vector<const Segment *>> by_rank;
+  for (auto &seg : segments)
+    by_rank[seg.other_rank].push_back(&seg);
+
+  if (collective) {
+    const int n = neighbors_.size();
+    exchanges_.emplace_back();
+    auto &ex = exchanges_.back();
+    ex.counts[0].assign(2 * n, 0);
+    ex.header_displs[0].assign(n, 0);
+    ex.data_displs[0].assign(n, 0);
+    std::size_t total_size = 0;
+    for (int i = 0; i < n; ++i) {
+      ex.header_displs[0][i] = ex.header[0].size();
+      ex.data_displs[0][i] = total_size;
+      auto it = by_rank.find(neighbors_[i]);
+      if (it == by_rank.end()) continue;
+      const std::size_t size = PackHeader(it->second, &ex.header[0]);
+      ex.counts[0][2 * i] = ex.header[0].size() - ex.header_displs[0][i];
+      ex.counts[0][2 * i + 1] = size;
+      total_size += size;
+    }
+    for (auto &[rank, segs] : by_rank)
+      PARTHENON_REQUIRE(std::binary_search(neighbors_.begin(), neighbors_.end(), rank),
+                        "Coalesced buffers to a rank that isn't a graph neighbor.");
+    ex.data[0] = BufArray1D<Real>("coalesced send buffer", total_size);
+    for (int i = 0; i < n; ++i) {
+      auto it = by_rank.find(neighbors_[i]);
+      if (it == by_rank.end()) continue;
+      std::size_t offset = ex.data_displs[0][i];
+      for (auto pseg : it->second) {
+        if (pseg->buf->GetState() != BufferState::sending) continue;
+        const BufArray1D<Real> &src = pseg->buf->buffer();
+        const std::size_t end = offset + src.size();
+        Kokkos::deep_copy(exec_space,
+                          Kokkos::subview(ex.data[0], std::make_pair(offset, end)), src);
+        offset += src.size();
+      }
+      if (CommStatistics::Enabled())
+        CommStatistics::Instance().AddSend(neighbors_[i],
+                                           ex.counts[0][2 * i + 1] * sizeof(Real));
+    }
+    exec_space.fence();
+    for (auto &seg : segments)
+      seg.buf->SetState(BufferState::stale);
+    ex.counts[1].assign(2 * n, 0);
+    PARTHENON_MPI_CHECK(MPI_Ineighbor_alltoall(ex.counts[0].data(), 2, MPI_INT,
+                                               ex.counts[1].data(), 2, MPI_INT,
+                                               graph_comms_[0], &ex.count_request));
+    return;
+  }
+
+  std::vector<std::pair<int, Message *>> messages;
+  for (auto &[rank, segs] : by_rank) {
+    sends_.emplace_back();
+    auto &msg = sends_.back();
+    const std::size_t total_size = PackHeader(segs, &msg.header);
+    msg.data = BufArray1D<Real>("coalesced send buffer", total_size);
+    std::size_t offset = 0;
+    for (int s = 0; s < segs.size(); ++s) {
+      const std::size_t size = msg.header[1 + nheader * s + 5];
+      if (size == 0) continue;
+      const BufArray1D<Real> &src = segs[s]->buf->buffer();
+      Kokkos::deep_copy(exec_space,
+                        Kokkos::subview(msg.data, std::make_pair(offset, offset + size)),
+                        src);
+      offset += size;
+    }
+    messages.push_back({rank, &msg});
+  }
+  // The data of the individual buffers has to be copied before they can be reused
+  exec_space.fence();
+
+  MPI_Comm comm = pmesh_->GetMPIComm(Mesh::coalesced_comm_label);
+  for (auto &seg : segments)
+    seg.buf->SetState(BufferState::stale);
+  for (auto &[rank, msg] : messages) {
+    PARTHENON_MPI_CHECK(MPI_Isend(msg->header.data(), msg->header.size(), MPI_INT, rank,
+                                  header_tag, comm, &(msg->requests[0])));
+    PARTHENON_MPI_CHECK(MPI_Isend(msg->data.data(), msg->data.size(), MPI_PARTHENON_REAL,
+                                  rank, data_tag, comm, &(msg->requests[1])));
+    if (CommStatistics::Enabled())
+      CommStatistics::Instance().AddSend(rank, msg->data.size() * sizeof(Real));
+  }
+#endif
+}
+
+void CoalescedBuffers::TryReceive() {
+#ifdef MPI_PARALLEL
+  if (graph_comms_[0] != MPI_COMM_NULL) ProgressExchanges(false);
+  MPI_Comm comm = pmesh_->GetMPIComm(Mesh::coalesced_comm_label);
+
+  // Pull in all messages that have arrived. The data message is always sent right after
+  // the header message, so it can be received with a blocking call.
+  int flag;
+  MPI_Status status;
+  PARTHENON_MPI_CHECK(MPI_Iprobe(MPI_ANY_SOURCE, header_tag, comm, &flag, &status));
+  while (flag) {
+    const int rank = status.MPI_SOURCE;
+    int header_size;
+    PARTHENON_MPI_CHECK(MPI_Get_count(&status, MPI_INT, &header_size));
+    receives_.emplace_back();
+    auto &msg = receives_.back();
+    msg.header.resize(header_size);
+    PARTHENON_MPI_CHECK(MPI_Recv(msg.header.data(), header_size, MPI_INT, rank,
+                                 header_tag, comm, MPI_STATUS_IGNORE));
+    const int nseg = msg.header[0];
+    std::size_t total_size = 0;
+    for (int s = 0; s < nseg; ++s)
+      total_size += msg.header[1 + nheader * s + 5];
+    msg.data = BufArray1D<Real>("coalesced receive buffer", total_size);
+    PARTHENON_MPI_CHECK(MPI_Recv(msg.data.data(), total_size, MPI_PARTHENON_REAL, rank,
+                                 data_tag, comm, MPI_STATUS_IGNORE));
+    if (CommStatistics::Enabled())
+      CommStatistics::Instance().AddReceive(rank, total_size * sizeof(Real));
+    msg.done = std::vector<bool>(nseg, false);
+    msg.nremaining = nseg;
+    PARTHENON_MPI_CHECK(MPI_Iprobe(MPI_ANY_SOURCE, header_tag, comm, &flag, &status));
+  }
+
+  // Unpack into all receive buffers whose previous data has already been used. Messages
+  // are processed in the order they arrived, so that consecutive messages for the same
+  // buffer are unpacked in the order they were sent.
+  bool copied = false;
+  for (auto &msg : receives_) {
+    std::size_t offset = 0;
+    for (int s = 0; s < msg.done.size(); ++s) {
+      const int *h = &msg.header[1 + nheader * s];
+      const std::size_t size = h[5];
+      if (!msg.done[s]) {
+        channel_key_t key{h[0], h[1], var_labels_[h[2]], h[3], h[4]};
+        auto it = pmesh_->boundary_comm_map.find(key);
+        PARTHENON_REQUIRE(it != pmesh_->boundary_comm_map.end(),
+                          "Received coalesced data for a boundary buffer that does not "
+                          "exist.");
+        auto &buf = it->second;
+        if (buf.GetState() == BufferState::stale) {
+          if (size > 0) {
+            if (!buf.IsActive()) buf.Allocate();
+            const BufArray1D<Real> &dst = buf.buffer();
+            PARTHENON_REQUIRE(dst.size() == size, "Coalesced buffer size mismatch.");
+            Kokkos::deep_copy(
+                DevExecSpace(), dst,
+                Kokkos::subview(msg.data, std::make_pair(offset, offset + size)));
+            buf.SetState(BufferState::received);
+            copied = true;
+          } else {
+            buf.SetState(BufferState::received_null);
+          }
+          msg.done[s] = true;
+          msg.nremaining--;
+        }
+      }
+      offset += size;
+    }
+  }
+  // Copies have to finish before the message buffers can be released
+  if (copied) Kokkos::fence();
+  receives_.remove_if([](const Message &msg) { return msg.nremaining == 0; });
+#endif
+}
+
+#ifdef MPI_PARALLEL
+void CoalescedBuffers::ProgressExchanges(const bool wait) {
+  // Every rank has to post the exchanges of headers and data in the same order, so an
+  // exchange can only be posted once all earlier ones have been
+  bool earlier_posted = true;
+  bool earlier_done = true;
+  for (auto it = exchanges_.begin(); it != exchanges_.end();) {
+    auto &ex = *it;
+    if (!ex.posted && earlier_posted) {
+      int flag = 1;
+      if (wait)
+        PARTHENON_MPI_CHECK(MPI_Wait(&ex.count_request, MPI_STATUS_IGNORE));
+      else
+        PARTHENON_MPI_CHECK(MPI_Test(&ex.count_request, &flag, MPI_STATUS_IGNORE));
+      if (flag) {
+        const int n = neighbors_.size();
+        std::vector<int> header_counts[2], data_counts[2];
+        for (int side = 0; side < 2; ++side) {
+          ex.header_displs[side].assign(n, 0);
+          ex.data_displs[side].assign(n, 0);
+          int header_size = 0, data_size = 0;
+          for (int i = 0; i < n; ++i) {
+            header_counts[side].push_back(ex.counts[side][2 * i]);
+            data_counts[side].push_back(ex.counts[side][2 * i + 1]);
+            ex.header_displs[side][i] = header_size;
+            ex.data_displs[side][i] = data_size;
+            header_size += header_counts[side][i];
+            data_size += data_counts[side][i];
+          }
+          if (side == 1) {
+            ex.header[1].resize(header_size);
+            ex.data[1] = BufArray1D<Real>("coalesced receive buffer", data_size);
+          }
+        }
+        PARTHENON_MPI_CHECK(MPI_Ineighbor_alltoallv(
+            ex.header[0].data(), header_counts[0].data(), ex.header_displs[0].data(),
+            MPI_INT, ex.header[1].data(), header_counts[1].data(),
+            ex.header_displs[1].data(), MPI_INT, graph_comms_[1], &ex.requests[0]));
+        PARTHENON_MPI_CHECK(MPI_Ineighbor_alltoallv(
+            ex.data[0].data(), data_counts[0].data(), ex.data_displs[0].data(),
+            MPI_PARTHENON_REAL, ex.data[1].data(), data_counts[1].data(),
+            ex.data_displs[1].data(), MPI_PARTHENON_REAL, graph_comms_[1],
+            &ex.requests[1]));
+        ex.posted = true;
+      }
+    }
+    earlier_posted = earlier_posted && ex.posted;
+    if (!ex.posted || !earlier_done) {
+      earlier_done = false;
+      ++it;
+      continue;
+    }
+
+    int flag = 1;
+    if (wait)
+      PARTHENON_MPI_CHECK(MPI_Waitall(2, ex.requests, MPI_STATUSES_IGNORE));
+    else
+      PARTHENON_MPI_CHECK(MPI_Testall(2, ex.requests, &flag, MPI_STATUSES_IGNORE));
+    if (!flag) {
+      earlier_done = false;
+      ++it;
+      continue;
+    }
+    // Hand the received data on as one message per sending rank
+    for (int i = 0; i < neighbors_.size(); ++i) {
+      const int header_size = ex.counts[1][2 * i];
+      if (header_size == 0) continue;
+      receives_.emplace_back();
+      auto &msg = receives_.back();
+      const int *h = &ex.header[1][ex.header_displs[1][i]];
+      msg.header.assign(h, h + header_size);
+      const std::size_t offset = ex.data_displs[1][i];
+      const std::size_t size = ex.counts[1][2 * i + 1];
+      msg.data = Kokkos::subview(ex.data[1], std::make_pair(offset, offset + size));
+      msg.done = std::vector<bool>(msg.header[0], false);
+      msg.nremaining = msg.header[0];
+      if (CommStatistics::Enabled())
+        CommStatistics::Instance().AddReceive(neighbors_[i], size * sizeof(Real));
+    }
+    it = exchanges_.erase(it);
+  }
+}
+
+void CoalescedBuffers::FreeGraphComms() {
+  PARTHENON_REQUIRE(exchanges_.size() == 0,
+                    "Freeing graph communicators with collectives in flight.");
+  for (auto &comm : graph_comms_)
+    if (comm != MPI_COMM_NULL) PARTHENON_MPI_CHECK(MPI_Comm_free(&comm));
+}
+#endif
+
+void CoalescedBuffers::Clear() {
+#ifdef MPI_PARALLEL
+  for (auto &msg : sends_)
+    PARTHENON_MPI_CHECK(MPI_Waitall(2, msg.requests, MPI_STATUSES_IGNORE));
+  sends_.clear();
+  // Completed exchanges can only hold messages that have already been unpacked or that
+  // carry no data for any buffer, since all receives have finished at this point
+  ProgressExchanges(true);
+  receives_.remove_if([](const Message &msg) { return msg.nremaining == 0; });
+  PARTHENON_REQUIRE(receives_.size() == 0,
+                    "Rebuilding boundary buffers with unprocessed coalesced messages.");
+#endif
+}
+
+void CoalescedBuffers::Finalize() {
+#ifdef MPI_PARALLEL
+  FreeGraphComms();
+#endif
+}
+
+} // namespace parthenon
@@ -0,0 +1,141 @@
+//========================================================================================
+// Parthenon performance portable AMR framework
+// Copyright(C) 2024 The Parthenon collaboration
+// Licensed under the 3-clause BSD License, see LICENSE file for details
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#ifndef BVALS_COMMS_COALESCED_BUFFERS_HPP_
+#define BVALS_COMMS_COALESCED_BUFFERS_HPP_
+
+#include <list>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "basic_types.hpp"
+#include "kokkos_abstraction.hpp"
+#include "parthenon_mpi.hpp"
+#include "utils/communication_buffer.hpp"
+#include "utils/object_pool.hpp"
+
+namespace parthenon {
+
+class Mesh;
+
+// Instead of posting one MPI message per boundary buffer, coalesced buffers going from
+// one rank to another are packed into a single contiguous message when a MeshData
+// object sends its boundaries. Each message is preceded by a header message holding the
+// number of buffers followed by the channel key (sender gid, receiver gid, variable id,
+// location index and the "other" flag) and the size of every buffer, where a size of
+// zero corresponds to a null send. Since messages are self describing, the receiving
+// rank does not need to know how the sending rank partitions its blocks. Received data
+// is copied into the individual receive buffers once these are stale, after which the
+// rest of the boundary communication machinery proceeds as usual.
+//
+// With neighborhood collectives the messages of one send to all neighboring ranks are
+// instead exchanged by a single MPI_Ineighbor_alltoallv on a distributed graph
+// communicator that connects every rank to the ranks it shares coalesced buffers with.
+// Since the receiving rank can't know the sizes of the messages in advance, they are
+// exchanged by a preceding MPI_Ineighbor_alltoall on a second communicator with the
+// same graph. Every rank has to take part in each of these collectives in the same
+// order, so they can only be used if every rank sends its coalesced boundaries the same
+// number of times, i.e. with a single partition per rank.
+class CoalescedBuffers {
+ public:
+  using channel_key_t = std::tuple<int, int, std::string, int, int>;
+  using comm_buf_t = CommBuffer<buf_pool_t<Real>::owner_t>;
+
+  // A boundary buffer that is sent as part of a coalesced message
+  struct Segment {
+    int other_rank;
+    channel_key_t key;
+    comm_buf_t *buf;
+  };
+
+  // Set up the variable ids and the graph communicators used by neighborhood
+  // collectives, needs to be called after the boundary buffers are built
+  void Initialize(Mesh *pmesh);
+
+  // Pack all segments that have been sent (or null sent) by the individual buffers into
+  // one message per receiving rank and post the sends. The packing copies are issued on
+  // exec_space, the execution space instance the buffers were filled on. If collective
+  // is true, the messages are exchanged by a neighborhood collective, which all ranks
+  // have to start even if they have nothing to send.
+  void Send(const std::vector<Segment> &segments,
+            const DevExecSpace &exec_space = DevExecSpace(), bool collective = false);
+
+  // Receive all available messages and copy their data into the receive buffers that
+  // are ready for it
+  void TryReceive();
+
+  // Wait for all in flight messages, required before the boundary buffers are rebuilt
+  void Clear();
+
+  // Free the graph communicators
+  void Finalize();
+
+ private:
+  Mesh *pmesh_ = nullptr;
+  std::vector<std::string> var_labels_;
+  std::unordered_map<std::string, int> var_ids_;
+
+#ifdef MPI_PARALLEL
+  static constexpr int header_tag = 0;
+  static constexpr int data_tag = 1;
+
+  struct Message {
+    std::vector<int> header;
+    BufArray1D<Real> data;
+    MPI_Request requests[2];
+    std::vector<bool> done;
+    int nremaining;
+  };
+  std::list<Message> sends_;
+  std::list<Message> receives_;
+
+  // Fill header with the number of segments and the header entries of every segment,
+  // returns the total size of their data
+  std::size_t PackHeader(const std::vector<const Segment *> &segs,
+                         std::vector<int> *header) const;
+
+  // A neighborhood collective exchange. Index 0 holds the send side and index 1 the
+  // receive side. counts holds the header and data sizes for every neighbor, which are
+  // exchanged before the headers and data themselves.
+  struct Exchange {
+    std::vector<int> counts[2];
+    std::vector<int> header[2];
+    BufArray1D<Real> data[2];
+    std::vector<int> header_displs[2];
+    std::vector<int> data_displs[2];
+    MPI_Request count_request;
+    MPI_Request requests[2];
+    bool posted = false;
+  };
+  std::list<Exchange> exchanges_;
+  std::vector<int> neighbors_;
+  // For counts and for headers and data
+  MPI_Comm graph_comms_[2] = {MPI_COMM_NULL, MPI_COMM_NULL};
+
+  // Post the exchange of headers and data once the sizes are known and turn the
+  // completed exchanges into received messages. Exchanges are completed strictly in the
+  // order they were started. If wait is true, block until all exchanges are completed.
+  void ProgressExchanges(bool wait);
+  void FreeGraphComms();
+#endif
+};
+
+} // namespace parthenon
+
+#endif // BVALS_COMMS_COALESCED_BUFFERS_HPP_
@@ -0,0 +1,172 @@
+//========================================================================================
+// Parthenon performance portable AMR framework
+// Copyright(C) 2024 The Parthenon collaboration
+// Licensed under the 3-clause BSD License, see LICENSE file for details
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+#include "bvals/comms/node_shared_buffers.hpp"
+#include "globals.hpp"
+#include "kokkos_abstraction.hpp"
+#include "mesh/mesh.hpp"
+#include "utils/error_checking.hpp"
+
+namespace parthenon {
+
+namespace {
+// Every channel is described to the receiver by the byte offsets of its state and its
+// data in the part of the window of the sender, and the number of elements
+constexpr int nlayout = 3;
+constexpr int layout_tag = 0;
+} // namespace
+
+void NodeSharedBuffers::Initialize(Mesh *pmesh) {
+  sends_.clear();
+  receives_.clear();
+  if (!pmesh->do_shared_memory_comms || node_ranks_.size() > 0) return;
+  node_ranks_ = std::vector<int>(Globals::nranks, -1);
+#ifdef MPI_PARALLEL
+  // Packing and unpacking happens on the device, which may not be able to access host
+  // memory. In that case MPI implementations typically already use the fastest
+  // transport between the devices of a node.
+  if (!Kokkos::SpaceAccessibility<DevExecSpace, Kokkos::HostSpace>::accessible) {
+    if (Globals::my_rank == 0)
+      PARTHENON_WARN("Ignoring shared_memory_comms since the communication buffers "
+                     "are not accessible from host memory.");
+    return;
+  }
+  PARTHENON_MPI_CHECK(MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED,
+                                          Globals::my_rank, MPI_INFO_NULL, &node_comm_));
+  int node_size;
+  PARTHENON_MPI_CHECK(MPI_Comm_size(node_comm_, &node_size));
+  std::vector<int> node_ranks(node_size), world_ranks(node_size);
+  for (int i = 0; i < node_size; ++i)
+    node_ranks[i] = i;
+  MPI_Group node_group, world_group;
+  PARTHENON_MPI_CHECK(MPI_Comm_group(node_comm_, &node_group));
+  PARTHENON_MPI_CHECK(MPI_Comm_group(MPI_COMM_WORLD, &world_group));
+  PARTHENON_MPI_CHECK(MPI_Group_translate_ranks(node_group, node_size, node_ranks.data(),
+                                                world_group, world_ranks.data()));
+  PARTHENON_MPI_CHECK(MPI_Group_free(&node_group));
+  PARTHENON_MPI_CHECK(MPI_Group_free(&world_group));
+  for (int i = 0; i < node_size; ++i)
+    node_ranks_[world_ranks[i]] = i;
+#endif
+}
+
+void NodeSharedBuffers::Add(int other_rank, const channel_key_t &key, comm_buf_t *buf,
+                            std::size_t size, bool sender) {
+  (sender ? sends_ : receives_)[other_rank].push_back({key, buf, size});
+}
+
+void NodeSharedBuffers::Build() {
+#ifdef MPI_PARALLEL
+  if (node_comm_ == MPI_COMM_NULL) return;
+  // Both ranks of a pair order the channels between them by their keys, which are the
+  // same on both sides
+  auto by_key = [](const Channel &a, const Channel &b) { return a.key < b.key; };
+  std::size_t nchannels = 0;
+  std::size_t ndata = 0;
+  for (auto &[rank, channels] : sends_) {
+    std::sort(channels.begin(), channels.end(), by_key);
+    nchannels += channels.size();
+    for (auto &channel : channels)
+      ndata += channel.size;
+  }
+  for (auto &[rank, channels] : receives_)
+    std::sort(channels.begin(), channels.end(), by_key);
+
+  // The states of all channels sent by this rank, followed by their data. Each rank
+  // gets its own (page aligned) part of the window.
+  const MPI_Aint nbytes = nchannels * sizeof(SharedChannelState) + ndata * sizeof(Real);
+  MPI_Info info;
+  PARTHENON_MPI_CHECK(MPI_Info_create(&info));
+  PARTHENON_MPI_CHECK(MPI_Info_set(info, "alloc_shared_noncontig", "true"));
+  char *base = nullptr;
+  PARTHENON_MPI_CHECK(MPI_Win_allocate_shared(nbytes, 1, info, node_comm_, &base, &win_));
+  PARTHENON_MPI_CHECK(MPI_Info_free(&info));
+  PARTHENON_MPI_CHECK(MPI_Win_lock_all(MPI_MODE_NOCHECK, win_));
+
+  auto make_storage = [](char *ptr, std::size_t size) {
+    buf_pool_t<Real>::owner_t storage;
+    storage =
+        buf_pool_t<Real>::weak_t(BufArray1D<Real>(reinterpret_cast<Real *>(ptr), size));
+    return storage;
+  };
+
+  std::vector<std::vector<std::int64_t>> layouts;
+  std::vector<MPI_Request> requests;
+  layouts.reserve(sends_.size());
+  requests.reserve(sends_.size());
+  std::int64_t state_offset = 0;
+  std::int64_t data_offset = nchannels * sizeof(SharedChannelState);
+  for (auto &[rank, channels] : sends_) {
+    auto &layout = layouts.emplace_back();
+    for (auto &channel : channels) {
+      auto *state = new (base + state_offset) SharedChannelState();
+      channel.buf->SetNodeShared(make_storage(base + data_offset, channel.size), state);
+      layout.insert(layout.end(),
+                    {state_offset, data_offset, static_cast<std::int64_t>(channel.size)});
+      state_offset += sizeof(SharedChannelState);
+      data_offset += channel.size * sizeof(Real);
+    }
+    requests.emplace_back();
+    PARTHENON_MPI_CHECK(MPI_Isend(layout.data(), layout.size(), MPI_INT64_T,
+                                  node_ranks_[rank], layout_tag, node_comm_,
+                                  &requests.back()));
+  }
+
+  for (auto &[rank, channels] : receives_) {
+    std::vector<std::int64_t> layout(nlayout * channels.size());
+    PARTHENON_MPI_CHECK(MPI_Recv(layout.data(), layout.size(), MPI_INT64_T,
+                                 node_ranks_[rank], layout_tag, node_comm_,
+                                 MPI_STATUS_IGNORE));
+    MPI_Aint size;
+    int disp_unit;
+    char *peer_base = nullptr;
+    PARTHENON_MPI_CHECK(
+        MPI_Win_shared_query(win_, node_ranks_[rank], &size, &disp_unit, &peer_base));
+    for (int c = 0; c < channels.size(); ++c) {
+      const std::int64_t *l = &layout[nlayout * c];
+      auto *state = reinterpret_cast<SharedChannelState *>(peer_base + l[0]);
+      channels[c].buf->SetNodeShared(make_storage(peer_base + l[1], l[2]), state);
+    }
+  }
+  PARTHENON_MPI_CHECK(MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE));
+#endif
+}
+
+void NodeSharedBuffers::Clear() {
+  sends_.clear();
+  receives_.clear();
+#ifdef MPI_PARALLEL
+  if (win_ == MPI_WIN_NULL) return;
+  PARTHENON_MPI_CHECK(MPI_Win_unlock_all(win_));
+  PARTHENON_MPI_CHECK(MPI_Win_free(&win_));
+#endif
+}
+
+void NodeSharedBuffers::Finalize() {
+  Clear();
+#ifdef MPI_PARALLEL
+  if (node_comm_ != MPI_COMM_NULL) PARTHENON_MPI_CHECK(MPI_Comm_free(&node_comm_));
+#endif
+  node_ranks_.clear();
+}
+
+} // namespace parthenon
@@ -0,0 +1,97 @@
+//========================================================================================
+// Parthenon performance portable AMR framework
+// Copyright(C) 2024 The Parthenon collaboration
+// Licensed under the 3-clause BSD License, see LICENSE file for details
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#ifndef BVALS_COMMS_NODE_SHARED_BUFFERS_HPP_
+#define BVALS_COMMS_NODE_SHARED_BUFFERS_HPP_
+
+#include <cstddef>
+#include <map>
+#include <vector>
+
+#include "bvals/comms/coalesced_buffers.hpp"
+#include "globals.hpp"
+#include "parthenon_mpi.hpp"
+
+namespace parthenon {
+
+class Mesh;
+
+// Boundary buffers between two ranks on the same node can be exchanged through an MPI-3
+// shared memory window instead of point to point messages. The sending rank allocates
+// the storage of all of its node shared send buffers in its part of the window, so both
+// the sending and the receiving CommBuffer point at the same memory: the sender packs
+// straight into it and the receiver unpacks straight from it. Sends and receives only
+// update the SharedChannelState of the channel. Since the buffer can only be written
+// again once the receiver has set its boundaries, the sender may have to wait in the
+// next stage, like for buffers between blocks on the same rank. Only non-sparse buffers
+// take part, since the size of their messages is fixed, and the storage has to be
+// accessible from the execution space that packs and unpacks the buffers.
+class NodeSharedBuffers {
+ public:
+  using channel_key_t = CoalescedBuffers::channel_key_t;
+  using comm_buf_t = CoalescedBuffers::comm_buf_t;
+
+  NodeSharedBuffers() = default;
+  NodeSharedBuffers(const NodeSharedBuffers &) = delete;
+  NodeSharedBuffers &operator=(const NodeSharedBuffers &) = delete;
+
+  // Find the ranks on the same node, needs to be called by all ranks before the boundary
+  // buffers are built
+  void Initialize(Mesh *pmesh);
+
+  bool SharesNode(int rank) const {
+    return rank != Globals::my_rank && rank < node_ranks_.size() &&
+           node_ranks_[rank] >= 0;
+  }
+
+  // Register a buffer that is built between this rank and other_rank. For sending
+  // buffers, size is the number of elements the storage needs to hold.
+  void Add(int other_rank, const channel_key_t &key, comm_buf_t *buf, std::size_t size,
+           bool sender);
+
+  // Allocate the window and point all registered buffers at their storage, needs to be
+  // called by all ranks of a node after the boundary buffers are built
+  void Build();
+
+  // Free the window, needs to be called by all ranks of a node once the boundary
+  // buffers are not used anymore
+  void Clear();
+
+  // Also free the node communicator, required before MPI is finalized
+  void Finalize();
+
+ private:
+  // Node rank of every rank on the same node, -1 for all other ranks
+  std::vector<int> node_ranks_;
+
+  struct Channel {
+    channel_key_t key;
+    comm_buf_t *buf;
+    std::size_t size;
+  };
+  std::map<int, std::vector<Channel>> sends_;
+  std::map<int, std::vector<Channel>> receives_;
+
+#ifdef MPI_PARALLEL
+  MPI_Comm node_comm_ = MPI_COMM_NULL;
+  MPI_Win win_ = MPI_WIN_NULL;
+#endif
+};
+
+} // namespace parthenon
+
+#endif // BVALS_COMMS_NODE_SHARED_BUFFERS_HPP_
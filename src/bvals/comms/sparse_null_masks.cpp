@@ -0,0 +1,183 @@
+//========================================================================================
+// Parthenon performance portable AMR framework
+// Copyright(C) 2024 The Parthenon collaboration
+// Licensed under the 3-clause BSD License, see LICENSE file for details
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bvals/comms/sparse_null_masks.hpp"
+#include "interface/state_descriptor.hpp"
+#include "mesh/mesh.hpp"
+#include "utils/error_checking.hpp"
+
+namespace parthenon {
+
+namespace {
+// Message layout: layout id, number of buffers, flag for whether the keys follow, the
+// keys (if present) and the mask words
+constexpr int nheader = 3;
+constexpr int nkey = 5;
+constexpr int bits_per_word = 32;
+} // namespace
+
+void SparseNullMasks::Initialize(Mesh *pmesh) {
+  pmesh_ = pmesh;
+  var_labels_.clear();
+  var_ids_.clear();
+  for (auto &pair : pmesh->resolved_packages->AllFields())
+    var_labels_.push_back(pair.first.label());
+  std::sort(var_labels_.begin(), var_labels_.end());
+  for (int i = 0; i < var_labels_.size(); ++i)
+    var_ids_[var_labels_[i]] = i;
+}
+
+void SparseNullMasks::Send(const std::vector<Segment> &segments,
+                           std::map<int, int> *layout_ids) {
+#ifdef MPI_PARALLEL
+  // Get rid of messages that have already been delivered
+  for (auto it = sends_.begin(); it != sends_.end();) {
+    int flag;
+    PARTHENON_MPI_CHECK(MPI_Test(&(it->request), &flag, MPI_STATUS_IGNORE));
+    it = flag ? sends_.erase(it) : std::next(it);
+  }
+  if (segments.size() == 0) return;
+
+  // The order of segments is fixed for a given cache, so it defines the layout
+  std::map<int, std::vector<const Segment *>> by_rank;
+  for (auto &seg : segments)
+    by_rank[seg.other_rank].push_back(&seg);
+
+  MPI_Comm comm = pmesh_->GetMPIComm(Mesh::null_mask_comm_label);
+  for (auto &[rank, segs] : by_rank) {
+    const int nseg = segs.size();
+    const bool new_layout = layout_ids->count(rank) == 0;
+    if (new_layout) (*layout_ids)[rank] = next_layout_id_[rank]++;
+
+    sends_.emplace_back();
+    auto &msg = sends_.back();
+    const int nwords = (nseg + bits_per_word - 1) / bits_per_word;
+    msg.data.assign(nheader + (new_layout ? nkey * nseg : 0) + nwords, 0);
+    msg.data[0] = layout_ids->at(rank);
+    msg.data[1] = nseg;
+    msg.data[2] = new_layout;
+    int offset = nheader;
+    if (new_layout) {
+      for (auto pseg : segs) {
+        auto &key = pseg->key;
+        msg.data[offset++] = std::get<0>(key);
+        msg.data[offset++] = std::get<1>(key);
+        msg.data[offset++] = var_ids_.at(std::get<2>(key));
+        msg.data[offset++] = std::get<3>(key);
+        msg.data[offset++] = std::get<4>(key);
+      }
+    }
+    for (int s = 0; s < nseg; ++s) {
+      if (segs[s]->buf->GetState() == BufferState::sending)
+        msg.data[offset + s / bits_per_word] |= std::uint32_t(1) << (s % bits_per_word);
+    }
+    PARTHENON_MPI_CHECK(MPI_Isend(msg.data.data(), msg.data.size(), MPI_UINT32_T, rank,
+                                  mask_tag, comm, &(msg.request)));
+  }
+#endif
+}
+
+void SparseNullMasks::TryReceive() {
+#ifdef MPI_PARALLEL
+  MPI_Comm comm = pmesh_->GetMPIComm(Mesh::null_mask_comm_label);
+
+  int flag;
+  MPI_Status status;
+  PARTHENON_MPI_CHECK(MPI_Iprobe(MPI_ANY_SOURCE, mask_tag, comm, &flag, &status));
+  while (flag) {
+    const int rank = status.MPI_SOURCE;
+    int size;
+    PARTHENON_MPI_CHECK(MPI_Get_count(&status, MPI_UINT32_T, &size));
+    std::vector<std::uint32_t> data(size);
+    PARTHENON_MPI_CHECK(MPI_Recv(data.data(), size, MPI_UINT32_T, rank, mask_tag, comm,
+                                 MPI_STATUS_IGNORE));
+    const auto layout = std::make_pair(rank, static_cast<int>(data[0]));
+    const int nseg = data[1];
+    int offset = nheader;
+    if (data[2]) {
+      auto &bufs = layouts_[layout];
+      bufs.resize(nseg);
+      for (int s = 0; s < nseg; ++s, offset += nkey) {
+        channel_key_t key{static_cast<int>(data[offset]),
+                          static_cast<int>(data[offset + 1]),
+                          var_labels_[data[offset + 2]],
+                          static_cast<int>(data[offset + 3]),
+                          static_cast<int>(data[offset + 4])};
+        auto it = pmesh_->boundary_comm_map.find(key);
+        PARTHENON_REQUIRE(it != pmesh_->boundary_comm_map.end(),
+                          "Received null mask for a boundary buffer that does not "
+                          "exist.");
+        bufs[s] = &(it->second);
+      }
+    }
+    PARTHENON_REQUIRE(layouts_.count(layout) > 0,
+                      "Received null mask for a layout that has not been announced.");
+    receives_.emplace_back();
+    auto &mask = receives_.back();
+    mask.bufs = &layouts_.at(layout);
+    PARTHENON_REQUIRE(mask.bufs->size() == nseg, "Null mask size mismatch.");
+    mask.has_data.resize(nseg);
+    for (int s = 0; s < nseg; ++s)
+      mask.has_data[s] = (data[offset + s / bits_per_word] >> (s % bits_per_word)) & 1;
+    mask.done = std::vector<bool>(nseg, false);
+    mask.nremaining = nseg;
+    PARTHENON_MPI_CHECK(MPI_Iprobe(MPI_ANY_SOURCE, mask_tag, comm, &flag, &status));
+  }
+
+  // Apply the masks to all buffers that are done with their previous message. Masks are
+  // processed in the order they arrived, and a buffer waiting for data or holding
+  // received data is not stale, so later masks are never applied before earlier ones.
+  for (auto &mask : receives_) {
+    for (int s = 0; s < mask.done.size(); ++s) {
+      if (mask.done[s]) continue;
+      auto &buf = *((*mask.bufs)[s]);
+      if (buf.GetState() != BufferState::stale || buf.IsExpectingData()) continue;
+      if (mask.has_data[s]) {
+        buf.ExpectData();
+        buf.TryStartReceive();
+      } else {
+        buf.SetState(BufferState::received_null);
+      }
+      mask.done[s] = true;
+      mask.nremaining--;
+    }
+  }
+  receives_.remove_if([](const ReceivedMask &mask) { return mask.nremaining == 0; });
+#endif
+}
+
+void SparseNullMasks::Clear() {
+#ifdef MPI_PARALLEL
+  for (auto &msg : sends_)
+    PARTHENON_MPI_CHECK(MPI_Wait(&(msg.request), MPI_STATUS_IGNORE));
+  sends_.clear();
+  PARTHENON_REQUIRE(receives_.size() == 0,
+                    "Rebuilding boundary buffers with unprocessed null masks.");
+  layouts_.clear();
+  next_layout_id_.clear();
+#endif
+}
+
+} // namespace parthenon
@@ -0,0 +1,95 @@
+//========================================================================================
+// Parthenon performance portable AMR framework
+// Copyright(C) 2024 The Parthenon collaboration
+// Licensed under the 3-clause BSD License, see LICENSE file for details
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#ifndef BVALS_COMMS_SPARSE_NULL_MASKS_HPP_
+#define BVALS_COMMS_SPARSE_NULL_MASKS_HPP_
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "bvals/comms/coalesced_buffers.hpp"
+#include "parthenon_mpi.hpp"
+
+namespace parthenon {
+
+class Mesh;
+
+// Instead of sending an empty message for every unallocated sparse variable on every
+// boundary, null masked buffers going from one rank to another only send their real
+// data. Whether each of them sent data or not is communicated in a single message per
+// receiving rank when a MeshData object sends its boundaries, which holds one bit per
+// buffer. The first mask sent for a given set of buffers (a layout) additionally holds
+// the channel keys of the buffers, later masks only refer to the layout by its id. A
+// receiving buffer only looks for its own message once a mask has told it that data is
+// coming, and is set to received_null otherwise. Masks for the same buffer are processed
+// in the order they were sent, so the messages of a buffer are matched to the correct
+// mask bit since MPI does not reorder the messages on a channel.
+class SparseNullMasks {
+ public:
+  using channel_key_t = CoalescedBuffers::channel_key_t;
+  using comm_buf_t = CoalescedBuffers::comm_buf_t;
+  using Segment = CoalescedBuffers::Segment;
+
+  // Set up the variable ids, needs to be called after the boundary buffers are built
+  void Initialize(Mesh *pmesh);
+
+  // Send the masks for all segments, which have to be sent (or null sent) already.
+  // layout_ids holds the ids of the layouts of these segments that have already been
+  // announced to each receiving rank and is updated if new layouts are sent.
+  void Send(const std::vector<Segment> &segments, std::map<int, int> *layout_ids);
+
+  // Receive all available masks and apply them to the receive buffers that are ready
+  void TryReceive();
+
+  // Wait for all in flight messages, required before the boundary buffers are rebuilt
+  void Clear();
+
+ private:
+  Mesh *pmesh_ = nullptr;
+  std::vector<std::string> var_labels_;
+  std::unordered_map<std::string, int> var_ids_;
+
+#ifdef MPI_PARALLEL
+  static constexpr int mask_tag = 0;
+
+  struct SendMessage {
+    std::vector<std::uint32_t> data;
+    MPI_Request request;
+  };
+  struct ReceivedMask {
+    const std::vector<comm_buf_t *> *bufs;
+    std::vector<bool> has_data;
+    std::vector<bool> done;
+    int nremaining;
+  };
+  // Next layout id for every receiving rank
+  std::map<int, int> next_layout_id_;
+  // Buffers of the layouts announced by (sending rank, layout id)
+  std::map<std::pair<int, int>, std::vector<comm_buf_t *>> layouts_;
+  std::list<SendMessage> sends_;
+  std::list<ReceivedMask> receives_;
+#endif
+};
+
+} // namespace parthenon
+
+#endif // BVALS_COMMS_SPARSE_NULL_MASKS_HPP_
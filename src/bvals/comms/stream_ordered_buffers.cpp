@@ -0,0 +1,173 @@
+//========================================================================================
+// Parthenon performance portable AMR framework
+// Copyright(C) 2024 The Parthenon collaboration
+// Licensed under the 3-clause BSD License, see LICENSE file for details
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "bvals/comms/stream_ordered_buffers.hpp"
+#include "globals.hpp"
+#include "mesh/mesh.hpp"
+#include "utils/error_checking.hpp"
+
+#ifdef PARTHENON_ENABLE_NCCL
+#define PARTHENON_NCCL_CHECK(expr)                                                       \
+  do {                                                                                   \
+    const ncclResult_t parthenon_nccl_check_status = (expr);                             \
+    if (parthenon_nccl_check_status != ncclSuccess)                                      \
+      PARTHENON_FAIL(std::string(#expr) +                                                \
+                     " failed: " + ncclGetErrorString(parthenon_nccl_check_status));     \
+  } while (false)
+#endif
+
+namespace parthenon {
+
+namespace {
+constexpr int size_tag = 0;
+
+std::vector<const CoalescedBuffers::Segment *>
+SortByKey(const std::vector<CoalescedBuffers::Segment> &segments) {
+  std::vector<const CoalescedBuffers::Segment *> out;
+  for (auto &seg : segments)
+    out.push_back(&seg);
+  std::sort(out.begin(), out.end(), [](auto a, auto b) { return a->key < b->key; });
+  return out;
+}
+} // namespace
+
+void StreamOrderedBuffers::Initialize(Mesh *pmesh) {
+  sends_.clear();
+  receives_.clear();
+  recv_sizes_.clear();
+  if (!pmesh->do_stream_ordered_comms) return;
+  PARTHENON_REQUIRE_THROWS(pmesh->DefaultNumPartitions() == 1,
+                           "stream_ordered_comms requires a single partition per rank.");
+  PARTHENON_REQUIRE_THROWS(!Globals::sparse_config.enabled,
+                           "stream_ordered_comms does not support sparse variables.");
+  PARTHENON_REQUIRE_THROWS(!pmesh->do_coalesced_comms && !pmesh->do_shared_memory_comms,
+                           "stream_ordered_comms cannot be combined with coalesced_comms "
+                           "or shared_memory_comms.");
+#ifdef MPI_PARALLEL
+#ifdef PARTHENON_ENABLE_NCCL
+  if (comm_ != MPI_COMM_NULL) return;
+  PARTHENON_MPI_CHECK(MPI_Comm_dup(MPI_COMM_WORLD, &comm_));
+  ncclUniqueId id;
+  if (Globals::my_rank == 0) PARTHENON_NCCL_CHECK(ncclGetUniqueId(&id));
+  PARTHENON_MPI_CHECK(MPI_Bcast(&id, sizeof(id), MPI_BYTE, 0, comm_));
+  PARTHENON_NCCL_CHECK(
+      ncclCommInitRank(&nccl_comm_, Globals::nranks, id, Globals::my_rank));
+#else
+  PARTHENON_THROW("stream_ordered_comms requires building with PARTHENON_ENABLE_NCCL.");
+#endif
+#endif
+}
+
+void StreamOrderedBuffers::Add(int other_rank, const channel_key_t &key, comm_buf_t *buf,
+                               std::size_t size, bool sender) {
+  (sender ? sends_ : receives_)[other_rank].push_back({key, buf, size});
+}
+
+void StreamOrderedBuffers::Build() {
+#ifdef MPI_PARALLEL
+  if (comm_ == MPI_COMM_NULL) return;
+  auto by_key = [](const Channel &a, const Channel &b) { return a.key < b.key; };
+  std::vector<std::vector<std::int64_t>> sizes;
+  std::vector<MPI_Request> requests;
+  sizes.reserve(sends_.size());
+  requests.reserve(sends_.size());
+  for (auto &[rank, channels] : sends_) {
+    std::sort(channels.begin(), channels.end(), by_key);
+    auto &send_sizes = sizes.emplace_back();
+    for (auto &channel : channels)
+      send_sizes.push_back(channel.size);
+    requests.emplace_back();
+    PARTHENON_MPI_CHECK(MPI_Isend(send_sizes.data(), send_sizes.size(), MPI_INT64_T, rank,
+                                  size_tag, comm_, &requests.back()));
+  }
+  for (auto &[rank, channels] : receives_) {
+    std::sort(channels.begin(), channels.end(), by_key);
+    std::vector<std::int64_t> recv_sizes(channels.size());
+    PARTHENON_MPI_CHECK(MPI_Recv(recv_sizes.data(), recv_sizes.size(), MPI_INT64_T, rank,
+                                 size_tag, comm_, MPI_STATUS_IGNORE));
+    for (int c = 0; c < channels.size(); ++c) {
+      // Receives are posted before any of the buffers are used
+      channels[c].buf->Allocate();
+      PARTHENON_REQUIRE(recv_sizes[c] <= channels[c].buf->buffer().size(),
+                        "Stream ordered receive buffer is too small.");
+      recv_sizes_[channels[c].key] = recv_sizes[c];
+    }
+  }
+  PARTHENON_MPI_CHECK(MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE));
+#endif
+}
+
+void StreamOrderedBuffers::Exchange(const std::vector<Segment> &send_segments,
+                                    const std::vector<Segment> &recv_segments,
+                                    const DevExecSpace &exec_space) {
+#ifdef PARTHENON_ENABLE_NCCL
+  if (nccl_comm_ == nullptr) return;
+#ifdef KOKKOS_ENABLE_HIP
+  auto stream = exec_space.hip_stream();
+#else
+  auto stream = exec_space.cuda_stream();
+#endif
+  const ncclDataType_t type = std::is_same_v<Real, float> ? ncclFloat32 : ncclFloat64;
+  const auto recvs = SortByKey(recv_segments);
+  PARTHENON_NCCL_CHECK(ncclGroupStart());
+  for (auto *seg : recvs) {
+    auto &buf = *(seg->buf);
+    PARTHENON_REQUIRE(buf.GetState() == BufferState::stale,
+                      "Posting a stream ordered receive into a buffer that is in use.");
+    PARTHENON_NCCL_CHECK(ncclRecv(buf.buffer().data(), recv_sizes_.at(seg->key), type,
+                                  seg->other_rank, nccl_comm_, stream));
+  }
+  for (auto *seg : SortByKey(send_segments)) {
+    auto &buf = *(seg->buf);
+    PARTHENON_NCCL_CHECK(ncclSend(buf.buffer().data(), buf.buffer().size(), type,
+                                  seg->other_rank, nccl_comm_, stream));
+  }
+  PARTHENON_NCCL_CHECK(ncclGroupEnd());
+  // Kernels reading the buffers on the same stream wait for the data
+  for (auto *seg : recvs)
+    seg->buf->SetState(BufferState::received);
+#endif
+}
+
+void StreamOrderedBuffers::Clear() {
+#ifdef PARTHENON_ENABLE_NCCL
+  // Operations may still be in flight on the streams
+  if (nccl_comm_ != nullptr) Kokkos::fence();
+#endif
+  sends_.clear();
+  receives_.clear();
+  recv_sizes_.clear();
+}
+
+void StreamOrderedBuffers::Finalize() {
+  Clear();
+#ifdef PARTHENON_ENABLE_NCCL
+  if (nccl_comm_ != nullptr) PARTHENON_NCCL_CHECK(ncclCommDestroy(nccl_comm_));
+  nccl_comm_ = nullptr;
+#endif
+#ifdef MPI_PARALLEL
+  if (comm_ != MPI_COMM_NULL) PARTHENON_MPI_CHECK(MPI_Comm_free(&comm_));
+#endif
+}
+
+} // namespace parthenon
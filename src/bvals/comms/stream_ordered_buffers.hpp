@@ -0,0 +1,110 @@
+//========================================================================================
+// Parthenon performance portable AMR framework
+// Copyright(C) 2024 The Parthenon collaboration
+// Licensed under the 3-clause BSD License, see LICENSE file for details
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#ifndef BVALS_COMMS_STREAM_ORDERED_BUFFERS_HPP_
+#define BVALS_COMMS_STREAM_ORDERED_BUFFERS_HPP_
+
+#include <cstddef>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include "bvals/comms/coalesced_buffers.hpp"
+#include "config.hpp"
+#include "kokkos_abstraction.hpp"
+#include "parthenon_mpi.hpp"
+#include "utils/hash.hpp"
+
+#ifdef PARTHENON_ENABLE_NCCL
+#ifdef KOKKOS_ENABLE_HIP
+#include <rccl/rccl.h>
+#else
+#include <nccl.h>
+#endif
+#endif
+
+namespace parthenon {
+
+class Mesh;
+
+// Instead of MPI messages that the host has to poll for, stream ordered buffers are
+// exchanged with NCCL (or RCCL) point to point operations that are enqueued on the stream
+// of the MeshData object right after the kernel packing the send buffers. All sends and
+// receives of a ghost exchange are posted in a single group, ordered by their channel
+// keys on both ranks of a pair, and the receive buffers are marked as received right
+// away. The unpacking kernel on the same stream then waits for the data, so neither the
+// sender nor the receiver has to wait on the host. Since operations between two ranks
+// are matched in the order they are posted, all ranks have to post their exchanges in
+// the same order, which requires a single partition per rank, and the number of elements
+// of each message has to be known by the receiver, which requires non-sparse variables.
+class StreamOrderedBuffers {
+ public:
+  using channel_key_t = CoalescedBuffers::channel_key_t;
+  using comm_buf_t = CoalescedBuffers::comm_buf_t;
+  using Segment = CoalescedBuffers::Segment;
+
+  StreamOrderedBuffers() = default;
+  StreamOrderedBuffers(const StreamOrderedBuffers &) = delete;
+  StreamOrderedBuffers &operator=(const StreamOrderedBuffers &) = delete;
+
+  // Check the configuration and set up the communicator, needs to be called by all ranks
+  // before the boundary buffers are built
+  void Initialize(Mesh *pmesh);
+
+  // Register a buffer that is built between this rank and other_rank. For sending
+  // buffers, size is the number of elements that are sent.
+  void Add(int other_rank, const channel_key_t &key, comm_buf_t *buf, std::size_t size,
+           bool sender);
+
+  // Tell the receivers the sizes of their messages, needs to be called by all ranks
+  // after the boundary buffers are built
+  void Build();
+
+  // Post the sends and receives of the (already filled) send segments and the receive
+  // segments of a MeshData object on the stream of exec_space
+  void Exchange(const std::vector<Segment> &send_segments,
+                const std::vector<Segment> &recv_segments,
+                const DevExecSpace &exec_space);
+
+  // Wait for all posted operations, required before the boundary buffers are rebuilt
+  void Clear();
+
+  // Also free the communicators, required before MPI is finalized
+  void Finalize();
+
+ private:
+  struct Channel {
+    channel_key_t key;
+    comm_buf_t *buf;
+    std::size_t size;
+  };
+  std::map<int, std::vector<Channel>> sends_;
+  std::map<int, std::vector<Channel>> receives_;
+  // Number of elements the sender sends on each receiving channel
+  std::unordered_map<channel_key_t, std::size_t, tuple_hash<channel_key_t>> recv_sizes_;
+
+#ifdef MPI_PARALLEL
+  MPI_Comm comm_ = MPI_COMM_NULL;
+#endif
+#ifdef PARTHENON_ENABLE_NCCL
+  ncclComm_t nccl_comm_ = nullptr;
+#endif
+};
+
+} // namespace parthenon
+
+#endif // BVALS_COMMS_STREAM_ORDERED_BUFFERS_HPP_
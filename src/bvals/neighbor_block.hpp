@@ -64,6 +64,9 @@ struct NeighborBlock {
   CellCentOffsets offsets;
   // Ownership of neighbor block of different topological elements
   block_ownership_t ownership;
+  // Ownership of the origin block, which determines the shared elements that the
+  // neighbor takes from the origin block
+  block_ownership_t origin_ownership;
   // Logical coordinate transformation from the main block to this neighbor
   forest::LogicalCoordinateTransformation lcoord_trans;
 
@@ -12,21 +12,29 @@
 //========================================================================================
 
 #include <algorithm>
+#include <array>
 #include <chrono>
 #include <fstream>
 #include <iomanip>
 #include <limits>
+#include <string>
+#include <vector>
 
 #include "driver/driver.hpp"
 
 #include "bvals/comms/bvals_in_one.hpp"
+#include "driver/pack_size_tuner.hpp"
 #include "globals.hpp"
 #include "interface/update.hpp"
 #include "mesh/mesh.hpp"
 #include "mesh/meshblock.hpp"
 #include "outputs/outputs.hpp"
+#include "outputs/time_average.hpp"
 #include "parameter_input.hpp"
 #include "parthenon_mpi.hpp"
+#include "utils/comm_statistics.hpp"
+#include "utils/instrument.hpp"
+#include "utils/telemetry.hpp"
 #include "utils/utils.hpp"
 
 namespace parthenon {
@@ -38,9 +46,24 @@ Kokkos::Timer Driver::timer_cycle;
 Kokkos::Timer Driver::timer_LBandAMR;
 
 void Driver::PreExecute() {
+  const auto &startup = pmesh->GetStartupTimes();
+  std::array<double, 5> startup_times{startup.block_construction, startup.neighbors,
+                                      startup.problem_generator, startup.boundaries,
+                                      startup.refinement};
+#ifdef MPI_PARALLEL
+  PARTHENON_MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, startup_times.data(),
+                                    startup_times.size(), MPI_DOUBLE, MPI_MAX,
+                                    MPI_COMM_WORLD));
+#endif
   if (Globals::my_rank == 0) {
     std::cout << "# Variables in use:\n" << *(pmesh->resolved_packages) << std::endl;
     std::cout << std::endl;
+    std::cout << "Startup times [s] (maximum over ranks): block_construction="
+              << startup_times[0] << " neighbors=" << startup_times[1]
+              << " problem_generator=" << startup_times[2]
+              << " boundaries=" << startup_times[3] << " refinement=" << startup_times[4]
+              << "\n"
+              << std::endl;
     std::cout << "Setup complete, executing driver...\n" << std::endl;
   }
 
@@ -86,6 +109,26 @@ DriverStatus EvolutionDriver::Execute() {
   pmesh->mbcnt = 0;
   int perf_cycle_offset =
       pinput->GetOrAddInteger("parthenon/time", "perf_cycle_offset", 0);
+  // Record the execution of all tasks and the critical path of every cycle
+  const bool profile_tasks =
+      pinput->GetOrAddBoolean("parthenon/time", "profile_tasks", false);
+  if (profile_tasks) {
+    TaskProfiler::Instance().SetMaxEvents(
+        pinput->GetOrAddInteger("parthenon/time", "profile_tasks_max_events", 10000000));
+    TaskProfiler::Instance().Enable(true);
+  }
+
+  // Accumulate the times of all instrumented regions for a report at the end of the run
+  const bool report_timers =
+      pinput->GetOrAddBoolean("parthenon/time", "instrument_timers", false);
+  if (report_timers) TimerRegistry::Enable(true);
+  // Count the messages exchanged with every rank and the time spent waiting for them
+  const bool comm_statistics =
+      pinput->GetOrAddBoolean("parthenon/time", "comm_statistics", false);
+  if (comm_statistics) CommStatistics::Enable(true);
+
+  // Select the number of partitions from the measured step times if requested
+  PackSizeTuner pack_size_tuner(pinput, pmesh);
 
   // Output a text file of all parameters at this point
   // Defaults must be set across all ranks
@@ -93,8 +136,10 @@ DriverStatus EvolutionDriver::Execute() {
 
   { // Main t < tmax loop region
     PARTHENON_INSTRUMENT
+    auto &telemetry = Telemetry::Instance();
     while (tm.KeepGoing() && signal != OutputSignal::analysis) {
       if (Globals::my_rank == 0) OutputCycleDiagnostics();
+      OutputMemoryDiagnostics();
 
       if (pmesh->PreStepUserWorkInLoop != nullptr) {
         pmesh->PreStepUserWorkInLoop(pmesh, pinput, tm);
@@ -103,7 +148,10 @@ DriverStatus EvolutionDriver::Execute() {
         pmesh->PreStepUserDiagnosticsInLoop(pmesh, pinput, tm);
       }
 
+      Kokkos::Timer timer_step;
       TaskListStatus status = Step();
+      const double time_step = timer_step.seconds();
+      if (profile_tasks) TaskProfiler::Instance().FinishCycle(tm.ncycle);
       if (status != TaskListStatus::complete) {
         std::cerr << "Step failed to complete all tasks." << std::endl;
         return DriverStatus::failed;
@@ -120,11 +168,14 @@ DriverStatus EvolutionDriver::Execute() {
       tm.time += tm.dt;
       pmesh->mbcnt += pmesh->nbtotal;
       pmesh->step_since_lb++;
+      TimeAverage::Accumulate(pmesh, tm.dt);
 
       timer_LBandAMR.reset();
       pmesh->LoadBalancingAndAdaptiveMeshRefinement(pinput, app_input);
       if (pmesh->modified) InitializeBlockTimeSteps();
       time_LBandAMR += timer_LBandAMR.seconds();
+      time_remesh_total_ += timer_LBandAMR.seconds();
+      pack_size_tuner.FinishCycle(time_step, pmesh->modified);
       SetGlobalTimeStep();
 
       // check for signals
@@ -137,12 +188,21 @@ DriverStatus EvolutionDriver::Execute() {
       // skip the final (last) output at the end of the simulation time as it happens
       // later
       if (tm.KeepGoing()) {
+        Kokkos::Timer timer_outputs;
         pouts->MakeOutputs(pmesh, pinput, &tm, signal);
+        time_outputs_total_ += timer_outputs.seconds();
+        if (telemetry.Enabled()) {
+          telemetry.Add(Telemetry::output, timer_outputs.seconds());
+        }
       }
+      // The records of a cycle are written by the next telemetry output
+      if (telemetry.Enabled()) telemetry.FinishCycle(tm.ncycle);
 
       if (tm.ncycle == perf_cycle_offset) {
         pmesh->mbcnt = 0;
         timer_main.reset();
+        time_remesh_total_ = 0.0;
+        time_outputs_total_ = 0.0;
       }
     } // END OF MAIN INTEGRATION LOOP
       // ======================================================
@@ -152,11 +212,33 @@ DriverStatus EvolutionDriver::Execute() {
     pmesh->UserWorkAfterLoop(pmesh, pinput, tm);
   }
 
+  if (report_timers) {
+    TimerRegistry::Enable(false);
+    if (Globals::my_rank == 0) TimerRegistry::Report(std::cout);
+  }
+
+  if (comm_statistics) {
+    CommStatistics::Enable(false);
+    CommStatistics::Instance().Write("comm_statistics." +
+                                     std::to_string(Globals::my_rank) + ".txt");
+  }
+
+  if (profile_tasks) {
+    auto &profiler = TaskProfiler::Instance();
+    profiler.Enable(false);
+    const std::string rank = std::to_string(Globals::my_rank);
+    profiler.WriteChromeTrace("task_profile." + rank + ".json", Globals::my_rank);
+    profiler.WriteCriticalPaths("task_critical_path." + rank + ".txt");
+    profiler.Clear();
+  }
+
   DriverStatus status = DriverStatus::complete;
   // Do *not* write the "final" output, if this is analysis run.
   // The analysis output itself has already been written above before the main loop.
   if (signal != OutputSignal::analysis) {
+    Kokkos::Timer timer_outputs;
     pouts->MakeOutputs(pmesh, pinput, &tm, OutputSignal::final);
+    time_outputs_total_ += timer_outputs.seconds();
   }
   PostExecute(status);
   return status;
@@ -194,8 +276,9 @@ void EvolutionDriver::InitializeBlockTimeSteps() {
     Update::EstimateTimestep(pmb->meshblock_data.Get().get());
   }
   // calculate the first time step using Mesh function
-  for (auto &partition : pmesh->GetDefaultBlockPartitions()) {
-    auto &mbase = pmesh->mesh_data.Add("base", partition);
+  const auto base = pmesh->mesh_data.GetStageHandle("base");
+  for (int ipart = 0; ipart < pmesh->DefaultNumPartitions(); ++ipart) {
+    auto &mbase = pmesh->mesh_data.GetOrAdd(base, ipart);
     Update::EstimateTimestep(mbase.get());
   }
 }
@@ -210,16 +293,52 @@ void EvolutionDriver::SetGlobalTimeStep() {
   if (tm.dt < 0.1 * std::numeric_limits<Real>::max()) {
     tm.dt *= 2.0;
   }
+  tm.dt = std::min(tm.dt, max_next_dt_);
   Real big = std::numeric_limits<Real>::max();
+  const int nlevels = report_subcycling_speedup_ ? pmesh->GetCurrentLevel() + 1 : 0;
+  std::vector<Real> level_dt(nlevels, big);
+  std::vector<int> level_nblocks(nlevels, 0);
   for (auto const &pmb : pmesh->block_list) {
     tm.dt = std::min(tm.dt, pmb->NewDt());
+    if (report_subcycling_speedup_) {
+      const int level = pmb->loc.level();
+      level_dt[level] = std::min(level_dt[level], pmb->NewDt());
+      level_nblocks[level]++;
+    }
     pmb->SetAllowedDt(big);
   }
 
 #ifdef MPI_PARALLEL
-  PARTHENON_MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, &tm.dt, 1, MPI_PARTHENON_REAL, MPI_MIN,
-                                    MPI_COMM_WORLD));
+  if (report_subcycling_speedup_) {
+    // Reduce the global dt together with the dt of every level
+    level_dt.push_back(tm.dt);
+    PARTHENON_MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, level_dt.data(), nlevels + 1,
+                                      MPI_PARTHENON_REAL, MPI_MIN, MPI_COMM_WORLD));
+    tm.dt = level_dt.back();
+    level_dt.pop_back();
+    PARTHENON_MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, level_nblocks.data(), nlevels,
+                                      MPI_INT, MPI_SUM, MPI_COMM_WORLD));
+  } else {
+    PARTHENON_MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, &tm.dt, 1, MPI_PARTHENON_REAL,
+                                      MPI_MIN, MPI_COMM_WORLD));
+  }
 #endif
+  if (report_subcycling_speedup_) {
+    // With subcycling the finest level takes the smallest step that satisfies the dt of
+    // every level, when every coarser level doubles it
+    Real dt_min = big, dt_finest = big;
+    for (int l = 0; l < nlevels; ++l) {
+      if (level_nblocks[l] == 0) continue;
+      dt_min = std::min(dt_min, level_dt[l]);
+      dt_finest = std::min(dt_finest, level_dt[l] / (1 << (nlevels - 1 - l)));
+    }
+    double updates_global = 0.0, updates_subcycled = 0.0;
+    for (int l = 0; l < nlevels; ++l) {
+      updates_global += level_nblocks[l] / dt_min;
+      updates_subcycled += level_nblocks[l] / (dt_finest * (1 << (nlevels - 1 - l)));
+    }
+    if (updates_subcycled > 0.0) subcycling_speedup_ = updates_global / updates_subcycled;
+  }
 
   if (tm.time < tm.tlim &&
       (tm.tlim - tm.time) < tm.dt) // timestep would take us past desired endpoint
@@ -267,7 +386,16 @@ void EvolutionDriver::OutputCycleDiagnostics() {
       if (pmesh->adaptive) {
         std::cout << " zone-cycles/wsec="
                   << static_cast<double>(zonecycles) / (time_cycle_step + time_LBandAMR)
-                  << " wsec_AMR=" << time_LBandAMR;
+                  << " wsec_AMR=" << time_LBandAMR << " MB_migrated="
+                  << static_cast<double>(pmesh->GetMigratedBytes() - migrated_bytes_prev) /
+                         (1024. * 1024.)
+                  << " MB_buffer_pools="
+                  << static_cast<double>(pmesh->GetBufferPoolSizeInBytes()) /
+                         (1024. * 1024.);
+      }
+
+      if (report_subcycling_speedup_) {
+        std::cout << " subcycling_speedup=" << subcycling_speedup_;
       }
 
       // insert more diagnostics here
@@ -278,6 +406,7 @@ void EvolutionDriver::OutputCycleDiagnostics() {
       time_LBandAMR = 0.0;
       // need to cache number of MeshBlocks as AMR/load balance change it
       mbcnt_prev = pmesh->mbcnt;
+      migrated_bytes_prev = pmesh->GetMigratedBytes();
     }
   }
   if (tm.ncycle_out_mesh != 0) {
@@ -297,4 +426,21 @@ void EvolutionDriver::OutputCycleDiagnostics() {
   }
 }
 
+void EvolutionDriver::OutputMemoryDiagnostics() {
+  if (ncycle_out_memory_ <= 0 || tm.ncycle % ncycle_out_memory_ != 0) return;
+  const auto usage = pmesh->GetMemoryUsage();
+  const auto sum = usage.Sum();
+  const auto max = usage.Max();
+  if (Globals::my_rank == 0) {
+    std::cout << "---------------------- Memory usage summed over ranks --------------"
+              << std::endl;
+    sum.Print(std::cout);
+    std::cout << "---------------------- Maximum memory usage of a rank --------------"
+              << std::endl;
+    max.Print(std::cout);
+    std::cout << "--------------------------------------------------------------------"
+              << std::endl;
+  }
+}
+
 } // namespace parthenon
@@ -14,6 +14,7 @@
 #ifndef DRIVER_DRIVER_HPP_
 #define DRIVER_DRIVER_HPP_
 
+#include <algorithm>
 #include <limits>
 #include <map>
 #include <memory>
@@ -38,7 +39,8 @@ enum class DriverStatus { complete, timeout, failed };
 class Driver {
  public:
   Driver(ParameterInput *pin, ApplicationInput *app_in, Mesh *pm)
-      : pinput(pin), app_input(app_in), pmesh(pm), mbcnt_prev(), time_LBandAMR() {}
+      : pinput(pin), app_input(app_in), pmesh(pm), mbcnt_prev(), migrated_bytes_prev(),
+        time_LBandAMR() {}
   virtual DriverStatus Execute() = 0;
   void InitializeOutputs() { pouts = std::make_unique<Outputs>(pmesh, pinput); }
 
@@ -54,6 +56,7 @@ class Driver {
   static Kokkos::Timer timer_cycle, timer_main, timer_LBandAMR;
   double time_LBandAMR;
   std::uint64_t mbcnt_prev;
+  std::uint64_t migrated_bytes_prev;
   virtual void PreExecute();
   virtual void PostExecute(DriverStatus status);
 
@@ -76,11 +79,20 @@ class EvolutionDriver : public Driver {
     const auto nout_mesh =
         pinput->GetOrAddInteger("parthenon/time", "ncycle_out_mesh", 0);
     tm = SimTime(start_time, tstop, nmax, ncycle, nout, nout_mesh, dt);
+    // disable memory usage output by default
+    ncycle_out_memory_ =
+        pinput->GetOrAddInteger("parthenon/time", "ncycle_out_memory", 0);
+    // estimate of the gain of level-based subcycling, disabled by default
+    report_subcycling_speedup_ =
+        pm->multilevel &&
+        pinput->GetOrAddBoolean("parthenon/time", "report_subcycling_speedup", false);
     pouts = std::make_unique<Outputs>(pmesh, pinput, &tm);
   }
   DriverStatus Execute() override;
   void SetGlobalTimeStep();
   void OutputCycleDiagnostics();
+  // Collective, as the memory usage is reduced over all ranks
+  void OutputMemoryDiagnostics();
   void DumpInputParameters();
 
   virtual TaskListStatus Step() = 0;
@@ -88,13 +100,54 @@ class EvolutionDriver : public Driver {
 
  protected:
   void PostExecute(DriverStatus status) override;
+  // Upper limit of the dt of the next cycle set by the time integration, e.g., from the
+  // error estimate of an embedded integrator, in addition to the block dts
+  Real max_next_dt_ = std::numeric_limits<Real>::max();
+  // Wall time spent in load balancing and mesh refinement and in writing outputs since
+  // the performance measurement started (see perf_cycle_offset)
+  double time_remesh_total_ = 0.0;
+  double time_outputs_total_ = 0.0;
 
  private:
   void InitializeBlockTimeSteps();
+  int ncycle_out_memory_ = 0;
+  bool report_subcycling_speedup_ = false;
+  // Ratio of the block updates per unit time with the global dt to those with every
+  // level stepping with twice the dt of the next finer level, from the block dts of the
+  // last SetGlobalTimeStep
+  Real subcycling_speedup_ = 1.0;
 };
 
 namespace DriverUtils {
 
+// When timing based load balancing is enabled, attribute the measured execution time of
+// the task lists in every region to the blocks they operate on. Lists are matched to
+// blocks by index if a region has one list per block, or to the default MeshData
+// partitions if it has one list per partition. The time of a partition is split evenly
+// among its blocks. Other regions are not measured.
+inline void MeasureBlockCosts(Mesh *pmesh, TaskCollection &tc) {
+  if (!pmesh->TimingBasedLoadBalancing()) return;
+  auto &block_list = pmesh->block_list;
+  auto &partitions = pmesh->GetDefaultBlockPartitions();
+  tc.ForEachRegion([&](TaskRegion &region) {
+    if (region.size() == block_list.size()) {
+      for (int i = 0; i < region.size(); ++i) {
+        MeshBlock *pmb = block_list[i].get();
+        region[i].SetCostFunction([pmb](double t) { pmb->AddCostForLoadBalancing(t); });
+      }
+    } else if (region.size() == partitions.size()) {
+      for (int i = 0; i < region.size(); ++i) {
+        auto part = partitions[i];
+        region[i].SetCostFunction([part](double t) {
+          const double t_block = t / std::max<std::size_t>(part->block_list.size(), 1);
+          for (auto &pmb : part->block_list)
+            pmb->AddCostForLoadBalancing(t_block);
+        });
+      }
+    }
+  });
+}
+
 template <typename T, class... Args>
 TaskListStatus ConstructAndExecuteBlockTasks(T *driver, Args... args) {
   int nmb = driver->pmesh->GetNumMeshBlocksThisRank(Globals::my_rank);
@@ -105,6 +158,7 @@ TaskListStatus ConstructAndExecuteBlockTasks(T *driver, Args... args) {
   for (auto &pmb : driver->pmesh->block_list) {
     tr[i++] = driver->MakeTaskList(pmb.get(), std::forward<Args>(args)...);
   }
+  MeasureBlockCosts(driver->pmesh, tc);
   TaskListStatus status = tc.Execute();
   return status;
 }
@@ -113,6 +167,7 @@ template <typename T, class... Args>
 TaskListStatus ConstructAndExecuteTaskLists(T *driver, Args... args) {
   TaskCollection tc =
       driver->MakeTaskCollection(driver->pmesh->block_list, std::forward<Args>(args)...);
+  MeasureBlockCosts(driver->pmesh, tc);
   TaskListStatus status = tc.Execute();
   return status;
 }
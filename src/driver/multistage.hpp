@@ -16,6 +16,7 @@
 
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include "application_input.hpp"
@@ -24,6 +25,7 @@
 #include "parameter_input.hpp"
 #include "tasks/tasks.hpp"
 #include "time_integration/staged_integrator.hpp"
+#include "utils/error_checking.hpp"
 
 namespace parthenon {
 
@@ -40,22 +42,49 @@ class MultiStageDriverGeneric : public EvolutionDriver {
     PARTHENON_INSTRUMENT
     using DriverUtils::ConstructAndExecuteTaskLists;
     TaskListStatus status;
-    integrator->dt = tm.dt;
-    for (int stage = 1; stage <= integrator->nstages; stage++) {
-      // Clear any initialization info. We should be relying
-      // on only the immediately preceding stage to contain
-      // reasonable data
-      pmesh->SetAllVariablesToInitialized();
-      status = ConstructAndExecuteTaskLists<>(this, stage);
-      if (status != TaskListStatus::complete) break;
+    for (int attempt = 0;; ++attempt) {
+      integrator->dt = tm.dt;
+      if constexpr (std::is_same_v<Integrator, ButcherIntegrator>) {
+        integrator->error = 0.0;
+      }
+      for (int stage = 1; stage <= integrator->nstages; stage++) {
+        // Clear any initialization info. We should be relying
+        // on only the immediately preceding stage to contain
+        // reasonable data
+        pmesh->SetAllVariablesToInitialized();
+        status = ConstructAndExecuteTaskLists<>(this, stage);
+        if (status != TaskListStatus::complete) break;
+      }
+      if (status != TaskListStatus::complete || !RetryStep_(attempt)) break;
     }
     return status;
   }
 
  protected:
   std::unique_ptr<Integrator> integrator;
+
+ private:
+  // With an embedded Butcher tableau, limit the dt of the next cycle after an accepted
+  // step, or shrink the dt and return true to repeat a rejected one. The tasks must
+  // leave the base container untouched unless integrator->StepAccepted().
+  bool RetryStep_(const int attempt) {
+    if constexpr (std::is_same_v<Integrator, ButcherIntegrator>) {
+      if (!integrator->IsEmbedded()) return false;
+      const Real dt_new = integrator->ErrorControlledDt(tm.dt);
+      if (integrator->StepAccepted()) {
+        max_next_dt_ = dt_new;
+        return false;
+      }
+      PARTHENON_REQUIRE_THROWS(attempt < integrator->max_rejections,
+                               "Too many rejected steps of the embedded integrator");
+      tm.dt = dt_new;
+      return true;
+    }
+    return false;
+  }
 };
 using MultiStageDriver = MultiStageDriverGeneric<LowStorageIntegrator>;
+using ImexDriver = MultiStageDriverGeneric<ImexIntegrator>;
 
 template <typename Integrator = LowStorageIntegrator>
 class MultiStageBlockTaskDriverGeneric : public MultiStageDriverGeneric<Integrator> {
@@ -0,0 +1,112 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "parthenon_mpi.hpp"
+
+#include "driver/pack_size_tuner.hpp"
+#include "globals.hpp"
+#include "mesh/mesh.hpp"
+#include "parameter_input.hpp"
+#include "utils/error_checking.hpp"
+
+namespace parthenon {
+
+PackSizeTuner::PackSizeTuner(ParameterInput *pin, Mesh *pmesh)
+    : pmesh_(pmesh),
+      enabled_(pin->GetOrAddBoolean("parthenon/mesh", "pack_size_autotune", false)),
+      warmup_cycles_(
+          pin->GetOrAddInteger("parthenon/mesh", "pack_size_autotune_warmup", 1)),
+      measure_cycles_(
+          pin->GetOrAddInteger("parthenon/mesh", "pack_size_autotune_cycles", 3)),
+      retune_fraction_(pin->GetOrAddReal("parthenon/mesh",
+                                         "pack_size_autotune_retune_fraction", 0.5)) {
+  PARTHENON_REQUIRE_THROWS(warmup_cycles_ >= 0 && measure_cycles_ > 0,
+                           "pack_size_autotune_warmup must not be negative and "
+                           "pack_size_autotune_cycles must be positive");
+  if (enabled_) Start();
+}
+
+void PackSizeTuner::Start() {
+  int nmax = pmesh_->block_list.size();
+#ifdef MPI_PARALLEL
+  PARTHENON_MPI_CHECK(
+      MPI_Allreduce(MPI_IN_PLACE, &nmax, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD));
+#endif
+  candidates_.clear();
+  for (int n = 1; n < nmax; n *= 2)
+    candidates_.push_back(n);
+  candidates_.push_back(std::max(nmax, 1));
+  times_.assign(candidates_.size(), 0.0);
+  current_ = 0;
+  ncycles_ = 0;
+  tuning_ = true;
+  Apply(candidates_[0]);
+}
+
+void PackSizeTuner::Apply(const int npartitions) {
+  const int nblocks = pmesh_->block_list.size();
+  pmesh_->SetDefaultPackSize(std::max(1, (nblocks + npartitions - 1) / npartitions));
+}
+
+void PackSizeTuner::FinishCycle(const double seconds, const bool remeshed) {
+  if (!enabled_) return;
+  const int nblocks = pmesh_->block_list.size();
+  if (remeshed) {
+    // The block count on a rank changes collectively, so the decision is collective too
+    if (tuning_) {
+      // Start over, the measurements no longer apply to the new blocks
+      Start();
+      return;
+    }
+    double change = std::abs(nblocks - nblocks_tuned_) /
+                    static_cast<double>(std::max(nblocks_tuned_, 1));
+#ifdef MPI_PARALLEL
+    PARTHENON_MPI_CHECK(
+        MPI_Allreduce(MPI_IN_PLACE, &change, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD));
+#endif
+    if (change > retune_fraction_) Start();
+    return;
+  }
+  if (!tuning_) return;
+
+  if (ncycles_++ >= warmup_cycles_) times_[current_] += seconds;
+  if (ncycles_ < warmup_cycles_ + measure_cycles_) return;
+
+  ncycles_ = 0;
+  if (++current_ < static_cast<int>(candidates_.size())) {
+    Apply(candidates_[current_]);
+    return;
+  }
+
+  // Ranks wait for each other every cycle, so the slowest rank sets the cycle time
+#ifdef MPI_PARALLEL
+  PARTHENON_MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, times_.data(), times_.size(),
+                                    MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD));
+#endif
+  const int best = std::min_element(times_.begin(), times_.end()) - times_.begin();
+  Apply(candidates_[best]);
+  tuning_ = false;
+  nblocks_tuned_ = nblocks;
+  if (Globals::my_rank == 0) {
+    std::cout << "Pack size autotuning: " << candidates_[best]
+              << " partition(s) per rank, average step time "
+              << times_[best] / measure_cycles_ << " s" << std::endl;
+  }
+}
+
+} // namespace parthenon
@@ -0,0 +1,60 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef DRIVER_PACK_SIZE_TUNER_HPP_
+#define DRIVER_PACK_SIZE_TUNER_HPP_
+//! \file pack_size_tuner.hpp
+//  \brief Runtime selection of the number of MeshData partitions
+
+#include <vector>
+
+namespace parthenon {
+
+class Mesh;
+class ParameterInput;
+
+// Measures the time of a few cycles for 1, 2, 4, ... partitions of the local blocks (up
+// to one block per partition) and keeps the partition count with the fastest cycles as
+// the pack size of the mesh. Tuning starts with the first cycle and restarts after a
+// remesh changes the number of blocks on any rank by more than a given fraction.
+// All ranks try the same partition counts at the same time and decide on the max of
+// the cycle times over ranks, so the calls are collective.
+class PackSizeTuner {
+ public:
+  PackSizeTuner(ParameterInput *pin, Mesh *pmesh);
+
+  bool Enabled() const { return enabled_; }
+  // Called by the driver after every cycle with the time spent in the step and whether
+  // the mesh has been modified since the last call
+  void FinishCycle(double seconds, bool remeshed);
+
+ private:
+  void Start();
+  void Apply(int npartitions);
+
+  Mesh *pmesh_;
+  bool enabled_;
+  int warmup_cycles_;  // cycles ignored after every change of the pack size
+  int measure_cycles_; // cycles measured for every partition count
+  double retune_fraction_;
+
+  bool tuning_ = false;
+  std::vector<int> candidates_; // partition counts
+  std::vector<double> times_;
+  int current_ = 0;
+  int ncycles_ = 0;
+  int nblocks_tuned_ = 0; // number of local blocks when the tuning finished
+};
+
+} // namespace parthenon
+
+#endif // DRIVER_PACK_SIZE_TUNER_HPP_
@@ -0,0 +1,106 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef INTERFACE_BLOCK_METADATA_HPP_
+#define INTERFACE_BLOCK_METADATA_HPP_
+//! \file block_metadata.hpp
+//  \brief Device copy of the block and neighbor information of a MeshData
+
+#include <cstdint>
+
+#include "coordinates/coordinates.hpp"
+#include "defs.hpp"
+#include "kokkos_abstraction.hpp"
+#include "mesh/domain.hpp"
+
+namespace parthenon {
+
+// Struct of arrays with the gid, logical location, physical boundary flags, coordinates,
+// and (in compressed sparse row format) the neighbors of every block of a MeshData, so
+// that kernels do not have to go back to the host MeshBlocks to look these up. Block b
+// here is block b of the MeshData. The neighbors of block b are the entries
+// neighbor_start(b) <= n < neighbor_start(b + 1) of the neighbor arrays, their
+// neighbor_index is the index of the neighbor in the same MeshData or -1 if it is not
+// part of it. It is built by MeshData::GetBlockMetadata and kept until the block list
+// of the mesh changes, so can be captured by value in kernels.
+// The uniform grids of the blocks of a MeshData in a few small tables, for kernels that
+// only need cell widths and positions and would otherwise load the coordinates of every
+// block through a pack. xmin is the position of the lower face of cell index 0, so it
+// includes the ghost zones, as in UniformCartesian.
+struct BlockGeometry {
+  ParArray2D<Real> dx;   // (b, direction - 1)
+  ParArray2D<Real> xmin; // (b, direction - 1)
+  ParArray1D<int> level;
+  IndexShape cellbounds; // the same for all blocks
+
+  KOKKOS_FORCEINLINE_FUNCTION
+  Real Dx(const int b, const int dir) const { return dx(b, dir - 1); }
+  KOKKOS_FORCEINLINE_FUNCTION
+  Real Xc(const int b, const int dir, const int idx) const {
+    return xmin(b, dir - 1) + (idx + 0.5) * dx(b, dir - 1);
+  }
+  KOKKOS_FORCEINLINE_FUNCTION
+  Real Xf(const int b, const int dir, const int idx) const {
+    return xmin(b, dir - 1) + idx * dx(b, dir - 1);
+  }
+  KOKKOS_FORCEINLINE_FUNCTION
+  Real CellVolume(const int b) const { return dx(b, 0) * dx(b, 1) * dx(b, 2); }
+  KOKKOS_INLINE_FUNCTION
+  IndexRange GetBoundsI(const IndexDomain domain) const {
+    return cellbounds.GetBoundsI(domain);
+  }
+  KOKKOS_INLINE_FUNCTION
+  IndexRange GetBoundsJ(const IndexDomain domain) const {
+    return cellbounds.GetBoundsJ(domain);
+  }
+  KOKKOS_INLINE_FUNCTION
+  IndexRange GetBoundsK(const IndexDomain domain) const {
+    return cellbounds.GetBoundsK(domain);
+  }
+};
+
+struct BlockMetadata {
+  int nblocks = 0;
+  int nneighbors = 0;
+
+  ParArray1D<int> gid;
+  ParArray1D<int> level;
+  ParArray2D<std::int64_t> lx; // (b, direction)
+  ParArray2D<int> bcs;         // (b, BoundaryFace), a BoundaryFlag
+  ParArray1D<ParArray0D<Coordinates_t>> coords;
+  BlockGeometry geometry; // shares level with the above
+
+  ParArray1D<int> neighbor_start;
+  ParArray1D<int> neighbor_gid;
+  ParArray1D<int> neighbor_rank;
+  ParArray1D<int> neighbor_level;
+  ParArray1D<int> neighbor_index;
+  ParArray2D<int> neighbor_offsets; // (n, direction), -1, 0 or 1
+
+  KOKKOS_INLINE_FUNCTION
+  int NumNeighbors(const int b) const {
+    return neighbor_start(b + 1) - neighbor_start(b);
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  bool IsPhysicalBoundary(const int b, const BoundaryFace face) const {
+    return bcs(b, face) != static_cast<int>(BoundaryFlag::block) &&
+           bcs(b, face) != static_cast<int>(BoundaryFlag::periodic);
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  const Coordinates_t &GetCoordinates(const int b) const { return coords(b)(); }
+};
+
+} // namespace parthenon
+
+#endif // INTERFACE_BLOCK_METADATA_HPP_
@@ -61,6 +61,31 @@ DataCollection<MeshData<Real>>::GetOrAdd(int gmg_level, const std::string &mbd_l
                  GridIdentifier::two_level_composite(gmg_level))[partition_id]);
 }
 
+template <>
+std::shared_ptr<MeshData<Real>> &
+DataCollection<MeshData<Real>>::GetOrAdd(StageHandle stage, const int &partition_id) {
+  PARTHENON_REQUIRE(stage.idx >= 0 && stage.idx < stage_labels_.size(),
+                    "Invalid stage handle");
+  // Get the handle first, since adding it can move the caches
+  const auto base = GetStageHandle("base");
+  auto &cache = stage_cache_[stage.idx];
+  // The partitions only change with the block list or pack size, which purge the
+  // caches, so a cache is sized once and references to its containers stay valid
+  if (cache.empty()) cache.resize(pmy_mesh_->GetDefaultBlockPartitions().size());
+  PARTHENON_DEBUG_REQUIRE(partition_id >= 0 && partition_id < cache.size(),
+                          "Partition id out of range");
+  auto &md = cache[partition_id];
+  if (md == nullptr) {
+    const auto &label = stage_labels_[stage.idx];
+    if (stage.idx == base.idx) {
+      md = GetOrAdd(label, partition_id);
+    } else {
+      md = Add(label, GetOrAdd(base, partition_id));
+    }
+  }
+  return md;
+}
+
 template class DataCollection<MeshData<Real>>;
 template class DataCollection<MeshBlockData<Real>>;
 
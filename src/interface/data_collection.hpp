@@ -84,6 +84,25 @@ class DataCollection {
     return Add(label, src, fields, true);
   }
 
+  // Add a container that only gets new storage for the variables with one of
+  // private_flags (Metadata::Independent by default) and their fluxes, while all other
+  // variables share the storage of the variables in src. Useful for integrator stages
+  // of packages with many derived fields that don't need a copy per stage.
+  template <class SRC_t, class... Flags_t>
+  std::shared_ptr<T> &AddSharing(const std::string &label,
+                                 const std::shared_ptr<SRC_t> &src,
+                                 const Flags_t &...private_flags) {
+    auto key = GetKey(label, src);
+    auto it = containers_.find(key);
+    if (it != containers_.end()) return it->second;
+
+    auto c = std::make_shared<T>(label);
+    c->InitializeSharing(src, private_flags...);
+
+    containers_[key] = c;
+    return containers_[key];
+  }
+
   auto &Stages() { return containers_; }
   const auto &Stages() const { return containers_; }
 
@@ -104,6 +123,27 @@ class DataCollection {
   std::shared_ptr<T> &GetOrAdd(int gmg_level, const std::string &mbd_label,
                                const int &partition_id);
 
+  // Stable handle of a stage label, which stays valid for the lifetime of the collection
+  struct StageHandle {
+    int idx = -1;
+  };
+  StageHandle GetStageHandle(const std::string &label) {
+    auto it = stage_handles_.find(label);
+    if (it != stage_handles_.end()) return StageHandle{it->second};
+    const int idx = stage_labels_.size();
+    stage_handles_[label] = idx;
+    stage_labels_.push_back(label);
+    stage_cache_.emplace_back();
+    return StageHandle{idx};
+  }
+  // Container of a stage on one of the default (leaf) partitions of the mesh. Stages
+  // other than "base" are added from the "base" container of the partition, like
+  // Add(label, GetOrAdd(base, partition_id)). The containers are cached per handle and
+  // partition until the next PurgeNonBase (which every remesh calls), so that building
+  // the task lists of many partitions every cycle doesn't build and look up the keys of
+  // the containers. Specific to MeshData.
+  std::shared_ptr<T> &GetOrAdd(StageHandle stage, const int &partition_id);
+
   void PurgeNonBase() {
     auto c = containers_.begin();
     while (c != containers_.end()) {
@@ -113,6 +153,8 @@ class DataCollection {
         ++c;
       }
     }
+    for (auto &cache : stage_cache_)
+      cache.clear();
   }
 
  private:
@@ -127,6 +169,10 @@ class DataCollection {
 
   Mesh *pmy_mesh_;
   std::map<std::string, std::shared_ptr<T>> containers_;
+  // Labels of the stage handles and their containers per partition
+  std::map<std::string, int> stage_handles_;
+  std::vector<std::string> stage_labels_;
+  std::vector<std::vector<std::shared_ptr<T>>> stage_cache_;
 };
 
 } // namespace parthenon
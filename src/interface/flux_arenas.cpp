@@ -0,0 +1,57 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <cstddef>
+#include <utility>
+
+#include "interface/flux_arenas.hpp"
+
+namespace parthenon {
+
+FluxArenas::storage_t FluxArenas::Get(const std::size_t size, const Real *preferred) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = free_.lower_bound(size);
+  for (auto p = it; p != free_.end(); ++p) {
+    if (p->second.data() == preferred) {
+      it = p;
+      break;
+    }
+  }
+  if (it != free_.end()) {
+    auto arena = std::move(it->second);
+    free_.erase(it);
+    return arena;
+  }
+  // Fluxes are computed before they are read, so the storage is not initialized
+  return storage_t(Kokkos::view_alloc(Kokkos::WithoutInitializing, "flux arena"), size);
+}
+
+void FluxArenas::Release(const storage_t &arena) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (arena.size() > 0) free_.emplace(arena.size(), arena);
+}
+
+void FluxArenas::Finalize() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  free_.clear();
+}
+
+std::size_t FluxArenas::GetSizeInBytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::size_t bytes = 0;
+  for (const auto &[size, arena] : free_)
+    bytes += size * sizeof(Real);
+  return bytes;
+}
+
+} // namespace parthenon
@@ -0,0 +1,60 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef INTERFACE_FLUX_ARENAS_HPP_
+#define INTERFACE_FLUX_ARENAS_HPP_
+//! \file flux_arenas.hpp
+//  \brief Storage of the flux variables of partitions that is shared between partitions
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+
+#include "basic_types.hpp"
+#include "kokkos_abstraction.hpp"
+
+namespace parthenon {
+
+// Arenas that hold the flux variables of a partition only while its fluxes are live, see
+// MeshData::AcquireFluxes. An arena that is released by one partition is handed to the
+// next one that acquires its fluxes, so the flux memory scales with the number of
+// partitions that compute fluxes at the same time instead of the number of blocks.
+class FluxArenas {
+ public:
+  using storage_t = Kokkos::View<Real *, LayoutWrapper, DevMemSpace>;
+
+  FluxArenas() = default;
+  FluxArenas(const FluxArenas &) = delete;
+  FluxArenas &operator=(const FluxArenas &) = delete;
+
+  void Initialize(bool enabled) { enabled_ = enabled; }
+  bool Enabled() const { return enabled_; }
+
+  // Storage of at least size elements. If the arena starting at preferred is unused and
+  // large enough it is returned, so that partitions keep getting the same storage and
+  // the caches holding views of their fluxes stay valid.
+  storage_t Get(std::size_t size, const Real *preferred);
+  void Release(const storage_t &arena);
+  // Free the storage that is currently not in use
+  void Finalize();
+  std::size_t GetSizeInBytes() const;
+
+ private:
+  bool enabled_ = false;
+  mutable std::mutex mutex_;
+  // unused storage by its number of elements
+  std::multimap<std::size_t, storage_t> free_;
+};
+
+} // namespace parthenon
+
+#endif // INTERFACE_FLUX_ARENAS_HPP_
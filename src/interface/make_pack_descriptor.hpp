@@ -14,10 +14,12 @@
 #define INTERFACE_MAKE_PACK_DESCRIPTOR_HPP_
 
 #include <algorithm>
+#include <cstddef>
 #include <functional>
 #include <limits>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <regex>
 #include <set>
 #include <string>
@@ -69,12 +71,36 @@ inline auto MakePackDescriptor(StateDescriptor *psd,
                                const std::vector<MetadataFlag> &flags = {},
                                const std::set<PDOpt> &options = {}) {
   static_assert(sizeof...(Ts) > 0, "Must have at least one variable type for type pack");
+  using desc_t = typename SparsePack<Ts...>::Descriptor;
+
+  // Building a descriptor walks all fields of psd (and matches regexes), which is too
+  // expensive to do in every task body. Since the variables are fixed by the list of
+  // types, descriptors are cached per instantiation and only distinguished by the
+  // runtime arguments. There are only ever a handful of those, so a linear search with
+  // exact comparisons suffices.
+  struct CacheEntry {
+    std::size_t psd_serial;
+    int psd_size;
+    std::vector<MetadataFlag> flags;
+    std::set<PDOpt> options;
+    desc_t desc;
+  };
+  static std::mutex cache_mutex;
+  static std::vector<CacheEntry> cache;
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  for (const auto &entry : cache) {
+    if (entry.psd_serial == psd->GetSerialNumber() && entry.psd_size == psd->size() &&
+        entry.flags == flags && entry.options == options)
+      return entry.desc;
+  }
 
   std::vector<std::string> vars{Ts::name()...};
   std::vector<bool> use_regex{Ts::regex()...};
 
-  return typename SparsePack<Ts...>::Descriptor(static_cast<impl::PackDescriptor>(
+  desc_t desc(static_cast<impl::PackDescriptor>(
       MakePackDescriptor(psd, vars, use_regex, flags, options)));
+  cache.push_back({psd->GetSerialNumber(), psd->size(), flags, options, desc});
+  return desc;
 }
 
 inline auto MakePackDescriptor(StateDescriptor *psd, const std::vector<std::string> &vars,
@@ -107,6 +133,15 @@ inline auto MakePackDescriptor(SparsePack<Ts...> pack, StateDescriptor *psd,
   return parthenon::MakePackDescriptor<Ts...>(psd, flags, options);
 }
 
+// Descriptor of a FixedSparsePack, which requires every variable of the types to be
+// allocated on all blocks of the packs made from it
+template <class... Ts, class T>
+inline auto MakeFixedPackDescriptor(T *pmd, const std::vector<MetadataFlag> &flags = {},
+                                    const std::set<PDOpt> &options = {}) {
+  return typename FixedSparsePack<Ts...>::Descriptor(
+      MakePackDescriptor<Ts...>(pmd, flags, options));
+}
+
 inline auto MakePackDescriptor(
     StateDescriptor *psd, const std::vector<std::pair<std::string, bool>> &var_regexes,
     const std::vector<MetadataFlag> &flags = {}, const std::set<PDOpt> &options = {}) {
@@ -12,7 +12,15 @@
 //========================================================================================
 #include "mesh_data.hpp"
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #include "mesh/mesh.hpp"
+#include "utils/hash.hpp"
 
 namespace parthenon {
 
@@ -30,6 +38,188 @@ void MeshData<T>::Initialize(BlockList_t blocks, Mesh *pmesh,
   } else {
     grid = GridIdentifier::leaf();
   }
+  exec_space = DevExecSpace();
+  block_metadata_valid_ = false;
+}
+
+template <typename T>
+const BlockMetadata &MeshData<T>::GetBlockMetadata() {
+  const std::size_t generation =
+      pmy_mesh_ == nullptr ? 0 : pmy_mesh_->GetBlockListGeneration();
+  if (block_metadata_valid_ && block_metadata_generation_ == generation)
+    return block_metadata_;
+
+  const int nblocks = NumBlocks();
+  std::unordered_map<int, int> index_of_gid;
+  int nneighbors = 0;
+  for (int b = 0; b < nblocks; ++b) {
+    auto pmb = GetBlockData(b)->GetBlockPointer();
+    index_of_gid[pmb->gid] = b;
+    nneighbors += GetNeighbors_(pmb).size();
+  }
+
+  BlockMetadata &bm = block_metadata_;
+  bm.nblocks = nblocks;
+  bm.nneighbors = nneighbors;
+  bm.gid = ParArray1D<int>("BlockMetadata::gid", nblocks);
+  bm.level = ParArray1D<int>("BlockMetadata::level", nblocks);
+  bm.lx = ParArray2D<std::int64_t>("BlockMetadata::lx", nblocks, 3);
+  bm.bcs = ParArray2D<int>("BlockMetadata::bcs", nblocks, BOUNDARY_NFACES);
+  bm.coords = ParArray1D<ParArray0D<Coordinates_t>>("BlockMetadata::coords", nblocks);
+  bm.geometry.dx = ParArray2D<Real>("BlockMetadata::dx", nblocks, 3);
+  bm.geometry.xmin = ParArray2D<Real>("BlockMetadata::xmin", nblocks, 3);
+  bm.geometry.level = bm.level;
+  if (nblocks > 0) {
+    bm.geometry.cellbounds = GetBlockData(0)->GetBlockPointer()->cellbounds;
+  }
+  bm.neighbor_start = ParArray1D<int>("BlockMetadata::neighbor_start", nblocks + 1);
+  bm.neighbor_gid = ParArray1D<int>("BlockMetadata::neighbor_gid", nneighbors);
+  bm.neighbor_rank = ParArray1D<int>("BlockMetadata::neighbor_rank", nneighbors);
+  bm.neighbor_level = ParArray1D<int>("BlockMetadata::neighbor_level", nneighbors);
+  bm.neighbor_index = ParArray1D<int>("BlockMetadata::neighbor_index", nneighbors);
+  bm.neighbor_offsets =
+      ParArray2D<int>("BlockMetadata::neighbor_offsets", nneighbors, 3);
+
+  auto gid_h = bm.gid.GetHostMirror();
+  auto level_h = bm.level.GetHostMirror();
+  auto lx_h = bm.lx.GetHostMirror();
+  auto bcs_h = bm.bcs.GetHostMirror();
+  auto coords_h = Kokkos::create_mirror_view(bm.coords);
+  auto dx_h = bm.geometry.dx.GetHostMirror();
+  auto xmin_h = bm.geometry.xmin.GetHostMirror();
+  auto start_h = bm.neighbor_start.GetHostMirror();
+  auto ngid_h = bm.neighbor_gid.GetHostMirror();
+  auto nrank_h = bm.neighbor_rank.GetHostMirror();
+  auto nlevel_h = bm.neighbor_level.GetHostMirror();
+  auto nindex_h = bm.neighbor_index.GetHostMirror();
+  auto noffsets_h = bm.neighbor_offsets.GetHostMirror();
+
+  int n = 0;
+  for (int b = 0; b < nblocks; ++b) {
+    auto pmb = GetBlockData(b)->GetBlockPointer();
+    gid_h(b) = pmb->gid;
+    level_h(b) = pmb->loc.level();
+    lx_h(b, 0) = pmb->loc.lx1();
+    lx_h(b, 1) = pmb->loc.lx2();
+    lx_h(b, 2) = pmb->loc.lx3();
+    for (int f = 0; f < BOUNDARY_NFACES; ++f)
+      bcs_h(b, f) = static_cast<int>(pmb->boundary_flag[f]);
+    coords_h(b) = pmb->coords_device;
+    for (int dir = 0; dir < 3; ++dir) {
+      dx_h(b, dir) = pmb->coords.DxcFA(dir + 1);
+      xmin_h(b, dir) = pmb->coords.GetXmin()[dir];
+    }
+    start_h(b) = n;
+    for (const auto &nb : GetNeighbors_(pmb)) {
+      ngid_h(n) = nb.gid;
+      nrank_h(n) = nb.rank;
+      nlevel_h(n) = nb.loc.level();
+      auto it = index_of_gid.find(nb.gid);
+      nindex_h(n) = (it == index_of_gid.end()) ? -1 : it->second;
+      for (int dir = 0; dir < 3; ++dir)
+        noffsets_h(n, dir) = static_cast<int>(nb.offsets[dir]);
+      ++n;
+    }
+  }
+  start_h(nblocks) = n;
+
+  bm.gid.DeepCopy(gid_h);
+  bm.level.DeepCopy(level_h);
+  bm.lx.DeepCopy(lx_h);
+  bm.bcs.DeepCopy(bcs_h);
+  Kokkos::deep_copy(bm.coords, coords_h);
+  bm.geometry.dx.DeepCopy(dx_h);
+  bm.geometry.xmin.DeepCopy(xmin_h);
+  bm.neighbor_start.DeepCopy(start_h);
+  bm.neighbor_gid.DeepCopy(ngid_h);
+  bm.neighbor_rank.DeepCopy(nrank_h);
+  bm.neighbor_level.DeepCopy(nlevel_h);
+  bm.neighbor_index.DeepCopy(nindex_h);
+  bm.neighbor_offsets.DeepCopy(noffsets_h);
+
+  block_metadata_valid_ = true;
+  block_metadata_generation_ = generation;
+  return block_metadata_;
+}
+
+// The neighbors that boundary communication on the grid of this MeshData uses
+template <typename T>
+void MeshData<T>::BuildContiguousStorage() {
+  contiguous_storage_.clear();
+  const int nblocks = NumBlocks();
+  if (nblocks == 0) return;
+  for (const auto &v : block_data_[0]->GetVariableVector()) {
+    if (v->IsSparse() || !v->IsAllocated()) continue;
+    if (v->IsSet(Metadata::Flux) && pmy_mesh_->flux_arenas.Enabled()) continue;
+    const auto &label = v->label();
+    std::vector<std::shared_ptr<Variable<T>>> vars;
+    for (int b = 0; b < nblocks; ++b) {
+      if (!block_data_[b]->HasVariable(label)) break;
+      auto var = block_data_[b]->GetVarPtr(label);
+      if (!var->IsAllocated() || var->data.size() != v->data.size()) break;
+      vars.push_back(var);
+    }
+    if (static_cast<int>(vars.size()) != nblocks) continue;
+
+    // The storage is initialized (i.e. first touched) on the execution space instance of
+    // the partition, which places it on the NUMA domain of the instance on the host
+    const auto &view = v->data.KokkosView();
+    contiguous_storage_t storage(typename contiguous_storage_t::base_t(
+        Kokkos::view_alloc(exec_space, label + ".contiguous"), nblocks, view.extent(0),
+        view.extent(1), view.extent(2), view.extent(3), view.extent(4), view.extent(5),
+        view.extent(6)));
+    exec_space.fence();
+    const auto &kv = storage.KokkosView();
+    const auto all = Kokkos::ALL();
+    for (int b = 0; b < nblocks; ++b) {
+      vars[b]->RelocateData(Kokkos::subview(kv, b, all, all, all, all, all, all, all));
+    }
+    contiguous_storage_[label] = storage;
+  }
+}
+
+template <typename T>
+void MeshData<T>::AcquireFluxes() {
+  auto &arenas = pmy_mesh_->flux_arenas;
+  if (!arenas.Enabled() || flux_arena_.size() > 0) return;
+  std::vector<Variable<T> *> fluxes;
+  std::size_t size = 0;
+  for (const auto &pmbd : block_data_) {
+    for (const auto &v : pmbd->GetVariableVector()) {
+      if (!v->IsSet(Metadata::Flux) || v->IsSparse() || !v->IsAllocated()) continue;
+      fluxes.push_back(v.get());
+      size += v->data.size();
+    }
+  }
+  if (size == 0) return;
+  flux_arena_ = arenas.Get(size, last_flux_arena_);
+  // Only variables that are not already at their place in the arena are moved, so the
+  // caches stay valid as long as the partition gets the same arena
+  std::size_t offset = 0;
+  for (auto *v : fluxes) {
+    T *ptr = flux_arena_.data() + offset;
+    if (v->data.data() != ptr) v->UseTransientStorage(ptr);
+    offset += v->data.size();
+  }
+}
+
+template <typename T>
+void MeshData<T>::ReleaseFluxes() {
+  if (flux_arena_.size() == 0) return;
+  // The next partition using the arena may run on another execution space instance
+  if (pmy_mesh_->NumExecSpaceInstances() > 1) exec_space.fence();
+  last_flux_arena_ = flux_arena_.data();
+  pmy_mesh_->flux_arenas.Release(flux_arena_);
+  flux_arena_ = FluxArenas::storage_t();
+}
+
+template <typename T>
+const std::vector<NeighborBlock> &MeshData<T>::GetNeighbors_(const MeshBlock *pmb) const {
+  if (grid.type == GridType::two_level_composite) {
+    return pmb->loc.level() == grid.logical_level ? pmb->gmg_same_neighbors
+                                                  : pmb->gmg_composite_finer_neighbors;
+  }
+  return pmb->neighbors;
 }
 
 // This method is basically here to get around the forward
@@ -40,6 +230,20 @@ void MeshData<T>::SetMeshProperties(Mesh *pmesh) {
   ndim_ = pmesh == nullptr ? 0 : pmesh->ndim;
 }
 
+template <typename T>
+bool MeshData<T>::DeviceGraphsEnabled() const {
+  return pmy_mesh_ != nullptr && pmy_mesh_->do_device_graphs;
+}
+
+template <typename T>
+std::size_t MeshData<T>::DeviceGraphKey(const std::size_t key) const {
+  // Graphs hold the addresses of the data, which change e.g. with transient fluxes
+  return impl::hash_combine(
+      impl::hash_combine(pmy_mesh_->GetBlockListGeneration(),
+                         Variable<Real>::GetAllocationGeneration()),
+      key);
+}
+
 template class MeshData<Real>;
 
 } // namespace parthenon
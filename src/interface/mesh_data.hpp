@@ -14,6 +14,7 @@
 #define INTERFACE_MESH_DATA_HPP_
 
 #include <algorithm>
+#include <cstddef>
 #include <limits>
 #include <map>
 #include <memory>
@@ -23,6 +24,8 @@
 #include <vector>
 
 #include "bvals/comms/bnd_info.hpp"
+#include "interface/block_metadata.hpp"
+#include "interface/flux_arenas.hpp"
 #include "interface/sparse_pack_base.hpp"
 #include "interface/swarm_pack_base.hpp"
 #include "interface/variable_pack.hpp"
@@ -30,6 +33,7 @@
 #include "mesh/meshblock.hpp"
 #include "mesh/meshblock_pack.hpp"
 #include "utils/communication_buffer.hpp"
+#include "utils/device_graph.hpp"
 #include "utils/error_checking.hpp"
 #include "utils/object_pool.hpp"
 #include "utils/unique_id.hpp"
@@ -196,6 +200,9 @@ class MeshData {
 
   GridIdentifier grid;
   int partition;
+  // Execution space instance of the block partition. Kernels of different partitions
+  // launched on their own instances can run concurrently on the device.
+  DevExecSpace exec_space;
 
   const auto &StageName() const { return stage_name_; }
 
@@ -236,6 +243,20 @@ class MeshData {
     return IndexRange{-1, -2};
   }
 
+  template <class... Ts>
+  IndexRegion GetCoreRegion(Ts &&...args) const {
+    if (block_data_.size() > 0)
+      return block_data_[0]->GetCoreRegion(std::forward<Ts>(args)...);
+    return IndexRegion{{-1, -2}, {-1, -2}, {-1, -2}};
+  }
+
+  template <class... Ts>
+  std::vector<IndexRegion> GetRimRegions(Ts &&...args) const {
+    if (block_data_.size() > 0)
+      return block_data_[0]->GetRimRegions(std::forward<Ts>(args)...);
+    return {};
+  }
+
   template <class... Args>
   void Add(Args &&...args) {
     for (const auto &pbd : block_data_) {
@@ -256,6 +277,8 @@ class MeshData {
       block_data_[i] = bl[i]->meshblock_data.Add(stage_name_, bl[i], vars);
     grid = part->grid;
     partition = part->partition;
+    exec_space = part->exec_space;
+    block_metadata_valid_ = false;
   }
 
   template <typename ID_t>
@@ -274,6 +297,27 @@ class MeshData {
     }
     grid = src->grid;
     partition = src->partition;
+    exec_space = src->exec_space;
+    block_metadata_valid_ = false;
+  }
+
+  // See MeshBlockData::InitializeSharing
+  void InitializeSharing(
+      std::shared_ptr<MeshData<T>> src,
+      const std::vector<MetadataFlag> &private_flags = {Metadata::Independent}) {
+    PARTHENON_REQUIRE_THROWS(src != nullptr, "src points at null");
+    SetMeshProperties(src->GetParentPointer());
+    const int nblocks = src->NumBlocks();
+    block_data_.resize(nblocks);
+    for (int i = 0; i < nblocks; ++i) {
+      auto pmbd = src->GetBlockData(i);
+      block_data_[i] = pmbd->GetBlockSharedPointer()->meshblock_data.AddSharing(
+          stage_name_, pmbd, private_flags);
+    }
+    grid = src->grid;
+    partition = src->partition;
+    exec_space = src->exec_space;
+    block_metadata_valid_ = false;
   }
 
   void Initialize(BlockList_t blocks, Mesh *pmesh, std::optional<int> gmg_level = {});
@@ -319,6 +363,22 @@ class MeshData {
     return status;
   }
 
+  // Launch the kernels enqueued by f on exec_space. If device graphs are enabled in the
+  // mesh, the kernels are captured into a graph (one per label) on the first call and
+  // the graph is replayed on later calls until the block list changes or a different
+  // key is passed, e.g., a counter of sparse allocation changes. See DeviceGraph for
+  // the restrictions on f.
+  template <typename F>
+  void LaunchDeviceGraph(const std::string &label, F &&f, const std::size_t key = 0) {
+    if (!DeviceGraphsEnabled()) {
+      f();
+      return;
+    }
+    auto &graph = device_graphs_[label];
+    if (graph == nullptr) graph = std::make_shared<DeviceGraph>();
+    graph->Launch(exec_space, DeviceGraphKey(key), std::forward<F>(f));
+  }
+
  private:
   template <typename... Args>
   const auto &PackVariablesAndFluxesImpl(PackIndexMap *map_out, Args &&...args) {
@@ -494,6 +554,32 @@ class MeshData {
     PARTHENON_THROW("SwarmPacks only compatible with int and Real types");
   }
 
+  // Device copy of the block and neighbor information of the blocks in this MeshData,
+  // built on first use and rebuilt after the block list of the mesh changed
+  const BlockMetadata &GetBlockMetadata();
+
+  // Mesh-level storage of a variable, with the block index of this MeshData as the
+  // slowest index followed by the (reversed) dimensions of the variable
+  using contiguous_storage_t = ParArray8D<T>;
+  // Move the data of every dense, allocated variable that all blocks share into one
+  // allocation per variable. Packs and per-block accesses keep working on subviews.
+  void BuildContiguousStorage();
+  // Empty if the variable does not have contiguous storage in this MeshData
+  contiguous_storage_t GetContiguousStorage(const std::string &label) const {
+    auto it = contiguous_storage_.find(label);
+    return it == contiguous_storage_.end() ? contiguous_storage_t() : it->second;
+  }
+
+  // With <parthenon/mesh> transient_fluxes, the dense flux variables of the blocks only
+  // have storage between AcquireFluxes and ReleaseFluxes, which is taken from an arena
+  // of the mesh that is shared with the other partitions. Fluxes are not preserved in
+  // between, so they have to be acquired before they are computed and released after
+  // the last use, usually the flux correction and the flux divergence, of a stage. Both
+  // do nothing if transient fluxes are disabled or the fluxes are already acquired or
+  // released.
+  void AcquireFluxes();
+  void ReleaseFluxes();
+
   void ClearSwarmCaches() {
     if (swarm_pack_real_cache_.size() > 0) swarm_pack_real_cache_.clear();
     if (swarm_pack_int_cache_.size() > 0) swarm_pack_int_cache_.clear();
@@ -501,6 +587,9 @@ class MeshData {
 
  private:
   void SetMeshProperties(Mesh *pmesh);
+  bool DeviceGraphsEnabled() const;
+  std::size_t DeviceGraphKey(const std::size_t key) const;
+  const std::vector<NeighborBlock> &GetNeighbors_(const MeshBlock *pmb) const;
 
   int ndim_;
   Mesh *pmy_mesh_;
@@ -515,6 +604,17 @@ class MeshData {
   SwarmPackCache<Real> swarm_pack_real_cache_;
   // caches for boundary information
   BvarsCache_t bvars_cache_;
+  // captured kernel sequences
+  std::map<std::string, std::shared_ptr<DeviceGraph>> device_graphs_;
+  // device block and neighbor information
+  BlockMetadata block_metadata_;
+  bool block_metadata_valid_ = false;
+  std::size_t block_metadata_generation_ = 0;
+  // contiguous storage of variables by label
+  std::map<std::string, contiguous_storage_t> contiguous_storage_;
+  // storage of the fluxes while they are acquired and where it started the last time
+  FluxArenas::storage_t flux_arena_;
+  const Real *last_flux_arena_ = nullptr;
 };
 
 template <typename T, typename... Args>
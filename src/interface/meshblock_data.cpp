@@ -14,6 +14,7 @@
 #include "interface/meshblock_data.hpp"
 
 #include <algorithm>
+#include <cstdint>
 #include <cstdlib>
 #include <memory>
 #include <set>
@@ -29,6 +30,7 @@
 #include "interface/variable_pack.hpp"
 #include "mesh/mesh.hpp"
 #include "mesh/meshblock.hpp"
+#include "utils/bit_hacks.hpp"
 #include "utils/error_checking.hpp"
 #include "utils/utils.hpp"
 
@@ -43,7 +45,11 @@ namespace parthenon {
 template <typename T>
 void MeshBlockData<T>::AddField(const std::string &base_name, const Metadata &metadata,
                                 int sparse_id) {
-  auto pvar = std::make_shared<Variable<T>>(base_name, metadata, sparse_id, pmy_block);
+  AddField(std::make_shared<Variable<T>>(base_name, metadata, sparse_id, pmy_block));
+}
+
+template <typename T>
+void MeshBlockData<T>::AddField(std::shared_ptr<Variable<T>> pvar) {
   Add(pvar);
 
   if (!Globals::sparse_config.enabled || !pvar->IsSparse()) {
@@ -262,18 +268,34 @@ MeshBlockData<T>::GetVariablesByName(const std::vector<std::string> &names,
   return var_list;
 }
 
+template <typename T>
+const typename MeshBlockData<T>::FlagIndex &MeshBlockData<T>::GetFlagIndex() {
+  if (flag_index_.valid) return flag_index_;
+  auto &vars = flag_index_.vars;
+  vars = varVector_;
+  std::sort(vars.begin(), vars.end(), VarComp<Variable<T>>());
+  const std::size_t nwords = (vars.size() + 63) / 64;
+  auto &bits = flag_index_.bits;
+  bits.clear();
+  for (std::size_t d = 0; d < vars.size(); ++d) {
+    for (const auto &flag : vars[d]->metadata().Flags()) {
+      if (flag.Index() >= bits.size()) bits.resize(flag.Index() + 1);
+      bits[flag.Index()].resize(nwords, 0);
+      bits[flag.Index()][d / 64] |= std::uint64_t(1) << (d % 64);
+    }
+  }
+  flag_index_.valid = true;
+  return flag_index_;
+}
+
 // From a given container, extract all variables (and UIDs) whose
 // Metadata matchs the all of the given flags (if the list of flags is
 // empty, extract all variables), optionally only extracting sparse
 // fields with an index from the given list of sparse indices
 //
-// JMM: This algorithm uses the map from metadata flags to variables
-// to accelerate performance.
-//
-// The cost of this loop scales as O(Nflags * Nvars/flag) In worst
-// case, this is linear in number of variables. However, on average,
-// the number of vars with a desired flag will be much smaller than
-// all vars. So average performance is much better than linear.
+// The variables are matched 64 at a time with the bitsets of the flags of the
+// FlagIndex, so the cost is linear in the number of flags times the number of
+// variables divided by 64, plus the number of matching variables.
 template <typename T>
 typename MeshBlockData<T>::VarList
 MeshBlockData<T>::GetVariablesByFlag(const Metadata::FlagCollection &flags,
@@ -284,7 +306,44 @@ MeshBlockData<T>::GetVariablesByFlag(const Metadata::FlagCollection &flags,
   typename MeshBlockData<T>::VarList var_list;
   std::unordered_set<int> sparse_ids_set(sparse_ids.begin(), sparse_ids.end());
 
-  auto vars = MetadataUtils::GetByFlag<VariableSet<T>>(flags, varMap_, flagsToVars_);
+  const auto &index = GetFlagIndex();
+  const auto &intersections = flags.GetIntersections();
+  const auto &unions = flags.GetUnions();
+  const auto &exclusions = flags.GetExclusions();
+  const std::size_t nvars = index.vars.size();
+  const std::size_t nwords = (nvars + 63) / 64;
+  auto word = [&](const MetadataFlag &flag, const std::size_t w) -> std::uint64_t {
+    const auto f = static_cast<std::size_t>(flag.Index());
+    return f < index.bits.size() && !index.bits[f].empty() ? index.bits[f][w] : 0;
+  };
+  std::vector<std::uint64_t> matches(nwords, 0);
+  int nmatches = 0;
+  // Without intersections or unions nothing matches unless there are no flags at all
+  if (flags.Empty() || !intersections.empty() || !unions.empty()) {
+    for (std::size_t w = 0; w < nwords; ++w) {
+      std::uint64_t m = w + 1 < nwords || nvars % 64 == 0
+                            ? ~std::uint64_t(0)
+                            : (std::uint64_t(1) << (nvars % 64)) - 1;
+      for (const auto &f : intersections)
+        m &= word(f, w);
+      if (!unions.empty()) {
+        std::uint64_t u = 0;
+        for (const auto &f : unions)
+          u |= word(f, w);
+        m &= u;
+      }
+      for (const auto &f : exclusions)
+        m &= ~word(f, w);
+      matches[w] = m;
+      nmatches += NumberOfSetBits(m);
+    }
+  }
+  VariableVector<T> vars;
+  vars.reserve(nmatches);
+  for (std::size_t w = 0; w < nwords; ++w) {
+    for (std::uint64_t m = matches[w]; m; m &= m - 1)
+      vars.push_back(index.vars[w * 64 + NumberOfBinaryTrailingZeros(m)]);
+  }
 
   for (auto &v : vars) {
     const auto &m = v->metadata();
@@ -14,6 +14,7 @@
 #define INTERFACE_MESHBLOCK_DATA_HPP_
 
 #include <algorithm>
+#include <cstdint>
 #include <limits>
 #include <map>
 #include <memory>
@@ -89,6 +90,14 @@ class MeshBlockData {
   IndexRange GetBoundsK(Ts &&...args) const {
     return GetBlockPointer()->cellbounds.GetBoundsK(std::forward<Ts>(args)...);
   }
+  template <class... Ts>
+  IndexRegion GetCoreRegion(Ts &&...args) const {
+    return GetBlockPointer()->cellbounds.GetCoreRegion(std::forward<Ts>(args)...);
+  }
+  template <class... Ts>
+  std::vector<IndexRegion> GetRimRegions(Ts &&...args) const {
+    return GetBlockPointer()->cellbounds.GetRimRegions(std::forward<Ts>(args)...);
+  }
 
   template <class... Ts>
   IndexRange GetBoundsI(CellLevel cl, Ts &&...args) const {
@@ -138,14 +147,7 @@ class MeshBlockData {
     resolved_packages = resolved_packages_in;
     is_shallow_ = shallow_copy;
 
-    // clear all variables, maps, and pack caches
-    varVector_.clear();
-    varMap_.clear();
-    varUidMap_.clear();
-    flagsToVars_.clear();
-    varPackMap_.clear();
-    coarseVarPackMap_.clear();
-    varFluxPackMap_.clear();
+    ClearVariables();
 
     [[maybe_unused]] auto add_var = [=](auto var) {
       if (shallow_copy || var->IsSet(Metadata::OneCopy)) {
@@ -162,8 +164,10 @@ class MeshBlockData {
           add_var(v);
         }
       } else if constexpr (std::is_same_v<SRC_t, MeshBlock>) {
-        for (auto const &q : resolved_packages->AllFields()) {
-          AddField(q.first.base_name, q.second, q.first.sparse_id);
+        const auto &prototypes = resolved_packages->FieldPrototypes(src);
+        varVector_.reserve(prototypes.size());
+        for (const auto &v : prototypes) {
+          AddField(v->Stamp());
         }
       }
     } else {
@@ -223,17 +227,19 @@ class MeshBlockData {
     return varMap_.at(label);
   }
   std::shared_ptr<Variable<T>> GetVarPtr(const Uid_t &uid) const {
-    PARTHENON_REQUIRE_THROWS(varUidMap_.count(uid),
+    PARTHENON_REQUIRE_THROWS(Contains(uid),
                              "Variable ID " + std::to_string(uid) + " not found!");
-    return varUidMap_.at(uid);
+    return varUidTable_[uid];
+  }
+  // The variable with the unique id uid or null if this container doesn't have it
+  Variable<T> *FindVarPtr(const Uid_t &uid) const noexcept {
+    return uid < varUidTable_.size() ? varUidTable_[uid].get() : nullptr;
   }
-
-  const auto &GetUidMap() const { return varUidMap_; }
 
   Variable<T> &Get(const std::string &base_name, int sparse_id = InvalidSparseID) const {
     return *GetVarPtr(MakeVarLabel(base_name, sparse_id));
   }
-  Variable<T> &Get(const Uid_t &uid) const { return *(varUidMap_.at(uid)); }
+  Variable<T> &Get(const Uid_t &uid) const { return *GetVarPtr(uid); }
 
   Uid_t UniqueID(const std::string &label) noexcept {
     auto it = varMap_.find(label);
@@ -521,7 +527,7 @@ class MeshBlockData {
   }
 
   bool Contains(const std::string &name) const noexcept { return varMap_.count(name); }
-  bool Contains(const Uid_t &uid) const noexcept { return varUidMap_.count(uid); }
+  bool Contains(const Uid_t &uid) const noexcept { return FindVarPtr(uid) != nullptr; }
   template <typename ID_t>
   bool Contains(const std::vector<ID_t> &vars) const noexcept {
     return std::all_of(vars.begin(), vars.end(),
@@ -549,22 +555,75 @@ class MeshBlockData {
 
   bool IsShallow() const { return is_shallow_; }
 
+  /// Create a copy of src that only allocates new storage for the variables with at
+  /// least one of private_flags (and for their fluxes), all other variables share the
+  /// storage of src. As for Initialize, the data of src is not deep copied.
+  void InitializeSharing(
+      const std::shared_ptr<MeshBlockData<T>> src,
+      const std::vector<MetadataFlag> &private_flags = {Metadata::Independent}) {
+    PARTHENON_DEBUG_REQUIRE(src != nullptr, "Source data must be non-null.");
+    SetBlockPointer(src);
+    resolved_packages = src->resolved_packages;
+    is_shallow_ = false;
+    ClearVariables();
+
+    auto is_private = [&](const auto &var) {
+      return !var->IsSet(Metadata::OneCopy) &&
+             var->metadata().AnyFlagsSet(private_flags);
+    };
+    std::set<std::string> private_fluxes;
+    for (const auto &v : src->GetVariableVector()) {
+      if (is_private(v) && v->IsSet(Metadata::WithFluxes))
+        private_fluxes.insert(v->metadata().GetFluxName());
+    }
+    for (const auto &v : src->GetVariableVector()) {
+      if (is_private(v) ||
+          (!v->IsSet(Metadata::OneCopy) && private_fluxes.count(v->label()))) {
+        Add(v->AllocateCopy(pmy_block));
+      } else {
+        Add(v);
+      }
+    }
+  }
+
  private:
+  // clear all variables, maps, and pack caches
+  void ClearVariables() {
+    varVector_.clear();
+    varMap_.clear();
+    varUidTable_.clear();
+    flag_index_ = FlagIndex();
+    varPackMap_.clear();
+    coarseVarPackMap_.clear();
+    varFluxPackMap_.clear();
+  }
+
   void AddField(const std::string &base_name, const Metadata &metadata,
                 int sparse_id = InvalidSparseID);
+  // Adds a new variable without data, allocating it unless it is sparse
+  void AddField(std::shared_ptr<Variable<T>> pvar);
 
   void Add(std::shared_ptr<Variable<T>> var) noexcept {
-    if (varUidMap_.count(var->GetUniqueID())) {
+    const Uid_t uid = var->GetUniqueID();
+    if (Contains(uid)) {
       PARTHENON_THROW("Tried to add variable " + var->label() + " twice!");
     }
     varVector_.push_back(var);
     varMap_[var->label()] = var;
-    varUidMap_[var->GetUniqueID()] = var;
-    for (const auto &flag : var->metadata().Flags()) {
-      flagsToVars_[flag].insert(var);
-    }
+    if (uid >= varUidTable_.size()) varUidTable_.resize(uid + 1);
+    varUidTable_[uid] = var;
+    flag_index_.valid = false;
   }
 
+  // Dense indices of the variables in the order of their unique ids, with one bitset
+  // over these indices per metadata flag
+  struct FlagIndex {
+    VariableVector<T> vars;
+    std::vector<std::vector<std::uint64_t>> bits; // by MetadataFlag::Index()
+    bool valid = false;
+  };
+  const FlagIndex &GetFlagIndex();
+
   std::shared_ptr<Variable<T>> AllocateSparse(std::string const &label,
                                               bool flag_uninitialized = false) {
     if (!HasVariable(label)) {
@@ -608,10 +667,12 @@ class MeshBlockData {
   const std::string stage_name_;
 
   VariableVector<T> varVector_; ///< the saved variable array
-  std::map<Uid_t, std::shared_ptr<Variable<T>>> varUidMap_;
+  // indexed by the unique ids of the variables, which are small consecutive integers
+  std::vector<std::shared_ptr<Variable<T>>> varUidTable_;
 
   MapToVars<T> varMap_;
-  MetadataFlagToVariableMap<T> flagsToVars_;
+  // built on the first flag query after variables were added
+  FlagIndex flag_index_;
 
   // variable packing
   MapToVariablePack<T> varPackMap_;
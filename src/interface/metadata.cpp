@@ -124,6 +124,10 @@ Metadata::Metadata(const std::vector<MetadataFlag> &bits, const std::vector<int>
   if (CountSet({Independent, Derived}) == 0) {
     DoBit(Derived, true);
   }
+  // Values that are only kept to single precision in files are also communicated as such
+  if (IsSet(ReducedPrecision)) {
+    DoBit(SinglePrecisionComms, true);
+  }
   // If variable is refined, set a default prolongation/restriction op
   // TODO(JMM): This is dangerous. See Issue #844.
   if (HasRefinementOps()) {
@@ -120,6 +120,14 @@
   PARTHENON_INTERNAL_FOR_FLAG(Fine)                                                      \
   /** this variable is the flux for another variable **/                                 \
   PARTHENON_INTERNAL_FOR_FLAG(Flux)                                                      \
+  /** boundary buffers of this variable hold single precision values **/                 \
+  PARTHENON_INTERNAL_FOR_FLAG(SinglePrecisionComms)                                      \
+  /** boundary buffers of this variable hold half precision values **/                   \
+  PARTHENON_INTERNAL_FOR_FLAG(HalfPrecisionComms)                                        \
+  /** variable tolerates single precision in communication and files **/                \
+  PARTHENON_INTERNAL_FOR_FLAG(ReducedPrecision)                                          \
+  /** integer swarm variable of unique particle ids with an index for lookups **/        \
+  PARTHENON_INTERNAL_FOR_FLAG(ParticleId)                                                \
   /************************************************/                                     \
   /** Vars specifying coordinates for visualization purposes **/                         \
   /** You can specify a single 3D var **/                                                \
@@ -170,6 +178,9 @@ class MetadataFlag {
 
   std::string const &Name() const;
 
+  // Flags are numbered consecutively from zero, e.g. to index tables over all flags
+  constexpr int Index() const { return flag_; }
+
 #ifdef CATCH_VERSION_MAJOR
   // Should never be used for application code - only exposed for testing.
   constexpr int InternalFlagValue() const { return flag_; }
@@ -383,6 +394,28 @@ class Metadata {
   parthenon::Real GetAllocationThreshold() const { return allocation_threshold_; }
   parthenon::Real GetDefaultValue() const { return default_value_; }
 
+  // Ghost exchange routines. A depth of zero (the default) exchanges all Globals::nghost
+  // layers, otherwise only depth layers are exchanged between blocks on the same level
+  // (prolongation and restriction at fine-coarse boundaries always need all layers).
+  // An empty list of stages (the default) exchanges ghosts of MeshData of every stage,
+  // otherwise only of MeshData whose stage name is in the list.
+  void SetGhostDepth(int depth) {
+    PARTHENON_REQUIRE_THROWS(depth >= 0, "Ghost depth must be non-negative");
+    ghost_depth_ = depth;
+  }
+  int GetGhostDepth() const { return ghost_depth_; }
+  void SetGhostExchangeStages(const std::vector<std::string> &stages) {
+    ghost_exchange_stages_ = stages;
+  }
+  const std::vector<std::string> &GetGhostExchangeStages() const {
+    return ghost_exchange_stages_;
+  }
+  bool ExchangesGhostsInStage(const std::string &stage) const {
+    return ghost_exchange_stages_.empty() ||
+           std::find(ghost_exchange_stages_.begin(), ghost_exchange_stages_.end(),
+                     stage) != ghost_exchange_stages_.end();
+  }
+
   // Individual flag setters, using these could result in an invalid set of flags, use
   // IsValid to check if the flags are valid
   // TODO(JMM): This is dangerous. See Issue #844.
@@ -598,6 +631,9 @@ class Metadata {
   parthenon::Real deallocation_threshold_;
   parthenon::Real default_value_;
 
+  int ghost_depth_ = 0;
+  std::vector<std::string> ghost_exchange_stages_ = {};
+
   /// if flag is true set bit, clears otherwise
   void DoBit(MetadataFlag bit, bool flag) {
     if (bit.flag_ >= bits_.size()) {
@@ -103,6 +103,10 @@ struct var_base_t {
   static int ndim() { return sizeof...(NCOMP); }
   KOKKOS_INLINE_FUNCTION
   static int size() { return multiply<NCOMP...>::value; }
+  // Types that match a single variable of a shape known at compile time, which can be
+  // used in a FixedSparsePack
+  static constexpr bool fixed_extent = !REGEX && (... && (NCOMP > 0));
+  static constexpr int fixed_size = multiply<NCOMP...>::value;
 
   const int idx;
 
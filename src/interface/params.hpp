@@ -1,5 +1,5 @@
 //========================================================================================
-// (C) (or copyright) 2020-2023. Triad National Security, LLC. All rights reserved.
+// (C) (or copyright) 2020-2024. Triad National Security, LLC. All rights reserved.
 //
 // This program was produced under U.S. Government contract 89233218CNA000001 for Los
 // Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
@@ -13,16 +13,19 @@
 #ifndef INTERFACE_PARAMS_HPP_
 #define INTERFACE_PARAMS_HPP_
 
+#include <functional>
 #include <iostream>
 #include <map>
 #include <memory>
 #include <string>
 #include <typeindex>
+#include <type_traits>
 #include <typeinfo>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "kokkos_abstraction.hpp"
 #include "utils/error_checking.hpp"
 
 #ifdef ENABLE_HDF5
@@ -40,6 +43,29 @@ class Params {
   // runtime, but should be read from the restart file upon restart.
   enum class Mutability : int { Immutable = 0, Mutable = 1, Restart = 2 };
 
+  // Typed reference to a parameter that skips the lookup of Get, for parameters that are
+  // read in hot paths. Obtain it once (e.g. at package initialization) with GetHandle.
+  // It stays valid (and sees new values) across Update, but not across reset.
+  template <typename T>
+  class Handle {
+   public:
+    Handle() = default;
+    const T &operator*() const { return *ptr_; }
+    const T *operator->() const { return ptr_; }
+    const T &Get() const { return *ptr_; }
+    bool IsValid() const { return ptr_ != nullptr; }
+
+   private:
+    friend class Params;
+    explicit Handle(const T *ptr) : ptr_(ptr) {}
+    const T *ptr_ = nullptr;
+  };
+
+  // Device copy of a trivially copyable parameter as a rank 0 view, so that kernels
+  // can read it without capturing the value in every launch
+  template <typename T>
+  using DeviceHandle = Kokkos::View<const T, DevMemSpace>;
+
   Params() {}
 
   // can't copy because we have a map of unique_ptr
@@ -70,13 +96,17 @@ class Params {
                              "Parameter " + key + " must be marked as mutable");
     PARTHENON_REQUIRE_THROWS(myTypes_.at(key) == std::type_index(typeid(T)),
                              "WRONG TYPE FOR KEY '" + key + "'");
-    myParams_[key] = std::unique_ptr<Params::base_t>(new object_t<T>(value));
+    // Assign in place, so that handles to the parameter stay valid
+    *GetTypedPointer_<T>(key)->pValue = value;
+    auto it = device_copies_.find(key);
+    if (it != device_copies_.end()) it->second.sync();
   }
 
   void reset() {
     myParams_.clear();
     myTypes_.clear();
     myMutable_.clear();
+    device_copies_.clear();
   }
 
   template <typename T>
@@ -98,6 +128,29 @@ class Params {
     return typed_ptr->pValue.get();
   }
 
+  template <typename T>
+  Handle<T> GetHandle(const std::string &key) const {
+    return Handle<T>(GetTypedPointer_<T>(key)->pValue.get());
+  }
+
+  // The device copy is created on first use and refreshed by Update. Changes made
+  // through GetMutable are only seen on device after a call to Update.
+  template <typename T>
+  DeviceHandle<T> GetDeviceHandle(const std::string &key) const {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "Only trivially copyable parameters can be mirrored on device");
+    using view_t = Kokkos::View<T, DevMemSpace>;
+    const T *value = GetTypedPointer_<T>(key)->pValue.get();
+    auto it = device_copies_.find(key);
+    if (it == device_copies_.end()) {
+      auto view = std::make_shared<view_t>(key);
+      DeviceCopy copy{view, [view, value]() { Kokkos::deep_copy(*view, *value); }};
+      copy.sync();
+      it = device_copies_.emplace(key, copy).first;
+    }
+    return *std::static_pointer_cast<view_t>(it->second.view);
+  }
+
   bool hasKey(const std::string &key) const {
     return (myParams_.find(key) != myParams_.end());
   }
@@ -215,6 +268,12 @@ class Params {
   std::map<std::string, std::unique_ptr<Params::base_t>> myParams_;
   std::map<std::string, std::type_index> myTypes_;
   std::map<std::string, Mutability> myMutable_;
+  // Device copies of parameters and the functions updating them
+  struct DeviceCopy {
+    std::shared_ptr<void> view;
+    std::function<void()> sync;
+  };
+  mutable std::map<std::string, DeviceCopy> device_copies_;
 };
 
 } // namespace parthenon
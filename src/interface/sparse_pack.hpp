@@ -32,7 +32,9 @@
 #include "interface/pack_utils.hpp"
 #include "interface/sparse_pack_base.hpp"
 #include "interface/variable.hpp"
+#include "kokkos_abstraction.hpp"
 #include "utils/concepts_lite.hpp"
+#include "utils/simd.hpp"
 #include "utils/utils.hpp"
 
 namespace parthenon {
@@ -128,6 +130,19 @@ class SparsePack : public SparsePackBase {
   KOKKOS_INLINE_FUNCTION
   const Coordinates_t &GetCoordinates(const int b = 0) const { return coords_(b)(); }
 
+  // Compact packs (built with PDOpt::Compact) additionally list the allocated variable
+  // components on every block as pairs p of block and index in the pack, see
+  // par_for_compact
+  bool IsCompact() const { return compact_pack_; }
+  KOKKOS_FORCEINLINE_FUNCTION
+  int GetCompactSize() const { return ncompact_; }
+  KOKKOS_FORCEINLINE_FUNCTION
+  int GetCompactBlock(const int p) const { return compact_(0, p); }
+  KOKKOS_FORCEINLINE_FUNCTION
+  int GetCompactIndex(const int p) const { return compact_(1, p); }
+  int GetCompactBlockHost(const int p) const { return compact_h_(0, p); }
+  int GetCompactIndexHost(const int p) const { return compact_h_(1, p); }
+
   // Bound overloads
   KOKKOS_INLINE_FUNCTION int GetLowerBound(const int b) const {
     return (flat_ && (b > 0)) ? (bounds_(1, b - 1, nvar_) + 1) : 0;
@@ -392,6 +407,142 @@ class SparsePack : public SparsePackBase {
                                       VTs... vts) const {
     return std::make_tuple(&(*this)(b, el, vts, k, j, i)...);
   }
+
+  // Explicit SIMD accessors to the simd::width<Real> consecutive values in i starting at
+  // the point given by args, which are the arguments of operator(). Only the first nlanes
+  // are loaded/stored, see InnerLoopPatternSimdVector.
+  template <class... Args>
+  KOKKOS_INLINE_FUNCTION simd::Vector LoadSimd(const int nlanes, Args &&...args) const {
+    return simd::Load(&(*this)(std::forward<Args>(args)...), nlanes);
+  }
+  template <class... Args>
+  KOKKOS_INLINE_FUNCTION void StoreSimd(const simd::Vector &v, const int nlanes,
+                                        Args &&...args) const {
+    simd::Store(v, &(*this)(std::forward<Args>(args)...), nlanes);
+  }
+};
+
+// A SparsePack of types with fixed shapes, in which every variable takes up exactly the
+// components of its type on every block. The offsets of the variables in the pack are
+// then compile time constants, so that the typed accessors compile to a fixed offset
+// instead of loading the bounds of the pack. This excludes sparse variables that can be
+// unallocated on some blocks and flat packs, which is checked on the host when the pack
+// is made.
+template <class... Ts>
+class FixedSparsePack : public SparsePack<Ts...> {
+  static_assert(sizeof...(Ts) > 0 && (... && Ts::fixed_extent),
+                "FixedSparsePack requires non-regex types with fixed shapes");
+  using base_t = SparsePack<Ts...>;
+  using TE = TopologicalElement;
+
+ public:
+  FixedSparsePack() = default;
+
+  explicit FixedSparsePack(const base_t &pack) : base_t(pack) {
+    PARTHENON_REQUIRE_THROWS(!this->flat_, "FixedSparsePack cannot be flattened.");
+    constexpr int offsets[] = {Offset<Ts>()...};
+    constexpr int sizes[] = {Ts::fixed_size...};
+    for (int b = 0; b < this->nblocks_; ++b) {
+      for (int v = 0; v < static_cast<int>(sizeof...(Ts)); ++v) {
+        PARTHENON_REQUIRE_THROWS(this->bounds_h_(0, b, v) == offsets[v] &&
+                                     this->bounds_h_(1, b, v) ==
+                                         offsets[v] + sizes[v] - 1,
+                                 "Variable " + std::to_string(v) + " on block " +
+                                     std::to_string(b) +
+                                     " does not have the fixed extent of its type.");
+      }
+    }
+  }
+
+  class Descriptor : public base_t::Descriptor {
+   public:
+    Descriptor() = default;
+    explicit Descriptor(const typename base_t::Descriptor &desc_in)
+        : base_t::Descriptor(desc_in) {}
+
+    template <class T, class... Args>
+    FixedSparsePack GetPack(T *pmd, Args &&...args) const {
+      return FixedSparsePack(
+          base_t::Descriptor::GetPack(pmd, std::forward<Args>(args)...));
+    }
+  };
+
+  // Offset of the first component of TIn in the pack and number of components of all
+  // variables on every block
+  template <class TIn, REQUIRES(IncludesType<TIn, Ts...>::value)>
+  static constexpr int Offset() {
+    constexpr int sizes[] = {Ts::fixed_size...};
+    int offset = 0;
+    for (std::size_t v = 0; v < GetTypeIdx<TIn, Ts...>::value; ++v)
+      offset += sizes[v];
+    return offset;
+  }
+  static constexpr int FixedSize() { return (... + Ts::fixed_size); }
+
+  using base_t::Contains;
+  using base_t::GetIndex;
+  using base_t::GetLowerBound;
+  using base_t::GetSize;
+  using base_t::GetUpperBound;
+  using base_t::operator();
+  using base_t::flux;
+
+  KOKKOS_INLINE_FUNCTION int GetLowerBound(const int b) const { return 0; }
+  KOKKOS_INLINE_FUNCTION int GetUpperBound(const int b) const { return FixedSize() - 1; }
+
+  template <class TIn, REQUIRES(IncludesType<TIn, Ts...>::value)>
+  KOKKOS_INLINE_FUNCTION int GetLowerBound(const int b, const TIn &) const {
+    return Offset<TIn>();
+  }
+  template <class TIn, REQUIRES(IncludesType<TIn, Ts...>::value)>
+  KOKKOS_INLINE_FUNCTION int GetUpperBound(const int b, const TIn &) const {
+    return Offset<TIn>() + TIn::fixed_size - 1;
+  }
+  template <typename T>
+  KOKKOS_INLINE_FUNCTION int GetSize(const int b, const T &) const {
+    return T::fixed_size;
+  }
+  template <typename TIn, REQUIRES(IncludesType<TIn, Ts...>::value)>
+  KOKKOS_INLINE_FUNCTION int GetIndex(const int b, const TIn &var) const {
+    return Offset<TIn>() + var.idx;
+  }
+  template <typename T>
+  KOKKOS_INLINE_FUNCTION bool Contains(const int b, const T t) const {
+    return true;
+  }
+
+  template <class TIn, REQUIRES(IncludesType<TIn, Ts...>::value)>
+  KOKKOS_INLINE_FUNCTION auto &operator()(const int b, const TE el, const TIn &t) const {
+    return this->pack_(static_cast<int>(el) % 3, b, Offset<TIn>() + t.idx);
+  }
+  template <class TIn, REQUIRES(IncludesType<TIn, Ts...>::value)>
+  KOKKOS_INLINE_FUNCTION auto &operator()(const int b, const TIn &t) const {
+    return this->pack_(0, b, Offset<TIn>() + t.idx);
+  }
+  template <class TIn, REQUIRES(IncludesType<TIn, Ts...>::value)>
+  KOKKOS_INLINE_FUNCTION Real &operator()(const int b, const TIn &t, const int k,
+                                          const int j, const int i) const {
+    return this->pack_(0, b, Offset<TIn>() + t.idx)(k, j, i);
+  }
+  template <class TIn, REQUIRES(IncludesType<TIn, Ts...>::value)>
+  KOKKOS_INLINE_FUNCTION Real &operator()(const int b, const TE el, const TIn &t,
+                                          const int k, const int j, const int i) const {
+    return this->pack_(static_cast<int>(el) % 3, b, Offset<TIn>() + t.idx)(k, j, i);
+  }
+
+  template <class TIn, REQUIRES(IncludesType<TIn, Ts...>::value)>
+  KOKKOS_INLINE_FUNCTION Real &flux(const int b, const int dir, const TIn &t, const int k,
+                                    const int j, const int i) const {
+    PARTHENON_DEBUG_REQUIRE(dir > 0 && dir < 4 && this->with_fluxes_,
+                            "Bad input to flux call");
+    return this->pack_(dir - 1 + this->flx_idx_, b, Offset<TIn>() + t.idx)(k, j, i);
+  }
+
+  template <class... VTs>
+  KOKKOS_INLINE_FUNCTION auto GetPtrs(const int b, const TE el, int k, int j, int i,
+                                      VTs... vts) const {
+    return std::make_tuple(&(*this)(b, el, vts, k, j, i)...);
+  }
 };
 
 template <typename... Vars>
@@ -407,6 +558,22 @@ inline std::ostream &operator<<(std::ostream &os, const SparsePack<Vars...> &sp)
   return os;
 }
 
+// Loop over the cells kb x jb x ib of only the allocated variable components on the
+// blocks of a compact pack, as function(b, n, k, j, i) with n the index in the pack
+template <class... Ts, class Function>
+inline void par_for_compact(const std::string &name, const SparsePack<Ts...> &pack,
+                            const IndexRange &kb, const IndexRange &jb,
+                            const IndexRange &ib, const Function &function) {
+  PARTHENON_REQUIRE(pack.IsCompact(), "par_for_compact requires a PDOpt::Compact pack.");
+  if (pack.GetCompactSize() == 0) return;
+  par_for(
+      DEFAULT_LOOP_PATTERN, name, DevExecSpace(), 0, pack.GetCompactSize() - 1, kb.s,
+      kb.e, jb.s, jb.e, ib.s, ib.e,
+      KOKKOS_LAMBDA(const int p, const int k, const int j, const int i) {
+        function(pack.GetCompactBlock(p), pack.GetCompactIndex(p), k, j, i);
+      });
+}
+
 } // namespace parthenon
 
 #endif // INTERFACE_SPARSE_PACK_HPP_
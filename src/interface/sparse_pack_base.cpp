@@ -71,15 +71,10 @@ SparsePackBase::GetAllocStatus(T *pmd, const PackDescriptor &desc,
 
   std::vector<int> astat;
   ForEachBlock(pmd, include_block, [&](int b, mbd_t *pmbd) {
-    const auto &uid_map = pmbd->GetUidMap();
     for (int i = 0; i < nvar; ++i) {
       for (const auto &[var_name, uid] : desc.var_groups[i]) {
-        if (uid_map.count(uid) > 0) {
-          const auto pv = uid_map.at(uid);
-          astat.push_back(pv->GetAllocationStatus());
-        } else {
-          astat.push_back(-1);
-        }
+        const auto pv = pmbd->FindVarPtr(uid);
+        astat.push_back(pv != nullptr ? pv->GetAllocationStatus() : -1);
       }
     }
   });
@@ -93,6 +88,145 @@ template SparsePackBase::alloc_t
 SparsePackBase::GetAllocStatus<MeshData<Real>>(MeshData<Real> *, const PackDescriptor &,
                                                const std::vector<bool> &);
 
+int SparsePackBase::CountBlock(const PackDescriptor &desc, MeshBlockData<Real> *pmbd,
+                               bool &contains_face_or_edge,
+                               bool &contains_face_with_fluxes) {
+  int size = 0;
+  for (int i = 0; i < desc.nvar_groups; ++i) {
+    for (const auto &[var_name, uid] : desc.var_groups[i]) {
+      if (const auto pv = pmbd->FindVarPtr(uid)) {
+        if (pv->IsAllocated()) {
+          if (pv->IsSet(Metadata::Edge)) contains_face_or_edge = true;
+          if (pv->IsSet(Metadata::Face)) {
+            if (pv->IsSet(Metadata::WithFluxes) && desc.with_fluxes) {
+              contains_face_with_fluxes = true;
+            }
+            contains_face_or_edge = true;
+          }
+          size += pv->GetDim(6) * pv->GetDim(5) * pv->GetDim(4);
+        }
+      }
+    }
+  }
+  return size;
+}
+
+void SparsePackBase::FillBlock(const PackDescriptor &desc, MeshBlockData<Real> *pmbd,
+                               const int blidx, int idx, coords_h_t *coords_h) {
+  const int nvar = desc.nvar_groups;
+  const int b = flat_ ? 0 : blidx;
+  if (!flat_ && coords_h != nullptr) {
+    // JMM: This line could be unified with the coords_h line below,
+    // but it would imply unnecessary copies in the case of non-flat
+    // packs.
+    (*coords_h)(b) = pmbd->GetBlockPointer()->coords_device;
+  }
+
+  for (int i = 0; i < nvar; ++i) {
+    bounds_h_(0, blidx, i) = idx;
+    for (const auto &[var_name, uid] : desc.var_groups[i]) {
+      if (const auto pv = pmbd->FindVarPtr(uid)) {
+        if (pv->IsAllocated()) {
+          Variable<Real> *pvf;
+          if (desc.with_fluxes && pv->IsSet(Metadata::WithFluxes)) {
+            std::string flux_name = pv->metadata().GetFluxName();
+            if (flux_name != "") pvf = &pmbd->Get(flux_name);
+          }
+          for (int t = 0; t < pv->GetDim(6); ++t) {
+            for (int u = 0; u < pv->GetDim(5); ++u) {
+              for (int v = 0; v < pv->GetDim(4); ++v) {
+                if (pv->IsSet(Metadata::Face) || pv->IsSet(Metadata::Edge)) {
+                  if (coarse_) {
+                    pack_h_(0, b, idx) = pv->coarse_s.Get(0, t, u, v);
+                    pack_h_(1, b, idx) = pv->coarse_s.Get(1, t, u, v);
+                    pack_h_(2, b, idx) = pv->coarse_s.Get(2, t, u, v);
+                  } else {
+                    pack_h_(0, b, idx) = pv->data.Get(0, t, u, v);
+                    pack_h_(1, b, idx) = pv->data.Get(1, t, u, v);
+                    pack_h_(2, b, idx) = pv->data.Get(2, t, u, v);
+                  }
+                  if (pv->IsSet(Metadata::Vector)) {
+                    pack_h_(0, b, idx).vector_component = X1DIR;
+                    pack_h_(1, b, idx).vector_component = X2DIR;
+                    pack_h_(2, b, idx).vector_component = X3DIR;
+                  }
+
+                  if (pv->IsSet(Metadata::Face)) {
+                    pack_h_(0, b, idx).topological_element = TopologicalElement::F1;
+                    pack_h_(1, b, idx).topological_element = TopologicalElement::F2;
+                    pack_h_(2, b, idx).topological_element = TopologicalElement::F3;
+                  }
+
+                } else { // This is a cell, node, or a variable that doesn't have
+                         // topology information
+                  if (coarse_) {
+                    pack_h_(0, b, idx) = pv->coarse_s.Get(0, t, u, v);
+                  } else {
+                    pack_h_(0, b, idx) = pv->data.Get(0, t, u, v);
+                  }
+                  if (pv->IsSet(Metadata::Vector))
+                    pack_h_(0, b, idx).vector_component = v + 1;
+                }
+
+                if (desc.with_fluxes && pv->IsSet(Metadata::WithFluxes)) {
+                  pack_h_(0 + flx_idx_, b, idx) = pvf->data.Get(0, t, u, v);
+                  if (!pv->IsSet(Metadata::Edge)) {
+                    pack_h_(1 + flx_idx_, b, idx) = pvf->data.Get(1, t, u, v);
+                    pack_h_(2 + flx_idx_, b, idx) = pvf->data.Get(2, t, u, v);
+                  }
+                }
+
+                for (auto el :
+                     GetTopologicalElements(pack_h_(0, b, idx).topological_type)) {
+                  pack_h_(static_cast<int>(el) % 3, b, idx).topological_element = el;
+                }
+                PARTHENON_REQUIRE(
+                    pack_h_(0, b, idx).size() > 0,
+                    "Seems like this variable might not actually be allocated.");
+
+                if (flat_ && coords_h != nullptr) {
+                  (*coords_h)(idx) = pmbd->GetBlockPointer()->coords_device;
+                }
+                idx++;
+              }
+            }
+          }
+        }
+      }
+    }
+    bounds_h_(1, blidx, i) = idx - 1;
+    if (bounds_h_(1, blidx, i) < bounds_h_(0, blidx, i)) {
+      // Did not find any allocated variables meeting our criteria
+      bounds_h_(0, blidx, i) = -1;
+      // Make the upper bound more negative so a for loop won't iterate once
+      bounds_h_(1, blidx, i) = -2;
+    }
+  }
+  // Record the maximum for easy access
+  bounds_h_(1, blidx, nvar) = idx - 1;
+}
+
+void SparsePackBase::BuildCompact() {
+  // List the allocated (block, variable component) pairs so that kernels over sparse
+  // variables only allocated on a few blocks don't have to launch over every block
+  if (!compact_pack_) return;
+  const int nblocks = bounds_h_.extent_int(1);
+  ncompact_ = 0;
+  for (int b = 0; b < nblocks; ++b)
+    ncompact_ += bounds_h_(1, b, nvar_) + 1;
+  compact_ = compact_t("compact", 2, std::max(ncompact_, 1));
+  compact_h_ = Kokkos::create_mirror_view(compact_);
+  int p = 0;
+  for (int b = 0; b < nblocks; ++b) {
+    for (int n = 0; n <= bounds_h_(1, b, nvar_); ++n) {
+      compact_h_(0, p) = b;
+      compact_h_(1, p) = n;
+      p++;
+    }
+  }
+  Kokkos::deep_copy(compact_, compact_h_);
+}
+
 template <class T>
 SparsePackBase SparsePackBase::Build(T *pmd, const PackDescriptor &desc,
                                      const std::vector<bool> &include_block) {
@@ -104,42 +238,26 @@ SparsePackBase SparsePackBase::Build(T *pmd, const PackDescriptor &desc,
   pack.coarse_ = desc.coarse;
   pack.nvar_ = desc.nvar_groups;
   pack.flat_ = desc.flat;
-  pack.size_ = 0;
+  pack.compact_pack_ = desc.compact;
 
-  // Count up the size of the array that is required
+  // Count up the size of the array that is required. The first entry of every block is
+  // at offsets[block], which in flat packs continues from the previous block, so that
+  // the blocks can be filled independently below.
+  std::vector<mbd_t *> blocks;
+  ForEachBlock(pmd, include_block, [&](int b, mbd_t *pmbd) { blocks.push_back(pmbd); });
+  const int nblocks = blocks.size();
+  std::vector<int> offsets(nblocks + 1, 0);
   int max_size = 0;
-  int nblocks = 0;
   bool contains_face_or_edge = false;
   bool contains_face_with_fluxes = false;
-  int size = 0; // local var used to compute size/block
-  ForEachBlock(pmd, include_block, [&](int b, mbd_t *pmbd) {
-    if (!desc.flat) {
-      size = 0;
-    }
-    nblocks++;
-    const auto &uid_map = pmbd->GetUidMap();
-    for (int i = 0; i < nvar; ++i) {
-      for (const auto &[var_name, uid] : desc.var_groups[i]) {
-        if (uid_map.count(uid) > 0) {
-          const auto pv = uid_map.at(uid);
-          if (pv->IsAllocated()) {
-            if (pv->IsSet(Metadata::Edge)) contains_face_or_edge = true;
-            if (pv->IsSet(Metadata::Face)) {
-              if (pv->IsSet(Metadata::WithFluxes) && desc.with_fluxes) {
-                contains_face_with_fluxes = true;
-              }
-              contains_face_or_edge = true;
-            }
-            int prod = pv->GetDim(6) * pv->GetDim(5) * pv->GetDim(4);
-            size += prod;       // max size/block (or total size for flat)
-            pack.size_ += prod; // total ragged size
-          }
-        }
-      }
-    }
-
+  for (int b = 0; b < nblocks; ++b) {
+    const int size =
+        CountBlock(desc, blocks[b], contains_face_or_edge, contains_face_with_fluxes);
+    offsets[b + 1] = offsets[b] + size;
     max_size = std::max(size, max_size);
-  });
+  }
+  pack.size_ = offsets[nblocks]; // total ragged size
+  if (desc.flat) max_size = pack.size_;
   pack.nblocks_ = desc.flat ? 1 : nblocks;
 
   // Allocate the views
@@ -165,120 +283,71 @@ SparsePackBase SparsePackBase::Build(T *pmd, const PackDescriptor &desc,
   pack.bounds_ = bounds_t("bounds", 2, nblocks, nvar + 1);
   pack.bounds_h_ = Kokkos::create_mirror_view(pack.bounds_);
 
-  pack.coords_ = coords_t("coords", desc.flat ? max_size : nblocks);
+  // Non-flat packs over all blocks of a MeshData can share the coordinates of its
+  // block metadata instead of copying them to the device again
+  bool shared_coords = false;
+  if constexpr (std::is_same_v<T, MeshData<Real>>) {
+    shared_coords = !desc.flat && nblocks == pmd->NumBlocks();
+    if (shared_coords) pack.coords_ = pmd->GetBlockMetadata().coords;
+  }
+  if (!shared_coords) pack.coords_ = coords_t("coords", desc.flat ? max_size : nblocks);
   auto coords_h = Kokkos::create_mirror_view(pack.coords_);
 
-  // Fill the views
-  int idx = 0;
-  int blidx = 0;
-  ForEachBlock(pmd, include_block, [&](int block, mbd_t *pmbd) {
-    int b = 0;
-    const auto &uid_map = pmbd->GetUidMap();
-    if (!desc.flat) {
-      idx = 0;
-      b = blidx;
-      // JMM: This line could be unified with the coords_h line below,
-      // but it would imply unnecessary copies in the case of non-flat
-      // packs.
-      coords_h(b) = pmbd->GetBlockPointer()->coords_device;
-    }
-
-    for (int i = 0; i < nvar; ++i) {
-      pack.bounds_h_(0, blidx, i) = idx;
-      for (const auto &[var_name, uid] : desc.var_groups[i]) {
-        if (uid_map.count(uid) > 0) {
-          const auto pv = uid_map.at(uid);
-          if (pv->IsAllocated()) {
-            Variable<Real> *pvf;
-            if (desc.with_fluxes && pv->IsSet(Metadata::WithFluxes)) {
-              std::string flux_name = pv->metadata().GetFluxName();
-              if (flux_name != "") pvf = &pmbd->Get(flux_name);
-            }
-            for (int t = 0; t < pv->GetDim(6); ++t) {
-              for (int u = 0; u < pv->GetDim(5); ++u) {
-                for (int v = 0; v < pv->GetDim(4); ++v) {
-                  if (pv->IsSet(Metadata::Face) || pv->IsSet(Metadata::Edge)) {
-                    if (pack.coarse_) {
-                      pack.pack_h_(0, b, idx) = pv->coarse_s.Get(0, t, u, v);
-                      pack.pack_h_(1, b, idx) = pv->coarse_s.Get(1, t, u, v);
-                      pack.pack_h_(2, b, idx) = pv->coarse_s.Get(2, t, u, v);
-                    } else {
-                      pack.pack_h_(0, b, idx) = pv->data.Get(0, t, u, v);
-                      pack.pack_h_(1, b, idx) = pv->data.Get(1, t, u, v);
-                      pack.pack_h_(2, b, idx) = pv->data.Get(2, t, u, v);
-                    }
-                    if (pv->IsSet(Metadata::Vector)) {
-                      pack.pack_h_(0, b, idx).vector_component = X1DIR;
-                      pack.pack_h_(1, b, idx).vector_component = X2DIR;
-                      pack.pack_h_(2, b, idx).vector_component = X3DIR;
-                    }
-
-                    if (pv->IsSet(Metadata::Face)) {
-                      pack.pack_h_(0, b, idx).topological_element =
-                          TopologicalElement::F1;
-                      pack.pack_h_(1, b, idx).topological_element =
-                          TopologicalElement::F2;
-                      pack.pack_h_(2, b, idx).topological_element =
-                          TopologicalElement::F3;
-                    }
-
-                  } else { // This is a cell, node, or a variable that doesn't have
-                           // topology information
-                    if (pack.coarse_) {
-                      pack.pack_h_(0, b, idx) = pv->coarse_s.Get(0, t, u, v);
-                    } else {
-                      pack.pack_h_(0, b, idx) = pv->data.Get(0, t, u, v);
-                    }
-                    if (pv->IsSet(Metadata::Vector))
-                      pack.pack_h_(0, b, idx).vector_component = v + 1;
-                  }
-
-                  if (desc.with_fluxes && pv->IsSet(Metadata::WithFluxes)) {
-                    pack.pack_h_(0 + pack.flx_idx_, b, idx) = pvf->data.Get(0, t, u, v);
-                    if (!pv->IsSet(Metadata::Edge)) {
-                      pack.pack_h_(1 + pack.flx_idx_, b, idx) = pvf->data.Get(1, t, u, v);
-                      pack.pack_h_(2 + pack.flx_idx_, b, idx) = pvf->data.Get(2, t, u, v);
-                    }
-                  }
-
-                  for (auto el :
-                       GetTopologicalElements(pack.pack_h_(0, b, idx).topological_type)) {
-                    pack.pack_h_(static_cast<int>(el) % 3, b, idx).topological_element =
-                        el;
-                  }
-                  PARTHENON_REQUIRE(
-                      pack.pack_h_(0, b, idx).size() > 0,
-                      "Seems like this variable might not actually be allocated.");
-
-                  if (desc.flat) {
-                    coords_h(idx) = pmbd->GetBlockPointer()->coords_device;
-                  }
-                  idx++;
-                }
-              }
-            }
-          }
-        }
-      }
-      pack.bounds_h_(1, blidx, i) = idx - 1;
-      if (pack.bounds_h_(1, blidx, i) < pack.bounds_h_(0, blidx, i)) {
-        // Did not find any allocated variables meeting our criteria
-        pack.bounds_h_(0, blidx, i) = -1;
-        // Make the upper bound more negative so a for loop won't iterate once
-        pack.bounds_h_(1, blidx, i) = -2;
-      }
-    }
-    // Record the maximum for easy access
-    pack.bounds_h_(1, blidx, nvar) = idx - 1;
-    blidx++;
-  });
+  // Fill the views, every block only writes to its own entries so the blocks are filled
+  // in parallel on the host
+  Kokkos::parallel_for(
+      "SparsePackBase::Build", Kokkos::RangePolicy<HostExecSpace>(0, nblocks),
+      [&](const int b) {
+        pack.FillBlock(desc, blocks[b], b, desc.flat ? offsets[b] : 0, &coords_h);
+      });
+  HostExecSpace().fence();
   Kokkos::deep_copy(pack.pack_, pack.pack_h_);
   Kokkos::deep_copy(pack.bounds_, pack.bounds_h_);
-  Kokkos::deep_copy(pack.coords_, coords_h);
+  if (!shared_coords) Kokkos::deep_copy(pack.coords_, coords_h);
 
+  pack.BuildCompact();
   return pack;
 }
 
+template <class T>
+bool SparsePackBase::Patch(T *pmd, const PackDescriptor &desc,
+                           const std::vector<bool> &include_block,
+                           const std::vector<int> &changed) {
+  using mbd_t = MeshBlockData<Real>;
+  // In flat packs all later blocks would move
+  if (flat_) return false;
+  std::vector<mbd_t *> blocks;
+  ForEachBlock(pmd, include_block, [&](int b, mbd_t *pmbd) { blocks.push_back(pmbd); });
+  const int leading_dim = pack_h_.extent_int(0);
+  const int max_size = pack_h_.extent_int(2);
+  for (const int b : changed) {
+    bool contains_face_or_edge = false;
+    bool contains_face_with_fluxes = false;
+    const int size =
+        CountBlock(desc, blocks[b], contains_face_or_edge, contains_face_with_fluxes);
+    // The views have to be reallocated if the block doesn't fit anymore
+    if (size > max_size || (contains_face_with_fluxes && flx_idx_ != 3) ||
+        (contains_face_or_edge && leading_dim < 3))
+      return false;
+  }
+
+  // The blocks and therefore their coordinates are the same
+  for (const int b : changed) {
+    size_ -= bounds_h_(1, b, nvar_) + 1;
+    // Drop the views of the old entries, which may keep deallocated data alive
+    for (int l = 0; l < leading_dim; ++l)
+      for (int n = 0; n < max_size; ++n)
+        pack_h_(l, b, n) = typename pack_h_t::value_type();
+    FillBlock(desc, blocks[b], b, 0, nullptr);
+    size_ += bounds_h_(1, b, nvar_) + 1;
+  }
+  // Blocking, so that no kernel still uses the old entries
+  Kokkos::deep_copy(pack_, pack_h_);
+  Kokkos::deep_copy(bounds_, bounds_h_);
+  BuildCompact();
+  return true;
+}
+
 // Specialize for the only two types this should work for
 template SparsePackBase
 SparsePackBase::Build<MeshBlockData<Real>>(MeshBlockData<Real> *, const PackDescriptor &,
@@ -286,21 +355,24 @@ SparsePackBase::Build<MeshBlockData<Real>>(MeshBlockData<Real> *, const PackDesc
 template SparsePackBase SparsePackBase::Build<MeshData<Real>>(MeshData<Real> *,
                                                               const PackDescriptor &,
                                                               const std::vector<bool> &);
+template bool SparsePackBase::Patch<MeshBlockData<Real>>(MeshBlockData<Real> *,
+                                                        const PackDescriptor &,
+                                                        const std::vector<bool> &,
+                                                        const std::vector<int> &);
+template bool SparsePackBase::Patch<MeshData<Real>>(MeshData<Real> *,
+                                                    const PackDescriptor &,
+                                                    const std::vector<bool> &,
+                                                    const std::vector<int> &);
 
 template <class T>
 SparsePackBase &SparsePackCache::Get(T *pmd, const PackDescriptor &desc,
                                      const std::vector<bool> &include_block) {
-  if (pack_map.count(desc.identifier) > 0) {
-    auto &cache_tuple = pack_map[desc.identifier];
+  auto it = pack_map.find(desc.identifier_hash);
+  if (it != pack_map.end()) {
+    auto &cache_tuple = it->second;
     auto &pack = std::get<0>(cache_tuple);
-    auto alloc_status_in = SparsePackBase::GetAllocStatus(pmd, desc, include_block);
-    auto &alloc_status = std::get<1>(cache_tuple);
-    if (alloc_status.size() != alloc_status_in.size())
+    if (std::get<4>(cache_tuple) != desc.identifier)
       return BuildAndAdd(pmd, desc, include_block);
-    for (int i = 0; i < alloc_status_in.size(); ++i) {
-      if (alloc_status[i] != alloc_status_in[i])
-        return BuildAndAdd(pmd, desc, include_block);
-    }
     auto &include_status = std::get<2>(cache_tuple);
     if (include_status.size() != include_block.size())
       return BuildAndAdd(pmd, desc, include_block);
@@ -308,6 +380,31 @@ SparsePackBase &SparsePackCache::Get(T *pmd, const PackDescriptor &desc,
       if (include_status[i] != include_block[i])
         return BuildAndAdd(pmd, desc, include_block);
     }
+    // No variable has been created, allocated, or deallocated since the pack was built,
+    // so walking all blocks and variables to compare allocation statuses is unnecessary
+    const auto generation = Variable<Real>::GetAllocationGeneration();
+    if (std::get<3>(cache_tuple) == generation) return pack;
+    auto alloc_status_in = SparsePackBase::GetAllocStatus(pmd, desc, include_block);
+    auto &alloc_status = std::get<1>(cache_tuple);
+    if (alloc_status.size() != alloc_status_in.size())
+      return BuildAndAdd(pmd, desc, include_block);
+    // Every block has the same number of statuses, only the entries of the blocks with
+    // changed statuses are filled again if they still fit into the pack
+    const int nblocks = pack.bounds_h_.extent_int(1);
+    const std::size_t per_block = nblocks > 0 ? alloc_status.size() / nblocks : 1;
+    std::vector<int> changed;
+    for (int i = 0; i < alloc_status_in.size(); ++i) {
+      if (alloc_status[i] != alloc_status_in[i]) {
+        const int b = i / per_block;
+        if (changed.empty() || changed.back() != b) changed.push_back(b);
+      }
+    }
+    if (!changed.empty()) {
+      if (!pack.Patch(pmd, desc, include_block, changed))
+        return BuildAndAdd(pmd, desc, include_block);
+      alloc_status = std::move(alloc_status_in);
+    }
+    std::get<3>(cache_tuple) = generation;
     // Cached version is not stale, so just return a reference to it
     return std::get<0>(cache_tuple);
   }
@@ -323,11 +420,14 @@ SparsePackCache::Get<MeshBlockData<Real>>(MeshBlockData<Real> *, const PackDescr
 template <class T>
 SparsePackBase &SparsePackCache::BuildAndAdd(T *pmd, const PackDescriptor &desc,
                                              const std::vector<bool> &include_block) {
-  if (pack_map.count(desc.identifier) > 0) pack_map.erase(desc.identifier);
-  pack_map[desc.identifier] = {SparsePackBase::Build(pmd, desc, include_block),
-                               SparsePackBase::GetAllocStatus(pmd, desc, include_block),
-                               include_block};
-  return std::get<0>(pack_map[desc.identifier]);
+  // Read the generation first so that a concurrent allocation can only make the cache
+  // entry look stale, never current
+  const auto generation = Variable<Real>::GetAllocationGeneration();
+  auto &cache_tuple = pack_map[desc.identifier_hash];
+  cache_tuple = {SparsePackBase::Build(pmd, desc, include_block),
+                 SparsePackBase::GetAllocStatus(pmd, desc, include_block), include_block,
+                 generation, desc.identifier};
+  return std::get<0>(cache_tuple);
 }
 template SparsePackBase &
 SparsePackCache::BuildAndAdd<MeshData<Real>>(MeshData<Real> *, const PackDescriptor &,
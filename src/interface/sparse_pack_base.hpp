@@ -43,7 +43,7 @@ using SparsePackIdxMap = std::unordered_map<std::string, std::size_t>;
 
 class StateDescriptor;
 
-enum class PDOpt { WithFluxes, Coarse, Flatten };
+enum class PDOpt { WithFluxes, Coarse, Flatten, Compact };
 
 class SparsePackBase {
  public:
@@ -60,6 +60,9 @@ class SparsePackBase {
   using bounds_t = ParArray3D<int>;
   using bounds_h_t = typename bounds_t::HostMirror;
   using coords_t = ParArray1D<ParArray0D<Coordinates_t>>;
+  using coords_h_t = typename coords_t::HostMirror;
+  using compact_t = ParArray2D<int>;
+  using compact_h_t = typename compact_t::HostMirror;
 
   // Returns a SparsePackBase object that is either newly created or taken
   // from the cache in pmd. The cache itself handles the all of this logic
@@ -86,16 +89,42 @@ class SparsePackBase {
   static SparsePackBase Build(T *pmd, const impl::PackDescriptor &desc,
                               const std::vector<bool> &include_block);
 
+  // Fill the entries of the (zero-based) blocks changed of a pack built by Build from
+  // the same pmd, desc, and include_block again, e.g. after sparse variables have been
+  // allocated or deallocated on them. Returns false without changing the pack if the
+  // blocks don't fit into its views anymore (or it is flat), in which case it has to be
+  // rebuilt.
+  template <class T>
+  bool Patch(T *pmd, const impl::PackDescriptor &desc,
+             const std::vector<bool> &include_block, const std::vector<int> &changed);
+
+  // Number of entries the variables of desc take up on pmbd, setting the flags if any of
+  // them has a face or edge topology or is a face variable with fluxes
+  static int CountBlock(const impl::PackDescriptor &desc, MeshBlockData<Real> *pmbd,
+                        bool &contains_face_or_edge, bool &contains_face_with_fluxes);
+  // Set the host entries and bounds of the block with pack index blidx, starting at
+  // entry idx, and its coordinates in coords_h unless that is null
+  void FillBlock(const impl::PackDescriptor &desc, MeshBlockData<Real> *pmbd,
+                 const int blidx, int idx, coords_h_t *coords_h);
+  // Build the list of entries of compact packs from the host bounds
+  void BuildCompact();
+
   pack_t pack_;
   pack_h_t pack_h_;
   bounds_t bounds_;
   bounds_h_t bounds_h_;
   coords_t coords_;
+  // For compact packs, the block (0) and pack index (1) of every allocated variable
+  // component on every block of the pack
+  compact_t compact_;
+  compact_h_t compact_h_;
 
   int flx_idx_;
   bool with_fluxes_;
   bool coarse_;
   bool flat_;
+  bool compact_pack_ = false;
+  int ncompact_ = 0;
   int nblocks_;
   int nvar_;
   int size_;
@@ -120,8 +149,13 @@ class SparsePackCache {
   SparsePackBase &BuildAndAdd(T *pmd, const impl::PackDescriptor &desc,
                               const std::vector<bool> &include_block);
 
-  std::unordered_map<std::string, std::tuple<SparsePackBase, SparsePackBase::alloc_t,
-                                             SparsePackBase::include_t>>
+  // Keyed by PackDescriptor::identifier_hash, the last element is the full identifier
+  // to catch hash collisions. The fourth element is the variable allocation generation at
+  // the time the pack was built, if it hasn't changed the allocation statuses don't need
+  // to be compared
+  std::unordered_map<std::size_t,
+                     std::tuple<SparsePackBase, SparsePackBase::alloc_t,
+                                SparsePackBase::include_t, std::size_t, std::string>>
       pack_map;
 
   friend class SparsePackBase;
@@ -138,7 +172,8 @@ struct PackDescriptor {
   // default constructor needed for certain use cases
   PackDescriptor()
       : nvar_groups(0), var_group_names({}), var_groups({}), with_fluxes(false),
-        coarse(false), flat(false), identifier("") {}
+        coarse(false), flat(false), compact(false), identifier(""),
+        identifier_hash(std::hash<std::string>()(identifier)) {}
 
   template <class GROUP_t, class SELECTOR_t>
   PackDescriptor(StateDescriptor *psd, const std::vector<GROUP_t> &var_groups_in,
@@ -147,9 +182,11 @@ struct PackDescriptor {
         var_groups(BuildUids(var_groups_in.size(), psd, selector)),
         with_fluxes(options.count(PDOpt::WithFluxes)),
         coarse(options.count(PDOpt::Coarse)), flat(options.count(PDOpt::Flatten)),
-        identifier(GetIdentifier()) {
+        compact(options.count(PDOpt::Compact)), identifier(GetIdentifier()),
+        identifier_hash(std::hash<std::string>()(identifier)) {
     PARTHENON_REQUIRE(!(with_fluxes && coarse),
                       "Probably shouldn't be making a coarse pack with fine fluxes.");
+    PARTHENON_REQUIRE(!(flat && compact), "Flat packs are already compact.");
   }
 
   const int nvar_groups;
@@ -158,7 +195,10 @@ struct PackDescriptor {
   const bool with_fluxes;
   const bool coarse;
   const bool flat;
+  const bool compact;
   const std::string identifier;
+  // Key of the pack in the SparsePackCache, hashed once here rather than on every lookup
+  const std::size_t identifier_hash;
 
  private:
   std::string GetIdentifier() {
@@ -172,16 +212,17 @@ struct PackDescriptor {
     ident += std::to_string(with_fluxes);
     ident += std::to_string(coarse);
     ident += std::to_string(flat);
+    ident += std::to_string(compact);
     return ident;
   }
   template <class FUNC_t>
   std::vector<PackDescriptor::VariableGroup_t>
   BuildUids(int nvgs, const StateDescriptor *const psd, const FUNC_t &selector) {
-    auto fields = psd->AllFields();
+    const auto &fields = psd->AllFields();
     std::vector<VariableGroup_t> vgs(nvgs);
-    for (auto [id, md] : fields) {
+    for (const auto &[id, md] : fields) {
+      const auto uid = Variable<Real>::GetUniqueID(id.label());
       for (int i = 0; i < nvgs; ++i) {
-        auto uid = Variable<Real>::GetUniqueID(id.label());
         if constexpr (std::is_invocable<FUNC_t, int, VarID, Metadata>::value) {
           if (selector(i, id, md)) {
             vgs[i].push_back({id, uid});
@@ -11,6 +11,7 @@
 // the public, perform publicly and display publicly, and to permit others to do so.
 //========================================================================================
 
+#include <algorithm>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
@@ -22,6 +23,7 @@
 #include "basic_types.hpp"
 #include "interface/metadata.hpp"
 #include "interface/state_descriptor.hpp"
+#include "mesh/meshblock.hpp"
 #include "utils/error_checking.hpp"
 
 namespace parthenon {
@@ -221,6 +223,7 @@ class SwarmProvider : public VariableProvider {
         for (auto &pair : package->AllSwarmValues(label)) {
           state_->AddSwarmValue(pair.first, label, pair.second);
         }
+        state_->SetSwarmCost(label, package->GetSwarmCost(label));
         return;
       }
     }
@@ -237,6 +240,7 @@ class SwarmProvider : public VariableProvider {
       auto &val_meta = p.second;
       state_->AddSwarmValue(val_name, swarm_name, val_meta);
     }
+    state_->SetSwarmCost(swarm_name, package->GetSwarmCost(swarm));
   }
 
   Packages_t &packages_;
@@ -323,7 +327,7 @@ bool StateDescriptor::AddSparsePoolImpl(const SparsePool &pool) {
   std::string controller_base = pool.controller_base_name();
   if (controller_base == "") controller_base = pool.base_name();
   // add all the sparse fields
-  for (const auto itr : pool.pool()) {
+  for (const auto &itr : pool.pool()) {
     if (!AddFieldImpl(VarID(pool.base_name(), itr.first), itr.second,
                       VarID(controller_base, itr.first))) {
       // a field with this name already exists, this would leave the StateDescriptor in an
@@ -437,13 +441,13 @@ StateDescriptor::CreateResolvedStateDescriptor(Packages_t &packages) {
     // the same level for the purpose of dependency resolution)
     Dictionary<Metadata> field_dict;
 
-    for (const auto itr : package->AllFields()) {
+    for (const auto &itr : package->AllFields()) {
       if (!itr.second.IsSet(Metadata::Sparse)) {
         field_dict.insert({itr.first.label(), itr.second});
       }
     }
 
-    for (const auto itr : package->AllSparsePools()) {
+    for (const auto &itr : package->AllSparsePools()) {
       field_dict.insert({itr.first, itr.second.shared_metadata()});
     }
 
@@ -480,6 +484,32 @@ StateDescriptor::CreateResolvedStateDescriptor(Packages_t &packages) {
   return state;
 }
 
+const std::vector<std::shared_ptr<Variable<Real>>> &
+StateDescriptor::FieldPrototypes(const std::shared_ptr<MeshBlock> &pmb) {
+  std::vector<int> key{static_cast<int>(metadataMap_.size())};
+  for (const auto *bnds : {&pmb->cellbounds, &pmb->c_cellbounds, &pmb->f_cellbounds}) {
+    for (const auto &ncells :
+         {bnds->ncellsi(IndexDomain::entire), bnds->ncellsj(IndexDomain::entire),
+          bnds->ncellsk(IndexDomain::entire)}) {
+      key.push_back(ncells);
+    }
+  }
+  if (key == field_prototypes_key_) return field_prototypes_;
+
+  field_prototypes_.clear();
+  field_prototypes_.reserve(metadataMap_.size());
+  for (const auto &[vid, metadata] : metadataMap_) {
+    field_prototypes_.push_back(
+        std::make_shared<Variable<Real>>(vid.base_name, metadata, vid.sparse_id, pmb));
+  }
+  std::sort(field_prototypes_.begin(), field_prototypes_.end(),
+            [](const auto &a, const auto &b) {
+              return a->GetUniqueID() < b->GetUniqueID();
+            });
+  field_prototypes_key_ = std::move(key);
+  return field_prototypes_;
+}
+
 // Build a list of variables in the following order
 // 1. fields requested by name (if present), in the order they're requested
 // 2. non-sparse fields picked up by the provided Metadata::FlagCollection
@@ -13,12 +13,15 @@
 #ifndef INTERFACE_STATE_DESCRIPTOR_HPP_
 #define INTERFACE_STATE_DESCRIPTOR_HPP_
 
+#include <atomic>
+#include <cstddef>
 #include <functional>
 #include <iostream>
 #include <limits>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -31,6 +34,7 @@
 #include "interface/params.hpp"
 #include "interface/sparse_pool.hpp"
 #include "interface/swarm.hpp"
+#include "interface/timestep_criterion.hpp"
 #include "interface/var_id.hpp"
 #include "interface/variable.hpp"
 #include "outputs/output_parameters.hpp"
@@ -147,6 +151,40 @@ class StateDescriptor {
     return params_.GetMutable<T>(key);
   }
 
+  // O(1) access to a parameter in hot paths and its device copy, see Params
+  template <typename T>
+  Params::Handle<T> ParamHandle(const std::string &key) const {
+    return params_.GetHandle<T>(key);
+  }
+  template <typename T>
+  Params::DeviceHandle<T> DeviceParam(const std::string &key) const {
+    return params_.GetDeviceHandle<T>(key);
+  }
+
+  // A package can register one struct of trivially copyable parameters that is kept in
+  // device memory. Kernels capture the (small) view returned by DeviceParams instead of
+  // every parameter, read it with params(), and see the values of UpdateDeviceParams,
+  // which is the only place the struct is copied to device again.
+  template <typename T>
+  void AddDeviceParams(const T &value) {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "Device parameter blocks must be trivially copyable");
+    params_.Add<T>(device_params_key_, value, Params::Mutability::Mutable);
+    params_.GetDeviceHandle<T>(device_params_key_);
+  }
+  template <typename T>
+  void UpdateDeviceParams(const T &value) {
+    params_.Update<T>(device_params_key_, value);
+  }
+  template <typename T>
+  Params::DeviceHandle<T> DeviceParams() const {
+    return params_.GetDeviceHandle<T>(device_params_key_);
+  }
+  template <typename T>
+  const T &DeviceParamsHost() const {
+    return params_.Get<T>(device_params_key_);
+  }
+
   // Set (if not set) and get simultaneously.
   // infers type correctly.
   template <typename T>
@@ -163,6 +201,10 @@ class StateDescriptor {
   // retrieve label
   const std::string &label() const noexcept { return label_; }
 
+  // Unique for every StateDescriptor created during the run, unlike its address, which
+  // may be reused once it is destroyed
+  std::size_t GetSerialNumber() const noexcept { return serial_; }
+
   bool AddSwarm(const std::string &swarm_name, const Metadata &m_in) {
     PARTHENON_REQUIRE(
         swarm_name != "swarm",
@@ -183,6 +225,20 @@ class StateDescriptor {
     return AddSwarm(T::name(), m);
   }
 
+  // Cost of a single active particle of swarm_name for load balancing, in units of the
+  // cost of a block without particles. Blocks add it for every particle they hold unless
+  // costs are measured by the timing based load balancer. Defaults to zero.
+  void SetSwarmCost(const std::string &swarm_name, Real cost) {
+    PARTHENON_REQUIRE_THROWS(SwarmPresent(swarm_name),
+                             "Swarm " + swarm_name + " does not exist!");
+    PARTHENON_REQUIRE_THROWS(cost >= 0.0, "Swarm cost must not be negative");
+    swarmCostMap_[swarm_name] = cost;
+  }
+  Real GetSwarmCost(const std::string &swarm_name) const {
+    auto it = swarmCostMap_.find(swarm_name);
+    return it == swarmCostMap_.end() ? 0.0 : it->second;
+  }
+
   bool AddSwarmValue(const std::string &value_name, const std::string &swarm_name,
                      const Metadata &m);
   template <typename T, typename V>
@@ -259,6 +315,12 @@ class StateDescriptor {
   }
 
   const auto &AllFields() const noexcept { return metadataMap_; }
+  // Variables without data of all fields in the order of their unique ids, shaped for
+  // blocks of the size of pmb. They are only rebuilt when fields are added or the block
+  // size changes, so that the variables of new blocks are stamped from them instead of
+  // resolving the metadata of every field on every block.
+  const std::vector<std::shared_ptr<Variable<Real>>> &
+  FieldPrototypes(const std::shared_ptr<MeshBlock> &pmb);
   const auto &AllSparsePools() const noexcept { return sparsePoolMap_; }
   const auto &AllSwarms() const noexcept { return swarmMetadataMap_; }
   const auto &AllSwarmValues(const std::string &swarm_name) noexcept {
@@ -426,6 +488,8 @@ class StateDescriptor {
   }
 
   std::vector<std::shared_ptr<AMRCriteria>> amr_criteria;
+  // Evaluated for all packages in one kernel by Update::EstimateTimestep
+  std::vector<TimestepCriterion> timestep_criteria;
 
   std::function<void(MeshBlockData<Real> *rc)> PreCommFillDerivedBlock = nullptr;
   std::function<void(MeshData<Real> *rc)> PreCommFillDerivedMesh = nullptr;
@@ -463,7 +527,10 @@ class StateDescriptor {
   void InvertControllerMap();
 
   Params params_;
+  static constexpr const char *device_params_key_ = "DeviceParams_";
   const std::string label_;
+  const std::size_t serial_ = next_serial_++;
+  inline static std::atomic<std::size_t> next_serial_{0};
 
   // for each variable label (full label for sparse variables) hold metadata
   std::unordered_map<VarID, Metadata, VarIDHasher> metadataMap_;
@@ -474,8 +541,13 @@ class StateDescriptor {
   // for each sparse base name hold its sparse pool
   Dictionary<SparsePool> sparsePoolMap_;
 
+  // see FieldPrototypes, with the number of fields and the block size they were built for
+  std::vector<std::shared_ptr<Variable<Real>>> field_prototypes_;
+  std::vector<int> field_prototypes_key_;
+
   Dictionary<Metadata> swarmMetadataMap_;
   Dictionary<Dictionary<Metadata>> swarmValueMetadataMap_;
+  Dictionary<Real> swarmCostMap_;
 
   RefinementFunctionMaps refinementFuncMaps_;
 };
@@ -11,6 +11,7 @@
 // the public, perform publicly and display publicly, and to permit others to do so.
 //========================================================================================
 #include <algorithm>
+#include <cstdint>
 #include <cstdlib>
 #include <limits>
 #include <memory>
@@ -21,7 +22,6 @@
 #include "swarm.hpp"
 #include "swarm_default_names.hpp"
 #include "utils/error_checking.hpp"
-#include "utils/sort.hpp"
 
 namespace parthenon {
 
@@ -64,7 +64,8 @@ SwarmDeviceContext Swarm::GetDeviceContext() const {
 }
 
 Swarm::Swarm(const std::string &label, const Metadata &metadata, const int nmax_pool_in)
-    : label_(label), m_(metadata), nmax_pool_(nmax_pool_in), mask_("mask", nmax_pool_),
+    : label_(label), m_(metadata), nmax_pool_(nmax_pool_in),
+      nmax_pool_min_(nmax_pool_in), mask_("mask", nmax_pool_),
       marked_for_removal_("mfr", nmax_pool_), block_index_("block_index_", nmax_pool_),
       neighbor_indices_("neighbor_indices_", 4, 4, 4),
       new_indices_("new_indices_", nmax_pool_),
@@ -72,7 +73,9 @@ Swarm::Swarm(const std::string &label, const Metadata &metadata, const int nmax_
       recv_neighbor_index_("recv_neighbor_index_", nmax_pool_),
       recv_buffer_index_("recv_buffer_index_", nmax_pool_),
       num_particles_to_send_("num_particles_to_send_", NMAX_NEIGHBORS),
-      cell_sorted_("cell_sorted_", nmax_pool_), mpiStatus(true) {
+      send_buffer_index_("send_buffer_index_", nmax_pool_),
+      cell_sorted_("cell_sorted_", nmax_pool_),
+      sorted_cell_idx_("sorted_cell_idx_", nmax_pool_), mpiStatus(true) {
   PARTHENON_REQUIRE_THROWS(typeid(Coordinates_t) == typeid(UniformCartesian),
                            "SwarmDeviceContext only supports a uniform Cartesian mesh!");
 
@@ -133,6 +136,7 @@ void Swarm::Add(const std::string &label, const Metadata &metadata) {
 
   if (newm.Type() == Metadata::Integer) {
     Add_<int>(label, newm);
+    if (newm.IsSet(Metadata::ParticleId)) EnableIdIndex_(label);
   } else if (newm.Type() == Metadata::Real) {
     Add_<Real>(label, newm);
   } else {
@@ -194,18 +198,75 @@ void Swarm::Remove(const std::string &label) {
   if (found == false) {
     throw std::invalid_argument("swarm variable not found in Remove()");
   }
+  if (label == id_index_var_) {
+    id_index_var_ = "";
+    id_index_ = ParticleIdIndex();
+    indexed_id_ = ParArray1D<int>();
+    id_index_dirty_.clear();
+  }
+
+  // Compact the pools
+  RebuildPool_<int>(nmax_pool_);
+  RebuildPool_<Real>(nmax_pool_);
 }
 
 void Swarm::setPoolMax(const std::int64_t nmax_pool) {
   PARTHENON_REQUIRE(nmax_pool > nmax_pool_, "Must request larger pool size!");
-  std::int64_t n_new_begin = nmax_pool_;
-  std::int64_t n_new = nmax_pool - nmax_pool_;
+  for (std::int64_t n = nmax_pool_; n < nmax_pool; n++) {
+    free_indices_.push_back(n);
+  }
+  ResizePool_(nmax_pool);
+}
+
+void Swarm::ReservePool(const int num_to_add) {
+  const std::int64_t nmax_needed = static_cast<std::int64_t>(num_active_) + num_to_add;
+  if (nmax_needed <= nmax_pool_) return;
+  setPoolMax(std::max<std::int64_t>(nmax_needed, 2 * nmax_pool_));
+}
+
+void Swarm::ShrinkPool(const std::int64_t nmax_pool_in) {
+  const std::int64_t nmax_pool =
+      std::max<std::int64_t>(nmax_pool_in, std::max(num_active_, 1));
+  if (nmax_pool >= nmax_pool_) return;
+  if (max_active_index_ >= nmax_pool) Defrag();
+  free_indices_.remove_if([nmax_pool](const int n) { return n >= nmax_pool; });
+  ResizePool_(nmax_pool);
+}
+
+void Swarm::UpdatePoolCapacity() {
+  // Particles received since the last call are the best guess for the next inflow
+  ReservePool(num_received_since_update_);
+  num_received_since_update_ = 0;
+
+  if (pool_shrink_occupancy_ <= 0.0) return;
+  if (num_active_ < pool_shrink_occupancy_ * nmax_pool_ && nmax_pool_ > nmax_pool_min_) {
+    low_occupancy_calls_++;
+  } else {
+    low_occupancy_calls_ = 0;
+  }
+  if (low_occupancy_calls_ >= pool_shrink_calls_) {
+    // Leave enough headroom that the pool does not immediately grow again
+    ShrinkPool(std::max<std::int64_t>(nmax_pool_min_, 2 * num_active_));
+    low_occupancy_calls_ = 0;
+  }
+}
+
+void Swarm::ResizePool_(const std::int64_t nmax_pool) {
+  const std::int64_t n_new = nmax_pool - nmax_pool_;
 
   auto pmb = GetBlockPointer();
   auto pm = pmb->pmy_mesh;
 
-  for (std::int64_t n = 0; n < n_new; n++) {
-    free_indices_.push_back(n + n_new_begin);
+  // Particles beyond a shrunk pool have to leave the id index first
+  if (HasIdIndex()) {
+    UpdateIdIndex();
+    Kokkos::resize(indexed_id_, nmax_pool);
+    if (n_new > 0) {
+      Kokkos::deep_copy(Kokkos::subview(indexed_id_.KokkosView(),
+                                        Kokkos::pair<int, int>(nmax_pool_, nmax_pool)),
+                        no_id_);
+    }
+    pmb->LogMemUsage(n_new * static_cast<std::int64_t>(sizeof(int)));
   }
 
   // Rely on Kokkos setting the newly added values to false for these arrays
@@ -215,32 +276,29 @@ void Swarm::setPoolMax(const std::int64_t nmax_pool) {
   Kokkos::resize(from_to_indices_, nmax_pool + 1);
   Kokkos::resize(recv_neighbor_index_, nmax_pool);
   Kokkos::resize(recv_buffer_index_, nmax_pool);
-  pmb->LogMemUsage(2 * n_new * sizeof(bool));
+  Kokkos::resize(send_buffer_index_, nmax_pool);
+  pmb->LogMemUsage(2 * n_new * static_cast<std::int64_t>(sizeof(bool)));
 
   Kokkos::resize(cell_sorted_, nmax_pool);
-  pmb->LogMemUsage(n_new * sizeof(SwarmKey));
+  pmb->LogMemUsage(n_new * static_cast<std::int64_t>(sizeof(SwarmKey)));
+  Kokkos::resize(sorted_cell_idx_, nmax_pool);
+  pmb->LogMemUsage(n_new * static_cast<std::int64_t>(sizeof(int)));
+  cell_sorted_valid_ = false;
 
   block_index_.Resize(nmax_pool);
-  pmb->LogMemUsage(n_new * sizeof(int));
-
-  auto &int_vector = std::get<getType<int>()>(vectors_);
-  auto &real_vector = std::get<getType<Real>()>(vectors_);
-
-  for (auto &d : int_vector) {
-    d->data.Resize(d->data.GetDim(6), d->data.GetDim(5), d->data.GetDim(4),
-                   d->data.GetDim(3), d->data.GetDim(2), nmax_pool);
-    pmb->LogMemUsage(n_new * sizeof(int));
-  }
+  pmb->LogMemUsage(n_new * static_cast<std::int64_t>(sizeof(int)));
 
-  for (auto &d : real_vector) {
-    d->data.Resize(d->data.GetDim(6), d->data.GetDim(5), d->data.GetDim(4),
-                   d->data.GetDim(3), d->data.GetDim(2), nmax_pool);
-    pmb->LogMemUsage(n_new * sizeof(Real));
-  }
+  const std::int64_t n_new_stride = PoolStride_(nmax_pool) - PoolStride_(nmax_pool_);
+  RebuildPool_<int>(nmax_pool);
+  pmb->LogMemUsage(n_new_stride * std::get<getType<int>()>(pools_).extent_int(0) *
+                   static_cast<std::int64_t>(sizeof(int)));
+  RebuildPool_<Real>(nmax_pool);
+  pmb->LogMemUsage(n_new_stride * std::get<getType<Real>()>(pools_).extent_int(0) *
+                   static_cast<std::int64_t>(sizeof(Real)));
 
   nmax_pool_ = nmax_pool;
 
-  // Eliminate any cached SwarmPacks, as they will need to be rebuilt following setPoolMax
+  // Eliminate any cached SwarmPacks, as they will need to be rebuilt following a resize
   pmb->meshblock_data.Get()->ClearSwarmCaches();
   pm->mesh_data.Get("base")->ClearSwarmCaches();
   for (auto &partition : pm->GetDefaultBlockPartitions()) {
@@ -248,6 +306,65 @@ void Swarm::setPoolMax(const std::int64_t nmax_pool) {
   }
 }
 
+template <class T>
+void Swarm::RebuildPool_(const int nmax_pool) {
+  auto &vars = std::get<getType<T>()>(vectors_);
+  auto &pool = std::get<getType<T>()>(pools_);
+
+  int ncomponents = 0;
+  for (const auto &v : vars) {
+    ncomponents += v->NumComponents();
+  }
+  const int stride = PoolStride_(nmax_pool);
+  ParArray2D<T> new_pool(label_ + " pool", ncomponents, stride);
+
+  int offset = 0;
+  for (auto &v : vars) {
+    const int ncomp = v->NumComponents();
+    // The old data of a variable is contiguous with its own stride in the particle index
+    const int old_stride = v->data.GetDim(1);
+    const int ncopy = std::min(old_stride, stride);
+    const T *old_data = v->data.data();
+    par_for(
+        DEFAULT_LOOP_PATTERN, PARTHENON_AUTO_LABEL, DevExecSpace(), 0, ncomp - 1, 0,
+        ncopy - 1, KOKKOS_LAMBDA(const int c, const int n) {
+          new_pool(offset + c, n) = old_data[c * old_stride + n];
+        });
+    offset += ncomp;
+  }
+  // The old data must stay alive until the copies are done
+  Kokkos::fence();
+
+  offset = 0;
+  for (auto &v : vars) {
+    v->data = ParArrayND<T>(typename ParArrayND<T>::base_t(
+        new_pool.data() + static_cast<std::size_t>(offset) * stride, v->GetDim(6),
+        v->GetDim(5), v->GetDim(4), v->GetDim(3), v->GetDim(2), stride));
+    offset += v->NumComponents();
+  }
+  pool = new_pool;
+}
+
+template void Swarm::RebuildPool_<int>(const int nmax_pool);
+template void Swarm::RebuildPool_<Real>(const int nmax_pool);
+
+std::uint64_t Swarm::GetMemoryUsage() const {
+  std::uint64_t bytes = 0;
+  for (const auto &d : std::get<getType<int>()>(vectors_))
+    bytes += d->data.size() * sizeof(int);
+  for (const auto &d : std::get<getType<Real>()>(vectors_))
+    bytes += d->data.size() * sizeof(Real);
+  bytes += (mask_.size() + marked_for_removal_.size()) * sizeof(bool);
+  bytes += (block_index_.size() + new_indices_.size() + from_to_indices_.size() +
+            recv_neighbor_index_.size() + recv_buffer_index_.size() +
+            send_buffer_index_.size() + cell_sorted_begin_.size() +
+            cell_sorted_number_.size() + sorted_cell_idx_.size() + indexed_id_.size()) *
+           sizeof(int);
+  bytes += cell_sorted_.size() * sizeof(SwarmKey);
+  if (HasIdIndex()) bytes += id_index_.capacity() * 2 * sizeof(int);
+  return bytes;
+}
+
 NewParticlesContext Swarm::AddEmptyParticles(const int num_to_add) {
   PARTHENON_DEBUG_REQUIRE(num_to_add >= 0, "Cannot add negative numbers of particles!");
 
@@ -271,6 +388,7 @@ NewParticlesContext Swarm::AddEmptyParticles(const int num_to_add) {
       block_index_h(*free_index) = this_block_;
       max_active_index_ = std::max<int>(max_active_index_, *free_index);
       new_indices_h(n) = *free_index;
+      MarkIdIndexDirty_(*free_index);
 
       free_index = free_indices_.erase(free_index);
     }
@@ -304,6 +422,7 @@ void Swarm::RemoveMarkedParticles() {
       if (marked_for_removal_h(n)) {
         mask_h(n) = false;
         free_indices_.push_front(n);
+        MarkIdIndexDirty_(n);
         num_active_ -= 1;
         if (n == max_active_index_) {
           max_active_index_ -= 1;
@@ -317,90 +436,146 @@ void Swarm::RemoveMarkedParticles() {
   Kokkos::deep_copy(marked_for_removal_, marked_for_removal_h);
 }
 
-void Swarm::Defrag() {
-  if (GetNumActive() == 0) {
-    return;
-  }
-  // TODO(BRR) Could this algorithm be more efficient? Does it matter?
-  // Add 1 to convert max index to max number
-  std::int64_t num_free = (max_active_index_ + 1) - num_active_;
-  auto pmb = GetBlockPointer();
-
-  auto from_to_indices_h = from_to_indices_.GetHostMirror();
-
-  auto mask_h = Kokkos::create_mirror_view_and_copy(HostMemSpace(), mask_);
+SwarmDefragInfo Swarm::GetDefragInfo() {
+  SwarmDefragInfo info;
+  info.mask = mask_;
+  info.holes = from_to_indices_;
+  PackIndexMap real_imap;
+  PackIndexMap int_imap;
+  info.vreal = PackAllVariables_<Real>(real_imap);
+  info.vint = PackAllVariables_<int>(int_imap);
+  info.nreal = info.vreal.GetDim(2);
+  info.nint = info.vint.GetDim(2);
+  info.num_active = num_active_;
+  info.max_active_index = max_active_index_;
+  return info;
+}
 
-  for (int n = 0; n <= max_active_index_; n++) {
-    from_to_indices_h(n) = unset_index_;
+void Swarm::UpdateIndicesAfterDefrag() {
+  // All free slots are now above the active particles
+  free_indices_.clear();
+  for (int n = num_active_; n < nmax_pool_; n++) {
+    free_indices_.push_back(n);
   }
 
-  std::list<int> new_free_indices;
-
-  free_indices_.sort();
+  // Update max_active_index_
+  max_active_index_ = num_active_ - 1;
 
-  int index = max_active_index_;
-  int num_to_move = std::min<int>(num_free, num_active_);
-  for (int n = 0; n < num_to_move; n++) {
-    while (mask_h(index) == false) {
-      index--;
-    }
-    int index_to_move_from = index;
-    index--;
+  id_index_all_dirty_ = HasIdIndex();
+}
 
-    // Below this number "moved" particles should actually stay in place
-    if (index_to_move_from < num_active_) {
-      break;
-    }
-    int index_to_move_to = free_indices_.front();
-    free_indices_.pop_front();
-    new_free_indices.push_back(index_to_move_from);
-    from_to_indices_h(index_to_move_from) = index_to_move_to;
-  }
+void Swarm::EnableIdIndex_(const std::string &label) {
+  PARTHENON_REQUIRE_THROWS(!HasIdIndex(), "Swarm " + label_ +
+                                              " can only have one ParticleId variable");
+  id_index_var_ = label;
+  id_index_ = ParticleIdIndex(std::max(2 * nmax_pool_, 64));
+  indexed_id_ = ParArray1D<int>("indexed_id_", nmax_pool_);
+  Kokkos::deep_copy(indexed_id_.KokkosView(), no_id_);
+  // Particles that already exist are indexed by the next update
+  id_index_all_dirty_ = true;
+}
 
-  // TODO(BRR) Not all these sorts may be necessary
-  new_free_indices.sort();
-  free_indices_.merge(new_free_indices);
+void Swarm::UpdateIdIndex() {
+  if (!HasIdIndex() || (!id_index_all_dirty_ && id_index_dirty_.empty())) return;
+  PARTHENON_INSTRUMENT
+  auto pmb = GetBlockPointer();
 
-  from_to_indices_.DeepCopy(from_to_indices_h);
+  // Particle indices to revisit, either the recorded ones or the whole pool
+  const bool all = id_index_all_dirty_;
+  int nupdate = nmax_pool_;
+  ParArray1D<int> dirty;
+  if (!all) {
+    std::sort(id_index_dirty_.begin(), id_index_dirty_.end());
+    id_index_dirty_.erase(std::unique(id_index_dirty_.begin(), id_index_dirty_.end()),
+                          id_index_dirty_.end());
+    nupdate = id_index_dirty_.size();
+    dirty = ParArray1D<int>("id index dirty", nupdate);
+    auto dirty_h = dirty.GetHostMirror();
+    for (int m = 0; m < nupdate; ++m)
+      dirty_h(m) = id_index_dirty_[m];
+    dirty.DeepCopy(dirty_h);
+  }
+  if (num_active_ > id_index_.capacity() / 2) id_index_.rehash(2 * num_active_);
 
-  auto from_to_indices = from_to_indices_;
+  auto mask = mask_;
+  auto ids = Get<int>(id_index_var_).Get();
+  auto indexed_id = indexed_id_;
+  auto index = id_index_;
+  constexpr int no_id = no_id_;
 
-  auto &mask = mask_;
+  // Drop stale entries first, a particle that moved is inserted again below
+  index.begin_erase();
   pmb->par_for(
-      PARTHENON_AUTO_LABEL, 0, max_active_index_, KOKKOS_LAMBDA(const int n) {
-        if (from_to_indices(n) >= 0) {
-          mask(from_to_indices(n)) = mask(n);
-          mask(n) = false;
+      PARTHENON_AUTO_LABEL, 0, nupdate - 1, KOKKOS_LAMBDA(const int m) {
+        const int n = all ? m : dirty(m);
+        const int id = mask(n) ? ids(n) : no_id;
+        const int old = indexed_id(n);
+        if (old != no_id && old != id) {
+          const auto r = index.find(old);
+          if (index.valid_at(r) && index.value_at(r) == n) index.erase(old);
         }
       });
+  index.end_erase();
+
+  // Retry with more room if the map ran full
+  do {
+    if (id_index_.failed_insert()) id_index_.rehash(2 * id_index_.capacity());
+    index = id_index_;
+    pmb->par_for(
+        PARTHENON_AUTO_LABEL, 0, nupdate - 1, KOKKOS_LAMBDA(const int m) {
+          const int n = all ? m : dirty(m);
+          if (!mask(n)) return;
+          const auto r = index.insert(ids(n), n);
+          if (r.existing()) index.value_at(r.index()) = n;
+        });
+  } while (id_index_.failed_insert());
 
-  auto &int_vector = std::get<getType<int>()>(vectors_);
-  auto &real_vector = std::get<getType<Real>()>(vectors_);
-  PackIndexMap real_imap;
-  PackIndexMap int_imap;
-  auto vreal = PackAllVariables_<Real>(real_imap);
-  auto vint = PackAllVariables_<int>(int_imap);
-  int real_vars_size = real_vector.size();
-  int int_vars_size = int_vector.size();
-  auto real_map = real_imap.Map();
-  auto int_map = int_imap.Map();
-  const int realPackDim = vreal.GetDim(2);
-  const int intPackDim = vint.GetDim(2);
+  pmb->par_for(
+      PARTHENON_AUTO_LABEL, 0, nupdate - 1, KOKKOS_LAMBDA(const int m) {
+        const int n = all ? m : dirty(m);
+        indexed_id(n) = mask(n) ? ids(n) : no_id;
+      });
 
+  id_index_dirty_.clear();
+  id_index_all_dirty_ = false;
+}
+
+void Swarm::FindParticles(const ParArray1D<int> &ids, const ParArray1D<int> &indices) {
+  PARTHENON_REQUIRE_THROWS(HasIdIndex(),
+                           "Swarm " + label_ + " has no ParticleId variable");
+  auto pmb = GetBlockPointer();
+  const auto &index = GetIdIndex();
   pmb->par_for(
-      PARTHENON_AUTO_LABEL, 0, max_active_index_, KOKKOS_LAMBDA(const int n) {
-        if (from_to_indices(n) >= 0) {
-          for (int vidx = 0; vidx < realPackDim; vidx++) {
-            vreal(vidx, from_to_indices(n)) = vreal(vidx, n);
-          }
-          for (int vidx = 0; vidx < intPackDim; vidx++) {
-            vint(vidx, from_to_indices(n)) = vint(vidx, n);
-          }
-        }
+      PARTHENON_AUTO_LABEL, 0, ids.extent_int(0) - 1, KOKKOS_LAMBDA(const int q) {
+        const auto r = index.find(ids(q));
+        indices(q) = index.valid_at(r) ? index.value_at(r) : -1;
       });
+}
 
-  // Update max_active_index_
-  max_active_index_ = num_active_ - 1;
+void Swarm::Defrag() {
+  if (GetNumActive() == 0) {
+    return;
+  }
+  // Particles above num_active_ are moved into the holes below it, which are exactly
+  // as many. Holes and particles to move are ranked by parallel scans over the mask so
+  // that everything stays on device: the lowest hole receives the highest particle.
+  auto pmb = GetBlockPointer();
+  const auto d = GetDefragInfo();
+
+  pmb->par_scan(
+      PARTHENON_AUTO_LABEL, 0, d.num_active - 1,
+      KOKKOS_LAMBDA(const int n, int &rank, const bool final) {
+        d.FindHole(n, rank, final);
+      });
+  if (d.max_active_index >= d.num_active) {
+    pmb->par_scan(
+        PARTHENON_AUTO_LABEL, 0, d.max_active_index - d.num_active,
+        KOKKOS_LAMBDA(const int nn, int &rank, const bool final) {
+          d.MoveToHole(nn, rank, final);
+        });
+  }
+
+  UpdateIndicesAfterDefrag();
 }
 
 ///
@@ -409,6 +584,9 @@ void Swarm::Defrag() {
 ///  (SwarmKey::swarm_index_) cell_sorted_begin_: Per-cell array of starting indices in
 ///  cell_sorted_ cell_sorted_number_: Per-cell array of number of particles in each cell
 ///
+/// This is a counting sort over cells, the order of the particles within a cell is
+/// arbitrary.
+///
 void Swarm::SortParticlesByCell() {
   auto pmb = GetBlockPointer();
 
@@ -419,103 +597,140 @@ void Swarm::SortParticlesByCell() {
   const int nx1 = pmb->cellbounds.ncellsi(IndexDomain::entire);
   const int nx2 = pmb->cellbounds.ncellsj(IndexDomain::entire);
   const int nx3 = pmb->cellbounds.ncellsk(IndexDomain::entire);
-  PARTHENON_REQUIRE(nx1 * nx2 * nx3 < std::numeric_limits<int>::max(),
+  PARTHENON_REQUIRE(static_cast<std::int64_t>(nx1) * nx2 * nx3 <
+                        std::numeric_limits<int>::max(),
                     "Too many cells for an int32 to store cell_idx_1d below!");
-
-  auto cell_sorted = cell_sorted_;
-  int ncells = pmb->cellbounds.GetTotal(IndexDomain::entire);
-  int num_active = num_active_;
-  int max_active_index = max_active_index_;
+  const int ncells = nx1 * nx2 * nx3;
 
   // Allocate data if necessary
   if (cell_sorted_begin_.GetDim(1) == 0) {
     cell_sorted_begin_ = ParArrayND<int>("cell_sorted_begin_", nx3, nx2, nx1);
     cell_sorted_number_ = ParArrayND<int>("cell_sorted_number_", nx3, nx2, nx1);
   }
+  auto cell_sorted = cell_sorted_;
   auto cell_sorted_begin = cell_sorted_begin_;
   auto cell_sorted_number = cell_sorted_number_;
+  auto sorted_cell_idx = sorted_cell_idx_;
   auto swarm_d = GetDeviceContext();
 
-  // Write an unsorted list
-  pmb->par_for(
-      PARTHENON_AUTO_LABEL, 0, max_active_index_, KOKKOS_LAMBDA(const int n) {
-        int i, j, k;
-        swarm_d.Xtoijk(x(n), y(n), z(n), i, j, k);
-        const int64_t cell_idx_1d = i + nx1 * (j + nx2 * k);
-        cell_sorted(n) = SwarmKey(static_cast<int>(cell_idx_1d), n);
-      });
-
-  sort(cell_sorted, SwarmKeyComparator(), 0, max_active_index);
+  // Cover the particles that were active at the last sort as well
+  const int max_index = std::max(max_active_index_, sorted_max_active_index_);
+
+  // The sorted list is still valid if every particle is in the same cell as at the last
+  // sort and every inactive index was inactive then as well
+  if (cell_sorted_valid_) {
+    int nchanged = 0;
+    pmb->par_reduce(
+        PARTHENON_AUTO_LABEL, 0, max_index,
+        KOKKOS_LAMBDA(const int n, int &changed) {
+          int cell_idx_1d = -1;
+          if (swarm_d.IsActive(n)) {
+            int i, j, k;
+            swarm_d.Xtoijk(x(n), y(n), z(n), i, j, k);
+            cell_idx_1d = i + nx1 * (j + nx2 * k);
+          }
+          if (cell_idx_1d != sorted_cell_idx(n)) changed++;
+        },
+        Kokkos::Sum<int>(nchanged));
+    if (nchanged == 0) return;
+  }
 
-  // Update per-cell arrays for easier accessing later
+  // Count the particles per cell
   const IndexRange &ib = pmb->cellbounds.GetBoundsI(IndexDomain::entire);
   const IndexRange &jb = pmb->cellbounds.GetBoundsJ(IndexDomain::entire);
   const IndexRange &kb = pmb->cellbounds.GetBoundsK(IndexDomain::entire);
   pmb->par_for(
       PARTHENON_AUTO_LABEL, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
       KOKKOS_LAMBDA(const int k, const int j, const int i) {
-        int cell_idx_1d = i + nx1 * (j + nx2 * k);
-        // Find starting index, first by guessing
-        int start_index =
-            static_cast<int>((cell_idx_1d * static_cast<Real>(num_active) / ncells));
-        int n = 0;
-        while (true) {
-          n++;
-          // Check if we left the list
-          if (start_index < 0 || start_index > max_active_index) {
-            start_index = -1;
-            break;
-          }
+        cell_sorted_number(k, j, i) = 0;
+      });
+  pmb->par_for(
+      PARTHENON_AUTO_LABEL, 0, max_index, KOKKOS_LAMBDA(const int n) {
+        if (swarm_d.IsActive(n)) {
+          int i, j, k;
+          swarm_d.Xtoijk(x(n), y(n), z(n), i, j, k);
+          sorted_cell_idx(n) = i + nx1 * (j + nx2 * k);
+          Kokkos::atomic_increment(&cell_sorted_number(k, j, i));
+        } else {
+          sorted_cell_idx(n) = -1;
+        }
+      });
 
-          if (cell_sorted(start_index).cell_idx_1d_ == cell_idx_1d) {
-            if (start_index == 0) {
-              break;
-            } else if (cell_sorted(start_index - 1).cell_idx_1d_ != cell_idx_1d) {
-              break;
-            } else {
-              start_index--;
-              continue;
-            }
-          }
-          if (cell_sorted(start_index).cell_idx_1d_ >= cell_idx_1d) {
-            start_index--;
-            if (start_index < 0) {
-              start_index = -1;
-              break;
-            }
-            if (cell_sorted(start_index).cell_idx_1d_ < cell_idx_1d) {
-              start_index = -1;
-              break;
-            }
-            continue;
+  // Starting index of every cell, the counts are reset to be used as cursors below
+  pmb->par_scan(
+      PARTHENON_AUTO_LABEL, 0, ncells - 1,
+      KOKKOS_LAMBDA(const int cell_idx_1d, int &offset, const bool final) {
+        const int i = cell_idx_1d % nx1;
+        const int j = (cell_idx_1d / nx1) % nx2;
+        const int k = cell_idx_1d / (nx1 * nx2);
+        const int number = cell_sorted_number(k, j, i);
+        if (final) {
+          cell_sorted_begin(k, j, i) = (number > 0) ? offset : -1;
+          cell_sorted_number(k, j, i) = 0;
+        }
+        offset += number;
+      });
+
+  // Place every particle in its cell
+  pmb->par_for(
+      PARTHENON_AUTO_LABEL, 0, max_index, KOKKOS_LAMBDA(const int n) {
+        const int cell_idx_1d = sorted_cell_idx(n);
+        if (cell_idx_1d >= 0) {
+          const int i = cell_idx_1d % nx1;
+          const int j = (cell_idx_1d / nx1) % nx2;
+          const int k = cell_idx_1d / (nx1 * nx2);
+          const int slot = Kokkos::atomic_fetch_add(&cell_sorted_number(k, j, i), 1);
+          cell_sorted(cell_sorted_begin(k, j, i) + slot) = SwarmKey(cell_idx_1d, n);
+        }
+      });
+
+  cell_sorted_valid_ = true;
+  sorted_max_active_index_ = max_active_index_;
+}
+
+void Swarm::ReorderParticlesByCell() {
+  SortParticlesByCell();
+  if (GetNumActive() == 0) {
+    return;
+  }
+  auto pmb = GetBlockPointer();
+  const auto d = GetDefragInfo();
+  auto cell_sorted = cell_sorted_;
+  auto sorted_cell_idx = sorted_cell_idx_;
+
+  // Gather into temporary storage in cell order and copy back to the front of the pool
+  ParArray2D<Real> real_tmp("ReorderParticlesByCell real", d.nreal, d.num_active);
+  ParArray2D<int> int_tmp("ReorderParticlesByCell int", d.nint, d.num_active);
+  pmb->par_for(
+      PARTHENON_AUTO_LABEL, 0, d.num_active - 1, KOKKOS_LAMBDA(const int p) {
+        const int n = cell_sorted(p).swarm_idx_;
+        for (int vidx = 0; vidx < d.nreal; vidx++) {
+          real_tmp(vidx, p) = d.vreal(vidx, n);
+        }
+        for (int vidx = 0; vidx < d.nint; vidx++) {
+          int_tmp(vidx, p) = d.vint(vidx, n);
+        }
+      });
+  pmb->par_for(
+      PARTHENON_AUTO_LABEL, 0, d.max_active_index, KOKKOS_LAMBDA(const int p) {
+        if (p < d.num_active) {
+          for (int vidx = 0; vidx < d.nreal; vidx++) {
+            d.vreal(vidx, p) = real_tmp(vidx, p);
           }
-          if (cell_sorted(start_index).cell_idx_1d_ < cell_idx_1d) {
-            start_index++;
-            if (start_index > max_active_index) {
-              start_index = -1;
-              break;
-            }
-            if (cell_sorted(start_index).cell_idx_1d_ > cell_idx_1d) {
-              start_index = -1;
-              break;
-            }
-            continue;
+          for (int vidx = 0; vidx < d.nint; vidx++) {
+            d.vint(vidx, p) = int_tmp(vidx, p);
           }
-        }
-        cell_sorted_begin(k, j, i) = start_index;
-        if (start_index == -1) {
-          cell_sorted_number(k, j, i) = 0;
+          d.mask(p) = true;
+          cell_sorted(p).swarm_idx_ = p;
+          sorted_cell_idx(p) = cell_sorted(p).cell_idx_1d_;
         } else {
-          int number = 0;
-          int current_index = start_index;
-          while (current_index <= max_active_index &&
-                 cell_sorted(current_index).cell_idx_1d_ == cell_idx_1d) {
-            current_index++;
-            number++;
-            cell_sorted_number(k, j, i) = number;
-          }
+          d.mask(p) = false;
+          sorted_cell_idx(p) = -1;
         }
       });
+
+  UpdateIndicesAfterDefrag();
+  sorted_max_active_index_ = max_active_index_;
 }
 
 } // namespace parthenon
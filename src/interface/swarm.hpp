@@ -19,6 +19,7 @@
 
 #include <array>
 #include <cstdint>
+#include <limits>
 #include <list>
 #include <map>
 #include <memory>
@@ -30,6 +31,8 @@
 #include <utility>
 #include <vector>
 
+#include <Kokkos_UnorderedMap.hpp>
+
 #include "basic_types.hpp"
 #include "bvals/bvals.hpp"
 #include "globals.hpp" // my_rank
@@ -71,7 +74,55 @@ class NewParticlesContext {
   ParArray1D<int> new_indices_;
 };
 
+// Views and sizes needed to defragment a swarm on device, returned by
+// Swarm::GetDefragInfo. Particles above num_active are moved into the holes below it,
+// which are exactly as many. FindHole has to be scanned over [0, num_active) to collect
+// the holes before MoveToHole is scanned over [0, max_active_index - num_active]. The
+// lowest hole receives the highest particle.
+struct SwarmDefragInfo {
+  ParArray1D<bool> mask;
+  ParArray1D<int> holes;
+  SwarmVariablePack<Real> vreal;
+  SwarmVariablePack<int> vint;
+  int nreal, nint; // number of real and int variables in the packs
+  int num_active;
+  int max_active_index;
+
+  KOKKOS_INLINE_FUNCTION
+  void FindHole(const int n, int &rank, const bool final) const {
+    if (!mask(n)) {
+      if (final) holes(rank) = n;
+      rank++;
+    }
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  void MoveToHole(const int nn, int &rank, const bool final) const {
+    const int n = max_active_index - nn;
+    if (mask(n)) {
+      if (final) {
+        const int to = holes(rank);
+        for (int vidx = 0; vidx < nreal; vidx++) {
+          vreal(vidx, to) = vreal(vidx, n);
+        }
+        for (int vidx = 0; vidx < nint; vidx++) {
+          vint(vidx, to) = vint(vidx, n);
+        }
+        mask(to) = true;
+        mask(n) = false;
+      }
+      rank++;
+    }
+  }
+};
+
+// Device hash map from particle id to particle index, see Swarm::GetIdIndex
+using ParticleIdIndex = Kokkos::UnorderedMap<int, int, DevMemSpace>;
+
 class MeshBlock;
+namespace forest {
+class BlockLocator;
+} // namespace forest
 
 enum class PARTICLE_STATUS { UNALLOCATED, ALIVE, DEAD };
 
@@ -166,6 +217,32 @@ class Swarm {
   /// Set max pool size
   void setPoolMax(const std::int64_t nmax_pool);
 
+  /// Make room for num_to_add more particles, growing the pool by at least a factor of
+  /// two if it has to grow
+  void ReservePool(const int num_to_add);
+
+  /// Shrink the pool to nmax_pool, but not below the number of active particles.
+  /// Defragments first if active particles lie beyond the new size.
+  void ShrinkPool(const std::int64_t nmax_pool);
+
+  /// Capacity management, meant to be called once per cycle. Reserves room for as many
+  /// particles as were received since the last call, and shrinks the pool to twice the
+  /// number of active particles (but not below its initial size) once the occupancy
+  /// has been below the shrink occupancy for the given number of consecutive calls.
+  void UpdatePoolCapacity();
+
+  /// Set the hysteresis of UpdatePoolCapacity, an occupancy <= 0 disables shrinking
+  void SetPoolShrinkPolicy(const Real occupancy, const int ncalls) {
+    pool_shrink_occupancy_ = occupancy;
+    pool_shrink_calls_ = ncalls;
+  }
+
+  /// Current pool size
+  int GetPoolMax() const { return nmax_pool_; }
+
+  /// Bytes held by the particle variables and the per particle bookkeeping arrays
+  std::uint64_t GetMemoryUsage() const;
+
   /// Check whether metadata bit is set
   bool IsSet(const MetadataFlag bit) const { return m_.IsSet(bit); }
 
@@ -180,7 +257,10 @@ class Swarm {
 
   /// Get the quality of the data layout. 1 is perfectly organized, < 1
   /// indicates gaps in the list.
-  Real GetPackingEfficiency() const { return num_active_ / (max_active_index_ + 1); }
+  Real GetPackingEfficiency() const {
+    if (max_active_index_ < 0) return 1.0;
+    return num_active_ / static_cast<Real>(max_active_index_ + 1);
+  }
 
   /// Remove particles marked for removal and update internal indexing
   void RemoveMarkedParticles();
@@ -192,10 +272,37 @@ class Swarm {
   /// memory
   void Defrag();
 
+  /// Views and sizes used by the defragmentation kernels, and the host side update of
+  /// the indexing once a kernel has compacted the particles. These let DefragSwarms
+  /// defragment the swarms of many blocks in one kernel launch.
+  SwarmDefragInfo GetDefragInfo();
+  void UpdateIndicesAfterDefrag();
+
   /// Sort particle list by cell each particle belongs to, according to 1D cell
-  /// index (i + nx*(j + ny*k))
+  /// index (i + nx*(j + ny*k)). Does nothing if no particle was added, removed, moved in
+  /// memory or moved to another cell since the last sort.
   void SortParticlesByCell();
 
+  /// Sort particles by cell and reorder the particle data in memory to match, so that
+  /// particles in the same cell are contiguous starting from the 0 index. Like Defrag,
+  /// this changes the indices of the particles.
+  void ReorderParticlesByCell();
+
+  /// Index from the values of the integer variable flagged Metadata::ParticleId, which
+  /// have to be unique within the swarm, to particle indices. AddEmptyParticles and
+  /// RemoveMarkedParticles record the particles they touch and defragmentation flags
+  /// all of them, UpdateIdIndex only revisits those. New particles are indexed once
+  /// their ids are set and the index is updated.
+  bool HasIdIndex() const { return !id_index_var_.empty(); }
+  void UpdateIdIndex();
+  const ParticleIdIndex &GetIdIndex() {
+    UpdateIdIndex();
+    return id_index_;
+  }
+
+  /// Indices of the particles with the given ids, -1 for ids not in this swarm
+  void FindParticles(const ParArray1D<int> &ids, const ParArray1D<int> &indices);
+
   // used in case of swarm boundary communication
   void SetupPersistentMPI();
   std::shared_ptr<BoundarySwarm> vbswarm;
@@ -223,6 +330,18 @@ class Swarm {
 
   bool FinalizeCommunicationIterative();
 
+  // Steps of TransferSwarmParticles, which moves particles to any block of the mesh.
+  // Count the particles leaving this block (the b-th on this rank) in counts(b, rank)
+  // by destination rank, pack them into buffer starting at offsets(b, rank) and remove
+  // them, and add the count particles listed in order starting at begin.
+  void CountParticlesToTransfer(const forest::BlockLocator &locator,
+                                const ParArray2D<int> &counts, int b);
+  void PackParticlesToTransfer(const forest::BlockLocator &locator,
+                               const ParArray2D<int> &offsets, int b,
+                               const BufArray1D<Real> &buffer);
+  void UnpackTransferredParticles(const BufArray1D<Real> &buffer,
+                                  const ParArray1D<int> &order, int begin, int count);
+
   template <class T>
   SwarmVariablePack<T> PackVariables(const std::vector<std::string> &name,
                                      PackIndexMap &vmap);
@@ -231,7 +350,7 @@ class Swarm {
   int num_particles_sent_;
   bool finished_transport;
 
-  void LoadBuffers_(const int max_indices_size);
+  void LoadBuffers_();
   void UnloadBuffers_();
 
   int CountParticlesToSend_(); // Must be public for launching kernel
@@ -251,6 +370,12 @@ class Swarm {
 
   void SetNeighborIndices_();
 
+  void EnableIdIndex_(const std::string &label);
+  // Mark a particle index as changed, or all of them after particles moved in memory
+  void MarkIdIndexDirty_(const int n) {
+    if (HasIdIndex()) id_index_dirty_.push_back(n);
+  }
+
   void CountReceivedParticles_();
   void UpdateNeighborBufferReceiveIndices_(ParArray1D<int> &neighbor_index,
                                            ParArray1D<int> &buffer_index);
@@ -268,11 +393,35 @@ class Swarm {
   std::string label_;
   Metadata m_;
   int nmax_pool_;
+  int nmax_pool_min_; // ShrinkPool never goes below the initial pool size
   std::string info_;
   std::tuple<ParticleVariableVector<int>, ParticleVariableVector<Real>> vectors_;
 
   std::tuple<MapToParticle<int>, MapToParticle<Real>> maps_;
 
+  // All variables of a type share one allocation of shape (components, pool stride),
+  // the data of every ParticleVariable is an unmanaged view into it. The stride is
+  // nmax_pool_ padded to pool_padding_ particles, so that every component starts on a
+  // vector width boundary, and the variables have that extent in the particle index.
+  std::tuple<ParArray2D<int>, ParArray2D<Real>> pools_;
+  constexpr static int pool_padding_ = 16;
+  static int PoolStride_(const int nmax_pool) {
+    return (nmax_pool + pool_padding_ - 1) / pool_padding_ * pool_padding_;
+  }
+  // Resize everything that is sized by the pool, the free indices have to be updated by
+  // the caller
+  void ResizePool_(const std::int64_t nmax_pool);
+
+  Real pool_shrink_occupancy_ = 0.125;
+  int pool_shrink_calls_ = 10;
+  int low_occupancy_calls_ = 0;
+  int num_received_since_update_ = 0;
+
+  // Reallocate the pool of type T for nmax_pool particles, copy over the data of all
+  // variables of type T and point them at the new pool
+  template <class T>
+  void RebuildPool_(const int nmax_pool);
+
   std::list<int> free_indices_;
   ParArray1D<bool> mask_;
   ParArray1D<bool> marked_for_removal_;
@@ -282,8 +431,8 @@ class Swarm {
   ParArray1D<int> new_indices_;     // Persistent array that provides the new indices when
                                     // AddEmptyParticles is called. Always defragmented.
   int new_indices_max_idx_;         // Maximum valid index of new_indices_ array.
-  ParArray1D<int> from_to_indices_; // Array used for sorting particles during defragment
-                                    // step (size nmax_pool + 1).
+  ParArray1D<int> from_to_indices_; // Array used for collecting the holes to fill during
+                                    // defragment step (size nmax_pool + 1).
   ParArray1D<int> recv_neighbor_index_; // Neighbor indices for received particles
   ParArray1D<int> recv_buffer_index_;   // Buffer indices for received particles
 
@@ -292,7 +441,7 @@ class Swarm {
   constexpr static int unset_index_ = -1;
 
   ParArray1D<int> num_particles_to_send_;
-  ParArrayND<int> particle_indices_to_send_;
+  ParArray1D<int> send_buffer_index_; // Slot of each particle in its send buffer
 
   std::vector<int> neighbor_received_particles_;
   int total_received_particles_;
@@ -308,6 +457,18 @@ class Swarm {
   ParArrayND<int>
       cell_sorted_number_; // Per-cell array of number of particles in each cell
 
+  ParArray1D<int> sorted_cell_idx_; // 1D cell index of each particle at the last sort,
+                                    // -1 for inactive particles
+  int sorted_max_active_index_ = inactive_max_active_index;
+  bool cell_sorted_valid_ = false; // Whether sorted_cell_idx_ describes cell_sorted_
+
+  std::string id_index_var_; // Empty if there is no id index
+  ParticleIdIndex id_index_;
+  ParArray1D<int> indexed_id_;       // Id of each particle index in id_index_, or no_id_
+  std::vector<int> id_index_dirty_;  // Particle indices changed since the last update
+  bool id_index_all_dirty_ = false;  // Particles were moved in memory
+  constexpr static int no_id_ = std::numeric_limits<int>::min();
+
  public:
   bool mpiStatus;
 };
@@ -367,6 +528,7 @@ inline void Swarm::Add_(const std::string &label, const Metadata &m) {
 
   std::get<getType<T>()>(vectors_).push_back(var);
   std::get<getType<T>()>(maps_)[label] = var;
+  RebuildPool_<T>(nmax_pool_);
 }
 
 using SP_Swarm = std::shared_ptr<Swarm>;
@@ -17,6 +17,7 @@
 #include <utility>
 #include <vector>
 
+#include "mesh/forest/block_locator.hpp"
 #include "mesh/mesh.hpp"
 #include "swarm.hpp"
 #include "swarm_default_names.hpp"
@@ -189,88 +190,33 @@ void Swarm::SetupPersistentMPI() {
 }
 
 int Swarm::CountParticlesToSend_() {
-  auto mask_h = Kokkos::create_mirror_view_and_copy(HostMemSpace(), mask_);
   auto swarm_d = GetDeviceContext();
   auto pmb = GetBlockPointer();
-  const int nbmax = vbswarm->bd_var_.nbmax;
-
-  // Fence to make sure particles aren't currently being transported locally
-  // TODO(BRR) do this operation on device.
-  pmb->exec_space.fence();
-  auto num_particles_to_send_h = num_particles_to_send_.GetHostMirror();
-  for (int n = 0; n < pmb->neighbors.size(); n++) {
-    num_particles_to_send_h(n) = 0;
-  }
   const int particle_size = GetParticleDataSize();
   vbswarm->particle_size = particle_size;
 
-  // TODO(BRR) This kernel launch should be folded into the subsequent logic once we
-  // convert that to kernel-based reductions
+  // Find the neighbor of every particle and its slot in the send buffer to that
+  // neighbor. The slot order within a buffer is arbitrary, only the counts per neighbor
+  // are needed on host.
   auto &x = Get<Real>(swarm_position::x::name()).Get();
   auto &y = Get<Real>(swarm_position::y::name()).Get();
   auto &z = Get<Real>(swarm_position::z::name()).Get();
-  const int max_active_index = GetMaxActiveIndex();
+  auto num_particles_to_send = num_particles_to_send_;
+  auto send_buffer_index = send_buffer_index_;
+  Kokkos::deep_copy(pmb->exec_space, num_particles_to_send, 0);
   pmb->par_for(
-      PARTHENON_AUTO_LABEL, 0, max_active_index, KOKKOS_LAMBDA(const int n) {
+      PARTHENON_AUTO_LABEL, 0, max_active_index_, KOKKOS_LAMBDA(const int n) {
         if (swarm_d.IsActive(n)) {
           bool on_current_mesh_block = true;
-          swarm_d.GetNeighborBlockIndex(n, x(n), y(n), z(n), on_current_mesh_block);
+          const int m =
+              swarm_d.GetNeighborBlockIndex(n, x(n), y(n), z(n), on_current_mesh_block);
+          if (m >= 0) {
+            send_buffer_index(n) = Kokkos::atomic_fetch_add(&num_particles_to_send(m), 1);
+          }
         }
       });
 
-  int max_indices_size = 0;
-  int total_noblock_particles = 0;
-  auto block_index_h = block_index_.GetHostMirrorAndCopy();
-  for (int n = 0; n <= max_active_index_; n++) {
-    if (mask_h(n)) {
-      // This particle should be sent
-      if (block_index_h(n) >= 0) {
-        num_particles_to_send_h(block_index_h(n))++;
-        if (max_indices_size < num_particles_to_send_h(block_index_h(n))) {
-          max_indices_size = num_particles_to_send_h(block_index_h(n));
-        }
-      }
-      if (block_index_h(n) == no_block_) {
-        total_noblock_particles++;
-      }
-    }
-  }
-  // Size-0 arrays not permitted but we don't want to short-circuit subsequent logic
-  // that indicates completed communications
-  max_indices_size = std::max<int>(1, max_indices_size);
-
-  // Not a ragged-right array, just for convenience
-  if (total_noblock_particles > 0) {
-    auto noblock_indices =
-        ParArray1D<int>("Particles with no block", total_noblock_particles);
-    auto noblock_indices_h = noblock_indices.GetHostMirror();
-    int counter = 0;
-    for (int n = 0; n <= max_active_index_; n++) {
-      if (mask_h(n)) {
-        if (block_index_h(n) == no_block_) {
-          noblock_indices_h(counter) = n;
-          counter++;
-        }
-      }
-    }
-    noblock_indices.DeepCopy(noblock_indices_h);
-  }
-
-  // TODO(BRR) don't allocate dynamically
-  particle_indices_to_send_ =
-      ParArrayND<int>("Particle indices to send", nbmax, max_indices_size);
-  auto particle_indices_to_send_h = particle_indices_to_send_.GetHostMirror();
-  std::vector<int> counter(nbmax, 0);
-  for (int n = 0; n <= max_active_index_; n++) {
-    if (mask_h(n)) {
-      if (block_index_h(n) >= 0) {
-        particle_indices_to_send_h(block_index_h(n), counter[block_index_h(n)]) = n;
-        counter[block_index_h(n)]++;
-      }
-    }
-  }
-  num_particles_to_send_.DeepCopy(num_particles_to_send_h);
-  particle_indices_to_send_.DeepCopy(particle_indices_to_send_h);
+  auto num_particles_to_send_h = num_particles_to_send_.GetHostMirrorAndCopy();
 
   num_particles_sent_ = 0;
   for (int n = 0; n < pmb->neighbors.size(); n++) {
@@ -285,17 +231,14 @@ int Swarm::CountParticlesToSend_() {
     num_particles_sent_ += num_particles_to_send_h(n);
   }
 
-  return max_indices_size;
+  return num_particles_sent_;
 }
 
-void Swarm::LoadBuffers_(const int max_indices_size) {
+void Swarm::LoadBuffers_() {
   auto swarm_d = GetDeviceContext();
   auto pmb = GetBlockPointer();
   const int particle_size = GetParticleDataSize();
-  const int nneighbor = pmb->neighbors.size();
 
-  auto &int_vector = std::get<getType<int>()>(vectors_);
-  auto &real_vector = std::get<getType<Real>()>(vectors_);
   PackIndexMap real_imap;
   PackIndexMap int_imap;
   auto vreal = PackAllVariables_<Real>(real_imap);
@@ -307,26 +250,22 @@ void Swarm::LoadBuffers_(const int max_indices_size) {
   // [variable start] [swarm idx]
 
   auto &bdvar = vbswarm->bd_var_;
-  auto num_particles_to_send = num_particles_to_send_;
-  auto particle_indices_to_send = particle_indices_to_send_;
+  auto block_index = block_index_;
+  auto send_buffer_index = send_buffer_index_;
   auto neighbor_buffer_index = neighbor_buffer_index_;
   pmb->par_for(
-      PARTHENON_AUTO_LABEL, 0, max_indices_size - 1,
-      KOKKOS_LAMBDA(const int n) {            // Max index
-        for (int m = 0; m < nneighbor; m++) { // Number of neighbors
-          const int bufid = neighbor_buffer_index(m);
-          if (n < num_particles_to_send(m)) {
-            const int sidx = particle_indices_to_send(m, n);
-            int buffer_index = n * particle_size;
-            swarm_d.MarkParticleForRemoval(sidx);
-            for (int i = 0; i < realPackDim; i++) {
-              bdvar.send[bufid](buffer_index) = vreal(i, sidx);
-              buffer_index++;
-            }
-            for (int i = 0; i < intPackDim; i++) {
-              bdvar.send[bufid](buffer_index) = static_cast<Real>(vint(i, sidx));
-              buffer_index++;
-            }
+      PARTHENON_AUTO_LABEL, 0, max_active_index_, KOKKOS_LAMBDA(const int n) {
+        if (swarm_d.IsActive(n) && block_index(n) >= 0) {
+          const int bufid = neighbor_buffer_index(block_index(n));
+          int buffer_index = send_buffer_index(n) * particle_size;
+          swarm_d.MarkParticleForRemoval(n);
+          for (int i = 0; i < realPackDim; i++) {
+            bdvar.send[bufid](buffer_index) = vreal(i, n);
+            buffer_index++;
+          }
+          for (int i = 0; i < intPackDim; i++) {
+            bdvar.send[bufid](buffer_index) = static_cast<Real>(vint(i, n));
+            buffer_index++;
           }
         }
       });
@@ -373,10 +312,10 @@ void Swarm::Send(BoundaryCommSubset phase) {
     }
   } else {
     // Query particles for those to be sent
-    int max_indices_size = CountParticlesToSend_();
+    CountParticlesToSend_();
 
     // Prepare buffers for send operations
-    LoadBuffers_(max_indices_size);
+    LoadBuffers_();
 
     // Send buffer data
     vbswarm->Send(phase);
@@ -423,6 +362,7 @@ void Swarm::UnloadBuffers_() {
   auto pmb = GetBlockPointer();
 
   CountReceivedParticles_();
+  num_received_since_update_ += total_received_particles_;
 
   auto &bdvar = vbswarm->bd_var_;
 
@@ -524,6 +464,100 @@ bool Swarm::FinalizeCommunicationIterative() {
   return true;
 }
 
+void Swarm::CountParticlesToTransfer(const forest::BlockLocator &locator,
+                                     const ParArray2D<int> &counts, const int b) {
+  auto swarm_d = GetDeviceContext();
+  auto pmb = GetBlockPointer();
+  const int gid = pmb->gid;
+  auto &x = Get<Real>(swarm_position::x::name()).Get();
+  auto &y = Get<Real>(swarm_position::y::name()).Get();
+  auto &z = Get<Real>(swarm_position::z::name()).Get();
+  auto send_buffer_index = send_buffer_index_;
+  pmb->par_for(
+      PARTHENON_AUTO_LABEL, 0, max_active_index_, KOKKOS_LAMBDA(const int n) {
+        if (swarm_d.IsActive(n)) {
+          const int dest = locator.FindGid(x(n), y(n), z(n));
+          if (dest >= 0 && dest != gid) {
+            send_buffer_index(n) =
+                Kokkos::atomic_fetch_add(&counts(b, locator.GetRank(dest)), 1);
+          }
+        }
+      });
+}
+
+void Swarm::PackParticlesToTransfer(const forest::BlockLocator &locator,
+                                    const ParArray2D<int> &offsets, const int b,
+                                    const BufArray1D<Real> &buffer) {
+  auto swarm_d = GetDeviceContext();
+  auto pmb = GetBlockPointer();
+  const int gid = pmb->gid;
+  const int stride = GetParticleDataSize() + 1;
+
+  PackIndexMap real_imap;
+  PackIndexMap int_imap;
+  auto vreal = PackAllVariables_<Real>(real_imap);
+  auto vint = PackAllVariables_<int>(int_imap);
+  const int realPackDim = vreal.GetDim(2);
+  const int intPackDim = vint.GetDim(2);
+
+  // Every particle is preceded by the gid of its destination. Positions are mapped back
+  // into the mesh across periodic boundaries, however far the particle moved.
+  auto &x = Get<Real>(swarm_position::x::name()).Get();
+  auto &y = Get<Real>(swarm_position::y::name()).Get();
+  auto &z = Get<Real>(swarm_position::z::name()).Get();
+  auto send_buffer_index = send_buffer_index_;
+  pmb->par_for(
+      PARTHENON_AUTO_LABEL, 0, max_active_index_, KOKKOS_LAMBDA(const int n) {
+        if (swarm_d.IsActive(n)) {
+          const int dest = locator.FindGid(x(n), y(n), z(n));
+          if (dest >= 0 && dest != gid) {
+            locator.ApplyPeriodicity(x(n), y(n), z(n));
+            int bid = (offsets(b, locator.GetRank(dest)) + send_buffer_index(n)) * stride;
+            buffer(bid++) = static_cast<Real>(dest);
+            for (int i = 0; i < realPackDim; i++) {
+              buffer(bid++) = vreal(i, n);
+            }
+            for (int i = 0; i < intPackDim; i++) {
+              buffer(bid++) = static_cast<Real>(vint(i, n));
+            }
+            swarm_d.MarkParticleForRemoval(n);
+          }
+        }
+      });
+
+  RemoveMarkedParticles();
+}
+
+void Swarm::UnpackTransferredParticles(const BufArray1D<Real> &buffer,
+                                       const ParArray1D<int> &order, const int begin,
+                                       const int count) {
+  if (count == 0) return;
+  auto pmb = GetBlockPointer();
+  auto newParticlesContext = AddEmptyParticles(count);
+  num_received_since_update_ += count;
+
+  PackIndexMap real_imap;
+  PackIndexMap int_imap;
+  auto vreal = PackAllVariables_<Real>(real_imap);
+  auto vint = PackAllVariables_<int>(int_imap);
+  const int realPackDim = vreal.GetDim(2);
+  const int intPackDim = vint.GetDim(2);
+  const int stride = GetParticleDataSize() + 1;
+
+  pmb->par_for(
+      PARTHENON_AUTO_LABEL, 0, newParticlesContext.GetNewParticlesMaxIndex(),
+      KOKKOS_LAMBDA(const int n) {
+        const int sid = newParticlesContext.GetNewParticleIndex(n);
+        int bid = order(begin + n) * stride + 1;
+        for (int i = 0; i < realPackDim; i++) {
+          vreal(i, sid) = buffer(bid++);
+        }
+        for (int i = 0; i < intPackDim; i++) {
+          vint(i, sid) = static_cast<int>(buffer(bid++));
+        }
+      });
+}
+
 void Swarm::AllocateComms(std::weak_ptr<MeshBlock> wpmb) {
   if (wpmb.expired()) return;
 
@@ -10,12 +10,16 @@
 // license in this material to reproduce, prepare derivative works, distribute copies to
 // the public, perform publicly and display publicly, and to permit others to do so.
 //========================================================================================
+#include <algorithm>
 #include <cstdlib>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
 #include "globals.hpp" // my_rank
+#include "interface/mesh_data.hpp"
+#include "kokkos_abstraction.hpp"
 #include "mesh/mesh.hpp"
 #include "swarm_container.hpp"
 #include "utils/error_checking.hpp"
@@ -157,6 +161,14 @@ TaskStatus SwarmContainer::DefragAll() {
   return TaskStatus::complete;
 }
 
+TaskStatus SwarmContainer::UpdatePoolCapacity() {
+  PARTHENON_INSTRUMENT
+  for (auto &s : swarmVector_) {
+    s->UpdatePoolCapacity();
+  }
+  return TaskStatus::complete;
+}
+
 TaskStatus SwarmContainer::SortParticlesByCell() {
   PARTHENON_INSTRUMENT
 
@@ -167,6 +179,16 @@ TaskStatus SwarmContainer::SortParticlesByCell() {
   return TaskStatus::complete;
 }
 
+TaskStatus SwarmContainer::ReorderParticlesByCell() {
+  PARTHENON_INSTRUMENT
+
+  for (auto &s : swarmVector_) {
+    s->ReorderParticlesByCell();
+  }
+
+  return TaskStatus::complete;
+}
+
 void SwarmContainer::SendBoundaryBuffers() {}
 
 void SwarmContainer::SetupPersistentMPI() {
@@ -244,4 +266,210 @@ void SwarmContainer::Print() const {
   }
 }
 
+TaskStatus DefragSwarms(MeshData<Real> *md, const double min_occupancy) {
+  PARTHENON_INSTRUMENT
+  PARTHENON_REQUIRE_THROWS(min_occupancy >= 0. && min_occupancy <= 1.,
+                           "Max fractional occupancy of swarm must be >= 0 and <= 1");
+
+  std::vector<std::shared_ptr<Swarm>> swarms;
+  for (int b = 0; b < md->NumBlocks(); b++) {
+    for (auto &s : md->GetSwarmData(b)->GetSwarmVector()) {
+      if (s->GetNumActive() > 0 &&
+          s->GetNumActive() / (s->GetMaxActiveIndex() + 1.0) < min_occupancy) {
+        swarms.push_back(s);
+      }
+    }
+  }
+  if (swarms.empty()) return TaskStatus::complete;
+
+  ParArray1D<SwarmDefragInfo> info("DefragSwarms info", swarms.size());
+  auto info_h = Kokkos::create_mirror_view(info);
+  for (int n = 0; n < swarms.size(); n++) {
+    info_h(n) = swarms[n]->GetDefragInfo();
+  }
+  Kokkos::deep_copy(info, info_h);
+
+  // One team per swarm, see SwarmDefragInfo
+  par_for_outer(
+      DEFAULT_OUTER_LOOP_PATTERN, PARTHENON_AUTO_LABEL, DevExecSpace(), 0, 0, 0,
+      swarms.size() - 1, KOKKOS_LAMBDA(team_mbr_t member, const int n) {
+        const auto &d = info(n);
+        Kokkos::parallel_scan(
+            Kokkos::TeamThreadRange<>(member, d.num_active),
+            [&](const int m, int &rank, const bool final) {
+              d.FindHole(m, rank, final);
+            });
+        member.team_barrier();
+        const int nmove = d.max_active_index + 1 - d.num_active;
+        Kokkos::parallel_scan(
+            Kokkos::TeamThreadRange<>(member, nmove),
+            [&](const int m, int &rank, const bool final) {
+              d.MoveToHole(m, rank, final);
+            });
+      });
+
+  for (auto &s : swarms) {
+    s->UpdateIndicesAfterDefrag();
+  }
+  return TaskStatus::complete;
+}
+
+TaskStatus SortSwarmsByCell(MeshData<Real> *md) {
+  PARTHENON_INSTRUMENT
+  for (int b = 0; b < md->NumBlocks(); b++) {
+    md->GetSwarmData(b)->SortParticlesByCell();
+  }
+  return TaskStatus::complete;
+}
+
+TaskStatus SendSwarms(MeshData<Real> *md, BoundaryCommSubset phase) {
+  PARTHENON_INSTRUMENT
+  for (int b = 0; b < md->NumBlocks(); b++) {
+    md->GetSwarmData(b)->Send(phase);
+  }
+  return TaskStatus::complete;
+}
+
+TaskStatus ReceiveSwarms(MeshData<Real> *md, BoundaryCommSubset phase) {
+  PARTHENON_INSTRUMENT
+  bool all_received = true;
+  for (int b = 0; b < md->NumBlocks(); b++) {
+    all_received =
+        (md->GetSwarmData(b)->Receive(phase) == TaskStatus::complete) && all_received;
+  }
+  return all_received ? TaskStatus::complete : TaskStatus::incomplete;
+}
+
+TaskStatus ResetSwarmCommunication(MeshData<Real> *md) {
+  PARTHENON_INSTRUMENT
+  for (int b = 0; b < md->NumBlocks(); b++) {
+    md->GetSwarmData(b)->ResetCommunication();
+  }
+  return TaskStatus::complete;
+}
+
+ParArray2D<int> FindSwarmParticles(MeshData<Real> *md, const std::string &swarm_name,
+                                   const ParArray1D<int> &ids) {
+  PARTHENON_INSTRUMENT
+  const int nids = ids.extent_int(0);
+  ParArray2D<int> found("FindSwarmParticles", 2, nids);
+  Kokkos::deep_copy(found, -1);
+  for (int b = 0; b < md->NumBlocks(); b++) {
+    auto swarm = md->GetSwarmData(b)->Get(swarm_name);
+    PARTHENON_REQUIRE_THROWS(swarm->HasIdIndex(),
+                             "Swarm " + swarm_name + " has no ParticleId variable");
+    const auto &index = swarm->GetIdIndex();
+    par_for(
+        PARTHENON_AUTO_LABEL, 0, nids - 1, KOKKOS_LAMBDA(const int q) {
+          const auto r = index.find(ids(q));
+          if (index.valid_at(r)) {
+            found(0, q) = b;
+            found(1, q) = index.value_at(r);
+          }
+        });
+  }
+  return found;
+}
+
+TaskStatus TransferSwarmParticles(Mesh *pm, const std::string &swarm_name) {
+  PARTHENON_INSTRUMENT
+  const auto &locator = pm->GetBlockLocator();
+  const auto &blocks = pm->block_list;
+  const int nblocks = blocks.size();
+  const int nranks = Globals::nranks;
+  auto get_swarm = [&](const int b) {
+    return blocks[b]->meshblock_data.Get()->GetSwarmData()->Get(swarm_name);
+  };
+  // Every particle is sent with the gid of its destination
+  const int stride = nblocks > 0 ? get_swarm(0)->GetParticleDataSize() + 1 : 1;
+
+  // The particles to each rank are contiguous in the send buffer, ordered by block
+  ParArray2D<int> counts("TransferSwarmParticles counts", std::max(nblocks, 1), nranks);
+  for (int b = 0; b < nblocks; b++) {
+    get_swarm(b)->CountParticlesToTransfer(locator, counts, b);
+  }
+  auto counts_h = counts.GetHostMirrorAndCopy();
+  ParArray2D<int> offsets("TransferSwarmParticles offsets", std::max(nblocks, 1), nranks);
+  auto offsets_h = offsets.GetHostMirror();
+  std::vector<int> send_counts(nranks), send_displs(nranks);
+  int nsend = 0;
+  for (int r = 0; r < nranks; r++) {
+    send_displs[r] = nsend;
+    for (int b = 0; b < nblocks; b++) {
+      offsets_h(b, r) = nsend;
+      nsend += counts_h(b, r);
+    }
+    send_counts[r] = nsend - send_displs[r];
+  }
+  offsets.DeepCopy(offsets_h);
+  BufArray1D<Real> send_buf("TransferSwarmParticles send", nsend * stride);
+  for (int b = 0; b < nblocks; b++) {
+    get_swarm(b)->PackParticlesToTransfer(locator, offsets, b, send_buf);
+  }
+
+  // A single exchange with all ranks, independent of how far particles moved
+  std::vector<int> recv_counts = send_counts;
+#ifdef MPI_PARALLEL
+  PARTHENON_MPI_CHECK(MPI_Alltoall(send_counts.data(), 1, MPI_INT, recv_counts.data(), 1,
+                                   MPI_INT, MPI_COMM_WORLD));
+#endif
+  std::vector<int> recv_displs(nranks);
+  int nrecv = 0;
+  for (int r = 0; r < nranks; r++) {
+    recv_displs[r] = nrecv;
+    nrecv += recv_counts[r];
+  }
+#ifdef MPI_PARALLEL
+  BufArray1D<Real> recv_buf("TransferSwarmParticles recv", nrecv * stride);
+  for (auto *v : {&send_counts, &send_displs, &recv_counts, &recv_displs}) {
+    for (auto &n : *v)
+      n *= stride;
+  }
+  Kokkos::fence();
+  PARTHENON_MPI_CHECK(MPI_Alltoallv(
+      send_buf.data(), send_counts.data(), send_displs.data(), MPI_PARTHENON_REAL,
+      recv_buf.data(), recv_counts.data(), recv_displs.data(), MPI_PARTHENON_REAL,
+      MPI_COMM_WORLD));
+#else
+  auto recv_buf = send_buf;
+#endif
+
+  // Sort the received particles by local destination block
+  const int gid0 = nblocks > 0 ? blocks[0]->gid : 0;
+  ParArray1D<int> block_counts("TransferSwarmParticles block counts",
+                               std::max(nblocks, 1));
+  ParArray1D<int> slots("TransferSwarmParticles slots", nrecv);
+  par_for(
+      PARTHENON_AUTO_LABEL, 0, nrecv - 1, KOKKOS_LAMBDA(const int m) {
+        const int lid = static_cast<int>(recv_buf(m * stride)) - gid0;
+        slots(m) = Kokkos::atomic_fetch_add(&block_counts(lid), 1);
+      });
+  auto block_counts_h = block_counts.GetHostMirrorAndCopy();
+  ParArray1D<int> block_begin("TransferSwarmParticles block begin", std::max(nblocks, 1));
+  auto block_begin_h = block_begin.GetHostMirror();
+  for (int b = 0, begin = 0; b < nblocks; b++) {
+    block_begin_h(b) = begin;
+    begin += block_counts_h(b);
+  }
+  block_begin.DeepCopy(block_begin_h);
+  ParArray1D<int> order("TransferSwarmParticles order", nrecv);
+  par_for(
+      PARTHENON_AUTO_LABEL, 0, nrecv - 1, KOKKOS_LAMBDA(const int m) {
+        const int lid = static_cast<int>(recv_buf(m * stride)) - gid0;
+        order(block_begin(lid) + slots(m)) = m;
+      });
+
+  std::vector<std::shared_ptr<Swarm>> swarms(nblocks);
+  for (int b = 0; b < nblocks; b++) {
+    swarms[b] = get_swarm(b);
+    swarms[b]->UnpackTransferredParticles(recv_buf, order, block_begin_h(b),
+                                          block_counts_h(b));
+  }
+  ApplySwarmBoundaryConditions(swarms);
+  for (auto &swarm : swarms) {
+    swarm->RemoveMarkedParticles();
+  }
+  return TaskStatus::complete;
+}
+
 } // namespace parthenon
@@ -149,8 +149,12 @@ class SwarmContainer {
   TaskStatus Defrag(double min_occupancy);
   TaskStatus DefragAll();
 
-  // Sort-by-cell task
+  // Pool capacity management task, see Swarm::UpdatePoolCapacity
+  TaskStatus UpdatePoolCapacity();
+
+  // Sort-by-cell tasks
   TaskStatus SortParticlesByCell();
+  TaskStatus ReorderParticlesByCell();
 
   // Communication routines
   void SetupPersistentMPI();
@@ -199,5 +203,36 @@ class SwarmContainer {
   SwarmMetadataMap swarmMetadataMap_ = {};
 };
 
+template <typename T>
+class MeshData;
+
+// Operations on the swarms of all blocks in a MeshData partition, so that a task list
+// needs a single task per partition rather than one per block. DefragSwarms compacts
+// all swarms below min_occupancy in one kernel launch, the others call the
+// corresponding SwarmContainer operation for every block. ReceiveSwarms keeps calling
+// SwarmContainer::Receive on all blocks until every block has received.
+TaskStatus DefragSwarms(MeshData<Real> *md, double min_occupancy);
+TaskStatus SortSwarmsByCell(MeshData<Real> *md);
+TaskStatus SendSwarms(MeshData<Real> *md, BoundaryCommSubset phase);
+TaskStatus ReceiveSwarms(MeshData<Real> *md, BoundaryCommSubset phase);
+TaskStatus ResetSwarmCommunication(MeshData<Real> *md);
+
+// Locations of the particles with the given ids in the swarm swarm_name, which needs a
+// Metadata::ParticleId variable, on the blocks of md. Returns a (2, number of ids) array
+// with the index of the block in md and the index of the particle, -1 for ids that are
+// not on any block of md. Uses the id index of every swarm instead of scanning the
+// particles.
+ParArray2D<int> FindSwarmParticles(MeshData<Real> *md, const std::string &swarm_name,
+                                   const ParArray1D<int> &ids);
+
+class Mesh;
+
+// Move every particle of swarm_name that left its block to the block containing it,
+// however far it moved, using the mesh's BlockLocator and a single all-to-all exchange
+// between the ranks instead of the neighbor communication of Send and Receive. This is
+// collective and operates on all blocks of the rank, so it must be called outside of
+// task lists that run per partition.
+TaskStatus TransferSwarmParticles(Mesh *pm, const std::string &swarm_name);
+
 } // namespace parthenon
 #endif // INTERFACE_SWARM_CONTAINER_HPP_
@@ -0,0 +1,358 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include "interface/swarm_deposition.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "globals.hpp"
+#include "interface/meshblock_data.hpp"
+#include "interface/swarm.hpp"
+#include "interface/swarm_default_names.hpp"
+#include "kokkos_abstraction.hpp"
+#include "mesh/mesh.hpp"
+#include "mesh/meshblock.hpp"
+#include "parthenon_mpi.hpp"
+#include "utils/error_checking.hpp"
+
+namespace parthenon {
+
+namespace {
+KOKKOS_INLINE_FUNCTION
+Real ShapeWeight(const DepositionShape shape, const Real delta) {
+  const Real d = std::abs(delta);
+  if (shape == DepositionShape::CIC) return d < 1.0 ? 1.0 - d : 0.0;
+  if (shape == DepositionShape::TSC) {
+    if (d < 0.5) return 0.75 - d * d;
+    return d < 1.5 ? 0.5 * (1.5 - d) * (1.5 - d) : 0.0;
+  }
+  // NGP only ever deposits into the cell of the particle
+  return 1.0;
+}
+
+std::int64_t FloorDiv2(const std::int64_t a) { return (a - (a < 0 ? 1 : 0)) / 2; }
+
+// Cells of the block at loc, including its ghost zones, that lie in the interior of the
+// block at nloc, in the index space of the block at loc. Only depends on the relative
+// position of the two blocks, so the sender and the receiver of a ghost accumulation
+// find the same cells.
+std::array<IndexRange, 3> GhostOverlap(const LogicalLocation &loc,
+                                       const LogicalLocation &nloc,
+                                       const IndexShape &cb) {
+  const std::array<IndexRange, 3> in{cb.GetBoundsI(IndexDomain::interior),
+                                     cb.GetBoundsJ(IndexDomain::interior),
+                                     cb.GetBoundsK(IndexDomain::interior)};
+  const std::array<IndexRange, 3> en{cb.GetBoundsI(IndexDomain::entire),
+                                     cb.GetBoundsJ(IndexDomain::entire),
+                                     cb.GetBoundsK(IndexDomain::entire)};
+  std::array<IndexRange, 3> out;
+  for (int d = 0; d < 3; ++d) {
+    if (in[d].s == en[d].s) {
+      out[d] = in[d];
+      continue;
+    }
+    const std::int64_t nx = in[d].e - in[d].s + 1;
+    // Interior of the neighbor in cells of this block relative to its first interior cell
+    const int dl = nloc.level() - loc.level();
+    std::int64_t ns = nloc.l(d) * nx;
+    std::int64_t ne = ns + nx;
+    if (dl < 0) {
+      ns *= 2;
+      ne = ns + 2 * nx;
+    } else if (dl > 0) {
+      ns /= 2;
+      ne = ns + nx / 2;
+    }
+    ns -= loc.l(d) * nx;
+    ne -= loc.l(d) * nx;
+    out[d].s = std::max<std::int64_t>(ns, en[d].s - in[d].s) + in[d].s;
+    out[d].e = std::min<std::int64_t>(ne - 1, en[d].e - in[d].s) + in[d].s;
+  }
+  return out;
+}
+
+int OverlapSize(const std::array<IndexRange, 3> &box) {
+  int size = 1;
+  for (const auto &r : box)
+    size *= std::max(r.e - r.s + 1, 0);
+  return size;
+}
+
+// Maps the cells of a receiving block onto the ghost cells packed by a sending block in
+// one direction. dl is the level of the receiver relative to the sender, and the sender
+// cells in [bs, be] are the packed ones.
+struct GhostMap {
+  int dl, off, base, bs, be;
+
+  // First of the sender cells covering receiver cell r, a coarser receiver cell covers
+  // two of them
+  KOKKOS_INLINE_FUNCTION
+  int First(const int r) const {
+    const int p = r - base;
+    return (dl == 0 ? p + off : (dl < 0 ? 2 * p + off : p / 2 + off)) + base;
+  }
+  KOKKOS_INLINE_FUNCTION
+  int Last(const int r) const { return First(r) + (dl < 0 ? 1 : 0); }
+};
+
+// Receiving block at loc, sending block at sloc (in the coordinates of the receiver)
+std::array<GhostMap, 3> GetGhostMaps(const LogicalLocation &loc,
+                                     const LogicalLocation &sloc,
+                                     const std::array<IndexRange, 3> &box,
+                                     const IndexShape &cb,
+                                     std::array<IndexRange, 3> &rbox) {
+  const std::array<IndexRange, 3> in{cb.GetBoundsI(IndexDomain::interior),
+                                     cb.GetBoundsJ(IndexDomain::interior),
+                                     cb.GetBoundsK(IndexDomain::interior)};
+  const std::array<IndexRange, 3> en{cb.GetBoundsI(IndexDomain::entire),
+                                     cb.GetBoundsJ(IndexDomain::entire),
+                                     cb.GetBoundsK(IndexDomain::entire)};
+  std::array<GhostMap, 3> maps;
+  for (int d = 0; d < 3; ++d) {
+    auto &m = maps[d];
+    m.base = in[d].s;
+    m.bs = box[d].s;
+    m.be = box[d].e;
+    if (in[d].s == en[d].s) {
+      // Direction that is not used
+      m.dl = 0;
+      m.off = 0;
+      rbox[d] = in[d];
+      continue;
+    }
+    const std::int64_t nx = in[d].e - in[d].s + 1;
+    m.dl = loc.level() - sloc.level();
+    std::int64_t off = loc.l(d) * nx - sloc.l(d) * nx;
+    std::int64_t rs, re;
+    const std::int64_t ps = m.bs - m.base, pe = m.be - m.base;
+    if (m.dl == 0) {
+      rs = ps - off;
+      re = pe - off;
+    } else if (m.dl < 0) {
+      off = 2 * loc.l(d) * nx - sloc.l(d) * nx;
+      rs = FloorDiv2(ps - off);
+      re = FloorDiv2(pe - off);
+    } else {
+      off = loc.l(d) * nx / 2 - sloc.l(d) * nx;
+      rs = 2 * (ps - off);
+      re = 2 * (pe - off) + 1;
+    }
+    m.off = static_cast<int>(off);
+    rbox[d].s = static_cast<int>(std::max<std::int64_t>(rs, 0)) + m.base;
+    rbox[d].e = static_cast<int>(std::min<std::int64_t>(re, nx - 1)) + m.base;
+  }
+  return maps;
+}
+
+using GhostKey = std::tuple<int, int, std::array<int, 3>>;
+} // namespace
+
+DepositionShape DepositionShapeFromString(const std::string &shape) {
+  if (shape == "ngp") return DepositionShape::NGP;
+  if (shape == "cic") return DepositionShape::CIC;
+  if (shape == "tsc") return DepositionShape::TSC;
+  PARTHENON_THROW("Unknown deposition shape " + shape +
+                  ", options are \"ngp\", \"cic\", and \"tsc\"");
+  return DepositionShape::NGP;
+}
+
+void DepositParticles(Swarm *swarm, const std::string &quantity, const std::string &field,
+                      const DepositionShape shape, const int component) {
+  PARTHENON_INSTRUMENT
+  auto pmb = swarm->GetBlockPointer();
+  swarm->SortParticlesByCell();
+
+  const int ndim = pmb->pmy_mesh->ndim;
+  const IndexRange ib = pmb->cellbounds.GetBoundsI(IndexDomain::interior);
+  const IndexRange jb = pmb->cellbounds.GetBoundsJ(IndexDomain::interior);
+  const IndexRange kb = pmb->cellbounds.GetBoundsK(IndexDomain::interior);
+  const IndexRange ibe = pmb->cellbounds.GetBoundsI(IndexDomain::entire);
+  const IndexRange jbe = pmb->cellbounds.GetBoundsJ(IndexDomain::entire);
+  const IndexRange kbe = pmb->cellbounds.GetBoundsK(IndexDomain::entire);
+  // Everything but NGP reaches one cell beyond the cell of a particle
+  const int w = (shape == DepositionShape::NGP) ? 0 : 1;
+  const int wj = (ndim > 1) ? w : 0;
+  const int wk = (ndim > 2) ? w : 0;
+
+  const auto &x = swarm->Get<Real>(swarm_position::x::name()).Get();
+  const auto &y = swarm->Get<Real>(swarm_position::y::name()).Get();
+  const auto &z = swarm->Get<Real>(swarm_position::z::name()).Get();
+  const auto &q = swarm->Get<Real>(quantity).Get();
+  auto swarm_d = swarm->GetDeviceContext();
+  auto &dep = pmb->meshblock_data.Get()->Get(field).data;
+  PARTHENON_REQUIRE_THROWS(component >= 0 && component < dep.GetDim(4),
+                           "Deposition component out of range for " + field);
+  const auto &coords = pmb->coords;
+  const Real dx1 = coords.Dxc<X1DIR>();
+  const Real dx2 = coords.Dxc<X2DIR>();
+  const Real dx3 = coords.Dxc<X3DIR>();
+
+  // Particles only live in the interior, so every cell gathers from the interior cells
+  // within the support of the shape
+  pmb->par_for(
+      PARTHENON_AUTO_LABEL, kbe.s, kbe.e, jbe.s, jbe.e, ibe.s, ibe.e,
+      KOKKOS_LAMBDA(const int k, const int j, const int i) {
+        const Real xc = coords.Xc<X1DIR>(i);
+        const Real yc = coords.Xc<X2DIR>(j);
+        const Real zc = coords.Xc<X3DIR>(k);
+        Real sum = 0.0;
+        for (int sk = (k - wk < kb.s ? kb.s : k - wk); sk <= k + wk && sk <= kb.e; ++sk) {
+          for (int sj = (j - wj < jb.s ? jb.s : j - wj); sj <= j + wj && sj <= jb.e;
+               ++sj) {
+            for (int si = (i - w < ib.s ? ib.s : i - w); si <= i + w && si <= ib.e;
+                 ++si) {
+              for (int n = 0; n < swarm_d.GetParticleCountPerCell(sk, sj, si); ++n) {
+                const int idx = swarm_d.GetFullIndex(sk, sj, si, n);
+                Real wgt = q(idx) * ShapeWeight(shape, (x(idx) - xc) / dx1);
+                if (ndim > 1) wgt *= ShapeWeight(shape, (y(idx) - yc) / dx2);
+                if (ndim > 2) wgt *= ShapeWeight(shape, (z(idx) - zc) / dx3);
+                sum += wgt;
+              }
+            }
+          }
+        }
+        dep(component, k, j, i) = sum / coords.CellVolume(k, j, i);
+      });
+}
+
+void AccumulateGhostZones(Mesh *pmesh, const std::string &field) {
+  PARTHENON_INSTRUMENT
+  if (pmesh->block_list.size() == 0) return;
+  const IndexShape &cb = pmesh->block_list[0]->cellbounds;
+  const int ndim = pmesh->ndim;
+  const Real coarse_fac = 1.0 / static_cast<Real>(1 << ndim);
+
+  // Ghost zones leave a block as one buffer per neighbor, identified by the gids of the
+  // sending and receiving block and the offset of the receiver seen from the sender
+  std::map<GhostKey, ParArray1D<Real>> buffers;
+  std::map<int, std::vector<GhostKey>> send_keys, recv_keys;
+  for (auto &pmb : pmesh->block_list) {
+    auto &var = pmb->meshblock_data.Get()->Get(field);
+    PARTHENON_REQUIRE_THROWS(var.IsSet(Metadata::Cell),
+                             "Can only accumulate the ghost zones of cell fields");
+    PARTHENON_REQUIRE_THROWS(var.data.GetDim(5) == 1 && var.data.GetDim(6) == 1,
+                             "Can only accumulate the ghost zones of vector fields");
+    const int ncomp = var.data.GetDim(4);
+    for (auto &nb : pmb->neighbors) {
+      const auto &trans = nb.lcoord_trans;
+      PARTHENON_REQUIRE_THROWS(trans.dir_connection == (std::array<int, 3>{0, 1, 2}) &&
+                                   !trans.dir_flip[0] && !trans.dir_flip[1] &&
+                                   !trans.dir_flip[2],
+                               "Ghost zone accumulation requires aligned trees");
+      std::array<int, 3> offsets = nb.offsets;
+      const auto box = GhostOverlap(pmb->loc, nb.origin_loc, cb);
+      const int size = ncomp * OverlapSize(box);
+      if (size == 0) continue;
+      const GhostKey key{pmb->gid, nb.gid, offsets};
+      ParArray1D<Real> buf("ghost accumulation", size);
+      const IndexRange ib = box[0], jb = box[1], kb = box[2];
+      const int ni = ib.e - ib.s + 1;
+      const int nj = jb.e - jb.s + 1;
+      const int nk = kb.e - kb.s + 1;
+      auto &data = var.data;
+      pmb->par_for(
+          PARTHENON_AUTO_LABEL, 0, ncomp - 1, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+          KOKKOS_LAMBDA(const int n, const int k, const int j, const int i) {
+            buf(((n * nk + k - kb.s) * nj + j - jb.s) * ni + i - ib.s) = data(n, k, j, i);
+          });
+      buffers[key] = buf;
+      if (nb.rank != Globals::my_rank) send_keys[nb.rank].push_back(key);
+    }
+    for (auto &nb : pmb->neighbors) {
+      if (nb.rank == Globals::my_rank) continue;
+      std::array<int, 3> offsets = nb.offsets;
+      const auto box = GhostOverlap(nb.origin_loc, pmb->loc, cb);
+      const int size = ncomp * OverlapSize(box);
+      if (size == 0) continue;
+      const GhostKey key{nb.gid, pmb->gid, {-offsets[0], -offsets[1], -offsets[2]}};
+      buffers[key] = ParArray1D<Real>("ghost accumulation", size);
+      recv_keys[nb.rank].push_back(key);
+    }
+  }
+
+#ifdef MPI_PARALLEL
+  // Both sides of a rank pair know all its buffers, so their position in the sorted
+  // list is a unique tag
+  MPI_Comm comm = pmesh->GetMPIComm(Mesh::ghost_accumulation_comm_label);
+  std::vector<MPI_Request> requests;
+  for (auto &[rank, keys] : recv_keys) {
+    std::sort(keys.begin(), keys.end());
+    for (int tag = 0; tag < static_cast<int>(keys.size()); ++tag) {
+      auto &buf = buffers[keys[tag]];
+      requests.emplace_back();
+      PARTHENON_MPI_CHECK(MPI_Irecv(buf.data(), buf.size(), MPI_PARTHENON_REAL, rank, tag,
+                                    comm, &requests.back()));
+    }
+  }
+  Kokkos::fence();
+  for (auto &[rank, keys] : send_keys) {
+    std::sort(keys.begin(), keys.end());
+    for (int tag = 0; tag < static_cast<int>(keys.size()); ++tag) {
+      auto &buf = buffers[keys[tag]];
+      requests.emplace_back();
+      PARTHENON_MPI_CHECK(MPI_Isend(buf.data(), buf.size(), MPI_PARTHENON_REAL, rank, tag,
+                                    comm, &requests.back()));
+    }
+  }
+  PARTHENON_MPI_CHECK(
+      MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE));
+#endif
+
+  // Every receiver adds its buffers one after the other, so overlapping contributions
+  // of face, edge, and corner neighbors don't race
+  for (auto &pmb : pmesh->block_list) {
+    auto &data = pmb->meshblock_data.Get()->Get(field).data;
+    const int ncomp = data.GetDim(4);
+    for (auto &nb : pmb->neighbors) {
+      std::array<int, 3> offsets = nb.offsets;
+      const GhostKey key{nb.gid, pmb->gid, {-offsets[0], -offsets[1], -offsets[2]}};
+      auto it = buffers.find(key);
+      if (it == buffers.end()) continue;
+      auto &buf = it->second;
+      const auto box = GhostOverlap(nb.origin_loc, pmb->loc, cb);
+      std::array<IndexRange, 3> rbox;
+      const auto maps = GetGhostMaps(pmb->loc, nb.origin_loc, box, cb, rbox);
+      const int ni = box[0].e - box[0].s + 1;
+      const int nj = box[1].e - box[1].s + 1;
+      const int nk = box[2].e - box[2].s + 1;
+      const GhostMap m1 = maps[0], m2 = maps[1], m3 = maps[2];
+      const Real fac = (m1.dl < 0) ? coarse_fac : 1.0;
+      pmb->par_for(
+          PARTHENON_AUTO_LABEL, 0, ncomp - 1, rbox[2].s, rbox[2].e, rbox[1].s, rbox[1].e,
+          rbox[0].s, rbox[0].e,
+          KOKKOS_LAMBDA(const int n, const int k, const int j, const int i) {
+            Real sum = 0.0;
+            for (int sk = m3.First(k); sk <= m3.Last(k); ++sk) {
+              if (sk < m3.bs || sk > m3.be) continue;
+              for (int sj = m2.First(j); sj <= m2.Last(j); ++sj) {
+                if (sj < m2.bs || sj > m2.be) continue;
+                for (int si = m1.First(i); si <= m1.Last(i); ++si) {
+                  if (si < m1.bs || si > m1.be) continue;
+                  sum += buf(((n * nk + sk - m3.bs) * nj + sj - m2.bs) * ni + si - m1.bs);
+                }
+              }
+            }
+            data(n, k, j, i) += fac * sum;
+          });
+    }
+  }
+}
+
+} // namespace parthenon
@@ -0,0 +1,48 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef INTERFACE_SWARM_DEPOSITION_HPP_
+#define INTERFACE_SWARM_DEPOSITION_HPP_
+//! \file swarm_deposition.hpp
+//  \brief Deposition of particle quantities onto cell-centered fields
+
+#include <string>
+
+#include "interface/swarm_device_context.hpp"
+
+namespace parthenon {
+
+class Mesh;
+class Swarm;
+
+// Parses "ngp", "cic", or "tsc"
+DepositionShape DepositionShapeFromString(const std::string &shape);
+
+// Sets the given component of the cell-centered field on the block of the swarm to the
+// density sum_p q_p W(x - x_p) / dV of the Real swarm variable q, including the ghost
+// zones. Every cell gathers the particles of itself and of its neighboring cells from
+// the cell sorted particle indices, so there are no atomic updates. The contributions to
+// the ghost zones can be added to the blocks they belong to with AccumulateGhostZones.
+// Like the rest of Swarm, this assumes uniform Cartesian coordinates.
+void DepositParticles(Swarm *swarm, const std::string &quantity, const std::string &field,
+                      DepositionShape shape, int component = 0);
+
+// Adds the ghost zones of all components of a cell-centered density field to the
+// interior of the neighboring blocks that own those cells, restricting or prolongating
+// them conservatively across refinement levels. Ghost zones across physical boundaries
+// are dropped and the ghost zones of the field are stale afterwards. This is collective
+// over all ranks and covers all blocks of the mesh.
+void AccumulateGhostZones(Mesh *pmesh, const std::string &field);
+
+} // namespace parthenon
+
+#endif // INTERFACE_SWARM_DEPOSITION_HPP_
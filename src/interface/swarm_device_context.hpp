@@ -36,6 +36,48 @@ struct SwarmKeyComparator {
   }
 };
 
+// Shape of the particles, by increasing support: nearest grid point (only the cell of
+// the particle), cloud in cell (linear weights over two cells per direction), and
+// triangular shaped cloud (quadratic weights over three cells per direction)
+enum class DepositionShape { NGP, CIC, TSC };
+
+// Cells and weights of the shape of a particle, starting at cell (k0, j0, i0) and
+// spanning nk x nj x ni cells. The weight of cell (k0 + dk, j0 + dj, i0 + di) is
+// wk[dk] * wj[dj] * wi[di].
+struct ParticleStencil {
+  int i0, j0, k0;
+  int ni, nj, nk;
+  Real wi[3], wj[3], wk[3];
+};
+
+// First cell and weights of the shape along one direction for a particle at s, its
+// distance from the first interior face in cell widths. base is the index of the first
+// interior cell. Returns the number of cells.
+KOKKOS_INLINE_FUNCTION
+int ParticleShapeStencil1D(const DepositionShape shape, const Real s, const int base,
+                           int &first, Real *w) {
+  if (shape == DepositionShape::CIC) {
+    const Real xi = s - 0.5;
+    const Real f = std::floor(xi);
+    first = static_cast<int>(f) + base;
+    w[1] = xi - f;
+    w[0] = 1.0 - w[1];
+    return 2;
+  }
+  const Real c = std::floor(s);
+  if (shape == DepositionShape::TSC) {
+    const Real d = s - c - 0.5;
+    first = static_cast<int>(c) - 1 + base;
+    w[0] = 0.5 * (0.5 - d) * (0.5 - d);
+    w[1] = 0.75 - d * d;
+    w[2] = 0.5 * (0.5 + d) * (0.5 + d);
+    return 3;
+  }
+  first = static_cast<int>(c) + base;
+  w[0] = 1.0;
+  return 1;
+}
+
 // TODO(BRR) Template this class on coordinates/pass appropriate additional args to e.g.
 // coords_.CellWidthFA()
 class SwarmDeviceContext {
@@ -68,7 +110,8 @@ class SwarmDeviceContext {
       printf("y = %e [%e %e]\n", y, y_min_, y_max_);
       printf("z = %e [%e %e]\n", z, z_min_, z_max_);
       PARTHENON_FAIL("Particle neighbor indices out of bounds; particle has somehow "
-                     "moved beyond the halo of adjacent blocks which is not permitted.");
+                     "moved beyond the halo of adjacent blocks, which requires "
+                     "TransferSwarmParticles.");
     }
 
     // Ignore k,j indices as necessary based on problem dimension
@@ -104,6 +147,33 @@ class SwarmDeviceContext {
                     : kb_s_;
   }
 
+  // Cells and weights of the shape of a particle at (x, y, z) for interpolating cell
+  // fields to it, see ParticleStencil. With CIC and TSC the stencil reaches into the
+  // first layer of ghost zones.
+  // TODO(BRR) This logic will change for non-uniform cartesian meshes
+  KOKKOS_INLINE_FUNCTION
+  ParticleStencil GetParticleStencil(const DepositionShape shape, const Real &x,
+                                     const Real &y, const Real &z) const {
+    ParticleStencil st;
+    st.ni = ParticleShapeStencil1D(shape, (x - x_min_) / coords_.Dxc<X1DIR>(), ib_s_,
+                                   st.i0, st.wi);
+    st.nj = 1;
+    st.j0 = jb_s_;
+    st.wj[0] = 1.0;
+    if (ndim_ > 1) {
+      st.nj = ParticleShapeStencil1D(shape, (y - y_min_) / coords_.Dxc<X2DIR>(), jb_s_,
+                                     st.j0, st.wj);
+    }
+    st.nk = 1;
+    st.k0 = kb_s_;
+    st.wk[0] = 1.0;
+    if (ndim_ > 2) {
+      st.nk = ParticleShapeStencil1D(shape, (z - z_min_) / coords_.Dxc<X3DIR>(), kb_s_,
+                                     st.k0, st.wk);
+    }
+    return st;
+  }
+
   KOKKOS_INLINE_FUNCTION
   int GetParticleCountPerCell(const int k, const int j, const int i) const {
     return cell_sorted_number_(k, j, i);
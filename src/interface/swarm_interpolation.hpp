@@ -0,0 +1,106 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef INTERFACE_SWARM_INTERPOLATION_HPP_
+#define INTERFACE_SWARM_INTERPOLATION_HPP_
+//! \file swarm_interpolation.hpp
+//  \brief Interpolation of cell-centered fields to particle positions
+
+#include <string>
+
+#include "interface/mesh_data.hpp"
+#include "interface/meshblock_data.hpp"
+#include "interface/swarm.hpp"
+#include "interface/swarm_container.hpp"
+#include "interface/swarm_default_names.hpp"
+#include "interface/swarm_device_context.hpp"
+#include "kokkos_abstraction.hpp"
+#include "utils/error_checking.hpp"
+
+namespace parthenon {
+
+// Interpolates the variables lo, ..., hi of block b of a pack with the weights of a
+// particle stencil, storing variable lo + v in out[v]. All variables share the stencil,
+// so the weights are only computed once per cell.
+template <class TPack>
+KOKKOS_INLINE_FUNCTION void InterpolateToParticle(const TPack &pack, const int b,
+                                                  const int lo, const int hi,
+                                                  const ParticleStencil &st, Real *out) {
+  for (int v = 0; v <= hi - lo; ++v)
+    out[v] = 0.0;
+  for (int dk = 0; dk < st.nk; ++dk) {
+    for (int dj = 0; dj < st.nj; ++dj) {
+      for (int di = 0; di < st.ni; ++di) {
+        const Real w = st.wk[dk] * st.wj[dj] * st.wi[di];
+        for (int v = 0; v <= hi - lo; ++v)
+          out[v] += w * pack(b, lo + v, st.k0 + dk, st.j0 + dj, st.i0 + di);
+      }
+    }
+  }
+}
+
+// Interpolates all variables of the pack to the particles of the swarm swarm_name on
+// every block of md, storing variable lo(b) + v of the pack in component v of the Real
+// swarm variable out. Particles are processed by cell, so neighboring threads read
+// overlapping stencils of the fields. With CIC and TSC the ghost zones of the fields
+// have to be filled.
+template <class TPack>
+void InterpolateToParticles(MeshData<Real> *md, const TPack &pack,
+                            const std::string &swarm_name, const std::string &out,
+                            const DepositionShape shape) {
+  PARTHENON_INSTRUMENT
+  for (int b = 0; b < md->NumBlocks(); ++b) {
+    auto &mbd = md->GetBlockData(b);
+    auto pmb = mbd->GetBlockPointer();
+    auto swarm = mbd->GetSwarmData()->Get(swarm_name);
+    const int lo = pack.GetLowerBoundHost(b);
+    const int hi = pack.GetUpperBoundHost(b);
+    if (hi < lo || swarm->GetNumActive() == 0) continue;
+    swarm->SortParticlesByCell();
+
+    const auto &x = swarm->Get<Real>(swarm_position::x::name()).Get();
+    const auto &y = swarm->Get<Real>(swarm_position::y::name()).Get();
+    const auto &z = swarm->Get<Real>(swarm_position::z::name()).Get();
+    auto &vals = swarm->Get<Real>(out).Get();
+    PARTHENON_REQUIRE_THROWS(vals.GetDim(2) >= hi - lo + 1,
+                             "Swarm variable " + out +
+                                 " has fewer components than the interpolated pack");
+    auto swarm_d = swarm->GetDeviceContext();
+    const IndexRange ib = pmb->cellbounds.GetBoundsI(IndexDomain::interior);
+    const IndexRange jb = pmb->cellbounds.GetBoundsJ(IndexDomain::interior);
+    const IndexRange kb = pmb->cellbounds.GetBoundsK(IndexDomain::interior);
+    pmb->par_for(
+        PARTHENON_AUTO_LABEL, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+        KOKKOS_LAMBDA(const int k, const int j, const int i) {
+          for (int p = 0; p < swarm_d.GetParticleCountPerCell(k, j, i); ++p) {
+            const int n = swarm_d.GetFullIndex(k, j, i, p);
+            const auto st = swarm_d.GetParticleStencil(shape, x(n), y(n), z(n));
+            for (int v = 0; v <= hi - lo; ++v) {
+              Real sum = 0.0;
+              for (int dk = 0; dk < st.nk; ++dk) {
+                for (int dj = 0; dj < st.nj; ++dj) {
+                  for (int di = 0; di < st.ni; ++di) {
+                    sum += st.wk[dk] * st.wj[dj] * st.wi[di] *
+                           pack(b, lo + v, st.k0 + dk, st.j0 + dj, st.i0 + di);
+                  }
+                }
+              }
+              vals(v, n) = sum;
+            }
+          }
+        });
+  }
+}
+
+} // namespace parthenon
+
+#endif // INTERFACE_SWARM_INTERPOLATION_HPP_
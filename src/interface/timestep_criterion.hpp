@@ -0,0 +1,52 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef INTERFACE_TIMESTEP_CRITERION_HPP_
+#define INTERFACE_TIMESTEP_CRITERION_HPP_
+
+#include <array>
+#include <string>
+
+#include "basic_types.hpp"
+
+namespace parthenon {
+
+// A per-cell timestep limit that a package registers in StateDescriptor::
+// timestep_criteria instead of (or in addition to) an EstimateTimestep function. The
+// criteria of all packages are evaluated together in a single kernel per MeshData or
+// MeshBlockData by Update::EstimateTimestep, so packages do not need a reduction each.
+// The limit is either taken from a cell-centered field or from constant values:
+//  - signal_speed: factor * dx_d / |s_d| minimized over the active directions d. A field
+//    with three or more components holds the speed s_d in component d, otherwise its
+//    first component is the speed in every direction.
+//  - diffusion: factor * dx^2 / |D| with the smallest active cell width dx.
+//  - rate: factor / |r|, e.g. for stiff source terms.
+// For diffusion and rate the largest magnitude over all components of a field is used.
+// Zero speeds, diffusivities, and rates do not limit the timestep.
+struct TimestepCriterion {
+  enum class Type { signal_speed, diffusion, rate };
+
+  TimestepCriterion(const Type type, const std::string &field, const Real factor)
+      : type(type), field(field), values{0.0, 0.0, 0.0}, factor(factor) {}
+  TimestepCriterion(const Type type, const std::array<Real, 3> &values,
+                    const Real factor)
+      : type(type), values(values), factor(factor) {}
+
+  Type type;
+  std::string field; // Empty for constant values
+  std::array<Real, 3> values;
+  Real factor;
+};
+
+} // namespace parthenon
+
+#endif // INTERFACE_TIMESTEP_CRITERION_HPP_
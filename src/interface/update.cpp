@@ -13,7 +13,13 @@
 
 #include "interface/update.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
 
 #include "config.hpp"
 #include "coordinates/coordinates.hpp"
@@ -139,68 +145,381 @@ TaskStatus UpdateWithFluxDivergence(MeshData<Real> *u0_data, MeshData<Real> *u1_
   return TaskStatus::complete;
 }
 
+TaskStatus Update2SWithFluxDivergence(MeshData<Real> *s0_data, MeshData<Real> *s1_data,
+                                      const LowStorageIntegrator *pint, Real dt,
+                                      int stage, bool update_s1) {
+  PARTHENON_INSTRUMENT
+  const IndexDomain interior = IndexDomain::interior;
+
+  std::vector<MetadataFlag> flags({Metadata::WithFluxes, Metadata::Cell});
+  auto s0_pack = s0_data->PackVariablesAndFluxes(flags);
+  const auto &s1_pack = s1_data->PackVariables(flags);
+  const IndexRange ib = s0_data->GetBoundsI(interior);
+  const IndexRange jb = s0_data->GetBoundsJ(interior);
+  const IndexRange kb = s0_data->GetBoundsK(interior);
+
+  const Real delta = pint->delta[stage - 1];
+  const Real beta_dt = pint->beta[stage - 1] * dt;
+  const Real gam0 = pint->gam0[stage - 1];
+  const Real gam1 = pint->gam1[stage - 1];
+  const int ndim = s0_pack.GetNdim();
+  parthenon::par_for(
+      DEFAULT_LOOP_PATTERN, PARTHENON_AUTO_LABEL, DevExecSpace(), 0,
+      s0_pack.GetDim(5) - 1, 0, s0_pack.GetDim(4) - 1, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+      KOKKOS_LAMBDA(const int m, const int l, const int k, const int j, const int i) {
+        if (s0_pack.IsAllocated(m, l) && s1_pack.IsAllocated(m, l)) {
+          const auto &coords = s0_pack.GetCoords(m);
+          const auto &s0 = s0_pack(m);
+          if (update_s1) {
+            s1_pack(m, l, k, j, i) += delta * s0(l, k, j, i);
+          }
+          s0_pack(m, l, k, j, i) = gam0 * s0(l, k, j, i) + gam1 * s1_pack(m, l, k, j, i) +
+                                   beta_dt * FluxDivHelper(l, k, j, i, ndim, coords, s0);
+        }
+      });
+  return TaskStatus::complete;
+}
+
+TaskStatus ButcherStageWithFluxDivergence(MeshData<Real> *in_data,
+                                          MeshData<Real> *base_data,
+                                          const std::vector<MeshData<Real> *> &stage_data,
+                                          MeshData<Real> *out_data,
+                                          const ButcherIntegrator *pint, Real dt,
+                                          int stage) {
+  PARTHENON_INSTRUMENT
+  PARTHENON_REQUIRE_THROWS(0 <= stage && stage < pint->nstages &&
+                               stage < stage_data.size(),
+                           "Invalid stage for the Butcher tableau");
+  const IndexDomain interior = IndexDomain::interior;
+
+  std::vector<MetadataFlag> flags({Metadata::WithFluxes, Metadata::Cell});
+  const auto &in_pack = in_data->PackVariablesAndFluxes(flags);
+  const auto &base_pack = base_data->PackVariables(flags);
+  const auto &rhs_pack = stage_data[stage]->PackVariables(flags);
+  const auto &out_pack = out_data->PackVariables(flags);
+  const IndexRange ib = in_data->GetBoundsI(interior);
+  const IndexRange jb = in_data->GetBoundsJ(interior);
+  const IndexRange kb = in_data->GetBoundsK(interior);
+
+  // Packs and weights of the right-hand sides of the previous stages, the one of this
+  // stage is computed in the kernel
+  const bool last = stage == pint->nstages - 1;
+  using pack_t = std::decay_t<decltype(rhs_pack)>;
+  ParArray1D<pack_t> prev_packs("Butcher previous stages", std::max(stage, 1));
+  ParArray1D<Real> prev_weights("Butcher previous weights", std::max(stage, 1));
+  auto prev_packs_h = Kokkos::create_mirror_view(HostMemSpace(), prev_packs);
+  auto prev_weights_h = Kokkos::create_mirror_view(HostMemSpace(), prev_weights);
+  for (int prev = 0; prev < stage; ++prev) {
+    prev_packs_h(prev) = stage_data[prev]->PackVariables(flags);
+    prev_weights_h(prev) = dt * (last ? pint->b[prev] : pint->a[stage + 1][prev]);
+  }
+  Kokkos::deep_copy(prev_packs, prev_packs_h);
+  Kokkos::deep_copy(prev_weights, prev_weights_h);
+  const Real weight = dt * (last ? pint->b[stage] : pint->a[stage + 1][stage]);
+
+  const int ndim = in_pack.GetNdim();
+  parthenon::par_for(
+      DEFAULT_LOOP_PATTERN, PARTHENON_AUTO_LABEL, DevExecSpace(), 0,
+      in_pack.GetDim(5) - 1, 0, in_pack.GetDim(4) - 1, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+      KOKKOS_LAMBDA(const int m, const int l, const int k, const int j, const int i) {
+        if (in_pack.IsAllocated(m, l) && rhs_pack.IsAllocated(m, l) &&
+            base_pack.IsAllocated(m, l) && out_pack.IsAllocated(m, l)) {
+          const Real rhs =
+              FluxDivHelper(l, k, j, i, ndim, in_pack.GetCoords(m), in_pack(m));
+          rhs_pack(m, l, k, j, i) = rhs;
+          Real out = base_pack(m, l, k, j, i) + weight * rhs;
+          for (int prev = 0; prev < stage; ++prev) {
+            if (prev_packs(prev).IsAllocated(m, l))
+              out += prev_weights(prev) * prev_packs(prev)(m, l, k, j, i);
+          }
+          out_pack(m, l, k, j, i) = out;
+        }
+      });
+  return TaskStatus::complete;
+}
+
+TaskStatus ButcherRegisterStage(MeshData<Real> *in_data, MeshData<Real> *base_data,
+                                const std::vector<MeshData<Real> *> &rhs_registers,
+                                MeshData<Real> *acc_data, MeshData<Real> *out_data,
+                                const ButcherIntegrator *pint, Real dt, int stage) {
+  PARTHENON_INSTRUMENT
+  PARTHENON_REQUIRE_THROWS(0 <= stage && stage < pint->nstages,
+                           "Invalid stage for the Butcher tableau");
+  PARTHENON_REQUIRE_THROWS(!pint->IsEmbedded(),
+                           "Embedded tableaux need the right-hand sides of all stages");
+  PARTHENON_REQUIRE_THROWS(rhs_registers.size() >= pint->nrhs_registers,
+                           "Not enough right-hand side registers");
+  const bool first = stage == 0;
+  const bool last = stage == pint->nstages - 1;
+  PARTHENON_REQUIRE_THROWS((first && last) || acc_data != nullptr,
+                           "Need an accumulator for tableaux with several stages");
+  const IndexDomain interior = IndexDomain::interior;
+
+  std::vector<MetadataFlag> flags({Metadata::WithFluxes, Metadata::Cell});
+  const auto &in_pack = in_data->PackVariablesAndFluxes(flags);
+  const auto &base_pack = base_data->PackVariables(flags);
+  const auto &rhs_pack = rhs_registers[pint->rhs_register[stage]]->PackVariables(flags);
+  const auto &out_pack = out_data->PackVariables(flags);
+  using pack_t = std::decay_t<decltype(rhs_pack)>;
+  const pack_t acc_pack =
+      (acc_data == nullptr) ? out_pack : acc_data->PackVariables(flags);
+  const IndexRange ib = in_data->GetBoundsI(interior);
+  const IndexRange jb = in_data->GetBoundsJ(interior);
+  const IndexRange kb = in_data->GetBoundsK(interior);
+
+  // Right-hand sides of previous stages that enter the input of the next stage, all of
+  // them are still in their registers by construction of rhs_register
+  std::vector<int> prev_stages;
+  if (!last) {
+    for (int prev = 0; prev < stage; ++prev) {
+      if (pint->a[stage + 1][prev] != 0.0) prev_stages.push_back(prev);
+    }
+  }
+  const int nprev = prev_stages.size();
+  ParArray1D<pack_t> prev_packs("Butcher previous registers", std::max(nprev, 1));
+  ParArray1D<Real> prev_weights("Butcher previous weights", std::max(nprev, 1));
+  auto prev_packs_h = Kokkos::create_mirror_view(HostMemSpace(), prev_packs);
+  auto prev_weights_h = Kokkos::create_mirror_view(HostMemSpace(), prev_weights);
+  for (int n = 0; n < nprev; ++n) {
+    const int prev = prev_stages[n];
+    prev_packs_h(n) = rhs_registers[pint->rhs_register[prev]]->PackVariables(flags);
+    prev_weights_h(n) = dt * pint->a[stage + 1][prev];
+  }
+  Kokkos::deep_copy(prev_packs, prev_packs_h);
+  Kokkos::deep_copy(prev_weights, prev_weights_h);
+  const Real weight = last ? 0.0 : dt * pint->a[stage + 1][stage];
+  const Real weight_b = dt * pint->b[stage];
+
+  const int ndim = in_pack.GetNdim();
+  parthenon::par_for(
+      DEFAULT_LOOP_PATTERN, PARTHENON_AUTO_LABEL, DevExecSpace(), 0,
+      in_pack.GetDim(5) - 1, 0, in_pack.GetDim(4) - 1, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+      KOKKOS_LAMBDA(const int m, const int l, const int k, const int j, const int i) {
+        if (in_pack.IsAllocated(m, l) && rhs_pack.IsAllocated(m, l) &&
+            base_pack.IsAllocated(m, l) && out_pack.IsAllocated(m, l) &&
+            acc_pack.IsAllocated(m, l)) {
+          const Real rhs =
+              FluxDivHelper(l, k, j, i, ndim, in_pack.GetCoords(m), in_pack(m));
+          const Real base = base_pack(m, l, k, j, i);
+          const Real acc = (first ? base : acc_pack(m, l, k, j, i)) + weight_b * rhs;
+          if (last) {
+            out_pack(m, l, k, j, i) = acc;
+            return;
+          }
+          rhs_pack(m, l, k, j, i) = rhs;
+          acc_pack(m, l, k, j, i) = acc;
+          Real out = base + weight * rhs;
+          for (int n = 0; n < nprev; ++n) {
+            if (prev_packs(n).IsAllocated(m, l))
+              out += prev_weights(n) * prev_packs(n)(m, l, k, j, i);
+          }
+          out_pack(m, l, k, j, i) = out;
+        }
+      });
+  return TaskStatus::complete;
+}
+
+TaskStatus ButcherErrorEstimate(MeshData<Real> *base_data,
+                                const std::vector<MeshData<Real> *> &stage_data,
+                                MeshData<Real> *out_data, const ButcherIntegrator *pint,
+                                Real dt, Real *error) {
+  PARTHENON_INSTRUMENT
+  PARTHENON_REQUIRE_THROWS(pint->IsEmbedded(), "The Butcher tableau is not embedded");
+  PARTHENON_REQUIRE_THROWS(stage_data.size() >= pint->nstages,
+                           "Need the right-hand sides of all stages");
+  const IndexDomain interior = IndexDomain::interior;
+
+  std::vector<MetadataFlag> flags({Metadata::WithFluxes, Metadata::Cell});
+  const auto &base_pack = base_data->PackVariables(flags);
+  const auto &out_pack = out_data->PackVariables(flags);
+  const IndexRange ib = base_data->GetBoundsI(interior);
+  const IndexRange jb = base_data->GetBoundsJ(interior);
+  const IndexRange kb = base_data->GetBoundsK(interior);
+
+  const int nstages = pint->nstages;
+  using pack_t = std::decay_t<decltype(base_pack)>;
+  ParArray1D<pack_t> rhs_packs("Butcher stages", nstages);
+  ParArray1D<Real> weights("Butcher error weights", nstages);
+  auto rhs_packs_h = Kokkos::create_mirror_view(HostMemSpace(), rhs_packs);
+  auto weights_h = Kokkos::create_mirror_view(HostMemSpace(), weights);
+  for (int j = 0; j < nstages; ++j) {
+    rhs_packs_h(j) = stage_data[j]->PackVariables(flags);
+    weights_h(j) = dt * (pint->b[j] - pint->b_embedded[j]);
+  }
+  Kokkos::deep_copy(rhs_packs, rhs_packs_h);
+  Kokkos::deep_copy(weights, weights_h);
+  const Real atol = pint->atol;
+  const Real rtol = pint->rtol;
+
+  Real max_err = 0.0;
+  parthenon::par_reduce(
+      loop_pattern_mdrange_tag, PARTHENON_AUTO_LABEL, DevExecSpace(), 0,
+      base_pack.GetDim(5) - 1, 0, base_pack.GetDim(4) - 1, kb.s, kb.e, jb.s, jb.e, ib.s,
+      ib.e,
+      KOKKOS_LAMBDA(const int m, const int l, const int k, const int j, const int i,
+                    Real &lmax) {
+        if (base_pack.IsAllocated(m, l) && out_pack.IsAllocated(m, l)) {
+          Real err = 0.0;
+          for (int s = 0; s < nstages; ++s) {
+            if (rhs_packs(s).IsAllocated(m, l))
+              err += weights(s) * rhs_packs(s)(m, l, k, j, i);
+          }
+          const Real u0 = std::abs(base_pack(m, l, k, j, i));
+          const Real u1 = std::abs(out_pack(m, l, k, j, i));
+          err = std::abs(err) / (atol + rtol * (u0 > u1 ? u0 : u1));
+          lmax = (err > lmax ? err : lmax);
+        }
+      },
+      Kokkos::Max<Real>(max_err));
+  *error = std::max(*error, max_err);
+  return TaskStatus::complete;
+}
+
+TaskStatus ImexStageSum(const std::vector<MetadataFlag> &flags, MeshData<Real> *base_data,
+                        const std::vector<MeshData<Real> *> &explicit_data,
+                        const std::vector<MeshData<Real> *> &implicit_data,
+                        MeshData<Real> *out_data, const ImexIntegrator *pint,
+                        const int stage) {
+  PARTHENON_INSTRUMENT
+  PARTHENON_REQUIRE_THROWS(0 <= stage && stage <= pint->nstages &&
+                               stage <= explicit_data.size() &&
+                               stage <= implicit_data.size(),
+                           "Invalid stage for the IMEX tableau");
+  const IndexDomain interior = IndexDomain::interior;
+  const auto &base_pack = base_data->PackVariables(flags);
+  const auto &out_pack = out_data->PackVariables(flags);
+  const IndexRange ib = base_data->GetBoundsI(interior);
+  const IndexRange jb = base_data->GetBoundsJ(interior);
+  const IndexRange kb = base_data->GetBoundsK(interior);
+
+  // Explicit and implicit right-hand sides of the previous stages with their weights
+  const bool last = stage == pint->nstages;
+  const int nterms = 2 * stage;
+  using pack_t = std::decay_t<decltype(base_pack)>;
+  ParArray1D<pack_t> packs("IMEX stages", std::max(nterms, 1));
+  ParArray1D<Real> weights("IMEX weights", std::max(nterms, 1));
+  auto packs_h = Kokkos::create_mirror_view(HostMemSpace(), packs);
+  auto weights_h = Kokkos::create_mirror_view(HostMemSpace(), weights);
+  const Real dt = pint->dt;
+  for (int j = 0; j < stage; ++j) {
+    packs_h(2 * j) = explicit_data[j]->PackVariables(flags);
+    weights_h(2 * j) = dt * (last ? pint->b_ex[j] : pint->a_ex[stage][j]);
+    packs_h(2 * j + 1) = implicit_data[j]->PackVariables(flags);
+    weights_h(2 * j + 1) = dt * (last ? pint->b_im[j] : pint->a_im[stage][j]);
+  }
+  Kokkos::deep_copy(packs, packs_h);
+  Kokkos::deep_copy(weights, weights_h);
+
+  parthenon::par_for(
+      DEFAULT_LOOP_PATTERN, PARTHENON_AUTO_LABEL, DevExecSpace(), 0,
+      base_pack.GetDim(5) - 1, 0, base_pack.GetDim(4) - 1, kb.s, kb.e, jb.s, jb.e, ib.s,
+      ib.e,
+      KOKKOS_LAMBDA(const int m, const int l, const int k, const int j, const int i) {
+        if (base_pack.IsAllocated(m, l) && out_pack.IsAllocated(m, l)) {
+          Real out = base_pack(m, l, k, j, i);
+          for (int n = 0; n < nterms; ++n) {
+            if (weights(n) != 0.0 && packs(n).IsAllocated(m, l))
+              out += weights(n) * packs(n)(m, l, k, j, i);
+          }
+          out_pack(m, l, k, j, i) = out;
+        }
+      });
+  return TaskStatus::complete;
+}
+
+TaskStatus ImexImplicitRHS(const std::vector<MetadataFlag> &flags, MeshData<Real> *u_data,
+                           MeshData<Real> *rhs_data, MeshData<Real> *implicit_data,
+                           const ImexIntegrator *pint, const int stage) {
+  PARTHENON_INSTRUMENT
+  PARTHENON_REQUIRE_THROWS(pint->IsImplicitStage(stage),
+                           "Stage of the IMEX tableau is not implicit");
+  const IndexDomain interior = IndexDomain::interior;
+  const auto &u_pack = u_data->PackVariables(flags);
+  const auto &rhs_pack = rhs_data->PackVariables(flags);
+  const auto &out_pack = implicit_data->PackVariables(flags);
+  const IndexRange ib = u_data->GetBoundsI(interior);
+  const IndexRange jb = u_data->GetBoundsJ(interior);
+  const IndexRange kb = u_data->GetBoundsK(interior);
+  const Real inv_factor = 1.0 / pint->ImplicitFactor(stage);
+  parthenon::par_for(
+      DEFAULT_LOOP_PATTERN, PARTHENON_AUTO_LABEL, DevExecSpace(), 0,
+      u_pack.GetDim(5) - 1, 0, u_pack.GetDim(4) - 1, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+      KOKKOS_LAMBDA(const int m, const int l, const int k, const int j, const int i) {
+        if (u_pack.IsAllocated(m, l) && rhs_pack.IsAllocated(m, l) &&
+            out_pack.IsAllocated(m, l)) {
+          out_pack(m, l, k, j, i) =
+              inv_factor * (u_pack(m, l, k, j, i) - rhs_pack(m, l, k, j, i));
+        }
+      });
+  return TaskStatus::complete;
+}
+
 TaskStatus SparseDealloc(MeshData<Real> *md) {
   PARTHENON_INSTRUMENT
   if (!Globals::sparse_config.enabled || (md->NumBlocks() == 0)) {
     return TaskStatus::complete;
   }
 
-  const IndexRange ib = md->GetBoundsI(IndexDomain::entire);
-  const IndexRange jb = md->GetBoundsJ(IndexDomain::entire);
-  const IndexRange kb = md->GetBoundsK(IndexDomain::entire);
-
   auto control_vars = md->GetMeshPointer()->resolved_packages->GetControlVariables();
   auto desc = MakePackDescriptor(md->GetMeshPointer()->resolved_packages.get(),
                                  control_vars, {Metadata::Sparse});
   auto pack = desc.GetPack(md);
-  auto packIdx = desc.GetMap();
-
-  ParArray2D<bool> is_zero("IsZero", pack.GetNBlocks(), pack.GetMaxNumberOfVars());
-  const int Ni = ib.e + 1 - ib.s;
-  const int Nj = jb.e + 1 - jb.s;
-  const int Nk = kb.e + 1 - kb.s;
-  const int NjNi = Nj * Ni;
-  const int NkNjNi = Nk * NjNi;
+  // The variable groups of the pack follow the order of control_vars
+  const int ncontrol = control_vars.size();
+
+  // Sparse packs only contain allocated variables, so if no control variable is
+  // allocated on any block there is nothing to deallocate and we can skip the kernel and
+  // the copy back to the host altogether
+  bool any_allocated = false;
+  for (int b = 0; b < pack.GetNBlocks(); ++b) {
+    any_allocated = any_allocated || pack.ContainsHost(b);
+  }
+  if (!any_allocated) return TaskStatus::complete;
+
+  // One flag per block and control variable, reduced over the components of the control
+  // variable on the device so that only these flags need to be copied to the host. Every
+  // (block, control variable) pair is checked by its own team with a single reduction
+  // over all of its components, so that the teams neither loop over the control
+  // variables nor synchronize once per component.
+  const int nblocks = pack.GetNBlocks();
+  ParArray2D<bool> is_zero("IsZero", nblocks, ncontrol);
   Kokkos::parallel_for(
       PARTHENON_AUTO_LABEL,
-      Kokkos::TeamPolicy<>(parthenon::DevExecSpace(), pack.GetNBlocks(), Kokkos::AUTO),
+      Kokkos::TeamPolicy<>(md->exec_space, nblocks * ncontrol, Kokkos::AUTO),
       KOKKOS_LAMBDA(parthenon::team_mbr_t team_member) {
-        const int b = team_member.league_rank();
-
-        const int lo = pack.GetLowerBound(b);
-        const int hi = pack.GetUpperBound(b);
-
-        for (int v = lo; v <= hi; ++v) {
-          const auto &var = pack(b, v);
-          const Real threshold = var.deallocation_threshold;
-          bool all_zero = true;
-          const auto &var_raw = var.data();
+        const int b = team_member.league_rank() / ncontrol;
+        const int c = team_member.league_rank() % ncontrol;
+        const int lo = pack.GetLowerBound(b, PackIdx(c));
+        const int hi = pack.GetUpperBound(b, PackIdx(c));
+        bool all_zero = true;
+        if (hi >= lo) {
+          // All components of a variable have the same size
+          const int nel = pack(b, lo).size();
           Kokkos::parallel_reduce(
-              Kokkos::TeamThreadRange<>(team_member, var.size()),
+              Kokkos::TeamThreadRange<>(team_member, (hi - lo + 1) * nel),
               [&](const int idx, bool &lall_zero) {
-                if (std::abs(var_raw[idx]) > threshold) {
-                  lall_zero = false;
-                  return;
-                }
+                const auto &var = pack(b, lo + idx / nel);
+                lall_zero = lall_zero && (std::abs(var.data()[idx % nel]) <=
+                                          var.deallocation_threshold);
               },
               Kokkos::LAnd<bool, DevMemSpace>(all_zero));
-          Kokkos::single(Kokkos::PerTeam(team_member),
-                         [&]() { is_zero(b, v) = all_zero; });
         }
+        Kokkos::single(Kokkos::PerTeam(team_member), [&]() { is_zero(b, c) = all_zero; });
       });
 
-  auto is_zero_h = Kokkos::create_mirror_view_and_copy(HostMemSpace(), is_zero);
+  // Only wait for the instance of this partition rather than for the whole device
+  auto is_zero_h = Kokkos::create_mirror_view(HostMemSpace(), is_zero);
+  Kokkos::deep_copy(md->exec_space, is_zero_h, is_zero);
+  md->exec_space.fence();
 
-  for (int b = 0; b < pack.GetNBlocks(); ++b) {
-    for (auto &control_var : control_vars) {
-      int lo = pack.GetLowerBoundHost(b, PackIdx(packIdx[control_var]));
-      int hi = pack.GetUpperBoundHost(b, PackIdx(packIdx[control_var]));
+  for (int b = 0; b < nblocks; ++b) {
+    for (int c = 0; c < ncontrol; ++c) {
+      const auto &control_var = control_vars[c];
+      int lo = pack.GetLowerBoundHost(b, PackIdx(c));
+      int hi = pack.GetUpperBoundHost(b, PackIdx(c));
       if (lo <= hi) { // Check that this control variable is actually in the pack
         auto &counter = md->GetBlockData(b)->Get(control_var).dealloc_count;
-        bool all_zero = true;
-        for (int iv = lo; iv <= hi; ++iv)
-          all_zero = all_zero && is_zero_h(b, iv);
-        if (all_zero) {
+        if (is_zero_h(b, c)) {
           counter++;
         } else {
           counter = 0;
@@ -219,6 +538,120 @@ TaskStatus SparseDealloc(MeshData<Real> *md) {
   return TaskStatus::complete;
 }
 
+namespace {
+// A timestep criterion as evaluated on the device by EstimateCriteriaTimestep
+struct BatchedTimestepCriterion {
+  TimestepCriterion::Type type;
+  int var; // variable group in the pack, or -1 for constant values
+  Real values[3];
+  Real factor;
+};
+
+// Cell widths of the blocks of a MeshData from its shared geometry table, or of the
+// block of a MeshBlockData from its coordinates
+BlockGeometry GetGeometry_(MeshData<Real> *md) {
+  return md->GetBlockMetadata().geometry;
+}
+struct SingleBlockGeometry {
+  Coordinates_t coords;
+  KOKKOS_FORCEINLINE_FUNCTION
+  Real Dx(const int, const int dir) const { return coords.DxcFA(dir); }
+};
+SingleBlockGeometry GetGeometry_(MeshBlockData<Real> *mbd) {
+  return SingleBlockGeometry{mbd->GetBlockPointer()->coords};
+}
+
+template <class T>
+Real EstimateCriteriaTimestep_(T *rc) {
+  PARTHENON_INSTRUMENT
+  auto pmesh = rc->GetMeshPointer();
+  std::vector<std::string> fields;
+  std::vector<BatchedTimestepCriterion> criteria;
+  for (auto &[name, pkg] : pmesh->packages.AllPackages()) {
+    for (auto &tc : pkg->timestep_criteria) {
+      int var = -1;
+      if (!tc.field.empty()) {
+        auto it = std::find(fields.begin(), fields.end(), tc.field);
+        var = it - fields.begin();
+        if (it == fields.end()) fields.push_back(tc.field);
+      }
+      criteria.push_back(BatchedTimestepCriterion{
+          tc.type, var, {tc.values[0], tc.values[1], tc.values[2]}, tc.factor});
+    }
+  }
+  const int ncriteria = criteria.size();
+  if (ncriteria == 0) return std::numeric_limits<Real>::max();
+
+  ParArray1D<BatchedTimestepCriterion> criteria_d("timestep criteria", ncriteria);
+  auto criteria_h = criteria_d.GetHostMirror();
+  for (int c = 0; c < ncriteria; ++c)
+    criteria_h(c) = criteria[c];
+  criteria_d.DeepCopy(criteria_h);
+
+  auto desc =
+      MakePackDescriptor(pmesh->resolved_packages.get(), fields, {Metadata::Cell});
+  auto pack = desc.GetPack(rc);
+  const IndexRange ib = rc->GetBoundsI(IndexDomain::interior);
+  const IndexRange jb = rc->GetBoundsJ(IndexDomain::interior);
+  const IndexRange kb = rc->GetBoundsK(IndexDomain::interior);
+  const int ndim = pmesh->ndim;
+  const auto geom = GetGeometry_(rc);
+
+  using TCType = TimestepCriterion::Type;
+  Real min_dt = std::numeric_limits<Real>::max();
+  par_reduce(
+      loop_pattern_mdrange_tag, PARTHENON_AUTO_LABEL, DevExecSpace(), 0,
+      pack.GetNBlocks() - 1, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+      KOKKOS_LAMBDA(const int b, const int k, const int j, const int i, Real &lmin_dt) {
+        const Real dx[3] = {geom.Dx(b, X1DIR), geom.Dx(b, X2DIR), geom.Dx(b, X3DIR)};
+        Real dx_min = dx[0];
+        for (int d = 1; d < ndim; ++d)
+          dx_min = dx[d] < dx_min ? dx[d] : dx_min;
+        for (int c = 0; c < ncriteria; ++c) {
+          const auto &crit = criteria_d(c);
+          Real s[3] = {crit.values[0], crit.values[1], crit.values[2]};
+          if (crit.var >= 0) {
+            const int lo = pack.GetLowerBound(b, PackIdx(crit.var));
+            const int hi = pack.GetUpperBound(b, PackIdx(crit.var));
+            if (hi < lo) continue; // unallocated sparse field
+            if (crit.type == TCType::signal_speed) {
+              for (int d = 0; d < 3; ++d)
+                s[d] = pack(b, hi - lo >= 2 ? lo + d : lo, k, j, i);
+            } else {
+              s[0] = 0.0;
+              for (int v = lo; v <= hi; ++v)
+                s[0] = std::max(s[0], std::abs(pack(b, v, k, j, i)));
+            }
+          }
+          if (crit.type == TCType::signal_speed) {
+            for (int d = 0; d < ndim; ++d) {
+              const Real sd = std::abs(s[d]);
+              if (sd > 0.0) lmin_dt = std::min(lmin_dt, crit.factor * dx[d] / sd);
+            }
+          } else {
+            const Real r = std::abs(s[0]);
+            if (r > 0.0) {
+              const Real scale = crit.type == TCType::diffusion ? dx_min * dx_min : 1.0;
+              lmin_dt = std::min(lmin_dt, crit.factor * scale / r);
+            }
+          }
+        }
+      },
+      Kokkos::Min<Real>(min_dt));
+  return min_dt;
+}
+} // namespace
+
+template <>
+Real EstimateCriteriaTimestep(MeshBlockData<Real> *rc) {
+  return EstimateCriteriaTimestep_(rc);
+}
+
+template <>
+Real EstimateCriteriaTimestep(MeshData<Real> *rc) {
+  return EstimateCriteriaTimestep_(rc);
+}
+
 } // namespace Update
 
 } // namespace parthenon
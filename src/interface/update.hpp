@@ -58,6 +58,17 @@ Real FluxDivHelper(const int l, const int k, const int j, const int i, const int
 template <typename T>
 TaskStatus FluxDivergence(T *in, T *dudt_obj);
 
+// Tasks for MeshData::AcquireFluxes and ReleaseFluxes around the computation and last
+// use of the fluxes of a stage with <parthenon/mesh> transient_fluxes
+inline TaskStatus AcquireFluxes(MeshData<Real> *md) {
+  md->AcquireFluxes();
+  return TaskStatus::complete;
+}
+inline TaskStatus ReleaseFluxes(MeshData<Real> *md) {
+  md->ReleaseFluxes();
+  return TaskStatus::complete;
+}
+
 // Update for low-storage integrators implemented as described in Sec. 3.2.3 of
 // Athena++ method paper. Specifically eq (11) at stage s
 // u(0) <- gamma_s0 * u(0) + gamma_s1 * u(1) + beta_{s,s-1} * dt * F(u(0))
@@ -67,6 +78,66 @@ template <typename T>
 TaskStatus UpdateWithFluxDivergence(T *data_u0, T *data_u1, const Real gam0,
                                     const Real gam1, const Real beta_dt);
 
+// Fused FluxDivergence and Update2S (see below) in a single pass over the data, i.e.
+// the right-hand side is computed from the fluxes of s0 on the fly instead of being
+// written to and read back from a separate container
+TaskStatus Update2SWithFluxDivergence(MeshData<Real> *s0_data, MeshData<Real> *s1_data,
+                                      const LowStorageIntegrator *pint, Real dt,
+                                      int stage, bool update_s1);
+
+// Fused FluxDivergence and SumButcher/UpdateButcher for the (zero-based) stage of a
+// Butcher tableau. In a single pass this stores the right-hand side S_stage computed
+// from the fluxes of in_data in stage_data[stage] and sets
+// out <- base + dt * sum_{j<=stage} a_{stage+1,j} S_j
+// which is the input of the next stage, or, after the last stage,
+// out <- base + dt * sum_j b_j S_j
+TaskStatus ButcherStageWithFluxDivergence(MeshData<Real> *in_data,
+                                          MeshData<Real> *base_data,
+                                          const std::vector<MeshData<Real> *> &stage_data,
+                                          MeshData<Real> *out_data,
+                                          const ButcherIntegrator *pint, Real dt,
+                                          int stage);
+
+// Register-based variant of ButcherStageWithFluxDivergence that stores S_stage in
+// rhs_registers[pint->rhs_register[stage]] and accumulates base + dt * sum_j b_j S_j in
+// acc_data while going through the stages, so only pint->nrhs_registers right-hand
+// sides have to be kept instead of one per stage. Sets out to the input of the next
+// stage, or after the last stage to the new state. out_data may be the same MeshData
+// as in_data (its fluxes are used, not its state), so with pint->register_name all
+// intermediate states share one register. Not for embedded tableaux, whose error
+// estimate needs the right-hand sides of all stages.
+TaskStatus ButcherRegisterStage(MeshData<Real> *in_data, MeshData<Real> *base_data,
+                                const std::vector<MeshData<Real> *> &rhs_registers,
+                                MeshData<Real> *acc_data, MeshData<Real> *out_data,
+                                const ButcherIntegrator *pint, Real dt, int stage);
+
+// Error estimate of an embedded Butcher tableau after the last stage, with out_data the
+// candidate solution and stage_data the right-hand sides of all stages. Maximizes
+// |dt * sum_j (b_j - b_embedded_j) S_j| / (atol + rtol * max(|base|, |out|)) over the
+// cells of the MeshData into *error, which is meant to be reduced over all ranks with
+// MPI_MAX into pint->error. base_data must not be modified before the step is accepted.
+TaskStatus ButcherErrorEstimate(MeshData<Real> *base_data,
+                                const std::vector<MeshData<Real> *> &stage_data,
+                                MeshData<Real> *out_data, const ButcherIntegrator *pint,
+                                Real dt, Real *error);
+
+// Stages of an IMEX tableau. For stage (0-based) < nstages this sets the right-hand side
+// of the implicit solve of the stage, or its solution if the stage is explicit,
+// out <- base + dt * sum_{j<stage} (a_ex[stage][j] E_j + a_im[stage][j] I_j)
+// and for stage == nstages the final update with b_ex and b_im. explicit_data and
+// implicit_data hold the explicit and implicit right-hand sides E_j and I_j.
+TaskStatus ImexStageSum(const std::vector<MetadataFlag> &flags, MeshData<Real> *base_data,
+                        const std::vector<MeshData<Real> *> &explicit_data,
+                        const std::vector<MeshData<Real> *> &implicit_data,
+                        MeshData<Real> *out_data, const ImexIntegrator *pint, int stage);
+
+// Recover the implicit right-hand side of an implicit stage from its solution u and the
+// right-hand side rhs of its solve, I <- (u - rhs) / (dt * a_im[stage][stage]), which
+// avoids applying the implicit operator once more
+TaskStatus ImexImplicitRHS(const std::vector<MetadataFlag> &flags, MeshData<Real> *u_data,
+                           MeshData<Real> *rhs_data, MeshData<Real> *implicit_data,
+                           const ImexIntegrator *pint, int stage);
+
 template <typename F, typename T>
 TaskStatus WeightedSumData(const F &flags, T *in1, T *in2, const Real w1, const Real w2,
                            T *out) {
@@ -135,6 +206,64 @@ TaskStatus AverageIndependentData(T *c1, T *c2, const Real wgt1) {
                          (1.0 - wgt1), c1);
 }
 
+// Fused linear combination out <- sum_n w[n] * in[n] (+ w_out * out if accumulate) of
+// the variables matching flags of any number of containers in a single kernel, so that
+// every input is read and out is written only once instead of once per term. out may be
+// one of the inputs. Only the cells of domain are updated.
+template <typename F, typename T>
+TaskStatus LinearCombinationData(const F &flags, const std::vector<T *> &in,
+                                 const std::vector<Real> &w, T *out,
+                                 const bool accumulate = false, const Real w_out = 1.0,
+                                 const IndexDomain domain = IndexDomain::entire) {
+  PARTHENON_INSTRUMENT
+  PARTHENON_REQUIRE_THROWS(in.size() == w.size(),
+                           "Need one weight for every term of the linear combination");
+  const auto &z = out->PackVariables(flags);
+  using pack_t = std::decay_t<decltype(z)>;
+  const int nterms = in.size();
+  ParArray1D<pack_t> packs("LinearCombinationData packs", std::max(nterms, 1));
+  ParArray1D<Real> weights("LinearCombinationData weights", std::max(nterms, 1));
+  auto packs_h = Kokkos::create_mirror_view(HostMemSpace(), packs);
+  auto weights_h = Kokkos::create_mirror_view(HostMemSpace(), weights);
+  for (int n = 0; n < nterms; ++n) {
+    packs_h(n) = in[n]->PackVariables(flags);
+    weights_h(n) = w[n];
+  }
+  Kokkos::deep_copy(packs, packs_h);
+  Kokkos::deep_copy(weights, weights_h);
+
+  IndexRange ib{0, z.GetDim(1) - 1}, jb{0, z.GetDim(2) - 1}, kb{0, z.GetDim(3) - 1};
+  if (domain != IndexDomain::entire) {
+    ib = out->GetBoundsI(domain);
+    jb = out->GetBoundsJ(domain);
+    kb = out->GetBoundsK(domain);
+  }
+  parthenon::par_for(
+      PARTHENON_AUTO_LABEL, 0, z.GetDim(5) - 1, 0, z.GetDim(4) - 1, kb.s, kb.e, jb.s,
+      jb.e, ib.s, ib.e,
+      KOKKOS_LAMBDA(const int b, const int l, const int k, const int j, const int i) {
+        if (!z.IsAllocated(b, l)) return;
+        // Same as WeightedSumData, the sum is only written if all terms are allocated
+        for (int n = 0; n < nterms; ++n) {
+          if (!packs(n).IsAllocated(b, l)) return;
+        }
+        Real sum = accumulate ? w_out * z(b, l, k, j, i) : 0.0;
+        for (int n = 0; n < nterms; ++n) {
+          sum += weights(n) * packs(n)(b, l, k, j, i);
+        }
+        z(b, l, k, j, i) = sum;
+      });
+  return TaskStatus::complete;
+}
+
+// In-place variant of LinearCombinationData, out <- w_out * out + sum_n w[n] * in[n]
+template <typename F, typename T>
+TaskStatus AccumulateData(const F &flags, T *out, const Real w_out,
+                          const std::vector<T *> &in, const std::vector<Real> &w,
+                          const IndexDomain domain = IndexDomain::entire) {
+  return LinearCombinationData(flags, in, w, out, true, w_out, domain);
+}
+
 // See equation 14 in Ketcheson, Jcomp 229 (2010) 1763-1773
 // In Parthenon language, s0 is the variable we are updating
 // and rhs should be computed with respect to s0.
@@ -191,34 +320,14 @@ TaskStatus SumButcher(const F &flags, std::shared_ptr<T> base_data,
                       std::vector<std::shared_ptr<T>> stage_data,
                       std::shared_ptr<T> out_data, const ButcherIntegrator *pint, Real dt,
                       int stage) {
-  PARTHENON_INSTRUMENT
-  const auto &out = out_data->PackVariables(flags);
-  const auto &in = base_data->PackVariables(flags);
-  const IndexDomain interior = IndexDomain::interior;
-  const IndexRange ib = out_data->GetBoundsI(interior);
-  const IndexRange jb = out_data->GetBoundsJ(interior);
-  const IndexRange kb = out_data->GetBoundsK(interior);
-  parthenon::par_for(
-      PARTHENON_AUTO_LABEL, 0, out.GetDim(5) - 1, 0, out.GetDim(4) - 1, kb.s, kb.e, jb.s,
-      jb.e, ib.s, ib.e,
-      KOKKOS_LAMBDA(const int b, const int l, const int k, const int j, const int i) {
-        if (out.IsAllocated(b, l) && in.IsAllocated(b, l)) {
-          out(b, l, k, j, i) = in(b, l, k, j, i);
-        }
-      });
+  std::vector<T *> in{base_data.get()};
+  std::vector<Real> w{1.0};
   for (int prev = 0; prev < stage; ++prev) {
-    Real a = pint->a[stage - 1][prev];
-    const auto &in = stage_data[stage]->PackVariables(flags);
-    parthenon::par_for(
-        PARTHENON_AUTO_LABEL, 0, out.GetDim(5) - 1, 0, out.GetDim(4) - 1, kb.s, kb.e,
-        jb.s, jb.e, ib.s, ib.e,
-        KOKKOS_LAMBDA(const int b, const int l, const int k, const int j, const int i) {
-          if (out.IsAllocated(b, l) && in.IsAllocated(b, l)) {
-            out(b, l, k, j, i) += dt * a * in(b, l, k, j, i);
-          }
-        });
+    in.push_back(stage_data[prev].get());
+    w.push_back(dt * pint->a[stage - 1][prev]);
   }
-  return TaskStatus::complete;
+  return LinearCombinationData(flags, in, w, out_data.get(), false, 1.0,
+                               IndexDomain::interior);
 }
 template <typename T>
 TaskStatus SumButcherIndependent(std::shared_ptr<T> base_data,
@@ -234,41 +343,31 @@ template <typename F, typename T>
 TaskStatus UpdateButcher(const F &flags, std::vector<std::shared_ptr<T>> stage_data,
                          std::shared_ptr<T> out_data, const ButcherIntegrator *pint,
                          Real dt) {
-  PARTHENON_INSTRUMENT
-
-  const auto &out = out_data->PackVariables(flags);
-  const IndexDomain interior = IndexDomain::interior;
-  const IndexRange ib = out_data->GetBoundsI(interior);
-  const IndexRange jb = out_data->GetBoundsJ(interior);
-  const IndexRange kb = out_data->GetBoundsK(interior);
-
-  const int nstages = pint->nstages;
-  for (int stage = 0; stage < nstages; ++stage) {
-    const Real butcher_b = pint->b[stage];
-    const auto &in = stage_data[stage]->PackVariables(flags);
-    parthenon::par_for(
-        PARTHENON_AUTO_LABEL, 0, out.GetDim(5) - 1, 0, out.GetDim(4) - 1, kb.s, kb.e,
-        jb.s, jb.e, ib.s, ib.e,
-        KOKKOS_LAMBDA(const int b, const int l, const int k, const int j, const int i) {
-          if (out.IsAllocated(b, l) && in.IsAllocated(b, l)) {
-            out(b, l, k, j, i) += dt * b * in(b, l, k, j, i);
-          }
-        });
+  std::vector<T *> in;
+  std::vector<Real> w;
+  for (int stage = 0; stage < pint->nstages; ++stage) {
+    in.push_back(stage_data[stage].get());
+    w.push_back(dt * pint->b[stage]);
   }
-  return TaskStatus::complete;
+  return AccumulateData(flags, out_data.get(), 1.0, in, w, IndexDomain::interior);
 }
-template <typename F, typename T>
+template <typename T>
 TaskStatus UpdateButcherIndependent(std::vector<std::shared_ptr<T>> stage_data,
                                     std::shared_ptr<T> out_data,
                                     const ButcherIntegrator *pint, Real dt) {
-  return UpdateButcherIndependent(std::vector<MetadataFlag>({Metadata::Independent}),
+  return UpdateButcher(std::vector<MetadataFlag>({Metadata::Independent}),
                                   stage_data, out_data, pint, dt);
 }
 
+// Minimum over the cells of rc of the StateDescriptor::timestep_criteria of all
+// packages, evaluated in a single kernel
+template <typename T>
+Real EstimateCriteriaTimestep(T *rc);
+
 template <typename T>
 TaskStatus EstimateTimestep(T *rc) {
   PARTHENON_INSTRUMENT
-  Real dt_min = std::numeric_limits<Real>::max();
+  Real dt_min = EstimateCriteriaTimestep(rc);
   for (const auto &pkg : rc->GetParentPointer()->packages.AllPackages()) {
     Real dt = pkg.second->EstimateTimestep(rc);
     dt_min = std::min(dt_min, dt);
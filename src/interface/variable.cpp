@@ -38,6 +38,7 @@ Variable<T>::Variable(const std::string &base_name, const Metadata &metadata,
   PARTHENON_REQUIRE_THROWS(IsSparse() == (sparse_id_ != InvalidSparseID),
                            "Mismatch between sparse flag and sparse ID");
   uid_ = get_uid_(label());
+  ++allocation_generation_;
 
   if (m_.getAssociated() == "") {
     m_.Associate(label());
@@ -71,8 +72,7 @@ std::string Variable<T>::info() {
 // assign them to this variable
 template <typename T>
 void Variable<T>::CopyFluxesAndBdryVar(const Variable<T> *src) {
-  if (IsSet(Metadata::FillGhost) || IsSet(Metadata::Independent) ||
-      IsSet(Metadata::ForceRemeshComm) || IsSet(Metadata::Flux)) {
+  if (UsesCoarseBuffer()) {
     // no need to check mesh->multilevel, if false, we're just making a shallow copy of
     // an empty ParArrayND
     coarse_s = src->coarse_s;
@@ -96,6 +96,15 @@ std::shared_ptr<Variable<T>> Variable<T>::AllocateCopy(std::weak_ptr<MeshBlock>
   return cv;
 }
 
+template <typename T>
+std::shared_ptr<Variable<T>> Variable<T>::Stamp() const {
+  PARTHENON_REQUIRE_THROWS(!is_allocated_ && data.size() == 0,
+                           "Only variables without data can be stamped: " + label());
+  auto cv = std::make_shared<Variable<T>>(*this);
+  ++allocation_generation_;
+  return cv;
+}
+
 template <typename T>
 void Variable<T>::Allocate(std::weak_ptr<MeshBlock> wpmb, bool flag_uninitialized) {
   if (is_allocated_) {
@@ -111,10 +120,13 @@ void Variable<T>::AllocateData(MeshBlock *pmb, bool flag_uninitialized) {
   PARTHENON_REQUIRE_THROWS(
       !is_allocated_,
       "Tried to allocate data for variable that's already allocated: " + label());
-  data = std::make_from_tuple<ParArrayND<T, VariableState>>(std::tuple_cat(
-      std::make_tuple(label(), MakeVariableState()), ArrayToReverseTuple(dims_)));
+  data = ParArrayND<T, VariableState>(
+      std::apply([&](auto... dims) { return data_pool_.Get(label(), dims...); },
+                 ArrayToReverseTuple(dims_)),
+      MakeVariableState());
 
   ++num_alloc_;
+  ++allocation_generation_;
 
   data.initialized = !flag_uninitialized;
   is_allocated_ = true;
@@ -138,20 +150,32 @@ void Variable<T>::AllocateCoarse(std::weak_ptr<MeshBlock> wpmb) {
   std::string base_name = label();
 
   // Create the boundary object
-  if (IsSet(Metadata::FillGhost) || IsSet(Metadata::Independent) ||
-      IsSet(Metadata::ForceRemeshComm) || IsSet(Metadata::Flux)) {
+  if (UsesCoarseBuffer()) {
     if (wpmb.expired()) return;
     std::shared_ptr<MeshBlock> pmb = wpmb.lock();
 
-    if (pmb->pmy_mesh != nullptr && pmb->pmy_mesh->multilevel) {
-      coarse_s = std::make_from_tuple<ParArrayND<T, VariableState>>(
-          std::tuple_cat(std::make_tuple(label() + ".coarse", MakeVariableState()),
-                         ArrayToReverseTuple(coarse_dims_)));
+    if (pmb->pmy_mesh != nullptr && pmb->pmy_mesh->multilevel &&
+        pmb->CoarseBuffersAllocated()) {
+      coarse_s = ParArrayND<T, VariableState>(
+          std::apply(
+              [&](auto... dims) { return data_pool_.Get(label() + ".coarse", dims...); },
+              ArrayToReverseTuple(coarse_dims_)),
+          MakeVariableState());
+      ++allocation_generation_;
       pmb->LogMemUsage(coarse_s.size() * sizeof(T));
     }
   }
 }
 
+template <typename T>
+std::int64_t Variable<T>::ReleaseCoarse() {
+  if (coarse_s.size() == 0) return 0;
+  const std::int64_t mem_size = coarse_s.size() * sizeof(T);
+  data_pool_.Release(coarse_s.KokkosView());
+  ++allocation_generation_;
+  return mem_size;
+}
+
 template <typename T>
 std::int64_t Variable<T>::Deallocate() {
   std::int64_t mem_size = 0;
@@ -161,15 +185,17 @@ std::int64_t Variable<T>::Deallocate() {
   }
 
   mem_size += data.size() * sizeof(T);
-  data.Reset();
-
-  if (IsSet(Metadata::FillGhost) || IsSet(Metadata::Independent) ||
-      IsSet(Metadata::ForceRemeshComm) || IsSet(Metadata::Flux)) {
-    mem_size += coarse_s.size() * sizeof(T);
-    coarse_s.Reset();
+  if (contiguous_) {
+    data = ParArrayND<T, VariableState>();
+    contiguous_ = false;
+  } else {
+    data_pool_.Release(data.KokkosView());
   }
 
+  if (UsesCoarseBuffer()) mem_size += ReleaseCoarse();
+
   is_allocated_ = false;
+  ++allocation_generation_;
   return mem_size;
 #else
   PARTHENON_THROW("Variable<T>::Deallocate(): Sparse is compile-time disabled");
@@ -177,6 +203,43 @@ std::int64_t Variable<T>::Deallocate() {
 #endif
 }
 
+template <typename T>
+void Variable<T>::RelocateData(
+    const typename ParArrayND<T, VariableState>::base_t &storage) {
+  PARTHENON_REQUIRE_THROWS(IsAllocated() && storage.size() == data.size(),
+                           "Contiguous storage of " + label() +
+                               " does not match its data.");
+  Kokkos::deep_copy(storage, data.KokkosView());
+  const bool initialized = data.initialized;
+  if (!contiguous_) data_pool_.Release(data.KokkosView());
+  data = ParArrayND<T, VariableState>(storage, MakeVariableState());
+  data.initialized = initialized;
+  contiguous_ = true;
+  // Caches holding views of the old data have to be rebuilt
+  ++num_alloc_;
+  ++allocation_generation_;
+}
+
+template <typename T>
+void Variable<T>::UseTransientStorage(T *ptr) {
+  PARTHENON_REQUIRE_THROWS(IsAllocated(),
+                           "Tried to move unallocated variable " + label() +
+                               " to transient storage.");
+  const auto &view = data.KokkosView();
+  const bool initialized = data.initialized;
+  // Freed rather than recycled, since not holding the storage is the point
+  data = ParArrayND<T, VariableState>(
+      typename ParArrayND<T, VariableState>::base_t(
+          ptr, view.extent(0), view.extent(1), view.extent(2), view.extent(3),
+          view.extent(4), view.extent(5), view.extent(6)),
+      MakeVariableState());
+  data.initialized = initialized;
+  contiguous_ = true;
+  // Caches holding views of the old data have to be rebuilt
+  ++num_alloc_;
+  ++allocation_generation_;
+}
+
 template <typename T>
 ParticleVariable<T>::ParticleVariable(const std::string &label, const int npool,
                                       const Metadata &metadata)
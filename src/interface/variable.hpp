@@ -25,7 +25,9 @@
 /// for actural data storage and generation
 
 #include <array>
+#include <atomic>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <limits>
 #include <map>
@@ -46,6 +48,7 @@
 #include "prolong_restrict/prolong_restrict.hpp"
 #include "utils/error_checking.hpp"
 #include "utils/unique_id.hpp"
+#include "utils/view_pool.hpp"
 
 namespace parthenon {
 
@@ -64,13 +67,22 @@ class Variable {
               std::weak_ptr<MeshBlock> wpmb);
 
   Variable() = default;
-  ~Variable() {}
+  ~Variable() {
+    // Contiguous and transient storage is shared with other blocks and can't be recycled
+    // on its own
+    if (!contiguous_) data_pool_.Release(data.KokkosView());
+    data_pool_.Release(coarse_s.KokkosView());
+  }
   // copy fluxes and boundary variable from src Variable (shallow copy)
   void CopyFluxesAndBdryVar(const Variable<T> *src);
 
   // make a new Variable based on an existing one
   std::shared_ptr<Variable<T>> AllocateCopy(std::weak_ptr<MeshBlock> wpmb);
 
+  // make a new Variable without data from this one, which must not have data either, for
+  // a block of the same size as the one this was created for
+  std::shared_ptr<Variable<T>> Stamp() const;
+
   // accessors
   template <class... Args>
   KOKKOS_FORCEINLINE_FUNCTION auto &operator()(Args... args) const {
@@ -135,6 +147,15 @@ class Variable {
 
   inline bool IsSet(const MetadataFlag bit) const { return m_.IsSet(bit); }
 
+  // Move the data into storage, a view of the same extents that is part of an
+  // allocation shared with the same variable on other blocks, see
+  // MeshData::BuildContiguousStorage
+  void RelocateData(const typename ParArrayND<T, VariableState>::base_t &storage);
+  // Point the data to the (uninitialized) storage at ptr, which is owned by an arena of
+  // MeshData::AcquireFluxes, without copying it. The current data is deallocated.
+  void UseTransientStorage(T *ptr);
+  bool HasContiguousStorage() const { return contiguous_; }
+
   ParArrayND<T, VariableState> data;
   ParArrayND<T, VariableState> coarse_s; // used for sending coarse boundary calculation
 
@@ -147,6 +168,15 @@ class Variable {
     return num_alloc_;
   }
 
+  // Incremented whenever any variable is created, allocated, or deallocated, so caches
+  // that depend on allocation statuses can cheaply check whether they may be stale
+  static std::size_t GetAllocationGeneration() { return allocation_generation_.load(); }
+
+  using data_pool_t = ViewPool<typename ParArrayND<T, VariableState>::base_t>;
+  // The data and coarse buffers of all variables are taken from and returned to this
+  // pool, so the storage of destroyed blocks is reused by newly created ones
+  static data_pool_t &GetDataPool() { return data_pool_; }
+
   std::vector<TopologicalElement> GetTopologicalElements() const {
     using TE = TopologicalElement;
     if (IsSet(Metadata::Face)) return {TE::F1, TE::F2, TE::F3};
@@ -171,6 +201,14 @@ class Variable {
   /// (Metadata::FillGhost is set)
   void AllocateCoarse(std::weak_ptr<MeshBlock> wpmb);
 
+  // release the coarse buffer only, returns the number of bytes released
+  std::int64_t ReleaseCoarse();
+
+  bool UsesCoarseBuffer() const {
+    return IsSet(Metadata::FillGhost) || IsSet(Metadata::Independent) ||
+           IsSet(Metadata::ForceRemeshComm) || IsSet(Metadata::Flux);
+  }
+
   VariableState MakeVariableState() const { return VariableState(m_, sparse_id_, dims_); }
 
   Metadata m_;
@@ -185,8 +223,11 @@ class Variable {
   // This generator needs to be global so that different instances of
   // variable have the same unique ID.
   inline static UniqueIDGenerator<std::string> get_uid_;
+  inline static std::atomic<std::size_t> allocation_generation_{0};
+  inline static data_pool_t data_pool_;
 
   bool is_allocated_ = false;
+  bool contiguous_ = false;
 };
 
 template <typename T>
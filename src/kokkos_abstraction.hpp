@@ -20,6 +20,7 @@
 #ifndef KOKKOS_ABSTRACTION_HPP_
 #define KOKKOS_ABSTRACTION_HPP_
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <type_traits>
@@ -32,6 +33,7 @@
 #include "parthenon_array_generic.hpp"
 #include "utils/error_checking.hpp"
 #include "utils/instrument.hpp"
+#include "utils/loop_autotune.hpp"
 #include "utils/multi_pointer.hpp"
 #include "utils/object_pool.hpp"
 
@@ -64,6 +66,15 @@ using BufMemSpace = Kokkos::Experimental::HipHostPinnedSpace::memory_space;
 using BufMemSpace = Kokkos::DefaultExecutionSpace::memory_space;
 #endif
 
+// Page locked host memory for staging device data that MPI can't access directly
+#if defined(KOKKOS_ENABLE_CUDA)
+using HostPinnedMemSpace = Kokkos::CudaHostPinnedSpace::memory_space;
+#elif defined(KOKKOS_ENABLE_HIP)
+using HostPinnedMemSpace = Kokkos::Experimental::HipHostPinnedSpace::memory_space;
+#else
+using HostPinnedMemSpace = Kokkos::HostSpace;
+#endif
+
 // MPI communication buffers
 template <typename T>
 using BufArray1D = Kokkos::View<T *, LayoutWrapper, BufMemSpace>;
@@ -168,6 +179,10 @@ static struct LoopPatternTPTVR {
 // inner Kokkos::ThreadVectorRange
 static struct LoopPatternTPTTRTVR {
 } loop_pattern_tpttrtvr_tag;
+// Selects one of the patterns above at runtime per kernel label from timing the first
+// invocations, see LoopAutotuner. Only 3D loops are tuned, others use MDRange.
+static struct LoopPatternAutotune {
+} loop_pattern_autotune_tag;
 // Used to catch undefined behavior as it results in throwing an error
 static struct LoopPatternUndefined {
 } loop_pattern_undefined_tag;
@@ -216,7 +231,9 @@ inline void kokkos_dispatch(ParallelScanDispatch, Args &&...args) {
 
 // 1D loop using RangePolicy loops
 template <typename Tag, typename Pattern, typename Function, class... Args>
-inline typename std::enable_if<sizeof...(Args) <= 1, void>::type
+inline typename std::enable_if<sizeof...(Args) <= 1 &&
+                                   !std::is_same<Pattern, LoopPatternAutotune>::value,
+                               void>::type
 par_dispatch(Pattern, const std::string &name, DevExecSpace exec_space, const int &il,
              const int &iu, const Function &function, Args &&...args) {
   PARTHENON_INSTRUMENT_REGION(name)
@@ -237,7 +254,9 @@ par_dispatch(Pattern, const std::string &name, DevExecSpace exec_space, const in
 }
 
 template <typename Tag, typename Pattern, typename Function, class... Args>
-inline typename std::enable_if<sizeof...(Args) <= 1, void>::type
+inline typename std::enable_if<sizeof...(Args) <= 1 &&
+                                   !std::is_same<Pattern, LoopPatternAutotune>::value,
+                               void>::type
 par_dispatch(Pattern p, const std::string &name, DevExecSpace exec_space,
              const IndexRange &r, const Function &function, Args &&...args) {
   par_dispatch<Tag>(p, name, exec_space, r.s, r.e, function, std::forward<Args>(args)...);
@@ -680,6 +699,81 @@ inline void par_dispatch(LoopPatternSimdFor, const std::string &name,
               function(l, m, n, k, j, i);
 }
 
+// Loops other than 3D (which take 7 or 8 arguments after the execution space) are not
+// tuned
+template <typename Tag, typename... Args>
+inline typename std::enable_if<sizeof...(Args) != 7 && sizeof...(Args) != 8, void>::type
+par_dispatch(LoopPatternAutotune, const std::string &name, DevExecSpace exec_space,
+             Args &&...args) {
+  par_dispatch<Tag>(loop_pattern_mdrange_tag, name, exec_space,
+                    std::forward<Args>(args)...);
+}
+
+// 3D loop with the pattern selected by the LoopAutotuner
+template <typename Tag, typename Function, class... Args>
+inline typename std::enable_if<sizeof...(Args) <= 1, void>::type
+par_dispatch(LoopPatternAutotune, const std::string &name, DevExecSpace exec_space,
+             const int kl, const int ku, const int jl, const int ju, const int il,
+             const int iu, const Function &function, Args &&...args) {
+  using Tuner = LoopAutotuner;
+  // Team patterns and simd loops only implement par_for
+  constexpr bool is_for = std::is_same<Tag, dispatch_impl::ParallelForDispatch>::value &&
+                          sizeof...(Args) == 0;
+  constexpr bool on_host =
+      Kokkos::SpaceAccessibility<Kokkos::HostSpace, DevMemSpace>::accessible;
+  unsigned allowed = Tuner::Bit(Tuner::flatrange) | Tuner::Bit(Tuner::mdrange) |
+                     Tuner::Bit(Tuner::mdrange_default_tile);
+  if (is_for) {
+    allowed |= Tuner::Bit(Tuner::tpttr) | Tuner::Bit(Tuner::tptvr) |
+               Tuner::Bit(Tuner::tpttrtvr);
+    if (on_host) allowed |= Tuner::Bit(Tuner::simdfor);
+  }
+  auto &tuner = Tuner::Instance();
+  const auto choice = tuner.Choose(name, allowed);
+  if (choice.measure) exec_space.fence();
+  Kokkos::Timer timer;
+  switch (choice.candidate) {
+  case Tuner::flatrange:
+    par_dispatch<Tag>(loop_pattern_flatrange_tag, name, exec_space, kl, ku, jl, ju, il,
+                      iu, function, std::forward<Args>(args)...);
+    break;
+  case Tuner::mdrange_default_tile: {
+    Tag tag;
+    kokkos_dispatch(tag, name,
+                    Kokkos::MDRangePolicy<Kokkos::Rank<3>>(exec_space, {kl, jl, il},
+                                                           {ku + 1, ju + 1, iu + 1}),
+                    function, std::forward<Args>(args)...);
+    break;
+  }
+  default:
+    if constexpr (is_for) {
+      if (choice.candidate == Tuner::tpttr) {
+        par_dispatch<Tag>(loop_pattern_tpttr_tag, name, exec_space, kl, ku, jl, ju, il,
+                          iu, function);
+      } else if (choice.candidate == Tuner::tptvr) {
+        par_dispatch<Tag>(loop_pattern_tptvr_tag, name, exec_space, kl, ku, jl, ju, il,
+                          iu, function);
+      } else if (choice.candidate == Tuner::tpttrtvr) {
+        par_dispatch<Tag>(loop_pattern_tpttrtvr_tag, name, exec_space, kl, ku, jl, ju,
+                          il, iu, function);
+      } else if (on_host && choice.candidate == Tuner::simdfor) {
+        par_dispatch<Tag>(loop_pattern_simdfor_tag, name, exec_space, kl, ku, jl, ju, il,
+                          iu, function);
+      } else {
+        par_dispatch<Tag>(loop_pattern_mdrange_tag, name, exec_space, kl, ku, jl, ju, il,
+                          iu, function);
+      }
+    } else {
+      par_dispatch<Tag>(loop_pattern_mdrange_tag, name, exec_space, kl, ku, jl, ju, il,
+                        iu, function, std::forward<Args>(args)...);
+    }
+  }
+  if (choice.measure) {
+    exec_space.fence();
+    tuner.Record(name, choice.candidate, timer.seconds());
+  }
+}
+
 template <typename Tag, typename... Args>
 inline void par_dispatch(const std::string &name, Args &&...args) {
   par_dispatch<Tag>(DEFAULT_LOOP_PATTERN, name, DevExecSpace(),
@@ -776,6 +870,85 @@ inline void par_for_outer(const std::string &name, Args &&...args) {
                 std::forward<Args>(args)...);
 }
 
+// NPads scratch pads of nvar x ni elements per team, e.g., for the left and right states
+// of a reconstruction along a row of cells. The required scratch size follows from the
+// dimensions, so kernels don't have to repeat the size computation of the allocation.
+template <int NPads, typename T = Real>
+class TeamScratchPads {
+ public:
+  using pads_t = Kokkos::Array<ScratchPad2D<T>, NPads>;
+
+  TeamScratchPads(const int nvar, const int ni, const int scratch_level = 1)
+      : nvar_(nvar), ni_(ni), scratch_level_(scratch_level) {}
+
+  size_t shmem_size() const { return NPads * ScratchPad2D<T>::shmem_size(nvar_, ni_); }
+  int nvar() const { return nvar_; }
+  int ni() const { return ni_; }
+  int scratch_level() const { return scratch_level_; }
+
+  // Carve the pads from the scratch of the team, has to be called once per team
+  KOKKOS_INLINE_FUNCTION
+  pads_t Get(const team_mbr_t &member) const {
+    pads_t pads;
+    for (int p = 0; p < NPads; ++p)
+      pads[p] = ScratchPad2D<T>(member.team_scratch(scratch_level_), nvar_, ni_);
+    return pads;
+  }
+
+ private:
+  int nvar_, ni_, scratch_level_;
+};
+
+// Outer parallel loop over the blocks [bl, bu] and the k-j rows of each of them with one
+// team per row, as (member, b, k, j, pads). The pads are carved from the scratch of the
+// team before the function is called. Instead of Kokkos::AUTO, teams on devices get the
+// row length rounded up to full warps (up to the maximum team size), so that the inner
+// loops over i are covered in a single pass.
+template <int NPads, typename T, typename Function>
+inline void par_for_blocks_teams(const std::string &name, DevExecSpace exec_space,
+                                 const TeamScratchPads<NPads, T> &scratch, const int bl,
+                                 const int bu, const int kl, const int ku, const int jl,
+                                 const int ju, const Function &function) {
+  const int Nb = bu - bl + 1;
+  const int Nk = ku - kl + 1;
+  const int Nj = ju - jl + 1;
+  const int NkNj = Nk * Nj;
+  if (Nb <= 0 || NkNj <= 0) return;
+
+  auto kernel = KOKKOS_LAMBDA(team_mbr_t team_member) {
+    const int b = team_member.league_rank() / NkNj + bl;
+    const int kj = team_member.league_rank() % NkNj;
+    const int k = kj / Nj + kl;
+    const int j = kj % Nj + jl;
+    auto pads = scratch.Get(team_member);
+    function(team_member, b, k, j, pads);
+  };
+
+  team_policy policy(exec_space, Nb * NkNj, Kokkos::AUTO);
+  if constexpr (!std::is_same_v<DevExecSpace, HostExecSpace>) {
+    constexpr int warp_size = 32;
+    const int team_size_max = team_policy(exec_space, Nb * NkNj, 1)
+                                  .set_scratch_size(scratch.scratch_level(),
+                                                    Kokkos::PerTeam(scratch.shmem_size()))
+                                  .team_size_max(kernel, Kokkos::ParallelForTag());
+    const int ni_warps = (scratch.ni() + warp_size - 1) / warp_size * warp_size;
+    const int team_size = std::max(1, std::min(team_size_max, ni_warps));
+    policy = team_policy(exec_space, Nb * NkNj, team_size);
+  }
+  Kokkos::parallel_for(
+      name,
+      policy.set_scratch_size(scratch.scratch_level(),
+                              Kokkos::PerTeam(scratch.shmem_size())),
+      kernel);
+}
+
+template <int NPads, typename T, typename... Args>
+inline void par_for_blocks_teams(const std::string &name,
+                                 const TeamScratchPads<NPads, T> &scratch,
+                                 Args &&...args) {
+  par_for_blocks_teams(name, DevExecSpace(), scratch, std::forward<Args>(args)...);
+}
+
 // Inner parallel loop using TeamThreadRange
 template <typename Function>
 KOKKOS_FORCEINLINE_FUNCTION void
@@ -75,6 +75,11 @@ enum class IndexDomain {
   outer_x3
 };
 
+// A rectangular region of the index space of a block
+struct IndexRegion {
+  IndexRange kb, jb, ib;
+};
+
 //! \class IndexVolume
 //  \brief Defines the dimensions of a shape of indices
 //
@@ -279,6 +284,56 @@ class IndexShape {
     return ke(domain, el) - ks(domain, el) + 1;
   }
 
+  //----------------------------------------------------------------------------------------
+  //! \fn IndexShape::GetCoreRegion(const IndexDomain &domain, const int depth, TE el)
+  //  \brief Returns the part of a domain that is at least depth cells away from its
+  //  edges in every direction that has ghost zones, i.e. the part that can be updated by
+  //  a stencil of half width depth without using any ghost zone data. This can be used to
+  //  overlap work with boundary communication. The region is empty (i.e. has a zero
+  //  sized range in at least one direction) if the domain is too small to have a core.
+  KOKKOS_INLINE_FUNCTION
+  IndexRegion GetCoreRegion(const IndexDomain &domain, const int depth,
+                            TE el = TE::CC) const noexcept {
+    IndexRegion core{GetBoundsK(domain, el), GetBoundsJ(domain, el),
+                     GetBoundsI(domain, el)};
+    IndexRange *ranges[3] = {&core.ib, &core.jb, &core.kb};
+    for (int d = 0; d < 3; ++d) {
+      if (entire_ncells_[d] == 1) continue;
+      ranges[d]->s += depth;
+      ranges[d]->e = std::max(ranges[d]->e - depth, ranges[d]->s - 1);
+    }
+    return core;
+  }
+
+  //----------------------------------------------------------------------------------------
+  //! \fn IndexShape::GetRimRegions(const IndexDomain &domain, const int depth, TE el)
+  //  \brief Returns non-overlapping regions that together with the core region (see
+  //  GetCoreRegion) cover the domain. These are the (up to two) slabs in x3 spanning the
+  //  whole domain in x2 and x1, the slabs in x2 limited to the core in x3 and the slabs
+  //  in x1 limited to the core in x3 and x2. Empty regions are omitted, and if the core
+  //  is empty the domain is returned as a single region.
+  std::vector<IndexRegion> GetRimRegions(const IndexDomain &domain, const int depth,
+                                         TE el = TE::CC) const {
+    const IndexRegion full{GetBoundsK(domain, el), GetBoundsJ(domain, el),
+                           GetBoundsI(domain, el)};
+    const IndexRegion core = GetCoreRegion(domain, depth, el);
+    const auto empty = [](const IndexRange &r) { return r.e < r.s; };
+    if (empty(core.kb) || empty(core.jb) || empty(core.ib)) return {full};
+
+    std::vector<IndexRegion> rim;
+    const auto add = [&](const IndexRegion &region) {
+      if (!(empty(region.kb) || empty(region.jb) || empty(region.ib)))
+        rim.push_back(region);
+    };
+    add({{full.kb.s, core.kb.s - 1}, full.jb, full.ib});
+    add({{core.kb.e + 1, full.kb.e}, full.jb, full.ib});
+    add({core.kb, {full.jb.s, core.jb.s - 1}, full.ib});
+    add({core.kb, {core.jb.e + 1, full.jb.e}, full.ib});
+    add({core.kb, core.jb, {full.ib.s, core.ib.s - 1}});
+    add({core.kb, core.jb, {core.ib.e + 1, full.ib.e}});
+    return rim;
+  }
+
   // Kept basic for kokkos
   KOKKOS_INLINE_FUNCTION
   int GetTotal(const IndexDomain &domain, TE el = TE::CC) const noexcept {
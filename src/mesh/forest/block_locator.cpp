@@ -0,0 +1,99 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+//! \file block_locator.cpp
+//  \brief Device-resident tree mapping positions to the leaf blocks containing them
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "mesh/forest/block_locator.hpp"
+#include "mesh/forest/forest.hpp"
+#include "utils/error_checking.hpp"
+
+namespace parthenon {
+namespace forest {
+
+BlockLocator::BlockLocator(const Forest &forest,
+                           const std::vector<LogicalLocation> &loclist,
+                           const std::vector<int> &ranklist, const RegionSize &mesh_size,
+                           const std::array<BoundaryFlag, BOUNDARY_NFACES> &mesh_bcs,
+                           const int ndim)
+    : ndim_(ndim) {
+  PARTHENON_REQUIRE_THROWS(loclist.size() == ranklist.size(),
+                           "Need the rank of every block");
+  // Work with locations in the legacy (single tree) index space, in which the root
+  // blocks are all blocks on the legacy root level or on the coarsest level of the
+  // leaves if blocks have been derefined below the root level
+  int root_level = forest.root_level + forest.forest_level.value();
+  std::vector<LogicalLocation> locs;
+  locs.reserve(loclist.size());
+  for (const auto &loc : loclist) {
+    locs.push_back(forest.GetLegacyTreeLocation(loc));
+    root_level = std::min(root_level, locs.back().level());
+  }
+  for (const auto &loc : locs) {
+    const int depth = loc.level() - root_level;
+    max_depth_ = std::max(max_depth_, depth);
+    const std::array<std::int64_t, 3> lx{loc.lx1(), loc.lx2(), loc.lx3()};
+    for (int d = 0; d < ndim_; ++d)
+      nroot_[d] = std::max<int>(nroot_[d], (lx[d] >> depth) + 1);
+  }
+  for (int d = 0; d < 3; ++d) {
+    const auto dir = static_cast<CoordinateDirection>(d + 1);
+    xmin_[d] = mesh_size.xmin(dir);
+    xmax_[d] = mesh_size.xmax(dir);
+    periodic_[d] = mesh_bcs[2 * d] == BoundaryFlag::periodic;
+  }
+
+  // Insert every leaf by walking down from its root block, splitting nodes on the way
+  const int nchildren = 1 << ndim_;
+  std::vector<int> nodes(nroot_[0] * nroot_[1] * nroot_[2], -1);
+  for (int gid = 0; gid < locs.size(); ++gid) {
+    const auto &loc = locs[gid];
+    const int depth = loc.level() - root_level;
+    const std::array<std::int64_t, 3> lx{loc.lx1(), loc.lx2(), loc.lx3()};
+    int node = ((lx[2] >> depth) * nroot_[1] + (lx[1] >> depth)) * nroot_[0] +
+               (lx[0] >> depth);
+    for (int l = depth - 1; l >= 0; --l) {
+      if (nodes[node] == -1) {
+        nodes[node] = -2 - static_cast<int>(nodes.size());
+        nodes.resize(nodes.size() + nchildren, -1);
+      }
+      PARTHENON_REQUIRE_THROWS(nodes[node] <= -2, "Leaf blocks overlap");
+      int child = 0;
+      for (int d = 0; d < ndim_; ++d)
+        child |= ((lx[d] >> l) & 1) << d;
+      node = -2 - nodes[node] + child;
+    }
+    PARTHENON_REQUIRE_THROWS(nodes[node] == -1, "Leaf blocks overlap");
+    nodes[node] = gid;
+  }
+  PARTHENON_REQUIRE_THROWS(std::count(nodes.begin(), nodes.end(), -1) == 0,
+                           "Leaf blocks do not cover the mesh");
+
+  nodes_ = ParArray1D<int>("BlockLocator::nodes", nodes.size());
+  ranks_ = ParArray1D<int>("BlockLocator::ranks", ranklist.size());
+  auto nodes_h = nodes_.GetHostMirror();
+  auto ranks_h = ranks_.GetHostMirror();
+  for (int n = 0; n < nodes.size(); ++n)
+    nodes_h(n) = nodes[n];
+  for (int gid = 0; gid < ranklist.size(); ++gid)
+    ranks_h(gid) = ranklist[gid];
+  nodes_.DeepCopy(nodes_h);
+  ranks_.DeepCopy(ranks_h);
+}
+
+} // namespace forest
+} // namespace parthenon
@@ -0,0 +1,109 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef MESH_FOREST_BLOCK_LOCATOR_HPP_
+#define MESH_FOREST_BLOCK_LOCATOR_HPP_
+//! \file block_locator.hpp
+//  \brief Device-resident tree mapping positions to the leaf blocks containing them
+
+#include <array>
+#include <vector>
+
+#include "basic_types.hpp"
+#include "defs.hpp"
+#include "kokkos_abstraction.hpp"
+#include "mesh/forest/logical_location.hpp"
+#include "parthenon_arrays.hpp"
+
+namespace parthenon {
+namespace forest {
+
+class Forest;
+
+// Compact representation of the leaf blocks of a hyper-rectangular mesh that can be
+// copied into kernels to find the gid and rank of the block containing any position in
+// O(levels), independent of how far the position is from the block doing the lookup.
+// Assumes uniformly spaced blocks, like the swarms that use it.
+//
+// The first nodes are the root blocks in x1-fastest order. Every node either holds the
+// gid of a leaf (>= 0) or refers to its 2^ndim children (<= -2), which are stored
+// consecutively with the x1 bit varying fastest.
+class BlockLocator {
+ public:
+  BlockLocator() = default;
+  // loclist and ranklist are the locations and ranks of all leaf blocks in gid order
+  BlockLocator(const Forest &forest, const std::vector<LogicalLocation> &loclist,
+               const std::vector<int> &ranklist, const RegionSize &mesh_size,
+               const std::array<BoundaryFlag, BOUNDARY_NFACES> &mesh_bcs, int ndim);
+
+  // Gid of the leaf block containing the position, or -1 if it is outside of the mesh
+  // in a direction that is not periodic
+  KOKKOS_INLINE_FUNCTION int FindGid(Real x, Real y, Real z) const {
+    const Real pos[3] = {x, y, z};
+    Real frac[3] = {0.0, 0.0, 0.0};
+    int root[3] = {0, 0, 0};
+    for (int d = 0; d < ndim_; ++d) {
+      Real t = (pos[d] - xmin_[d]) / (xmax_[d] - xmin_[d]);
+      if (periodic_[d]) {
+        t -= Kokkos::floor(t);
+      } else if (t < 0.0 || t >= 1.0) {
+        return -1;
+      }
+      t *= nroot_[d];
+      root[d] = Kokkos::min(static_cast<int>(t), nroot_[d] - 1);
+      frac[d] = t - root[d];
+    }
+    int node = nodes_((root[2] * nroot_[1] + root[1]) * nroot_[0] + root[0]);
+    while (node <= -2) {
+      int child = 0;
+      for (int d = 0; d < ndim_; ++d) {
+        frac[d] *= 2.0;
+        const int upper = frac[d] >= 1.0;
+        frac[d] -= upper;
+        child |= upper << d;
+      }
+      node = nodes_(-2 - node + child);
+    }
+    return node;
+  }
+
+  KOKKOS_INLINE_FUNCTION int GetRank(const int gid) const { return ranks_(gid); }
+
+  // Map the position into the mesh along periodic directions
+  KOKKOS_INLINE_FUNCTION void ApplyPeriodicity(Real &x, Real &y, Real &z) const {
+    Real *pos[3] = {&x, &y, &z};
+    for (int d = 0; d < ndim_; ++d) {
+      if (periodic_[d] && (*pos[d] < xmin_[d] || *pos[d] >= xmax_[d])) {
+        const Real len = xmax_[d] - xmin_[d];
+        *pos[d] -= len * Kokkos::floor((*pos[d] - xmin_[d]) / len);
+      }
+    }
+  }
+
+  // Depth of the deepest leaf below the root blocks
+  int GetMaxDepth() const { return max_depth_; }
+
+ private:
+  ParArray1D<int> nodes_;
+  ParArray1D<int> ranks_;
+  Real xmin_[3] = {0.0, 0.0, 0.0};
+  Real xmax_[3] = {1.0, 1.0, 1.0};
+  int nroot_[3] = {1, 1, 1};
+  bool periodic_[3] = {false, false, false};
+  int ndim_ = 1;
+  int max_depth_ = 0;
+};
+
+} // namespace forest
+} // namespace parthenon
+
+#endif // MESH_FOREST_BLOCK_LOCATOR_HPP_
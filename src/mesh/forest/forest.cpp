@@ -62,6 +62,66 @@ std::vector<LogicalLocation> Forest::GetMeshBlockListAndResolveGids() {
   return mb_list;
 }
 
+int Forest::AddMeshBlocks(const std::vector<LogicalLocation> &locs) {
+  gids_resolved = false;
+  int max_loc_level = 0;
+  for (const auto &loc : locs)
+    max_loc_level = std::max(max_loc_level, loc.level());
+
+  // Nodes that have to be refined, by level. Refining a node requires its parent and the
+  // nodes of the parent level next to it (see Tree::Refine) to be refined, which are one
+  // level coarser, so going once from the finest to the coarsest level finds all of them
+  std::vector<std::unordered_set<LogicalLocation>> to_refine(max_loc_level);
+  for (const auto &loc : locs) {
+    PARTHENON_REQUIRE(trees.count(loc.tree()) > 0,
+                      "Trying to add a meshblock with a location on an unknown tree.");
+    if (loc.level() > 0) to_refine[loc.level() - 1].insert(loc.GetParent());
+  }
+  for (int l = max_loc_level - 1; l > 0; --l) {
+    for (const auto &loc : to_refine[l]) {
+      to_refine[l - 1].insert(loc.GetParent());
+      for (const auto &[neighbor_tree, neigh] :
+           trees[loc.tree()]->GetProperNestingRefinements(loc))
+        to_refine[l - 1].insert(neigh);
+    }
+  }
+
+  // Refining from coarse to fine, the nodes are leaves when they are refined (or
+  // already internal, in which case nothing happens)
+  int added = 0;
+  for (int l = 0; l < max_loc_level; ++l) {
+    for (const auto &loc : to_refine[l])
+      added += trees[loc.tree()]->Refine(loc, false);
+  }
+  return added;
+}
+
+std::vector<LogicalLocation> Forest::GetForestLocationsFromLegacyTreeLocations(
+    const std::vector<LogicalLocation> &locs) const {
+  std::vector<LogicalLocation> forest_locs;
+  forest_locs.reserve(locs.size());
+  if (trees.empty()) return forest_locs;
+  int macro_level = (*trees.begin()).second->athena_forest_loc.level();
+  std::unordered_map<LogicalLocation, std::int64_t> macro_trees;
+  for (auto &[id, t] : trees)
+    macro_trees[t->athena_forest_loc] = t->GetId();
+
+  for (const auto &loc : locs) {
+    if (loc.tree() >= 0) {
+      forest_locs.push_back(loc);
+      continue;
+    }
+    const int level = loc.level() - macro_level;
+    auto forest_loc = loc.GetParent(level);
+    auto it = macro_trees.find(forest_loc);
+    PARTHENON_REQUIRE(it != macro_trees.end(), "Somehow didn't find a tree.");
+    forest_locs.emplace_back(it->second, level, loc.lx1() - (forest_loc.lx1() << level),
+                             loc.lx2() - (forest_loc.lx2() << level),
+                             loc.lx3() - (forest_loc.lx3() << level));
+  }
+  return forest_locs;
+}
+
 Forest Forest::HyperRectangular(RegionSize mesh_size, RegionSize block_size,
                                 std::array<BoundaryFlag, BOUNDARY_NFACES> mesh_bcs) {
   std::array<bool, 3> periodic{mesh_bcs[BoundaryFace::inner_x1] == BoundaryFlag::periodic,
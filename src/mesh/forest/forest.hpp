@@ -106,6 +106,10 @@ class Forest {
     gids_resolved = false;
     return trees[loc.tree()]->AddMeshBlock(loc, enforce_proper_nesting);
   }
+  // Same as calling AddMeshBlock with proper nesting for every location in locs, but
+  // the refinements that this implies are collected level by level in a single sweep
+  // from fine to coarse and then applied at once without further nesting checks
+  int AddMeshBlocks(const std::vector<LogicalLocation> &locs);
   int Refine(const LogicalLocation &loc, bool enforce_proper_nesting = true) {
     gids_resolved = false;
     return trees[loc.tree()]->Refine(loc, enforce_proper_nesting);
@@ -159,6 +163,20 @@ class Forest {
     return count;
   }
 
+  // Make the trees safe to query concurrently, see Tree::BuildLookupIndex
+  void BuildLookupIndices() const {
+    for (auto &[id, tree] : trees)
+      tree->BuildLookupIndex();
+  }
+
+  // Estimate of the host memory held by the trees, which is replicated on every rank
+  std::size_t GetMemoryUsage() const {
+    std::size_t bytes{0};
+    for (auto &[id, tree] : trees)
+      bytes += tree->GetMemoryUsage();
+    return bytes;
+  }
+
   // TODO(LFR): Probably eventually remove this. This is only meaningful for simply
   // oriented grids
   LogicalLocation GetLegacyTreeLocation(const LogicalLocation &loc) const {
@@ -191,6 +209,10 @@ class Forest {
     PARTHENON_FAIL("Somehow didn't find a tree.");
     return LogicalLocation();
   }
+  // Same for many locations, with a single lookup table from the legacy locations of the
+  // roots to the trees
+  std::vector<LogicalLocation> GetForestLocationsFromLegacyTreeLocations(
+      const std::vector<LogicalLocation> &locs) const;
 
   std::size_t CountTrees() const { return trees.size(); }
 
@@ -71,6 +71,11 @@ class LogicalLocation { // aggregate and POD type
   const auto &lx3() const { return l_[2]; }
   const auto &level() const { return level_; }
   const auto &morton() const { return morton_; }
+  // Key of the location along the Hilbert curve through its tree, computed on demand
+  HilbertNumber hilbert(int ndim) const {
+    return HilbertNumber(ndim, std::max(level_, 0), l_[0], ndim > 1 ? l_[1] : 0,
+                         ndim > 2 ? l_[2] : 0);
+  }
   const auto &tree() const { return tree_idx_; }
 
   // Check if this logical location is actually in the domain of the tree,
@@ -71,6 +71,7 @@ int Tree::AddMeshBlock(const LogicalLocation &loc, bool enforce_proper_nesting)
   PARTHENON_REQUIRE(
       loc.tree() == my_id,
       "Trying to add a meshblock to a tree with a LogicalLocation on a different tree.");
+  index_valid = false;
   if (internal_nodes.count(loc)) return -1;
   if (leaves.count(loc)) return 0;
 
@@ -95,6 +96,7 @@ int Tree::Refine(const LogicalLocation &ref_loc, bool enforce_proper_nesting) {
   PARTHENON_REQUIRE(
       ref_loc.tree() == my_id,
       "Trying to refine a tree with a LogicalLocation on a different tree.");
+  index_valid = false;
   // Check that this is a valid refinement location
   if (!leaves.count(ref_loc)) return 0; // Can't refine a block that doesn't exist
 
@@ -109,29 +111,37 @@ int Tree::Refine(const LogicalLocation &ref_loc, bool enforce_proper_nesting) {
   int nadded = daughters.size() - 1;
 
   if (enforce_proper_nesting) {
-    LogicalLocation parent = ref_loc.GetParent();
-    int ox1 = ref_loc.lx1() - (parent.lx1() << 1);
-    int ox2 = ref_loc.lx2() - (parent.lx2() << 1);
-    int ox3 = ref_loc.lx3() - (parent.lx3() << 1);
-
-    for (int k = 0; k < (ndim > 2 ? 2 : 1); ++k) {
-      for (int j = 0; j < (ndim > 1 ? 2 : 1); ++j) {
-        for (int i = 0; i < (ndim > 0 ? 2 : 1); ++i) {
-          LogicalLocation neigh = parent.GetSameLevelNeighbor(
-              i + ox1 - 1, j + ox2 - (ndim > 1), k + ox3 - (ndim > 2));
-          // Need to communicate this refinement action to possible neighboring tree(s)
-          // and trigger refinement there
-          int n_idx =
-              neigh.NeighborTreeIndex(); // Note that this can point you back to this tree
-          for (auto &[neighbor_tree, lcoord_trans] : neighbors[n_idx]) {
-            nadded += neighbor_tree->Refine(
-                lcoord_trans.Transform(neigh, neighbor_tree->GetId()));
-          }
+    for (auto &[neighbor_tree, neigh] : GetProperNestingRefinements(ref_loc))
+      nadded += neighbor_tree->Refine(neigh);
+  }
+  return nadded;
+}
+
+std::vector<std::pair<Tree *, LogicalLocation>>
+Tree::GetProperNestingRefinements(const LogicalLocation &ref_loc) const {
+  std::vector<std::pair<Tree *, LogicalLocation>> refinements;
+  LogicalLocation parent = ref_loc.GetParent();
+  int ox1 = ref_loc.lx1() - (parent.lx1() << 1);
+  int ox2 = ref_loc.lx2() - (parent.lx2() << 1);
+  int ox3 = ref_loc.lx3() - (parent.lx3() << 1);
+
+  for (int k = 0; k < (ndim > 2 ? 2 : 1); ++k) {
+    for (int j = 0; j < (ndim > 1 ? 2 : 1); ++j) {
+      for (int i = 0; i < (ndim > 0 ? 2 : 1); ++i) {
+        LogicalLocation neigh = parent.GetSameLevelNeighbor(
+            i + ox1 - 1, j + ox2 - (ndim > 1), k + ox3 - (ndim > 2));
+        // Need to communicate this refinement action to possible neighboring tree(s)
+        // and trigger refinement there
+        int n_idx =
+            neigh.NeighborTreeIndex(); // Note that this can point you back to this tree
+        for (auto &[neighbor_tree, lcoord_trans] : neighbors[n_idx]) {
+          refinements.emplace_back(neighbor_tree,
+                                   lcoord_trans.Transform(neigh, neighbor_tree->GetId()));
         }
       }
     }
   }
-  return nadded;
+  return refinements;
 }
 
 std::vector<NeighborLocation> Tree::FindNeighbors(const LogicalLocation &loc,
@@ -162,7 +172,7 @@ void Tree::FindNeighborsImpl(const LogicalLocation &loc, int ox1, int ox2, int o
   PARTHENON_REQUIRE(
       loc.tree() == my_id,
       "Trying to find neighbors in a tree with a LogicalLocation on a different tree.");
-  PARTHENON_REQUIRE((leaves.count(loc) == 1 || internal_nodes.count(loc) == 1),
+  PARTHENON_REQUIRE(Lookup(loc).type != NodeType::none,
                     "Location must be in the tree to find neighbors.");
   auto neigh = loc.GetSameLevelNeighbor(ox1, ox2, ox3);
   int n_idx = neigh.NeighborTreeIndex();
@@ -194,10 +204,11 @@ void Tree::FindNeighborsImpl(const LogicalLocation &loc, int ox1, int ox2, int o
     auto tloc = lcoord_trans.Transform(loc, neighbor_tree->GetId());
     PARTHENON_REQUIRE(lcoord_trans.InverseTransform(tloc, GetId()) == loc,
                       "Inverse transform not working.");
-    if (neighbor_tree->leaves.count(tneigh) && include_same) {
+    const auto neigh_type = neighbor_tree->Lookup(tneigh).type;
+    if (neigh_type == NodeType::leaf && include_same) {
       neighbor_locs->push_back(NeighborLocation(
           tneigh, lcoord_trans.InverseTransform(tneigh, GetId()), lcoord_trans));
-    } else if (neighbor_tree->internal_nodes.count(tneigh)) {
+    } else if (neigh_type == NodeType::internal) {
       if (include_fine) {
         auto daughters = tneigh.GetDaughters(neighbor_tree->ndim);
         for (auto &n : daughters) {
@@ -209,7 +220,8 @@ void Tree::FindNeighborsImpl(const LogicalLocation &loc, int ox1, int ox2, int o
         neighbor_locs->push_back(NeighborLocation(
             tneigh, lcoord_trans.InverseTransform(tneigh, GetId()), lcoord_trans));
       }
-    } else if (neighbor_tree->leaves.count(tneigh.GetParent()) && include_coarse) {
+    } else if (include_coarse &&
+               neighbor_tree->Lookup(tneigh.GetParent()).type == NodeType::leaf) {
       auto neighp = lcoord_trans.InverseTransform(tneigh.GetParent(), GetId());
       // Since coarser neighbors can cover multiple elements of the origin block and
       // because our communication algorithm packs this extra data by hand, we do not wish
@@ -227,6 +239,7 @@ int Tree::Derefine(const LogicalLocation &ref_loc, bool enforce_proper_nesting)
   PARTHENON_REQUIRE(
       ref_loc.tree() == my_id,
       "Trying to derefine a tree with a LogicalLocation on a different tree.");
+  index_valid = false;
 
   // ref_loc is the block to be added and its daughters are the blocks to be removed
   std::vector<LogicalLocation> daughters = ref_loc.GetDaughters(ndim);
@@ -262,7 +275,7 @@ int Tree::Derefine(const LogicalLocation &ref_loc, bool enforce_proper_nesting)
   }
 
   // Derefinement is ok
-  std::int64_t dgid = std::numeric_limits<std::int64_t>::max();
+  int dgid = std::numeric_limits<int>::max();
   for (auto &d : daughters) {
     auto node = leaves.extract(d);
     dgid = std::min(dgid, node.mapped().first);
@@ -343,44 +356,90 @@ void Tree::AddNeighborTree(CellCentOffsets offset, std::shared_ptr<Tree> neighbo
 }
 
 void Tree::InsertGid(const LogicalLocation &loc, std::int64_t gid) {
-  if (leaves.count(loc)) {
-    leaves[loc].second = leaves[loc].first;
-    leaves[loc].first = gid;
-  } else if (internal_nodes.count(loc)) {
-    internal_nodes[loc].second = internal_nodes[loc].first;
-    internal_nodes[loc].first = gid;
-  } else {
-    PARTHENON_FAIL("Tried to assign gid to non-existent block.");
+  auto it = leaves.find(loc);
+  if (it == leaves.end()) {
+    it = internal_nodes.find(loc);
+    PARTHENON_REQUIRE(it != internal_nodes.end(),
+                      "Tried to assign gid to non-existent block.");
   }
-}
-
-std::int64_t Tree::GetGid(const LogicalLocation &loc) const {
-  if (leaves.count(loc)) {
-    return leaves.at(loc).first;
-  } else if (internal_nodes.count(loc)) {
-    return internal_nodes.at(loc).first;
+  it->second.second = it->second.first;
+  it->second.first = static_cast<int>(gid);
+  // Assigning gids does not change the structure of the tree, update the index in place
+  if (index_valid) {
+    auto &node = index_nodes[FindInIndex(loc)];
+    node.gid_old = node.gid;
+    node.gid = static_cast<int>(gid);
   }
-  return -1;
 }
 
+std::int64_t Tree::GetGid(const LogicalLocation &loc) const { return Lookup(loc).gid; }
+
 // Get the gid of the leaf block with the same Morton number
 // as loc
 std::int64_t Tree::GetLeafGid(const LogicalLocation &loc) const {
-  if (leaves.count(loc)) {
-    return leaves.at(loc).first;
-  } else if (internal_nodes.count(loc)) {
-    return GetLeafGid(loc.GetDaughter(0, 0, 0));
-  }
-  return -1;
+  const auto node = Lookup(loc);
+  if (node.type == NodeType::internal) return GetLeafGid(loc.GetDaughter(0, 0, 0));
+  return node.gid;
 }
 
 std::int64_t Tree::GetOldGid(const LogicalLocation &loc) const {
-  if (leaves.count(loc)) {
-    return leaves.at(loc).second;
-  } else if (internal_nodes.count(loc)) {
-    return internal_nodes.at(loc).second;
+  return Lookup(loc).gid_old;
+}
+
+namespace {
+bool IndexKeyLess(const MortonNumber &lm, int ll, const MortonNumber &rm, int rl) {
+  if (lm != rm) return lm < rm;
+  return ll < rl;
+}
+} // namespace
+
+void Tree::BuildIndex() const {
+  index_keys.clear();
+  index_nodes.clear();
+  index_keys.reserve(leaves.size() + internal_nodes.size());
+  index_nodes.reserve(leaves.size() + internal_nodes.size());
+  std::vector<std::pair<LogicalLocation, NodeInfo>> nodes;
+  nodes.reserve(leaves.size() + internal_nodes.size());
+  for (const auto &[loc, gids] : leaves)
+    nodes.emplace_back(loc, NodeInfo{NodeType::leaf, gids.first, gids.second});
+  for (const auto &[loc, gids] : internal_nodes)
+    nodes.emplace_back(loc, NodeInfo{NodeType::internal, gids.first, gids.second});
+  std::sort(nodes.begin(), nodes.end(),
+            [](const auto &a, const auto &b) { return a.first < b.first; });
+  for (const auto &[loc, info] : nodes) {
+    index_keys.push_back(IndexKey{loc.morton(), loc.level()});
+    index_nodes.push_back(info);
   }
-  return -1;
+  index_valid = true;
+}
+
+int Tree::FindInIndex(const LogicalLocation &loc) const {
+  // Locations outside of the tree would alias with Morton numbers of nodes inside it
+  if (loc.tree() != my_id || !loc.IsInTree()) return -1;
+  auto it = std::lower_bound(index_keys.begin(), index_keys.end(), loc,
+                             [](const IndexKey &key, const LogicalLocation &l) {
+                               return IndexKeyLess(key.morton, key.level, l.morton(),
+                                                   l.level());
+                             });
+  if (it == index_keys.end() || it->morton != loc.morton() || it->level != loc.level())
+    return -1;
+  return it - index_keys.begin();
+}
+
+Tree::NodeInfo Tree::Lookup(const LogicalLocation &loc) const {
+  if (!index_valid) BuildIndex();
+  const int idx = FindInIndex(loc);
+  return idx < 0 ? NodeInfo() : index_nodes[idx];
+}
+
+std::size_t Tree::GetMemoryUsage() const {
+  // Every entry is a separately allocated node holding the value, the pointer to the
+  // next node and the cached hash, in addition to the bucket array and the flat index
+  constexpr std::size_t entry = sizeof(LocMap_t::value_type) + 2 * sizeof(void *);
+  return (leaves.size() + internal_nodes.size()) * entry +
+         (leaves.bucket_count() + internal_nodes.bucket_count()) * sizeof(void *) +
+         index_keys.capacity() * sizeof(IndexKey) +
+         index_nodes.capacity() * sizeof(NodeInfo);
 }
 
 void Tree::EnrollBndryFncts(
@@ -418,6 +477,7 @@ void Tree::EnrollBndryFncts(
     case BoundaryFlag::user:
       if (app_in->boundary_conditions[f] != nullptr) {
         MeshBndryFnctn[f] = app_in->boundary_conditions[f];
+        MeshBndryFnctnMD[f] = app_in->boundary_conditions_md[f];
       } else {
         std::stringstream msg;
         msg << "A user boundary condition for face " << f
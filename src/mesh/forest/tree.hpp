@@ -14,6 +14,7 @@
 #define MESH_FOREST_TREE_HPP_
 
 #include <array>
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <set>
@@ -82,9 +83,15 @@ class Tree : public std::enable_shared_from_this<Tree> {
   int AddMeshBlock(const LogicalLocation &loc, bool enforce_proper_nesting = true);
   int Refine(const LogicalLocation &ref_loc, bool enforce_proper_nesting = true);
   int Derefine(const LogicalLocation &ref_loc, bool enforce_proper_nesting = true);
+  // Locations one level coarser than ref_loc, possibly on neighboring trees, that have
+  // to be refined as well to keep the forest properly nested when ref_loc is refined
+  std::vector<std::pair<Tree *, LogicalLocation>>
+  GetProperNestingRefinements(const LogicalLocation &ref_loc) const;
 
   // Methods for getting block properties
-  int count(const LogicalLocation &loc) const { return leaves.count(loc); }
+  int count(const LogicalLocation &loc) const {
+    return Lookup(loc).type == NodeType::leaf;
+  }
   std::vector<LogicalLocation> GetSortedMeshBlockList() const;
   std::vector<LogicalLocation> GetSortedInternalNodeList() const;
   RegionSize GetBlockDomain(const LogicalLocation &loc) const;
@@ -95,6 +102,13 @@ class Tree : public std::enable_shared_from_this<Tree> {
   std::vector<NeighborLocation> FindNeighbors(const LogicalLocation &loc, int ox1,
                                               int ox2, int ox3) const;
   std::size_t CountMeshBlock() const { return leaves.size(); }
+  // Build the lookup index now if the tree was modified, which is needed before the
+  // tree is queried from several threads
+  void BuildLookupIndex() const {
+    if (!index_valid) BuildIndex();
+  }
+  // Estimate of the host memory held by the maps of leaves and internal nodes
+  std::size_t GetMemoryUsage() const;
 
   // Gid related methods
   void InsertGid(const LogicalLocation &loc, std::int64_t gid);
@@ -122,21 +136,36 @@ class Tree : public std::enable_shared_from_this<Tree> {
       std::array<std::vector<BValFunc>, BOUNDARY_NFACES> UserBoundaryFunctions_in,
       std::array<std::vector<SBValFunc>, BOUNDARY_NFACES> UserSwarmBoundaryFunctions_in);
   BValFunc MeshBndryFnctn[BOUNDARY_NFACES];
+  // Fused version of MeshBndryFnctn for whole MeshData, if the user condition has one
+  MDBValFunc MeshBndryFnctnMD[BOUNDARY_NFACES];
   SBValFunc SwarmBndryFnctn[BOUNDARY_NFACES];
   std::array<std::vector<BValFunc>, BOUNDARY_NFACES> UserBoundaryFunctions;
   std::array<std::vector<SBValFunc>, BOUNDARY_NFACES> UserSwarmBoundaryFunctions;
 
  private:
+  enum class NodeType : std::int8_t { none, internal, leaf };
+  struct NodeInfo {
+    NodeType type = NodeType::none;
+    int gid = -1;
+    int gid_old = -1;
+  };
+  // Find loc in the sorted flat index, which is (re)built first if the tree was modified
+  NodeInfo Lookup(const LogicalLocation &loc) const;
+  // Position of loc in the (valid) index or -1
+  int FindInIndex(const LogicalLocation &loc) const;
+  void BuildIndex() const;
+
   void FindNeighborsImpl(const LogicalLocation &loc, int ox1, int ox2, int ox3,
                          std::vector<NeighborLocation> *neighbor_locs,
                          GridIdentifier grid_type) const;
 
   int ndim;
   const std::uint64_t my_id;
-  // Structure mapping location of block in this tree to current gid and previous gid
-  using LocMap_t =
-      std::unordered_map<LogicalLocation, std::pair<std::int64_t, std::int64_t>>;
-  static std::pair<LogicalLocation, std::pair<std::int64_t, std::int64_t>>
+  // Structure mapping location of block in this tree to current gid and previous gid.
+  // Every rank holds the full tree, so the gids are stored as int (which the total
+  // number of blocks is limited to anyway) to keep the entries small.
+  using LocMap_t = std::unordered_map<LogicalLocation, std::pair<int, int>>;
+  static std::pair<LogicalLocation, std::pair<int, int>>
   LocMapEntry(const LogicalLocation &loc, const int gid, const int gid_old) {
     return std::make_pair(loc, std::make_pair(gid, gid_old));
   }
@@ -144,6 +173,18 @@ class Tree : public std::enable_shared_from_this<Tree> {
   LocMap_t leaves;
   LocMap_t internal_nodes;
 
+  // Sorted flat copy of leaves and internal_nodes keyed by Morton number and level, so
+  // that the many lookups done while building the neighbor lists of all blocks are
+  // binary searches over contiguous keys instead of hash map probes. It is rebuilt on
+  // the first lookup after the tree was refined or derefined.
+  struct IndexKey {
+    MortonNumber morton;
+    int level;
+  };
+  mutable std::vector<IndexKey> index_keys;
+  mutable std::vector<NodeInfo> index_nodes;
+  mutable bool index_valid = false;
+
   // This contains all of the neighbor information for this tree, for each of the
   // 3^3 possible neighbor connections. Since an edge or node connection can have
   // multiple neighbors generally, we keep a map at each neighbor location from
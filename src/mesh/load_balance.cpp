@@ -0,0 +1,310 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+//! \file load_balance.cpp
+//  \brief Implementation of the block to rank partitioners
+
+#include <algorithm>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "mesh/load_balance.hpp"
+#include "utils/error_checking.hpp"
+
+namespace parthenon {
+namespace loadbalance {
+
+Partitioner GetPartitioner(const std::string &name) {
+  if (name == "greedy") return Partitioner::greedy;
+  if (name == "optimal") return Partitioner::optimal;
+  if (name == "incremental") return Partitioner::incremental;
+  if (name == "user") return Partitioner::user;
+  PARTHENON_FAIL("Unknown load balancing partitioner " + name);
+  return Partitioner::greedy;
+}
+
+void AssignBlocksGreedy(std::vector<double> const &costlist, int nranks,
+                        std::vector<int> &ranklist) {
+  AssignBlocksGreedy(costlist, std::vector<double>(nranks, 1.0), ranklist);
+}
+
+void AssignBlocksGreedy(std::vector<double> const &costlist,
+                        std::vector<double> const &weights, std::vector<int> &ranklist) {
+  ranklist.resize(costlist.size());
+  const int nranks = weights.size();
+
+  double const total_cost = std::accumulate(costlist.begin(), costlist.end(), 0.0);
+  double remaining_weight = std::accumulate(weights.begin(), weights.end(), 0.0);
+
+  int rank = nranks - 1;
+  double target_cost = total_cost * weights[rank] / remaining_weight;
+  double my_cost = 0.0;
+  double remaining_cost = total_cost;
+  // create rank list from the end: the master MPI rank should have less load
+  for (int block_id = costlist.size() - 1; block_id >= 0; block_id--) {
+    if (target_cost == 0.0) {
+      std::stringstream msg;
+      msg << "### FATAL ERROR in CalculateLoadBalance" << std::endl
+          << "There is at least one process which has no MeshBlock" << std::endl
+          << "Decrease the number of processes or use smaller MeshBlocks." << std::endl;
+      PARTHENON_FAIL(msg);
+    }
+    my_cost += costlist[block_id];
+    ranklist[block_id] = rank;
+    if (my_cost >= target_cost && rank > 0) {
+      remaining_cost -= my_cost;
+      remaining_weight -= weights[rank];
+      rank--;
+      my_cost = 0.0;
+      target_cost = remaining_cost * weights[rank] / remaining_weight;
+    }
+  }
+}
+
+namespace {
+// Try to partition the blocks s.t. no rank has a cost larger than max_cost times its
+// weight. Each rank takes as many blocks as possible from the front of the list while
+// leaving at least one block for each of the remaining ranks. If ranklist is not null,
+// the assignment is written to it. Returns true if the partition satisfies the bound.
+bool Probe(std::vector<double> const &prefix, std::vector<double> const &weights,
+           double max_cost, std::vector<int> *ranklist) {
+  const int nblocks = prefix.size() - 1;
+  const int nranks = weights.size();
+  int start = 0;
+  for (int rank = 0; rank < nranks; ++rank) {
+    const int remaining_ranks = nranks - rank - 1;
+    const double rank_max_cost = max_cost * weights[rank];
+    int end;
+    if (remaining_ranks == 0) {
+      end = nblocks;
+      if (prefix[end] - prefix[start] > rank_max_cost) return false;
+    } else if (nblocks - start <= remaining_ranks) {
+      // Fewer blocks than ranks, give out single blocks until they run out
+      end = std::min(start + 1, nblocks);
+    } else {
+      if (prefix[start + 1] - prefix[start] > rank_max_cost) return false;
+      end = std::upper_bound(prefix.begin() + start + 1, prefix.end(),
+                             prefix[start] + rank_max_cost) -
+            prefix.begin() - 1;
+      end = std::min(std::max(end, start + 1), nblocks - remaining_ranks);
+    }
+    if (ranklist != nullptr) {
+      for (int b = start; b < end; ++b)
+        (*ranklist)[b] = rank;
+    }
+    start = end;
+  }
+  return true;
+}
+} // namespace
+
+void AssignBlocksOptimal(std::vector<double> const &costlist, int nranks,
+                         std::vector<int> &ranklist) {
+  AssignBlocksOptimal(costlist, std::vector<double>(nranks, 1.0), ranklist);
+}
+
+void AssignBlocksOptimal(std::vector<double> const &costlist,
+                         std::vector<double> const &weights, std::vector<int> &ranklist) {
+  ranklist.resize(costlist.size());
+  if (costlist.size() == 0) return;
+
+  std::vector<double> prefix(costlist.size() + 1, 0.0);
+  std::partial_sum(costlist.begin(), costlist.end(), prefix.begin() + 1);
+  const double total_cost = prefix.back();
+  const double max_block = *std::max_element(costlist.begin(), costlist.end());
+  const double total_weight = std::accumulate(weights.begin(), weights.end(), 0.0);
+  const auto [min_weight, max_weight] =
+      std::minmax_element(weights.begin(), weights.end());
+
+  // The optimal bottleneck (per unit weight) is bounded from below by the average cost
+  // per unit weight and the most expensive single block on the fastest rank. The
+  // front-greedy probe always succeeds for the sum of the average and the most
+  // expensive block on the slowest rank, so the bisection interval can be kept tight.
+  double lo = std::max(total_cost / total_weight, max_block / *max_weight);
+  double hi = total_cost / total_weight + max_block / *min_weight;
+  if (!Probe(prefix, weights, hi, nullptr)) hi = (total_cost + max_block) / *min_weight;
+  if (Probe(prefix, weights, lo, nullptr)) hi = lo;
+
+  constexpr int max_iters = 100;
+  constexpr double rel_tol = 1.e-12;
+  for (int it = 0; it < max_iters && (hi - lo) > rel_tol * hi; ++it) {
+    const double mid = 0.5 * (lo + hi);
+    if (Probe(prefix, weights, mid, nullptr)) {
+      hi = mid;
+    } else {
+      lo = mid;
+    }
+  }
+  const bool success = Probe(prefix, weights, hi, &ranklist);
+  PARTHENON_REQUIRE_THROWS(success, "Optimal partitioner failed to find a partition.");
+}
+
+void AssignBlocksIncremental(std::vector<double> const &costlist,
+                             std::vector<int> const &prev_ranklist, int nranks,
+                             double tolerance, std::vector<int> &ranklist) {
+  const int nblocks = costlist.size();
+  if (nblocks < nranks || prev_ranklist.size() != nblocks ||
+      !IsContiguous(prev_ranklist, nranks)) {
+    AssignBlocksOptimal(costlist, nranks, ranklist);
+    return;
+  }
+
+  // The bound can never be better than what the optimal partitioner achieves
+  std::vector<int> optimal;
+  AssignBlocksOptimal(costlist, nranks, optimal);
+  std::vector<double> prefix(nblocks + 1, 0.0);
+  std::partial_sum(costlist.begin(), costlist.end(), prefix.begin() + 1);
+  const double max_cost = std::max((1.0 + tolerance) * prefix.back() / nranks,
+                                   MaxRankCost(costlist, optimal, nranks));
+
+  // Nothing to do if every rank of the old assignment is within the bound and non-empty
+  std::vector<int> nslist, nblist;
+  UpdateBlockList(prev_ranklist, nranks, nslist, nblist);
+  if (MaxRankCost(costlist, prev_ranklist, nranks) <= max_cost &&
+      std::all_of(nblist.begin(), nblist.end(), [](int nb) { return nb > 0; })) {
+    ranklist = prev_ranklist;
+    return;
+  }
+
+  // earliest[r] is the smallest starting block of rank r s.t. ranks r, ..., nranks - 1
+  // can hold the remaining blocks without exceeding the bound
+  std::vector<int> earliest(nranks + 1);
+  earliest[nranks] = nblocks;
+  for (int rank = nranks - 1; rank >= 0; --rank) {
+    const int end = earliest[rank + 1];
+    int start = std::lower_bound(prefix.begin(), prefix.begin() + end + 1,
+                                 prefix[end] - max_cost) -
+                prefix.begin();
+    earliest[rank] = std::max(std::min(start, end - 1), rank);
+  }
+
+  // Sweep through the boundaries and move each one as little as possible from its old
+  // position s.t. the previous rank stays within the bound and the remaining ranks can
+  // still be assigned
+  ranklist.resize(nblocks);
+  int start = 0;
+  for (int rank = 0; rank < nranks; ++rank) {
+    int end = nblocks;
+    if (rank < nranks - 1) {
+      const int latest = std::min(
+          static_cast<int>(std::upper_bound(prefix.begin() + start + 1, prefix.end(),
+                                            prefix[start] + max_cost) -
+                           prefix.begin() - 1),
+          nblocks - (nranks - rank - 1));
+      const int hi = std::max(latest, start + 1);
+      const int lo = std::min(std::max(earliest[rank + 1], start + 1), hi);
+      end = std::clamp(nslist[rank + 1], lo, hi);
+    }
+    for (int b = start; b < end; ++b)
+      ranklist[b] = rank;
+    start = end;
+  }
+}
+
+void AssignBlocksHierarchical(std::vector<double> const &costlist,
+                              std::vector<int> const &node_sizes,
+                              std::vector<double> const &weights, const Partitioner inner,
+                              std::vector<int> &ranklist) {
+  PARTHENON_REQUIRE_THROWS(inner == Partitioner::greedy || inner == Partitioner::optimal,
+                           "Hierarchical partitioning requires the greedy or optimal "
+                           "partitioner within nodes.");
+  auto assign = [inner](std::vector<double> const &costs,
+                        std::vector<double> const &rank_weights,
+                        std::vector<int> &ranks) {
+    if (inner == Partitioner::greedy) {
+      AssignBlocksGreedy(costs, rank_weights, ranks);
+    } else {
+      AssignBlocksOptimal(costs, rank_weights, ranks);
+    }
+  };
+  const int nblocks = costlist.size();
+  const int nranks = weights.size();
+  PARTHENON_REQUIRE_THROWS(
+      std::accumulate(node_sizes.begin(), node_sizes.end(), 0) == nranks,
+      "The nodes of the hierarchical partitioner must hold all ranks.");
+  // Without at least one block per rank there is nothing to gain
+  if (node_sizes.size() <= 1 || nblocks < nranks) {
+    assign(costlist, weights, ranklist);
+    return;
+  }
+  std::vector<double> prefix_weight(nranks + 1, 0.0);
+  std::partial_sum(weights.begin(), weights.end(), prefix_weight.begin() + 1);
+  ranklist.resize(nblocks);
+
+  std::vector<double> prefix(nblocks + 1, 0.0);
+  std::partial_sum(costlist.begin(), costlist.end(), prefix.begin() + 1);
+  int start = 0;
+  int first_rank = 0;
+  std::vector<double> node_costs, node_weights;
+  std::vector<int> node_ranklist;
+  for (int n = 0; n < node_sizes.size(); ++n) {
+    const int remaining_ranks = nranks - first_rank - node_sizes[n];
+    int end = nblocks;
+    if (remaining_ranks > 0) {
+      // Place the node boundary on the block boundary closest to the target cost, while
+      // leaving at least one block for every rank
+      const double target = prefix.back() * prefix_weight[first_rank + node_sizes[n]] /
+                            prefix_weight.back();
+      end = std::lower_bound(prefix.begin() + start, prefix.end(), target) -
+            prefix.begin();
+      if (end > start && target - prefix[end - 1] < prefix[end] - target) end--;
+      end = std::min(std::max(end, start + node_sizes[n]), nblocks - remaining_ranks);
+    }
+    node_costs.assign(costlist.begin() + start, costlist.begin() + end);
+    node_weights.assign(weights.begin() + first_rank,
+                        weights.begin() + first_rank + node_sizes[n]);
+    assign(node_costs, node_weights, node_ranklist);
+    for (int b = start; b < end; ++b)
+      ranklist[b] = first_rank + node_ranklist[b - start];
+    start = end;
+    first_rank += node_sizes[n];
+  }
+}
+
+int CountMigratedBlocks(std::vector<int> const &prev_ranklist,
+                        std::vector<int> const &ranklist) {
+  int nmigrated = 0;
+  for (int b = 0; b < std::min(prev_ranklist.size(), ranklist.size()); ++b)
+    nmigrated += (prev_ranklist[b] != ranklist[b]);
+  return nmigrated;
+}
+
+double MaxRankCost(std::vector<double> const &costlist, std::vector<int> const &ranklist,
+                   int nranks) {
+  std::vector<double> rank_cost(nranks, 0.0);
+  for (int b = 0; b < costlist.size(); ++b)
+    rank_cost[ranklist[b]] += costlist[b];
+  return nranks > 0 ? *std::max_element(rank_cost.begin(), rank_cost.end()) : 0.0;
+}
+
+bool IsContiguous(std::vector<int> const &ranklist, int nranks) {
+  for (int b = 0; b < ranklist.size(); ++b) {
+    if (ranklist[b] < 0 || ranklist[b] >= nranks) return false;
+    if (b > 0 && ranklist[b] < ranklist[b - 1]) return false;
+  }
+  return true;
+}
+
+void UpdateBlockList(std::vector<int> const &ranklist, int nranks,
+                     std::vector<int> &nslist, std::vector<int> &nblist) {
+  nslist.assign(nranks, 0);
+  nblist.assign(nranks, 0);
+  for (const int rank : ranklist)
+    nblist[rank]++;
+  for (int rank = 1; rank < nranks; ++rank)
+    nslist[rank] = nslist[rank - 1] + nblist[rank - 1];
+}
+
+} // namespace loadbalance
+} // namespace parthenon
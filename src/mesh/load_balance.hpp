@@ -0,0 +1,100 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef MESH_LOAD_BALANCE_HPP_
+#define MESH_LOAD_BALANCE_HPP_
+//! \file load_balance.hpp
+//  \brief Partitioners used to assign MeshBlocks to ranks.
+//
+//  All partitioners operate on the global list of block costs in gid order (i.e. along
+//  the space filling curve used by the forest) and assign contiguous ranges of gids to
+//  ranks in increasing rank order. This contiguity is assumed everywhere ranges of
+//  blocks are described by (nslist, nblist) pairs.
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "mesh/forest/logical_location.hpp"
+
+namespace parthenon {
+namespace loadbalance {
+
+enum class Partitioner { greedy, optimal, incremental, user };
+
+// Signature of a user supplied partitioner. Given the cost and location of every block
+// in gid order and the number of ranks, fill ranklist with the rank of every block.
+// The resulting ranklist must be non-decreasing.
+using PartitionerFunc_t =
+    std::function<void(std::vector<double> const &costlist,
+                       std::vector<LogicalLocation> const &loclist, int nranks,
+                       std::vector<int> &ranklist)>;
+
+Partitioner GetPartitioner(const std::string &name);
+
+// Legacy partitioner, sweeps from the back of the list and greedily fills each rank
+// up to the average remaining cost.
+void AssignBlocksGreedy(std::vector<double> const &costlist, int nranks,
+                        std::vector<int> &ranklist);
+
+// Versions of the partitioners for ranks of different throughput, every rank receives a
+// cost proportional to its (positive) weight. The number of ranks is the size of
+// weights, and uniform weights give the same result as the versions above.
+void AssignBlocksGreedy(std::vector<double> const &costlist,
+                        std::vector<double> const &weights, std::vector<int> &ranklist);
+void AssignBlocksOptimal(std::vector<double> const &costlist,
+                         std::vector<double> const &weights, std::vector<int> &ranklist);
+
+// Optimal one-dimensional (chains-on-chains) partitioner, minimizes the maximum cost
+// on any rank subject to each rank owning a contiguous range of blocks.
+void AssignBlocksOptimal(std::vector<double> const &costlist, int nranks,
+                         std::vector<int> &ranklist);
+
+// Incremental partitioner, starts from a previous assignment of the same blocks and
+// only moves the rank boundaries as far as needed to bring the maximum cost on any rank
+// within (1 + tolerance) of the average (or of the optimal bottleneck if that is
+// larger). If the previous assignment already satisfies the bound it is kept as is.
+void AssignBlocksIncremental(std::vector<double> const &costlist,
+                             std::vector<int> const &prev_ranklist, int nranks,
+                             double tolerance, std::vector<int> &ranklist);
+
+// Hierarchical partitioner for ranks that are grouped into nodes of consecutive ranks,
+// node_sizes holds the number of ranks of every node. The blocks are first split into
+// one contiguous range per node, with a cost proportional to the number of ranks of the
+// node, and every range is then split among the ranks of its node by the greedy or
+// optimal partitioner. This keeps the node boundaries from being shifted by the
+// imbalance of individual ranks. The ranks are weighted as above, so the cost of a node
+// is proportional to the sum of the weights of its ranks.
+void AssignBlocksHierarchical(std::vector<double> const &costlist,
+                              std::vector<int> const &node_sizes,
+                              std::vector<double> const &weights, Partitioner inner,
+                              std::vector<int> &ranklist);
+
+// Number of blocks that are assigned to a different rank in the two lists
+int CountMigratedBlocks(std::vector<int> const &prev_ranklist,
+                        std::vector<int> const &ranklist);
+
+// Returns the maximum cost on any rank for a given assignment
+double MaxRankCost(std::vector<double> const &costlist, std::vector<int> const &ranklist,
+                   int nranks);
+
+// Check that every rank owns a contiguous range of gids in increasing rank order
+bool IsContiguous(std::vector<int> const &ranklist, int nranks);
+
+// Fill the starting gid and number of blocks of every rank from a (contiguous) ranklist
+void UpdateBlockList(std::vector<int> const &ranklist, int nranks,
+                     std::vector<int> &nslist, std::vector<int> &nblist);
+
+} // namespace loadbalance
+} // namespace parthenon
+
+#endif // MESH_LOAD_BALANCE_HPP_
@@ -0,0 +1,140 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <cstdint>
+#include <iomanip>
+#include <map>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "parthenon_mpi.hpp"
+
+#include "interface/meshblock_data.hpp"
+#include "interface/state_descriptor.hpp"
+#include "interface/swarm_container.hpp"
+#include "interface/variable.hpp"
+#include "mesh/memory_usage.hpp"
+#include "mesh/mesh.hpp"
+#include "mesh/meshblock.hpp"
+#include "utils/error_checking.hpp"
+
+namespace parthenon {
+
+MemoryUsage Mesh::GetMemoryUsage() const {
+  MemoryUsage usage;
+
+  // Find the package of every field. Fluxes don't carry the metadata flag of their
+  // package, so they are attributed to the package of the field they belong to.
+  std::unordered_map<std::string, std::string> package_of;
+  for (const auto &[pkg_name, pkg] : packages.AllPackages()) {
+    usage.packages[pkg_name] = 0;
+    const auto flag = pkg->GetMetadataFlag();
+    for (const auto &[vid, m] : resolved_packages->AllFields()) {
+      if (!m.IsSet(flag)) continue;
+      package_of[vid.label()] = pkg_name;
+      if (m.GetFluxName() != "") package_of[m.GetFluxName()] = pkg_name;
+    }
+  }
+  for (const auto &[vid, m] : resolved_packages->AllFields())
+    usage.fields[vid.label()] = 0;
+
+  // Stages other than "base" usually share (some of) their variables with it, so only
+  // count every allocation once
+  std::unordered_set<const void *> counted;
+  for (const auto &pmb : block_list) {
+    for (const auto &[stage, pmbd] : pmb->meshblock_data.Stages()) {
+      for (const auto &v : pmbd->GetVariableVector()) {
+        std::uint64_t bytes = 0;
+        if (v->data.size() > 0 && counted.insert(v->data.data()).second) {
+          const std::uint64_t data_bytes = v->data.size() * sizeof(Real);
+          (v->IsSet(Metadata::Flux) ? usage.fluxes : usage.variables) += data_bytes;
+          bytes += data_bytes;
+        }
+        if (v->coarse_s.size() > 0 && counted.insert(v->coarse_s.data()).second) {
+          const std::uint64_t coarse_bytes = v->coarse_s.size() * sizeof(Real);
+          usage.coarse_buffers += coarse_bytes;
+          bytes += coarse_bytes;
+        }
+        if (bytes == 0) continue;
+        usage.fields[v->label()] += bytes;
+        auto it = package_of.find(v->label());
+        if (it != package_of.end()) usage.packages[it->second] += bytes;
+      }
+      auto swarms = pmbd->GetSwarmData();
+      if (swarms != nullptr && counted.insert(swarms.get()).second) {
+        for (const auto &swarm : swarms->GetSwarmVector())
+          usage.swarms += swarm->GetMemoryUsage();
+      }
+    }
+  }
+
+  usage.boundary_buffers = GetBufferPoolSizeInBytes();
+  usage.variable_pool = Variable<Real>::GetDataPool().GetStatistics().cached_bytes;
+  usage.forest = forest.GetMemoryUsage() + loclist.capacity() * sizeof(LogicalLocation) +
+                 costlist.capacity() * sizeof(double) +
+                 (ranklist.capacity() + nslist.capacity() + nblist.capacity()) *
+                     sizeof(int);
+  return usage;
+}
+
+MemoryUsage MemoryUsage::Sum() const { return Reduce(false); }
+MemoryUsage MemoryUsage::Max() const { return Reduce(true); }
+
+MemoryUsage MemoryUsage::Reduce(const bool max) const {
+  MemoryUsage out = *this;
+#ifdef MPI_PARALLEL
+  std::vector<std::uint64_t> vals{variables,     fluxes, coarse_buffers, boundary_buffers,
+                                  variable_pool, swarms, forest};
+  for (const auto &[name, bytes] : packages)
+    vals.push_back(bytes);
+  for (const auto &[name, bytes] : fields)
+    vals.push_back(bytes);
+  PARTHENON_MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, vals.data(), vals.size(),
+                                    MPI_UINT64_T, max ? MPI_MAX : MPI_SUM,
+                                    MPI_COMM_WORLD));
+  int n = 0;
+  for (auto *v : {&out.variables, &out.fluxes, &out.coarse_buffers,
+                  &out.boundary_buffers, &out.variable_pool, &out.swarms, &out.forest})
+    *v = vals[n++];
+  for (auto &[name, bytes] : out.packages)
+    bytes = vals[n++];
+  for (auto &[name, bytes] : out.fields)
+    bytes = vals[n++];
+#endif
+  return out;
+}
+
+void MemoryUsage::Print(std::ostream &os, const double min_field_fraction) const {
+  constexpr double MB = 1024. * 1024.;
+  const auto flags = os.flags();
+  const auto precision = os.precision();
+  os << std::fixed << std::setprecision(2);
+  os << "Memory usage [MB]: total=" << Total() / MB << " variables=" << variables / MB
+     << " fluxes=" << fluxes / MB << " coarse_buffers=" << coarse_buffers / MB
+     << " boundary_buffers=" << boundary_buffers / MB
+     << " variable_pool=" << variable_pool / MB << " swarms=" << swarms / MB
+     << " forest=" << forest / MB << std::endl;
+  for (const auto &[name, bytes] : packages)
+    os << "  package " << name << ": " << bytes / MB << std::endl;
+  for (const auto &[name, bytes] : fields) {
+    if (bytes > 0 && bytes >= min_field_fraction * Total())
+      os << "  field " << name << ": " << bytes / MB << std::endl;
+  }
+  os.flags(flags);
+  os.precision(precision);
+}
+
+} // namespace parthenon
@@ -0,0 +1,61 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef MESH_MEMORY_USAGE_HPP_
+#define MESH_MEMORY_USAGE_HPP_
+//! \file memory_usage.hpp
+//  \brief Accounting of the memory held by the different parts of a Mesh
+
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+
+namespace parthenon {
+
+// Bytes held on a rank (or, after a reduction, summed or maximized over all ranks) by
+// the variables, buffers, and swarms of a Mesh, see Mesh::GetMemoryUsage
+struct MemoryUsage {
+  std::uint64_t variables = 0;        // data of variables other than fluxes
+  std::uint64_t fluxes = 0;           // data of flux variables
+  std::uint64_t coarse_buffers = 0;   // coarse buffers of all variables
+  std::uint64_t boundary_buffers = 0; // boundary communication buffer pools
+  std::uint64_t variable_pool = 0;    // storage kept for reuse by new variables
+  std::uint64_t swarms = 0;           // particle variables and swarm bookkeeping
+  std::uint64_t forest = 0;           // forest and global block lists (on every rank)
+
+  // Data, fluxes, and coarse buffers by the package that added the field and by the
+  // label of the field. Fluxes are attributed to the package of their field. Both
+  // contain all packages and fields, so they have the same keys on all ranks.
+  std::map<std::string, std::uint64_t> packages;
+  std::map<std::string, std::uint64_t> fields;
+
+  std::uint64_t Total() const {
+    return variables + fluxes + coarse_buffers + boundary_buffers + variable_pool +
+           swarms + forest;
+  }
+
+  // Collective reductions over all ranks, the result is available on all ranks
+  MemoryUsage Sum() const;
+  MemoryUsage Max() const;
+
+  // Print a summary, including every package and the fields that hold more than
+  // min_field_fraction of the total
+  void Print(std::ostream &os, double min_field_fraction = 0.01) const;
+
+ private:
+  MemoryUsage Reduce(bool max) const;
+};
+
+} // namespace parthenon
+
+#endif // MESH_MEMORY_USAGE_HPP_
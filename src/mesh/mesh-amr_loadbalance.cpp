@@ -22,13 +22,20 @@
 //  \brief implementation of Mesh::AdaptiveMeshRefinement() and related utilities
 
 #include <algorithm>
+#include <array>
+#include <cmath>
 #include <cstdint>
 #include <iostream>
+#include <map>
+#include <memory>
 #include <numeric>
+#include <set>
 #include <sstream>
 #include <string>
 #include <tuple>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "parthenon_mpi.hpp"
 
@@ -36,12 +43,17 @@
 #include "defs.hpp"
 #include "globals.hpp"
 #include "interface/update.hpp"
+#include "kokkos_abstraction.hpp"
+#include "mesh/load_balance.hpp"
 #include "mesh/mesh.hpp"
 #include "mesh/mesh_refinement.hpp"
 #include "mesh/meshblock.hpp"
 #include "parthenon_arrays.hpp"
 #include "utils/buffer_utils.hpp"
 #include "utils/error_checking.hpp"
+#include "utils/indexer.hpp"
+#include "utils/instrument.hpp"
+#include "utils/telemetry.hpp"
 
 namespace parthenon {
 
@@ -78,76 +90,171 @@ MPI_Request SendCoarseToFine(int lid_recv, int dest_rank, const LogicalLocation
 }
 #endif
 
+//----------------------------------------------------------------------------------------
+// A copy of one topological element of a variable between an old and a new block (or a
+// received buffer) during remeshing, i.e.
+//   dst(te, t, u, v, k + dk, j + dj, i + di) = src(te, t, u, v, k + sk, j + sj, i + si)
+// for all (t, u, v, k, j, i) covered by idxer. Collecting these allows to do all copies
+// of a remesh step in a single kernel launch.
+struct AMRCopyRegion {
+  ParArrayND<Real, VariableState> src, dst;
+  Indexer6D idxer;
+  int te, sk, sj, si, dk, dj, di;
+};
+
+//----------------------------------------------------------------------------------------
+//! \fn void AddCoarseToFineRegions(const ParArrayND<Real, VariableState> &fb, int ox1,
+//        int ox2, int ox3, Variable<Real> *var, MeshBlock *pmb,
+//        std::vector<AMRCopyRegion> &regions)
+//  \brief add the copies of the part of the parent block data fb covered by the fine
+//  block at offset (ox1, ox2, ox3) into the coarse buffer of var for prolongation
+
+void AddCoarseToFineRegions(const ParArrayND<Real, VariableState> &fb, int ox1, int ox2,
+                            int ox3, Variable<Real> *var, MeshBlock *pmb,
+                            std::vector<AMRCopyRegion> &regions) {
+  const int nt = fb.GetDim(6) - 1;
+  const int nu = fb.GetDim(5) - 1;
+  const int nv = fb.GetDim(4) - 1;
+
+  auto &cellbounds = var->IsSet(Metadata::Fine) ? pmb->f_cellbounds : pmb->cellbounds;
+  auto &c_cellbounds = var->IsSet(Metadata::Fine) ? pmb->cellbounds : pmb->c_cellbounds;
+  for (auto te : var->GetTopologicalElements()) {
+    IndexRange ib = c_cellbounds.GetBoundsI(IndexDomain::entire, te);
+    IndexRange jb = c_cellbounds.GetBoundsJ(IndexDomain::entire, te);
+    IndexRange kb = c_cellbounds.GetBoundsK(IndexDomain::entire, te);
+
+    IndexRange ib_int = cellbounds.GetBoundsI(IndexDomain::interior, te);
+    IndexRange jb_int = cellbounds.GetBoundsJ(IndexDomain::interior, te);
+    IndexRange kb_int = cellbounds.GetBoundsK(IndexDomain::interior, te);
+
+    AMRCopyRegion region;
+    region.src = fb;
+    region.dst = var->coarse_s;
+    region.idxer = Indexer6D({0, nt}, {0, nu}, {0, nv}, {kb.s, kb.e}, {jb.s, jb.e},
+                             {ib.s, ib.e});
+    region.te = static_cast<int>(te) % 3;
+    region.sk = (ox3 == 0) ? 0 : (kb_int.e - kb_int.s + 1) / 2;
+    region.sj = (ox2 == 0) ? 0 : (jb_int.e - jb_int.s + 1) / 2;
+    region.si = (ox1 == 0) ? 0 : (ib_int.e - ib_int.s + 1) / 2;
+    region.dk = region.dj = region.di = 0;
+    regions.push_back(region);
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void AddFineToCoarseRegions(const ParArrayND<Real, VariableState> &cb, int ox1,
+//        int ox2, int ox3, Variable<Real> *var, MeshBlock *pmb,
+//        std::vector<AMRCopyRegion> &regions)
+//  \brief add the copies of the restricted data cb of the fine block at offset
+//  (ox1, ox2, ox3) into the corresponding part of the coarse block data of var
+
+void AddFineToCoarseRegions(const ParArrayND<Real, VariableState> &cb, int ox1, int ox2,
+                            int ox3, Variable<Real> *var, MeshBlock *pmb,
+                            std::vector<AMRCopyRegion> &regions) {
+  const int ndim = pmb->pmy_mesh->ndim;
+  const int nt = var->data.GetDim(6) - 1;
+  const int nu = var->data.GetDim(5) - 1;
+  const int nv = var->data.GetDim(4) - 1;
+
+  auto &c_cellbounds = var->IsSet(Metadata::Fine) ? pmb->cellbounds : pmb->c_cellbounds;
+  for (auto te : var->GetTopologicalElements()) {
+    IndexRange ib = c_cellbounds.GetBoundsI(IndexDomain::interior, te);
+    IndexRange jb = c_cellbounds.GetBoundsJ(IndexDomain::interior, te);
+    IndexRange kb = c_cellbounds.GetBoundsK(IndexDomain::interior, te);
+    // Deal with ownership of shared elements by removing right side of index
+    // space if fine block is on the left side of a direction. I think this
+    // should work fine even if the ownership model is changed elsewhere, since
+    // the fine blocks should be consistent in their shared elements at this point
+    if (ox3 == 0 && ndim > 2) kb.e -= TopologicalOffsetK(te);
+    if (ox2 == 0 && ndim > 1) jb.e -= TopologicalOffsetJ(te);
+    if (ox1 == 0) ib.e -= TopologicalOffsetI(te);
+
+    AMRCopyRegion region;
+    region.src = cb;
+    region.dst = var->data;
+    region.idxer = Indexer6D({0, nt}, {0, nu}, {0, nv}, {kb.s, kb.e}, {jb.s, jb.e},
+                             {ib.s, ib.e});
+    region.te = static_cast<int>(te) % 3;
+    region.sk = region.sj = region.si = 0;
+    region.dk = (ox3 == 0 || ndim < 3) ? 0 : (kb.e - kb.s + 1 - TopologicalOffsetK(te));
+    region.dj = (ox2 == 0 || ndim < 2) ? 0 : (jb.e - jb.s + 1 - TopologicalOffsetJ(te));
+    region.di = (ox1 == 0) ? 0 : (ib.e - ib.s + 1 - TopologicalOffsetI(te));
+    regions.push_back(region);
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void CopyAMRRegions(const std::vector<AMRCopyRegion> &regions)
+//  \brief do all copies in regions in a single kernel with one team per region
+
+void CopyAMRRegions(const std::vector<AMRCopyRegion> &regions) {
+  if (regions.empty()) return;
+  const int nregions = regions.size();
+  ParArray1D<AMRCopyRegion> regions_d("AMR copy regions", nregions);
+  auto regions_h = Kokkos::create_mirror_view(HostMemSpace(), regions_d);
+  for (int r = 0; r < nregions; ++r)
+    regions_h(r) = regions[r];
+  Kokkos::deep_copy(regions_d, regions_h);
+
+  par_for_outer(
+      DEFAULT_OUTER_LOOP_PATTERN, PARTHENON_AUTO_LABEL, DevExecSpace(), 0, 0, 0,
+      nregions - 1, KOKKOS_LAMBDA(team_mbr_t team_member, const int r) {
+        const auto &reg = regions_d(r);
+        par_for_inner(DEFAULT_INNER_LOOP_PATTERN, team_member, 0, reg.idxer.size() - 1,
+                      [&](const int ii) {
+                        const auto [t, u, v, k, j, i] = reg.idxer(ii);
+                        reg.dst(reg.te, t, u, v, k + reg.dk, j + reg.dj, i + reg.di) =
+                            reg.src(reg.te, t, u, v, k + reg.sk, j + reg.sj, i + reg.si);
+                      });
+      });
+}
+
+void UnpackCoarseToFine(const ParArrayND<Real, VariableState> &fb, int ox1, int ox2,
+                        int ox3, Variable<Real> *var, MeshBlock *pmb) {
+  std::vector<AMRCopyRegion> regions;
+  AddCoarseToFineRegions(fb, ox1, ox2, ox3, var, pmb, regions);
+  CopyAMRRegions(regions);
+}
+
+void UnpackFineToCoarse(const ParArrayND<Real, VariableState> &cb, int ox1, int ox2,
+                        int ox3, Variable<Real> *var, MeshBlock *pmb) {
+  std::vector<AMRCopyRegion> regions;
+  AddFineToCoarseRegions(cb, ox1, ox2, ox3, var, pmb, regions);
+  CopyAMRRegions(regions);
+}
+
+#ifdef MPI_PARALLEL
 bool TryRecvCoarseToFine(int lid_recv, int send_rank, const LogicalLocation &fine_loc,
-                         Variable<Real> *var_in, Variable<Real> *var, MeshBlock *pmb,
-                         Mesh *pmesh) {
+                         Variable<Real> *var, MeshBlock *pmb, Mesh *pmesh) {
   const int ox1 = ((fine_loc.lx1() & 1LL) == 1LL);
   const int ox2 = ((fine_loc.lx2() & 1LL) == 1LL);
   const int ox3 = ((fine_loc.lx3() & 1LL) == 1LL);
 
-  int test = 1;
-#ifdef MPI_PARALLEL
   MPI_Comm comm = pmesh->GetMPIComm(var->label());
   int tag = CreateAMRMPITag(lid_recv, ox1, ox2, ox3);
+  int test;
   MPI_Status status;
   PARTHENON_MPI_CHECK(MPI_Iprobe(send_rank, tag, comm, &test, &status));
-#endif
   if (test) {
-    int size = var_in->IsAllocated();
-#ifdef MPI_PARALLEL
+    int size;
     PARTHENON_MPI_CHECK(MPI_Get_count(&status, MPI_PARTHENON_REAL, &size));
-#endif
     if (size > 0) {
       if (!pmb->IsAllocated(var->label())) pmb->AllocateSparse(var->label());
-      auto fb = var_in->data;
-#ifdef MPI_PARALLEL
       PARTHENON_MPI_CHECK(MPI_Recv(var->data.data(), var->data.size(), MPI_PARTHENON_REAL,
                                    send_rank, tag, comm, MPI_STATUS_IGNORE));
-      fb = var->data;
-#endif
-      auto cb = var->coarse_s;
-      const int nt = fb.GetDim(6) - 1;
-      const int nu = fb.GetDim(5) - 1;
-      const int nv = fb.GetDim(4) - 1;
-
-      auto &cellbounds = var->IsSet(Metadata::Fine) ? pmb->f_cellbounds : pmb->cellbounds;
-      auto &c_cellbounds =
-          var->IsSet(Metadata::Fine) ? pmb->cellbounds : pmb->c_cellbounds;
-      for (auto te : var->GetTopologicalElements()) {
-        IndexRange ib = c_cellbounds.GetBoundsI(IndexDomain::entire, te);
-        IndexRange jb = c_cellbounds.GetBoundsJ(IndexDomain::entire, te);
-        IndexRange kb = c_cellbounds.GetBoundsK(IndexDomain::entire, te);
-
-        IndexRange ib_int = cellbounds.GetBoundsI(IndexDomain::interior, te);
-        IndexRange jb_int = cellbounds.GetBoundsJ(IndexDomain::interior, te);
-        IndexRange kb_int = cellbounds.GetBoundsK(IndexDomain::interior, te);
-
-        const int ks = (ox3 == 0) ? 0 : (kb_int.e - kb_int.s + 1) / 2;
-        const int js = (ox2 == 0) ? 0 : (jb_int.e - jb_int.s + 1) / 2;
-        const int is = (ox1 == 0) ? 0 : (ib_int.e - ib_int.s + 1) / 2;
-        const int idx_te = static_cast<int>(te) % 3;
-        parthenon::par_for(
-            PARTHENON_AUTO_LABEL, 0, nt, 0, nu, 0, nv, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
-            KOKKOS_LAMBDA(const int t, const int u, const int v, const int k, const int j,
-                          const int i) {
-              cb(idx_te, t, u, v, k, j, i) = fb(idx_te, t, u, v, k + ks, j + js, i + is);
-            });
-      }
+      UnpackCoarseToFine(var->data, ox1, ox2, ox3, var, pmb);
     } else {
       if (pmb->IsAllocated(var->label()) &&
           !var->metadata().IsSet(Metadata::ForceAllocOnNewBlocks))
         pmb->DeallocateSparse(var->label());
-#ifdef MPI_PARALLEL
       PARTHENON_MPI_CHECK(MPI_Recv(var->data.data(), 0, MPI_PARTHENON_REAL, send_rank,
                                    tag, comm, MPI_STATUS_IGNORE));
-#endif
     }
   }
 
   return test;
 }
 
-#ifdef MPI_PARALLEL
 MPI_Request SendFineToCoarse(int lid_recv, int dest_rank, const LogicalLocation &fine_loc,
                              Variable<Real> *var, Mesh *pmesh) {
   MPI_Request req;
@@ -167,85 +274,41 @@ MPI_Request SendFineToCoarse(int lid_recv, int dest_rank, const LogicalLocation
   }
   return req;
 }
-#endif
 
 bool TryRecvFineToCoarse(int lid_recv, int send_rank, const LogicalLocation &fine_loc,
-                         Variable<Real> *var_in, Variable<Real> *var, MeshBlock *pmb,
-                         Mesh *pmesh) {
-  const int ndim = pmb->pmy_mesh->ndim;
+                         Variable<Real> *var, MeshBlock *pmb, Mesh *pmesh) {
   const int ox1 = ((fine_loc.lx1() & 1LL) == 1LL);
   const int ox2 = ((fine_loc.lx2() & 1LL) == 1LL);
   const int ox3 = ((fine_loc.lx3() & 1LL) == 1LL);
 
-  int test = 1;
-#ifdef MPI_PARALLEL
   MPI_Comm comm = pmesh->GetMPIComm(var->label());
   int tag = CreateAMRMPITag(lid_recv, ox1, ox2, ox3);
+  int test;
   MPI_Status status;
   PARTHENON_MPI_CHECK(MPI_Iprobe(send_rank, tag, comm, &test, &status));
-#endif
   if (test) {
-    int size = var_in->IsAllocated();
-#ifdef MPI_PARALLEL
+    int size;
     PARTHENON_MPI_CHECK(MPI_Get_count(&status, MPI_PARTHENON_REAL, &size));
-#endif
     if (size > 0) {
       if (!pmb->IsAllocated(var->label())) pmb->AllocateSparse(var->label());
-      auto cb = var_in->coarse_s;
-#ifdef MPI_PARALLEL
       // This has to be an MPI_Recv w/o buffering
       PARTHENON_MPI_CHECK(MPI_Recv(var->coarse_s.data(), var->coarse_s.size(),
                                    MPI_PARTHENON_REAL, send_rank, tag, comm,
                                    MPI_STATUS_IGNORE));
-      cb = var->coarse_s;
-#endif
-      auto fb = var->data;
-      const int nt = fb.GetDim(6) - 1;
-      const int nu = fb.GetDim(5) - 1;
-      const int nv = fb.GetDim(4) - 1;
-
-      auto &c_cellbounds =
-          var->IsSet(Metadata::Fine) ? pmb->cellbounds : pmb->c_cellbounds;
-      for (auto te : var->GetTopologicalElements()) {
-        IndexRange ib = c_cellbounds.GetBoundsI(IndexDomain::interior, te);
-        IndexRange jb = c_cellbounds.GetBoundsJ(IndexDomain::interior, te);
-        IndexRange kb = c_cellbounds.GetBoundsK(IndexDomain::interior, te);
-        // Deal with ownership of shared elements by removing right side of index
-        // space if fine block is on the left side of a direction. I think this
-        // should work fine even if the ownership model is changed elsewhere, since
-        // the fine blocks should be consistent in their shared elements at this point
-        if (ox3 == 0 && ndim > 2) kb.e -= TopologicalOffsetK(te);
-        if (ox2 == 0 && ndim > 1) jb.e -= TopologicalOffsetJ(te);
-        if (ox1 == 0) ib.e -= TopologicalOffsetI(te);
-        const int ks =
-            (ox3 == 0 || ndim < 3) ? 0 : (kb.e - kb.s + 1 - TopologicalOffsetK(te));
-        const int js =
-            (ox2 == 0 || ndim < 2) ? 0 : (jb.e - jb.s + 1 - TopologicalOffsetJ(te));
-        const int is = (ox1 == 0) ? 0 : (ib.e - ib.s + 1 - TopologicalOffsetI(te));
-        const int idx_te = static_cast<int>(te) % 3;
-        parthenon::par_for(
-            PARTHENON_AUTO_LABEL, 0, nt, 0, nu, 0, nv, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
-            KOKKOS_LAMBDA(const int t, const int u, const int v, const int k, const int j,
-                          const int i) {
-              fb(idx_te, t, u, v, k + ks, j + js, i + is) = cb(idx_te, t, u, v, k, j, i);
-            });
-      }
+      UnpackFineToCoarse(var->coarse_s, ox1, ox2, ox3, var, pmb);
       // We have to block here w/o buffering so that the write is guaranteed to be
       // finished before another fine block that is restricted to a sub-region of
       // this coarse block makes an MPI call and overwrites the coarse buffer.
       Kokkos::fence();
     } else {
-#ifdef MPI_PARALLEL
       PARTHENON_MPI_CHECK(MPI_Recv(var->data.data(), 0, MPI_PARTHENON_REAL, send_rank,
                                    tag, comm, MPI_STATUS_IGNORE));
-#endif
     }
   }
 
   return test;
 }
 
-#ifdef MPI_PARALLEL
 MPI_Request SendSameToSame(int lid_recv, int dest_rank, Variable<Real> *var,
                            MeshBlock *pmb, Mesh *pmesh) {
   MPI_Request req;
@@ -315,6 +378,284 @@ bool TryRecvSameToSame(int lid_recv, int send_rank, Variable<Real> *var, MeshBlo
 }
 #endif
 
+#ifdef MPI_PARALLEL
+// Aggregated AMR migration messages consist of the number of segments, a header for
+// every segment and the data of all allocated segments, in this order. A segment is one
+// variable of one (source block, destination block) pair. Its header holds the local id
+// of the destination block, the index of the variable in vars_cc_, the offset of the
+// fine block within the coarse block (ox1 + 2 * ox2 + 4 * ox3), whether the variable is
+// allocated, the derefinement count of the source block and the dealloc_count of the
+// variable.
+constexpr int amr_migration_header_size = 6;
+
+//----------------------------------------------------------------------------------------
+// \!fn void Mesh::SendAggregatedMigration(...)
+// \brief pack all variables of all blocks going to the same rank into a single buffer
+//        and post one send per destination rank
+
+void Mesh::SendAggregatedMigration(const std::vector<LogicalLocation> &newloc,
+                                   const std::vector<int> &newrank,
+                                   const std::vector<int> &oldtonew, int onbs, int onbe,
+                                   int nleaf, std::vector<BufArray1D<Real>> &send_bufs,
+                                   std::vector<MPI_Request> &send_reqs,
+                                   std::uint64_t &bytes_sent) {
+  struct Segment {
+    std::array<Real, amr_migration_header_size> header;
+    const Real *src;
+    std::size_t size;
+  };
+  // Ordered by destination rank so that all ranks agree on the order of the segments
+  std::map<int, std::vector<Segment>> segments;
+  auto add_segments = [&](int nn, MeshBlock *pmb, const LogicalLocation &loc, bool f2c) {
+    const int dest_rank = newrank[nn];
+    // Blocks staying on this rank are filled directly, see Mesh::FillSameRankAMR
+    if (dest_rank == Globals::my_rank) return;
+    const int ox = ((loc.lx1() & 1LL) == 1LL) + 2 * ((loc.lx2() & 1LL) == 1LL) +
+                   4 * ((loc.lx3() & 1LL) == 1LL);
+    for (int ivar = 0; ivar < pmb->vars_cc_.size(); ++ivar) {
+      auto &var = pmb->vars_cc_[ivar];
+      const bool allocated = var->IsAllocated();
+      auto &src = f2c ? var->coarse_s : var->data;
+      Segment seg;
+      seg.header = {static_cast<Real>(nn - nslist[dest_rank]),
+                    static_cast<Real>(ivar),
+                    static_cast<Real>(ox),
+                    static_cast<Real>(allocated),
+                    static_cast<Real>(pmb->pmr->DerefinementCount()),
+                    static_cast<Real>(var->dealloc_count)};
+      seg.src = allocated ? src.data() : nullptr;
+      seg.size = allocated ? src.size() : 0;
+      segments[dest_rank].push_back(seg);
+    }
+  };
+
+  for (int n = onbs; n <= onbe; n++) {
+    const int nn = oldtonew[n];
+    const LogicalLocation &oloc = loclist[n];
+    const LogicalLocation &nloc = newloc[nn];
+    auto pb = FindMeshBlock(n);
+    if (nloc.level() == oloc.level() && newrank[nn] != Globals::my_rank) { // s2s
+      add_segments(nn, pb.get(), LogicalLocation(), false);
+    } else if (nloc.level() > oloc.level()) { // c2f
+      for (int l = 0; l < nleaf; l++)
+        add_segments(nn + l, pb.get(), newloc[nn + l], false);
+    } else if (nloc.level() < oloc.level()) { // f2c
+      add_segments(nn, pb.get(), oloc, true);
+    }
+  }
+
+  using unmanaged_t =
+      Kokkos::View<const Real *, LayoutWrapper, DevMemSpace, MemUnmanaged>;
+  const int first_buf = send_bufs.size();
+  for (auto &[dest_rank, segs] : segments) {
+    const std::size_t header_size = 1 + amr_migration_header_size * segs.size();
+    std::size_t total_size = header_size;
+    for (auto &seg : segs)
+      total_size += seg.size;
+    BufArray1D<Real> buf("AMR migration send buffer", total_size);
+
+    auto header = Kokkos::subview(buf, std::make_pair(std::size_t(0), header_size));
+    auto header_h = Kokkos::create_mirror_view(HostMemSpace(), header);
+    header_h(0) = static_cast<Real>(segs.size());
+    std::size_t offset = header_size;
+    for (int s = 0; s < segs.size(); ++s) {
+      for (int h = 0; h < amr_migration_header_size; ++h)
+        header_h(1 + amr_migration_header_size * s + h) = segs[s].header[h];
+      if (segs[s].size > 0) {
+        Kokkos::deep_copy(
+            DevExecSpace(),
+            Kokkos::subview(buf, std::make_pair(offset, offset + segs[s].size)),
+            unmanaged_t(segs[s].src, segs[s].size));
+        offset += segs[s].size;
+      }
+    }
+    Kokkos::deep_copy(header, header_h);
+    send_bufs.push_back(buf);
+    bytes_sent += total_size * sizeof(Real);
+  }
+  // All buffers need to be filled before handing them to MPI
+  Kokkos::fence();
+
+  MPI_Comm comm = GetMPIComm(amr_migration_comm_);
+  const int tag = CreateAMRMPITag(0, 0, 0, 0);
+  int ibuf = first_buf;
+  for (auto &[dest_rank, segs] : segments) {
+    auto &buf = send_bufs[ibuf++];
+    if (host_staging.Enabled()) {
+      // The receiver can't probe the size of a message that is sent in chunks
+      migration_staged_sizes_.push_back(buf.size());
+      send_reqs.emplace_back();
+      PARTHENON_MPI_CHECK(MPI_Isend(&migration_staged_sizes_.back(), 1, MPI_INT64_T,
+                                    dest_rank, tag, comm, &send_reqs.back()));
+      migration_staging_.push_back(host_staging.Get(buf.size()));
+      host_staging.Isend(buf.data(), buf.size(), migration_staging_.back(), dest_rank,
+                         tag, comm, send_reqs);
+      continue;
+    }
+    send_reqs.emplace_back();
+    PARTHENON_MPI_CHECK(MPI_Isend(buf.data(), buf.size(), MPI_PARTHENON_REAL, dest_rank,
+                                  tag, comm, &send_reqs.back()));
+  }
+}
+
+//----------------------------------------------------------------------------------------
+// \!fn void Mesh::RecvAggregatedMigration(...)
+// \brief receive the aggregated messages from all ranks that own old blocks feeding
+//        into the new blocks of this rank and unpack them
+
+void Mesh::RecvAggregatedMigration(const std::vector<LogicalLocation> &newloc,
+                                   const std::vector<int> &newtoold, int nbs, int nbe,
+                                   int nleaf) {
+  // Collect the ranks this rank expects a message from, mirroring the send logic
+  std::set<int> pending;
+  for (int n = nbs; n <= nbe; n++) {
+    const int on = newtoold[n];
+    const int nsrc = loclist[on].level() > newloc[n].level() ? nleaf : 1;
+    for (int l = 0; l < nsrc; l++) {
+      if (ranklist[on + l] != Globals::my_rank) pending.insert(ranklist[on + l]);
+    }
+  }
+
+  using unmanaged_t = Kokkos::View<Real *, LayoutWrapper, DevMemSpace, MemUnmanaged>;
+  MPI_Comm comm = GetMPIComm(amr_migration_comm_);
+  const int tag = CreateAMRMPITag(0, 0, 0, 0);
+  int niter = 0;
+  while (!pending.empty() && niter++ < 1e7) {
+    for (auto it = pending.begin(); it != pending.end();) {
+      const int send_rank = *it;
+      int test;
+      MPI_Status status;
+      PARTHENON_MPI_CHECK(MPI_Iprobe(send_rank, tag, comm, &test, &status));
+      if (!test) {
+        ++it;
+        continue;
+      }
+      BufArray1D<Real> buf;
+      if (host_staging.Enabled()) {
+        std::int64_t size;
+        PARTHENON_MPI_CHECK(
+            MPI_Recv(&size, 1, MPI_INT64_T, send_rank, tag, comm, MPI_STATUS_IGNORE));
+        buf = BufArray1D<Real>("AMR migration recv buffer", size);
+        auto host = host_staging.Get(size);
+        std::vector<MPI_Request> requests;
+        host_staging.Irecv(size, 0, host_staging.NumChunks(size), host, send_rank, tag,
+                           comm, requests);
+        int next = 0;
+        host_staging.Progress(buf.data(), size, host, requests, next, true,
+                              DevExecSpace());
+        Kokkos::fence();
+        host_staging.Release(host);
+      } else {
+        int size;
+        PARTHENON_MPI_CHECK(MPI_Get_count(&status, MPI_PARTHENON_REAL, &size));
+        buf = BufArray1D<Real>("AMR migration recv buffer", size);
+        PARTHENON_MPI_CHECK(MPI_Recv(buf.data(), size, MPI_PARTHENON_REAL, send_rank,
+                                     tag, comm, MPI_STATUS_IGNORE));
+      }
+
+      auto nseg_h = Kokkos::create_mirror_view_and_copy(
+          HostMemSpace(), Kokkos::subview(buf, std::make_pair(0, 1)));
+      const int nseg = static_cast<int>(nseg_h(0));
+      const int header_size = 1 + amr_migration_header_size * nseg;
+      auto header_h = Kokkos::create_mirror_view_and_copy(
+          HostMemSpace(), Kokkos::subview(buf, std::make_pair(0, header_size)));
+
+      std::size_t offset = header_size;
+      for (int s = 0; s < nseg; ++s) {
+        const int h = 1 + amr_migration_header_size * s;
+        const int lid = static_cast<int>(header_h(h));
+        const int ivar = static_cast<int>(header_h(h + 1));
+        const int ox = static_cast<int>(header_h(h + 2));
+        const bool allocated = header_h(h + 3) > 0.5;
+        const int ox1 = ox & 1;
+        const int ox2 = (ox >> 1) & 1;
+        const int ox3 = (ox >> 2) & 1;
+
+        const int n = nbs + lid;
+        const int on = newtoold[n];
+        auto &pb = block_list[lid];
+        auto var = pb->vars_cc_[ivar].get();
+        const bool f2c = loclist[on].level() > newloc[n].level();
+        const bool c2f = loclist[on].level() < newloc[n].level();
+
+        if (allocated) {
+          if (!pb->IsAllocated(var->label())) pb->AllocateSparse(var->label());
+          auto &dst = f2c ? var->coarse_s : var->data;
+          Kokkos::deep_copy(
+              DevExecSpace(), unmanaged_t(dst.data(), dst.size()),
+              Kokkos::subview(buf, std::make_pair(offset, offset + dst.size())));
+          offset += dst.size();
+          if (c2f) {
+            UnpackCoarseToFine(var->data, ox1, ox2, ox3, var, pb.get());
+          } else if (f2c) {
+            UnpackFineToCoarse(var->coarse_s, ox1, ox2, ox3, var, pb.get());
+            // The coarse buffer is reused by the other fine blocks of this coarse block
+            Kokkos::fence();
+          }
+        } else if (!f2c && pb->IsAllocated(var->label()) &&
+                   !var->metadata().IsSet(Metadata::ForceAllocOnNewBlocks)) {
+          pb->DeallocateSparse(var->label());
+        }
+        if (!f2c && !c2f) {
+          pb->pmr->DerefinementCount() = static_cast<int>(header_h(h + 4));
+          var->dealloc_count = static_cast<int>(header_h(h + 5));
+        }
+      }
+      // The receive buffer goes out of scope after this iteration
+      Kokkos::fence();
+      it = pending.erase(it);
+    }
+  }
+  if (!pending.empty()) PARTHENON_FAIL("AMR Receive failed");
+}
+#endif // MPI_PARALLEL
+
+//----------------------------------------------------------------------------------------
+// \!fn void Mesh::FillSameRankAMR(...)
+// \brief copy the data from the old to the new blocks of all coarse-to-fine and
+//        fine-to-coarse pairs that are both on this rank, in a single kernel launch
+
+void Mesh::FillSameRankAMR(const BlockList_t &old_block_list,
+                           const std::vector<LogicalLocation> &newloc,
+                           const std::vector<int> &newtoold, int onbs, int nbs, int nbe,
+                           int nleaf) {
+  std::vector<AMRCopyRegion> regions;
+  for (int n = nbs; n <= nbe; n++) {
+    const int on = newtoold[n];
+    const LogicalLocation &oloc = loclist[on];
+    const LogicalLocation &nloc = newloc[n];
+    auto pb = block_list[n - nbs].get();
+    if (oloc.level() > nloc.level()) { // f2c
+      for (int l = 0; l < nleaf; l++) {
+        if (ranklist[on + l] != Globals::my_rank) continue;
+        auto pob = old_block_list[on + l - onbs].get();
+        const LogicalLocation &floc = loclist[on + l];
+        for (auto &var : pb->vars_cc_) {
+          auto var_in = pob->meshblock_data.Get()->GetVarPtr(var->label());
+          if (!var_in->IsAllocated()) continue;
+          if (!pb->IsAllocated(var->label())) pb->AllocateSparse(var->label());
+          AddFineToCoarseRegions(var_in->coarse_s, floc.lx1() & 1LL, floc.lx2() & 1LL,
+                                 floc.lx3() & 1LL, var.get(), pb, regions);
+        }
+      }
+    } else if (oloc.level() < nloc.level() && ranklist[on] == Globals::my_rank) { // c2f
+      auto pob = old_block_list[on - onbs].get();
+      for (auto &var : pb->vars_cc_) {
+        auto var_in = pob->meshblock_data.Get()->GetVarPtr(var->label());
+        if (var_in->IsAllocated()) {
+          if (!pb->IsAllocated(var->label())) pb->AllocateSparse(var->label());
+          AddCoarseToFineRegions(var_in->data, nloc.lx1() & 1LL, nloc.lx2() & 1LL,
+                                 nloc.lx3() & 1LL, var.get(), pb, regions);
+        } else if (pb->IsAllocated(var->label()) &&
+                   !var->metadata().IsSet(Metadata::ForceAllocOnNewBlocks)) {
+          pb->DeallocateSparse(var->label());
+        }
+      }
+    }
+  }
+  CopyAMRRegions(regions);
+}
+
 //----------------------------------------------------------------------------------------
 // \!fn void Mesh::LoadBalancingAndAdaptiveMeshRefinement(ParameterInput *pin)
 // \brief Main function for adaptive mesh refinement
@@ -323,92 +664,64 @@ void Mesh::LoadBalancingAndAdaptiveMeshRefinement(ParameterInput *pin,
                                                   ApplicationInput *app_in) {
   PARTHENON_INSTRUMENT
   int nnew = 0, ndel = 0;
+  // Split the time between remeshing and pure load balancing for the telemetry
+  auto &telemetry = Telemetry::Instance();
+  double start = telemetry.Now();
+  auto add_time = [&](const Telemetry::Timer timer) {
+    const double now = telemetry.Now();
+    if (telemetry.Enabled()) telemetry.Add(timer, now - start);
+    start = now;
+  };
 
   if (adaptive) {
     UpdateMeshBlockTree(nnew, ndel);
     nbnew += nnew;
     nbdel += ndel;
+    add_time(Telemetry::remesh);
   }
 
   lb_flag_ |= lb_automatic_;
 
   UpdateCostList();
+  // Particles moving between blocks change the load without any change of the mesh
+  if (!lb_automatic_) lb_flag_ |= CheckParticleCostDrift();
+  // Only check the balance if it is off, but possibly every cycle
+  if (lb_imbalance_trigger_) lb_flag_ = CheckImbalanceTrigger();
 
   modified = false;
   if (nnew != 0 || ndel != 0) { // at least one (de)refinement happened
     GatherCostListAndCheckBalance();
+    add_time(Telemetry::load_balance);
     RedistributeAndRefineMeshBlocks(pin, app_in, nbtotal + nnew - ndel);
     modified = true;
-  } else if (lb_flag_ && step_since_lb >= lb_interval_) {
+    add_time(Telemetry::remesh);
+  } else if (lb_flag_ && (lb_imbalance_trigger_ || step_since_lb >= lb_interval_)) {
+    lb_rank_particle_cost_at_check_ = lb_rank_particle_cost_;
     if (!GatherCostListAndCheckBalance()) { // load imbalance detected
+      const double migration_start = telemetry.Now();
       RedistributeAndRefineMeshBlocks(pin, app_in, nbtotal);
       modified = true;
+      // Needs to be the same on all ranks for the next decisions
+      lb_migration_time_ = telemetry.Now() - migration_start;
+#ifdef MPI_PARALLEL
+      PARTHENON_MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, &lb_migration_time_, 1, MPI_DOUBLE,
+                                        MPI_MAX, MPI_COMM_WORLD));
+#endif
     }
     lb_flag_ = false;
   }
+  if (lb_imbalance_trigger_) PostRankCostReduction();
+  add_time(Telemetry::load_balance);
 }
 
-// Private routines
-namespace {
-/**
- * @brief This routine assigns blocks to ranks by attempting to place index-contiguous
- * blocks of equal total cost on each rank.
- *
- * @param costlist (Input) A map of global block ID to a relative weight.
- * @param ranklist (Output) A map of global block ID to ranks.
- */
-void AssignBlocks(std::vector<double> const &costlist, std::vector<int> &ranklist) {
-  ranklist.resize(costlist.size());
-
-  double const total_cost = std::accumulate(costlist.begin(), costlist.end(), 0.0);
-
-  int rank = (Globals::nranks)-1;
-  double target_cost = total_cost / Globals::nranks;
-  double my_cost = 0.0;
-  double remaining_cost = total_cost;
-  // create rank list from the end: the master MPI rank should have less load
-  for (int block_id = costlist.size() - 1; block_id >= 0; block_id--) {
-    if (target_cost == 0.0) {
-      std::stringstream msg;
-      msg << "### FATAL ERROR in CalculateLoadBalance" << std::endl
-          << "There is at least one process which has no MeshBlock" << std::endl
-          << "Decrease the number of processes or use smaller MeshBlocks." << std::endl;
-      PARTHENON_FAIL(msg);
-    }
-    my_cost += costlist[block_id];
-    ranklist[block_id] = rank;
-    if (my_cost >= target_cost && rank > 0) {
-      rank--;
-      remaining_cost -= my_cost;
-      my_cost = 0.0;
-      target_cost = remaining_cost / (rank + 1);
-    }
-  }
-}
-
-void UpdateBlockList(std::vector<int> const &ranklist, std::vector<int> &nslist,
-                     std::vector<int> &nblist) {
-  nslist.resize(Globals::nranks);
-  nblist.resize(Globals::nranks);
-
-  nslist[0] = 0;
-  int rank = 0;
-  for (int block_id = 1; block_id < ranklist.size(); block_id++) {
-    if (ranklist[block_id] != ranklist[block_id - 1]) {
-      nblist[rank] = block_id - nslist[rank];
-      nslist[++rank] = block_id;
-    }
-  }
-  nblist[rank] = ranklist.size() - nslist[rank];
-}
-} // namespace
-
 //----------------------------------------------------------------------------------------
 // \brief Calculate distribution of MeshBlocks based on the cost list
 void Mesh::CalculateLoadBalance(std::vector<double> const &costlist,
+                                std::vector<LogicalLocation> const &loclist,
                                 std::vector<int> &ranklist, std::vector<int> &nslist,
-                                std::vector<int> &nblist) {
-  PARTHENON_INSTRUMENT
+                                std::vector<int> &nblist,
+                                std::vector<int> const &prev_ranklist) {
+  PARTHENON_INSTRUMENT_REGION("Mesh::CalculateLoadBalance")
   auto const total_blocks = costlist.size();
 
   using it = std::vector<double>::const_iterator;
@@ -417,12 +730,38 @@ void Mesh::CalculateLoadBalance(std::vector<double> const &costlist,
   double const mincost = min_max.first == costlist.begin() ? 0.0 : *min_max.first;
   double const maxcost = min_max.second == costlist.begin() ? 0.0 : *min_max.second;
 
-  // Assigns blocks to ranks on a rougly cost-equal basis.
-  AssignBlocks(costlist, ranklist);
+  // Assigns blocks to ranks on a rougly cost-equal basis, or proportional to the weights
+  // of the ranks if they are known
+  const std::vector<double> weights = lb_rank_weights_.empty()
+                                          ? std::vector<double>(Globals::nranks, 1.0)
+                                          : lb_rank_weights_;
+  if (lb_node_sizes_.size() > 1) {
+    // First across nodes, then across the ranks of every node
+    loadbalance::AssignBlocksHierarchical(costlist, lb_node_sizes_, weights,
+                                          lb_partitioner_, ranklist);
+  } else if (lb_partitioner_ == loadbalance::Partitioner::optimal) {
+    loadbalance::AssignBlocksOptimal(costlist, weights, ranklist);
+  } else if (lb_partitioner_ == loadbalance::Partitioner::incremental) {
+    // Without a previous assignment (e.g. on startup) this falls back to the optimal
+    // partitioner
+    loadbalance::AssignBlocksIncremental(costlist, prev_ranklist, Globals::nranks,
+                                         lb_incremental_tolerance_, ranklist);
+  } else if (lb_partitioner_ == loadbalance::Partitioner::user) {
+    PARTHENON_REQUIRE_THROWS(UserPartitioner != nullptr,
+                             "User partitioner requested but none was provided.");
+    ranklist.resize(costlist.size());
+    UserPartitioner(costlist, loclist, Globals::nranks, ranklist);
+    PARTHENON_REQUIRE_THROWS(
+        ranklist.size() == costlist.size() &&
+            loadbalance::IsContiguous(ranklist, Globals::nranks),
+        "User partitioner must assign contiguous ranges of blocks to increasing ranks.");
+  } else {
+    loadbalance::AssignBlocksGreedy(costlist, weights, ranklist);
+  }
 
   // Updates nslist with the ID of the starting block on each rank and the count of blocks
   // on each rank.
-  UpdateBlockList(ranklist, nslist, nblist);
+  loadbalance::UpdateBlockList(ranklist, Globals::nranks, nslist, nblist);
 
 #ifdef MPI_PARALLEL
   if (total_blocks % (Globals::nranks) != 0 && !adaptive && !lb_flag_ &&
@@ -470,6 +809,8 @@ void Mesh::ResetLoadBalanceVariables() {
   }
   lb_flag_ = false;
   step_since_lb = 0;
+  // The particle cost of the new blocks is only known at the next update
+  lb_rank_particle_cost_at_check_ = -1.0;
 }
 
 //----------------------------------------------------------------------------------------
@@ -478,150 +819,268 @@ void Mesh::ResetLoadBalanceVariables() {
 
 void Mesh::UpdateCostList() {
   if (lb_automatic_) {
+    // exponentially smooth the cost measured during the last cycle
     double w = static_cast<double>(lb_interval_ - 1) / static_cast<double>(lb_interval_);
     for (auto &pmb : block_list) {
       costlist[pmb->gid] = costlist[pmb->gid] * w + pmb->cost_;
+      pmb->ResetTimeMeasurement();
     }
-  } else if (lb_flag_) {
+  } else if (lb_flag_ || lb_particle_cost_) {
+    // Particle costs are measured directly by the timing based load balancer, so they
+    // are only added here. Without manual costs every block counts as one.
+    lb_rank_particle_cost_ = 0.0;
     for (auto &pmb : block_list) {
-      costlist[pmb->gid] = pmb->cost_;
+      const double particle_cost = lb_particle_cost_ ? pmb->GetParticleCost() : 0.0;
+      costlist[pmb->gid] = (lb_manual_ ? pmb->cost_ : 1.0) + particle_cost;
+      lb_rank_particle_cost_ += particle_cost;
     }
+    if (lb_rank_particle_cost_at_check_ < 0.0)
+      lb_rank_particle_cost_at_check_ = lb_rank_particle_cost_;
   }
 }
 
+//----------------------------------------------------------------------------------------
+// \!fn bool Mesh::CheckParticleCostDrift()
+// \brief check whether the particle cost of any rank changed by more than the tolerance
+// since the last balance check. Collective, all ranks return the same value.
+
+bool Mesh::CheckParticleCostDrift() {
+  if (!lb_particle_cost_ || lb_particle_drift_tolerance_ <= 0.0 ||
+      step_since_lb < lb_interval_)
+    return false;
+  double drift = std::abs(lb_rank_particle_cost_ - lb_rank_particle_cost_at_check_);
+  double total = lb_rank_particle_cost_;
+#ifdef MPI_PARALLEL
+  PARTHENON_MPI_CHECK(
+      MPI_Allreduce(MPI_IN_PLACE, &drift, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD));
+  PARTHENON_MPI_CHECK(
+      MPI_Allreduce(MPI_IN_PLACE, &total, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD));
+#endif
+  return drift > lb_particle_drift_tolerance_ * total / Globals::nranks;
+}
+
+//----------------------------------------------------------------------------------------
+// \!fn bool Mesh::CheckImbalanceTrigger()
+// \brief complete the reduction of the rank costs posted in the last cycle and decide
+// whether the balance should be checked. Collective, all ranks return the same value.
+
+bool Mesh::CheckImbalanceTrigger() {
+#ifdef MPI_PARALLEL
+  if (lb_cost_requests_[0] == MPI_REQUEST_NULL) return false;
+  // Usually done long ago
+  PARTHENON_MPI_CHECK(MPI_Waitall(2, lb_cost_requests_, MPI_STATUSES_IGNORE));
+  const double maxcost = lb_reduced_cost_[0];
+  const double avecost = lb_reduced_cost_[1] / Globals::nranks;
+  if (maxcost <= (1.0 + lb_tolerance_) * avecost) return false;
+  // The smoothed timing based cost of a rank is about lb_interval_ times its time per
+  // cycle, so the difference is the time that rebalancing saves over the next
+  // lb_interval_ cycles. Other costs are not comparable to times.
+  return !lb_automatic_ || maxcost - avecost > lb_migration_time_;
+#else
+  return false;
+#endif
+}
+
+//----------------------------------------------------------------------------------------
+// \!fn void Mesh::PostRankCostReduction()
+// \brief start the reduction of the maximum and the sum of the rank costs (divided by
+// the relative throughput of the rank) that is completed in the next cycle
+
+void Mesh::PostRankCostReduction() {
+#ifdef MPI_PARALLEL
+  double cost = 0.0;
+  for (auto &pmb : block_list)
+    cost += costlist[pmb->gid];
+  if (!lb_rank_weights_.empty()) {
+    const double mean_weight =
+        std::accumulate(lb_rank_weights_.begin(), lb_rank_weights_.end(), 0.0) /
+        Globals::nranks;
+    cost *= mean_weight / lb_rank_weights_[Globals::my_rank];
+  }
+  lb_rank_cost_[0] = lb_rank_cost_[1] = cost;
+  PARTHENON_MPI_CHECK(MPI_Iallreduce(&lb_rank_cost_[0], &lb_reduced_cost_[0], 1,
+                                     MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD,
+                                     &lb_cost_requests_[0]));
+  PARTHENON_MPI_CHECK(MPI_Iallreduce(&lb_rank_cost_[1], &lb_reduced_cost_[1], 1,
+                                     MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD,
+                                     &lb_cost_requests_[1]));
+#endif
+}
+
 //----------------------------------------------------------------------------------------
 // \!fn void Mesh::UpdateMeshBlockTree(int &nnew, int &ndel)
 // \brief collect refinement flags and manipulate the MeshBlockTree
 
 void Mesh::UpdateMeshBlockTree(int &nnew, int &ndel) {
-  PARTHENON_INSTRUMENT
+  PARTHENON_INSTRUMENT_REGION("Mesh::UpdateMeshBlockTree")
   // compute nleaf= number of leaf MeshBlocks per refined block
   int nleaf = 2;
   if (!mesh_size.symmetry(X2DIR)) nleaf = 4;
   if (!mesh_size.symmetry(X3DIR)) nleaf = 8;
 
-  // collect refinement flags from all the meshblocks
-  // count the number of the blocks to be (de)refined
-  nref[Globals::my_rank] = 0;
-  nderef[Globals::my_rank] = 0;
+  // Gid of the first block of the group of leaf siblings that gid belongs to, or -1 if
+  // not all of its siblings are leaves, i.e., the block cannot be derefined. Siblings
+  // are consecutive in the (Morton ordered) loclist.
+  auto first_sibling = [&](const int gid) {
+    const auto &loc = loclist[gid];
+    if (loc.level() <= 0) return -1;
+    const int first = gid - static_cast<int>((loc.lx1() & 1LL) + 2 * (loc.lx2() & 1LL) +
+                                             4 * (loc.lx3() & 1LL));
+    if (first < 0 || first + nleaf > nbtotal) return -1;
+    const auto parent = loc.GetParent();
+    for (int n = first; n < first + nleaf; ++n) {
+      if (loclist[n].level() != loc.level() || !(loclist[n].GetParent() == parent))
+        return -1;
+    }
+    return first;
+  };
+
+  // Every rank holds the full loclist, so only the gids of the flagged blocks have to be
+  // exchanged instead of their LogicalLocations. Sibling groups that are entirely on
+  // this rank are resolved here and sent as the single entry -1 - (gid of the first
+  // sibling), blocks of groups spread over several ranks are sent one by one and the
+  // groups are resolved after the exchange. Derefinement flags of blocks that cannot be
+  // derefined are dropped.
+  std::vector<int> flagged, deref;
   for (auto const &pmb : block_list) {
-    if (pmb->pmr->refine_flag_ == 1) nref[Globals::my_rank]++;
-    if (pmb->pmr->refine_flag_ == -1) nderef[Globals::my_rank]++;
+    if (pmb->pmr->refine_flag_ == 1) flagged.push_back(pmb->gid);
+    if (pmb->pmr->refine_flag_ != -1) continue;
+    const int first = first_sibling(pmb->gid);
+    if (first < 0) continue;
+    bool local = true, all_flagged = true;
+    for (int n = first; n < first + nleaf; ++n) {
+      if (ranklist[n] != Globals::my_rank) {
+        local = false;
+      } else if (FindMeshBlock(n)->pmr->refine_flag_ != -1) {
+        all_flagged = false;
+      }
+    }
+    if (!local) {
+      deref.push_back(pmb->gid);
+    } else if (all_flagged && pmb->gid == first) {
+      deref.push_back(-1 - first);
+    }
   }
+  const int nlocal_ref = flagged.size();
+  flagged.insert(flagged.end(), deref.begin(), deref.end());
+
+  // count the number of entries of every rank
+  std::vector<int> nflagged(2 * Globals::nranks);
+  nflagged[2 * Globals::my_rank] = nlocal_ref;
+  nflagged[2 * Globals::my_rank + 1] = deref.size();
 #ifdef MPI_PARALLEL
-  PARTHENON_MPI_CHECK(
-      MPI_Allgather(MPI_IN_PLACE, 1, MPI_INT, nref.data(), 1, MPI_INT, MPI_COMM_WORLD));
-  PARTHENON_MPI_CHECK(
-      MPI_Allgather(MPI_IN_PLACE, 1, MPI_INT, nderef.data(), 1, MPI_INT, MPI_COMM_WORLD));
+  PARTHENON_MPI_CHECK(MPI_Allgather(MPI_IN_PLACE, 2, MPI_INT, nflagged.data(), 2,
+                                    MPI_INT, MPI_COMM_WORLD));
 #endif
-
-  // count the number of the blocks to be (de)refined and displacement
-  int tnref = 0, tnderef = 0;
+  std::vector<int> counts(Globals::nranks), displs(Globals::nranks);
+  int ntotal = 0;
   for (int n = 0; n < Globals::nranks; n++) {
-    tnref += nref[n];
-    tnderef += nderef[n];
-  }
-  if (tnref == 0 && tnderef < nleaf) { // nothing to do
-    return;
+    counts[n] = nflagged[2 * n] + nflagged[2 * n + 1];
+    displs[n] = ntotal;
+    ntotal += counts[n];
   }
+  if (ntotal == 0) return; // nothing to do
 
-  int rd = 0, dd = 0;
-  for (int n = 0; n < Globals::nranks; n++) {
-    rdisp[n] = rd;
-    ddisp[n] = dd;
-    // technically could overflow, since sizeof() operator returns
-    // std::size_t = long unsigned int > int
-    // on many platforms (LP64). However, these are used below in MPI calls for
-    // integer arguments (recvcounts, displs). MPI does not support > 64-bit count ranges
-    bnref[n] = static_cast<int>(nref[n] * sizeof(LogicalLocation));
-    bnderef[n] = static_cast<int>(nderef[n] * sizeof(LogicalLocation));
-    brdisp[n] = static_cast<int>(rd * sizeof(LogicalLocation));
-    bddisp[n] = static_cast<int>(dd * sizeof(LogicalLocation));
-    rd += nref[n];
-    dd += nderef[n];
-  }
-
-  // allocate memory for the location arrays
-  LogicalLocation *lref{}, *lderef{}, *clderef{};
-  if (tnref > 0) lref = new LogicalLocation[tnref];
-  if (tnderef >= nleaf) {
-    lderef = new LogicalLocation[tnderef];
-    clderef = new LogicalLocation[tnderef / nleaf];
-  }
-
-  // collect the locations and costs
-  int iref = rdisp[Globals::my_rank], ideref = ddisp[Globals::my_rank];
-  for (auto const &pmb : block_list) {
-    if (pmb->pmr->refine_flag_ == 1) lref[iref++] = pmb->loc;
-    if (pmb->pmr->refine_flag_ == -1 && tnderef >= nleaf) lderef[ideref++] = pmb->loc;
-  }
+  std::vector<int> all_flagged(ntotal);
 #ifdef MPI_PARALLEL
-  if (tnref > 0) {
-    PARTHENON_MPI_CHECK(MPI_Allgatherv(MPI_IN_PLACE, bnref[Globals::my_rank], MPI_BYTE,
-                                       lref, bnref.data(), brdisp.data(), MPI_BYTE,
-                                       MPI_COMM_WORLD));
-  }
-  if (tnderef >= nleaf) {
-    PARTHENON_MPI_CHECK(MPI_Allgatherv(MPI_IN_PLACE, bnderef[Globals::my_rank], MPI_BYTE,
-                                       lderef, bnderef.data(), bddisp.data(), MPI_BYTE,
-                                       MPI_COMM_WORLD));
-  }
+  PARTHENON_MPI_CHECK(MPI_Allgatherv(flagged.data(), flagged.size(), MPI_INT,
+                                     all_flagged.data(), counts.data(), displs.data(),
+                                     MPI_INT, MPI_COMM_WORLD));
+#else
+  all_flagged = flagged;
 #endif
 
-  // calculate the list of the newly derefined blocks
-  int ctnd = 0;
-  if (tnderef >= nleaf) {
-    int lk = 0, lj = 0;
-    if (!mesh_size.symmetry(X2DIR)) lj = 1;
-    if (!mesh_size.symmetry(X3DIR)) lk = 1;
-    for (int n = 0; n < tnderef; n++) {
-      if ((lderef[n].lx1() & 1LL) == 0LL && (lderef[n].lx2() & 1LL) == 0LL &&
-          (lderef[n].lx3() & 1LL) == 0LL) {
-        int r = n, rr = 0;
-        for (std::int64_t k = 0; k <= lk; k++) {
-          for (std::int64_t j = 0; j <= lj; j++) {
-            for (std::int64_t i = 0; i <= 1; i++) {
-              if (r < tnderef) {
-                if ((lderef[n].lx1() + i) == lderef[r].lx1() &&
-                    (lderef[n].lx2() + j) == lderef[r].lx2() &&
-                    (lderef[n].lx3() + k) == lderef[r].lx3() &&
-                    lderef[n].level() == lderef[r].level())
-                  rr++;
-                r++;
-              }
-            }
-          }
-        }
-        if (rr == nleaf) {
-          clderef[ctnd] = lderef[n].GetParent();
-          ctnd++;
-        }
+  // calculate the lists of the blocks to be refined and of the newly derefined blocks
+  std::vector<LogicalLocation> lref, clderef;
+  std::vector<int> lderef; // individually sent, in increasing gid order
+  for (int n = 0; n < Globals::nranks; n++) {
+    const int nr = nflagged[2 * n];
+    for (int i = displs[n]; i < displs[n] + counts[n]; ++i) {
+      const int entry = all_flagged[i];
+      if (i < displs[n] + nr) {
+        lref.push_back(loclist[entry]);
+      } else if (entry < 0) {
+        clderef.push_back(loclist[-1 - entry].GetParent());
+      } else {
+        lderef.push_back(entry);
       }
     }
   }
-  // sort the lists by level
-  if (ctnd > 1) {
-    std::sort(clderef, &(clderef[ctnd - 1]),
-              [](const LogicalLocation &left, const LogicalLocation &right) {
-                return left.level() > right.level();
-              });
+  for (int i = 0; i + nleaf <= lderef.size(); ++i) {
+    // The entries are unique and sorted, so the group is complete if its last block is
+    // nleaf - 1 entries further
+    if (first_sibling(lderef[i]) == lderef[i] &&
+        lderef[i + nleaf - 1] == lderef[i] + nleaf - 1) {
+      clderef.push_back(loclist[lderef[i]].GetParent());
+      i += nleaf - 1;
+    }
   }
-  if (tnderef >= nleaf) delete[] lderef;
+  if (refinement_buffer_ > 0 && !lref.empty()) ApplyRefinementBuffer_(lref, clderef);
+
+  // sort the list by level
+  std::sort(clderef.begin(), clderef.end(),
+            [](const LogicalLocation &left, const LogicalLocation &right) {
+              return left.level() > right.level();
+            });
 
   // Now the lists of the blocks to be refined and derefined are completed
   // Start tree manipulation
   // Step 1. perform refinement
-  for (int n = 0; n < tnref; n++) {
-    nnew += forest.Refine(lref[n]);
+  for (const auto &loc : lref) {
+    nnew += forest.Refine(loc);
   }
-  if (tnref != 0) delete[] lref;
 
   // Step 2. perform derefinement
-  for (int n = 0; n < ctnd; n++) {
-    ndel += forest.Derefine(clderef[n]);
+  for (const auto &loc : clderef) {
+    ndel += forest.Derefine(loc);
+  }
+}
+
+//----------------------------------------------------------------------------------------
+// \!fn void Mesh::ApplyRefinementBuffer_(std::vector<LogicalLocation> &lref,
+//                                      std::vector<LogicalLocation> &clderef)
+// \brief Grow the refined region by refinement_buffer_ layers of neighbors
+//
+// Features moving out of a block would otherwise trigger a remesh every few cycles.
+// Neighbors on the same or a coarser level than the block they are found from are
+// refined as well, and no block within the buffer is derefined. Blocks in the buffer on
+// this rank also restart their derefinement count, so that a region is only derefined
+// once the feature left it for derefine_count cycles. All ranks hold the same lists and
+// forest, so they all arrive at the same result.
+
+void Mesh::ApplyRefinementBuffer_(std::vector<LogicalLocation> &lref,
+                                  std::vector<LogicalLocation> &clderef) {
+  std::unordered_set<LogicalLocation> refined(lref.begin(), lref.end());
+  std::unordered_set<LogicalLocation> buffer(lref.begin(), lref.end());
+  std::vector<LogicalLocation> front = lref;
+  for (int layer = 0; layer < refinement_buffer_ && !front.empty(); ++layer) {
+    std::vector<LogicalLocation> next;
+    for (const auto &loc : front) {
+      for (const auto &nloc : forest.FindNeighbors(loc)) {
+        const auto &nb = nloc.global_loc;
+        if (!buffer.insert(nb).second) continue;
+        if (nb.level() <= loc.level()) refined.insert(nb);
+        next.push_back(nb);
+      }
+    }
+    front = std::move(next);
   }
 
-  if (tnderef >= nleaf) delete[] clderef;
+  // The order of refinement has to agree between ranks
+  lref.assign(refined.begin(), refined.end());
+  std::sort(lref.begin(), lref.end());
+
+  clderef.erase(std::remove_if(clderef.begin(), clderef.end(),
+                               [&](const LogicalLocation &parent) {
+                                 for (const auto &d : parent.GetDaughters(ndim))
+                                   if (buffer.count(d)) return true;
+                                 return false;
+                               }),
+                clderef.end());
+
+  for (auto const &pmb : block_list) {
+    if (buffer.count(pmb->loc)) pmb->pmr->deref_count_ = 0;
+  }
 }
 
 //----------------------------------------------------------------------------------------
@@ -629,7 +1088,7 @@ void Mesh::UpdateMeshBlockTree(int &nnew, int &ndel) {
 // \brief collect the cost from MeshBlocks and check the load balance
 
 bool Mesh::GatherCostListAndCheckBalance() {
-  if (lb_manual_ || lb_automatic_) {
+  if (lb_manual_ || lb_automatic_ || lb_particle_cost_) {
 #ifdef MPI_PARALLEL
     PARTHENON_MPI_CHECK(MPI_Allgatherv(MPI_IN_PLACE, nblist[Globals::my_rank], MPI_DOUBLE,
                                        costlist.data(), nblist.data(), nslist.data(),
@@ -707,6 +1166,11 @@ void Mesh::RedistributeAndRefineMeshBlocks(ParameterInput *pin, ApplicationInput
     for (; mb_idx < nbtold; mb_idx++)
       oldtonew[mb_idx] = ntot - 1;
 
+    remesh_gid_map_.assign(nbtold, -1);
+    for (int n = 0; n < ntot; n++) {
+      if (newloc[n] == loclist[newtoold[n]]) remesh_gid_map_[newtoold[n]] = n;
+    }
+
     current_level = 0;
     for (int n = 0; n < ntot; n++) {
       // "on" = "old n" = "old gid" = "old global MeshBlock ID"
@@ -728,8 +1192,12 @@ void Mesh::RedistributeAndRefineMeshBlocks(ParameterInput *pin, ApplicationInput
     }
   } // Construct new list region
 
-  // Calculate new load balance
-  CalculateLoadBalance(newcost, newrank, nslist, nblist);
+  // Calculate new load balance, starting from the current owners of the blocks (or
+  // their parents/children) for incremental rebalancing
+  std::vector<int> prevrank(ntot);
+  for (int n = 0; n < ntot; n++)
+    prevrank[n] = ranklist[newtoold[n]];
+  CalculateLoadBalance(newcost, newloc, newrank, nslist, nblist, prevrank);
 
   int nbs = nslist[Globals::my_rank];
   int nbe = nbs + nblist[Globals::my_rank] - 1;
@@ -748,6 +1216,7 @@ void Mesh::RedistributeAndRefineMeshBlocks(ParameterInput *pin, ApplicationInput
     int nn = oldtonew[on];
     if (newloc[nn].level() < loclist[on].level()) {
       auto pmb = FindMeshBlock(on);
+      pmb->SetCoarseBuffersAllocated(true);
       for (auto &var : pmb->vars_cc_) {
         restriction_cache.RegisterRegionHost(
             irestrict++, ProResInfo::GetInteriorRestrict(pmb.get(), NeighborBlock(), var),
@@ -764,34 +1233,53 @@ void Mesh::RedistributeAndRefineMeshBlocks(ParameterInput *pin, ApplicationInput
 #ifdef MPI_PARALLEL
   // Send data from old to new blocks
   std::vector<MPI_Request> send_reqs;
+  std::vector<BufArray1D<Real>> send_bufs;
+  std::uint64_t bytes_sent = 0;
   { // AMR Send region
-    PARTHENON_INSTRUMENT
-    for (int n = onbs; n <= onbe; n++) {
-      int nn = oldtonew[n];
-      LogicalLocation &oloc = loclist[n];
-      LogicalLocation &nloc = newloc[nn];
-      auto pb = FindMeshBlock(n);
-      if (nloc.level() == oloc.level() &&
-          newrank[nn] != Globals::my_rank) { // same level, different rank
-        for (auto &var : pb->vars_cc_)
-          send_reqs.emplace_back(SendSameToSame(nn - nslist[newrank[nn]], newrank[nn],
-                                                var.get(), pb.get(), this));
-      } else if (nloc.level() > oloc.level()) { // c2f
-        // c2f must communicate to multiple leaf blocks (unlike f2c, same2same)
-        for (int l = 0; l < nleaf; l++) {
-          const int nl = nn + l; // Leaf block index in new global block list
-          LogicalLocation &nloc = newloc[nl];
-          for (auto &var : pb->vars_cc_)
-            send_reqs.emplace_back(SendCoarseToFine(nl - nslist[newrank[nl]], newrank[nl],
-                                                    nloc, var.get(), this));
-        } // end loop over nleaf (unique to c2f branch in this step 6)
-      } else if (nloc.level() < oloc.level()) { // f2c: restrict + pack + send
-        for (auto &var : pb->vars_cc_)
-          send_reqs.emplace_back(SendFineToCoarse(nn - nslist[newrank[nn]], newrank[nn],
-                                                  oloc, var.get(), this));
+    PARTHENON_INSTRUMENT_REGION("Mesh::Migration")
+    if (lb_aggregate_migration_) {
+      SendAggregatedMigration(newloc, newrank, oldtonew, onbs, onbe, nleaf, send_bufs,
+                              send_reqs, bytes_sent);
+    } else {
+      for (int n = onbs; n <= onbe; n++) {
+        int nn = oldtonew[n];
+        LogicalLocation &oloc = loclist[n];
+        LogicalLocation &nloc = newloc[nn];
+        auto pb = FindMeshBlock(n);
+        if (nloc.level() == oloc.level() &&
+            newrank[nn] != Globals::my_rank) { // same level, different rank
+          for (auto &var : pb->vars_cc_) {
+            send_reqs.emplace_back(SendSameToSame(nn - nslist[newrank[nn]], newrank[nn],
+                                                  var.get(), pb.get(), this));
+            if (var->IsAllocated()) bytes_sent += var->data.size() * sizeof(Real);
+          }
+        } else if (nloc.level() > oloc.level()) { // c2f
+          // c2f must communicate to multiple leaf blocks (unlike f2c, same2same)
+          for (int l = 0; l < nleaf; l++) {
+            const int nl = nn + l; // Leaf block index in new global block list
+            if (newrank[nl] == Globals::my_rank) continue; // see FillSameRankAMR
+            LogicalLocation &nloc = newloc[nl];
+            for (auto &var : pb->vars_cc_) {
+              send_reqs.emplace_back(SendCoarseToFine(
+                  nl - nslist[newrank[nl]], newrank[nl], nloc, var.get(), this));
+              if (var->IsAllocated()) bytes_sent += var->data.size() * sizeof(Real);
+            }
+          } // end loop over nleaf (unique to c2f branch in this step 6)
+        } else if (nloc.level() < oloc.level() &&
+                   newrank[nn] != Globals::my_rank) { // f2c: restrict + pack + send
+          for (auto &var : pb->vars_cc_) {
+            send_reqs.emplace_back(SendFineToCoarse(nn - nslist[newrank[nn]], newrank[nn],
+                                                    oloc, var.get(), this));
+            if (var->IsAllocated()) bytes_sent += var->coarse_s.size() * sizeof(Real);
+          }
+        }
       }
     }
-  }    // AMR Send region
+  } // AMR Send region
+  // Keep track of the migration volume across all ranks
+  PARTHENON_MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, &bytes_sent, 1, MPI_UINT64_T, MPI_SUM,
+                                    MPI_COMM_WORLD));
+  lb_migrated_bytes_ += bytes_sent;
 #endif // MPI_PARALLEL
 
   // Construct a new MeshBlock list (moving the data within the MPI rank)
@@ -810,8 +1298,7 @@ void Mesh::RedistributeAndRefineMeshBlocks(ParameterInput *pin, ApplicationInput
           BoundaryFlag block_bcs[6];
           SetBlockSizeAndBoundaries(newloc[n], block_size, block_bcs);
           new_block_list[n - nbs] =
-              MeshBlock::Make(n, n - nbs, newloc[n], block_size, block_bcs, this, pin,
-                              app_in, packages, resolved_packages, gflag);
+              MakeMeshBlock_(n, n - nbs, newloc[n], block_size, block_bcs, pin, app_in);
         }
       } else {
         // on a different refinement level or MPI rank - create a new block
@@ -819,8 +1306,7 @@ void Mesh::RedistributeAndRefineMeshBlocks(ParameterInput *pin, ApplicationInput
         SetBlockSizeAndBoundaries(newloc[n], block_size, block_bcs);
         // append new block to list of MeshBlocks
         new_block_list[n - nbs] =
-            MeshBlock::Make(n, n - nbs, newloc[n], block_size, block_bcs, this, pin,
-                            app_in, packages, resolved_packages, gflag);
+            MakeMeshBlock_(n, n - nbs, newloc[n], block_size, block_bcs, pin, app_in);
       }
     }
   } // AMR Construct new MeshBlockList region
@@ -835,19 +1321,39 @@ void Mesh::RedistributeAndRefineMeshBlocks(ParameterInput *pin, ApplicationInput
     block_list[n - nbs]->lid = n - nbs;
   }
   BuildBlockPartitions(GridIdentifier::leaf());
+  // invalidates everything that was captured for the old block list
+  block_list_generation_++;
 
   // Receive the data and load into MeshBlocks
   { // AMR Recv and unpack data
     PARTHENON_INSTRUMENT
-    bool all_received;
-    int niter = 0;
-    if (block_list.size() > 0) {
+    // Closed after the last message arrived, together with the send region above
+    auto migration_timer = std::make_unique<KokkosTimer>("Mesh::Migration");
+    // Data that stays on this rank is copied directly while the messages are in flight
+    if (block_list.size() > 0)
+      FillSameRankAMR(old_block_list, newloc, newtoold, onbs, nbs, nbe, nleaf);
+    if (UserWorkDuringMigration != nullptr) {
+      // The blocks that were just moved into the new list already hold valid data
+      BlockList_t unchanged;
+      for (int n = nbs; n <= nbe; n++) {
+        const int on = newtoold[n];
+        if (ranklist[on] == Globals::my_rank && loclist[on].level() == newloc[n].level())
+          unchanged.push_back(block_list[n - nbs]);
+      }
+      UserWorkDuringMigration(this, pin, unchanged);
+    }
+#ifdef MPI_PARALLEL
+    if (lb_aggregate_migration_ && block_list.size() > 0)
+      RecvAggregatedMigration(newloc, newtoold, nbs, nbe, nleaf);
+    if (block_list.size() > 0 && !lb_aggregate_migration_) {
       // Create a vector for holding the status of all communications, it is sized to fit
       // the maximal number of calculations that this rank could receive: the number of
       // blocks on the rank x the number of variables x times the number of fine blocks
       // that would communicate if every block had been coarsened (8 in 3D)
       std::vector<bool> finished(
           std::max((nbe - nbs + 1), 1) * FindMeshBlock(nbs)->vars_cc_.size() * 8, false);
+      bool all_received;
+      int niter = 0;
       do {
         all_received = true;
         niter++;
@@ -859,39 +1365,29 @@ void Mesh::RedistributeAndRefineMeshBlocks(ParameterInput *pin, ApplicationInput
           auto pb = FindMeshBlock(n);
           if (oloc.level() == nloc.level() &&
               ranklist[on] != Globals::my_rank) { // same level, different rank
-#ifdef MPI_PARALLEL
             for (auto &var : pb->vars_cc_) {
               if (!finished[idx])
                 finished[idx] =
                     TryRecvSameToSame(n - nbs, ranklist[on], var.get(), pb.get(), this);
               all_received = finished[idx++] && all_received;
             }
-#endif
           } else if (oloc.level() > nloc.level()) { // f2c
             for (int l = 0; l < nleaf; l++) {
-              auto pob = pb;
-              if (ranklist[on + l] == Globals::my_rank)
-                pob = old_block_list[on + l - onbs];
+              if (ranklist[on + l] == Globals::my_rank) continue;
               LogicalLocation &oloc = loclist[on + l];
               for (auto &var : pb->vars_cc_) {
-                if (!finished[idx]) {
-                  auto var_in = pob->meshblock_data.Get()->GetVarPtr(var->label());
-                  finished[idx] =
-                      TryRecvFineToCoarse(n - nbs, ranklist[on + l], oloc, var_in.get(),
-                                          var.get(), pb.get(), this);
-                }
+                if (!finished[idx])
+                  finished[idx] = TryRecvFineToCoarse(n - nbs, ranklist[on + l], oloc,
+                                                      var.get(), pb.get(), this);
                 all_received = finished[idx++] && all_received;
               }
             }
-          } else if (oloc.level() < nloc.level()) { // c2f
+          } else if (oloc.level() < nloc.level() &&
+                     ranklist[on] != Globals::my_rank) { // c2f
             for (auto &var : pb->vars_cc_) {
-              if (!finished[idx]) {
-                auto pob = pb;
-                if (ranklist[on] == Globals::my_rank) pob = old_block_list[on - onbs];
-                auto var_in = pob->meshblock_data.Get()->GetVarPtr(var->label());
-                finished[idx] = TryRecvCoarseToFine(
-                    n - nbs, ranklist[on], nloc, var_in.get(), var.get(), pb.get(), this);
-              }
+              if (!finished[idx])
+                finished[idx] = TryRecvCoarseToFine(n - nbs, ranklist[on], nloc,
+                                                    var.get(), pb.get(), this);
               all_received = finished[idx++] && all_received;
             }
           }
@@ -900,9 +1396,11 @@ void Mesh::RedistributeAndRefineMeshBlocks(ParameterInput *pin, ApplicationInput
       } while (!all_received && niter < 1e7);
       if (!all_received) PARTHENON_FAIL("AMR Receive failed");
     }
+#endif // MPI_PARALLEL
     // Fence here to be careful that all communication is finished before moving
     // on to prolongation
     Kokkos::fence();
+    migration_timer.reset();
 
     // Prolongate blocks that had a coarse buffer filled (i.e. c2f blocks)
     ProResCache_t prolongation_cache;
@@ -942,7 +1440,13 @@ void Mesh::RedistributeAndRefineMeshBlocks(ParameterInput *pin, ApplicationInput
     if (send_reqs.size() != 0)
       PARTHENON_MPI_CHECK(
           MPI_Waitall(send_reqs.size(), send_reqs.data(), MPI_STATUSES_IGNORE));
+    for (auto &host : migration_staging_)
+      host_staging.Release(host);
+    migration_staging_.clear();
+    migration_staged_sizes_.clear();
 #endif
+    // No more data is sent from or copied out of the old blocks
+    RetireMeshBlocks_(old_block_list);
     // init meshblock data
     for (auto &pmb : block_list) {
       if (pmb->InitMeshBlockUserData != nullptr) {
@@ -987,20 +1491,27 @@ void Mesh::RedistributeAndRefineMeshBlocks(ParameterInput *pin, ApplicationInput
     // like any other blocks at their level.
     SetMeshBlockNeighbors(GridIdentifier::leaf(), block_list, ranklist);
     SetGMGNeighbors();
+    // All new blocks were created with coarse buffers for the restriction/prolongation
+    // above, which can now be dropped again where the neighborhood is uniform
+    UpdateCoarseBuffers();
     // Ownership does not impact anything about the buffers, so we don't need to
     // rebuild them if they were built above
     if (noncc_names.size() == 0) BuildTagMapAndBoundaryBuffers();
 
-    // Call to fill ghosts with real data and fill derived quantities
-    PreCommFillDerived();
-    CommunicateBoundaries();
-    FillDerived();
+    // Call to fill ghosts with real data and fill derived quantities, unless the
+    // caller does that itself after regenerating the data
+    if (!defer_remesh_fill_) {
+      PreCommFillDerived();
+      CommunicateBoundaries();
+      FillDerived();
+    }
 
     // Initialize the "base" MeshData object
     // TODO(LFR): Is this necessary? Do we ever pull out the entire mesh MeshData?
     mesh_data.Get()->Initialize(block_list, this);
   } // AMR Recv and unpack data
 
+  block_locator_valid_ = false;
   ResetLoadBalanceVariables();
 }
 } // namespace parthenon
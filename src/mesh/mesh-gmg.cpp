@@ -20,6 +20,8 @@
 #include <algorithm>
 #include <cstdint>
 #include <iostream>
+#include <map>
+#include <memory>
 #include <numeric>
 #include <sstream>
 #include <string>
@@ -40,21 +42,28 @@
 #include "utils/bit_hacks.hpp"
 #include "utils/buffer_utils.hpp"
 #include "utils/error_checking.hpp"
+#include "utils/instrument.hpp"
 
 namespace parthenon {
 
 void Mesh::SetMeshBlockNeighbors(
     GridIdentifier grid_id, BlockList_t &block_list, const std::vector<int> &ranklist,
     const std::unordered_set<LogicalLocation> &newly_refined) {
+  PARTHENON_INSTRUMENT_REGION("Mesh::SetMeshBlockNeighbors")
   Indexer3D offsets({ndim > 0 ? -1 : 0, ndim > 0 ? 1 : 0},
                     {ndim > 1 ? -1 : 0, ndim > 1 ? 1 : 0},
                     {ndim > 2 ? -1 : 0, ndim > 2 ? 1 : 0});
   BufferID buffer_id(ndim, multilevel);
 
-  for (auto &pmb : block_list) {
+  // The lookups in the forest below happen concurrently, so its index has to be current
+  forest.BuildLookupIndices();
+
+  auto set_neighbors = [&](const std::shared_ptr<MeshBlock> &pmb) {
     std::vector<NeighborBlock> all_neighbors;
     const auto &loc = pmb->loc;
     auto neighbors = forest.FindNeighbors(loc, grid_id);
+    auto origin_ownership = DetermineOwnership(loc, neighbors, newly_refined);
+    origin_ownership.initialized = true;
 
     // Build NeighborBlocks for unique neighbors
     for (const auto &nloc : neighbors) {
@@ -71,8 +80,10 @@ void Mesh::SetMeshBlockNeighbors(
                                                        -offsets[2]);
       int tid = buffer_id.GetID(-offsets[0], -offsets[1], -offsets[2], fn[0], fn[1]);
       int lgid = forest.GetLeafGid(nloc.global_loc);
-      all_neighbors.emplace_back(pmb->pmy_mesh, nloc.global_loc, nloc.origin_loc,
-                                 ranklist[lgid], gid, offsets, bid, tid, f[0], f[1]);
+      const int nrank = grid_id.type == GridType::leaf ? ranklist[lgid]
+                                                       : GetGMGRank(nloc.global_loc);
+      all_neighbors.emplace_back(pmb->pmy_mesh, nloc.global_loc, nloc.origin_loc, nrank,
+                                 gid, offsets, bid, tid, f[0], f[1]);
 
       // Set neighbor block ownership
       auto &nb = all_neighbors.back();
@@ -81,6 +92,7 @@ void Mesh::SetMeshBlockNeighbors(
       nb.ownership =
           DetermineOwnership(nloc.global_loc, neighbor_neighbors, newly_refined);
       nb.ownership.initialized = true;
+      nb.origin_ownership = origin_ownership;
 
       // Set logical coordinate transformation from this block to the neighbor
       nb.lcoord_trans = nloc.lcoord_trans;
@@ -95,11 +107,40 @@ void Mesh::SetMeshBlockNeighbors(
                pmb->loc.level() == grid_id.logical_level - 1) {
       pmb->gmg_composite_finer_neighbors = all_neighbors;
     }
-  }
+  };
+
+  // The neighbor lists of different blocks are independent, so they are built in
+  // parallel on the host, with every block only writing to its own lists
+  Kokkos::parallel_for("SetMeshBlockNeighbors",
+                       Kokkos::RangePolicy<HostExecSpace>(0, block_list.size()),
+                       [&](const int b) { set_neighbors(block_list[b]); });
+  HostExecSpace().fence();
 }
 
 void Mesh::BuildGMGBlockLists(ParameterInput *pin, ApplicationInput *app_in) {
   if (!multigrid) return;
+  gmg_pin_ = pin;
+  gmg_app_in_ = app_in;
+
+  // Drop the hierarchy of the previous mesh, including levels that don't exist anymore
+  for (auto &[level, bl] : gmg_block_lists)
+    block_partitions_.erase(GridIdentifier::two_level_composite(level));
+  gmg_block_lists.clear();
+  gmg_hierarchy_valid_ = false;
+  if (!gmg_lazy_build_) MakeGMGBlockLists_();
+}
+
+void Mesh::BuildGMGHierarchy() {
+  if (!multigrid || gmg_hierarchy_valid_) return;
+  MakeGMGBlockLists_();
+  SetGMGNeighbors();
+  // The tags of the leaf buffers are assigned together with the GMG ones
+  BuildTagMapAndBoundaryBuffers();
+}
+
+void Mesh::MakeGMGBlockLists_() {
+  ParameterInput *pin = gmg_pin_;
+  ApplicationInput *app_in = gmg_app_in_;
 
   // See how many times we can go below logical level zero based on the
   // number of times a blocks zones can be reduced by 2^D
@@ -112,13 +153,54 @@ void Mesh::BuildGMGBlockLists(ParameterInput *pin, ApplicationInput *app_in) {
     }
   }
 
-  const int gmg_min_level = -gmg_level_offset;
+  int gmg_min_level = -gmg_level_offset;
+  // Levels below the requested depth are not built, but every leaf block has to be on a
+  // level of the hierarchy
+  if (gmg_max_coarsenings_ >= 0) {
+    int min_leaf_level = current_level;
+    for (const auto &loc : loclist)
+      min_leaf_level = std::min(min_leaf_level, loc.level());
+    gmg_min_level = std::max(
+        gmg_min_level, std::min(current_level - gmg_max_coarsenings_, min_leaf_level));
+  }
   gmg_min_logical_level_ = gmg_min_level;
   for (int level = gmg_min_level; level <= current_level; ++level) {
     gmg_block_lists[level] = BlockList_t();
   }
 
-  // Fill/create gmg block lists based on this ranks block list
+  // Internal blocks live on the rank of the leaf block that shares their Morton number,
+  // so the coarsest levels end up with a single small block on a few ranks each and
+  // V-cycles are bound by the latency of the communication between them. Below
+  // gmg_agglomeration_blocks_per_rank blocks per rank, internal blocks are instead
+  // gathered onto every stride-th rank. Strides are powers of two, so that the ranks
+  // that own a level also own the coarser levels.
+  gmg_agglomeration_blocks_per_rank_ = pin->GetOrAddInteger(
+      "parthenon/mesh", "gmg_agglomeration_blocks_per_rank", 0);
+  gmg_agglomeration_stride_.clear();
+  if (gmg_agglomeration_blocks_per_rank_ > 0) {
+    std::map<int, std::int64_t> nblocks_level;
+    for (const auto &leaf_loc : loclist) {
+      nblocks_level[leaf_loc.level()]++;
+      auto loc = leaf_loc.GetParent();
+      while (loc.level() >= gmg_min_level && loc.morton() == leaf_loc.morton()) {
+        nblocks_level[loc.level()]++;
+        loc = loc.GetParent();
+      }
+    }
+    for (const auto &[level, nblocks] : nblocks_level) {
+      if (nblocks >= static_cast<std::int64_t>(gmg_agglomeration_blocks_per_rank_) *
+                         Globals::nranks)
+        continue;
+      const std::int64_t nactive =
+          std::max<std::int64_t>(1, nblocks / gmg_agglomeration_blocks_per_rank_);
+      int stride = 1;
+      while (stride * nactive < Globals::nranks)
+        stride *= 2;
+      if (stride > 1) gmg_agglomeration_stride_[level] = stride;
+    }
+  }
+
+  // Fill gmg block lists with the leaf blocks of this rank
   for (auto &pmb : block_list) {
     const int level = pmb->loc.level();
     // Add the leaf block to its level
@@ -128,18 +210,25 @@ void Mesh::BuildGMGBlockLists(ParameterInput *pin, ApplicationInput *app_in) {
     if (level < current_level) {
       gmg_block_lists[level + 1].push_back(pmb);
     }
+  }
 
-    // Create internal blocks that share a Morton number with this block
-    // and add them to gmg two-level composite grid block lists. This
-    // determines which process internal blocks live on
-    auto loc = pmb->loc.GetParent();
-    while (loc.level() >= gmg_min_level && loc.morton() == pmb->loc.morton()) {
-      RegionSize block_size = GetDefaultBlockSize();
-      BoundaryFlag block_bcs[6];
-      SetBlockSizeAndBoundaries(loc, block_size, block_bcs);
-      gmg_block_lists[loc.level()].push_back(
-          MeshBlock::Make(forest.GetGid(loc), -1, loc, block_size, block_bcs, this, pin,
-                          app_in, packages, resolved_packages, gflag));
+  // Create internal blocks that share a Morton number with a leaf block and add them to
+  // gmg two-level composite grid block lists. Without agglomeration, they are all created
+  // on the rank of that leaf block.
+  const bool agglomerate = !gmg_agglomeration_stride_.empty();
+  for (int gid = 0; gid < nbtotal; ++gid) {
+    if (!agglomerate && ranklist[gid] != Globals::my_rank) continue;
+    const auto &leaf_loc = loclist[gid];
+    auto loc = leaf_loc.GetParent();
+    while (loc.level() >= gmg_min_level && loc.morton() == leaf_loc.morton()) {
+      if (GetGMGRank(loc) == Globals::my_rank) {
+        RegionSize block_size = GetDefaultBlockSize();
+        BoundaryFlag block_bcs[6];
+        SetBlockSizeAndBoundaries(loc, block_size, block_bcs);
+        gmg_block_lists[loc.level()].push_back(
+            MeshBlock::Make(forest.GetGid(loc), -1, loc, block_size, block_bcs, this, pin,
+                            app_in, packages, resolved_packages, gflag));
+      }
       loc = loc.GetParent();
     }
   }
@@ -149,10 +238,21 @@ void Mesh::BuildGMGBlockLists(ParameterInput *pin, ApplicationInput *app_in) {
     std::sort(bl.begin(), bl.end(), [](auto &a, auto &b) { return a->gid < b->gid; });
     BuildBlockPartitions(GridIdentifier::two_level_composite(level));
   }
+  gmg_hierarchy_valid_ = true;
+}
+
+int Mesh::GetGMGRank(const LogicalLocation &loc) const {
+  const std::int64_t leaf_gid = forest.GetLeafGid(loc);
+  const int rank = ranklist[leaf_gid];
+  // Leaf blocks are never moved
+  if (forest.GetGid(loc) == leaf_gid) return rank;
+  auto it = gmg_agglomeration_stride_.find(loc.level());
+  if (it == gmg_agglomeration_stride_.end()) return rank;
+  return rank - rank % it->second;
 }
 
 void Mesh::SetGMGNeighbors() {
-  if (!multigrid) return;
+  if (!multigrid || !gmg_hierarchy_valid_) return;
   const int gmg_min_level = GetGMGMinLevel();
   // Sort the gmg block lists by gid and find neighbors
   for (auto &[level, bl] : gmg_block_lists) {
@@ -163,9 +263,8 @@ void Mesh::SetGMGNeighbors() {
         auto ploc = pmb->loc.GetParent();
         int gid = forest.GetGid(ploc);
         if (gid >= 0) {
-          int leaf_gid = forest.GetLeafGid(ploc);
           pmb->gmg_coarser_neighbors.emplace_back(
-              pmb->pmy_mesh, ploc, ploc, ranklist[leaf_gid], gid,
+              pmb->pmy_mesh, ploc, ploc, GetGMGRank(ploc), gid,
               std::array<int, 3>{0, 0, 0}, 0, 0, 0, 0);
         }
       }
@@ -178,10 +277,9 @@ void Mesh::SetGMGNeighbors() {
         for (auto &d : dlocs) {
           int gid = forest.GetGid(d);
           if (gid >= 0) {
-            int leaf_gid = forest.GetLeafGid(d);
-            pmb->gmg_finer_neighbors.emplace_back(pmb->pmy_mesh, d, d, ranklist[leaf_gid],
-                                                  gid, std::array<int, 3>{0, 0, 0}, 0, 0,
-                                                  0, 0);
+            pmb->gmg_finer_neighbors.emplace_back(pmb->pmy_mesh, d, d, GetGMGRank(d), gid,
+                                                  std::array<int, 3>{0, 0, 0}, 0, 0, 0,
+                                                  0);
           }
         }
         if (pmb->gmg_finer_neighbors.size() == 0) {
@@ -23,6 +23,7 @@
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <functional>
 #include <iomanip>
 #include <iostream>
 #include <limits>
@@ -51,8 +52,10 @@
 #include "parameter_input.hpp"
 #include "parthenon_arrays.hpp"
 #include "prolong_restrict/prolong_restrict.hpp"
+#include "utils/affinity.hpp"
 #include "utils/buffer_utils.hpp"
 #include "utils/error_checking.hpp"
+#include "utils/instrument.hpp"
 #include "utils/partition_stl_containers.hpp"
 
 namespace parthenon {
@@ -78,10 +81,7 @@ Mesh::Mesh(ParameterInput *pin, ApplicationInput *app_in, Packages_t &packages,
       // private members:
       num_mesh_threads_(pin->GetOrAddInteger("parthenon/mesh", "num_threads", 1)),
       use_uniform_meshgen_fn_{true, true, true, true}, lb_flag_(true), lb_automatic_(),
-      lb_manual_(), nslist(Globals::nranks), nblist(Globals::nranks),
-      nref(Globals::nranks), nderef(Globals::nranks), rdisp(Globals::nranks),
-      ddisp(Globals::nranks), bnref(Globals::nranks), bnderef(Globals::nranks),
-      brdisp(Globals::nranks), bddisp(Globals::nranks) {
+      lb_manual_(), nslist(Globals::nranks), nblist(Globals::nranks) {
   // Allow for user overrides to default Parthenon functions
   if (app_in->InitUserMeshData != nullptr) {
     InitUserMeshData = app_in->InitUserMeshData;
@@ -104,6 +104,9 @@ Mesh::Mesh(ParameterInput *pin, ApplicationInput *app_in, Packages_t &packages,
   if (app_in->UserWorkBeforeRestartOutput != nullptr) {
     UserWorkBeforeRestartOutput = app_in->UserWorkBeforeRestartOutput;
   }
+  if (app_in->InSituOutput != nullptr) {
+    InSituOutput = app_in->InSituOutput;
+  }
   if (app_in->PreStepDiagnosticsInLoop != nullptr) {
     PreStepUserDiagnosticsInLoop = app_in->PreStepDiagnosticsInLoop;
   }
@@ -113,9 +116,16 @@ Mesh::Mesh(ParameterInput *pin, ApplicationInput *app_in, Packages_t &packages,
   if (app_in->UserWorkAfterLoop != nullptr) {
     UserWorkAfterLoop = app_in->UserWorkAfterLoop;
   }
+  if (app_in->UserPartitioner != nullptr) {
+    UserPartitioner = app_in->UserPartitioner;
+  }
+  if (app_in->UserWorkDuringMigration != nullptr) {
+    UserWorkDuringMigration = app_in->UserWorkDuringMigration;
+  }
 
   // Default root level, may be overwritten by another constructor
   root_level = 0;
+  min_level = 0;
   // SMR / AMR:
   if (adaptive) {
     max_level = pin->GetOrAddInteger("parthenon/mesh", "numlevel", 1) + root_level - 1;
@@ -123,6 +133,106 @@ Mesh::Mesh(ParameterInput *pin, ApplicationInput *app_in, Packages_t &packages,
     max_level = 63;
   }
 
+  do_neighbor_collective_comms =
+      pin->GetOrAddBoolean("parthenon/mesh", "neighbor_collective_comms", false);
+  do_coalesced_comms = pin->GetOrAddBoolean("parthenon/mesh", "coalesced_comms",
+                                            do_neighbor_collective_comms);
+  do_coalesced_flux_correction = pin->GetOrAddBoolean(
+      "parthenon/mesh", "coalesced_flux_correction", do_coalesced_comms);
+  do_persistent_comms = pin->GetOrAddBoolean("parthenon/mesh", "persistent_comms", false);
+  do_direct_local_copies =
+      pin->GetOrAddBoolean("parthenon/mesh", "direct_local_copies", false);
+  do_deduplicate_shared_elements =
+      pin->GetOrAddBoolean("parthenon/mesh", "deduplicate_shared_elements", false);
+  do_null_masks = pin->GetOrAddBoolean("parthenon/mesh", "null_masks", false);
+  do_shared_memory_comms =
+      pin->GetOrAddBoolean("parthenon/mesh", "shared_memory_comms", false);
+  do_stream_ordered_comms =
+      pin->GetOrAddBoolean("parthenon/mesh", "stream_ordered_comms", false);
+  do_device_graphs = pin->GetOrAddBoolean("parthenon/mesh", "device_graphs", false);
+  do_incremental_buffer_rebuild =
+      pin->GetOrAddBoolean("parthenon/mesh", "incremental_buffer_rebuild", false);
+  recycle_blocks_ = pin->GetOrAddBoolean("parthenon/mesh", "recycle_blocks", false);
+  host_staging.Initialize(
+      pin->GetOrAddBoolean("parthenon/mesh", "host_staged_comms", false),
+      pin->GetOrAddInteger("parthenon/mesh", "host_staging_chunk_bytes", 1 << 20));
+  do_contiguous_storage =
+      pin->GetOrAddBoolean("parthenon/mesh", "contiguous_storage", false);
+  flux_arenas.Initialize(
+      pin->GetOrAddBoolean("parthenon/mesh", "transient_fluxes", false));
+  refinement_buffer_ = pin->GetOrAddInteger("parthenon/mesh", "refinement_buffer", 0);
+  PARTHENON_REQUIRE_THROWS(refinement_buffer_ >= 0,
+                           "refinement_buffer must not be negative.");
+
+  // Split the device into independent execution space instances that are handed out to
+  // the block partitions in a round robin fashion
+  const int num_exec_spaces =
+      pin->GetOrAddInteger("parthenon/mesh", "num_exec_space_instances", 1);
+  PARTHENON_REQUIRE_THROWS(num_exec_spaces > 0,
+                           "num_exec_space_instances must be positive.");
+  // On the host, the threads can be pinned to cores, and with numa_partitions the host
+  // is instead split into one instance per NUMA domain with the threads of every
+  // instance pinned to the cores of its domain. The contiguous storage of a partition is
+  // then first touched by the threads of its instance.
+  const bool numa_partitions =
+      pin->GetOrAddBoolean("parthenon/affinity", "numa_partitions", false);
+  const bool pin_threads =
+      pin->GetOrAddBoolean("parthenon/affinity", "pin_threads", numa_partitions);
+  const auto numa_domains = affinity::GetNUMADomains();
+  // With devices_per_rank > 1 the partitions are instead spread over several devices,
+  // with the boundary communication between them going through peer access. The
+  // contiguous storage of a partition is allocated on the device of its instance.
+  const int devices_per_rank =
+      pin->GetOrAddInteger("parthenon/mesh", "devices_per_rank", 1);
+  PARTHENON_REQUIRE_THROWS(devices_per_rank > 0, "devices_per_rank must be positive.");
+  if (devices_per_rank > 1) {
+    if (!do_contiguous_storage && Globals::my_rank == 0)
+      PARTHENON_WARN("parthenon/mesh/devices_per_rank only places the data of "
+                     "partitions with parthenon/mesh/contiguous_storage = true, all "
+                     "other data stays on the first device.");
+    exec_spaces_ = affinity::CreateDeviceInstances(devices_per_rank);
+    owns_device_instances_ = true;
+  } else if (numa_partitions && affinity::HostThreadsPinnable() &&
+             numa_domains.size() > 1) {
+    if (!do_contiguous_storage && Globals::my_rank == 0)
+      PARTHENON_WARN("parthenon/affinity/numa_partitions only places the data of "
+                     "partitions with parthenon/mesh/contiguous_storage = true.");
+    std::vector<int> weights;
+    for (const auto &cores : numa_domains)
+      weights.push_back(cores.size());
+    exec_spaces_ = Kokkos::Experimental::partition_space(DevExecSpace(), weights);
+    for (int d = 0; d < exec_spaces_.size(); ++d)
+      affinity::PinExecSpaceThreads(exec_spaces_[d], numa_domains[d]);
+  } else if (num_exec_spaces > 1) {
+    exec_spaces_ = Kokkos::Experimental::partition_space(
+        DevExecSpace(), std::vector<int>(num_exec_spaces, 1));
+  } else {
+    exec_spaces_ = {DevExecSpace()};
+  }
+  if (pin_threads && affinity::HostThreadsPinnable() && exec_spaces_.size() == 1)
+    affinity::PinExecSpaceThreads(exec_spaces_[0], affinity::GetAllowedCores());
+
+  // Limit the memory of destroyed variables kept around for reuse by new blocks, a
+  // negative value means no limit and zero disables the reuse
+  const Real pool_max_mbytes =
+      pin->GetOrAddReal("parthenon/mesh", "variable_pool_max_mbytes", -1.0);
+  Variable<Real>::GetDataPool().SetMaxBytes(
+      pool_max_mbytes < 0 ? std::numeric_limits<std::size_t>::max()
+                          : static_cast<std::size_t>(pool_max_mbytes * 1024 * 1024));
+  // Same for the unused boundary buffers kept around by the buffer pools
+  const Real buffer_pool_max_mbytes =
+      pin->GetOrAddReal("parthenon/mesh", "buffer_pool_max_mbytes", -1.0);
+  if (buffer_pool_max_mbytes >= 0)
+    buffer_pool_max_bytes =
+        static_cast<std::uint64_t>(buffer_pool_max_mbytes * 1024 * 1024);
+  // Geometric multigrid restricts and prolongates the interior of all blocks, so it needs
+  // the coarse buffers everywhere
+  lazy_coarse_buffers = multilevel && !multigrid &&
+                        pin->GetOrAddBoolean("parthenon/mesh", "lazy_coarse_buffers", false);
+  gmg_lazy_build_ = pin->GetOrAddBoolean("parthenon/mesh", "gmg_lazy_build", false);
+  gmg_max_coarsenings_ =
+      pin->GetOrAddInteger("parthenon/mesh", "gmg_max_coarsenings", -1);
+
   SetupMPIComms();
 
   RegisterLoadBalancing_(pin);
@@ -177,8 +287,21 @@ Mesh::Mesh(ParameterInput *pin, ApplicationInput *app_in, Packages_t &packages,
   // SMR / AMR:
   if (adaptive) {
     max_level = pin->GetOrAddInteger("parthenon/mesh", "numlevel", 1) + root_level - 1;
+    // Levels below the root grid, on which a block covers 2^l root blocks per
+    // direction. These exist within the trees, i.e., the root grid has to consist of
+    // multiples of 2^l blocks per direction.
+    const int nbelow = pin->GetOrAddInteger("parthenon/mesh", "numlevel_below_root", 0);
+    PARTHENON_REQUIRE_THROWS(nbelow >= 0 && nbelow <= root_level,
+                             "parthenon/mesh/numlevel_below_root = " +
+                                 std::to_string(nbelow) +
+                                 " requires the number of root blocks in every "
+                                 "direction to be divisible by 2^numlevel_below_root, "
+                                 "at most " +
+                                 std::to_string(root_level) + " is possible here");
+    min_level = root_level - nbelow;
   } else {
     max_level = 63;
+    min_level = root_level;
   }
 
   // Register user defined boundary conditions
@@ -215,6 +338,7 @@ Mesh::Mesh(ParameterInput *pin, ApplicationInput *app_in, Packages_t &packages,
   // Load balancing flag and parameters
   forest = forest::Forest::Make2D(forest_def);
   root_level = forest.root_level;
+  min_level = root_level;
   forest.EnrollBndryFncts(app_in, resolved_packages->UserBoundaryFunctions,
                           resolved_packages->UserSwarmBoundaryFunctions);
   BuildBlockList(pin, app_in, packages, 0);
@@ -296,7 +420,18 @@ Mesh::Mesh(ParameterInput *pin, ApplicationInput *app_in, RestartReader &rr,
     dealloc_count[loclist[i]] = mesh_info.derefinement_count[i];
   }
 
-  // rebuild the Block Tree
+  // rebuild the Block Tree, blocks below the root level replace the root blocks (and
+  // intermediate levels) they cover
+  std::function<void(const LogicalLocation &)> coarsen = [&](const LogicalLocation &loc) {
+    if (loc.level() + 1 < root_level) {
+      for (const auto &d : loc.GetDaughters(ndim))
+        coarsen(d);
+    }
+    forest.Derefine(loc, false);
+  };
+  for (int i = 0; i < nbtotal; i++) {
+    if (loclist[i].level() < root_level) coarsen(loclist[i]);
+  }
   for (int i = 0; i < nbtotal; i++)
     forest.AddMeshBlock(loclist[i], false);
 
@@ -344,7 +479,7 @@ void Mesh::BuildBlockList(ParameterInput *pin, ApplicationInput *app_in,
   // initialize cost array with the simplest estimate; all the blocks are equal
   costlist = std::vector<double>(nbtotal, 1.0);
 
-  CalculateLoadBalance(costlist, ranklist, nslist, nblist);
+  CalculateLoadBalance(costlist, loclist, ranklist, nslist, nblist);
 
   // Output MeshBlock list and quit (mesh test only); do not create meshes
   if (mesh_test > 0) {
@@ -357,6 +492,7 @@ void Mesh::BuildBlockList(ParameterInput *pin, ApplicationInput *app_in,
   int nbs = nslist[Globals::my_rank];
   int nbe = nbs + nblist[Globals::my_rank] - 1;
   // create MeshBlock list for this process
+  Kokkos::Timer timer;
   block_list.clear();
   block_list.resize(nbe - nbs + 1);
   for (int i = nbs; i <= nbe; i++) {
@@ -371,10 +507,15 @@ void Mesh::BuildBlockList(ParameterInput *pin, ApplicationInput *app_in,
       block_list[i - nbs]->pmr->DerefinementCount() =
           dealloc_count.count(loclist[i]) ? dealloc_count.at(loclist[i]) : 0;
   }
+  Kokkos::fence();
+  startup_times_.block_construction += timer.seconds();
+  timer.reset();
   BuildBlockPartitions(GridIdentifier::leaf());
   BuildGMGBlockLists(pin, app_in);
   SetMeshBlockNeighbors(GridIdentifier::leaf(), block_list, ranklist);
   SetGMGNeighbors();
+  startup_times_.neighbors += timer.seconds();
+  block_locator_valid_ = false;
   ResetLoadBalanceVariables();
 }
 
@@ -382,7 +523,20 @@ void Mesh::BuildBlockList(ParameterInput *pin, ApplicationInput *app_in,
 // destructor
 
 Mesh::~Mesh() {
+  if (owns_device_instances_) {
+    // The partitions hold copies of the instances, which have to be released before
+    // the streams of the instances are destroyed
+    mesh_data.PurgeNonBase();
+    mesh_data.Stages().clear();
+    block_partitions_.clear();
+    affinity::DestroyDeviceInstances(exec_spaces_);
+  }
+  coalesced_buffers.Finalize();
+  node_shared_buffers.Finalize();
+  stream_ordered_buffers.Finalize();
+  flux_arenas.Finalize();
 #ifdef MPI_PARALLEL
+  PARTHENON_MPI_CHECK(MPI_Waitall(2, lb_cost_requests_, MPI_STATUSES_IGNORE));
   // Cleanup MPI comms
   for (auto &pair : mpi_comm_map_) {
     PARTHENON_MPI_CHECK(MPI_Comm_free(&(pair.second)));
@@ -403,11 +557,27 @@ void Mesh::BuildBlockPartitions(GridIdentifier grid) {
     partition_blocklists = std::vector<BlockList_t>(1);
   std::vector<std::shared_ptr<BlockListPartition>> out;
   int id = 0;
-  for (auto &part_bl : partition_blocklists)
-    out.emplace_back(std::make_shared<BlockListPartition>(id++, grid, part_bl, this));
+  for (auto &part_bl : partition_blocklists) {
+    out.emplace_back(std::make_shared<BlockListPartition>(
+        id, grid, part_bl, this, exec_spaces_[id % exec_spaces_.size()]));
+    id++;
+  }
   block_partitions_[grid] = out;
 }
 
+void Mesh::SetDefaultPackSize(const int pack_size) {
+  if (pack_size == default_pack_size_) return;
+  default_pack_size_ = pack_size;
+  // MeshData of the old partitions and their caches are no longer valid
+  mesh_data.PurgeNonBase();
+  mesh_data.Get()->ClearCaches();
+  BuildBlockPartitions(GridIdentifier::leaf());
+  if (do_contiguous_storage) {
+    for (auto &partition : GetDefaultBlockPartitions())
+      mesh_data.Add("base", partition)->BuildContiguousStorage();
+  }
+}
+
 //----------------------------------------------------------------------------------------
 //! \fn void Mesh::OutputMeshStructure(int ndim)
 //  \brief print the mesh structure information
@@ -426,18 +596,19 @@ void Mesh::OutputMeshStructure(const int ndim,
   std::cout << "Number of logical  refinement levels = " << current_level << std::endl;
 
   // compute/output number of blocks per level, and cost per level
-  std::vector<int> nb_per_plevel(max_level + 1, 0);
-  std::vector<int> cost_per_plevel(max_level + 1, 0);
+  // physical levels are negative below the root grid
+  std::vector<int> nb_per_plevel(max_level - min_level + 1, 0);
+  std::vector<int> cost_per_plevel(max_level - min_level + 1, 0);
 
   for (int i = 0; i < nbtotal; i++) {
-    nb_per_plevel[(loclist[i].level() - root_level)]++;
-    cost_per_plevel[(loclist[i].level() - root_level)] += costlist[i];
+    nb_per_plevel[(loclist[i].level() - min_level)]++;
+    cost_per_plevel[(loclist[i].level() - min_level)] += costlist[i];
   }
-  for (int i = root_level; i <= max_level; i++) {
-    if (nb_per_plevel[i - root_level] != 0) {
+  for (int i = min_level; i <= max_level; i++) {
+    if (nb_per_plevel[i - min_level] != 0) {
       std::cout << "  Physical level = " << i - root_level << " (logical level = " << i
-                << "): " << nb_per_plevel[i - root_level]
-                << " MeshBlocks, cost = " << cost_per_plevel[i - root_level] << std::endl;
+                << "): " << nb_per_plevel[i - min_level]
+                << " MeshBlocks, cost = " << cost_per_plevel[i - min_level] << std::endl;
     }
   }
 
@@ -471,7 +642,7 @@ void Mesh::OutputMeshStructure(const int ndim,
   // output relative size/locations of meshblock to file, for plotting
   double real_max = std::numeric_limits<double>::max();
   double mincost = real_max, maxcost = 0.0, totalcost = 0.0;
-  for (int i = root_level; i <= max_level; i++) {
+  for (int i = min_level; i <= max_level; i++) {
     for (int j = 0; j < nbtotal; j++) {
       if (loclist[j].level() == i) {
         SetBlockSizeAndBoundaries(loclist[j], block_size, block_bcs);
@@ -580,6 +751,7 @@ void Mesh::ApplyUserWorkBeforeRestartOutput(Mesh *mesh, ParameterInput *pin,
 }
 
 void Mesh::BuildTagMapAndBoundaryBuffers() {
+  PARTHENON_INSTRUMENT_REGION("Mesh::BuildTagMapAndBoundaryBuffers")
   const int num_partitions = DefaultNumPartitions();
   const int nmb = GetNumMeshBlocksThisRank(Globals::my_rank);
 
@@ -590,7 +762,7 @@ void Mesh::BuildTagMapAndBoundaryBuffers() {
     tag_map.AddMeshDataToMap<BoundaryType::any>(md);
   }
 
-  if (multigrid) {
+  if (multigrid && gmg_hierarchy_valid_) {
     for (int gmg_level = GetGMGMinLevel(); gmg_level <= GetGMGMaxLevel(); ++gmg_level) {
       const auto grid_id = GridIdentifier::two_level_composite(gmg_level);
       for (auto &partition : GetDefaultBlockPartitions(grid_id)) {
@@ -628,14 +800,23 @@ void Mesh::BuildTagMapAndBoundaryBuffers() {
       "Too many iterations waiting to delete boundary communication buffers.");
 
   // Clear boundary communication buffers
-  boundary_comm_map.clear();
+  stream_ordered_buffers.Clear();
+  coalesced_buffers.Clear();
+  null_masks.Clear();
+  node_shared_buffers.Clear();
+  boundary_comm_map = TakeUnchangedBuffers_();
+
+  // Needs to know the ranks on the same node when the buffers are built
+  node_shared_buffers.Initialize(this);
+  stream_ordered_buffers.Initialize(this);
 
   // Build the boundary buffers for the current mesh
   for (auto &partition : GetDefaultBlockPartitions()) {
     auto &md = mesh_data.Add("base", partition);
+    if (do_contiguous_storage) md->BuildContiguousStorage();
     BuildBoundaryBuffers(md);
   }
-  if (multigrid) {
+  if (multigrid && gmg_hierarchy_valid_) {
     for (int gmg_level = GetGMGMinLevel(); gmg_level <= GetGMGMaxLevel(); ++gmg_level) {
       const auto grid_id = GridIdentifier::two_level_composite(gmg_level);
       for (auto &partition : GetDefaultBlockPartitions(grid_id)) {
@@ -645,6 +826,103 @@ void Mesh::BuildTagMapAndBoundaryBuffers() {
       }
     }
   }
+  coalesced_buffers.Initialize(this);
+  null_masks.Initialize(this);
+  node_shared_buffers.Build();
+  stream_ordered_buffers.Build();
+
+  // Buffers of sizes that aren't needed for the current mesh anymore would otherwise be
+  // kept forever
+  if (GetBufferPoolSizeInBytes() > buffer_pool_max_bytes)
+    TrimBufferPools(buffer_pool_max_bytes);
+}
+
+Mesh::comm_buf_map_t Mesh::TakeUnchangedBuffers_() {
+  comm_buf_map_t kept;
+  // Multigrid buffers are keyed by the gids of the multigrid blocks. The ownership of
+  // shared elements, and with it the size of deduplicated buffers, can change even if
+  // both blocks stay the same.
+  if (do_incremental_buffer_rebuild && !multigrid && !do_deduplicate_shared_elements) {
+    const int nold = remesh_gid_map_.size();
+    for (auto &[key, buf] : boundary_comm_map) {
+      const auto &[sender, receiver, label, location, other] = key;
+      if (sender >= nold || receiver >= nold) continue;
+      const int new_sender = remesh_gid_map_[sender];
+      const int new_receiver = remesh_gid_map_[receiver];
+      if (new_sender < 0 || new_receiver < 0) continue;
+      // These are registered with their helpers when they are created
+      if (buf.IsNodeShared() || buf.IsStreamOrdered()) continue;
+      if (buf.GetSendRank() != ranklist[new_sender] ||
+          buf.GetRecvRank() != ranklist[new_receiver])
+        continue;
+      kept.emplace(channel_key_t{new_sender, new_receiver, label, location, other}, buf);
+    }
+  }
+  // Only valid for the first rebuild after a remesh
+  remesh_gid_map_.clear();
+  return kept;
+}
+
+std::shared_ptr<MeshBlock> Mesh::MakeMeshBlock_(int gid, int lid, LogicalLocation loc,
+                                                RegionSize block_size,
+                                                BoundaryFlag *block_bcs,
+                                                ParameterInput *pin,
+                                                ApplicationInput *app_in) {
+  if (retired_blocks_.empty())
+    return MeshBlock::Make(gid, lid, loc, block_size, block_bcs, this, pin, app_in,
+                           packages, resolved_packages, gflag);
+  auto pmb = std::move(retired_blocks_.back());
+  retired_blocks_.pop_back();
+  pmb->Initialize(gid, lid, loc, block_size, block_bcs, this, pin, app_in, packages,
+                  resolved_packages, gflag);
+  return pmb;
+}
+
+void Mesh::RetireMeshBlocks_(BlockList_t &blocks) {
+  if (!recycle_blocks_) return;
+  // More blocks than there are on this rank now are unlikely to be needed at once
+  const std::size_t max_retired = block_list.size();
+  for (auto &pmb : blocks) {
+    if (retired_blocks_.size() >= max_retired) break;
+    // Blocks that were moved to the new block list (or are held on to elsewhere)
+    if (pmb == nullptr || pmb.use_count() > 1) continue;
+    pmb->Retire();
+    retired_blocks_.push_back(std::move(pmb));
+  }
+}
+
+std::uint64_t Mesh::TrimBufferPools(const std::uint64_t max_bytes) {
+  std::vector<buf_pool_t<Real> *> pools;
+  for (auto &[size, pool] : pool_map)
+    pools.push_back(&pool);
+  std::sort(pools.begin(), pools.end(),
+            [](const auto *a, const auto *b) { return a->LastUse() < b->LastUse(); });
+  std::uint64_t total = GetBufferPoolSizeInBytes();
+  std::uint64_t released = 0;
+  for (auto *pool : pools) {
+    if (total <= max_bytes) break;
+    const std::uint64_t bytes = pool->ReleaseUnused();
+    total -= bytes;
+    released += bytes;
+  }
+  if (total > max_bytes) {
+    const std::uint64_t bytes = host_staging.GetSizeInBytes();
+    host_staging.Trim();
+    released += bytes;
+  }
+  return released;
+}
+
+void Mesh::UpdateCoarseBuffers() {
+  if (!lazy_coarse_buffers) return;
+  for (auto &pmb : block_list) {
+    // Boundary communication only prolongates into and restricts onto the coarse buffers
+    // of blocks with coarser neighbors
+    bool needed = false;
+    for (const auto &nb : pmb->neighbors)
+      needed = needed || (nb.origin_loc.level() < pmb->loc.level());
+    pmb->SetCoarseBuffersAllocated(needed);
+  }
 }
 
 void Mesh::CommunicateBoundaries(std::string md_name) {
@@ -753,8 +1031,10 @@ void Mesh::Initialize(bool init_problem, ParameterInput *pin, ApplicationInput *
   PARTHENON_INSTRUMENT
   bool init_done = true;
   const int nb_initial = nbtotal;
+  Kokkos::Timer timer;
   do {
     int nmb = GetNumMeshBlocksThisRank(Globals::my_rank);
+    timer.reset();
 
     // init meshblock data
     for (int i = 0; i < nmb; ++i) {
@@ -812,24 +1092,45 @@ void Mesh::Initialize(bool init_problem, ParameterInput *pin, ApplicationInput *
                     [](auto &sp_block) { sp_block->SetAllVariablesToInitialized(); });
     }
 
+    Kokkos::fence();
+    startup_times_.problem_generator += timer.seconds();
+    timer.reset();
+
     PreCommFillDerived();
 
+    UpdateCoarseBuffers();
     BuildTagMapAndBoundaryBuffers();
 
-    CommunicateBoundaries();
+    if (init_problem || !restart_ghosts_valid) CommunicateBoundaries();
 
     FillDerived();
+    Kokkos::fence();
+    startup_times_.boundaries += timer.seconds();
 
     if (init_problem && adaptive) {
+      timer.reset();
       for (int i = 0; i < nmb; ++i) {
         block_list[i]->pmr->CheckRefinementCondition();
       }
       init_done = false;
       // caching nbtotal the private variable my be updated in the following function
       const int nb_before_loadbalance = nbtotal;
+      // If the number of blocks changes, the next iteration calls the problem generator
+      // on all blocks and fills their boundaries, so the remesh does not need to
+      defer_remesh_fill_ = true;
       LoadBalancingAndAdaptiveMeshRefinement(pin, app_in);
+      defer_remesh_fill_ = false;
+      startup_times_.refinement += timer.seconds();
       if (nbtotal == nb_before_loadbalance) {
         init_done = true;
+        if (modified) {
+          timer.reset();
+          PreCommFillDerived();
+          CommunicateBoundaries();
+          FillDerived();
+          Kokkos::fence();
+          startup_times_.boundaries += timer.seconds();
+        }
       } else if (nbtotal < nb_before_loadbalance && Globals::my_rank == 0) {
         std::cout << "### Warning in Mesh::Initialize" << std::endl
                   << "The number of MeshBlocks decreased during AMR grid initialization."
@@ -899,6 +1200,39 @@ const IndexShape &Mesh::GetLeafBlockCellBounds(CellLevel level) const {
   }
 }
 
+const forest::BlockLocator &Mesh::GetBlockLocator() {
+  if (!block_locator_valid_) {
+    block_locator_ =
+        forest::BlockLocator(forest, loclist, ranklist, mesh_size, mesh_bcs, ndim);
+    block_locator_valid_ = true;
+  }
+  return block_locator_;
+}
+
+namespace {
+// Throughput of this rank in cell updates per second for a memory bandwidth bound
+// stencil, which is representative of the kernels of typical applications
+double MeasureRankThroughput() {
+  constexpr int n = 1 << 22;
+  constexpr int nrep = 5;
+  ParArray1D<Real> a("rank calibration input", n);
+  ParArray1D<Real> b("rank calibration output", n);
+  double best = std::numeric_limits<double>::max();
+  for (int rep = 0; rep <= nrep; ++rep) {
+    Kokkos::fence();
+    Kokkos::Timer timer;
+    par_for(
+        PARTHENON_AUTO_LABEL, 1, n - 2, KOKKOS_LAMBDA(const int i) {
+          b(i) = a(i) + 0.25 * (a(i - 1) - 2.0 * a(i) + a(i + 1));
+        });
+    Kokkos::fence();
+    // The first repetition includes the setup of the kernel
+    if (rep > 0) best = std::min(best, timer.seconds());
+  }
+  return n / best;
+}
+} // namespace
+
 // Functionality re-used in mesh constructor
 void Mesh::RegisterLoadBalancing_(ParameterInput *pin) {
 #ifdef MPI_PARALLEL // JMM: Not sure this ifdef is needed
@@ -906,17 +1240,103 @@ void Mesh::RegisterLoadBalancing_(ParameterInput *pin) {
       pin->GetOrAddString("parthenon/loadbalancing", "balancer", "default",
                           std::vector<std::string>{"default", "automatic", "manual"});
   if (balancer == "automatic") {
-    // JMM: I am disabling timing based load balancing, as it's not
-    // threaded through the infrastructure. I think some thought needs
-    // to go into doing this right with loops over meshdata rather
-    // than loops over data on a single meshblock.
-    PARTHENON_FAIL("Timing based load balancing is currently unavailable.");
+    // Block costs are measured from the execution time of the task lists, see
+    // DriverUtils::MeasureBlockCosts
     lb_automatic_ = true;
   } else if (balancer == "manual") {
     lb_manual_ = true;
   }
   lb_tolerance_ = pin->GetOrAddReal("parthenon/loadbalancing", "tolerance", 0.5);
   lb_interval_ = pin->GetOrAddInteger("parthenon/loadbalancing", "interval", 10);
+  lb_aggregate_migration_ =
+      pin->GetOrAddBoolean("parthenon/loadbalancing", "aggregate_migration", false);
+  for (const auto &[swarm_name, m] : resolved_packages->AllSwarms())
+    lb_particle_cost_ |= resolved_packages->GetSwarmCost(swarm_name) > 0.0;
+  lb_particle_drift_tolerance_ =
+      pin->GetOrAddReal("parthenon/loadbalancing", "particle_drift_tolerance", 0.0);
+  lb_imbalance_trigger_ =
+      pin->GetOrAddBoolean("parthenon/loadbalancing", "imbalance_trigger", false);
+  if (lb_imbalance_trigger_ && !lb_automatic_ && !lb_manual_ && !lb_particle_cost_)
+    PARTHENON_WARN("parthenon/loadbalancing/imbalance_trigger has no effect with equal "
+                   "block costs.");
+  PARTHENON_REQUIRE_THROWS(lb_particle_drift_tolerance_ >= 0.0,
+                           "parthenon/loadbalancing/particle_drift_tolerance must not "
+                           "be negative");
+#endif // MPI_PARALLEL
+  // The partitioner is also used by mesh tests, which emulate multiple ranks
+  lb_partitioner_ = loadbalance::GetPartitioner(
+      pin->GetOrAddString(
+          "parthenon/loadbalancing", "partitioner", "greedy",
+          std::vector<std::string>{"greedy", "optimal", "incremental", "user"}));
+  lb_incremental_tolerance_ =
+      pin->GetOrAddReal("parthenon/loadbalancing", "incremental_tolerance", 0.1);
+
+  // Ranks with different throughput receive costs proportional to their weights
+  lb_rank_weights_.clear();
+  if (pin->DoesParameterExist("parthenon/loadbalancing", "rank_weights")) {
+    const auto weights = pin->GetVector<Real>("parthenon/loadbalancing", "rank_weights");
+    lb_rank_weights_.assign(weights.begin(), weights.end());
+    PARTHENON_REQUIRE_THROWS(lb_rank_weights_.size() == Globals::nranks,
+                             "parthenon/loadbalancing/rank_weights needs one weight per "
+                             "rank.");
+  } else if (pin->GetOrAddBoolean("parthenon/loadbalancing", "calibrate_rank_weights",
+                                  false)) {
+    double throughput = MeasureRankThroughput();
+    lb_rank_weights_.assign(Globals::nranks, throughput);
+#ifdef MPI_PARALLEL
+    PARTHENON_MPI_CHECK(MPI_Allgather(&throughput, 1, MPI_DOUBLE,
+                                      lb_rank_weights_.data(), 1, MPI_DOUBLE,
+                                      MPI_COMM_WORLD));
+#endif
+    if (Globals::my_rank == 0) {
+      const auto [min, max] =
+          std::minmax_element(lb_rank_weights_.begin(), lb_rank_weights_.end());
+      std::cout << "Calibrated rank weights, fastest/slowest rank: " << *max / *min
+                << std::endl;
+    }
+  }
+  for (const double w : lb_rank_weights_)
+    PARTHENON_REQUIRE_THROWS(w > 0.0, "Rank weights must be positive.");
+  if (!lb_rank_weights_.empty() && lb_partitioner_ != loadbalance::Partitioner::greedy &&
+      lb_partitioner_ != loadbalance::Partitioner::optimal && Globals::my_rank == 0)
+    PARTHENON_WARN("Rank weights are only used by the greedy and optimal partitioners.");
+#ifdef MPI_PARALLEL
+  lb_node_sizes_.clear();
+  if (pin->GetOrAddBoolean("parthenon/loadbalancing", "hierarchical", false)) {
+    // Identify every node by the lowest rank on it
+    MPI_Comm node_comm;
+    PARTHENON_MPI_CHECK(MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED,
+                                            Globals::my_rank, MPI_INFO_NULL, &node_comm));
+    int leader = Globals::my_rank;
+    PARTHENON_MPI_CHECK(MPI_Bcast(&leader, 1, MPI_INT, 0, node_comm));
+    PARTHENON_MPI_CHECK(MPI_Comm_free(&node_comm));
+    std::vector<int> leaders(Globals::nranks);
+    PARTHENON_MPI_CHECK(MPI_Allgather(&leader, 1, MPI_INT, leaders.data(), 1, MPI_INT,
+                                      MPI_COMM_WORLD));
+    // Blocks are assigned to ranks in increasing order, so the partition can only be
+    // split by node if the ranks of every node are consecutive
+    bool consecutive = true;
+    for (int r = 0; r < Globals::nranks; ++r) {
+      if (r > 0 && leaders[r] == leaders[r - 1]) {
+        lb_node_sizes_.back()++;
+      } else {
+        consecutive = consecutive && leaders[r] == r;
+        lb_node_sizes_.push_back(1);
+      }
+    }
+    if (!consecutive) {
+      lb_node_sizes_.clear();
+      if (Globals::my_rank == 0)
+        PARTHENON_WARN("Hierarchical load balancing requires consecutive ranks on "
+                       "every node, falling back to partitioning across all ranks.");
+    } else if (lb_partitioner_ != loadbalance::Partitioner::greedy &&
+               lb_partitioner_ != loadbalance::Partitioner::optimal) {
+      lb_node_sizes_.clear();
+      if (Globals::my_rank == 0)
+        PARTHENON_WARN("Hierarchical load balancing is only supported by the greedy "
+                       "and optimal partitioners.");
+    }
+  }
 #endif // MPI_PARALLEL
 }
 
@@ -946,6 +1366,30 @@ void Mesh::SetupMPIComms() {
     const auto ret = mpi_comm_map_.insert({pair.first, mpi_comm});
     PARTHENON_REQUIRE_THROWS(ret.second, "Communicator with same name already in map");
   }
+  {
+    MPI_Comm mpi_comm;
+    PARTHENON_MPI_CHECK(MPI_Comm_dup(MPI_COMM_WORLD, &mpi_comm));
+    const auto ret = mpi_comm_map_.insert({amr_migration_comm_, mpi_comm});
+    PARTHENON_REQUIRE_THROWS(ret.second, "Communicator with same name already in map");
+  }
+  if (do_coalesced_comms || do_coalesced_flux_correction) {
+    MPI_Comm mpi_comm;
+    PARTHENON_MPI_CHECK(MPI_Comm_dup(MPI_COMM_WORLD, &mpi_comm));
+    const auto ret = mpi_comm_map_.insert({coalesced_comm_label, mpi_comm});
+    PARTHENON_REQUIRE_THROWS(ret.second, "Communicator with same name already in map");
+  }
+  {
+    MPI_Comm mpi_comm;
+    PARTHENON_MPI_CHECK(MPI_Comm_dup(MPI_COMM_WORLD, &mpi_comm));
+    const auto ret = mpi_comm_map_.insert({ghost_accumulation_comm_label, mpi_comm});
+    PARTHENON_REQUIRE_THROWS(ret.second, "Communicator with same name already in map");
+  }
+  if (do_null_masks) {
+    MPI_Comm mpi_comm;
+    PARTHENON_MPI_CHECK(MPI_Comm_dup(MPI_COMM_WORLD, &mpi_comm));
+    const auto ret = mpi_comm_map_.insert({null_mask_comm_label, mpi_comm});
+    PARTHENON_REQUIRE_THROWS(ret.second, "Communicator with same name already in map");
+  }
   // TODO(everying during a sync) we should discuss what to do with face vars as they
   // are currently not handled in pmb->meshblock_data.Get()->SetupPersistentMPI(); nor
   // inserted into pmb->pbval->bvars.
@@ -1075,6 +1519,9 @@ void Mesh::DoStaticRefinement(ParameterInput *pin) {
     return std::pair<int, int>{lxmin, lxmax};
   };
 
+  // Blocks of all regions, which are added to the forest at once at the end, so that the
+  // refinements they imply are found in a single sweep instead of block by block
+  std::vector<LogicalLocation> ref_locs;
   InputBlock *pib = pin->pfirst_block;
   while (pib != nullptr) {
     if (pib->block_name.compare(0, 27, "parthenon/static_refinement") == 0) {
@@ -1141,14 +1588,14 @@ void Mesh::DoStaticRefinement(ParameterInput *pin) {
       for (std::int64_t k = l_region_min[2]; k < l_region_max[2]; k += 2) {
         for (std::int64_t j = l_region_min[1]; j < l_region_max[1]; j += 2) {
           for (std::int64_t i = l_region_min[0]; i < l_region_max[0]; i += 2) {
-            LogicalLocation nloc(lrlev, i, j, k);
-            forest.AddMeshBlock(forest.GetForestLocationFromLegacyTreeLocation(nloc));
+            ref_locs.emplace_back(lrlev, i, j, k);
           }
         }
       }
     }
     pib = pib->pnext;
   }
+  forest.AddMeshBlocks(forest.GetForestLocationsFromLegacyTreeLocations(ref_locs));
 }
 // Return list of locations and levels for the legacy tree
 // TODO(LFR): It doesn't make sense to offset the level by the
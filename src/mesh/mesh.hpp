@@ -22,8 +22,11 @@
 //  (potentially on different levels) that tile the entire domain.
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <deque>
 #include <functional>
+#include <limits>
 #include <map>
 #include <memory>
 #include <string>
@@ -36,6 +39,11 @@
 
 #include "application_input.hpp"
 #include "bvals/boundary_conditions.hpp"
+#include "bvals/comms/coalesced_buffers.hpp"
+#include "bvals/comms/node_shared_buffers.hpp"
+#include "bvals/comms/sparse_null_masks.hpp"
+#include "bvals/comms/stream_ordered_buffers.hpp"
+#include "interface/flux_arenas.hpp"
 #include "bvals/comms/tag_map.hpp"
 #include "config.hpp"
 #include "coordinates/coordinates.hpp"
@@ -45,20 +53,25 @@
 #include "interface/mesh_data.hpp"
 #include "interface/state_descriptor.hpp"
 #include "kokkos_abstraction.hpp"
+#include "mesh/forest/block_locator.hpp"
 #include "mesh/forest/forest.hpp"
 #include "mesh/forest/forest_topology.hpp"
+#include "mesh/load_balance.hpp"
+#include "mesh/memory_usage.hpp"
 #include "mesh/meshblock_pack.hpp"
 #include "outputs/io_wrapper.hpp"
 #include "parameter_input.hpp"
 #include "parthenon_arrays.hpp"
 #include "utils/communication_buffer.hpp"
 #include "utils/hash.hpp"
+#include "utils/host_staging.hpp"
 #include "utils/object_pool.hpp"
 #include "utils/partition_stl_containers.hpp"
 
 namespace parthenon {
 
 // Forward declarations
+struct InSituData;
 class MeshBlock;
 class MeshRefinement;
 class ParameterInput;
@@ -99,6 +112,8 @@ class Mesh {
     return nblist[my_rank];
   }
   int GetNumMeshThreads() const { return num_mesh_threads_; }
+  bool TimingBasedLoadBalancing() const { return lb_automatic_; }
+  std::uint64_t GetMigratedBytes() const { return lb_migrated_bytes_; }
   std::int64_t GetTotalCells();
   // TODO(JMM): Move block_size into mesh.
   int GetNumberOfMeshBlockCells() const;
@@ -109,6 +124,20 @@ class Mesh {
   const IndexShape &GetLeafBlockCellBounds(CellLevel level = CellLevel::same) const;
 
   const forest::Forest &Forest() const { return forest; }
+  // Maps positions to the gid and rank of the leaf block containing them on device.
+  // Built on first use after the mesh changed.
+  const forest::BlockLocator &GetBlockLocator();
+
+  // Wall times [s] of the phases of setting up the mesh on this rank, accumulated over
+  // the iterations of the initial refinement
+  struct StartupTimes {
+    double block_construction = 0.0; // creating the blocks and their variables
+    double neighbors = 0.0;          // block partitions, GMG block lists, neighbors
+    double problem_generator = 0.0;  // user block data, problem generators, post init
+    double boundaries = 0.0;         // boundary buffers, communication, derived fields
+    double refinement = 0.0;         // initial refinement and load balancing
+  };
+  const StartupTimes &GetStartupTimes() const { return startup_times_; }
 
   // data
   bool modified;
@@ -133,6 +162,13 @@ class Mesh {
   std::map<int, BlockList_t> gmg_block_lists;
   int GetGMGMaxLevel() const { return current_level; }
   int GetGMGMinLevel() const { return gmg_min_logical_level_; }
+  // Build the GMG block lists, their neighbors, and their boundary buffers if they were
+  // deferred by parthenon/mesh/gmg_lazy_build. Collective, and a no-op if they are
+  // already up to date with the current mesh.
+  void BuildGMGHierarchy();
+  // Rank that owns the block at loc on the GMG levels, which differs from the rank of
+  // the leaf block with the same Morton number for agglomerated internal blocks
+  int GetGMGRank(const LogicalLocation &loc) const;
 
   // functions
   void Initialize(bool init_problem, ParameterInput *pin, ApplicationInput *app_in);
@@ -148,20 +184,17 @@ class Mesh {
   int DefaultNumPartitions() {
     return partition::partition_impl::IntCeil(block_list.size(), DefaultPackSize());
   }
+  // Change the pack size of the leaf grid (a value < 1 means all blocks in one pack),
+  // which drops all MeshData but "base". Must not be called within a cycle.
+  void SetDefaultPackSize(int pack_size);
 
   const std::vector<std::shared_ptr<BlockListPartition>> &
   GetDefaultBlockPartitions(GridIdentifier grid = GridIdentifier::leaf()) const {
     return block_partitions_.at(grid);
   }
-
-  // step 7: create new MeshBlock list (same MPI rank but diff level: create new block)
-  // Moved here given Cuda/nvcc restriction:
-  // "error: The enclosing parent function ("...")
-  // for an extended __host__ __device__ lambda cannot have private or
-  // protected access within its class"
-  void FillSameRankCoarseToFineAMR(MeshBlock *pob, MeshBlock *pmb,
-                                   LogicalLocation &newloc);
-  void FillSameRankFineToCoarseAMR(MeshBlock *pob, MeshBlock *pmb, LogicalLocation &loc);
+  int NumExecSpaceInstances() const { return exec_spaces_.size(); }
+  // Incremented every time the block list is rebuilt by load balancing and refinement
+  std::size_t GetBlockListGeneration() const { return block_list_generation_; }
 
   std::shared_ptr<MeshBlock> FindMeshBlock(int tgid) const;
 
@@ -190,6 +223,8 @@ class Mesh {
                      OutputParameters *pparams)>
       UserWorkBeforeRestartOutput = nullptr;
 
+  std::function<void(Mesh *, const InSituData &)> InSituOutput = nullptr;
+
   static void PreStepUserDiagnosticsInLoopDefault(Mesh *, ParameterInput *,
                                                   SimTime const &);
   std::function<void(Mesh *, ParameterInput *, SimTime const &)>
@@ -200,6 +235,9 @@ class Mesh {
       PostStepUserDiagnosticsInLoop = PostStepUserDiagnosticsInLoopDefault;
 
   int GetRootLevel() const noexcept { return root_level; }
+  // Coarsest level blocks can be derefined to, which is below the root level (i.e.,
+  // blocks cover several root blocks) if parthenon/mesh/numlevel_below_root > 0
+  int GetMinLevel() const noexcept { return min_level; }
   int GetLegacyTreeRootLevel() const {
     return forest.root_level + forest.forest_level.value();
   }
@@ -219,10 +257,65 @@ class Mesh {
   using channel_key_t = std::tuple<int, int, std::string, int, int>;
   using comm_buf_t = CommBuffer<buf_pool_t<Real>::owner_t>;
   std::unordered_map<int, buf_pool_t<Real>> pool_map;
+  // Pinned host memory for messages that go through the host, see host_staged_comms
+  HostStaging host_staging;
   using comm_buf_map_t =
       std::unordered_map<channel_key_t, comm_buf_t, tuple_hash<channel_key_t>>;
   comm_buf_map_t boundary_comm_map;
   TagMap tag_map;
+  // Exchange all non-local boundary buffers between a pair of ranks in one message
+  bool do_coalesced_comms = false;
+  // Only coalesce the (small, latency bound) flux correction buffers
+  bool do_coalesced_flux_correction = false;
+  bool UseCoalescedComms(BoundaryType btype) const {
+    return do_coalesced_comms ||
+           (do_coalesced_flux_correction &&
+            (btype == BoundaryType::flxcor_send || btype == BoundaryType::flxcor_recv));
+  }
+  // Exchange the coalesced messages of ghost zones and flux corrections through
+  // neighborhood collectives instead of point-to-point messages
+  bool do_neighbor_collective_comms = false;
+  bool UseNeighborCollectives(BoundaryType btype) const {
+    return do_neighbor_collective_comms && UseCoalescedComms(btype) &&
+           (btype == BoundaryType::any || btype == BoundaryType::nonlocal ||
+            btype == BoundaryType::flxcor_send || btype == BoundaryType::flxcor_recv);
+  }
+  CoalescedBuffers coalesced_buffers;
+  static constexpr char coalesced_comm_label[] = "mesh_internal_coalesced_comms";
+  // Use persistent MPI requests for non-sparse boundary buffers
+  bool do_persistent_comms = false;
+  // Set ghost zones of cell centered variables directly from neighbors in the same
+  // MeshData object instead of packing and unpacking their local buffers
+  bool do_direct_local_copies = false;
+  // Send the elements that face, edge, and node variables share with neighbors on the
+  // same level only once, from the block that owns them
+  bool do_deduplicate_shared_elements = false;
+  // Signal null sends of sparse variables with one allocation mask per rank pair
+  bool do_null_masks = false;
+  SparseNullMasks null_masks;
+  static constexpr char null_mask_comm_label[] = "mesh_internal_null_masks";
+  // Communicator of the ghost zone accumulation of particle depositions
+  static constexpr char ghost_accumulation_comm_label[] =
+      "mesh_internal_ghost_accumulation";
+  // Exchange non-sparse buffers between ranks on the same node through shared memory
+  bool do_shared_memory_comms = false;
+  NodeSharedBuffers node_shared_buffers;
+  // Exchange the non-local ghost buffers with NCCL/RCCL on the streams of the partitions
+  bool do_stream_ordered_comms = false;
+  bool UseStreamOrderedComms(BoundaryType btype) const {
+    return do_stream_ordered_comms && btype == BoundaryType::any;
+  }
+  StreamOrderedBuffers stream_ordered_buffers;
+  // Capture kernel sequences launched via MeshData::LaunchDeviceGraph into device graphs
+  bool do_device_graphs = false;
+  // Keep the boundary buffers of channels between blocks that are unchanged by a remesh
+  // and stay on the same ranks instead of rebuilding all of them
+  bool do_incremental_buffer_rebuild = false;
+  // Keep the data of a variable on all blocks of a default partition in one allocation,
+  // see MeshData::BuildContiguousStorage
+  bool do_contiguous_storage = false;
+  // Storage of the flux variables while they are acquired, see MeshData::AcquireFluxes
+  FluxArenas flux_arenas;
 
 #ifdef MPI_PARALLEL
   MPI_Comm GetMPIComm(const std::string &label) const { return mpi_comm_map_.at(label); }
@@ -237,14 +330,33 @@ class Mesh {
     }
   }
 
+  // Bytes held on this rank by variables, buffers, and swarms. Not collective, use
+  // MemoryUsage::Sum or MemoryUsage::Max for totals over all ranks.
+  MemoryUsage GetMemoryUsage() const;
+
   uint64_t GetBufferPoolSizeInBytes() const {
     std::uint64_t buffer_memory = 0;
     for (auto &p : pool_map) {
       buffer_memory += p.second.SizeInBytes();
     }
-    return buffer_memory;
+    return buffer_memory + host_staging.GetSizeInBytes();
   }
 
+  // Drop the unused buffers of the least recently used pools until the pools hold at
+  // most max_bytes (or no unused buffers are left), returns the number of bytes dropped
+  std::uint64_t TrimBufferPools(std::uint64_t max_bytes);
+  // Pools are trimmed to this size whenever the boundary buffers are rebuilt
+  std::uint64_t buffer_pool_max_bytes = std::numeric_limits<std::uint64_t>::max();
+
+  // Only keep the coarse buffers of blocks that have coarser neighbors
+  bool lazy_coarse_buffers = false;
+  // Set on restart when the restart file held the ghost zones of all communicated
+  // variables, in which case Initialize skips the boundary exchange
+  bool restart_ghosts_valid = false;
+  // Allocate or release the coarse buffers of all blocks according to their current
+  // neighbors, does nothing unless lazy_coarse_buffers is set
+  void UpdateCoarseBuffers();
+
   // expose a mesh-level call to get lists of variables from resolved_packages
   template <typename... Args>
   std::vector<std::string> GetVariableNames(Args &&...args) {
@@ -255,7 +367,7 @@ class Mesh {
 
  private:
   // data
-  int root_level, max_level, current_level;
+  int root_level, min_level, max_level, current_level;
   int num_mesh_threads_;
   /// Maps Global Block IDs to which rank the block is mapped to.
   std::vector<int> ranklist;
@@ -265,16 +377,9 @@ class Mesh {
   std::vector<int> nblist;
   /// Maps global block ID to its cost
   std::vector<double> costlist;
-  // 8x arrays used exclusively for AMR (not SMR):
-  /// Count of blocks to refine on each rank
-  std::vector<int> nref;
-  /// Count of blocks to de-refine on each rank
-  std::vector<int> nderef;
-  std::vector<int> rdisp, ddisp;
-  std::vector<int> bnref, bnderef;
-  std::vector<int> brdisp, bddisp;
-  // the last 4x should be std::size_t, but are limited to int by MPI
 
+  forest::BlockLocator block_locator_;
+  bool block_locator_valid_ = false;
   std::vector<LogicalLocation> loclist;
 
   // flags are false if using non-uniform or user meshgen function
@@ -284,15 +389,75 @@ class Mesh {
   bool lb_flag_, lb_automatic_, lb_manual_;
   double lb_tolerance_;
   int lb_interval_;
+  loadbalance::Partitioner lb_partitioner_ = loadbalance::Partitioner::greedy;
+  double lb_incremental_tolerance_ = 0.1;
+  // number of ranks on every node if blocks are partitioned across nodes first
+  std::vector<int> lb_node_sizes_;
+  // relative throughput of every rank, empty if all ranks are equally fast
+  std::vector<double> lb_rank_weights_;
+  // total number of bytes sent between ranks while redistributing blocks
+  std::uint64_t lb_migrated_bytes_ = 0;
+  // pack all data migrating between a pair of ranks into a single message
+  bool lb_aggregate_migration_ = false;
+  // at least one swarm has a non-zero particle cost, see StateDescriptor::SetSwarmCost
+  bool lb_particle_cost_ = false;
+  // check the balance when the particle cost of a rank changed by more than this
+  // fraction of the average rank particle cost since the last check, zero disables it
+  double lb_particle_drift_tolerance_ = 0.0;
+  double lb_rank_particle_cost_ = 0.0;
+  double lb_rank_particle_cost_at_check_ = -1.0;
+  // check the balance whenever the maximum rank cost, reduced in the background every
+  // cycle, exceeds the tolerance and the expected gain outweighs the last migration time
+  bool lb_imbalance_trigger_ = false;
+  double lb_migration_time_ = 0.0;
+#ifdef MPI_PARALLEL
+  // (weighted) cost of this rank, and maximum and sum over all ranks
+  double lb_rank_cost_[2] = {0.0, 0.0};
+  double lb_reduced_cost_[2] = {0.0, 0.0};
+  MPI_Request lb_cost_requests_[2] = {MPI_REQUEST_NULL, MPI_REQUEST_NULL};
+#endif
+  loadbalance::PartitionerFunc_t UserPartitioner = nullptr;
+  std::function<void(Mesh *, ParameterInput *, const BlockList_t &)>
+      UserWorkDuringMigration = nullptr;
+  // number of layers of neighbors around blocks tagged for refinement that are refined
+  // as well and kept from derefining
+  int refinement_buffer_ = 0;
+  StartupTimes startup_times_;
+  // Set while remeshing during Mesh::Initialize when the problem generator is called on
+  // the new blocks anyway, so the boundary fill at the end of the remesh is skipped
+  bool defer_remesh_fill_ = false;
+  // Blocks removed by a remesh that are kept for reuse, see recycle_blocks
+  bool recycle_blocks_ = false;
+  BlockList_t retired_blocks_;
+  // New gid of every old block that was neither refined nor derefined by the last
+  // remesh (-1 otherwise), consumed by the next rebuild of the boundary buffers
+  std::vector<int> remesh_gid_map_;
 
   // size of default MeshBlockPacks
   int default_pack_size_;
 
   int gmg_min_logical_level_ = 0;
+  // Defer building the GMG hierarchy after a remesh until it is needed by a solver
+  bool gmg_lazy_build_ = false;
+  bool gmg_hierarchy_valid_ = false;
+  // Coarsest GMG level relative to the finest level, -1 for as coarse as possible
+  int gmg_max_coarsenings_ = -1;
+  ParameterInput *gmg_pin_ = nullptr;
+  ApplicationInput *gmg_app_in_ = nullptr;
+  // Internal blocks on GMG levels that have fewer than
+  // gmg_agglomeration_blocks_per_rank blocks per rank are gathered onto every
+  // gmg_agglomeration_stride_[level]-th rank
+  int gmg_agglomeration_blocks_per_rank_ = 0;
+  std::map<int, int> gmg_agglomeration_stride_;
 
 #ifdef MPI_PARALLEL
   // Global map of MPI comms for separate variables
   std::unordered_map<std::string, MPI_Comm> mpi_comm_map_;
+  // Communicator used for aggregated AMR block migration
+  static constexpr char amr_migration_comm_[] = "mesh_internal_amr_migration";
+  // Sizes and pinned host storage of the host staged migration messages in flight
+  std::deque<std::int64_t> migration_staged_sizes_;
+  std::vector<HostStaging::host_buf_t> migration_staging_;
 #endif
 
   // functions
@@ -302,18 +467,44 @@ class Mesh {
                       const std::unordered_map<LogicalLocation, int> &dealloc_count = {});
   void DoStaticRefinement(ParameterInput *pin);
   void CalculateLoadBalance(std::vector<double> const &costlist,
+                            std::vector<LogicalLocation> const &loclist,
                             std::vector<int> &ranklist, std::vector<int> &nslist,
-                            std::vector<int> &nblist);
+                            std::vector<int> &nblist,
+                            std::vector<int> const &prev_ranklist = {});
   void ResetLoadBalanceVariables();
 
   // Mesh::LoadBalancingAndAdaptiveMeshRefinement() helper functions:
   void UpdateCostList();
+  bool CheckParticleCostDrift();
+  // Decide from the rank costs reduced since the last cycle whether to check the balance
+  // and post the reduction of the current rank costs
+  bool CheckImbalanceTrigger();
+  void PostRankCostReduction();
   void UpdateMeshBlockTree(int &nnew, int &ndel);
+  void ApplyRefinementBuffer_(std::vector<LogicalLocation> &lref,
+                              std::vector<LogicalLocation> &clderef);
   bool GatherCostListAndCheckBalance();
   void RedistributeAndRefineMeshBlocks(ParameterInput *pin, ApplicationInput *app_in,
                                        int ntot);
+#ifdef MPI_PARALLEL
+  void SendAggregatedMigration(const std::vector<LogicalLocation> &newloc,
+                               const std::vector<int> &newrank,
+                               const std::vector<int> &oldtonew, int onbs, int onbe,
+                               int nleaf, std::vector<BufArray1D<Real>> &send_bufs,
+                               std::vector<MPI_Request> &send_reqs,
+                               std::uint64_t &bytes_sent);
+  void RecvAggregatedMigration(const std::vector<LogicalLocation> &newloc,
+                               const std::vector<int> &newtoold, int nbs, int nbe,
+                               int nleaf);
+#endif
+  // Copy the data of all c2f and f2c pairs with both blocks on this rank at once
+  void FillSameRankAMR(const BlockList_t &old_block_list,
+                       const std::vector<LogicalLocation> &newloc,
+                       const std::vector<int> &newtoold, int onbs, int nbs, int nbe,
+                       int nleaf);
   void BuildGMGBlockLists(ParameterInput *pin, ApplicationInput *app_in);
   void SetGMGNeighbors();
+  void MakeGMGBlockLists_();
   void
   SetMeshBlockNeighbors(GridIdentifier grid_id, BlockList_t &block_list,
                         const std::vector<int> &ranklist,
@@ -327,6 +518,15 @@ class Mesh {
 
   void SetupMPIComms();
   void BuildTagMapAndBoundaryBuffers();
+  // The buffers of boundary_comm_map that the rebuild can keep, keyed by the new gids
+  comm_buf_map_t TakeUnchangedBuffers_();
+  // Create a block during remeshing, reusing a retired block if there is one
+  std::shared_ptr<MeshBlock> MakeMeshBlock_(int gid, int lid, LogicalLocation loc,
+                                            RegionSize block_size,
+                                            BoundaryFlag *block_bcs, ParameterInput *pin,
+                                            ApplicationInput *app_in);
+  // Keep the blocks that nothing else refers to anymore for reuse by MakeMeshBlock_
+  void RetireMeshBlocks_(BlockList_t &blocks);
   void CommunicateBoundaries(std::string md_name = "base");
   void PreCommFillDerived();
   void FillDerived();
@@ -334,6 +534,10 @@ class Mesh {
   void BuildBlockPartitions(GridIdentifier grid);
   std::map<GridIdentifier, std::vector<std::shared_ptr<BlockListPartition>>>
       block_partitions_;
+  // execution space instances that the block partitions are distributed over
+  std::vector<DevExecSpace> exec_spaces_{DevExecSpace()};
+  bool owns_device_instances_ = false;
+  std::size_t block_list_generation_ = 0;
 };
 
 } // namespace parthenon
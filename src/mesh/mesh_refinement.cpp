@@ -93,7 +93,7 @@ void MeshRefinement::SetRefinement(AmrTag flag) {
       refine_flag_ = 1;
     }
   } else if (aret < 0) {
-    if (pmb->loc.level() == pmb->pmy_mesh->root_level) {
+    if (pmb->loc.level() <= pmb->pmy_mesh->GetMinLevel()) {
       refine_flag_ = 0;
       deref_count_ = 0;
     } else {
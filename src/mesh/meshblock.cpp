@@ -35,6 +35,7 @@
 #include "globals.hpp"
 #include "interface/metadata.hpp"
 #include "interface/state_descriptor.hpp"
+#include "interface/swarm_container.hpp"
 #include "interface/variable.hpp"
 #include "kokkos_abstraction.hpp"
 #include "mesh/mesh.hpp"
@@ -124,9 +125,10 @@ void MeshBlock::Initialize(int igid, int ilid, LogicalLocation iloc,
   // construct objects stored in MeshBlock class.  Note in particular that the initial
   // conditions for the simulation are set in problem generator called from main
 
-  // Coords has host and device objects
+  // Coords has host and device objects, recycled blocks keep their device storage
   coords = Coordinates_t(block_size, pin);
-  coords_device = ParArray0D<Coordinates_t>("coords on device");
+  if (!coords_device.is_allocated())
+    coords_device = ParArray0D<Coordinates_t>("coords on device");
   auto coords_host_mirror = Kokkos::create_mirror_view(coords_device);
   coords_host_mirror() = coords;
   Kokkos::deep_copy(coords_device, coords_host_mirror);
@@ -201,6 +203,28 @@ void MeshBlock::Initialize(int igid, int ilid, LogicalLocation iloc,
 
 MeshBlock::~MeshBlock() = default;
 
+void MeshBlock::Retire() {
+  // Variables give their storage back to the pool of their type
+  meshblock_data = DataCollection<MeshBlockData<Real>>();
+  vars_cc_.clear();
+  pmr.reset();
+  pbswarm.reset();
+  app.reset();
+  neighbors.clear();
+  gmg_coarser_neighbors.clear();
+  gmg_composite_finer_neighbors.clear();
+  gmg_same_neighbors.clear();
+  gmg_finer_neighbors.clear();
+  gmg_leaf_neighbors.clear();
+  ProblemGenerator = nullptr;
+  PostInitialization = nullptr;
+  InitApplicationMeshBlockData = nullptr;
+  InitMeshBlockUserData = nullptr;
+  UserWorkBeforeOutput = nullptr;
+  mem_usage_ = 0;
+  coarse_buffers_allocated_ = true;
+}
+
 void MeshBlock::InitializeIndexShapesImpl(const int nx1, const int nx2, const int nx3,
                                           bool init_coarse, bool multilevel) {
   cellbounds = IndexShape(nx3, nx2, nx1, Globals::nghost);
@@ -237,11 +261,33 @@ void MeshBlock::InitializeIndexShapes(const int nx1, const int nx2, const int nx
 
 void MeshBlock::SetCostForLoadBalancing(double cost) {
   if (pmy_mesh->lb_manual_) {
-    cost_ = std::min(cost, TINY_NUMBER);
+    cost_ = std::max(cost, TINY_NUMBER);
     pmy_mesh->lb_flag_ = true;
   }
 }
 
+//----------------------------------------------------------------------------------------
+//! \fn void MeshBlock::AddCostForLoadBalancing(double cost)
+//  \brief accumulate a measured cost for automatic load balancing
+
+void MeshBlock::AddCostForLoadBalancing(double cost) {
+  if (pmy_mesh->lb_automatic_) cost_ += cost;
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn double MeshBlock::GetParticleCost()
+//  \brief load balancing cost of the particles held by the swarms of the block
+
+double MeshBlock::GetParticleCost() {
+  double cost = 0.0;
+  auto &swarm_data = meshblock_data.Get()->GetSwarmData();
+  if (swarm_data == nullptr) return cost;
+  for (const auto &swarm : swarm_data->GetSwarmVector()) {
+    cost += resolved_packages->GetSwarmCost(swarm->label()) * swarm->GetNumActive();
+  }
+  return cost;
+}
+
 //----------------------------------------------------------------------------------------
 //! \fn void MeshBlock::ResetTimeMeasurement()
 //  \brief reset the MeshBlock cost for automatic load balancing
@@ -344,4 +390,34 @@ void MeshBlock::DeallocateSparse(std::string const &label) {
   }
 }
 
+void MeshBlock::SetCoarseBuffersAllocated(const bool allocate) {
+  if (allocate == coarse_buffers_allocated_) return;
+  coarse_buffers_allocated_ = allocate;
+
+  auto &base = meshblock_data.Get();
+  for (auto &v : base->GetVariableVector()) {
+    if (!v->IsAllocated() || !v->UsesCoarseBuffer()) continue;
+    if (allocate) {
+      v->AllocateCoarse(shared_from_this());
+    } else {
+      LogMemUsage(-v->ReleaseCoarse());
+    }
+    // the coarse buffer changed, so packs and boundary info containing it are rebuilt
+    ++v->num_alloc_;
+  }
+
+  // variables copied to other stages share the coarse buffer of the base stage
+  for (auto &[stage, mbd] : meshblock_data.Stages()) {
+    if (mbd == base || mbd->IsShallow()) continue;
+    for (auto &v : mbd->GetVariableVector()) {
+      if (!v->IsAllocated() || !v->UsesCoarseBuffer() || !base->HasVariable(v->label()))
+        continue;
+      auto base_var = base->GetVarPtr(v->label());
+      if (v == base_var) continue;
+      v->CopyFluxesAndBdryVar(base_var.get());
+      ++v->num_alloc_;
+    }
+  }
+}
+
 } // namespace parthenon
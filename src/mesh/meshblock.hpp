@@ -186,6 +186,10 @@ class MeshBlock : public std::enable_shared_from_this<MeshBlock> {
   // functions
   // Load balancing
   void SetCostForLoadBalancing(double cost);
+  // Accumulate measured wall time when timing based load balancing is enabled
+  void AddCostForLoadBalancing(double cost);
+  // Sum of the active particles of all swarms weighted by their StateDescriptor cost
+  double GetParticleCost();
 
   // Memory usage
   // TODO(JMM): Currently swarm send/receive boundaries are not counted.
@@ -210,6 +214,12 @@ class MeshBlock : public std::enable_shared_from_this<MeshBlock> {
 
   void DeallocateSparse(std::string const &label);
 
+  // The coarse buffers of the variables are allocated on all blocks of a multilevel mesh
+  // unless <parthenon/mesh> lazy_coarse_buffers is set, in which case they are only kept
+  // on blocks with coarser neighbors, see Mesh::UpdateCoarseBuffers
+  bool CoarseBuffersAllocated() const { return coarse_buffers_allocated_; }
+  void SetCoarseBuffersAllocated(bool allocate);
+
 #ifdef ENABLE_SPARSE
   inline bool IsAllocated(std::string const &label) const noexcept {
     return meshblock_data.Get()->IsAllocated(label);
@@ -433,6 +443,10 @@ class MeshBlock : public std::enable_shared_from_this<MeshBlock> {
                   std::shared_ptr<StateDescriptor> resolved_packages, int igflag,
                   double icost = 1.0);
 
+  // Drop the data, refinement and boundary objects, and neighbors of the block, so that
+  // Initialize can set it up again for another block (see Mesh::MakeMeshBlock_)
+  void Retire();
+
   void InitializeIndexShapesImpl(const int nx1, const int nx2, const int nx3,
                                  bool init_coarse, bool multilevel);
   void InitializeIndexShapes(const int nx1, const int nx2, const int nx3);
@@ -457,17 +471,22 @@ class MeshBlock : public std::enable_shared_from_this<MeshBlock> {
 
   // memory usage on a block
   std::uint64_t mem_usage_;
+
+  bool coarse_buffers_allocated_ = true;
 };
 
 using BlockList_t = std::vector<std::shared_ptr<MeshBlock>>;
 
 struct BlockListPartition {
-  BlockListPartition(int p, GridIdentifier g, const BlockList_t &bl, Mesh *pm)
-      : partition{p}, grid{g}, block_list{bl}, pmesh{pm} {}
+  BlockListPartition(int p, GridIdentifier g, const BlockList_t &bl, Mesh *pm,
+                     DevExecSpace space = DevExecSpace())
+      : partition{p}, grid{g}, block_list{bl}, pmesh{pm}, exec_space{space} {}
   const int partition;
   const GridIdentifier grid;
   const BlockList_t block_list;
   Mesh *pmesh;
+  // execution space instance that kernels operating on the partition are launched on
+  const DevExecSpace exec_space;
 };
 
 } // namespace parthenon
@@ -21,6 +21,7 @@
 #include <cstdlib>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -47,6 +48,17 @@ namespace parthenon {
 
 using namespace OutputUtils;
 
+#ifdef PARTHENON_ENABLE_ASCENT
+struct AscentOutput::Cache {
+  ascent::Ascent ascent;
+  conduit::Node root;         // mesh description, see AscentOutput::WriteOutputFile
+  std::size_t generation = 0; // block list generation the description is for
+  bool valid = false;
+};
+#else
+struct AscentOutput::Cache {};
+#endif // ifdef PARTHENON_ENABLE_ASCENT
+
 //----------------------------------------------------------------------------------------
 //! \fn void AscentOutput:::WriteOutputFile(Mesh *pm)
 //  \brief  Expose mesh and all Cell variables for processing with Ascent
@@ -63,23 +75,34 @@ void AscentOutput::WriteOutputFile(Mesh *pm, ParameterInput *pin, SimTime *tm,
 
   using conduit::Node;
 
-  // Ascent needs the MPI communicator we are using
-  ascent::Ascent ascent;
-  Node ascent_opts;
-  ascent_opts["mpi_comm"] = MPI_Comm_c2f(MPI_COMM_WORLD);
-  ascent_opts["actions_file"] = pin->GetString(output_params.block_name, "actions_file");
-  // Only publish fields that are used within actions to reduce memory footprint.
-  // A user might need to override this, e.g., in a runtime ascent_options.yaml, if
-  // the required fields cannot be resolved by Ascent.
-  // See https://ascent.readthedocs.io/en/latest/AscentAPI.html#field-filtering
-  // TODO(some in mid 2023) Reenable this as this currently only works in develop of
-  // Ascent and not in published release (expected in 0.9.1), see
-  // https://github.com/Alpine-DAV/ascent/pull/1109
-  // ascent_opts["field_filtering"] = "true";
-  ascent.open(ascent_opts);
-
-  // create root node for the whole mesh
-  Node root;
+  // The Ascent instance stays open between outputs and the coordinate sets and
+  // topologies of the blocks are only described again after the block list changed
+  const std::size_t generation = pm->GetBlockListGeneration();
+  if (cache_ == nullptr) {
+    cache_ = std::make_shared<Cache>();
+    // Ascent needs the MPI communicator we are using
+    Node ascent_opts;
+    ascent_opts["mpi_comm"] = MPI_Comm_c2f(MPI_COMM_WORLD);
+    ascent_opts["actions_file"] =
+        pin->GetString(output_params.block_name, "actions_file");
+    // Only publish fields that are used within actions to reduce memory footprint.
+    // A user might need to override this, e.g., in a runtime ascent_options.yaml, if
+    // the required fields cannot be resolved by Ascent.
+    // See https://ascent.readthedocs.io/en/latest/AscentAPI.html#field-filtering
+    // TODO(some in mid 2023) Reenable this as this currently only works in develop of
+    // Ascent and not in published release (expected in 0.9.1), see
+    // https://github.com/Alpine-DAV/ascent/pull/1109
+    // ascent_opts["field_filtering"] = "true";
+    cache_->ascent.open(ascent_opts);
+  }
+  const bool rebuild = !cache_->valid || cache_->generation != generation;
+  if (rebuild) {
+    cache_->root.reset();
+    cache_->generation = generation;
+    cache_->valid = true;
+  }
+  // root node for the whole mesh
+  Node &root = cache_->root;
 
   for (auto &pmb : pm->block_list) {
     // create a unique id for this MeshBlock
@@ -87,7 +110,6 @@ void AscentOutput::WriteOutputFile(Mesh *pm, ParameterInput *pin, SimTime *tm,
     Node &mesh = root[meshblock_name];
 
     // add basic state info
-    mesh["state/domain_id"] = pmb->gid;
     mesh["state/cycle"] = tm->ncycle;
     mesh["state/time"] = tm->time;
 
@@ -100,60 +122,58 @@ void AscentOutput::WriteOutputFile(Mesh *pm, ParameterInput *pin, SimTime *tm,
     auto nk = kb.e - kb.s + 1;
     uint64_t ncells = ni * nj * nk;
 
-    auto ib_int = bounds.GetBoundsI(IndexDomain::interior);
-    auto jb_int = bounds.GetBoundsJ(IndexDomain::interior);
-    auto kb_int = bounds.GetBoundsK(IndexDomain::interior);
-
-    auto &coords = pmb->coords;
-    Real dx1 = coords.CellWidth<X1DIR>(ib.s, jb.s, kb.s);
-    Real dx2 = coords.CellWidth<X2DIR>(ib.s, jb.s, kb.s);
-    Real dx3 = coords.CellWidth<X3DIR>(ib.s, jb.s, kb.s);
-    std::array<Real, 3> corner = coords.GetXmin();
-
-    // create the coordinate set
-    mesh["coordsets/coords/type"] = "uniform";
-    PARTHENON_REQUIRE_THROWS(typeid(Coordinates_t) == typeid(UniformCartesian),
-                             "Ascent currently only supports Cartesian coordinates.");
-
-    mesh["coordsets/coords/dims/i"] = ni + 1;
-    mesh["coordsets/coords/dims/j"] = nj + 1;
-    if (nk > 1) {
-      mesh["coordsets/coords/dims/k"] = nk + 1;
-    }
+    if (rebuild) {
+      mesh["state/domain_id"] = pmb->gid;
 
-    // add origin and spacing to the coordset (optional)
-    mesh["coordsets/coords/origin/x"] = corner[0];
-    mesh["coordsets/coords/origin/y"] = corner[1];
-    if (nk > 1) {
-      mesh["coordsets/coords/origin/z"] = corner[2];
-    }
+      auto &coords = pmb->coords;
+      Real dx1 = coords.CellWidth<X1DIR>(ib.s, jb.s, kb.s);
+      Real dx2 = coords.CellWidth<X2DIR>(ib.s, jb.s, kb.s);
+      Real dx3 = coords.CellWidth<X3DIR>(ib.s, jb.s, kb.s);
+      std::array<Real, 3> corner = coords.GetXmin();
 
-    mesh["coordsets/coords/spacing/dx"] = dx1;
-    mesh["coordsets/coords/spacing/dy"] = dx2;
-    if (nk > 1) {
-      mesh["coordsets/coords/spacing/dz"] = dx3;
-    }
+      // create the coordinate set
+      mesh["coordsets/coords/type"] = "uniform";
+      PARTHENON_REQUIRE_THROWS(typeid(Coordinates_t) == typeid(UniformCartesian),
+                               "Ascent currently only supports Cartesian coordinates.");
 
-    // add the topology
-    mesh["topologies/topo/type"] = "uniform";
-    mesh["topologies/topo/coordset"] = "coords";
+      mesh["coordsets/coords/dims/i"] = ni + 1;
+      mesh["coordsets/coords/dims/j"] = nj + 1;
+      if (nk > 1) {
+        mesh["coordsets/coords/dims/k"] = nk + 1;
+      }
 
-    // indicate ghost zones with ascent_ghosts set to 1
-    Node &n_field = mesh["fields/ascent_ghosts"];
-    n_field["association"] = "element";
-    n_field["topology"] = "topo";
+      // add origin and spacing to the coordset (optional)
+      mesh["coordsets/coords/origin/x"] = corner[0];
+      mesh["coordsets/coords/origin/y"] = corner[1];
+      if (nk > 1) {
+        mesh["coordsets/coords/origin/z"] = corner[2];
+      }
+
+      mesh["coordsets/coords/spacing/dx"] = dx1;
+      mesh["coordsets/coords/spacing/dy"] = dx2;
+      if (nk > 1) {
+        mesh["coordsets/coords/spacing/dz"] = dx3;
+      }
+
+      // add the topology
+      mesh["topologies/topo/type"] = "uniform";
+      mesh["topologies/topo/coordset"] = "coords";
+    }
 
     // allocate ghost mask if not already done
     if (ghost_mask_.data() == nullptr) {
       ghost_mask_ = ParArray1D<Real>("Ascent ghost mask", ncells);
 
+      auto ib_int = bounds.GetBoundsI(IndexDomain::interior);
+      auto jb_int = bounds.GetBoundsJ(IndexDomain::interior);
+      auto kb_int = bounds.GetBoundsK(IndexDomain::interior);
       const int njni = nj * ni;
       auto &ghost_mask = ghost_mask_; // redef to lambda capture class member
       pmb->par_for(
           PARTHENON_AUTO_LABEL, 0, ncells - 1, KOKKOS_LAMBDA(const int &idx) {
             const int k = idx / (njni);
             const int j = (idx - k * njni) / ni;
-            const int i = idx - k * njni - j * nj;
+            const int i = idx - k * njni - j * ni;
 
             if ((i < ib_int.s) || (ib_int.e < i) || (j < jb_int.s) || (jb_int.e < j) ||
                 ((nk > 1) && ((k < kb_int.s) || (kb_int.e < k)))) {
@@ -163,7 +183,15 @@ void AscentOutput::WriteOutputFile(Mesh *pm, ParameterInput *pin, SimTime *tm,
             }
           });
     }
-    // Set ghost mask
+
+    // The fields point to the (device) data of the variables, which may have been
+    // reallocated since the last output, so they are always described again
+    if (mesh.has_child("fields")) mesh.remove("fields");
+
+    // indicate ghost zones with ascent_ghosts set to 1
+    Node &n_field = mesh["fields/ascent_ghosts"];
+    n_field["association"] = "element";
+    n_field["topology"] = "topo";
     n_field["values"].set_external(ghost_mask_.data(), ncells);
 
     // create a field for each component of each variable pack
@@ -188,24 +216,29 @@ void AscentOutput::WriteOutputFile(Mesh *pm, ParameterInput *pin, SimTime *tm,
     }
   }
 
-  // make sure we conform:
-  Node verify_info;
-  if (!conduit::blueprint::mesh::verify(root, verify_info)) {
-    if (parthenon::Globals::my_rank == 0) {
-      PARTHENON_WARN("Ascent output: blueprint::mesh::verify failed!");
+  // make sure we conform, which only needs to be checked again for a new mesh
+  if (rebuild) {
+    Node verify_info;
+    if (!conduit::blueprint::mesh::verify(root, verify_info)) {
+      if (parthenon::Globals::my_rank == 0) {
+        PARTHENON_WARN("Ascent output: blueprint::mesh::verify failed!");
+      }
+      verify_info.print();
     }
-    verify_info.print();
   }
-  ascent.publish(root);
+  cache_->ascent.publish(root);
 
   // Create dummy action as we need to "execute" to override the actions defined in the
   // yaml file.
   Node actions;
   // execute the actions
-  ascent.execute(actions);
+  cache_->ascent.execute(actions);
 
-  // close ascent
-  ascent.close();
+  // close ascent after the final output, before MPI is finalized
+  if (signal == SignalHandler::OutputSignal::final) {
+    cache_->ascent.close();
+    cache_.reset();
+  }
 #endif // ifndef PARTHENON_ENABLE_ASCENT
 
   // advance output parameters
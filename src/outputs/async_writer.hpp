@@ -0,0 +1,69 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef OUTPUTS_ASYNC_WRITER_HPP_
+#define OUTPUTS_ASYNC_WRITER_HPP_
+//! \file async_writer.hpp
+//  \brief Background thread that finishes writing output files
+
+#include <exception>
+#include <functional>
+#include <thread>
+#include <utility>
+
+namespace parthenon {
+
+// Runs at most one output job at a time on a background thread, so that the simulation
+// can continue while a staged output is written to disk. There is a single instance
+// shared by all outputs, since the HDF5 library must not be called from several threads
+// at once, so everything that uses HDF5 has to Wait() for the job in flight first.
+class AsyncWriter {
+ public:
+  static AsyncWriter &Instance() {
+    static AsyncWriter writer;
+    return writer;
+  }
+
+  AsyncWriter(const AsyncWriter &) = delete;
+  AsyncWriter &operator=(const AsyncWriter &) = delete;
+  ~AsyncWriter() {
+    if (thread_.joinable()) thread_.join();
+  }
+
+  // Block until the job in flight (if any) is done, rethrowing its exception
+  void Wait() {
+    if (thread_.joinable()) thread_.join();
+    if (error_) std::rethrow_exception(std::exchange(error_, nullptr));
+  }
+
+  // Wait for the previous job and run job on the background thread
+  void Submit(std::function<void()> job) {
+    Wait();
+    thread_ = std::thread([this, job = std::move(job)]() {
+      try {
+        job();
+      } catch (...) {
+        error_ = std::current_exception();
+      }
+    });
+  }
+
+ private:
+  AsyncWriter() = default;
+
+  std::thread thread_;
+  std::exception_ptr error_;
+};
+
+} // namespace parthenon
+
+#endif // OUTPUTS_ASYNC_WRITER_HPP_
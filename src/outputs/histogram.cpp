@@ -44,8 +44,10 @@
 // Parthenon headers
 #include "coordinates/coordinates.hpp"
 #include "defs.hpp"
+#include "interface/variable_pack.hpp"
 #include "interface/variable_state.hpp"
 #include "mesh/mesh.hpp"
+#include "outputs/async_writer.hpp"
 #include "outputs/output_utils.hpp"
 #include "outputs/outputs.hpp"
 #include "outputs/parthenon_hdf5.hpp"
@@ -203,13 +205,6 @@ Histogram::Histogram(ParameterInput *pin, const std::string &block_name,
                              "Negative component indices are not supported");
   }
 
-  const auto nxbins = x_edges_.extent_int(0) - 1;
-  const auto nybins = ndim_ == 2 ? y_edges_.extent_int(0) - 1 : 1;
-
-  result_ = ParArray2D<Real>(prefix + "result", nybins, nxbins);
-  scatter_result =
-      Kokkos::Experimental::ScatterView<Real **, LayoutWrapper>(result_.KokkosView());
-
   accumulate_ = pin->GetOrAddBoolean(block_name, prefix + "accumulate", false);
   weight_by_vol_ = pin->GetOrAddBoolean(block_name, prefix + "weight_by_volume", false);
 
@@ -225,176 +220,196 @@ Histogram::Histogram(ParameterInput *pin, const std::string &block_name,
   }
 }
 
-// Computes a 1D or 2D histogram with inclusive lower edges and inclusive rightmost edges.
-// Function could in principle be templated on dimension, but it's currently not expected
-// to be a performance concern (because it won't be called that often).
-void Histogram::CalcHist(Mesh *pm) {
-  Kokkos::Profiling::pushRegion("Calculate single histogram");
-  const auto x_var_component = x_var_component_;
-  const auto y_var_component = y_var_component_;
-  const auto binned_var_component = binned_var_component_;
-  const auto weight_var_component = weight_var_component_;
-  const auto x_var_type = x_var_type_;
-  const auto y_var_type = y_var_type_;
-  const auto x_edges = x_edges_;
-  const auto y_edges = y_edges_;
-  const auto x_edges_type = x_edges_type_;
-  const auto y_edges_type = y_edges_type_;
-  const auto x_edge_min = x_edge_min_;
-  const auto x_edge_dbin = x_edge_dbin_;
-  const auto y_edge_min = y_edge_min_;
-  const auto y_edge_dbin = y_edge_dbin_;
-  const auto hist_ndim = ndim_;
-  const auto weight_by_vol = weight_by_vol_;
-  const auto accumulate = accumulate_;
-  auto result = result_;
-  auto scatter = scatter_result;
+int Histogram::NumBins() const {
+  const auto nxbins = x_edges_.extent_int(0) - 1;
+  const auto nybins = ndim_ == 2 ? y_edges_.extent_int(0) - 1 : 1;
+  return nxbins * nybins;
+}
 
-  // Reset ScatterView from previous output
-  scatter.reset();
-  // Also reset the histogram from previous call.
-  // Currently still required for consistent results between host and device backends, see
-  // https://github.com/kokkos/kokkos/issues/6363
-  Kokkos::deep_copy(result, 0);
+namespace {
+// Everything the histogram kernel needs to know about a single histogram, with the
+// variables given by their index in the pack of all variables used by the histograms
+// (-1 if unused) and the edges by their offset in the concatenated edges
+struct HistParams {
+  int ndim;
+  VarType x_var_type, y_var_type;
+  int x_var_idx, y_var_idx, binned_var_idx, weight_var_idx;
+  EdgeType x_edges_type, y_edges_type;
+  int x_edges_offset, y_edges_offset, nx_edges, ny_edges;
+  Real x_edge_min, x_edge_dbin, y_edge_min, y_edge_dbin;
+  bool accumulate, weight_by_vol;
+  int result_offset;
+};
+
+// Edges of one histogram in the concatenated edges of all histograms, as required by
+// upper_bound
+struct EdgeSpan {
+  const Real *edges;
+  int n;
+  KOKKOS_INLINE_FUNCTION int extent_int(const int) const { return n; }
+  KOKKOS_INLINE_FUNCTION Real operator()(const int i) const { return edges[i]; }
+};
+
+template <typename Pack, typename Coords>
+KOKKOS_INLINE_FUNCTION Real GetValue(const VarType var_type, const int var_idx,
+                                     const Pack &pack, const Coords &coords, const int b,
+                                     const int k, const int j, const int i) {
+  if (var_type == VarType::X1) {
+    return coords.template Xc<1>(k, j, i);
+  } else if (var_type == VarType::X2) {
+    return coords.template Xc<2>(k, j, i);
+  } else if (var_type == VarType::X3) {
+    return coords.template Xc<3>(k, j, i);
+  } else if (var_type == VarType::R) {
+    return Kokkos::sqrt(SQR(coords.template Xc<1>(k, j, i)) +
+                        SQR(coords.template Xc<2>(k, j, i)) +
+                        SQR(coords.template Xc<3>(k, j, i)));
+  }
+  return pack(b, var_idx, k, j, i);
+}
+
+// Bin of val with inclusive lower edges and inclusive rightmost edge, or -1 if val is
+// outside of the edges and not accumulated in the outermost bins
+KOKKOS_INLINE_FUNCTION int GetBin(const Real val, const EdgeSpan &edges,
+                                  const EdgeType edges_type, const Real edge_min,
+                                  const Real edge_dbin, const bool accumulate) {
+  const int nedges = edges.extent_int(0);
+  // First handle edge cases explicitly
+  if (val < edges(0)) {
+    return accumulate ? 0 : -1;
+  } else if (val > edges(nedges - 1)) {
+    return accumulate ? nedges - 2 : -1;
+    // if we're on the rightmost edge, directly set last bin
+  } else if (val == edges(nedges - 1)) {
+    return nedges - 2;
+  }
+  // for lin and log directly pick index
+  if (edges_type == EdgeType::Lin) {
+    return static_cast<int>((val - edge_min) / edge_dbin);
+  } else if (edges_type == EdgeType::Log) {
+    return static_cast<int>((Kokkos::log10(val) - edge_min) / edge_dbin);
+  }
+  // otherwise search
+  return upper_bound(edges, val) - 1;
+}
+} // namespace
+
+} // namespace HistUtil
 
-  for (auto partition : pm->GetDefaultBlockPartitions()) {
-    auto &md = pm->mesh_data.Add("base", partition);
+//----------------------------------------------------------------------------------------
+//! \fn void HistogramOutput:::CalcHistograms_(Mesh *pm)
+//  \brief Computes all 1D and 2D histograms of this output with inclusive lower edges
+//  and inclusive rightmost edges. Every cell is visited once for all histograms and all
+//  results share a single scatter view and a single MPI reduction.
+void HistogramOutput::CalcHistograms_(Mesh *pm) {
+  using namespace HistUtil;
+  Kokkos::Profiling::pushRegion("Calculate all histograms");
+  const int nhist = histograms_.size();
 
-    const auto x_var_pack_string = x_var_type == VarType::Var
-                                       ? std::vector<std::string>{x_var_name_}
-                                       : std::vector<std::string>{};
-    const auto x_var = md->PackVariables(x_var_pack_string);
+  // All variables used by any of the histograms, packed once per partition
+  std::vector<std::string> var_names;
+  const auto add_var = [&](const std::string &name, const bool used) {
+    if (used && std::find(var_names.begin(), var_names.end(), name) == var_names.end()) {
+      var_names.push_back(name);
+    }
+  };
+  for (const auto &hist : histograms_) {
+    add_var(hist.x_var_name_, hist.x_var_type_ == VarType::Var);
+    add_var(hist.y_var_name_, hist.y_var_type_ == VarType::Var);
+    add_var(hist.binned_var_name_, hist.binned_var_component_ != -1);
+    add_var(hist.weight_var_name_, hist.weight_var_component_ != -1);
+  }
 
-    const auto y_var_pack_string = y_var_type == VarType::Var
-                                       ? std::vector<std::string>{y_var_name_}
-                                       : std::vector<std::string>{};
-    const auto y_var = md->PackVariables(y_var_pack_string);
+  ParArray1D<HistParams> params("HistogramOutput::params", nhist);
+  auto params_h = params.GetHostMirror();
 
-    const auto binned_var_pack_string = binned_var_component == -1
-                                            ? std::vector<std::string>{}
-                                            : std::vector<std::string>{binned_var_name_};
-    const auto binned_var = md->PackVariables(binned_var_pack_string);
+  auto results = results_;
+  auto scatter = scatter_results_;
+  const Real *edges = edges_.data();
 
-    const auto weight_var_pack_string = weight_var_component == -1
-                                            ? std::vector<std::string>{}
-                                            : std::vector<std::string>{weight_var_name_};
-    const auto weight_var = md->PackVariables(weight_var_pack_string);
+  // Reset ScatterView from previous output
+  scatter.reset();
+  // Also reset the histograms from previous call.
+  // Currently still required for consistent results between host and device backends, see
+  // https://github.com/kokkos/kokkos/issues/6363
+  Kokkos::deep_copy(results.KokkosView(), 0);
+
+  const auto base = pm->mesh_data.GetStageHandle("base");
+  const int npartitions = pm->GetDefaultBlockPartitions().size();
+  for (int ipart = 0; ipart < npartitions; ++ipart) {
+    auto &md = pm->mesh_data.GetOrAdd(base, ipart);
+
+    PackIndexMap imap;
+    const auto pack = md->PackVariables(var_names, imap);
+    const auto index_of = [&](const std::string &name, const int component) {
+      return component < 0 ? -1 : imap.get(name).first + component;
+    };
+
+    int edges_offset = 0;
+    for (int h = 0; h < nhist; ++h) {
+      const auto &hist = histograms_[h];
+      auto &p = params_h(h);
+      p.ndim = hist.ndim_;
+      p.x_var_type = hist.x_var_type_;
+      p.y_var_type = hist.y_var_type_;
+      p.x_var_idx = index_of(hist.x_var_name_, hist.x_var_component_);
+      p.y_var_idx = index_of(hist.y_var_name_, hist.y_var_component_);
+      p.binned_var_idx = index_of(hist.binned_var_name_, hist.binned_var_component_);
+      p.weight_var_idx = index_of(hist.weight_var_name_, hist.weight_var_component_);
+      p.x_edges_type = hist.x_edges_type_;
+      p.y_edges_type = hist.y_edges_type_;
+      p.nx_edges = hist.x_edges_.extent_int(0);
+      p.ny_edges = hist.y_edges_.extent_int(0);
+      p.x_edges_offset = edges_offset;
+      p.y_edges_offset = edges_offset + p.nx_edges;
+      edges_offset += p.nx_edges + p.ny_edges;
+      p.x_edge_min = hist.x_edge_min_;
+      p.x_edge_dbin = hist.x_edge_dbin_;
+      p.y_edge_min = hist.y_edge_min_;
+      p.y_edge_dbin = hist.y_edge_dbin_;
+      p.accumulate = hist.accumulate_;
+      p.weight_by_vol = hist.weight_by_vol_;
+      p.result_offset = hist.result_offset_;
+    }
+    params.DeepCopy(params_h);
 
     const auto ib = md->GetBoundsI(IndexDomain::interior);
     const auto jb = md->GetBoundsJ(IndexDomain::interior);
     const auto kb = md->GetBoundsK(IndexDomain::interior);
 
     parthenon::par_for(
-        "CalcHist", 0, md->NumBlocks() - 1, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+        "CalcHistograms", 0, md->NumBlocks() - 1, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
         KOKKOS_LAMBDA(const int b, const int k, const int j, const int i) {
-          auto &coords = x_var.GetCoords(b);
-          auto x_val = std::numeric_limits<Real>::quiet_NaN();
-          if (x_var_type == VarType::X1) {
-            x_val = coords.Xc<1>(k, j, i);
-          } else if (x_var_type == VarType::X2) {
-            x_val = coords.Xc<2>(k, j, i);
-          } else if (x_var_type == VarType::X3) {
-            x_val = coords.Xc<3>(k, j, i);
-          } else if (x_var_type == VarType::R) {
-            x_val = Kokkos::sqrt(SQR(coords.Xc<1>(k, j, i)) + SQR(coords.Xc<2>(k, j, i)) +
-                                 SQR(coords.Xc<3>(k, j, i)));
-          } else {
-            x_val = x_var(b, x_var_component, k, j, i);
-          }
-
-          int x_bin = -1;
-          // First handle edge cases explicitly
-          if (x_val < x_edges(0)) {
-            if (accumulate) {
-              x_bin = 0;
-            } else {
-              return;
-            }
-          } else if (x_val > x_edges(x_edges.extent_int(0) - 1)) {
-            if (accumulate) {
-              x_bin = x_edges.extent_int(0) - 2;
-            } else {
-              return;
-            }
-            // if we're on the rightmost edge, directly set last bin
-          } else if (x_val == x_edges(x_edges.extent_int(0) - 1)) {
-            x_bin = x_edges.extent_int(0) - 2;
-          } else {
-            // for lin and log directly pick index
-            if (x_edges_type == EdgeType::Lin) {
-              x_bin = static_cast<int>((x_val - x_edge_min) / x_edge_dbin);
-            } else if (x_edges_type == EdgeType::Log) {
-              x_bin = static_cast<int>((Kokkos::log10(x_val) - x_edge_min) / x_edge_dbin);
-              // otherwise search
-            } else {
-              x_bin = upper_bound(x_edges, x_val) - 1;
-            }
-          }
-          PARTHENON_DEBUG_REQUIRE(x_bin >= 0, "Bin not found");
-
-          // needs to be zero as for the 1D histogram we need 0 as first index of the 2D
-          // result array
-          int y_bin = 0;
-          if (hist_ndim == 2) {
-            auto y_val = std::numeric_limits<Real>::quiet_NaN();
-            if (y_var_type == VarType::X1) {
-              y_val = coords.Xc<1>(k, j, i);
-            } else if (y_var_type == VarType::X2) {
-              y_val = coords.Xc<2>(k, j, i);
-            } else if (y_var_type == VarType::X3) {
-              y_val = coords.Xc<3>(k, j, i);
-            } else if (y_var_type == VarType::R) {
-              y_val =
-                  Kokkos::sqrt(SQR(coords.Xc<1>(k, j, i)) + SQR(coords.Xc<2>(k, j, i)) +
-                               SQR(coords.Xc<3>(k, j, i)));
-            } else {
-              y_val = y_var(b, y_var_component, k, j, i);
+          const auto &coords = pack.GetCoords(b);
+          auto res = scatter.access();
+          for (int h = 0; h < nhist; ++h) {
+            const auto &p = params(h);
+            const int x_bin = GetBin(
+                GetValue(p.x_var_type, p.x_var_idx, pack, coords, b, k, j, i),
+                EdgeSpan{edges + p.x_edges_offset, p.nx_edges}, p.x_edges_type,
+                p.x_edge_min, p.x_edge_dbin, p.accumulate);
+            if (x_bin < 0) continue;
+
+            // needs to be zero as for the 1D histogram there is a single row of bins
+            int y_bin = 0;
+            if (p.ndim == 2) {
+              y_bin = GetBin(
+                  GetValue(p.y_var_type, p.y_var_idx, pack, coords, b, k, j, i),
+                  EdgeSpan{edges + p.y_edges_offset, p.ny_edges}, p.y_edges_type,
+                  p.y_edge_min, p.y_edge_dbin, p.accumulate);
+              if (y_bin < 0) continue;
             }
 
-            y_bin = -1; // reset to impossible value
-            // First handle edge cases explicitly
-            if (y_val < y_edges(0)) {
-              if (accumulate) {
-                y_bin = 0;
-              } else {
-                return;
-              }
-            } else if (y_val > y_edges(y_edges.extent_int(0) - 1)) {
-              if (accumulate) {
-                y_bin = y_edges.extent_int(0) - 2;
-              } else {
-                return;
-              }
-              // if we're on the rightmost edge, directly set last bin
-            } else if (y_val == y_edges(y_edges.extent_int(0) - 1)) {
-              y_bin = y_edges.extent_int(0) - 2;
-            } else {
-              // for lin and log directly pick index
-              if (y_edges_type == EdgeType::Lin) {
-                y_bin = static_cast<int>((y_val - y_edge_min) / y_edge_dbin);
-              } else if (y_edges_type == EdgeType::Log) {
-                y_bin =
-                    static_cast<int>((Kokkos::log10(y_val) - y_edge_min) / y_edge_dbin);
-                // otherwise search
-              } else {
-                y_bin = upper_bound(y_edges, y_val) - 1;
-              }
-            }
-            PARTHENON_DEBUG_REQUIRE(y_bin >= 0, "Bin not found");
+            const Real val_to_add =
+                p.binned_var_idx == -1 ? 1.0 : pack(b, p.binned_var_idx, k, j, i);
+            Real weight = p.weight_by_vol ? coords.CellVolume(k, j, i) : 1.0;
+            weight *= p.weight_var_idx == -1 ? 1.0 : pack(b, p.weight_var_idx, k, j, i);
+            res(p.result_offset + y_bin * (p.nx_edges - 1) + x_bin) += val_to_add * weight;
           }
-          auto res = scatter.access();
-          const auto val_to_add = binned_var_component == -1
-                                      ? 1
-                                      : binned_var(b, binned_var_component, k, j, i);
-          auto weight = weight_by_vol ? coords.CellVolume(k, j, i) : 1.0;
-          weight *= weight_var_component == -1
-                        ? 1.0
-                        : weight_var(b, weight_var_component, k, j, i);
-          res(y_bin, x_bin) += val_to_add * weight;
         });
     // "reduce" results from scatter view to original view. May be a no-op depending on
     // backend.
-    Kokkos::Experimental::contribute(result.KokkosView(), scatter);
+    Kokkos::Experimental::contribute(results.KokkosView(), scatter);
   }
   // Ensure all (implicit) reductions from contribute are done
   Kokkos::fence(); // May not be required
@@ -402,18 +417,16 @@ void Histogram::CalcHist(Mesh *pm) {
   // Now reduce over ranks
 #ifdef MPI_PARALLEL
   if (Globals::my_rank == 0) {
-    PARTHENON_MPI_CHECK(MPI_Reduce(MPI_IN_PLACE, result.data(), result.size(),
+    PARTHENON_MPI_CHECK(MPI_Reduce(MPI_IN_PLACE, results.data(), results.size(),
                                    MPI_PARTHENON_REAL, MPI_SUM, 0, MPI_COMM_WORLD));
   } else {
-    PARTHENON_MPI_CHECK(MPI_Reduce(result.data(), result.data(), result.size(),
+    PARTHENON_MPI_CHECK(MPI_Reduce(results.data(), results.data(), results.size(),
                                    MPI_PARTHENON_REAL, MPI_SUM, 0, MPI_COMM_WORLD));
   }
 #endif
-  Kokkos::Profiling::popRegion(); // Calculate single histogram
+  Kokkos::Profiling::popRegion(); // Calculate all histograms
 }
 
-} // namespace HistUtil
-
 //----------------------------------------------------------------------------------------
 //! \fn void HistogramOutput:::SetupHistograms(ParameterInput *pin)
 //  \brief Process parameter input to setup persistent histograms
@@ -422,9 +435,28 @@ HistogramOutput::HistogramOutput(const OutputParameters &op, ParameterInput *pin
 
   hist_names_ = pin->GetVector<std::string>(op.block_name, "hist_names");
 
+  int nbins = 0;
+  std::vector<Real> edges;
   for (auto &hist_name : hist_names_) {
-    histograms_.emplace_back(pin, op.block_name, hist_name);
+    auto &hist = histograms_.emplace_back(pin, op.block_name, hist_name);
+    hist.result_offset_ = nbins;
+    nbins += hist.NumBins();
+    for (auto *hist_edges : {&hist.x_edges_, &hist.y_edges_}) {
+      const auto edges_h = hist_edges->GetHostMirrorAndCopy();
+      edges.insert(edges.end(), edges_h.data(), edges_h.data() + edges_h.size());
+    }
+  }
+
+  edges_ = ParArray1D<Real>("HistogramOutput::edges", edges.size());
+  auto edges_h = edges_.GetHostMirror();
+  for (int i = 0; i < edges.size(); i++) {
+    edges_h(i) = edges[i];
   }
+  edges_.DeepCopy(edges_h);
+
+  results_ = ParArray1D<Real>("HistogramOutput::results", nbins);
+  scatter_results_ =
+      Kokkos::Experimental::ScatterView<Real *, LayoutWrapper>(results_.KokkosView());
 }
 
 std::string HistogramOutput::GenerateFilename_(ParameterInput *pin, SimTime *tm,
@@ -457,16 +489,14 @@ std::string HistogramOutput::GenerateFilename_(ParameterInput *pin, SimTime *tm,
 //  \brief  Calculate histograms
 void HistogramOutput::WriteOutputFile(Mesh *pm, ParameterInput *pin, SimTime *tm,
                                       const SignalHandler::OutputSignal signal) {
-  Kokkos::Profiling::pushRegion("Calculate all histograms");
-  for (auto &hist : histograms_) {
-    hist.CalcHist(pm);
-  }
-  Kokkos::Profiling::popRegion(); // Calculate all histograms
+  CalcHistograms_(pm);
 
   Kokkos::Profiling::pushRegion("Dump histograms");
   // Given the expect size of histograms, we'll use serial HDF
   if (Globals::my_rank == 0) {
     using namespace HDF5;
+    // HDF5 must not be used while an asynchronous output is still being written
+    AsyncWriter::Instance().Wait();
     H5P const pl_xfer = H5P::FromHIDCheck(H5Pcreate(H5P_DATASET_XFER));
 
     // As we're reusing the interface from the existing hdf5 output,
@@ -500,6 +530,8 @@ void HistogramOutput::WriteOutputFile(Mesh *pm, ParameterInput *pin, SimTime *tm
     }
     HDF5WriteAttribute("hist_names", hist_names_, info_group);
 
+    const auto results_h = results_.GetHostMirrorAndCopy();
+
     for (auto &hist : histograms_) {
       const H5G hist_group = MakeGroup(file, "/" + hist.name_);
       HDF5WriteAttribute("ndim", hist.ndim_, hist_group);
@@ -523,21 +555,21 @@ void HistogramOutput::WriteOutputFile(Mesh *pm, ParameterInput *pin, SimTime *tm
                     local_count.data(), global_count.data(), pl_xfer);
       }
 
-      const auto hist_h = hist.result_.GetHostMirrorAndCopy();
-      // Ensure correct output format (as the data in Parthenon may, in theory, vary by
-      // changing the default view layout) so that it matches the numpy output  (row
-      // major, x first)
-      std::vector<Real> tmp_data(hist_h.size());
+      // The results are stored row major with x fastest, but the output uses the numpy
+      // ordering (row major, x first)
+      const int nxbins = hist.x_edges_.extent_int(0) - 1;
+      const int nybins = hist.ndim_ == 2 ? hist.y_edges_.extent_int(0) - 1 : 1;
+      std::vector<Real> tmp_data(nxbins * nybins);
       int idx = 0;
-      for (int i = 0; i < hist_h.extent_int(1); ++i) {
-        for (int j = 0; j < hist_h.extent_int(0); ++j) {
-          tmp_data[idx++] = hist_h(j, i);
+      for (int i = 0; i < nxbins; ++i) {
+        for (int j = 0; j < nybins; ++j) {
+          tmp_data[idx++] = results_h(hist.result_offset_ + j * nxbins + i);
         }
       }
 
-      local_count[0] = global_count[0] = hist_h.extent_int(1);
+      local_count[0] = global_count[0] = nxbins;
       if (hist.ndim_ == 2) {
-        local_count[1] = global_count[1] = hist_h.extent_int(0);
+        local_count[1] = global_count[1] = nybins;
 
         HDF5Write2D(hist_group, "data", tmp_data.data(), local_offset.data(),
                     local_count.data(), global_count.data(), pl_xfer);
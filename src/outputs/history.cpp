@@ -18,6 +18,8 @@
 //  \brief writes history output data, volume-averaged quantities that are output
 //         frequently in time to trace their history.
 
+#include <algorithm>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <iomanip>
@@ -27,11 +29,14 @@
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "coordinates/coordinates.hpp"
 #include "defs.hpp"
 #include "globals.hpp"
+#include "interface/variable_pack.hpp"
+#include "kokkos_abstraction.hpp"
 #include "mesh/mesh.hpp"
 #include "outputs/outputs.hpp"
 #include "parthenon_arrays.hpp"
@@ -39,6 +44,119 @@
 
 namespace parthenon {
 
+namespace {
+template <UserHistoryOperation OP>
+struct FieldReduction;
+
+template <>
+struct FieldReduction<UserHistoryOperation::sum> {
+  using reducer_t = Kokkos::Sum<Real>;
+  static Real Identity() { return Kokkos::reduction_identity<Real>::sum(); }
+  KOKKOS_INLINE_FUNCTION static void Join(Real &dst, const Real val) { dst += val; }
+  KOKKOS_INLINE_FUNCTION static void Combine(Real *dst, const Real val) {
+    Kokkos::atomic_add(dst, val);
+  }
+};
+
+template <>
+struct FieldReduction<UserHistoryOperation::max> {
+  using reducer_t = Kokkos::Max<Real>;
+  static Real Identity() { return Kokkos::reduction_identity<Real>::max(); }
+  KOKKOS_INLINE_FUNCTION static void Join(Real &dst, const Real val) {
+    dst = val > dst ? val : dst;
+  }
+  KOKKOS_INLINE_FUNCTION static void Combine(Real *dst, const Real val) {
+    Kokkos::atomic_max(dst, val);
+  }
+};
+
+template <>
+struct FieldReduction<UserHistoryOperation::min> {
+  using reducer_t = Kokkos::Min<Real>;
+  static Real Identity() { return Kokkos::reduction_identity<Real>::min(); }
+  KOKKOS_INLINE_FUNCTION static void Join(Real &dst, const Real val) {
+    dst = val < dst ? val : dst;
+  }
+  KOKKOS_INLINE_FUNCTION static void Combine(Real *dst, const Real val) {
+    Kokkos::atomic_min(dst, val);
+  }
+};
+
+// Evaluate all field reductions with operation OP in one kernel. Every team reduces one
+// field over one block and combines its result with those of the other blocks
+// atomically, so there is a single launch and a single copy back to the host no matter
+// how many fields are reduced.
+template <UserHistoryOperation OP>
+void ReduceHistoryFields(MeshData<Real> *md,
+                         const std::vector<const HistoryOutputField *> &fields,
+                         std::vector<Real> &results, std::vector<std::string> &labels) {
+  if (fields.empty()) return;
+  std::vector<std::string> names;
+  for (const auto *field : fields) {
+    if (std::find(names.begin(), names.end(), field->var_name) == names.end()) {
+      names.push_back(field->var_name);
+    }
+  }
+  PackIndexMap imap;
+  const auto &pack = md->PackVariables(names, imap);
+
+  const int nfields = fields.size();
+  ParArray1D<int> vidx("HistoryOutput::field_indices", nfields);
+  ParArray1D<int> weighted("HistoryOutput::field_weighted", nfields);
+  auto vidx_h = vidx.GetHostMirror();
+  auto weighted_h = weighted.GetHostMirror();
+  for (int n = 0; n < nfields; ++n) {
+    const auto &field = *fields[n];
+    const auto &[lo, hi] = imap.get(field.var_name);
+    PARTHENON_REQUIRE_THROWS(field.component >= 0 && lo + field.component <= hi,
+                             "Component " + std::to_string(field.component) +
+                                 " of history field \"" + field.var_name +
+                                 "\" does not exist");
+    vidx_h(n) = lo + field.component;
+    weighted_h(n) = field.volume_weighted;
+  }
+  vidx.DeepCopy(vidx_h);
+  weighted.DeepCopy(weighted_h);
+
+  ParArray1D<Real> result("HistoryOutput::field_results", nfields);
+  Kokkos::deep_copy(result.KokkosView(), FieldReduction<OP>::Identity());
+
+  const auto ib = md->GetBoundsI(IndexDomain::interior);
+  const auto jb = md->GetBoundsJ(IndexDomain::interior);
+  const auto kb = md->GetBoundsK(IndexDomain::interior);
+  const int ni = ib.e - ib.s + 1;
+  const int nj = jb.e - jb.s + 1;
+  const int ncells = ni * nj * (kb.e - kb.s + 1);
+  par_for_outer(
+      DEFAULT_OUTER_LOOP_PATTERN, "HistoryOutput::ReduceFields", DevExecSpace(), 0, 0, 0,
+      pack.GetDim(5) - 1, 0, nfields - 1,
+      KOKKOS_LAMBDA(team_mbr_t member, const int b, const int n) {
+        const int v = vidx(n);
+        if (!pack.IsAllocated(b, v)) return;
+        const auto &coords = pack.GetCoords(b);
+        Real lresult;
+        Kokkos::parallel_reduce(
+            Kokkos::TeamThreadRange(member, ncells),
+            [&](const int c, Real &lr) {
+              const int k = kb.s + c / (ni * nj);
+              const int j = jb.s + (c / ni) % nj;
+              const int i = ib.s + c % ni;
+              const Real vol = weighted(n) ? coords.CellVolume(k, j, i) : 1.0;
+              FieldReduction<OP>::Join(lr, pack(b, v, k, j, i) * vol);
+            },
+            typename FieldReduction<OP>::reducer_t(lresult));
+        Kokkos::single(Kokkos::PerTeam(member),
+                       [&]() { FieldReduction<OP>::Combine(&result(n), lresult); });
+      });
+
+  auto result_h = result.GetHostMirrorAndCopy();
+  for (int n = 0; n < nfields; ++n) {
+    results.push_back(result_h(n));
+    labels.push_back(fields[n]->label);
+  }
+}
+} // namespace
+
 //----------------------------------------------------------------------------------------
 //! \fn void OutputType::HistoryFile()
 //  \brief Writes a history file
@@ -92,6 +210,9 @@ void HistoryOutput::WriteOutputFile(Mesh *pm, ParameterInput *pin, SimTime *tm,
     md_base->Initialize(pm->block_list, pm);
   }
 
+  // Field reductions of all packages, evaluated together after the callbacks
+  std::map<UserHistoryOperation, std::vector<const HistoryOutputField *>> fields;
+
   // Loop over all packages of the application
   for (const auto &pkg : packages) {
     const auto &params = pkg.second->AllParams();
@@ -120,6 +241,43 @@ void HistoryOutput::WriteOutputFile(Mesh *pm, ParameterInput *pin, SimTime *tm,
         }
       }
     }
+
+    // Check if the package has enrolled field reductions which are stored in the Params
+    // under the `hist_field_param_key` name.
+    if (params.hasKey(hist_field_param_key)) {
+      for (const auto &hist_field : params.Get<HstField_list>(hist_field_param_key)) {
+        fields[hist_field.hst_op].push_back(&hist_field);
+      }
+    }
+  }
+
+  using Op = UserHistoryOperation;
+  ReduceHistoryFields<Op::sum>(md_base.get(), fields[Op::sum], results[Op::sum],
+                               labels[Op::sum]);
+  ReduceHistoryFields<Op::max>(md_base.get(), fields[Op::max], results[Op::max],
+                               labels[Op::max]);
+  ReduceHistoryFields<Op::min>(md_base.get(), fields[Op::min], results[Op::min],
+                               labels[Op::min]);
+
+  // Memory usage in MB summed over and maximized over ranks by the reductions below
+  if (output_params.memory_usage) {
+    constexpr Real MB = 1024. * 1024.;
+    const auto usage = pm->GetMemoryUsage();
+    const std::vector<std::pair<std::string, std::uint64_t>> columns = {
+        {"mem_variables", usage.variables},
+        {"mem_fluxes", usage.fluxes},
+        {"mem_coarse", usage.coarse_buffers},
+        {"mem_bnd_buffers", usage.boundary_buffers},
+        {"mem_var_pool", usage.variable_pool},
+        {"mem_swarms", usage.swarms},
+        {"mem_forest", usage.forest},
+        {"mem_total", usage.Total()}};
+    for (const auto &[label, bytes] : columns) {
+      results[UserHistoryOperation::sum].push_back(bytes / MB);
+      labels[UserHistoryOperation::sum].push_back(label);
+    }
+    results[UserHistoryOperation::max].push_back(usage.Total() / MB);
+    labels[UserHistoryOperation::max].push_back("mem_total_max_rank");
   }
 
 #ifdef MPI_PARALLEL
@@ -0,0 +1,86 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+//! \file insitu.cpp
+//  \brief Hand the variables of all blocks to an in situ consumer without copies
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <Kokkos_Core.hpp>
+
+#include "globals.hpp"
+#include "interface/meshblock_data.hpp"
+#include "mesh/mesh.hpp"
+#include "mesh/meshblock.hpp"
+#include "outputs/insitu.hpp"
+#include "outputs/output_utils.hpp"
+#include "outputs/outputs.hpp"
+#include "utils/error_checking.hpp"
+
+namespace parthenon {
+
+using namespace OutputUtils;
+
+//----------------------------------------------------------------------------------------
+//! \fn void InSituOutput:::WriteOutputFile(Mesh *pm)
+//  \brief Call the in situ consumer with the requested variables of all blocks
+void InSituOutput::WriteOutputFile(Mesh *pm, ParameterInput *pin, SimTime *tm,
+                                   const SignalHandler::OutputSignal signal) {
+  if (pm->InSituOutput == nullptr) {
+    if (Globals::my_rank == 0) {
+      PARTHENON_WARN("In situ output requested by input file, but no consumer is set "
+                     "in ApplicationInput::InSituOutput. Skipping this output.");
+    }
+  } else {
+    Kokkos::Profiling::pushRegion("InSituOutput::WriteOutputFile");
+    auto get_vars = [&](const std::shared_ptr<MeshBlock> &pmb) {
+      return GetAnyVariables(pmb->meshblock_data.Get()->GetVariableVector(),
+                             output_params.variables);
+    };
+
+    const auto &first_block = *(pm->block_list.front());
+    InSituData data;
+    data.params = &output_params;
+    data.time = tm;
+    data.var_info = VarInfo::GetAll(get_vars(pm->block_list.front()),
+                                    first_block.cellbounds, first_block.f_cellbounds);
+    data.blocks.reserve(pm->block_list.size());
+    for (const auto &pmb : pm->block_list) {
+      InSituBlock block{pmb, {}};
+      const auto vars = get_vars(pmb);
+      for (const auto &vinfo : data.var_info) {
+        auto it = std::find_if(vars.begin(), vars.end(),
+                               [&](const auto &v) { return v->label() == vinfo.label; });
+        block.variables.push_back(it != vars.end() && (*it)->IsAllocated() ? *it
+                                                                           : nullptr);
+      }
+      data.blocks.push_back(std::move(block));
+    }
+
+    // the consumer may read the data right away, also on the host
+    Kokkos::fence();
+    pm->InSituOutput(pm, data);
+    Kokkos::Profiling::popRegion(); // InSituOutput::WriteOutputFile
+  }
+
+  // advance output parameters
+  if (signal == SignalHandler::OutputSignal::none) {
+    output_params.file_number++;
+    output_params.next_time += output_params.dt;
+    pin->SetInteger(output_params.block_name, "file_number", output_params.file_number);
+    pin->SetReal(output_params.block_name, "next_time", output_params.next_time);
+  }
+}
+
+} // namespace parthenon
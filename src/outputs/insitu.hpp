@@ -0,0 +1,52 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef OUTPUTS_INSITU_HPP_
+#define OUTPUTS_INSITU_HPP_
+//! \file insitu.hpp
+//  \brief Data handed to in situ consumers by "insitu" outputs
+
+#include <memory>
+#include <vector>
+
+#include "basic_types.hpp"
+#include "interface/variable.hpp"
+#include "outputs/output_parameters.hpp"
+#include "outputs/output_utils.hpp"
+
+namespace parthenon {
+
+class MeshBlock;
+
+// The requested variables of a block, in the order of InSituData::var_info. These are
+// the variables of the simulation themselves, so their data are device views that are
+// neither copied nor moved to the host. Sparse variables that are not allocated on the
+// block are nullptr.
+struct InSituBlock {
+  std::shared_ptr<MeshBlock> pmb;
+  std::vector<std::shared_ptr<Variable<Real>>> variables;
+};
+
+// Everything an "insitu" output hands to ApplicationInput::InSituOutput. The consumer is
+// called on all ranks at the same time (so it may communicate, e.g., to stage the data
+// to analysis nodes) after all kernels are done. The data is only guaranteed to stay
+// unchanged while the consumer runs, so it has to copy whatever it needs later.
+struct InSituData {
+  const OutputParameters *params; // e.g., block_name to tell several outputs apart
+  const SimTime *time;            // nullptr outside of time evolution
+  std::vector<OutputUtils::VarInfo> var_info;
+  std::vector<InSituBlock> blocks; // all blocks of this rank
+};
+
+} // namespace parthenon
+
+#endif // OUTPUTS_INSITU_HPP_
@@ -18,13 +18,26 @@
 #ifndef OUTPUTS_OUTPUT_PARAMETERS_HPP_
 #define OUTPUTS_OUTPUT_PARAMETERS_HPP_
 
+#include <limits>
 #include <map>
 #include <set>
 #include <string>
 #include <vector>
 
+#include "basic_types.hpp"
+
 namespace parthenon {
 
+// Selection of the particles of a swarm that are written to an output. The selection
+// only depends on the values of the particles, so it is the same in every dump.
+struct SwarmSelection {
+  int subsample = 1; // keep particles for which subsample_variable % subsample == 0
+  std::string subsample_variable = "id";
+  std::string variable; // if set, also require min <= variable < max
+  Real min = std::numeric_limits<Real>::lowest();
+  Real max = std::numeric_limits<Real>::max();
+};
+
 //----------------------------------------------------------------------------------------
 //! \struct OutputParameters
 //  \brief  container for parameters read from <output> block in the input file
@@ -40,23 +53,59 @@ struct OutputParameters {
   std::vector<std::string> component_labels;
   std::map<std::string, std::set<std::string>> swarms;
   std::vector<std::string> swarm_vars;
+  std::map<std::string, SwarmSelection> swarm_selections; // by swarm, all if not listed
   std::string file_type;
   std::string data_format;
   std::vector<std::string> packages;
   Real next_time, dt;
+  int dcycle; // if positive, written every dcycle cycles instead of every dt
   int file_number;
   bool include_ghost_zones, cartesian_vector;
   bool single_precision_output;
+  bool half_precision_output; // store variables in half precision, implies single
   bool sparse_seed_nans;
   int hdf5_compression_level;
+  // none, deflate, zstd, lz4, blosc, zfp, or filter, optionally overridden per variable
+  std::string hdf5_compressor;
+  std::map<std::string, std::string> hdf5_variable_compressors;
+  Real hdf5_compression_tolerance;                 // absolute error bound of zfp
+  int hdf5_filter_id;                              // HDF5 filter used by "filter"
+  std::vector<unsigned int> hdf5_filter_cd_values; // and its parameters
   bool write_xdmf;
   bool write_swarm_xdmf;
+  bool memory_usage;          // add memory usage columns to history output
+  bool async_write;           // finish writing HDF5 files on a background thread
+  bool incremental;           // only write blocks changed since the last full restart
+  int incremental_full_every; // number of incremental restarts between full ones
+  std::string fast_dir;       // fast tier directory of restarts
+  int fast_flush_every;       // every how many restarts go to the regular location
+  bool emergency_flush;       // restarts triggered by signals go through the fast tier
+  bool raw_block_data;        // restart block data in per-rank binary files
+  bool hdf5_subfiling;        // write one subfile per node with the subfiling VFD
+  bool hdf5_group_variables;  // one dataset per group of variables of the same shape
+  // bytes written to a subfile at a time, 0 for the HDF5 default
+  int hdf5_subfiling_stripe_size;
+  // variables only written every so many outputs of the block (1 if not listed)
+  std::map<std::string, int> variable_every;
+  bool reuse_mesh_metadata; // link block metadata of earlier files of an unchanged mesh
+  // only blocks intersecting the box [region_xmin, region_xmax] (no bound in directions
+  // that are not given) on levels region_min_level to region_max_level (relative to the
+  // root grid) are written
+  std::vector<Real> region_xmin, region_xmax;
+  int region_min_level, region_max_level;
   // TODO(felker): some of the parameters in this class are not initialized in constructor
   OutputParameters()
-      : block_number(0), next_time(0.0), dt(-1.0), file_number(0),
+      : block_number(0), next_time(0.0), dt(-1.0), dcycle(0), file_number(0),
         include_ghost_zones(false), cartesian_vector(false),
-        single_precision_output(false), sparse_seed_nans(false),
-        hdf5_compression_level(5), write_xdmf(false), write_swarm_xdmf(false) {}
+        single_precision_output(false), half_precision_output(false),
+        sparse_seed_nans(false), hdf5_compression_level(5), hdf5_compressor("deflate"),
+        hdf5_compression_tolerance(0.0), hdf5_filter_id(0), write_xdmf(false),
+        write_swarm_xdmf(false), memory_usage(false), async_write(false),
+        incremental(false), incremental_full_every(10), fast_flush_every(10),
+        emergency_flush(false), raw_block_data(false), hdf5_subfiling(false),
+        hdf5_group_variables(false), hdf5_subfiling_stripe_size(0),
+        reuse_mesh_metadata(false), region_min_level(std::numeric_limits<int>::lowest()),
+        region_max_level(std::numeric_limits<int>::max()) {}
 };
 
 } // namespace parthenon
@@ -15,7 +15,9 @@
 // the public, perform publicly and display publicly, and to permit others to do so.
 //========================================================================================
 
+#include <limits>
 #include <map>
+#include <numeric>
 #include <set>
 #include <string>
 #include <type_traits>
@@ -138,21 +140,75 @@ std::vector<VarInfo> VarInfo::GetAll(const VariableVector<Real> &vars,
   return out;
 }
 
-void SwarmInfo::AddOffsets(const SP_Swarm &swarm) {
+namespace {
+// Stores the indices of the active particles of a defragmented swarm that pass the
+// selection, in order, in selected and returns their number
+template <typename T>
+int SelectParticles(const SP_Swarm &swarm, const SwarmSelection &selection,
+                    const ParArrayND<T> &values, ParArray1D<int> &selected) {
+  const int num_active = swarm->GetNumActive();
+  const int subsample = selection.subsample;
+  ParArrayND<int> ids;
+  if (subsample > 1) {
+    PARTHENON_REQUIRE_THROWS(swarm->Contains<int>(selection.subsample_variable),
+                             "Swarm " + swarm->label() + " has no integer variable " +
+                                 selection.subsample_variable + " to subsample by");
+    ids = swarm->Get<int>(selection.subsample_variable).Get();
+  }
+  const bool use_values = !selection.variable.empty();
+  const Real min = selection.min;
+  const Real max = selection.max;
+  selected = ParArray1D<int>("selected particles", num_active);
+  int num_selected = 0;
+  par_scan(
+      PARTHENON_AUTO_LABEL, 0, num_active - 1,
+      KOKKOS_LAMBDA(const int n, int &rank, const bool final) {
+        bool keep = (subsample <= 1) || (ids(n) % subsample == 0);
+        if (use_values) {
+          const Real v = static_cast<Real>(values(n));
+          keep = keep && (min <= v) && (v < max);
+        }
+        if (keep) {
+          if (final) selected(rank) = n;
+          ++rank;
+        }
+      },
+      num_selected);
+  return num_selected;
+}
+} // namespace
+
+void SwarmInfo::AddOffsets(const SP_Swarm &swarm, const SwarmSelection *selection) {
   std::size_t count = swarm->GetNumActive();
+  ParArray1D<int> indices;
+  if (selection != nullptr && count > 0) {
+    const auto &vname = selection->variable;
+    if (vname.empty() || swarm->Contains<Real>(vname)) {
+      const auto values =
+          vname.empty() ? ParArrayND<Real>() : swarm->Get<Real>(vname).Get();
+      count = SelectParticles(swarm, *selection, values, indices);
+    } else {
+      PARTHENON_REQUIRE_THROWS(swarm->Contains<int>(vname),
+                               "Swarm " + swarm->label() + " has no variable " + vname +
+                                   " to select particles by");
+      count = SelectParticles(swarm, *selection, swarm->Get<int>(vname).Get(), indices);
+    }
+  }
   std::size_t offset = (offsets.size() > 0) ? offsets.back() : 0;
   offset += (counts.size() > 0) ? counts.back() : 0;
   counts.push_back(count);
   offsets.push_back(offset);
   count_on_rank += count;
   max_indices.push_back(swarm->GetMaxActiveIndex());
+  selected.push_back(indices);
   // JMM: If we defrag, we don't need these
   // masks.push_back(swarm->GetMask());
 }
 
-AllSwarmInfo::AllSwarmInfo(BlockList_t &block_list,
+AllSwarmInfo::AllSwarmInfo(const BlockList_t &block_list,
                            const std::map<std::string, std::set<std::string>> &swarmnames,
-                           bool is_restart) {
+                           bool is_restart,
+                           const std::map<std::string, SwarmSelection> &selections) {
   for (auto &pmb : block_list) {
     const auto &swarm_container = pmb->meshblock_data.Get()->GetSwarmData();
     swarm_container->DefragAll(); // JMM: If we defrag, we don't need to mask?
@@ -179,7 +235,9 @@ AllSwarmInfo::AllSwarmInfo(BlockList_t &block_list,
         if (swarm_container->Contains(swarmname)) {
           auto &swarm = swarm_container->Get(swarmname);
           auto &info = all_info[swarmname];
-          info.AddOffsets(swarm);
+          auto selection = selections.find(swarmname);
+          info.AddOffsets(swarm, selection == selections.end() ? nullptr
+                                                                : &selection->second);
           for (const auto &varname : varnames) {
             if (swarm->Contains<int>(varname)) {
               auto var = swarm->GetP<int>(varname);
@@ -205,10 +263,56 @@ AllSwarmInfo::AllSwarmInfo(BlockList_t &block_list,
   }
 }
 
+OutputBlocks::OutputBlocks(Mesh *pm, const OutputParameters &params) {
+  const auto &xmin = params.region_xmin;
+  const auto &xmax = params.region_xmax;
+  all = xmin.empty() && xmax.empty() &&
+        params.region_min_level <= pm->GetMinLevel() - pm->GetRootLevel() &&
+        params.region_max_level == std::numeric_limits<int>::max();
+  nblist = pm->GetNbList();
+  if (all) {
+    blocks = pm->block_list;
+    gids.resize(pm->nbtotal);
+    std::iota(gids.begin(), gids.end(), 0);
+    for (int r = 0; r < Globals::my_rank; ++r)
+      offset += nblist[r];
+    return;
+  }
+
+  const int root_level = pm->GetRootLevel();
+  auto selected = [&](const LogicalLocation &loc) {
+    const int level = loc.level() - root_level;
+    if (level < params.region_min_level || level > params.region_max_level) return false;
+    const RegionSize domain = pm->GetBlockSize(loc);
+    for (int d = 0; d < 3; ++d) {
+      const auto dir = static_cast<CoordinateDirection>(d + 1);
+      if (d < xmin.size() && domain.xmax(dir) < xmin[d]) return false;
+      if (d < xmax.size() && domain.xmin(dir) > xmax[d]) return false;
+    }
+    return true;
+  };
+  // The blocks of every rank are contiguous in the global block list
+  const auto loclist = pm->GetLocList();
+  int gid = 0;
+  for (int r = 0; r < nblist.size(); ++r) {
+    const int num_blocks = nblist[r];
+    nblist[r] = 0;
+    for (int n = 0; n < num_blocks; ++n, ++gid) {
+      if (!selected(loclist[gid])) continue;
+      gids.push_back(gid);
+      ++nblist[r];
+      if (r < Globals::my_rank) ++offset;
+    }
+  }
+  for (const auto &pmb : pm->block_list) {
+    if (selected(pmb->loc)) blocks.push_back(pmb);
+  }
+}
+
 // Tools that can be shared accross Output types
 
-std::vector<Real> ComputeXminBlocks(Mesh *pm) {
-  return FlattenBlockInfo<Real>(pm, pm->ndim,
+std::vector<Real> ComputeXminBlocks(Mesh *pm, const BlockList_t &blocks) {
+  return FlattenBlockInfo<Real>(blocks, pm->ndim,
                                 [=](MeshBlock *pmb, std::vector<Real> &data, int &i) {
                                   auto xmin = pmb->coords.GetXmin();
                                   data[i++] = xmin[0];
@@ -221,9 +325,9 @@ std::vector<Real> ComputeXminBlocks(Mesh *pm) {
                                 });
 }
 
-std::vector<int64_t> ComputeLocs(Mesh *pm) {
+std::vector<int64_t> ComputeLocs(const BlockList_t &blocks) {
   return FlattenBlockInfo<int64_t>(
-      pm, 3, [=](MeshBlock *pmb, std::vector<int64_t> &locs, int &i) {
+      blocks, 3, [=](MeshBlock *pmb, std::vector<int64_t> &locs, int &i) {
         auto loc = pmb->pmy_mesh->Forest().GetLegacyTreeLocation(pmb->loc);
         locs[i++] = loc.lx1();
         locs[i++] = loc.lx2();
@@ -231,9 +335,9 @@ std::vector<int64_t> ComputeLocs(Mesh *pm) {
       });
 }
 
-std::vector<int> ComputeIDsAndFlags(Mesh *pm) {
+std::vector<int> ComputeIDsAndFlags(const BlockList_t &blocks) {
   return FlattenBlockInfo<int>(
-      pm, 5, [=](MeshBlock *pmb, std::vector<int> &data, int &i) {
+      blocks, 5, [=](MeshBlock *pmb, std::vector<int> &data, int &i) {
         auto loc = pmb->pmy_mesh->Forest().GetLegacyTreeLocation(pmb->loc);
         data[i++] = loc.level();
         data[i++] = pmb->gid;
@@ -243,8 +347,8 @@ std::vector<int> ComputeIDsAndFlags(Mesh *pm) {
       });
 }
 
-std::vector<int> ComputeDerefinementCount(Mesh *pm) {
-  return FlattenBlockInfo<int>(pm, 1,
+std::vector<int> ComputeDerefinementCount(const BlockList_t &blocks) {
+  return FlattenBlockInfo<int>(blocks, 1,
                                [=](MeshBlock *pmb, std::vector<int> &data, int &i) {
                                  data[i++] = pmb->pmr ? pmb->pmr->DerefinementCount() : 0;
                                });
@@ -253,20 +357,20 @@ std::vector<int> ComputeDerefinementCount(Mesh *pm) {
 // TODO(JMM): I could make this use the other loop
 // functionality/high-order functions.  but it was more code than this
 // for, I think, little benefit.
-void ComputeCoords(Mesh *pm, bool face, const IndexRange &ib, const IndexRange &jb,
-                   const IndexRange &kb, std::vector<Real> &x, std::vector<Real> &y,
-                   std::vector<Real> &z) {
+void ComputeCoords(const BlockList_t &blocks, bool face, const IndexRange &ib,
+                   const IndexRange &jb, const IndexRange &kb, std::vector<Real> &x,
+                   std::vector<Real> &y, std::vector<Real> &z) {
   const int nx1 = ib.e - ib.s + 1;
   const int nx2 = jb.e - jb.s + 1;
   const int nx3 = kb.e - kb.s + 1;
-  const int num_blocks = pm->block_list.size();
+  const int num_blocks = blocks.size();
   x.resize((nx1 + face) * num_blocks);
   y.resize((nx2 + face) * num_blocks);
   z.resize((nx3 + face) * num_blocks);
   std::size_t idx_x = 0, idx_y = 0, idx_z = 0;
 
   // note relies on casting of bool to int
-  for (auto &pmb : pm->block_list) {
+  for (auto &pmb : blocks) {
     for (int i = ib.s; i <= ib.e + face; ++i) {
       x[idx_x++] = face ? pmb->coords.Xf<1>(i) : pmb->coords.Xc<1>(i);
     }
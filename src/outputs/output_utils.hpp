@@ -40,6 +40,7 @@
 #include "mesh/domain.hpp"
 #include "mesh/mesh.hpp"
 #include "mesh/meshblock.hpp"
+#include "outputs/output_parameters.hpp"
 #include "utils/error_checking.hpp"
 
 namespace parthenon {
@@ -56,6 +57,8 @@ struct VarInfo {
   bool is_sparse;
   bool is_vector;
   bool is_coordinate_field;
+  // written to files in single precision, see Metadata::ReducedPrecision
+  bool reduced_precision;
   IndexShape cellbounds;
   std::vector<std::string> component_labels;
   // list of topological elements in variable... e.g., Face1, Face2, etc
@@ -134,7 +137,8 @@ struct VarInfo {
         topological_elements(topological_elements), is_sparse(is_sparse),
         is_vector(is_vector), cellbounds(cellbounds), rnx_(nx_.rbegin(), nx_.rend()),
         ntop_elems(topological_elements.size()), element_matters(ntop_elems > 1),
-        is_coordinate_field(metadata.IsCoordinateField()) {
+        is_coordinate_field(metadata.IsCoordinateField()),
+        reduced_precision(metadata.IsSet(Metadata::ReducedPrecision)) {
     if (num_components <= 0) {
       std::stringstream msg;
       msg << "### ERROR: Got variable " << label << " with " << num_components
@@ -214,7 +218,10 @@ struct SwarmInfo {
   std::vector<std::size_t> offsets;                     // global
   // std::vector<ParArray1D<bool>> masks; // used for reading swarms without defrag
   std::vector<std::size_t> max_indices;   // JMM: If we defrag, unneeded?
-  void AddOffsets(const SP_Swarm &swarm); // sets above metadata
+  // per-meshblock indices of the output particles, empty if all active are output
+  std::vector<ParArray1D<int>> selected;
+  // sets above metadata, only the particles passing selection (if any) are counted
+  void AddOffsets(const SP_Swarm &swarm, const SwarmSelection *selection = nullptr);
   template <typename T>
   MapToVarVec<T> &Vars() {
     return std::get<MapToVarVec<T>>(vars);
@@ -230,66 +237,102 @@ struct SwarmInfo {
     var_info[varname] = SwarmVarInfo(var->GetDim(6), var->GetDim(5), var->GetDim(4),
                                      var->GetDim(3), var->GetDim(2), rank, t, vector);
   }
-  // Copies swarmvar to host in prep for output
+  // Copies all swarmvars of type T to host in prep for output. The variables are packed
+  // on device into a single buffer, which is then transferred with one copy. Because the
+  // swarms are defragmented, the active particles of a block are its first counts[b]
+  // particles, unless a selection gathers them from selected[b]. Every variable is
+  // stored component by component, each component holding the particles of all blocks
+  // on this rank in order. var_offsets receives the start of every variable in the
+  // returned buffer.
   template <typename T>
-  std::vector<T> FillHostBuffer(const std::string vname,
-                                ParticleVariableVector<T> &swmvarvec) {
-    const auto &vinfo = var_info.at(vname);
-    std::vector<T> host_data(count_on_rank * vinfo.nvar);
-    std::size_t ivec = 0;
-    for (int n6 = 0; n6 < vinfo.GetN(6); ++n6) {
-      for (int n5 = 0; n5 < vinfo.GetN(5); ++n5) {
-        for (int n4 = 0; n4 < vinfo.GetN(4); ++n4) {
-          for (int n3 = 0; n3 < vinfo.GetN(3); ++n3) {
-            for (int n2 = 0; n2 < vinfo.GetN(2); ++n2) {
-              std::size_t block_idx = 0;
-              for (auto &swmvar : swmvarvec) {
-                // Copied extra times. JMM: If we defrag, unneeded?
-                // auto mask_h = masks[block_idx].GetHostMirrorAndCopy();
-                // Prevents us from having to copy extra data for swarm vars
-                // with multiple components
-                auto v_h = swmvar->GetHostMirrorAndCopy(n6, n5, n4, n3, n2);
-                // DO NOT use GetDim, as it does not reflect particle count
-                std::size_t particles_to_add = counts[block_idx];
-                std::size_t particles_added = 0;
-                for (std::size_t i = 0; i < particles_to_add; ++i) {
-                  if (true) { //(mask_h(i)) {
-                    host_data[ivec++] = v_h(i);
-                    particles_added++;
-                  }
-                }
-                if (particles_added != particles_to_add) {
-                  std::string msg = StringPrintf(
-                      "Not all active particles output! "
-                      "var, n6, n5, n4, n3, n2, block, particles_added, counts = "
-                      "%s %d %d %d %d %d %d %d %d",
-                      vname.c_str(), n6, n5, n4, n3, n2, block_idx, particles_added,
-                      particles_to_add);
-                  PARTHENON_THROW(msg);
-                }
-                ++block_idx;
-              }
-            }
-          }
-        }
+  std::vector<T> FillHostBuffers(std::map<std::string, std::size_t> &var_offsets) {
+    auto &vars = Vars<T>();
+    std::size_t size = 0;
+    for (const auto &[vname, swmvarvec] : vars) {
+      var_offsets[vname] = size;
+      size += count_on_rank * var_info.at(vname).nvar;
+    }
+    std::vector<T> host_data(size);
+    if (size == 0) return host_data;
+
+    ParArray1D<T> buffer("swarm output buffer", size);
+    for (const auto &[vname, swmvarvec] : vars) {
+      const auto &vinfo = var_info.at(vname);
+      const int nvar = vinfo.nvar;
+      const int n2 = vinfo.GetN(2);
+      const int n3 = vinfo.GetN(3);
+      const int n4 = vinfo.GetN(4);
+      const int n5 = vinfo.GetN(5);
+      const std::size_t stride = count_on_rank;
+      for (std::size_t b = 0; b < swmvarvec.size(); ++b) {
+        // DO NOT use GetDim, as it does not reflect particle count
+        const int count = counts[b];
+        if (count == 0) continue;
+        const std::size_t start = var_offsets[vname] + offsets[b] - global_offset;
+        auto data = swmvarvec[b]->data;
+        const auto sel = selected[b];
+        const bool gather = sel.size() > 0;
+        par_for(
+            PARTHENON_AUTO_LABEL, 0, nvar - 1, 0, count - 1,
+            KOKKOS_LAMBDA(const int c, const int i) {
+              int r = c;
+              const int i2 = r % n2;
+              r /= n2;
+              const int i3 = r % n3;
+              r /= n3;
+              const int i4 = r % n4;
+              r /= n4;
+              const int i5 = r % n5;
+              const int i6 = r / n5;
+              const int n = gather ? sel(i) : i;
+              buffer(start + c * stride + i) = data(i6, i5, i4, i3, i2, n);
+            });
       }
     }
+    Kokkos::View<T *, HostMemSpace, Kokkos::MemoryTraits<Kokkos::Unmanaged>> host_view(
+        host_data.data(), size);
+    Kokkos::deep_copy(host_view, buffer.KokkosView());
     return host_data; // move semantics
   }
 };
 struct AllSwarmInfo {
   std::map<std::string, SwarmInfo> all_info;
-  AllSwarmInfo(BlockList_t &block_list,
+  AllSwarmInfo(const BlockList_t &block_list,
                const std::map<std::string, std::set<std::string>> &swarmnames,
-               bool is_restart);
+               bool is_restart,
+               const std::map<std::string, SwarmSelection> &selections = {});
+};
+
+// Where a variable is in an HDF5 file with grouped variable datasets (see
+// hdf5_group_variables). The variables of a group are concatenated along the component
+// axis of a dataset of shape [block, component, k, j, i], in which the topological
+// elements and the tensor components of a variable are flattened in this order.
+struct VarGroupLayout {
+  std::string dataset; // name of the dataset of the group
+  int offset;          // first component of the variable in the dataset
+  int ncomp;           // number of components of the variable
+  int ncomp_group;     // number of components of all variables of the group
+};
+
+// The blocks written to an output, all blocks of the mesh unless the output is
+// restricted to a region of interest. The selection only depends on the locations of
+// the blocks, so every rank knows it for all ranks without communication.
+struct OutputBlocks {
+  BlockList_t blocks;      // selected blocks of this rank
+  std::vector<int> gids;   // global ids of the selected blocks of all ranks, in order
+  std::vector<int> nblist; // number of selected blocks of every rank
+  std::size_t offset = 0;  // index of the first block of this rank among all selected
+  bool all = true;         // whether all blocks are selected
+  OutputBlocks(Mesh *pm, const OutputParameters &params);
+  std::size_t NumGlobal() const { return gids.size(); }
 };
 
 template <typename T, typename Function_t>
-std::vector<T> FlattenBlockInfo(Mesh *pm, int shape, Function_t f) {
-  const int num_blocks_local = static_cast<int>(pm->block_list.size());
+std::vector<T> FlattenBlockInfo(const BlockList_t &blocks, int shape, Function_t f) {
+  const int num_blocks_local = static_cast<int>(blocks.size());
   std::vector<T> data(shape * num_blocks_local);
   int i = 0;
-  for (auto &pmb : pm->block_list) {
+  for (auto &pmb : blocks) {
     f(pmb.get(), data, i);
   }
   return data;
@@ -333,13 +376,13 @@ void PackOrUnpackVar(const VarInfo &info, bool do_ghosts, idx_t &idx, Function_t
   }
 }
 
-void ComputeCoords(Mesh *pm, bool face, const IndexRange &ib, const IndexRange &jb,
-                   const IndexRange &kb, std::vector<Real> &x, std::vector<Real> &y,
-                   std::vector<Real> &z);
-std::vector<Real> ComputeXminBlocks(Mesh *pm);
-std::vector<int64_t> ComputeLocs(Mesh *pm);
-std::vector<int> ComputeIDsAndFlags(Mesh *pm);
-std::vector<int> ComputeDerefinementCount(Mesh *pm);
+void ComputeCoords(const BlockList_t &blocks, bool face, const IndexRange &ib,
+                   const IndexRange &jb, const IndexRange &kb, std::vector<Real> &x,
+                   std::vector<Real> &y, std::vector<Real> &z);
+std::vector<Real> ComputeXminBlocks(Mesh *pm, const BlockList_t &blocks);
+std::vector<int64_t> ComputeLocs(const BlockList_t &blocks);
+std::vector<int> ComputeIDsAndFlags(const BlockList_t &blocks);
+std::vector<int> ComputeDerefinementCount(const BlockList_t &blocks);
 
 // TODO(JMM): Potentially unsafe if MPI_UNSIGNED_LONG_LONG isn't a size_t
 // however I think it's probably safe to assume we'll be on systems
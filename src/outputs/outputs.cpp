@@ -63,6 +63,7 @@
 #include <cstring>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <set>
 #include <sstream>
 #include <stdexcept>
@@ -74,6 +75,7 @@
 #include "interface/swarm_default_names.hpp"
 #include "mesh/mesh.hpp"
 #include "mesh/meshblock.hpp"
+#include "outputs/time_average.hpp"
 #include "parameter_input.hpp"
 #include "parthenon_arrays.hpp"
 #include "utils/error_checking.hpp"
@@ -129,6 +131,9 @@ Outputs::Outputs(Mesh *pm, ParameterInput *pin, SimTime *tm) {
       if (tm != nullptr) {
         op.next_time = pin->GetOrAddReal(op.block_name, "next_time", tm->time);
         op.dt = dt;
+        if (pin->DoesParameterExist(op.block_name, "dcycle")) {
+          op.dcycle = pin->GetInteger(op.block_name, "dcycle");
+        }
       }
 
       // set file number, basename, id, and format
@@ -156,10 +161,20 @@ Outputs::Outputs(Mesh *pm, ParameterInput *pin, SimTime *tm) {
       if (is_hdf5_output) {
         op.single_precision_output =
             pin->GetOrAddBoolean(op.block_name, "single_precision_output", false);
+        op.half_precision_output =
+            pin->GetOrAddBoolean(op.block_name, "half_precision_output", false);
+        // restarts have to reproduce the state exactly
+        PARTHENON_REQUIRE_THROWS(!op.half_precision_output || op.file_type != "rst",
+                                 "half_precision_output can't be used for restart "
+                                 "output block " +
+                                     op.block_name);
+        // the data is converted from single precision
+        if (op.half_precision_output) op.single_precision_output = true;
         op.sparse_seed_nans =
             pin->GetOrAddBoolean(op.block_name, "sparse_seed_nans", false);
       } else {
         op.single_precision_output = false;
+        op.half_precision_output = false;
         op.sparse_seed_nans = false;
 
         if (pin->DoesParameterExist(op.block_name, "single_precision_output")) {
@@ -180,16 +195,62 @@ Outputs::Outputs(Mesh *pm, ParameterInput *pin, SimTime *tm) {
         op.hdf5_compression_level = pin->GetOrAddInteger(
             op.block_name, "hdf5_compression_level", default_compression_level);
 
+        std::string default_compressor = "deflate";
 #ifdef PARTHENON_DISABLE_HDF5_COMPRESSION
-        if (op.hdf5_compression_level != 0) {
-          std::stringstream err;
-          err << "HDF5 compression requested for output block '" << op.block_name
-              << "', but HDF5 compression is disabled";
-          PARTHENON_THROW(err)
+        default_compressor = "none";
+#endif
+        op.hdf5_compressor =
+            pin->GetOrAddString(op.block_name, "hdf5_compressor", default_compressor);
+        op.hdf5_variable_compressors.clear();
+        if (pin->DoesParameterExist(op.block_name, "hdf5_variable_compressors")) {
+          for (const auto &entry : pin->GetVector<std::string>(
+                   op.block_name, "hdf5_variable_compressors")) {
+            const auto colon = entry.rfind(':');
+            PARTHENON_REQUIRE_THROWS(colon != std::string::npos,
+                                     "Entries of hdf5_variable_compressors in block " +
+                                         op.block_name +
+                                         " must be of the form variable:compressor");
+            op.hdf5_variable_compressors[entry.substr(0, colon)] =
+                entry.substr(colon + 1);
+          }
+        }
+        op.hdf5_compression_tolerance =
+            pin->GetOrAddReal(op.block_name, "hdf5_compression_tolerance", 0.0);
+        op.hdf5_filter_id = pin->GetOrAddInteger(op.block_name, "hdf5_filter_id", 0);
+        op.hdf5_filter_cd_values.clear();
+        if (pin->DoesParameterExist(op.block_name, "hdf5_filter_cd_values")) {
+          for (const auto &v :
+               pin->GetVector<int>(op.block_name, "hdf5_filter_cd_values"))
+            op.hdf5_filter_cd_values.push_back(static_cast<unsigned int>(v));
         }
+
+        std::set<std::string> compressors{op.hdf5_compressor};
+        for (const auto &[var, compressor] : op.hdf5_variable_compressors)
+          compressors.insert(compressor);
+        for (const auto &compressor : compressors) {
+#ifdef PARTHENON_DISABLE_HDF5_COMPRESSION
+          if (op.hdf5_compression_level != 0 && compressor != "none") {
+            std::stringstream err;
+            err << "HDF5 compression requested for output block '" << op.block_name
+                << "', but HDF5 compression is disabled";
+            PARTHENON_THROW(err)
+          }
 #endif
+          // restarts have to reproduce the state exactly
+          if (compressor == "zfp") {
+            PARTHENON_REQUIRE_THROWS(op.file_type != "rst",
+                                     "Lossy HDF5 compressor zfp can't be used for "
+                                     "restart output block " +
+                                         op.block_name);
+            PARTHENON_REQUIRE_THROWS(
+                op.hdf5_compression_tolerance > 0.0,
+                "HDF5 compressor zfp requires hdf5_compression_tolerance > 0 in block " +
+                    op.block_name);
+          }
+        }
       } else {
         op.hdf5_compression_level = 0;
+        op.hdf5_compressor = "none";
 
         if (pin->DoesParameterExist(op.block_name, "hdf5_compression_level")) {
           std::stringstream warn;
@@ -208,11 +269,13 @@ Outputs::Outputs(Mesh *pm, ParameterInput *pin, SimTime *tm) {
         } else {
           op.packages = std::vector<std::string>();
         }
+        op.memory_usage = pin->GetOrAddBoolean(pib->block_name, "memory_usage", false);
       }
 
       // set output variable and optional data format string used in formatted writes
       if ((op.file_type != "hst") && (op.file_type != "rst") &&
-          (op.file_type != "ascent") && (op.file_type != "histogram")) {
+          (op.file_type != "ascent") && (op.file_type != "histogram") &&
+          (op.file_type != "telemetry")) {
         op.variables = pin->GetOrAddVector<std::string>(pib->block_name, "variables",
                                                         std::vector<std::string>());
         // JMM: If the requested var isn't present for a given swarm,
@@ -247,9 +310,34 @@ Outputs::Outputs(Mesh *pm, ParameterInput *pin, SimTime *tm) {
                                                swarm_position::y::name(),
                                                swarm_position::z::name()};
             op.swarms[swname].insert(coords.begin(), coords.end());
+
+            // Optionally only write a deterministic subset of the particles
+            const std::string &blk = pib->block_name;
+            SwarmSelection selection;
+            selection.subsample = pin->GetOrAddInteger(blk, swname + "_subsample", 1);
+            PARTHENON_REQUIRE_THROWS(selection.subsample > 0,
+                                     swname + "_subsample must be positive");
+            if (selection.subsample > 1) {
+              selection.subsample_variable =
+                  pin->GetOrAddString(blk, swname + "_subsample_variable", "id");
+            }
+            if (pin->DoesParameterExist(blk, swname + "_select_variable")) {
+              selection.variable = pin->GetString(blk, swname + "_select_variable");
+              selection.min =
+                  pin->GetOrAddReal(blk, swname + "_select_min", selection.min);
+              selection.max =
+                  pin->GetOrAddReal(blk, swname + "_select_max", selection.max);
+            }
+            if (selection.subsample > 1 || !selection.variable.empty()) {
+              op.swarm_selections[swname] = selection;
+            }
           }
         }
       }
+      if (op.file_type == "hdf5") {
+        const auto averages = TimeAverage::FieldNames(pm->packages, op.block_number);
+        op.variables.insert(op.variables.end(), averages.begin(), averages.end());
+      }
       op.data_format = pin->GetOrAddString(op.block_name, "data_format", "%12.5e");
       op.data_format.insert(0, " "); // prepend with blank to separate columns
 
@@ -258,10 +346,28 @@ Outputs::Outputs(Mesh *pm, ParameterInput *pin, SimTime *tm) {
       if (op.file_type == "hst") {
         pnew_type = new HistoryOutput(op);
         num_hst_outputs++;
+      } else if (op.file_type == "telemetry") {
+        pnew_type = new TelemetryOutput(op);
       } else if (op.file_type == "vtk") {
+#ifdef ENABLE_HDF5
         pnew_type = new VTKOutput(op);
+#else
+        msg << "### FATAL ERROR in Outputs constructor" << std::endl
+            << "Executable not configured for HDF5 outputs, but the VTKHDF file format "
+            << "is requested in output block '" << op.block_name << "'. "
+            << "You can disable this block without deleting it by setting a dt < 0."
+            << std::endl;
+        PARTHENON_FAIL(msg);
+#endif // ifdef ENABLE_HDF5
       } else if (op.file_type == "ascent") {
         pnew_type = new AscentOutput(op);
+      } else if (op.file_type == "insitu") {
+        pnew_type = new InSituOutput(op);
+      } else if (op.file_type == "stats") {
+        pnew_type = new StatisticsOutput(op, pin);
+      } else if (op.file_type == "slice" || op.file_type == "line" ||
+                 op.file_type == "probes") {
+        pnew_type = new SampleOutput(op, pin);
       } else if (op.file_type == "histogram") {
 #ifdef ENABLE_HDF5
         pnew_type = new HistogramOutput(op, pin);
@@ -283,6 +389,79 @@ Outputs::Outputs(Mesh *pm, ParameterInput *pin, SimTime *tm) {
         op.write_swarm_xdmf =
             (restart) ? false
                       : pin->GetOrAddBoolean(op.block_name, "write_swarm_xdmf", false);
+        op.async_write = pin->GetOrAddBoolean(op.block_name, "async_write", false);
+        op.hdf5_subfiling = pin->GetOrAddBoolean(op.block_name, "hdf5_subfiling", false);
+        op.hdf5_subfiling_stripe_size =
+            pin->GetOrAddInteger(op.block_name, "hdf5_subfiling_stripe_size", 0);
+        op.hdf5_group_variables =
+            pin->GetOrAddBoolean(op.block_name, "hdf5_group_variables", false);
+        // restarts have to contain everything
+        op.variable_every.clear();
+        if (!restart && pin->DoesParameterExist(op.block_name, "variable_every")) {
+          for (const auto &entry :
+               pin->GetVector<std::string>(op.block_name, "variable_every")) {
+            const auto colon = entry.rfind(':');
+            PARTHENON_REQUIRE_THROWS(colon != std::string::npos,
+                                     "Entries of variable_every in block " +
+                                         op.block_name +
+                                         " must be of the form variable:number");
+            const int every = std::stoi(entry.substr(colon + 1));
+            PARTHENON_REQUIRE_THROWS(every > 0, "Entries of variable_every in block " +
+                                                    op.block_name + " must be positive");
+            op.variable_every[entry.substr(0, colon)] = every;
+          }
+        }
+        op.reuse_mesh_metadata =
+            !restart &&
+            pin->GetOrAddBoolean(op.block_name, "reuse_mesh_metadata", false);
+        if (!restart) {
+          if (pin->DoesParameterExist(op.block_name, "region_xmin")) {
+            op.region_xmin = pin->GetVector<Real>(op.block_name, "region_xmin");
+          }
+          if (pin->DoesParameterExist(op.block_name, "region_xmax")) {
+            op.region_xmax = pin->GetVector<Real>(op.block_name, "region_xmax");
+          }
+          PARTHENON_REQUIRE_THROWS(
+              op.region_xmin.size() <= 3 && op.region_xmax.size() <= 3,
+              "region_xmin and region_xmax can have at most three entries in block " +
+                  op.block_name);
+          op.region_min_level = pin->GetOrAddInteger(op.block_name, "region_min_level",
+                                                     std::numeric_limits<int>::lowest());
+          op.region_max_level = pin->GetOrAddInteger(op.block_name, "region_max_level",
+                                                     std::numeric_limits<int>::max());
+        }
+        if (restart) {
+          op.incremental = pin->GetOrAddBoolean(op.block_name, "incremental", false);
+          op.incremental_full_every =
+              pin->GetOrAddInteger(op.block_name, "incremental_full_every", 10);
+          op.raw_block_data =
+              pin->GetOrAddBoolean(op.block_name, "raw_block_data", false);
+          // incremental files only contain the blocks that changed in their datasets
+          PARTHENON_REQUIRE_THROWS(!(op.raw_block_data && op.incremental),
+                                   "raw_block_data and incremental can't be combined in "
+                                   "block " +
+                                       op.block_name);
+          // the changed blocks are tracked per variable dataset
+          PARTHENON_REQUIRE_THROWS(!(op.hdf5_group_variables && op.incremental),
+                                   "hdf5_group_variables and incremental can't be "
+                                   "combined in block " +
+                                       op.block_name);
+          if (pin->DoesParameterExist(op.block_name, "fast_dir")) {
+            op.fast_dir = pin->GetString(op.block_name, "fast_dir");
+            op.fast_flush_every =
+                pin->GetOrAddInteger(op.block_name, "fast_flush_every", 10);
+            op.emergency_flush =
+                pin->GetOrAddBoolean(op.block_name, "emergency_flush", false);
+            PARTHENON_REQUIRE_THROWS(op.fast_flush_every > 0,
+                                     "fast_flush_every must be positive in block " +
+                                         op.block_name);
+            // incremental files refer to their base in the same directory
+            PARTHENON_REQUIRE_THROWS(!op.incremental,
+                                     "fast_dir and incremental can't be combined in "
+                                     "block " +
+                                         op.block_name);
+          }
+        }
         pnew_type = new PHDF5Output(op, restart);
 #else
         msg << "### FATAL ERROR in Outputs constructor" << std::endl
@@ -438,12 +617,16 @@ void Outputs::MakeOutputs(Mesh *pm, ParameterInput *pin, SimTime *tm,
   while (ptype != nullptr) {
     if ((tm == nullptr) ||
         ((ptype->output_params.dt >= 0.0) &&
-         ((tm->ncycle == 0) || (tm->time >= ptype->output_params.next_time) ||
+         ((tm->ncycle == 0) ||
+          (ptype->output_params.dcycle > 0
+               ? tm->ncycle % ptype->output_params.dcycle == 0
+               : tm->time >= ptype->output_params.next_time) ||
           (tm->time >= tm->tlim) || (signal == SignalHandler::OutputSignal::now) ||
           (signal == SignalHandler::OutputSignal::final) ||
           (signal == SignalHandler::OutputSignal::analysis &&
            ptype->output_params.analysis_flag)))) {
-      if (first && ptype->output_params.file_type != "hst") {
+      if (first && ptype->output_params.file_type != "hst" &&
+          ptype->output_params.file_type != "telemetry") {
         pm->ApplyUserWorkBeforeOutput(pm, pin, *tm);
         for (const auto &pkg : pm->packages.AllPackages()) {
           pkg.second->UserWorkBeforeOutput(pm, pin, *tm);
@@ -457,6 +640,7 @@ void Outputs::MakeOutputs(Mesh *pm, ParameterInput *pin, SimTime *tm,
         }
       }
       ptype->WriteOutputFile(pm, pin, tm, signal);
+      TimeAverage::Reset(pm, ptype->output_params.block_number);
     }
     ptype = ptype->pnext_type; // move to next OutputType node in singly linked list
   }
@@ -19,10 +19,13 @@
 //! \file outputs.hpp
 //  \brief provides classes to handle ALL types of data output
 
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <set>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "Kokkos_ScatterView.hpp"
@@ -33,14 +36,19 @@
 #include "io_wrapper.hpp"
 #include "kokkos_abstraction.hpp"
 #include "outputs/output_parameters.hpp"
+#include "outputs/statistics_sketch.hpp"
 #include "parthenon_arrays.hpp"
 #include "utils/error_checking.hpp"
+#include "utils/telemetry.hpp"
 
 namespace parthenon {
 
 // forward declarations
 class Mesh;
 class ParameterInput;
+namespace OutputUtils {
+struct OutputBlocks;
+} // namespace OutputUtils
 
 //----------------------------------------------------------------------------------------
 //! \struct OutputData
@@ -126,11 +134,30 @@ struct HistoryOutputVec {
       : hst_op(hst_op_), hst_vec_fun(hst_vec_fun_), label(label_) {}
 };
 
+// Reduction of one component of a field over the interior cells of all blocks, which
+// is optionally weighted by the cell volume. Other than the callbacks above, which each
+// launch their own kernel(s), all field reductions with the same operation are
+// evaluated together in a single kernel.
+struct HistoryOutputField {
+  UserHistoryOperation hst_op;
+  std::string var_name; // name of the field, including the sparse id for sparse fields
+  int component;        // flattened component of the field
+  bool volume_weighted; // multiply the cell values by the cell volume
+  std::string label;
+  HistoryOutputField(const UserHistoryOperation &hst_op_, const std::string &var_name_,
+                     const std::string &label_, const int component_ = 0,
+                     const bool volume_weighted_ = false)
+      : hst_op(hst_op_), var_name(var_name_), component(component_),
+        volume_weighted(volume_weighted_), label(label_) {}
+};
+
 using HstVar_list = std::vector<HistoryOutputVar>;
 using HstVec_list = std::vector<HistoryOutputVec>;
+using HstField_list = std::vector<HistoryOutputField>;
 // Hardcoded global entry to be used by each package to enroll user output functions
 const char hist_param_key[] = "HistoryFunctions";
 const char hist_vec_param_key[] = "HistoryVectorFunctions";
+const char hist_field_param_key[] = "HistoryFieldReductions";
 
 //----------------------------------------------------------------------------------------
 //! \class HistoryFile
@@ -144,13 +171,12 @@ class HistoryOutput : public OutputType {
 };
 
 //----------------------------------------------------------------------------------------
-//! \class VTKOutput
-//  \brief derived OutputType class for vtk dumps
+//! \class TelemetryOutput
+//  \brief derived OutputType class for the per-cycle timing and memory breakdown
 
-class VTKOutput : public OutputType {
+class TelemetryOutput : public OutputType {
  public:
-  explicit VTKOutput(const OutputParameters &oparams) : OutputType(oparams) {}
-  void WriteContainer(SimTime &tm, Mesh *pm, ParameterInput *pin, bool flag) override;
+  explicit TelemetryOutput(const OutputParameters &oparams);
   void WriteOutputFile(Mesh *pm, ParameterInput *pin, SimTime *tm,
                        const SignalHandler::OutputSignal signal) override;
 };
@@ -169,6 +195,21 @@ class AscentOutput : public OutputType {
   //  Ghost mask currently (Ascent 0.9) needs to be of float type on device as the
   //  automated conversion between int and float does not work
   ParArray1D<Real> ghost_mask_;
+  // open Ascent instance and mesh description, which is kept until the block list
+  // changes
+  struct Cache;
+  std::shared_ptr<Cache> cache_;
+};
+
+//----------------------------------------------------------------------------------------
+//! \class InSituOutput
+//  \brief derived OutputType class that hands the variables to an in situ consumer
+
+class InSituOutput : public OutputType {
+ public:
+  explicit InSituOutput(const OutputParameters &oparams) : OutputType(oparams) {}
+  void WriteOutputFile(Mesh *pm, ParameterInput *pin, SimTime *tm,
+                       const SignalHandler::OutputSignal signal) override;
 };
 
 #ifdef ENABLE_HDF5
@@ -190,19 +231,68 @@ class PHDF5Output : public OutputType {
  private:
   std::string GenerateFilename_(ParameterInput *pin, SimTime *tm,
                                 const SignalHandler::OutputSignal signal);
-  void WriteBlocksMetadata_(Mesh *pm, hid_t file, const HDF5::H5P &pl, hsize_t offset,
-                            hsize_t max_blocks_global) const;
+  // whether the datasets are written on a background thread, see async_write
+  bool UseAsyncWrite_() const;
+  // The block metadata, coordinates, and levels are linked to the file link instead of
+  // being written if it is not empty, see reuse_mesh_metadata
+  void WriteBlocksMetadata_(Mesh *pm, hid_t file, const HDF5::H5P &pl,
+                            const OutputUtils::OutputBlocks &out_blocks,
+                            const std::string &link) const;
   void WriteCoordinates_(Mesh *pm, const IndexDomain &domain, hid_t file,
-                         const HDF5::H5P &pl, hsize_t offset,
-                         hsize_t max_blocks_global) const;
-  void WriteLevelsAndLocs_(Mesh *pm, hid_t file, const HDF5::H5P &pl, hsize_t offset,
-                           hsize_t max_blocks_global) const;
-  void WriteSparseInfo_(Mesh *pm, hbool_t *sparse_allocated,
-                        const std::vector<int> &dealloc_count,
+                         const HDF5::H5P &pl, const OutputUtils::OutputBlocks &out_blocks,
+                         const std::string &link) const;
+  void WriteLevelsAndLocs_(Mesh *pm, hid_t file, const HDF5::H5P &pl,
+                           const OutputUtils::OutputBlocks &out_blocks,
+                           const std::string &link) const;
+  void WriteSparseInfo_(hbool_t *sparse_allocated, const std::vector<int> &dealloc_count,
                         const std::vector<std::string> &sparse_names, hsize_t num_sparse,
-                        hid_t file, const HDF5::H5P &pl, size_t offset,
-                        hsize_t max_blocks_global) const;
+                        hid_t file, const HDF5::H5P &pl,
+                        const OutputUtils::OutputBlocks &out_blocks) const;
+  // Writes the variables of the local blocks to the raw file of this rank next to the
+  // restart file filename and where they are to the file, see raw_block_data. Sets
+  // which sparse variables are allocated in the same way as the dataset writes.
+  void WriteRawBlockData_(const std::string &filename, hid_t file, const HDF5::H5P &pl,
+                          const OutputUtils::OutputBlocks &out_blocks,
+                          const std::vector<OutputUtils::VarInfo> &vars_info,
+                          const std::unordered_map<std::string, size_t> &sparse_field_idx,
+                          hbool_t *sparse_allocated,
+                          std::vector<int> &dealloc_count) const;
   const bool restart_; // true if we write a restart file, false for regular output files
+
+  // The last full restart file that incremental restarts refer to, see incremental
+  struct IncrementalBase {
+    std::string filename;
+    // structure and partition of the mesh it was written with
+    std::size_t mesh_hash = 0;
+    int num_increments = 0;
+    // hash of the data of every variable on every local block
+    std::unordered_map<std::string, std::vector<std::uint64_t>> hashes;
+  } incremental_base_;
+  // newest restart file in the fast tier, see fast_dir
+  std::string last_fast_file_;
+  // The last file with the block metadata of the current mesh, see reuse_mesh_metadata
+  struct MeshMetadataFile {
+    std::string filename;
+    std::size_t mesh_hash = 0;
+  } mesh_metadata_;
+};
+
+//----------------------------------------------------------------------------------------
+//! \class VTKOutput
+//  \brief derived OutputType class for VTKHDF (overlapping AMR) dumps
+
+class VTKOutput : public OutputType {
+ public:
+  explicit VTKOutput(const OutputParameters &oparams) : OutputType(oparams) {}
+  void WriteOutputFile(Mesh *pm, ParameterInput *pin, SimTime *tm,
+                       const SignalHandler::OutputSignal signal) override;
+
+ private:
+  std::string GenerateFilename_(ParameterInput *pin, SimTime *tm,
+                                const SignalHandler::OutputSignal signal);
+  // rewrite the ParaView .series file listing all files written so far
+  void WriteSeries_(const std::string &filename, Real time);
+  std::vector<std::pair<std::string, Real>> series_; // file name and time
 };
 
 //----------------------------------------------------------------------------------------
@@ -235,13 +325,11 @@ struct Histogram {
   std::string weight_var_name_; // variable name of variable used as weight
   // component of variable to be used as weight. If -1 means no weighting
   int weight_var_component_;
-  ParArray2D<Real> result_; // resulting histogram
+  // offset of the bins of this histogram in the results of all histograms of an output
+  int result_offset_;
 
-  // temp view for histogram reduction for better performance (switches
-  // between atomics and data duplication depending on the platform)
-  Kokkos::Experimental::ScatterView<Real **, LayoutWrapper> scatter_result;
   Histogram(ParameterInput *pin, const std::string &block_name, const std::string &name);
-  void CalcHist(Mesh *pm);
+  int NumBins() const;
 };
 
 } // namespace HistUtil
@@ -255,11 +343,73 @@ class HistogramOutput : public OutputType {
  private:
   std::string GenerateFilename_(ParameterInput *pin, SimTime *tm,
                                 const SignalHandler::OutputSignal signal);
+  // Calculate all histograms in a single sweep over each partition
+  void CalcHistograms_(Mesh *pm);
   std::vector<std::string> hist_names_; // names (used as id) for different histograms
   std::vector<HistUtil::Histogram> histograms_;
+  ParArray1D<Real> edges_;   // concatenated x and y edges of all histograms
+  ParArray1D<Real> results_; // concatenated bins of all histograms (row major, x fastest)
+
+  // temp view for histogram reduction for better performance (switches
+  // between atomics and data duplication depending on the platform)
+  Kokkos::Experimental::ScatterView<Real *, LayoutWrapper> scatter_results_;
 };
 #endif // ifdef ENABLE_HDF5
 
+//----------------------------------------------------------------------------------------
+//! \class StatisticsOutput
+//  \brief derived OutputType class for statistics of variables, see statistics_sketch
+
+class StatisticsOutput : public OutputType {
+ public:
+  StatisticsOutput(const OutputParameters &oparams, ParameterInput *pin);
+  void WriteOutputFile(Mesh *pm, ParameterInput *pin, SimTime *tm,
+                       const SignalHandler::OutputSignal signal) override;
+
+ private:
+  // Sketches of all components of the variables in a single sweep over each partition,
+  // merged over ranks with a single reduction
+  void UpdateSketches_(Mesh *pm);
+  StatsUtil::SketchLayout layout_;
+  bool accumulate_; // keep adding to the sketches instead of starting over every output
+  std::vector<Real> percentiles_;
+  std::vector<std::string> labels_; // of the components, in the order of the sketches
+  std::vector<Real> sketches_;      // of all components, on the host
+  std::vector<Real> shift_;         // of the power sums of every component
+  ParArray1D<Real> bins_;           // of all components, on device
+  Kokkos::Experimental::ScatterView<Real *, LayoutWrapper> scatter_bins_;
+};
+
+//----------------------------------------------------------------------------------------
+//! \class SampleOutput
+//  \brief derived OutputType class for variables interpolated to the points of an
+//  axis-aligned slice ("slice"), a line ("line"), or a list of probes ("probes")
+
+class SampleOutput : public OutputType {
+ public:
+  SampleOutput(const OutputParameters &oparams, ParameterInput *pin);
+  void WriteOutputFile(Mesh *pm, ParameterInput *pin, SimTime *tm,
+                       const SignalHandler::OutputSignal signal) override;
+
+ private:
+  void MakePoints_(Mesh *pm);
+  // Interpolates all components to the points in the blocks of this rank and gathers
+  // them on the writer. Returns the values of all points on the writer, NaN for points
+  // outside of the mesh.
+  std::vector<Real> Sample_(Mesh *pm);
+  void WriteFile_(const std::vector<Real> &values, SimTime *tm);
+
+  int writer_; // rank that writes the files
+  // slice normal direction and position, or line end points, or probe positions
+  int normal_;
+  Real position_;
+  std::vector<Real> start_, end_, probes_;
+  std::vector<int> npoints_;   // along the directions of the line or slice
+  ParArray2D<Real> points_;    // positions of all points, on device
+  std::vector<Real> points_h_; // positions of all points, on the host
+  std::vector<std::string> labels_;
+};
+
 //----------------------------------------------------------------------------------------
 //! \class Outputs
 
@@ -274,6 +424,8 @@ class Outputs {
   void
   MakeOutputs(Mesh *pm, ParameterInput *pin, SimTime *tm = nullptr,
               SignalHandler::OutputSignal signal = SignalHandler::OutputSignal::none);
+  // Head of the list of OutputTypes, e.g., to write outputs individually
+  OutputType *GetFirstOutputType() const { return pfirst_type_; }
 
  private:
   OutputType *pfirst_type_; // ptr to head OutputType node in singly linked list
@@ -24,31 +24,185 @@
 #ifdef ENABLE_HDF5
 
 #include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
 #include <limits>
+#include <map>
 #include <memory>
 #include <numeric>
 #include <set>
+#include <string>
+#include <system_error>
 #include <tuple>
 #include <type_traits>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
+#include FS_HEADER
 #include "driver/driver.hpp"
 #include "interface/metadata.hpp"
 #include "interface/swarm_default_names.hpp"
 #include "mesh/mesh.hpp"
 #include "mesh/meshblock.hpp"
+#include "outputs/async_writer.hpp"
 #include "outputs/output_utils.hpp"
 #include "outputs/outputs.hpp"
 #include "outputs/parthenon_hdf5.hpp"
 #include "outputs/parthenon_xdmf.hpp"
+#include "outputs/raw_block_data.hpp"
 #include "outputs/restart.hpp"
+#include "utils/hash.hpp"
+#include "utils/instrument.hpp"
 #include "utils/string_utils.hpp"
 
+namespace fs = FS_NAMESPACE;
+
 namespace parthenon {
 
+namespace {
+// The HDF5 objects and the dataset writes of an output that are finished on the
+// background thread in asynchronous mode. The writes own the staged host copies of the
+// data they write.
+struct StagedHDF5Output {
+  HDF5::H5P acc_file, pl_xfer;
+  HDF5::H5F file;
+  HDF5::H5T var_file_type; // type of the variable datasets if it differs from the data
+  std::vector<HDF5::H5P> dcreate_props;
+  std::vector<HDF5::H5G> groups;
+  std::vector<std::function<void()>> writes;
+
+  void Finish() {
+    for (auto &write : writes)
+      write();
+    writes.clear();
+    // close everything in the file before the file itself
+    groups.clear();
+    dcreate_props.clear();
+    file.Reset();
+    var_file_type.Reset();
+    pl_xfer.Reset();
+    acc_file.Reset();
+  }
+};
+
+#ifndef PARTHENON_DISABLE_HDF5_COMPRESSION
+// Registered IDs of the HDF5 filter plugins for the fast and the lossy compressors.
+// These are loaded by HDF5 at runtime from HDF5_PLUGIN_PATH (see
+// https://github.com/HDFGroup/hdf5_plugins) rather than linked into Parthenon.
+constexpr H5Z_filter_t H5Z_FILTER_BLOSC_ID = 32001;
+constexpr H5Z_filter_t H5Z_FILTER_LZ4_ID = 32004;
+constexpr H5Z_filter_t H5Z_FILTER_ZFP_ID = 32013;
+constexpr H5Z_filter_t H5Z_FILTER_ZSTD_ID = 32015;
+
+// Replace the filter pipeline of pl_dcreate by the compressor of the variable var_name.
+// Without compression there is no need for chunks, so the dataset is contiguous.
+void SetCompression(hid_t pl_dcreate, const OutputParameters &output_params,
+                    const std::string &var_name, int ndim, const hsize_t *chunk_size) {
+  auto it = output_params.hdf5_variable_compressors.find(var_name);
+  const std::string &compressor = it != output_params.hdf5_variable_compressors.end()
+                                      ? it->second
+                                      : output_params.hdf5_compressor;
+  const int level = output_params.hdf5_compression_level;
+
+  PARTHENON_HDF5_CHECK(H5Premove_filter(pl_dcreate, H5Z_FILTER_ALL));
+  if (compressor == "none" || level == 0) {
+    PARTHENON_HDF5_CHECK(H5Pset_layout(pl_dcreate, H5D_CONTIGUOUS));
+    return;
+  }
+  PARTHENON_HDF5_CHECK(H5Pset_chunk(pl_dcreate, ndim, chunk_size));
+
+  H5Z_filter_t filter;
+  std::vector<unsigned int> cd_values;
+  if (compressor == "deflate") {
+    PARTHENON_HDF5_CHECK(H5Pset_deflate(pl_dcreate, std::min(9, level)));
+    return;
+  } else if (compressor == "zstd") {
+    filter = H5Z_FILTER_ZSTD_ID;
+    cd_values = {static_cast<unsigned int>(std::min(22, level))};
+  } else if (compressor == "lz4") {
+    filter = H5Z_FILTER_LZ4_ID;
+  } else if (compressor == "blosc") {
+    // first four values are reserved for the filter, then level, byte shuffle, and lz4
+    filter = H5Z_FILTER_BLOSC_ID;
+    cd_values = {0, 0, 0, 0, static_cast<unsigned int>(std::min(9, level)), 1, 1};
+  } else if (compressor == "zfp") {
+    // fixed accuracy mode, the absolute error bound is stored as a double in the
+    // third and fourth value
+    filter = H5Z_FILTER_ZFP_ID;
+    cd_values.resize(4, 0);
+    cd_values[0] = 3;
+    const double tolerance = output_params.hdf5_compression_tolerance;
+    std::memcpy(&cd_values[2], &tolerance, sizeof(double));
+  } else if (compressor == "filter") {
+    filter = static_cast<H5Z_filter_t>(output_params.hdf5_filter_id);
+    cd_values = output_params.hdf5_filter_cd_values;
+  } else {
+    PARTHENON_THROW("Unknown HDF5 compressor '" + compressor + "' for variable " +
+                    var_name);
+  }
+
+  const htri_t avail = PARTHENON_HDF5_CHECK(H5Zfilter_avail(filter));
+  PARTHENON_REQUIRE_THROWS(avail > 0, "HDF5 filter " + std::to_string(filter) +
+                                          " for compressor '" + compressor +
+                                          "' is not available, make sure that its "
+                                          "plugin can be found in HDF5_PLUGIN_PATH");
+  PARTHENON_HDF5_CHECK(H5Pset_filter(pl_dcreate, filter, H5Z_FLAG_MANDATORY,
+                                     cd_values.size(), cd_values.data()));
+}
+#endif
+
+// Use the subfiling VFD of HDF5, which writes one subfile per node (or per group of
+// ranks, see the H5FD_SUBFILING_* environment variables of HDF5), each written by I/O
+// concentrator threads, plus a stub file with the name of the output file
+void SetSubfiling(hid_t acc_file, const OutputParameters &output_params) {
+  static bool warned = false;
+  auto warn = [&](const std::string &msg) {
+    if (!warned && Globals::my_rank == 0) PARTHENON_WARN(msg);
+    warned = true;
+  };
+#if defined(MPI_PARALLEL) && defined(H5_HAVE_SUBFILING_VFD)
+  // the I/O concentrators are threads that communicate with MPI
+  int provided;
+  PARTHENON_MPI_CHECK(MPI_Query_thread(&provided));
+  if (provided < MPI_THREAD_MULTIPLE) {
+    warn("HDF5 subfiling requires MPI_THREAD_MULTIPLE (set "
+         "PARTHENON_MPI_THREAD_MULTIPLE=1 in the environment), writing a single file "
+         "instead.");
+    return;
+  }
+  H5FD_subfiling_config_t config;
+  // the defaults, since subfiling is not set up yet
+  PARTHENON_HDF5_CHECK(H5Pget_fapl_subfiling(acc_file, &config));
+  config.shared_cfg.ioc_selection = SELECT_IOC_ONE_PER_NODE;
+  if (output_params.hdf5_subfiling_stripe_size > 0) {
+    config.shared_cfg.stripe_size = output_params.hdf5_subfiling_stripe_size;
+  }
+  PARTHENON_HDF5_CHECK(H5Pset_fapl_subfiling(acc_file, &config));
+#else
+  warn("HDF5 subfiling requires MPI and HDF5 (1.14 or newer) built with the subfiling "
+       "VFD, writing a single file instead.");
+#endif
+}
+
+// Link name at location to the object at path in the file target_file, which HDF5 looks
+// up relative to the directory of the file that contains the link
+void LinkExternal(const std::string &target_file, const std::string &path,
+                  hid_t location, const std::string &name) {
+  PARTHENON_HDF5_CHECK(H5Lcreate_external(target_file.c_str(), path.c_str(), location,
+                                          name.c_str(), H5P_DEFAULT, H5P_DEFAULT));
+}
+} // namespace
+
 void PHDF5Output::WriteOutputFile(Mesh *pm, ParameterInput *pin, SimTime *tm,
                                   const SignalHandler::OutputSignal signal) {
   using namespace HDF5;
+  // The HDF5 library must not be used while a previous output is still being written
+  AsyncWriter::Instance().Wait();
   if (output_params.single_precision_output) {
     this->template WriteOutputFileImpl<true>(pm, pin, tm, signal);
   } else {
@@ -56,6 +210,26 @@ void PHDF5Output::WriteOutputFile(Mesh *pm, ParameterInput *pin, SimTime *tm,
   }
 }
 
+bool PHDF5Output::UseAsyncWrite_() const {
+  if (!output_params.async_write) return false;
+#ifdef MPI_PARALLEL
+  // The background thread does collective MPI-IO while the main thread communicates
+  int provided;
+  PARTHENON_MPI_CHECK(MPI_Query_thread(&provided));
+  if (provided < MPI_THREAD_MULTIPLE) {
+    static bool warned = false;
+    if (!warned && Globals::my_rank == 0) {
+      PARTHENON_WARN("Asynchronous HDF5 output requires MPI_THREAD_MULTIPLE (set "
+                     "PARTHENON_MPI_THREAD_MULTIPLE=1 in the environment), writing "
+                     "synchronously instead.");
+    }
+    warned = true;
+    return false;
+  }
+#endif
+  return true;
+}
+
 //----------------------------------------------------------------------------------------
 //! \fn void PHDF5Output:::WriteOutputFileImpl(Mesh *pm, ParameterInput *pin, bool flag)
 //  \brief Cycles over all MeshBlocks and writes OutputData in the Parthenon HDF5 format,
@@ -76,8 +250,10 @@ void PHDF5Output::WriteOutputFileImpl(Mesh *pm, ParameterInput *pin, SimTime *tm
   // HDF5 structures
   // Also writes companion xdmf file
 
-  const size_t max_blocks_global = pm->nbtotal;
-  const size_t num_blocks_local = pm->block_list.size();
+  // Regular outputs may only contain the blocks in a region of interest
+  const OutputBlocks out_blocks(pm, output_params);
+  const size_t max_blocks_global = out_blocks.NumGlobal();
+  const size_t num_blocks_local = out_blocks.blocks.size();
 
   const IndexDomain theDomain =
       (output_params.include_ghost_zones ? IndexDomain::entire : IndexDomain::interior);
@@ -96,11 +272,41 @@ void PHDF5Output::WriteOutputFileImpl(Mesh *pm, ParameterInput *pin, SimTime *tm
   const auto &nblist = pm->GetNbList();
 
   // open HDF5 file
-  // Define output filename
+  // Only every fast_flush_every-th restart (and the ones triggered by signals) are
+  // written to the regular location, all others go to the fast tier, where they are
+  // written under a temporary name, so that only complete files can be restarted from.
+  // With emergency_flush, restarts triggered by signals are written to the fast tier as
+  // well and copied to the regular location in the background, so that there is a
+  // complete restart file as soon as possible if the job is about to be killed.
+  const bool emergency = restart_ && !output_params.fast_dir.empty() &&
+                         output_params.emergency_flush &&
+                         signal != SignalHandler::OutputSignal::none;
+  const bool fast_tier =
+      restart_ && !output_params.fast_dir.empty() &&
+      (emergency || (signal == SignalHandler::OutputSignal::none &&
+                     output_params.file_number % output_params.fast_flush_every != 0));
+  // Define output filename, which advances the file number of regular outputs
+  const int output_number = output_params.file_number;
   auto filename = GenerateFilename_(pin, tm, signal);
+  const std::string regular_filename = filename;
+  std::string published_filename = filename;
+  if (fast_tier) {
+    published_filename = output_params.fast_dir + "/" +
+                         filename.substr(filename.find_last_of('/') + 1);
+    filename = published_filename + ".tmp";
+  }
+  if (max_blocks_global == 0) {
+    if (Globals::my_rank == 0) {
+      PARTHENON_WARN("No blocks in the output region of " + output_params.block_name +
+                     ", not writing " + filename);
+    }
+    Kokkos::Profiling::popRegion(); // WriteOutputFile???Prec
+    return;
+  }
 
   // set file access property list
-  H5P const acc_file = H5P::FromHIDCheck(HDF5::GenerateFileAccessProps());
+  H5P acc_file = H5P::FromHIDCheck(HDF5::GenerateFileAccessProps());
+  if (output_params.hdf5_subfiling) SetSubfiling(acc_file, output_params);
 
   // now create the file
   H5F file;
@@ -115,6 +321,43 @@ void PHDF5Output::WriteOutputFileImpl(Mesh *pm, ParameterInput *pin, SimTime *tm
     PARTHENON_THROW(err)
   }
 
+  // In asynchronous mode all data is copied to host buffers and the datasets are written
+  // on a background thread, so the simulation only has to wait for the copies. The next
+  // HDF5 output waits for the write to finish before it starts.
+  const bool async = UseAsyncWrite_();
+  auto staged = std::make_shared<StagedHDF5Output>();
+  auto write_or_stage = [&](std::function<void()> write) {
+    if (async) {
+      staged->writes.push_back(std::move(write));
+    } else {
+      write();
+    }
+  };
+
+  // Incremental restarts only contain the data of the blocks that changed since the last
+  // full restart (their base). This requires the mesh and its partition to be unchanged
+  // since the base, which is known on all ranks, so all ranks come to the same decision.
+  const bool track_changes = restart_ && output_params.incremental;
+  // Regular outputs can link the block metadata and coordinates of the last file that
+  // contains them instead of writing them again, as long as the mesh is unchanged
+  const bool reuse_metadata = !restart_ && output_params.reuse_mesh_metadata;
+  std::size_t mesh_hash = 0;
+  if (track_changes || reuse_metadata) {
+    for (const auto &loc : pm->GetLocList())
+      mesh_hash = impl::hash_combine(mesh_hash, loc);
+    for (const auto &nb : nblist)
+      mesh_hash = impl::hash_combine(mesh_hash, nb);
+  }
+  const bool incremental =
+      track_changes && !incremental_base_.filename.empty() &&
+      incremental_base_.mesh_hash == mesh_hash &&
+      incremental_base_.num_increments < output_params.incremental_full_every;
+  const std::string metadata_link =
+      (reuse_metadata && !mesh_metadata_.filename.empty() &&
+       mesh_metadata_.mesh_hash == mesh_hash)
+          ? mesh_metadata_.filename.substr(mesh_metadata_.filename.find_last_of('/') + 1)
+          : "";
+
   // -------------------------------------------------------------------------------- //
   //   WRITING ATTRIBUTES                                                             //
   // -------------------------------------------------------------------------------- //
@@ -133,7 +376,8 @@ void PHDF5Output::WriteOutputFileImpl(Mesh *pm, ParameterInput *pin, SimTime *tm
   }                                 // Input section
 
   // we'll need this again at the end
-  const H5G info_group = MakeGroup(file, "/Info");
+  staged->groups.push_back(MakeGroup(file, "/Info"));
+  const hid_t info_group = staged->groups.back();
   {
     Kokkos::Profiling::pushRegion("write Info");
     HDF5WriteAttribute("OutputFormatVersion", OUTPUT_VERSION_FORMAT, info_group);
@@ -146,7 +390,7 @@ void PHDF5Output::WriteOutputFileImpl(Mesh *pm, ParameterInput *pin, SimTime *tm
 
     HDF5WriteAttribute("WallTime", Driver::elapsed_main(), info_group);
     HDF5WriteAttribute("NumDims", pm->ndim, info_group);
-    HDF5WriteAttribute("NumMeshBlocks", pm->nbtotal, info_group);
+    HDF5WriteAttribute("NumMeshBlocks", static_cast<int>(max_blocks_global), info_group);
     HDF5WriteAttribute("MaxLevel", max_level, info_group);
     // write whether we include ghost cells or not
     HDF5WriteAttribute("IncludesGhost", output_params.include_ghost_zones ? 1 : 0,
@@ -163,7 +407,23 @@ void PHDF5Output::WriteOutputFileImpl(Mesh *pm, ParameterInput *pin, SimTime *tm
     HDF5WriteAttribute("Refine", pm->adaptive ? 1 : 0, info_group);
     HDF5WriteAttribute("Multilevel", pm->multilevel ? 1 : 0, info_group);
 
-    HDF5WriteAttribute("BlocksPerPE", nblist, info_group);
+    HDF5WriteAttribute("BlocksPerPE", out_blocks.nblist, info_group);
+    if (!metadata_link.empty()) {
+      HDF5WriteAttribute("MeshMetadataFile", metadata_link.c_str(), info_group);
+    }
+    if (incremental) {
+      // relative to the directory of this file
+      const auto &base = incremental_base_.filename;
+      HDF5WriteAttribute("IncrementalBase",
+                         base.substr(base.find_last_of('/') + 1).c_str(), info_group);
+    }
+    if (output_params.raw_block_data) {
+      // relative to the directory of this file
+      HDF5WriteAttribute(
+          "RawBlockData",
+          published_filename.substr(published_filename.find_last_of('/') + 1).c_str(),
+          info_group);
+    }
 
     // Mesh block size
     HDF5WriteAttribute("MeshBlockSize", std::vector<int>{nx1, nx2, nx3}, info_group);
@@ -213,13 +473,10 @@ void PHDF5Output::WriteOutputFileImpl(Mesh *pm, ParameterInput *pin, SimTime *tm
   // -------------------------------------------------------------------------------- //
 
   // set local offset, always the same for all data sets
-  hsize_t my_offset = 0;
-  for (int i = 0; i < Globals::my_rank; i++) {
-    my_offset += nblist[i];
-  }
+  const hsize_t my_offset = out_blocks.offset;
 
-  H5P const pl_xfer = H5P::FromHIDCheck(H5Pcreate(H5P_DATASET_XFER));
-  H5P const pl_dcreate = H5P::FromHIDCheck(H5Pcreate(H5P_DATASET_CREATE));
+  H5P pl_xfer = H5P::FromHIDCheck(H5Pcreate(H5P_DATASET_XFER));
+  H5P pl_dcreate = H5P::FromHIDCheck(H5Pcreate(H5P_DATASET_CREATE));
 
   // Never write fill values to the dataset
   PARTHENON_HDF5_CHECK(H5Pset_fill_time(pl_dcreate, H5D_FILL_TIME_NEVER));
@@ -228,9 +485,15 @@ void PHDF5Output::WriteOutputFileImpl(Mesh *pm, ParameterInput *pin, SimTime *tm
   PARTHENON_HDF5_CHECK(H5Pset_dxpl_mpio(pl_xfer, H5FD_MPIO_COLLECTIVE));
 #endif
 
-  WriteBlocksMetadata_(pm, file, pl_xfer, my_offset, max_blocks_global);
-  WriteCoordinates_(pm, theDomain, file, pl_xfer, my_offset, max_blocks_global);
-  WriteLevelsAndLocs_(pm, file, pl_xfer, my_offset, max_blocks_global);
+  WriteBlocksMetadata_(pm, file, pl_xfer, out_blocks, metadata_link);
+  WriteCoordinates_(pm, theDomain, file, pl_xfer, out_blocks, metadata_link);
+  WriteLevelsAndLocs_(pm, file, pl_xfer, out_blocks, metadata_link);
+  // only numbered files can be referred to, "now" and "final" files are overwritten
+  if (reuse_metadata && metadata_link.empty() &&
+      signal == SignalHandler::OutputSignal::none) {
+    mesh_metadata_.filename = filename;
+    mesh_metadata_.mesh_hash = mesh_hash;
+  }
 
   // -------------------------------------------------------------------------------- //
   //   WRITING VARIABLES DATA                                                         //
@@ -270,6 +533,27 @@ void PHDF5Output::WriteOutputFileImpl(Mesh *pm, ParameterInput *pin, SimTime *tm
   auto all_vars_info =
       VarInfo::GetAll(get_vars(pm->block_list.front()), cellbounds, f_cellbounds);
 
+  // Variables listed in variable_every are only written every so many outputs, but all
+  // of them are written to the "now" and "final" files. Entries match the label or, for
+  // sparse variables, the base name.
+  if (!output_params.variable_every.empty() &&
+      signal == SignalHandler::OutputSignal::none) {
+    std::unordered_map<std::string, int> every;
+    for (const auto &v : get_vars(pm->block_list.front())) {
+      for (const auto &name : {v->base_name(), v->label()}) {
+        auto it = output_params.variable_every.find(name);
+        if (it != output_params.variable_every.end()) every[v->label()] = it->second;
+      }
+    }
+    all_vars_info.erase(std::remove_if(all_vars_info.begin(), all_vars_info.end(),
+                                       [&](const VarInfo &vinfo) {
+                                         auto it = every.find(vinfo.label);
+                                         return it != every.end() &&
+                                                output_number % it->second != 0;
+                                       }),
+                        all_vars_info.end());
+  }
+
   // We need to add information about the sparse variables to the HDF5 file, namely:
   // 1) Which variables are sparse
   // 2) Is a sparse id of a particular sparse variable allocated on a given block
@@ -300,23 +584,100 @@ void PHDF5Output::WriteOutputFileImpl(Mesh *pm, ParameterInput *pin, SimTime *tm
   std::unique_ptr<hbool_t[]> sparse_allocated(new hbool_t[num_blocks_local * num_sparse]);
   std::vector<int> sparse_dealloc_count(num_blocks_local * num_sparse);
 
-  // allocate space for largest size variable
+  // The datasets to write and the variables in them. With hdf5_group_variables, the
+  // variables on the mesh that share their topological location, file type, and
+  // compressor are concatenated along the component axis of one dataset per group (see
+  // VarGroupLayout), which cuts the number of dataset creations and collective writes.
+  struct OutputDataset {
+    std::string name;
+    std::vector<const VarInfo *> vars;
+    std::vector<int> offsets; // first component of every variable in the group
+    int ncomp;                // components of all variables in the group, 0 if no group
+  };
+  std::vector<OutputDataset> datasets;
+  std::map<std::string, VarGroupLayout> var_groups;
+  {
+    std::map<std::tuple<std::string, bool, std::string>, std::size_t> group_idx;
+    for (const auto &vinfo : all_vars_info) {
+      if (!output_params.hdf5_group_variables ||
+          vinfo.where == MetadataFlag({Metadata::None})) {
+        datasets.push_back({vinfo.label, {&vinfo}, {0}, 0});
+        continue;
+      }
+      auto it = output_params.hdf5_variable_compressors.find(vinfo.label);
+      const std::string &compressor = it != output_params.hdf5_variable_compressors.end()
+                                          ? it->second
+                                          : output_params.hdf5_compressor;
+      const auto key = std::make_tuple(Metadata::LocationToString(vinfo.where),
+                                       vinfo.reduced_precision, compressor);
+      auto [g, inserted] = group_idx.emplace(key, datasets.size());
+      if (inserted) {
+        datasets.push_back(
+            {"VariableGroup" + std::to_string(group_idx.size() - 1), {}, {}, 0});
+      }
+      auto &dset = datasets[g->second];
+      const auto [n3, n2, n1] = vinfo.GetNumKJI(theDomain);
+      const int ncomp = vinfo.FillSize(theDomain) / (n3 * n2 * n1);
+      dset.vars.push_back(&vinfo);
+      dset.offsets.push_back(dset.ncomp);
+      var_groups[vinfo.label] = {dset.name, dset.ncomp, ncomp, 0};
+      dset.ncomp += ncomp;
+    }
+    for (const auto &dset : datasets) {
+      for (const auto *vinfo : dset.vars) {
+        if (dset.ncomp > 0) var_groups.at(vinfo->label).ncomp_group = dset.ncomp;
+      }
+    }
+  }
+
+  // allocate space for largest dataset
   size_t varSize_max = 0;
-  for (auto &vinfo : all_vars_info) {
-    const size_t varSize = vinfo.Size();
+  for (const auto &dset : datasets) {
+    size_t varSize = 0;
+    for (const auto *vinfo : dset.vars)
+      varSize += vinfo->Size();
     varSize_max = std::max(varSize_max, varSize);
   }
 
   using OutT = typename std::conditional<WRITE_SINGLE_PRECISION, float, Real>::type;
-  std::vector<OutT> tmpData(varSize_max * num_blocks_local);
+  const size_t tmp_size = output_params.raw_block_data ? 0 : varSize_max;
+  std::vector<OutT> tmpData(tmp_size * num_blocks_local);
 
   // for each variable we write
-  for (auto &vinfo : all_vars_info) {
+  if (incremental) staged->groups.push_back(MakeGroup(file, "/Incremental"));
+
+  // IEEE 754 half precision, which HDF5 converts the single precision data to
+  if (output_params.half_precision_output) {
+    staged->var_file_type = H5T::FromHIDCheck(H5Tcopy(H5T_IEEE_F32LE));
+    PARTHENON_HDF5_CHECK(H5Tset_fields(staged->var_file_type, 15, 10, 5, 0, 10));
+    PARTHENON_HDF5_CHECK(H5Tset_size(staged->var_file_type, 2));
+    PARTHENON_HDF5_CHECK(H5Tset_ebias(staged->var_file_type, 15));
+    PARTHENON_HDF5_CHECK(H5Tpack(staged->var_file_type));
+  }
+  const hid_t var_file_type = output_params.half_precision_output
+                                  ? static_cast<hid_t>(staged->var_file_type)
+                                  : H5I_INVALID_HID;
+  // The variables of restarts with raw_block_data go to the raw files instead of datasets
+  if (output_params.raw_block_data) {
+    WriteRawBlockData_(published_filename, file, pl_xfer, out_blocks, all_vars_info,
+                       sparse_field_idx, sparse_allocated.get(), sparse_dealloc_count);
+  }
+  const std::vector<OutputDataset> no_datasets;
+  for (const auto &dset : output_params.raw_block_data ? no_datasets : datasets) {
     Kokkos::Profiling::pushRegion("write variable loop");
+    // all variables of a group share these
+    const VarInfo &first_vinfo = *dset.vars.front();
+    const bool is_group = dset.ncomp > 0;
+    // Variables that tolerate reduced precision are converted by HDF5 when writing
+    // double precision files, and converted back when they are read on restart
+    const hid_t dset_file_type =
+        (first_vinfo.reduced_precision && sizeof(OutT) > sizeof(float))
+            ? H5T_NATIVE_FLOAT
+            : var_file_type;
     // not really necessary, but doesn't hurt
     memset(tmpData.data(), 0, tmpData.size() * sizeof(OutT));
 
-    const std::string var_name = vinfo.label;
+    const std::string var_name = dset.name;
 
     hsize_t local_offset[H5_NDIM];
     std::fill(local_offset + 1, local_offset + H5_NDIM, 0);
@@ -328,85 +689,184 @@ void PHDF5Output::WriteOutputFileImpl(Mesh *pm, ParameterInput *pin, SimTime *tm
     hsize_t global_count[H5_NDIM];
     global_count[0] = static_cast<hsize_t>(max_blocks_global);
 
-    // block index + variable on block dimensions
-    int ndim = 1 + vinfo.FillShape(theDomain, &(local_count[1]), &(global_count[1]));
+    // block index + variable on block dimensions, or block, component, k, j, i for groups
+    const auto [n3, n2, n1] = first_vinfo.GetNumKJI(theDomain);
+    int ndim;
+    if (is_group) {
+      ndim = 5;
+      local_count[1] = global_count[1] = dset.ncomp;
+      local_count[2] = global_count[2] = n3;
+      local_count[3] = global_count[3] = n2;
+      local_count[4] = global_count[4] = n1;
+    } else {
+      ndim = 1 + first_vinfo.FillShape(theDomain, &(local_count[1]), &(global_count[1]));
+    }
 
 #ifndef PARTHENON_DISABLE_HDF5_COMPRESSION
-    // we need chunks to enable compression. Do not run the pipeline
-    // if compression is soft disabled.  By default data would still
-    // be passed, which may result in slower output.
-    if (output_params.hdf5_compression_level > 0) {
-      std::array<hsize_t, H5_NDIM> chunk_size;
-      std::fill(chunk_size.begin(), chunk_size.end(), 1);
-      for (int i = 1; i < ndim; ++i) {
-        chunk_size[i] = local_count[i];
-      }
-      if (vinfo.where != MetadataFlag(Metadata::None)) {
-        std::fill(&(chunk_size[0]), &(chunk_size[0]) + ndim - 3, 1);
-      }
-      PARTHENON_HDF5_CHECK(H5Pset_chunk(pl_dcreate, ndim, chunk_size.data()));
-      PARTHENON_HDF5_CHECK(
-          H5Pset_deflate(pl_dcreate, std::min(9, output_params.hdf5_compression_level)));
+    // we need chunks to enable compression, which are aligned with the blocks (and the
+    // components of non-cell variables), so that every block is compressed on its own
+    std::array<hsize_t, H5_NDIM> chunk_size;
+    std::fill(chunk_size.begin(), chunk_size.end(), 1);
+    for (int i = 1; i < ndim; ++i) {
+      chunk_size[i] = local_count[i];
     }
+    if (first_vinfo.where != MetadataFlag(Metadata::None)) {
+      std::fill(&(chunk_size[0]), &(chunk_size[0]) + ndim - 3, 1);
+    }
+    // all variables of a group have the same compressor
+    SetCompression(pl_dcreate, output_params, first_vinfo.label, ndim,
+                   chunk_size.data());
 #endif
 
-    // load up data
-    hsize_t index = 0;
+    // load up data, every variable of a group at its first component on every block
+    const hsize_t block_size = is_group ? static_cast<hsize_t>(dset.ncomp) * n3 * n2 * n1
+                                        : first_vinfo.FillSize(theDomain);
 
     Kokkos::Profiling::pushRegion("fill host output buffer");
     // for each local mesh block
     for (size_t b_idx = 0; b_idx < num_blocks_local; ++b_idx) {
-      const auto &pmb = pm->block_list[b_idx];
-      bool is_allocated = false;
-      int dealloc_count = 0;
+      const auto &pmb = out_blocks.blocks[b_idx];
       // for each variable that this local meshblock actually has
       const auto vars = get_vars(pmb);
-      for (auto &v : vars) {
-        // For reference, if we update the logic here, there's also
-        // a similar block in parthenon_manager.cpp
-        if (v->IsAllocated() && (var_name == v->label())) {
-          auto v_h = v->data.GetHostMirrorAndCopy();
-          OutputUtils::PackOrUnpackVar(
-              vinfo, output_params.include_ghost_zones, index,
-              [&](auto index, int topo, int t, int u, int v, int k, int j, int i) {
-                tmpData[index] = static_cast<OutT>(v_h(topo, t, u, v, k, j, i));
-              });
-          is_allocated = true;
-          dealloc_count = v->dealloc_count;
-          break;
+      for (std::size_t n = 0; n < dset.vars.size(); ++n) {
+        const VarInfo &vinfo = *dset.vars[n];
+        hsize_t index = b_idx * block_size + static_cast<hsize_t>(dset.offsets[n]) * n3 *
+                                                 n2 * n1;
+        bool is_allocated = false;
+        int dealloc_count = 0;
+        for (auto &v : vars) {
+          // For reference, if we update the logic here, there's also
+          // a similar block in parthenon_manager.cpp
+          if (v->IsAllocated() && (vinfo.label == v->label())) {
+            auto v_h = v->data.GetHostMirrorAndCopy();
+            OutputUtils::PackOrUnpackVar(
+                vinfo, output_params.include_ghost_zones, index,
+                [&](auto index, int topo, int t, int u, int v, int k, int j, int i) {
+                  tmpData[index] = static_cast<OutT>(v_h(topo, t, u, v, k, j, i));
+                });
+            is_allocated = true;
+            dealloc_count = v->dealloc_count;
+            break;
+          }
         }
-      }
-
-      if (vinfo.is_sparse) {
-        size_t sparse_idx = sparse_field_idx.at(vinfo.label);
-        sparse_allocated[b_idx * num_sparse + sparse_idx] = is_allocated;
-        sparse_dealloc_count[b_idx * num_sparse + sparse_idx] = dealloc_count;
-      }
 
-      if (!is_allocated) {
         if (vinfo.is_sparse) {
-          hsize_t varSize = vinfo.FillSize(theDomain);
-          auto fill_val =
-              output_params.sparse_seed_nans ? std::numeric_limits<OutT>::quiet_NaN() : 0;
-          std::fill(tmpData.data() + index, tmpData.data() + index + varSize, fill_val);
-          index += varSize;
-        } else {
-          std::stringstream msg;
-          msg << "### ERROR: Unable to find dense variable " << var_name << std::endl;
-          PARTHENON_FAIL(msg);
+          size_t sparse_idx = sparse_field_idx.at(vinfo.label);
+          sparse_allocated[b_idx * num_sparse + sparse_idx] = is_allocated;
+          sparse_dealloc_count[b_idx * num_sparse + sparse_idx] = dealloc_count;
+        }
+
+        if (!is_allocated) {
+          if (vinfo.is_sparse) {
+            hsize_t varSize = vinfo.FillSize(theDomain);
+            auto fill_val = output_params.sparse_seed_nans
+                                ? std::numeric_limits<OutT>::quiet_NaN()
+                                : 0;
+            std::fill(tmpData.data() + index, tmpData.data() + index + varSize,
+                      fill_val);
+          } else {
+            std::stringstream msg;
+            msg << "### ERROR: Unable to find dense variable " << vinfo.label
+                << std::endl;
+            PARTHENON_FAIL(msg);
+          }
         }
       }
     }
     Kokkos::Profiling::popRegion(); // fill host output buffer
 
+    // For incremental restarts, move the data of the changed blocks to the front and
+    // only write those, otherwise remember the state of the blocks for the next ones
+    std::shared_ptr<std::vector<std::int64_t>> changed_gids;
+    if (track_changes) {
+      auto &hashes = incremental_base_.hashes[var_name];
+      if (incremental) {
+        changed_gids = std::make_shared<std::vector<std::int64_t>>();
+        size_t num_changed = 0;
+        for (size_t b_idx = 0; b_idx < num_blocks_local; ++b_idx) {
+          const OutT *block_data = tmpData.data() + b_idx * block_size;
+          if (b_idx < hashes.size() &&
+              impl::hash_bytes(block_data, block_size) == hashes[b_idx])
+            continue;
+          if (num_changed != b_idx) {
+            std::copy(block_data, block_data + block_size,
+                      tmpData.data() + num_changed * block_size);
+          }
+          changed_gids->push_back(out_blocks.blocks[b_idx]->gid);
+          ++num_changed;
+        }
+        size_t total_changed;
+        local_offset[0] = MPIPrefixSum(num_changed, total_changed);
+        local_count[0] = num_changed;
+        global_count[0] = total_changed;
+        if (total_changed == 0) {
+          // chunks can't be larger than the (empty) dataset
+          PARTHENON_HDF5_CHECK(H5Premove_filter(pl_dcreate, H5Z_FILTER_ALL));
+          PARTHENON_HDF5_CHECK(H5Pset_layout(pl_dcreate, H5D_CONTIGUOUS));
+        }
+      } else {
+        hashes.resize(num_blocks_local);
+        for (size_t b_idx = 0; b_idx < num_blocks_local; ++b_idx) {
+          hashes[b_idx] =
+              impl::hash_bytes(tmpData.data() + b_idx * block_size, block_size);
+        }
+      }
+    }
+
     Kokkos::Profiling::pushRegion("write variable data");
     // write data to file
-    { // scope so the dataset gets closed
-      HDF5WriteND(file, var_name, tmpData.data(), ndim, &local_offset[0], &local_count[0],
-                  &global_count[0], pl_xfer, pl_dcreate);
-      H5D dset = H5D::FromHIDCheck(H5Dopen2(file, var_name.c_str(), H5P_DEFAULT));
-      HDF5WriteAttribute("TopologicalLocation", Metadata::LocationToString(vinfo.where),
-                         dset);
+    std::shared_ptr<std::vector<OutT>> data;
+    const OutT *pdata = tmpData.data();
+    hid_t dcreate = pl_dcreate;
+    if (async) {
+      // keep the buffer and the chunking/compression settings of this dataset
+      data = std::make_shared<std::vector<OutT>>(std::move(tmpData));
+      tmpData.resize(varSize_max * num_blocks_local);
+      pdata = data->data();
+      staged->dcreate_props.push_back(H5P::FromHIDCheck(H5Pcopy(pl_dcreate)));
+      dcreate = staged->dcreate_props.back();
+    }
+    // Groups record which variables they contain, where, and the shape the variables
+    // have in ungrouped files
+    std::vector<std::string> group_names, group_shapes;
+    std::vector<int> group_offsets, group_ncomps;
+    for (std::size_t n = 0; is_group && n < dset.vars.size(); ++n) {
+      const VarInfo &vinfo = *dset.vars[n];
+      group_names.push_back(vinfo.label);
+      group_offsets.push_back(dset.offsets[n]);
+      group_ncomps.push_back(var_groups.at(vinfo.label).ncomp);
+      hsize_t shape[H5_NDIM];
+      const int vndim = vinfo.FillShape(theDomain, shape);
+      std::string shape_str;
+      for (int d = 0; d < vndim; ++d)
+        shape_str += (d > 0 ? " " : "") + std::to_string(shape[d]);
+      group_shapes.push_back(shape_str);
+    }
+    write_or_stage([data, pdata, dcreate, var_name, ndim, local_offset, local_count,
+                    global_count, file_id = static_cast<hid_t>(file),
+                    xfer = static_cast<hid_t>(pl_xfer), where = first_vinfo.where,
+                    dset_file_type, group_names, group_offsets, group_ncomps,
+                    group_shapes]() {
+      HDF5WriteND(file_id, var_name, pdata, ndim, &local_offset[0], &local_count[0],
+                  &global_count[0], xfer, dcreate, dset_file_type);
+      H5D dset = H5D::FromHIDCheck(H5Dopen2(file_id, var_name.c_str(), H5P_DEFAULT));
+      HDF5WriteAttribute("TopologicalLocation", Metadata::LocationToString(where), dset);
+      if (!group_names.empty()) {
+        HDF5WriteAttribute("VariableNames", group_names, dset);
+        HDF5WriteAttribute("VariableOffsets", group_offsets, dset);
+        HDF5WriteAttribute("VariableComponents", group_ncomps, dset);
+        HDF5WriteAttribute("VariableShapes", group_shapes, dset);
+      }
+    });
+    if (incremental) {
+      // global ids of the blocks in the dataset
+      write_or_stage([changed_gids, var_name, offset = local_offset[0],
+                      count = local_count[0], total = global_count[0],
+                      file_id = static_cast<hid_t>(file),
+                      xfer = static_cast<hid_t>(pl_xfer)]() {
+        HDF5WriteND(file_id, "/Incremental/" + var_name, changed_gids->data(), 1, &offset,
+                    &count, &total, xfer, H5P_DEFAULT);
+      });
     }
     Kokkos::Profiling::popRegion(); // write variable data
     Kokkos::Profiling::popRegion(); // write variable loop
@@ -440,12 +900,27 @@ void PHDF5Output::WriteOutputFileImpl(Mesh *pm, ParameterInput *pin, SimTime *tm
   HDF5WriteAttribute("NumComponents", num_components, info_group);
   HDF5WriteAttribute("ComponentNames", component_names, info_group);
   HDF5WriteAttribute("OutputDatasetNames", var_names, info_group);
+  // where the variables of grouped datasets are, for readers that only look at the Info
+  if (!var_groups.empty()) {
+    std::vector<std::string> grouped_vars, grouped_datasets;
+    std::vector<int> grouped_offsets, grouped_ncomps;
+    for (const auto &[label, layout] : var_groups) {
+      grouped_vars.push_back(label);
+      grouped_datasets.push_back(layout.dataset);
+      grouped_offsets.push_back(layout.offset);
+      grouped_ncomps.push_back(layout.ncomp);
+    }
+    HDF5WriteAttribute("GroupedVariables", grouped_vars, info_group);
+    HDF5WriteAttribute("GroupedVariableDatasets", grouped_datasets, info_group);
+    HDF5WriteAttribute("GroupedVariableOffsets", grouped_offsets, info_group);
+    HDF5WriteAttribute("GroupedVariableComponents", grouped_ncomps, info_group);
+  }
 
   // write SparseInfo and SparseFields (we can't write a zero-size dataset, so only write
   // this if we have sparse fields)
   if (num_sparse > 0) {
-    WriteSparseInfo_(pm, sparse_allocated.get(), sparse_dealloc_count, sparse_names,
-                     num_sparse, file, pl_xfer, my_offset, max_blocks_global);
+    WriteSparseInfo_(sparse_allocated.get(), sparse_dealloc_count, sparse_names,
+                     num_sparse, file, pl_xfer, out_blocks);
   } // SparseInfo and SparseFields sections
 
   // -------------------------------------------------------------------------------- //
@@ -453,21 +928,48 @@ void PHDF5Output::WriteOutputFileImpl(Mesh *pm, ParameterInput *pin, SimTime *tm
   // -------------------------------------------------------------------------------- //
 
   Kokkos::Profiling::pushRegion("write particle data");
-  AllSwarmInfo swarm_info(pm->block_list, output_params.swarms, restart_);
+  AllSwarmInfo swarm_info(out_blocks.blocks, output_params.swarms, restart_,
+                          output_params.swarm_selections);
+  // Write (or stage) a copy of host_data as a dataset of location
+  // Writes count elements of the shared host buffer, starting at start. All variables of
+  // a type share one buffer, so staging them for asynchronous writes copies nothing.
+  auto write_swarm_buffer = [&](hid_t location, const std::string &name, auto data,
+                                std::size_t start, int rank, const hsize_t *local_offset,
+                                const hsize_t *local_count, const hsize_t *global_count) {
+    std::array<hsize_t, 6> offset, count, global;
+    std::copy(local_offset, local_offset + rank, offset.begin());
+    std::copy(local_count, local_count + rank, count.begin());
+    std::copy(global_count, global_count + rank, global.begin());
+    write_or_stage([data, start, location, name, rank, offset, count, global,
+                    xfer = static_cast<hid_t>(pl_xfer)]() {
+      HDF5WriteND(location, name, data->data() + start, rank, offset.data(), count.data(),
+                  global.data(), xfer, H5P_DEFAULT);
+    });
+  };
+  auto write_swarm_data = [&](hid_t location, const std::string &name, auto &&host_data,
+                              int rank, const hsize_t *local_offset,
+                              const hsize_t *local_count, const hsize_t *global_count) {
+    using vec_t = std::decay_t<decltype(host_data)>;
+    auto data = std::make_shared<vec_t>(std::forward<decltype(host_data)>(host_data));
+    write_swarm_buffer(location, name, data, 0, rank, local_offset, local_count,
+                       global_count);
+  };
   for (auto &[swname, swinfo] : swarm_info.all_info) {
-    const H5G g_swm = MakeGroup(file, swname);
+    staged->groups.push_back(MakeGroup(file, swname));
+    const hid_t g_swm = staged->groups.back();
     // offsets/counts are NOT the same here vs the grid data
     hsize_t local_offset[6] = {static_cast<hsize_t>(my_offset), 0, 0, 0, 0, 0};
     hsize_t local_count[6] = {static_cast<hsize_t>(num_blocks_local), 0, 0, 0, 0, 0};
     hsize_t global_count[6] = {static_cast<hsize_t>(max_blocks_global), 0, 0, 0, 0, 0};
     // These indicate particles/meshblock and location in global index
     // space where each meshblock starts
-    HDF5Write1D(g_swm, "counts", swinfo.counts.data(), local_offset, local_count,
-                global_count, pl_xfer);
-    HDF5Write1D(g_swm, "offsets", swinfo.offsets.data(), local_offset, local_count,
-                global_count, pl_xfer);
+    write_swarm_data(g_swm, "counts", swinfo.counts, 1, local_offset, local_count,
+                     global_count);
+    write_swarm_data(g_swm, "offsets", swinfo.offsets, 1, local_offset, local_count,
+                     global_count);
 
-    const H5G g_var = MakeGroup(g_swm, "SwarmVars");
+    staged->groups.push_back(MakeGroup(g_swm, "SwarmVars"));
+    const hid_t g_var = staged->groups.back();
     if (swinfo.global_count == 0) {
       continue;
     }
@@ -496,27 +998,32 @@ void PHDF5Output::WriteOutputFileImpl(Mesh *pm, ParameterInput *pin, SimTime *tm
       global_count[0] = swinfo.global_count;
       local_count[1] = global_count[1] = 3;
     };
-    auto &int_vars = std::get<SwarmInfo::MapToVarVec<int>>(swinfo.vars);
-    for (auto &[vname, swmvarvec] : int_vars) {
+    // Every rank packs all its variables of a type into one buffer with a single
+    // device to host copy, the datasets are then written from slices of that buffer
+    std::map<std::string, std::size_t> var_offsets;
+    auto int_data =
+        std::make_shared<std::vector<int>>(swinfo.FillHostBuffers<int>(var_offsets));
+    for (auto &[vname, swmvarvec] : swinfo.Vars<int>()) {
       const auto &vinfo = swinfo.var_info.at(vname);
-      auto host_data = swinfo.FillHostBuffer(vname, swmvarvec);
       SetCounts(swinfo, vinfo);
-      HDF5WriteND(g_var, vname, host_data.data(), vinfo.tensor_rank + 1, local_offset,
-                  local_count, global_count, pl_xfer, H5P_DEFAULT);
+      write_swarm_buffer(g_var, vname, int_data, var_offsets.at(vname),
+                         vinfo.tensor_rank + 1, local_offset, local_count, global_count);
     }
     std::vector<Real> pos_tmp; // tmp vector to (potentially) hold particle positions
-    auto &rvars = std::get<SwarmInfo::MapToVarVec<Real>>(swinfo.vars);
-    for (auto &[vname, swmvarvec] : rvars) {
+    auto real_data =
+        std::make_shared<std::vector<Real>>(swinfo.FillHostBuffers<Real>(var_offsets));
+    for (auto &[vname, swmvarvec] : swinfo.Vars<Real>()) {
       const auto &vinfo = swinfo.var_info.at(vname);
-      auto host_data = swinfo.FillHostBuffer(vname, swmvarvec);
+      const std::size_t start = var_offsets.at(vname);
       SetCounts(swinfo, vinfo);
-      HDF5WriteND(g_var, vname, host_data.data(), vinfo.tensor_rank + 1, local_offset,
-                  local_count, global_count, pl_xfer, H5P_DEFAULT);
       if (output_params.write_swarm_xdmf &&
           (vname == swarm_position::x::name() || vname == swarm_position::y::name() ||
            vname == swarm_position::z::name())) {
-        pos_tmp.insert(pos_tmp.end(), host_data.begin(), host_data.end());
+        const auto first = real_data->begin() + start;
+        pos_tmp.insert(pos_tmp.end(), first, first + swinfo.count_on_rank * vinfo.nvar);
       }
+      write_swarm_buffer(g_var, vname, real_data, start, vinfo.tensor_rank + 1,
+                         local_offset, local_count, global_count);
     }
     if (output_params.write_swarm_xdmf) {
       // TODO(@pdmullen): Here and above, we have worked with temp vectors pos_tmp and
@@ -534,8 +1041,8 @@ void PHDF5Output::WriteOutputFileImpl(Mesh *pm, ParameterInput *pin, SimTime *tm
         swarm_positions[spcnt++] = pos_tmp[2 * npart + i];
       }
       SetCountsParticlePositions(swinfo);
-      HDF5WriteND(g_var, "swarm_positions", swarm_positions.data(), 2, local_offset,
-                  local_count, global_count, pl_xfer, H5P_DEFAULT);
+      write_swarm_data(g_var, "swarm_positions", std::move(swarm_positions), 2,
+                       local_offset, local_count, global_count);
     }
 
     // If swarm does not contain an "id" object, generate a sequential
@@ -546,18 +1053,94 @@ void PHDF5Output::WriteOutputFileImpl(Mesh *pm, ParameterInput *pin, SimTime *tm
       local_offset[0] = swinfo.global_offset;
       local_count[0] = swinfo.count_on_rank;
       global_count[0] = swinfo.global_count;
-      HDF5Write1D(g_var, "id", ids.data(), local_offset, local_count, global_count,
-                  pl_xfer);
+      write_swarm_data(g_var, "id", std::move(ids), 1, local_offset, local_count,
+                       global_count);
     }
   }
   Kokkos::Profiling::popRegion(); // write particle data
 
   if (output_params.write_xdmf || output_params.write_swarm_xdmf) {
-    Kokkos::Profiling::pushRegion("genXDMF");
+    // Also timed by the TimerRegistry, see the I/O benchmark
+    PARTHENON_INSTRUMENT_REGION("genXDMF")
     // generate XDMF companion file
-    XDMF::genXDMF(filename, pm, tm, theDomain, nx1, nx2, nx3, all_vars_info, swarm_info,
-                  output_params.write_xdmf, output_params.write_swarm_xdmf);
-    Kokkos::Profiling::popRegion(); // genXDMF
+    XDMF::genXDMF(filename, pm, tm, out_blocks, theDomain, nx1, nx2, nx3, all_vars_info,
+                  swarm_info, output_params.write_xdmf, output_params.write_swarm_xdmf,
+                  var_groups);
+  }
+
+  if (track_changes) {
+    if (incremental) {
+      incremental_base_.num_increments++;
+    } else {
+      incremental_base_.filename = filename;
+      incremental_base_.mesh_hash = mesh_hash;
+      incremental_base_.num_increments = 0;
+    }
+  }
+
+  // Once the file is complete, move it to its final name and remove the previous file of
+  // the fast tier, which is superseded by this one
+  std::function<void()> publish = []() {};
+  if (restart_ && !output_params.fast_dir.empty()) {
+    publish = [fast_tier, filename, published_filename, previous = last_fast_file_,
+               raw = output_params.raw_block_data]() {
+      if (raw && !previous.empty()) {
+        std::remove(RawBlockData::Filename(previous, Globals::my_rank).c_str());
+      }
+      if (Globals::my_rank != 0) return;
+      if (fast_tier) std::rename(filename.c_str(), published_filename.c_str());
+      if (!previous.empty()) std::remove(previous.c_str());
+    };
+    last_fast_file_ = fast_tier ? published_filename : "";
+  }
+  std::function<void()> flush;
+  if (emergency) {
+    flush = [regular = regular_filename, published_filename,
+             raw = output_params.raw_block_data]() {
+      // every rank copies its raw file and rank 0 the restart file, each under a
+      // temporary name first
+      auto copy = [](const std::string &from, const std::string &to) {
+        std::error_code ec;
+        fs::copy_file(from, to + ".tmp", fs::copy_options::overwrite_existing, ec);
+        if (!ec) fs::rename(to + ".tmp", to, ec);
+        if (ec) {
+          std::cout << "[" << Globals::my_rank << "] WARNING: Failed to flush " << from
+                    << " to " << to << ": " << ec.message() << std::endl;
+        }
+        return !ec;
+      };
+      if (Globals::my_rank == 0) {
+        std::cout << "Restart file " << published_filename
+                  << " is complete, flushing it to " << regular << std::endl;
+      }
+      if (raw) {
+        copy(RawBlockData::Filename(published_filename, Globals::my_rank),
+             RawBlockData::Filename(regular, Globals::my_rank));
+      }
+      if (Globals::my_rank == 0 && copy(published_filename, regular)) {
+        std::cout << "Flushed restart file " << published_filename << " to " << regular
+                  << std::endl;
+      }
+    };
+  }
+
+  if (async) {
+    // hand all open HDF5 objects to the background thread, nothing may be closed here
+    // once it runs
+    staged->acc_file = std::move(acc_file);
+    staged->file = std::move(file);
+    staged->pl_xfer = std::move(pl_xfer);
+    staged->dcreate_props.push_back(std::move(pl_dcreate));
+    AsyncWriter::Instance().Submit([staged = std::move(staged), publish, flush]() {
+      staged->Finish();
+      publish();
+      if (flush) flush();
+    });
+  } else {
+    // close the groups before the file
+    staged->Finish();
+    publish();
+    if (flush) AsyncWriter::Instance().Submit(flush);
   }
 
   Kokkos::Profiling::popRegion(); // WriteOutputFile???Prec
@@ -604,40 +1187,51 @@ std::string PHDF5Output::GenerateFilename_(ParameterInput *pin, SimTime *tm,
 }
 
 void PHDF5Output::WriteBlocksMetadata_(Mesh *pm, hid_t file, const HDF5::H5P &pl,
-                                       hsize_t offset, hsize_t max_blocks_global) const {
+                                       const OutputUtils::OutputBlocks &out_blocks,
+                                       const std::string &link) const {
   using namespace HDF5;
   Kokkos::Profiling::pushRegion("I/O HDF5: write block metadata");
   const H5G gBlocks = MakeGroup(file, "/Blocks");
-  const hsize_t num_blocks_local = pm->block_list.size();
+  const auto &blocks = out_blocks.blocks;
+  const hsize_t num_blocks_local = blocks.size();
+  const hsize_t max_blocks_global = out_blocks.NumGlobal();
+  const hsize_t offset = out_blocks.offset;
   const hsize_t ndim = pm->ndim;
   const hsize_t loc_offset[2] = {offset, 0};
 
+  // all but the derefinement count only change with the mesh
+  if (!link.empty()) {
+    for (const std::string name :
+         {"xmin", "loc.lx123", "loc.level-gid-lid-cnghost-gflag"})
+      LinkExternal(link, "/Blocks/" + name, gBlocks, name);
+  }
+
   // write Xmin[ndim] for blocks
-  {
+  if (link.empty()) {
     // JMM: These arrays chould be shared, but I think this is clearer
     // as to what's going on.
     hsize_t loc_cnt[2] = {num_blocks_local, ndim};
     hsize_t glob_cnt[2] = {max_blocks_global, ndim};
 
-    std::vector<Real> tmpData = OutputUtils::ComputeXminBlocks(pm);
+    std::vector<Real> tmpData = OutputUtils::ComputeXminBlocks(pm, blocks);
     HDF5Write2D(gBlocks, "xmin", tmpData.data(), &loc_offset[0], &loc_cnt[0],
                 &glob_cnt[0], pl);
   }
 
-  {
+  if (link.empty()) {
     // LOC.lx1,2,3
     hsize_t loc_cnt[2] = {num_blocks_local, 3};
     hsize_t glob_cnt[2] = {max_blocks_global, 3};
-    std::vector<int64_t> tmpLoc = OutputUtils::ComputeLocs(pm);
+    std::vector<int64_t> tmpLoc = OutputUtils::ComputeLocs(blocks);
     HDF5Write2D(gBlocks, "loc.lx123", tmpLoc.data(), &loc_offset[0], &loc_cnt[0],
                 &glob_cnt[0], pl);
   }
 
-  {
+  if (link.empty()) {
     // (LOC.)level, GID, LID, cnghost, gflag
     hsize_t loc_cnt[2] = {num_blocks_local, NumIDsAndFlags};
     hsize_t glob_cnt[2] = {max_blocks_global, NumIDsAndFlags};
-    std::vector<int> tmpID = OutputUtils::ComputeIDsAndFlags(pm);
+    std::vector<int> tmpID = OutputUtils::ComputeIDsAndFlags(blocks);
     HDF5Write2D(gBlocks, "loc.level-gid-lid-cnghost-gflag", tmpID.data(), &loc_offset[0],
                 &loc_cnt[0], &glob_cnt[0], pl);
   }
@@ -646,7 +1240,7 @@ void PHDF5Output::WriteBlocksMetadata_(Mesh *pm, hid_t file, const HDF5::H5P &pl
     // derefinement count
     hsize_t loc_cnt[2] = {num_blocks_local, 1};
     hsize_t glob_cnt[2] = {max_blocks_global, 1};
-    std::vector<int> tmpID = OutputUtils::ComputeDerefinementCount(pm);
+    std::vector<int> tmpID = OutputUtils::ComputeDerefinementCount(blocks);
     HDF5Write2D(gBlocks, "derefinement_count", tmpID.data(), &loc_offset[0], &loc_cnt[0],
                 &glob_cnt[0], pl);
   }
@@ -655,25 +1249,32 @@ void PHDF5Output::WriteBlocksMetadata_(Mesh *pm, hid_t file, const HDF5::H5P &pl
 }
 
 void PHDF5Output::WriteCoordinates_(Mesh *pm, const IndexDomain &domain, hid_t file,
-                                    const HDF5::H5P &pl, hsize_t offset,
-                                    hsize_t max_blocks_global) const {
+                                    const HDF5::H5P &pl,
+                                    const OutputUtils::OutputBlocks &out_blocks,
+                                    const std::string &link) const {
   using namespace HDF5;
   Kokkos::Profiling::pushRegion("write mesh coords");
+  if (!link.empty()) {
+    for (const std::string name : {"/Locations", "/VolumeLocations"})
+      LinkExternal(link, name, file, name);
+    Kokkos::Profiling::popRegion(); // write mesh coords
+    return;
+  }
   const IndexShape &shape = pm->GetLeafBlockCellBounds();
   const IndexRange ib = shape.GetBoundsI(domain);
   const IndexRange jb = shape.GetBoundsJ(domain);
   const IndexRange kb = shape.GetBoundsK(domain);
 
-  const hsize_t num_blocks_local = pm->block_list.size();
-  const hsize_t loc_offset[2] = {offset, 0};
+  const hsize_t num_blocks_local = out_blocks.blocks.size();
+  const hsize_t loc_offset[2] = {out_blocks.offset, 0};
   hsize_t loc_cnt[2] = {num_blocks_local, 1};
-  hsize_t glob_cnt[2] = {max_blocks_global, 1};
+  hsize_t glob_cnt[2] = {out_blocks.NumGlobal(), 1};
 
   for (const bool face : {true, false}) {
     const H5G gLocations = MakeGroup(file, face ? "/Locations" : "/VolumeLocations");
 
     std::vector<Real> loc_x, loc_y, loc_z;
-    OutputUtils::ComputeCoords(pm, face, ib, jb, kb, loc_x, loc_y, loc_z);
+    OutputUtils::ComputeCoords(out_blocks.blocks, face, ib, jb, kb, loc_x, loc_y, loc_z);
 
     loc_cnt[1] = glob_cnt[1] = (ib.e - ib.s + 1) + face;
     HDF5Write2D(gLocations, "x", loc_x.data(), &loc_offset[0], &loc_cnt[0], &glob_cnt[0],
@@ -691,14 +1292,31 @@ void PHDF5Output::WriteCoordinates_(Mesh *pm, const IndexDomain &domain, hid_t f
 }
 
 void PHDF5Output::WriteLevelsAndLocs_(Mesh *pm, hid_t file, const HDF5::H5P &pl,
-                                      hsize_t offset, hsize_t max_blocks_global) const {
+                                      const OutputUtils::OutputBlocks &out_blocks,
+                                      const std::string &link) const {
   using namespace HDF5;
   Kokkos::Profiling::pushRegion("write levels and locations");
+  if (!link.empty()) {
+    for (const std::string name : {"/Levels", "/LogicalLocations"})
+      LinkExternal(link, name, file, name);
+    Kokkos::Profiling::popRegion(); // write levels and locations
+    return;
+  }
   auto [levels, logicalLocations] = pm->GetLevelsAndLogicalLocationsFlat();
+  if (!out_blocks.all) {
+    // only keep the selected blocks, which are in increasing order
+    std::size_t n = 0;
+    for (const int gid : out_blocks.gids) {
+      levels[n] = levels[gid];
+      for (int d = 0; d < 3; ++d)
+        logicalLocations[3 * n + d] = logicalLocations[3 * gid + d];
+      ++n;
+    }
+  }
 
   // Only write levels on rank 0 since it has data for all ranks
-  const hsize_t num_blocks_local = pm->block_list.size();
-  const hsize_t loc_offset[2] = {offset, 0};
+  const hsize_t max_blocks_global = out_blocks.NumGlobal();
+  const hsize_t loc_offset[2] = {0, 0};
   const hsize_t loc_cnt[2] = {(Globals::my_rank == 0) ? max_blocks_global : 0, 3};
   const hsize_t glob_cnt[2] = {max_blocks_global, 3};
 
@@ -710,18 +1328,18 @@ void PHDF5Output::WriteLevelsAndLocs_(Mesh *pm, hid_t file, const HDF5::H5P &pl,
   Kokkos::Profiling::popRegion(); // write levels and locations
 }
 
-void PHDF5Output::WriteSparseInfo_(Mesh *pm, hbool_t *sparse_allocated,
+void PHDF5Output::WriteSparseInfo_(hbool_t *sparse_allocated,
                                    const std::vector<int> &dealloc_count,
                                    const std::vector<std::string> &sparse_names,
                                    hsize_t num_sparse, hid_t file, const HDF5::H5P &pl,
-                                   size_t offset, hsize_t max_blocks_global) const {
+                                   const OutputUtils::OutputBlocks &out_blocks) const {
   using namespace HDF5;
   Kokkos::Profiling::pushRegion("write sparse info");
 
-  const hsize_t num_blocks_local = pm->block_list.size();
-  const hsize_t loc_offset[2] = {offset, 0};
+  const hsize_t num_blocks_local = out_blocks.blocks.size();
+  const hsize_t loc_offset[2] = {out_blocks.offset, 0};
   const hsize_t loc_cnt[2] = {num_blocks_local, num_sparse};
-  const hsize_t glob_cnt[2] = {max_blocks_global, num_sparse};
+  const hsize_t glob_cnt[2] = {out_blocks.NumGlobal(), num_sparse};
 
   HDF5Write2D(file, "SparseInfo", sparse_allocated, &loc_offset[0], &loc_cnt[0],
               &glob_cnt[0], pl);
@@ -739,6 +1357,69 @@ void PHDF5Output::WriteSparseInfo_(Mesh *pm, hbool_t *sparse_allocated,
   Kokkos::Profiling::popRegion(); // write sparse info
 }
 
+void PHDF5Output::WriteRawBlockData_(
+    const std::string &filename, hid_t file, const HDF5::H5P &pl,
+    const OutputUtils::OutputBlocks &out_blocks,
+    const std::vector<OutputUtils::VarInfo> &vars_info,
+    const std::unordered_map<std::string, size_t> &sparse_field_idx,
+    hbool_t *sparse_allocated, std::vector<int> &dealloc_count) const {
+  using namespace HDF5;
+  Kokkos::Profiling::pushRegion("write raw block data");
+
+  const hsize_t num_blocks_local = out_blocks.blocks.size();
+  const hsize_t num_vars = vars_info.size();
+  const hsize_t num_sparse = sparse_field_idx.size();
+  // offsets[b * num_vars + v] of the data of variable v on local block b in the file of
+  // this rank, -1 if it isn't allocated
+  std::vector<std::int64_t> offsets(num_blocks_local * num_vars, -1);
+  // number of values of every variable on a block
+  std::vector<std::int64_t> sizes(num_vars, 0);
+
+  // Variable by variable, in the order they are read on restart
+  RawBlockData::Writer writer(RawBlockData::Filename(filename, Globals::my_rank),
+                              Globals::my_rank);
+  for (size_t v_idx = 0; v_idx < num_vars; ++v_idx) {
+    const auto &vinfo = vars_info[v_idx];
+    for (size_t b_idx = 0; b_idx < num_blocks_local; ++b_idx) {
+      const auto &pmb = out_blocks.blocks[b_idx];
+      const auto v = pmb->meshblock_data.Get()->GetVarPtr(vinfo.label);
+      if (vinfo.is_sparse) {
+        const size_t sparse_idx = sparse_field_idx.at(vinfo.label);
+        sparse_allocated[b_idx * num_sparse + sparse_idx] = v->IsAllocated();
+        dealloc_count[b_idx * num_sparse + sparse_idx] =
+            v->IsAllocated() ? v->dealloc_count : 0;
+      }
+      if (!v->IsAllocated()) continue;
+      auto v_h = v->data.GetHostMirrorAndCopy();
+      offsets[b_idx * num_vars + v_idx] = writer.Append(v_h.data(), v_h.size());
+      sizes[v_idx] = v_h.size();
+    }
+  }
+  writer.Close();
+#ifdef MPI_PARALLEL
+  // sparse variables may not be allocated on any block of a rank
+  PARTHENON_MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, sizes.data(), num_vars, MPI_INT64_T,
+                                    MPI_MAX, MPI_COMM_WORLD));
+#endif
+
+  std::vector<int> ranks(num_blocks_local, Globals::my_rank);
+  const hsize_t loc_offset[2] = {out_blocks.offset, 0};
+  const hsize_t loc_cnt[2] = {num_blocks_local, num_vars};
+  const hsize_t glob_cnt[2] = {out_blocks.NumGlobal(), num_vars};
+  HDF5Write2D(file, "RawBlockData", offsets.data(), &loc_offset[0], &loc_cnt[0],
+              &glob_cnt[0], pl);
+  HDF5Write1D(file, "RawBlockDataRanks", ranks.data(), &loc_offset[0], &loc_cnt[0],
+              &glob_cnt[0], pl);
+
+  std::vector<std::string> labels;
+  for (const auto &vinfo : vars_info)
+    labels.push_back(vinfo.label);
+  const H5D dset = H5D::FromHIDCheck(H5Dopen2(file, "RawBlockData", H5P_DEFAULT));
+  HDF5WriteAttribute("Variables", labels, dset);
+  HDF5WriteAttribute("VariableSizes", sizes, dset);
+  Kokkos::Profiling::popRegion(); // write raw block data
+}
+
 // Utility functions implemented
 namespace HDF5 {
 hid_t GenerateFileAccessProps() {
@@ -846,6 +1527,35 @@ hid_t GenerateFileAccessProps() {
         MPI_Info_set(FILE_INFO_TEMPLATE, "cb_buffer_size", cb_buffer_size.c_str()));
   }
 
+  // Two-phase (aggregated) collective I/O: in collective writes only a few aggregator
+  // ranks per node gather the data of the other ranks and issue large contiguous writes,
+  // so that the file system is not hit by requests from every rank
+  // Default: MPI library default (usually one aggregator per node on Lustre)
+  const auto writers_per_node = Env::get<size_t>("MPI_writers_per_node", 0, exists);
+  if (exists && writers_per_node > 0) {
+    PARTHENON_MPI_CHECK(MPI_Info_set(FILE_INFO_TEMPLATE, "romio_cb_write", "enable"));
+    const auto cb_config_list = "*:" + std::to_string(writers_per_node);
+    PARTHENON_MPI_CHECK(
+        MPI_Info_set(FILE_INFO_TEMPLATE, "cb_config_list", cb_config_list.c_str()));
+  }
+  // Total number of aggregators
+  const auto cb_nodes = Env::get<std::string>("MPI_cb_nodes", "", exists);
+  if (exists) {
+    PARTHENON_MPI_CHECK(MPI_Info_set(FILE_INFO_TEMPLATE, "cb_nodes", cb_nodes.c_str()));
+  }
+  // Lustre striping of newly created files, aggregators write in units of the stripe
+  // size, so it is typically set to (a multiple of) the number of aggregators
+  const auto striping_factor = Env::get<std::string>("MPI_striping_factor", "", exists);
+  if (exists) {
+    PARTHENON_MPI_CHECK(
+        MPI_Info_set(FILE_INFO_TEMPLATE, "striping_factor", striping_factor.c_str()));
+  }
+  const auto striping_unit = Env::get<std::string>("MPI_striping_unit", "", exists);
+  if (exists) {
+    PARTHENON_MPI_CHECK(
+        MPI_Info_set(FILE_INFO_TEMPLATE, "striping_unit", striping_unit.c_str()));
+  }
+
   /* tell the HDF5 library that we want to use MPI-IO to do the writing */
   PARTHENON_HDF5_CHECK(H5Pset_fapl_mpio(acc_file, MPI_COMM_WORLD, FILE_INFO_TEMPLATE));
 #else
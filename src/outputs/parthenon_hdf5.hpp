@@ -77,14 +77,16 @@ inline H5G MakeGroup(hid_t file, const std::string &name) {
 template <typename T>
 void HDF5WriteND(hid_t location, const std::string &name, const T *data, int rank,
                  const hsize_t *local_offset, const hsize_t *local_count,
-                 const hsize_t *global_count, hid_t plist_xfer, hid_t plist_dcreate) {
+                 const hsize_t *global_count, hid_t plist_xfer, hid_t plist_dcreate,
+                 hid_t file_type = H5I_INVALID_HID) {
   const H5S local_space = H5S::FromHIDCheck(H5Screate_simple(rank, local_count, NULL));
   const H5S global_space = H5S::FromHIDCheck(H5Screate_simple(rank, global_count, NULL));
 
+  // the data is converted by HDF5 if the type in the file (file_type) differs
   auto type = getHDF5Type(data);
-  const H5D gDSet =
-      H5D::FromHIDCheck(H5Dcreate(location, name.c_str(), type, global_space, H5P_DEFAULT,
-                                  plist_dcreate, H5P_DEFAULT));
+  const H5D gDSet = H5D::FromHIDCheck(
+      H5Dcreate(location, name.c_str(), file_type >= 0 ? file_type : hid_t(type),
+                global_space, H5P_DEFAULT, plist_dcreate, H5P_DEFAULT));
   PARTHENON_HDF5_CHECK(H5Sselect_hyperslab(global_space, H5S_SELECT_SET, local_offset,
                                            NULL, local_count, NULL));
   PARTHENON_HDF5_CHECK(
@@ -28,12 +28,19 @@
 #include <hdf5.h>
 
 // C++
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <fstream>
 #include <iostream>
+#include <map>
+#include <sstream>
 #include <string>
 
 // Parthenon
 #include "basic_types.hpp"
 #include "mesh/mesh.hpp"
+#include "parthenon_mpi.hpp"
 #include "outputs/output_utils.hpp"
 #include "outputs/parthenon_hdf5.hpp"
 #include "outputs/parthenon_xdmf.hpp"
@@ -50,17 +57,18 @@ static std::string stringXdmfArrayRef(const std::string &prefix,
                                       const std::string &label, const hsize_t *dims,
                                       const int &ndims, const std::string &theType,
                                       const int &precision);
-static void writeXdmfArrayRef(std::ofstream &fid, const std::string &prefix,
+static void writeXdmfArrayRef(std::ostream &fid, const std::string &prefix,
                               const std::string &hdfPath, const std::string &label,
                               const hsize_t *dims, const int &ndims,
                               const std::string &theType, const int &precision);
-static void writeXdmfSlabVariableRef(std::ofstream &fid, const std::string &name,
+static void writeXdmfSlabVariableRef(std::ostream &fid, const std::string &name,
                                      const std::vector<std::string> &component_labels,
                                      std::string &hdfFile, int iblock,
                                      const int &num_components, int &ndims, hsize_t *dims,
                                      const int nx3, const int nx2, const int nx1,
                                      const bool do_lowerd, const bool isVector,
-                                     MetadataFlag where);
+                                     MetadataFlag where, const std::string &dataset,
+                                     const int comp_offset);
 static std::string ParticlePositionRef(const std::string &prefix,
                                        const std::string &swmname,
                                        const std::string &varname,
@@ -76,29 +84,25 @@ static std::string ParticleDatasetRef(const std::string &prefix,
 static void ParticleVariableRef(std::ofstream &xdmf, const std::string &varname,
                                 const SwarmVarInfo &varinfo, const std::string &swmname,
                                 const std::string &hdffile, int particle_count);
-static void BlockCoordRegularRef(std::ofstream &xdmf, int nbtot, int ib, int nx,
+static void BlockCoordRegularRef(std::ostream &xdmf, int nbtot, int ib, int nx,
                                  const std::string &hdfFile, const std::string &dir);
 static std::string LocationToStringRef(MetadataFlag where);
+static void WriteDistributed(const std::string &filename, const std::string &header,
+                             const std::string &body, const std::string &footer);
 } // namespace impl
 
-void genXDMF(std::string hdfFile, Mesh *pm, SimTime *tm, IndexDomain domain, int nx1,
-             int nx2, int nx3, const std::vector<VarInfo> &var_list,
+void genXDMF(std::string hdfFile, Mesh *pm, SimTime *tm, const OutputBlocks &out_blocks,
+             IndexDomain domain, int nx1, int nx2, int nx3,
+             const std::vector<VarInfo> &var_list,
              const AllSwarmInfo &all_swarm_info, const bool mesh_xdmf,
-             const bool swarm_xdmf) {
+             const bool swarm_xdmf,
+             const std::map<std::string, VarGroupLayout> &var_groups) {
   using namespace HDF5;
   using namespace OutputUtils;
   using namespace impl;
-  // using round robin generation.
-  // must switch to MPIIO at some point
-
-  // only rank 0 writes XDMF
-  if (Globals::my_rank != 0) {
-    return;
-  }
 
   if (mesh_xdmf) {
     std::string filename_aux = hdfFile + ".xdmf";
-    std::ofstream xdmf;
     hsize_t dims[H5_NDIM] = {0}; // zero-initialized
 
     // check whether or not coordinates field is provided and find it if it is present
@@ -112,25 +116,25 @@ void genXDMF(std::string hdfFile, Mesh *pm, SimTime *tm, IndexDomain domain, int
           "3DRectMesh");
     }
 
-    // open file
-    xdmf = std::ofstream(filename_aux.c_str(), std::ofstream::trunc);
-
-    // Write header
-    xdmf << R"(<?xml version="1.0" ?>)" << std::endl;
-    xdmf << R"(<!DOCTYPE Xdmf SYSTEM "Xdmf.dtd">)" << std::endl;
-    xdmf << R"(<Xdmf Version="3.0">)" << std::endl;
-    xdmf << R"(<Information Name="TimeVaryingMetaData" Value="True"/>)" << std::endl;
-    xdmf << "  <Domain>" << std::endl;
-    xdmf << R"(  <Grid Name="Mesh" GridType="Collection">)" << std::endl;
+    // Header and footer are written by rank 0, every rank generates the grids of its
+    // own blocks, which are written to their place in the file in parallel
+    std::ostringstream header, footer, xdmf;
+    header << R"(<?xml version="1.0" ?>)" << '\n';
+    header << R"(<!DOCTYPE Xdmf SYSTEM "Xdmf.dtd">)" << '\n';
+    header << R"(<Xdmf Version="3.0">)" << '\n';
+    header << R"(<Information Name="TimeVaryingMetaData" Value="True"/>)" << '\n';
+    header << "  <Domain>" << '\n';
+    header << R"(  <Grid Name="Mesh" GridType="Collection">)" << '\n';
     if (tm != nullptr) {
-      xdmf << R"(    <Information Name="Cycle" Value=")" << tm->ncycle << R"("/>)"
-           << std::endl;
-      xdmf << R"(    <Time Value=")" << tm->time << R"("/>)" << std::endl;
+      header << R"(    <Information Name="Cycle" Value=")" << tm->ncycle << R"("/>)"
+             << '\n';
+      header << R"(    <Time Value=")" << tm->time << R"("/>)" << '\n';
     }
 
     // Now write Grid for each block
     int ndim;
-    dims[0] = pm->nbtotal;
+    const int nbtotal = out_blocks.NumGlobal();
+    dims[0] = nbtotal;
     const int n3_offset = output_coords ? (nx3 > 1) : 1;
     const int n2_offset = output_coords ? (nx2 > 1) : 1;
     std::string mesh_type, dimstring;
@@ -148,7 +152,10 @@ void genXDMF(std::string hdfFile, Mesh *pm, SimTime *tm, IndexDomain domain, int
       mesh_type = "3DRectMesh";
       dimstring = StringPrintf("%d %d %d", nx3 + n3_offset, nx2 + n2_offset, nx1 + 1);
     }
-    for (int ib = 0; ib < pm->nbtotal; ib++) {
+    // the blocks of this rank are contiguous in the datasets
+    const int ib_start = out_blocks.offset;
+    const int ib_end = ib_start + out_blocks.blocks.size();
+    for (int ib = ib_start; ib < ib_end; ib++) {
       xdmf << StringPrintf("    <Grid GridType=\"Uniform\" Name=\"%d\">\n", ib);
       xdmf << StringPrintf("      <Topology TopologyType=\"%s\" Dimensions=\"%s\"/>\n",
                            mesh_type.c_str(), dimstring.c_str());
@@ -156,6 +163,14 @@ void genXDMF(std::string hdfFile, Mesh *pm, SimTime *tm, IndexDomain domain, int
                            output_coords ? "X_Y_Z" : "VXVYVZ");
       if (output_coords) {
         ndim = coords_it->FillShape<hsize_t>(domain, &(dims[1])) + 1;
+        std::string coords_dataset = coords_it->label;
+        int coords_offset = 0;
+        const auto group = var_groups.find(coords_it->label);
+        if (group != var_groups.end()) {
+          coords_dataset = group->second.dataset;
+          coords_offset = group->second.offset;
+          dims[1] = group->second.ncomp_group;
+        }
         for (int d = 0; d < 3; ++d) {
           xdmf << StringPrintf(
                       "        <DataItem ItemType=\"Hyperslab\" Dimensions=\"%s\">\n"
@@ -165,18 +180,18 @@ void genXDMF(std::string hdfFile, Mesh *pm, SimTime *tm, IndexDomain domain, int
                       "            1 1 1 1 1\n"
                       "            1 1 %d %d %d\n"
                       "          </DataItem>\n",
-                      dimstring.c_str(), ib, d, nx3 + (nx3 > 1), nx2 + (nx2 > 1),
-                      nx1 + (nx1 > 1))
-               << stringXdmfArrayRef("          ", hdfFile + ":/", coords_it->label, dims,
+                      dimstring.c_str(), ib, coords_offset + d, nx3 + (nx3 > 1),
+                      nx2 + (nx2 > 1), nx1 + (nx1 > 1))
+               << stringXdmfArrayRef("          ", hdfFile + ":/", coords_dataset, dims,
                                      ndim, "Float", 8)
                << "        </DataItem>\n";
         }
       } else {
-        BlockCoordRegularRef(xdmf, pm->nbtotal, ib, nx1, hdfFile, "x");
-        BlockCoordRegularRef(xdmf, pm->nbtotal, ib, nx2, hdfFile, "y");
-        BlockCoordRegularRef(xdmf, pm->nbtotal, ib, nx3, hdfFile, "z");
+        BlockCoordRegularRef(xdmf, nbtotal, ib, nx1, hdfFile, "x");
+        BlockCoordRegularRef(xdmf, nbtotal, ib, nx2, hdfFile, "y");
+        BlockCoordRegularRef(xdmf, nbtotal, ib, nx3, hdfFile, "z");
       }
-      xdmf << "      </Geometry>" << std::endl;
+      xdmf << "      </Geometry>" << '\n';
 
       // write graphics variables
       for (const auto &vinfo : var_list) {
@@ -189,25 +204,45 @@ void genXDMF(std::string hdfFile, Mesh *pm, SimTime *tm, IndexDomain domain, int
           continue;
         }
         ndim = vinfo.FillShape<hsize_t>(domain, &(dims[1])) + 1;
-        const int num_components = vinfo.num_components;
-        nx3 = dims[ndim - 3];
-        nx2 = dims[ndim - 2];
-        nx1 = dims[ndim - 1];
+        int num_components = vinfo.num_components;
+        // shape of the variable, which differs from the cells for node variables
+        const int vnx3 = dims[ndim - 3];
+        const int vnx2 = dims[ndim - 2];
+        const int vnx1 = dims[ndim - 1];
+        // the components of grouped variables are slices of the dataset of the group
+        std::string dataset = vinfo.label;
+        int comp_offset = 0;
+        const auto group = var_groups.find(vinfo.label);
+        if (group != var_groups.end()) {
+          dataset = group->second.dataset;
+          comp_offset = group->second.offset;
+          num_components = group->second.ncomp;
+          ndim = 5;
+          dims[1] = group->second.ncomp_group;
+          dims[2] = vnx3;
+          dims[3] = vnx2;
+          dims[4] = vnx1;
+        }
         writeXdmfSlabVariableRef(xdmf, vinfo.label, vinfo.component_labels, hdfFile, ib,
-                                 num_components, ndim, dims, nx3, nx2, nx1, output_coords,
-                                 vinfo.is_vector, vinfo.where);
+                                 num_components, ndim, dims, vnx3, vnx2, vnx1,
+                                 output_coords, vinfo.is_vector, vinfo.where, dataset,
+                                 comp_offset);
       }
-      xdmf << "    </Grid>" << std::endl;
+      xdmf << "    </Grid>" << '\n';
     }
 
     // Cleanup
-    xdmf << "    </Grid>" << std::endl;
-    xdmf << "  </Domain>" << std::endl;
-    xdmf << "</Xdmf>" << std::endl;
-    xdmf.close();
+    footer << "    </Grid>" << '\n';
+    footer << "  </Domain>" << '\n';
+    footer << "</Xdmf>" << std::endl;
+    WriteDistributed(filename_aux, header.str(), xdmf.str(), footer.str());
+  }
+
+  // Particles are defined as their own "mesh" with one grid per swarm, written by rank 0
+  if (Globals::my_rank != 0) {
+    return;
   }
 
-  // Particles are defined as their own "mesh"
   if (swarm_xdmf && all_swarm_info.all_info.size() > 0) {
     std::string sfilename_aux = hdfFile + ".swarm.xdmf";
     std::ofstream pxdmf;
@@ -283,21 +318,21 @@ static std::string stringXdmfArrayRef(const std::string &prefix,
   return mystr;
 }
 
-static void writeXdmfArrayRef(std::ofstream &fid, const std::string &prefix,
+static void writeXdmfArrayRef(std::ostream &fid, const std::string &prefix,
                               const std::string &hdfPath, const std::string &label,
                               const hsize_t *dims, const int &ndims,
                               const std::string &theType, const int &precision) {
-  fid << stringXdmfArrayRef(prefix, hdfPath, label, dims, ndims, theType, precision)
-      << std::flush;
+  fid << stringXdmfArrayRef(prefix, hdfPath, label, dims, ndims, theType, precision);
 }
 
-static void writeXdmfSlabVariableRef(std::ofstream &fid, const std::string &name,
+static void writeXdmfSlabVariableRef(std::ostream &fid, const std::string &name,
                                      const std::vector<std::string> &component_labels,
                                      std::string &hdfFile, int iblock,
                                      const int &num_components, int &ndims, hsize_t *dims,
                                      const int nx3, const int nx2, const int nx1,
                                      const bool do_lowerd, const bool isVector,
-                                     MetadataFlag where) {
+                                     MetadataFlag where, const std::string &dataset,
+                                     const int comp_offset) {
   // writes a slab reference to file
   std::vector<std::string> names;
   int nentries = 1;
@@ -346,8 +381,8 @@ static void writeXdmfSlabVariableRef(std::ofstream &fid, const std::string &name
         << prefix << "      1 1 1 1\n"
         << prefix << "      1 " << nx3 << " " << nx2 << " " << nx1 << "\n"
         << prefix << "    </DataItem>" << std::endl;
-    writeXdmfArrayRef(fid, prefix + "    ", hdfFile + ":/", name, dims, ndims, "Float",
-                      8);
+    writeXdmfArrayRef(fid, prefix + "    ", hdfFile + ":/", dataset, dims, ndims,
+                      "Float", 8);
     fid << prefix << "  "
         << "</DataItem>" << std::endl;
     fid << prefix << "</Attribute>" << std::endl;
@@ -370,14 +405,14 @@ static void writeXdmfSlabVariableRef(std::ofstream &fid, const std::string &name
       fid << prefix << "    "
           << R"(<DataItem Dimensions="3 5" NumberType="Int" Format="XML">)"
           << "\n"
-          << prefix << "      " << iblock << " " << i << " 0 0 0\n"
+          << prefix << "      " << iblock << " " << comp_offset + i << " 0 0 0\n"
           << prefix << "      "
           << "1 1 1 1 1\n"
           << prefix << "      "
           << "1 1 " << nx3 << " " << nx2 << " " << nx1 << "\n"
           << prefix << "    </DataItem>" << std::endl;
-      writeXdmfArrayRef(fid, prefix + "    ", hdfFile + ":/", name, dims, ndims, "Float",
-                        8);
+      writeXdmfArrayRef(fid, prefix + "    ", hdfFile + ":/", dataset, dims, ndims,
+                        "Float", 8);
       fid << prefix << "  "
           << "</DataItem>" << std::endl;
       fid << prefix << "</Attribute>" << std::endl;
@@ -503,7 +538,7 @@ static void ParticleVariableRef(std::ofstream &xdmf, const std::string &varname,
   }
 }
 
-static void BlockCoordRegularRef(std::ofstream &xdmf, int nbtot, int ib, int nx,
+static void BlockCoordRegularRef(std::ostream &xdmf, int nbtot, int ib, int nx,
                                  const std::string &hdfFile, const std::string &dir) {
   hsize_t dims[] = {static_cast<hsize_t>(nbtot), static_cast<hsize_t>(nx + 1)};
   xdmf << StringPrintf(
@@ -518,6 +553,42 @@ static void BlockCoordRegularRef(std::ofstream &xdmf, int nbtot, int ib, int nx,
   xdmf << "        </DataItem>" << std::endl;
 }
 
+// Write the header and footer of rank 0 and the bodies of all ranks in between them in
+// the order of the ranks. With MPI, all ranks write their bodies to the file at once.
+static void WriteDistributed(const std::string &filename, const std::string &header,
+                             const std::string &body, const std::string &footer) {
+#ifdef MPI_PARALLEL
+  std::uint64_t size = body.size(), offset = 0, total = 0;
+  PARTHENON_MPI_CHECK(
+      MPI_Exscan(&size, &offset, 1, MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD));
+  // the result of MPI_Exscan is undefined on rank 0
+  if (Globals::my_rank == 0) offset = 0;
+  PARTHENON_MPI_CHECK(
+      MPI_Allreduce(&size, &total, 1, MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD));
+  PARTHENON_REQUIRE_THROWS(body.size() <= INT_MAX,
+                           "XDMF of the blocks of a rank exceeds 2 GiB");
+
+  MPI_File fh;
+  PARTHENON_MPI_CHECK(MPI_File_open(MPI_COMM_WORLD, filename.c_str(),
+                                    MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL,
+                                    &fh));
+  // truncate an existing file
+  PARTHENON_MPI_CHECK(MPI_File_set_size(fh, 0));
+  if (Globals::my_rank == 0) {
+    PARTHENON_MPI_CHECK(MPI_File_write_at(fh, 0, header.data(), header.size(), MPI_CHAR,
+                                          MPI_STATUS_IGNORE));
+    PARTHENON_MPI_CHECK(MPI_File_write_at(fh, header.size() + total, footer.data(),
+                                          footer.size(), MPI_CHAR, MPI_STATUS_IGNORE));
+  }
+  PARTHENON_MPI_CHECK(MPI_File_write_at_all(fh, header.size() + offset, body.data(),
+                                            body.size(), MPI_CHAR, MPI_STATUS_IGNORE));
+  PARTHENON_MPI_CHECK(MPI_File_close(&fh));
+#else
+  std::ofstream out(filename, std::ofstream::trunc);
+  out << header << body << footer;
+#endif
+}
+
 static std::string LocationToStringRef(MetadataFlag where) {
   if (where == MetadataFlag({Metadata::Node})) {
     return R"(" Center="Node")";
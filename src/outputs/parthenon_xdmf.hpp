@@ -19,6 +19,7 @@
 #define OUTPUTS_PARTHENON_XDMF_HPP_
 
 // C++ includes
+#include <map>
 #include <string>
 #include <vector>
 
@@ -28,10 +29,12 @@
 namespace parthenon {
 // forward declarations
 namespace XDMF {
-void genXDMF(std::string hdfFile, Mesh *pm, SimTime *tm, IndexDomain domain, int nx1,
+void genXDMF(std::string hdfFile, Mesh *pm, SimTime *tm,
+             const OutputUtils::OutputBlocks &out_blocks, IndexDomain domain, int nx1,
              int nx2, int nx3, const std::vector<OutputUtils::VarInfo> &var_list,
              const OutputUtils::AllSwarmInfo &all_swarm_info, const bool mesh_xdmf,
-             const bool swarm_xdmf);
+             const bool swarm_xdmf,
+             const std::map<std::string, OutputUtils::VarGroupLayout> &var_groups = {});
 } // namespace XDMF
 } // namespace parthenon
 
@@ -0,0 +1,126 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include "outputs/raw_block_data.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+#include "utils/error_checking.hpp"
+
+namespace parthenon {
+namespace RawBlockData {
+namespace {
+constexpr char magic[8] = "PRTHRAW";
+constexpr std::size_t buffer_size = 1 << 24;
+} // namespace
+
+std::string Filename(const std::string &restart_filename, const int rank) {
+  std::stringstream name;
+  name << restart_filename << "." << std::setw(6) << std::setfill('0') << rank << ".raw";
+  return name.str();
+}
+
+Writer::Writer(const std::string &filename, const int rank) : filename_(filename) {
+  file_ = std::fopen(filename.c_str(), "wb");
+  PARTHENON_REQUIRE_THROWS(file_ != nullptr, "Failed to create raw block data file " +
+                                                 filename + ": " + std::strerror(errno));
+  std::setvbuf(file_, nullptr, _IOFBF, buffer_size);
+  Header header;
+  std::memcpy(header.magic, magic, sizeof(magic));
+  header.version = version;
+  header.real_size = sizeof(Real);
+  header.rank = rank;
+  Write_(&header, sizeof(header));
+}
+
+Writer::~Writer() {
+  if (file_ != nullptr) std::fclose(file_);
+}
+
+std::int64_t Writer::Append(const Real *data, const std::size_t count) {
+  static const std::array<char, alignment> zeros{};
+  const std::size_t padding = (alignment - size_ % alignment) % alignment;
+  Write_(zeros.data(), padding);
+  const std::int64_t offset = size_;
+  Write_(data, count * sizeof(Real));
+  return offset;
+}
+
+void Writer::Close() {
+  const bool ok = std::fflush(file_) == 0;
+  std::fclose(file_);
+  file_ = nullptr;
+  PARTHENON_REQUIRE_THROWS(ok, "Failed to write raw block data file " + filename_);
+}
+
+void Writer::Write_(const void *data, const std::size_t bytes) {
+  if (bytes == 0) return;
+  PARTHENON_REQUIRE_THROWS(std::fwrite(data, 1, bytes, file_) == bytes,
+                           "Failed to write raw block data file " + filename_ + ": " +
+                               std::strerror(errno));
+  size_ += bytes;
+}
+
+MappedFile::MappedFile(const std::string &filename, const int rank)
+    : filename_(filename) {
+  const int fd = open(filename.c_str(), O_RDONLY);
+  PARTHENON_REQUIRE_THROWS(fd >= 0, "Failed to open raw block data file " + filename +
+                                        ": " + std::strerror(errno));
+  struct stat st;
+  const bool have_size = fstat(fd, &st) == 0;
+  size_ = have_size ? static_cast<std::size_t>(st.st_size) : 0;
+  if (size_ >= sizeof(Header)) {
+    data_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  // the mapping stays valid without the file descriptor
+  close(fd);
+  PARTHENON_REQUIRE_THROWS(data_ != nullptr && data_ != MAP_FAILED,
+                           "Failed to map raw block data file " + filename);
+  // The variables are read in the order they were written
+  madvise(data_, size_, MADV_SEQUENTIAL);
+
+  const auto *header = static_cast<const Header *>(data_);
+  PARTHENON_REQUIRE_THROWS(std::memcmp(header->magic, magic, sizeof(magic)) == 0 &&
+                               header->version == version,
+                           filename + " is not a raw block data file");
+  PARTHENON_REQUIRE_THROWS(header->real_size == sizeof(Real),
+                           "Raw block data file " + filename +
+                               " was written with a different precision of Real");
+  PARTHENON_REQUIRE_THROWS(header->rank == static_cast<std::uint64_t>(rank),
+                           "Raw block data file " + filename + " belongs to rank " +
+                               std::to_string(header->rank));
+}
+
+MappedFile::~MappedFile() {
+  if (data_ != nullptr && data_ != MAP_FAILED) munmap(data_, size_);
+}
+
+const Real *MappedFile::Data(const std::int64_t offset, const std::size_t count) const {
+  PARTHENON_REQUIRE_THROWS(offset >= static_cast<std::int64_t>(sizeof(Header)) &&
+                               offset + count * sizeof(Real) <= size_,
+                           "Raw block data file " + filename_ + " is truncated");
+  return reinterpret_cast<const Real *>(static_cast<const char *>(data_) + offset);
+}
+
+} // namespace RawBlockData
+} // namespace parthenon
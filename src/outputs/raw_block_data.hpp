@@ -0,0 +1,85 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef OUTPUTS_RAW_BLOCK_DATA_HPP_
+#define OUTPUTS_RAW_BLOCK_DATA_HPP_
+//! \file raw_block_data.hpp
+//  \brief Per-rank binary files with the block data of restarts, see raw_block_data
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "basic_types.hpp"
+
+namespace parthenon {
+namespace RawBlockData {
+// The files start with a header, followed by the complete data (including ghost zones)
+// of every allocated variable on every block of the rank that wrote it, as it is laid
+// out in memory. Every array starts at a multiple of the alignment. Where the data of a
+// variable on a block is stored is recorded in the restart file.
+constexpr std::size_t alignment = 4096;
+constexpr std::uint64_t version = 1;
+
+struct Header {
+  char magic[8];
+  std::uint64_t version;
+  std::uint64_t real_size; // sizeof(Real) of the data
+  std::uint64_t rank;      // rank that wrote the file
+};
+
+// Name of the file with the data of rank next to the restart file restart_filename
+std::string Filename(const std::string &restart_filename, int rank);
+
+// Writes a file sequentially through a large buffer
+class Writer {
+ public:
+  Writer(const std::string &filename, int rank);
+  ~Writer();
+  Writer(const Writer &) = delete;
+  Writer &operator=(const Writer &) = delete;
+
+  // Appends count values at the next multiple of the alignment and returns their offset
+  // in bytes
+  std::int64_t Append(const Real *data, std::size_t count);
+  // Flushes and closes the file, throwing if anything could not be written
+  void Close();
+
+ private:
+  void Write_(const void *data, std::size_t bytes);
+
+  std::string filename_;
+  std::FILE *file_ = nullptr;
+  std::int64_t size_ = 0;
+};
+
+// Read-only memory map of a file, so that the data is paged in from disk (or the page
+// cache) only when it is copied to the variables
+class MappedFile {
+ public:
+  MappedFile(const std::string &filename, int rank);
+  ~MappedFile();
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  // The count values at offset bytes into the file
+  const Real *Data(std::int64_t offset, std::size_t count) const;
+
+ private:
+  std::string filename_;
+  void *data_ = nullptr;
+  std::size_t size_ = 0;
+};
+} // namespace RawBlockData
+} // namespace parthenon
+
+#endif // OUTPUTS_RAW_BLOCK_DATA_HPP_
@@ -109,6 +109,18 @@ class RestartReader {
                           const OutputUtils::VarInfo &info, std::vector<Real> &dataVec,
                           int file_output_format_version) const = 0;
 
+  // Whether the data of the variables is stored in per-rank binary files next to the
+  // restart file (see raw_block_data), so that it is read with ReadRawBlockData instead
+  // of ReadBlocks
+  [[nodiscard]] virtual bool HasRawBlockData() const { return false; }
+
+  // Copies the complete data (including ghost zones) of variable name on the block with
+  // global id gid to the count values starting at dst in device memory
+  virtual void ReadRawBlockData(const std::string &name, int gid, Real *dst,
+                                std::size_t count) const {
+    PARTHENON_THROW("Restart file has no raw block data");
+  }
+
   // Gets the data from a swarm var on current rank. Assumes all
   // blocks are contiguous. Fills dataVec based on shape from swarmvar
   // metadata.
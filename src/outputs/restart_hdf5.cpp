@@ -17,14 +17,18 @@
 //! \file restart.cpp
 //  \brief writes restart files
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <numeric>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "basic_types.hpp"
 #include "globals.hpp"
 #include "interface/params.hpp"
+#include "kokkos_abstraction.hpp"
 #include "mesh/mesh.hpp"
 #include "mesh/meshblock.hpp"
 #include "outputs/output_utils.hpp"
@@ -32,12 +36,29 @@
 #ifdef ENABLE_HDF5
 #include "outputs/parthenon_hdf5.hpp"
 #endif
+#include "outputs/raw_block_data.hpp"
 #include "outputs/restart.hpp"
 #include "outputs/restart_hdf5.hpp"
+#include "parthenon_mpi.hpp"
 #include "utils/error_checking.hpp"
+#include "utils/utils.hpp"
 
 namespace parthenon {
 
+#if defined(ENABLE_HDF5) && defined(MPI_PARALLEL)
+namespace {
+// Broadcast a vector read on rank 0 to all other ranks
+template <typename T>
+void BroadcastVector(std::vector<T> &data) {
+  std::size_t size = data.size();
+  PARTHENON_MPI_CHECK(MPI_Bcast(&size, sizeof(size), MPI_BYTE, 0, MPI_COMM_WORLD));
+  data.resize(size);
+  PARTHENON_MPI_CHECK(
+      MPI_Bcast(data.data(), size * sizeof(T), MPI_BYTE, 0, MPI_COMM_WORLD));
+}
+} // namespace
+#endif
+
 //----------------------------------------------------------------------------------------
 //! \fn void RestartReader::RestartReader(const std::string filename)
 //  \brief Opens the restart file and stores appropriate file handle in fh_
@@ -49,19 +70,128 @@ RestartReaderHDF5::RestartReaderHDF5(const char *filename) : filename_(filename)
       << "is required for restarts" << std::endl;
   PARTHENON_FAIL(msg);
 #else  // HDF5 enabled
+#ifdef MPI_PARALLEL
+  // Open the file with MPI-IO, so that the block data of all ranks is read in collective
+  // reads. Every rank only reads the contiguous range of its own blocks, so this doesn't
+  // depend on the number of ranks the file was written with.
+  const H5P acc_file = H5P::FromHIDCheck(H5Pcreate(H5P_FILE_ACCESS));
+  bool exists;
+  // Sets the size of the data sieve buffer used for small independent reads
+  const size_t sieve_buf_size = Env::get<size_t>("H5_sieve_buf_size", 0, exists);
+  if (exists) {
+    PARTHENON_HDF5_CHECK(H5Pset_sieve_buf_size(acc_file, sieve_buf_size));
+  }
+  MPI_Info info;
+  PARTHENON_MPI_CHECK(MPI_Info_create(&info));
+  PARTHENON_MPI_CHECK(MPI_Info_set(info, "access_style", "read_once"));
+  PARTHENON_HDF5_CHECK(H5Pset_fapl_mpio(acc_file, MPI_COMM_WORLD, info));
+  PARTHENON_MPI_CHECK(MPI_Info_free(&info));
+#ifdef H5_HAVE_SUBFILING_VFD
+  // Files written with hdf5_subfiling can only be opened with the subfiling VFD
+  hid_t fh = H5I_INVALID_HID;
+  H5E_BEGIN_TRY { fh = H5Fopen(filename, H5F_ACC_RDONLY, acc_file); }
+  H5E_END_TRY;
+  if (fh < 0) {
+    H5FD_subfiling_config_t config;
+    PARTHENON_HDF5_CHECK(H5Pget_fapl_subfiling(acc_file, &config));
+    PARTHENON_HDF5_CHECK(H5Pset_fapl_subfiling(acc_file, &config));
+    fh = H5Fopen(filename, H5F_ACC_RDONLY, acc_file);
+  }
+  fh_ = H5F::FromHIDCheck(fh);
+#else
+  fh_ = H5F::FromHIDCheck(H5Fopen(filename, H5F_ACC_RDONLY, acc_file));
+#endif
+
+  pl_xfer_ = H5P::FromHIDCheck(H5Pcreate(H5P_DATASET_XFER));
+  PARTHENON_HDF5_CHECK(H5Pset_dxpl_mpio(pl_xfer_, H5FD_MPIO_COLLECTIVE));
+#else
   // Open the HDF file in read only mode
   fh_ = H5F::FromHIDCheck(H5Fopen(filename, H5F_ACC_RDONLY, H5P_DEFAULT));
-  params_group_ = H5G::FromHIDCheck(H5Oopen(fh_, "Params", H5P_DEFAULT));
+  pl_xfer_ = H5P::FromHIDCheck(H5Pcreate(H5P_DATASET_XFER));
+#endif
+  OpenMetadata_();
+  params_group_ = H5G::FromHIDCheck(H5Oopen(meta_fh_, "Params", H5P_DEFAULT));
 
   has_ghost = GetAttr<int>("Info", "IncludesGhost");
+
+  // Incremental restart files only contain the blocks that changed since their base,
+  // which is a full restart file in the same directory
+  const H5O info = H5O::FromHIDCheck(H5Oopen(meta_fh_, "Info", H5P_DEFAULT));
+  if (PARTHENON_HDF5_CHECK(H5Aexists(info, "IncrementalBase")) > 0) {
+    const std::string file(filename);
+    const auto base = file.substr(0, file.find_last_of('/') + 1) +
+                      GetAttr<std::string>("Info", "IncrementalBase");
+    base_ = std::make_unique<RestartReaderHDF5>(base.c_str());
+  }
+
+  // Files with grouped variable datasets record where the variables are in the Info
+  if (PARTHENON_HDF5_CHECK(H5Aexists(info, "GroupedVariables")) > 0) {
+    const auto labels = GetAttrVec<std::string>("Info", "GroupedVariables");
+    const auto datasets = GetAttrVec<std::string>("Info", "GroupedVariableDatasets");
+    const auto offsets = GetAttrVec<int>("Info", "GroupedVariableOffsets");
+    const auto ncomps = GetAttrVec<int>("Info", "GroupedVariableComponents");
+    for (std::size_t v = 0; v < labels.size(); ++v)
+      grouped_vars_[labels[v]] = {datasets[v], offsets[v], ncomps[v]};
+  }
+
+  // Restarts with raw_block_data only record where the data of the blocks is in the raw
+  // files, which are in the same directory
+  if (PARTHENON_HDF5_CHECK(H5Aexists(info, "RawBlockData")) > 0) {
+    const std::string file(filename);
+    raw_filename_ = file.substr(0, file.find_last_of('/') + 1) +
+                    GetAttr<std::string>("Info", "RawBlockData");
+    raw_offsets_ = ReadDataset<std::int64_t>("RawBlockData");
+    raw_ranks_ = ReadDataset<int>("RawBlockDataRanks");
+    raw_sizes_ = GetAttrVec<std::int64_t>("RawBlockData", "VariableSizes");
+    const auto labels = GetAttrVec<std::string>("RawBlockData", "Variables");
+    for (std::size_t v = 0; v < labels.size(); ++v)
+      raw_vars_[labels[v]] = static_cast<int>(v);
+  }
 #endif // ENABLE_HDF5
 }
 
+#ifdef ENABLE_HDF5
+void RestartReaderHDF5::OpenMetadata_() {
+  // the objects every rank reads all of, as far as they exist in the file
+  const std::vector<std::string> names = {
+      "Input",        "Info",        "Params", "SparseInfo", "SparseDeallocCount",
+      "RawBlockData", "RawBlockDataRanks"};
+  const std::string image_name = filename_ + ":metadata";
+  std::vector<char> image;
+  if (Globals::my_rank == 0) {
+    const H5P acc_mem = H5P::FromHIDCheck(H5Pcreate(H5P_FILE_ACCESS));
+    PARTHENON_HDF5_CHECK(H5Pset_fapl_core(acc_mem, 1 << 16, false));
+    const H5F mem = H5F::FromHIDCheck(
+        H5Fcreate(image_name.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, acc_mem));
+    for (const auto &name : names) {
+      if (PARTHENON_HDF5_CHECK(H5Lexists(fh_, name.c_str(), H5P_DEFAULT)) <= 0) continue;
+      PARTHENON_HDF5_CHECK(
+          H5Ocopy(fh_, name.c_str(), mem, name.c_str(), H5P_DEFAULT, H5P_DEFAULT));
+    }
+    PARTHENON_HDF5_CHECK(H5Fflush(mem, H5F_SCOPE_GLOBAL));
+    image.resize(PARTHENON_HDF5_CHECK(H5Fget_file_image(mem, nullptr, 0)));
+    PARTHENON_HDF5_CHECK(H5Fget_file_image(mem, image.data(), image.size()));
+  }
+#ifdef MPI_PARALLEL
+  BroadcastVector(image);
+#endif
+  const H5P acc_image = H5P::FromHIDCheck(H5Pcreate(H5P_FILE_ACCESS));
+  PARTHENON_HDF5_CHECK(H5Pset_fapl_core(acc_image, 1 << 16, false));
+  PARTHENON_HDF5_CHECK(H5Pset_file_image(acc_image, image.data(), image.size()));
+  meta_fh_ =
+      H5F::FromHIDCheck(H5Fopen(image_name.c_str(), H5F_ACC_RDONLY, acc_image));
+  for (const auto &name : names) {
+    if (PARTHENON_HDF5_CHECK(H5Lexists(meta_fh_, name.c_str(), H5P_DEFAULT)) > 0)
+      meta_objects_.insert(name);
+  }
+}
+#endif // ENABLE_HDF5
+
 int RestartReaderHDF5::GetOutputFormatVersion() const {
 #ifndef ENABLE_HDF5
   PARTHENON_FAIL("Restart functionality is not available because HDF5 is disabled");
 #else  // HDF5 enabled
-  const H5O obj = H5O::FromHIDCheck(H5Oopen(fh_, "Info", H5P_DEFAULT));
+  const H5O obj = H5O::FromHIDCheck(H5Oopen(meta_fh_, "Info", H5P_DEFAULT));
   auto status = PARTHENON_HDF5_CHECK(H5Aexists(obj, "OutputFormatVersion"));
   // file contains version info
   if (status > 0) {
@@ -80,7 +210,7 @@ RestartReaderHDF5::SparseInfo RestartReaderHDF5::GetSparseInfo() const {
 
   // check if SparseInfo exists, if not, return the default-constructed SparseInfo
   // instance
-  auto status = PARTHENON_HDF5_CHECK(H5Lexists(fh_, "SparseInfo", H5P_DEFAULT));
+  auto status = PARTHENON_HDF5_CHECK(H5Lexists(meta_fh_, "SparseInfo", H5P_DEFAULT));
   if (status > 0) {
     // SparseInfo exists, read its contents
     auto hdl = OpenDataset<bool>("SparseInfo");
@@ -133,15 +263,25 @@ RestartReaderHDF5::MeshInfo RestartReaderHDF5::GetMeshInfo() const {
 
   mesh_info.grid_dim = GetAttrVec<Real>("Info", "RootGridDomain");
 
-  mesh_info.lx123 = ReadDataset<int64_t>("/Blocks/loc.lx123");
-  mesh_info.level_gid_lid_cnghost_gflag =
-      ReadDataset<int>("/Blocks/loc.level-gid-lid-cnghost-gflag");
-
+  // Every rank needs the locations of all blocks to build the tree, but there is no need
+  // for all of them to read these from the file
   auto status =
       PARTHENON_HDF5_CHECK(H5Lexists(fh_, "Blocks/derefinement_count", H5P_DEFAULT));
-  if (status > 0) {
-    mesh_info.derefinement_count = ReadDataset<int>("/Blocks/derefinement_count");
-  } else {
+  if (Globals::my_rank == 0) {
+    mesh_info.lx123 = ReadDataset<int64_t>("/Blocks/loc.lx123");
+    mesh_info.level_gid_lid_cnghost_gflag =
+        ReadDataset<int>("/Blocks/loc.level-gid-lid-cnghost-gflag");
+    if (status > 0) {
+      mesh_info.derefinement_count = ReadDataset<int>("/Blocks/derefinement_count");
+    }
+  }
+#ifdef MPI_PARALLEL
+  BroadcastVector(mesh_info.lx123);
+  BroadcastVector(mesh_info.level_gid_lid_cnghost_gflag);
+  if (status > 0) BroadcastVector(mesh_info.derefinement_count);
+#endif
+
+  if (status <= 0) {
     // File does not contain this dataset, so must be older. Set to default value of zero
     if (Globals::my_rank == 0 && (GetAttr<int>("Info", "Multilevel") != 0))
       PARTHENON_WARN("Restarting from an HDF5 file that doesn't contain "
@@ -212,6 +352,32 @@ void RestartReaderHDF5::ReadBlocks(const std::string &name, IndexRange range,
 #ifndef ENABLE_HDF5
   PARTHENON_FAIL("Restart functionality is not available because HDF5 is disabled");
 #else  // HDF5 enabled
+  const IndexDomain domain = has_ghost != 0 ? IndexDomain::entire : IndexDomain::interior;
+  const auto grouped = grouped_vars_.find(name);
+  if (grouped != grouped_vars_.end()) {
+    // The components of the variable in the [block, component, k, j, i] dataset of its
+    // group have the same order as in a dataset of its own
+    auto hdl = OpenDataset<Real>(grouped->second.dataset);
+    const auto [n3, n2, n1] = info.GetNumKJI(domain);
+    hsize_t offset[5] = {static_cast<hsize_t>(range.s),
+                         static_cast<hsize_t>(grouped->second.offset), 0, 0, 0};
+    hsize_t count[5] = {static_cast<hsize_t>(range.e - range.s + 1),
+                        static_cast<hsize_t>(grouped->second.ncomp),
+                        static_cast<hsize_t>(n3), static_cast<hsize_t>(n2),
+                        static_cast<hsize_t>(n1)};
+    const hsize_t total_count = count[0] * count[1] * count[2] * count[3] * count[4];
+    PARTHENON_REQUIRE_THROWS(dataVec.size() >= total_count,
+                             "Buffer (size " + std::to_string(dataVec.size()) +
+                                 ") is too small for variable " + name + " (size " +
+                                 std::to_string(total_count) + ")");
+    const H5S memspace = H5S::FromHIDCheck(H5Screate_simple(5, count, NULL));
+    PARTHENON_HDF5_CHECK(
+        H5Sselect_hyperslab(hdl.dataspace, H5S_SELECT_SET, offset, NULL, count, NULL));
+    PARTHENON_HDF5_CHECK(H5Dread(hdl.dataset, hdl.type, memspace, hdl.dataspace,
+                                 pl_xfer_, dataVec.data()));
+    return;
+  }
+
   auto hdl = OpenDataset<Real>(name);
 
   const int VNDIM = info.VNDIM;
@@ -224,7 +390,6 @@ void RestartReaderHDF5::ReadBlocks(const std::string &name, IndexRange range,
 
   offset[0] = static_cast<hsize_t>(range.s);
   count[0] = static_cast<hsize_t>(range.e - range.s + 1);
-  const IndexDomain domain = has_ghost != 0 ? IndexDomain::entire : IndexDomain::interior;
 
   // Currently supports versions 3 and 4.
   if (file_output_format_version >= HDF5::OUTPUT_VERSION_FORMAT - 1) {
@@ -247,13 +412,75 @@ void RestartReaderHDF5::ReadBlocks(const std::string &name, IndexRange range,
                                std::to_string(total_count) + ")");
 
   const H5S memspace = H5S::FromHIDCheck(H5Screate_simple(total_dim, count, NULL));
-  PARTHENON_HDF5_CHECK(
-      H5Sselect_hyperslab(hdl.dataspace, H5S_SELECT_SET, offset, NULL, count, NULL));
+  if (base_ == nullptr) {
+    PARTHENON_HDF5_CHECK(
+        H5Sselect_hyperslab(hdl.dataspace, H5S_SELECT_SET, offset, NULL, count, NULL));
+  }
+
+  if (base_ == nullptr) {
+    // Read data from file, collectively with MPI, which requires all ranks to read the
+    // same variables in the same order
+    PARTHENON_HDF5_CHECK(H5Dread(hdl.dataset, hdl.type, memspace, hdl.dataspace,
+                                 pl_xfer_, dataVec.data()));
+    return;
+  }
 
-  // Read data from file
-  PARTHENON_HDF5_CHECK(H5Dread(hdl.dataset, hdl.type, memspace, hdl.dataspace,
-                               H5P_DEFAULT, dataVec.data()));
+  // Incremental restart: start with the data in the base file and replace the blocks
+  // that changed since then, which are stored in order of their global ids
+  base_->ReadBlocks(name, range, info, dataVec, file_output_format_version);
+  const auto gids = ReadDataset<int64_t>("/Incremental/" + name);
+  const hsize_t block_count = total_count / count[0];
+  std::vector<int64_t> local_gids;
+  PARTHENON_HDF5_CHECK(H5Sselect_none(hdl.dataspace));
+  count[0] = 1;
+  for (hsize_t n = 0; n < gids.size(); ++n) {
+    if (gids[n] < range.s || gids[n] > range.e) continue;
+    offset[0] = n;
+    PARTHENON_HDF5_CHECK(
+        H5Sselect_hyperslab(hdl.dataspace, H5S_SELECT_OR, offset, NULL, count, NULL));
+    local_gids.push_back(gids[n]);
+  }
+  count[0] = local_gids.size();
+  std::vector<Real> changed(local_gids.size() * block_count);
+  const H5S changed_memspace =
+      H5S::FromHIDCheck(H5Screate_simple(total_dim, count, NULL));
+  PARTHENON_HDF5_CHECK(H5Dread(hdl.dataset, hdl.type, changed_memspace, hdl.dataspace,
+                               pl_xfer_, changed.data()));
+  for (size_t n = 0; n < local_gids.size(); ++n) {
+    std::copy(changed.begin() + n * block_count, changed.begin() + (n + 1) * block_count,
+              dataVec.begin() + (local_gids[n] - range.s) * block_count);
+  }
 #endif // ENABLE_HDF5
 }
 
+void RestartReaderHDF5::ReadRawBlockData(const std::string &name, const int gid,
+                                         Real *dst, const std::size_t count) const {
+  const auto it = raw_vars_.find(name);
+  PARTHENON_REQUIRE_THROWS(it != raw_vars_.end(),
+                           "Variable " + name + " is not in the raw block data");
+  const int v = it->second;
+  PARTHENON_REQUIRE_THROWS(raw_sizes_[v] == static_cast<std::int64_t>(count),
+                           "Size of variable " + name +
+                               " doesn't match the raw block data");
+  const std::int64_t offset = raw_offsets_[gid * raw_vars_.size() + v];
+  PARTHENON_REQUIRE_THROWS(offset >= 0, "Variable " + name +
+                                            " is not allocated on block " +
+                                            std::to_string(gid) + " in the raw data");
+
+  // Blocks can be read from the files of any number of ranks, since every block is
+  // found through the rank that wrote it
+  const int rank = raw_ranks_[gid];
+  auto &mapped = raw_files_[rank];
+  if (mapped == nullptr) {
+    mapped = std::make_unique<RawBlockData::MappedFile>(
+        RawBlockData::Filename(raw_filename_, rank), rank);
+  }
+  // Directly from the mapped pages to the device
+  Kokkos::View<const Real *, HostMemSpace, Kokkos::MemoryTraits<Kokkos::Unmanaged>> src(
+      mapped->Data(offset, count), count);
+  Kokkos::View<Real *, DevMemSpace, Kokkos::MemoryTraits<Kokkos::Unmanaged>> dst_view(
+      dst, count);
+  Kokkos::deep_copy(dst_view, src);
+}
+
 } // namespace parthenon
@@ -19,10 +19,16 @@
 //! \file io_wrapper.hpp
 //  \brief defines a set of small wrapper functions for MPI versus Serial Output.
 
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "config.hpp"
+#include "outputs/raw_block_data.hpp"
 #include "outputs/restart.hpp"
 #ifdef ENABLE_HDF5
 #include <hdf5.h>
@@ -71,6 +77,15 @@ class RestartReaderHDF5 : public RestartReader {
     std::vector<hsize_t> dims;
   };
 
+  void OpenMetadata_();
+  // The file object name is read from, the in-memory copy for the objects in it
+  hid_t FileOf_(const std::string &name) const {
+    const auto start = name.find_first_not_of('/');
+    const auto top = name.substr(start, name.find('/', start) - start);
+    return meta_objects_.count(top) > 0 ? static_cast<hid_t>(meta_fh_)
+                                        : static_cast<hid_t>(fh_);
+  }
+
   // internal convenience function to open a dataset, perform some checks, and get
   // dimensions
   template <typename T>
@@ -78,12 +93,13 @@ class RestartReaderHDF5 : public RestartReader {
     DatasetHandle handle;
 
     // make sure dataset exists
-    auto status = PARTHENON_HDF5_CHECK(H5Oexists_by_name(fh_, name.c_str(), H5P_DEFAULT));
+    const hid_t fh = FileOf_(name);
+    auto status = PARTHENON_HDF5_CHECK(H5Oexists_by_name(fh, name.c_str(), H5P_DEFAULT));
     PARTHENON_REQUIRE_THROWS(
         status > 0, "Dataset '" + name + "' does not exist in HDF5 file " + filename_);
 
     // open dataset
-    handle.dataset = H5D::FromHIDCheck(H5Dopen2(fh_, name.c_str(), H5P_DEFAULT));
+    handle.dataset = H5D::FromHIDCheck(H5Dopen2(fh, name.c_str(), H5P_DEFAULT));
     handle.dataspace = H5S::FromHIDCheck(H5Dget_space(handle.dataset));
 
     // get the HDF5 type from the template parameter and make sure it matches the dataset
@@ -117,6 +133,11 @@ class RestartReaderHDF5 : public RestartReader {
                   const OutputUtils::VarInfo &info, std::vector<Real> &dataVec,
                   int file_output_format_version) const override;
 
+  [[nodiscard]] bool HasRawBlockData() const override { return !raw_vars_.empty(); }
+
+  void ReadRawBlockData(const std::string &name, int gid, Real *dst,
+                        std::size_t count) const override;
+
   // Gets the data from a swarm var on current rank. Assumes all
   // blocks are contiguous. Fills dataVec based on shape from swarmvar
   // metadata.
@@ -182,10 +203,11 @@ class RestartReaderHDF5 : public RestartReader {
     PARTHENON_FAIL("Restart functionality is not available because HDF5 is disabled");
 #else  // HDF5 enabled
     // check if the location exists in the file
-    PARTHENON_HDF5_CHECK(H5Oexists_by_name(fh_, location.c_str(), H5P_DEFAULT));
+    const hid_t fh = FileOf_(location);
+    PARTHENON_HDF5_CHECK(H5Oexists_by_name(fh, location.c_str(), H5P_DEFAULT));
 
     // open the object specified by the location path, this could be a dataset or group
-    const H5O obj = H5O::FromHIDCheck(H5Oopen(fh_, location.c_str(), H5P_DEFAULT));
+    const H5O obj = H5O::FromHIDCheck(H5Oopen(fh, location.c_str(), H5P_DEFAULT));
 
     return HDF5ReadAttributeVec<T>(obj, name);
 #endif // ENABLE_HDF5
@@ -237,8 +259,34 @@ class RestartReaderHDF5 : public RestartReader {
   // Currently all restarts are HDF5 files
   // when that changes, this will be revisited
   H5F fh_;
+  // In-memory copy of the small objects of the file that all ranks read (e.g., the input,
+  // info, and params), which only rank 0 reads from the file and broadcasts, so that
+  // large jobs don't have every rank read them at the same time
+  H5F meta_fh_;
+  std::set<std::string> meta_objects_;
   H5G params_group_;
+  // transfer properties of the block data reads, collective with MPI
+  H5P pl_xfer_;
+  // base of an incremental restart file
+  std::unique_ptr<RestartReaderHDF5> base_;
+  // Dataset, first component, and number of components of the variables in grouped
+  // datasets, see hdf5_group_variables
+  struct GroupedVar {
+    std::string dataset;
+    int offset, ncomp;
+  };
+  std::unordered_map<std::string, GroupedVar> grouped_vars_;
 #endif // ENABLE_HDF5
+
+  // Where the data of the blocks is in the raw files, see raw_block_data: the rank that
+  // wrote block gid, the number of values of every variable, and the offset of
+  // variable v on block gid in the file at raw_offsets_[gid * raw_vars_.size() + v]
+  std::string raw_filename_;
+  std::unordered_map<std::string, int> raw_vars_;
+  std::vector<std::int64_t> raw_sizes_, raw_offsets_;
+  std::vector<int> raw_ranks_;
+  // files are mapped once something is read from them
+  mutable std::map<int, std::unique_ptr<RawBlockData::MappedFile>> raw_files_;
 };
 
 } // namespace parthenon
@@ -0,0 +1,330 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+//! \file sample.cpp
+//  \brief writes variables interpolated to the points of axis-aligned slices, lines, or
+//         probes. Only the ranks owning blocks that contain points do any work, and the
+//         values are gathered on a single writer rank.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "coordinates/coordinates.hpp"
+#include "globals.hpp"
+#include "interface/variable_pack.hpp"
+#include "kokkos_abstraction.hpp"
+#include "mesh/forest/block_locator.hpp"
+#include "mesh/mesh.hpp"
+#include "outputs/outputs.hpp"
+#include "parameter_input.hpp"
+#include "parthenon_mpi.hpp"
+#include "utils/error_checking.hpp"
+#include "utils/instrument.hpp"
+
+namespace parthenon {
+
+SampleOutput::SampleOutput(const OutputParameters &op, ParameterInput *pin)
+    : OutputType(op) {
+  const auto &block = op.block_name;
+  PARTHENON_REQUIRE_THROWS(!op.variables.empty(),
+                           "Sample output " + block + " requires variables");
+  // Spread the writing of several sample outputs over ranks
+  writer_ = op.block_number % Globals::nranks;
+  if (op.file_type == "slice") {
+    normal_ = pin->GetInteger(block, "normal");
+    PARTHENON_REQUIRE_THROWS(normal_ >= 1 && normal_ <= 3,
+                             "normal of " + block + " must be 1, 2, or 3");
+    position_ = pin->GetReal(block, "position");
+    npoints_ = pin->GetVector<int>(block, "npoints");
+    PARTHENON_REQUIRE_THROWS(npoints_.size() == 2,
+                             "npoints of slice " + block + " requires two entries");
+  } else if (op.file_type == "line") {
+    start_ = pin->GetVector<Real>(block, "start");
+    end_ = pin->GetVector<Real>(block, "end");
+    PARTHENON_REQUIRE_THROWS(start_.size() == 3 && end_.size() == 3,
+                             "start and end of line " + block + " require x1, x2, x3");
+    npoints_ = {pin->GetInteger(block, "npoints")};
+  } else {
+    probes_ = pin->GetVector<Real>(block, "positions");
+    PARTHENON_REQUIRE_THROWS(!probes_.empty() && probes_.size() % 3 == 0,
+                             "positions of probes " + block +
+                                 " require x1, x2, x3 of every probe");
+  }
+  for (const auto n : npoints_) {
+    PARTHENON_REQUIRE_THROWS(n > 0, "npoints of " + block + " must be positive");
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void SampleOutput::MakePoints_(Mesh *pm)
+//  \brief Positions of the points. Slices sample the centers of a uniform grid covering
+//  the mesh, and lines include their end points.
+void SampleOutput::MakePoints_(Mesh *pm) {
+  points_h_.clear();
+  if (output_params.file_type == "slice") {
+    const int d = normal_ - 1;
+    const int a = d == 0 ? 1 : 0;
+    const int b = d == 2 ? 1 : 2;
+    const auto &ms = pm->mesh_size;
+    const auto dir = [](const int n) { return static_cast<CoordinateDirection>(n + 1); };
+    const Real dxa = (ms.xmax(dir(a)) - ms.xmin(dir(a))) / npoints_[0];
+    const Real dxb = (ms.xmax(dir(b)) - ms.xmin(dir(b))) / npoints_[1];
+    for (int jb = 0; jb < npoints_[1]; ++jb) {
+      for (int ja = 0; ja < npoints_[0]; ++ja) {
+        Real x[3];
+        x[d] = position_;
+        x[a] = ms.xmin(dir(a)) + (ja + 0.5) * dxa;
+        x[b] = ms.xmin(dir(b)) + (jb + 0.5) * dxb;
+        points_h_.insert(points_h_.end(), x, x + 3);
+      }
+    }
+  } else if (output_params.file_type == "line") {
+    const int n = npoints_[0];
+    for (int p = 0; p < n; ++p) {
+      const Real t = n > 1 ? static_cast<Real>(p) / (n - 1) : 0.0;
+      for (int d = 0; d < 3; ++d)
+        points_h_.push_back(start_[d] + t * (end_[d] - start_[d]));
+    }
+  } else {
+    points_h_ = probes_;
+  }
+
+  const int npoints = points_h_.size() / 3;
+  points_ = ParArray2D<Real>("SampleOutput::points", npoints, 3);
+  auto points_m = points_.GetHostMirror();
+  for (int p = 0; p < npoints; ++p) {
+    for (int d = 0; d < 3; ++d)
+      points_m(p, d) = points_h_[3 * p + d];
+  }
+  points_.DeepCopy(points_m);
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn std::vector<Real> SampleOutput::Sample_(Mesh *pm)
+//  \brief Finds the block containing every point with the block locator of the forest
+//  and interpolates trilinearly between the cell centers around it, in a single kernel
+//  over all points and components. The stencil can reach into the ghost zones.
+std::vector<Real> SampleOutput::Sample_(Mesh *pm) {
+  PARTHENON_INSTRUMENT
+  auto &md = pm->mesh_data.Get();
+  PackIndexMap imap;
+  const auto pack = md->PackVariables(output_params.variables, imap);
+  if (labels_.empty()) {
+    for (const auto &var : output_params.variables) {
+      const auto &[lo, hi] = imap.get(var);
+      for (int v = lo; v <= hi; ++v)
+        labels_.push_back(lo == hi ? var : var + "_" + std::to_string(v - lo));
+    }
+  }
+  const int ncomp = labels_.size();
+  const int npoints = points_h_.size() / 3;
+
+  // the blocks of a rank are contiguous in gid order
+  const auto nblist = pm->GetNbList();
+  int gid_offset = 0;
+  for (int r = 0; r < Globals::my_rank; ++r)
+    gid_offset += nblist[r];
+  const int nblocks = pm->block_list.size();
+
+  const auto ib = md->GetBoundsI(IndexDomain::entire);
+  const auto jb = md->GetBoundsJ(IndexDomain::entire);
+  const auto kb = md->GetBoundsK(IndexDomain::entire);
+  const int n[3] = {ib.e - ib.s + 1, jb.e - jb.s + 1, kb.e - kb.s + 1};
+  const auto locator = pm->GetBlockLocator();
+  const auto points = points_;
+  ParArray1D<int> owned("SampleOutput::owned", npoints);
+  ParArray2D<Real> values("SampleOutput::values", npoints, ncomp);
+  parthenon::par_for(
+      DEFAULT_LOOP_PATTERN, "SampleOutput::Sample", DevExecSpace(), 0, npoints - 1,
+      KOKKOS_LAMBDA(const int p) {
+        Real x = points(p, 0);
+        Real y = points(p, 1);
+        Real z = points(p, 2);
+        const int b = locator.FindGid(x, y, z) - gid_offset;
+        owned(p) = b >= 0 && b < nblocks;
+        if (!owned(p)) return;
+        locator.ApplyPeriodicity(x, y, z);
+        const auto &coords = pack.GetCoords(b);
+        Real t[3] = {(x - coords.Xc<1>(0)) / coords.Dxc<1>(),
+                     (y - coords.Xc<2>(0)) / coords.Dxc<2>(),
+                     (z - coords.Xc<3>(0)) / coords.Dxc<3>()};
+        int idx[3];
+        for (int d = 0; d < 3; ++d) {
+          // directions without extent do not interpolate
+          idx[d] = n[d] > 1 ? Kokkos::max(
+                                  0, Kokkos::min(static_cast<int>(Kokkos::floor(t[d])),
+                                                 n[d] - 2))
+                            : 0;
+          t[d] = n[d] > 1 ? t[d] - idx[d] : 0.0;
+        }
+        for (int c = 0; c < ncomp; ++c) {
+          Real sum = 0.0;
+          if (pack.IsAllocated(b, c)) {
+            for (int ck = 0; ck < 2; ++ck) {
+              for (int cj = 0; cj < 2; ++cj) {
+                for (int ci = 0; ci < 2; ++ci) {
+                  const Real w = (ci ? t[0] : 1.0 - t[0]) * (cj ? t[1] : 1.0 - t[1]) *
+                                 (ck ? t[2] : 1.0 - t[2]);
+                  if (w == 0.0) continue;
+                  sum += w * pack(b, c, idx[2] + ck, idx[1] + cj, idx[0] + ci);
+                }
+              }
+            }
+          }
+          values(p, c) = sum;
+        }
+      });
+
+  // Only the points of this rank are sent to the writer
+  auto owned_h = owned.GetHostMirrorAndCopy();
+  auto values_h = values.GetHostMirrorAndCopy();
+  std::vector<int> send_idx;
+  std::vector<Real> send_values;
+  for (int p = 0; p < npoints; ++p) {
+    if (!owned_h(p)) continue;
+    send_idx.push_back(p);
+    for (int c = 0; c < ncomp; ++c)
+      send_values.push_back(values_h(p, c));
+  }
+  std::vector<int> recv_idx = send_idx;
+  std::vector<Real> recv_values = send_values;
+#ifdef MPI_PARALLEL
+  const int nranks = Globals::nranks;
+  int nsend = send_idx.size();
+  std::vector<int> counts(nranks), displs(nranks);
+  PARTHENON_MPI_CHECK(MPI_Gather(&nsend, 1, MPI_INT, counts.data(), 1, MPI_INT, writer_,
+                                 MPI_COMM_WORLD));
+  int nrecv = 0;
+  for (int r = 0; r < nranks; ++r) {
+    displs[r] = nrecv;
+    nrecv += counts[r];
+  }
+  recv_idx.resize(nrecv);
+  PARTHENON_MPI_CHECK(MPI_Gatherv(send_idx.data(), nsend, MPI_INT, recv_idx.data(),
+                                  counts.data(), displs.data(), MPI_INT, writer_,
+                                  MPI_COMM_WORLD));
+  for (int r = 0; r < nranks; ++r) {
+    counts[r] *= ncomp;
+    displs[r] *= ncomp;
+  }
+  recv_values.resize(nrecv * ncomp);
+  PARTHENON_MPI_CHECK(MPI_Gatherv(send_values.data(), nsend * ncomp, MPI_PARTHENON_REAL,
+                                  recv_values.data(), counts.data(), displs.data(),
+                                  MPI_PARTHENON_REAL, writer_, MPI_COMM_WORLD));
+#endif // MPI_PARALLEL
+
+  std::vector<Real> result;
+  if (Globals::my_rank == writer_) {
+    result.assign(npoints * ncomp, std::numeric_limits<Real>::quiet_NaN());
+    for (int q = 0; q < recv_idx.size(); ++q) {
+      std::copy(&recv_values[q * ncomp], &recv_values[q * ncomp] + ncomp,
+                &result[recv_idx[q] * ncomp]);
+    }
+  }
+  return result;
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void SampleOutput::WriteFile_(const std::vector<Real> &values, SimTime *tm)
+//  \brief Probes append a row per output to a single file like history outputs, slices
+//  and lines write a file per output with a row per point
+void SampleOutput::WriteFile_(const std::vector<Real> &values, SimTime *tm) {
+  const auto &op = output_params;
+  const bool probes = op.file_type == "probes";
+  const int ncomp = labels_.size();
+  const int npoints = points_h_.size() / 3;
+  const Real time = tm != nullptr ? tm->time : 0.0;
+  const int ncycle = tm != nullptr ? tm->ncycle : 0;
+  const char *fmt = op.data_format.c_str();
+
+  std::stringstream fname;
+  fname << op.file_basename << "." << op.file_id << ".";
+  if (!probes) {
+    fname << std::setw(op.file_number_width) << std::setfill('0') << op.file_number
+          << ".";
+  }
+  fname << op.file_type;
+  FILE *pfile = std::fopen(fname.str().c_str(), probes ? "a" : "w");
+  PARTHENON_REQUIRE_THROWS(pfile != nullptr,
+                           "Sample file '" + fname.str() + "' could not be opened");
+
+  if (probes) {
+    if (op.file_number == 0) {
+      std::fprintf(pfile, "#  Probes at");
+      for (int p = 0; p < npoints; ++p) {
+        std::fprintf(pfile, " [%d]=(%g, %g, %g)", p, points_h_[3 * p],
+                     points_h_[3 * p + 1], points_h_[3 * p + 2]);
+      }
+      std::fprintf(pfile, "\n");
+      int iout = 1;
+      std::fprintf(pfile, "# [%d]=time    ", iout++);
+      std::fprintf(pfile, " [%d]=cycle   ", iout++);
+      for (int p = 0; p < npoints; ++p) {
+        for (const auto &label : labels_)
+          std::fprintf(pfile, " [%d]=%s_%d", iout++, label.c_str(), p);
+      }
+      std::fprintf(pfile, "\n");
+    }
+    std::fprintf(pfile, fmt, time);
+    std::fprintf(pfile, " %12d", ncycle);
+    for (const auto value : values)
+      std::fprintf(pfile, fmt, value);
+    std::fprintf(pfile, "\n");
+  } else {
+    std::fprintf(pfile, "#  %s at time = %e, cycle = %d\n",
+                 op.file_type == "slice" ? "Slice" : "Line", time, ncycle);
+    if (op.file_type == "slice") {
+      std::fprintf(pfile, "#  normal = x%d, position = %e, npoints = %d x %d\n", normal_,
+                   position_, npoints_[0], npoints_[1]);
+    }
+    int iout = 1;
+    for (int d = 1; d <= 3; ++d)
+      std::fprintf(pfile, "# [%d]=x%d ", iout++, d);
+    for (const auto &label : labels_)
+      std::fprintf(pfile, " [%d]=%s", iout++, label.c_str());
+    std::fprintf(pfile, "\n");
+    for (int p = 0; p < npoints; ++p) {
+      for (int d = 0; d < 3; ++d)
+        std::fprintf(pfile, fmt, points_h_[3 * p + d]);
+      for (int c = 0; c < ncomp; ++c)
+        std::fprintf(pfile, fmt, values[p * ncomp + c]);
+      std::fprintf(pfile, "\n");
+    }
+  }
+  std::fclose(pfile);
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void SampleOutput::WriteOutputFile(Mesh *pm, ParameterInput *pin, SimTime *tm,
+//                                         const SignalHandler::OutputSignal signal)
+//  \brief Samples the variables and writes them on the writer rank
+void SampleOutput::WriteOutputFile(Mesh *pm, ParameterInput *pin, SimTime *tm,
+                                   const SignalHandler::OutputSignal signal) {
+  PARTHENON_INSTRUMENT
+  if (points_h_.empty()) MakePoints_(pm);
+  const auto values = Sample_(pm);
+  if (Globals::my_rank == writer_) WriteFile_(values, tm);
+
+  // advance output parameters
+  output_params.file_number++;
+  output_params.next_time += output_params.dt;
+  pin->SetInteger(output_params.block_name, "file_number", output_params.file_number);
+  pin->SetReal(output_params.block_name, "next_time", output_params.next_time);
+}
+
+} // namespace parthenon
@@ -0,0 +1,346 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+//! \file statistics.cpp
+//  \brief writes statistics of variables (moments, extrema, and percentiles) that are
+//         computed from mergeable sketches without writing the variables themselves
+
+#include <cstdio>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// ScatterView is not part of Kokkos core interface
+#include "Kokkos_ScatterView.hpp"
+
+#include "coordinates/coordinates.hpp"
+#include "globals.hpp"
+#include "interface/variable_pack.hpp"
+#include "kokkos_abstraction.hpp"
+#include "mesh/mesh.hpp"
+#include "outputs/outputs.hpp"
+#include "outputs/statistics_sketch.hpp"
+#include "parameter_input.hpp"
+#include "utils/error_checking.hpp"
+#include "utils/instrument.hpp"
+
+namespace parthenon {
+namespace {
+// Count, power sums, and extrema (with the flat index of their cell) of the values of
+// one component on one block, reduced over the threads of a team
+struct BlockMoments {
+  Real s[5];
+  Real min, max;
+  int imin, imax;
+  KOKKOS_INLINE_FUNCTION BlockMoments &operator+=(const BlockMoments &other) {
+    for (int p = 0; p < 5; ++p)
+      s[p] += other.s[p];
+    if (other.min < min) {
+      min = other.min;
+      imin = other.imin;
+    }
+    if (other.max > max) {
+      max = other.max;
+      imax = other.imax;
+    }
+    return *this;
+  }
+};
+} // namespace
+} // namespace parthenon
+
+namespace Kokkos {
+template <>
+struct reduction_identity<parthenon::BlockMoments> {
+  KOKKOS_FORCEINLINE_FUNCTION static parthenon::BlockMoments sum() {
+    return {{0.0, 0.0, 0.0, 0.0, 0.0},
+            reduction_identity<parthenon::Real>::min(),
+            reduction_identity<parthenon::Real>::max(),
+            -1,
+            -1};
+  }
+};
+} // namespace Kokkos
+
+namespace parthenon {
+namespace {
+#ifdef MPI_PARALLEL
+// MPI reduction of arrays of sketches, whose length is that of the MPI datatype
+void MergeSketches(void *in, void *inout, int *len, MPI_Datatype *type) {
+  int size;
+  MPI_Type_size(*type, &size);
+  const int stride = size / sizeof(Real);
+  for (int n = 0; n < *len; ++n) {
+    StatsUtil::Merge(static_cast<const Real *>(in) + n * stride,
+                     static_cast<Real *>(inout) + n * stride, stride);
+  }
+}
+#endif // MPI_PARALLEL
+} // namespace
+
+StatisticsOutput::StatisticsOutput(const OutputParameters &op, ParameterInput *pin)
+    : OutputType(op) {
+  const auto &block = op.block_name;
+  PARTHENON_REQUIRE_THROWS(!op.variables.empty(),
+                           "Statistics output " + block + " requires variables");
+  const Real relative_accuracy = pin->GetOrAddReal(block, "relative_accuracy", 0.01);
+  const Real min_magnitude = pin->GetOrAddReal(block, "min_magnitude", 1.0e-8);
+  const Real max_magnitude = pin->GetOrAddReal(block, "max_magnitude", 1.0e8);
+  PARTHENON_REQUIRE_THROWS(relative_accuracy > 0.0 && relative_accuracy < 1.0,
+                           "relative_accuracy of " + block + " must be in (0, 1)");
+  PARTHENON_REQUIRE_THROWS(min_magnitude > 0.0 && max_magnitude > min_magnitude,
+                           "Requires 0 < min_magnitude < max_magnitude in " + block);
+  layout_ = StatsUtil::SketchLayout(relative_accuracy, min_magnitude, max_magnitude);
+  accumulate_ = pin->GetOrAddBoolean(block, "accumulate", false);
+  percentiles_ = pin->GetOrAddVector<Real>(block, "percentiles", {1.0, 50.0, 99.0});
+  for (const auto p : percentiles_) {
+    PARTHENON_REQUIRE_THROWS(p >= 0.0 && p <= 100.0,
+                             "percentiles of " + block + " must be in [0, 100]");
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void StatisticsOutput::UpdateSketches_(Mesh *pm)
+//  \brief Computes the sketches of all components of the variables over the interior
+//  cells of all blocks, with one kernel per partition, and merges them over ranks with
+//  a single reduction. The power sums are taken about the means of the previous update
+//  to avoid cancellation.
+void StatisticsOutput::UpdateSketches_(Mesh *pm) {
+  PARTHENON_INSTRUMENT
+  using namespace StatsUtil;
+  const int stride = layout_.Stride();
+  const int nbins = layout_.NumBins();
+  constexpr int nhead = offset::bins;
+
+  std::vector<Real> update;
+  const auto base = pm->mesh_data.GetStageHandle("base");
+  const int npartitions = pm->GetDefaultBlockPartitions().size();
+  for (int ipart = 0; ipart < npartitions; ++ipart) {
+    auto &md = pm->mesh_data.GetOrAdd(base, ipart);
+    PackIndexMap imap;
+    const auto pack = md->PackVariables(output_params.variables, imap);
+
+    // The components are the same on every partition, so they are set up once
+    std::vector<int> vidx;
+    std::vector<std::string> labels;
+    for (const auto &var : output_params.variables) {
+      const auto &[lo, hi] = imap.get(var);
+      for (int v = lo; v <= hi; ++v) {
+        vidx.push_back(v);
+        labels.push_back(lo == hi ? var : var + "_" + std::to_string(v - lo));
+      }
+    }
+    const int ncomp = vidx.size();
+    if (labels_.empty()) {
+      labels_ = labels;
+      shift_.assign(ncomp, 0.0);
+      bins_ = ParArray1D<Real>("StatisticsOutput::bins", ncomp * nbins);
+      scatter_bins_ =
+          Kokkos::Experimental::ScatterView<Real *, LayoutWrapper>(bins_.KokkosView());
+    }
+    PARTHENON_REQUIRE_THROWS(labels == labels_, "Variables of statistics output " +
+                                                    output_params.block_name +
+                                                    " changed");
+    if (update.empty()) {
+      update.resize(ncomp * stride);
+      for (int c = 0; c < ncomp; ++c)
+        Reset(&update[c * stride], stride);
+      scatter_bins_.reset();
+      Kokkos::deep_copy(bins_.KokkosView(), 0);
+    }
+
+    ParArray1D<int> comp_vidx("StatisticsOutput::vidx", ncomp);
+    ParArray1D<Real> shift("StatisticsOutput::shift", ncomp);
+    auto vidx_h = comp_vidx.GetHostMirror();
+    auto shift_h = shift.GetHostMirror();
+    for (int c = 0; c < ncomp; ++c) {
+      vidx_h(c) = vidx[c];
+      shift_h(c) = shift_[c];
+    }
+    comp_vidx.DeepCopy(vidx_h);
+    shift.DeepCopy(shift_h);
+
+    const int nblocks = pack.GetDim(5);
+    ParArray1D<Real> partial("StatisticsOutput::partial", nblocks * ncomp * nhead);
+    const auto ib = md->GetBoundsI(IndexDomain::interior);
+    const auto jb = md->GetBoundsJ(IndexDomain::interior);
+    const auto kb = md->GetBoundsK(IndexDomain::interior);
+    const int ni = ib.e - ib.s + 1;
+    const int nj = jb.e - jb.s + 1;
+    const int ncells = ni * nj * (kb.e - kb.s + 1);
+    const auto layout = layout_;
+    auto scatter = scatter_bins_;
+    par_for_outer(
+        DEFAULT_OUTER_LOOP_PATTERN, "StatisticsOutput::UpdateSketches", DevExecSpace(),
+        0, 0, 0, nblocks - 1, 0, ncomp - 1,
+        KOKKOS_LAMBDA(team_mbr_t member, const int b, const int c) {
+          Real *head = &partial((b * ncomp + c) * nhead);
+          const int v = comp_vidx(c);
+          BlockMoments moments = Kokkos::reduction_identity<BlockMoments>::sum();
+          if (pack.IsAllocated(b, v)) {
+            const Real a = shift(c);
+            Kokkos::parallel_reduce(
+                Kokkos::TeamThreadRange(member, ncells),
+                [&](const int n, BlockMoments &lm) {
+                  const int k = kb.s + n / (ni * nj);
+                  const int j = jb.s + (n / ni) % nj;
+                  const int i = ib.s + n % ni;
+                  const Real x = pack(b, v, k, j, i);
+                  const Real y = x - a;
+                  lm.s[0] += 1.0;
+                  lm.s[1] += y;
+                  lm.s[2] += y * y;
+                  lm.s[3] += y * y * y;
+                  lm.s[4] += y * y * y * y;
+                  if (x < lm.min) {
+                    lm.min = x;
+                    lm.imin = n;
+                  }
+                  if (x > lm.max) {
+                    lm.max = x;
+                    lm.imax = n;
+                  }
+                  auto bins = scatter.access();
+                  bins(c * layout.NumBins() + layout.Bin(x)) += 1.0;
+                },
+                Kokkos::Sum<BlockMoments>(moments));
+          }
+          Kokkos::single(Kokkos::PerTeam(member), [&]() {
+            for (int p = 0; p < 5; ++p)
+              head[offset::count + p] = moments.s[p];
+            head[offset::min] = moments.min;
+            head[offset::max] = moments.max;
+            // Coordinates of the extrema, or of the first cell if there are none
+            const auto &coords = pack.GetCoords(b);
+            const int offsets[2] = {offset::min, offset::max};
+            const int cells[2] = {moments.imin, moments.imax};
+            for (int e = 0; e < 2; ++e) {
+              const int n = Kokkos::max(cells[e], 0);
+              const int k = kb.s + n / (ni * nj);
+              const int j = jb.s + (n / ni) % nj;
+              const int i = ib.s + n % ni;
+              head[offsets[e] + 1] = coords.Xc<1>(k, j, i);
+              head[offsets[e] + 2] = coords.Xc<2>(k, j, i);
+              head[offsets[e] + 3] = coords.Xc<3>(k, j, i);
+            }
+          });
+        });
+    Kokkos::Experimental::contribute(bins_.KokkosView(), scatter);
+
+    const auto partial_h = partial.GetHostMirrorAndCopy();
+    for (int b = 0; b < nblocks; ++b) {
+      for (int c = 0; c < ncomp; ++c)
+        Merge(&partial_h((b * ncomp + c) * nhead), &update[c * stride], nhead);
+    }
+  }
+  PARTHENON_REQUIRE_THROWS(!labels_.empty(),
+                           "Statistics output requires blocks on every rank");
+  const int ncomp = labels_.size();
+  const auto bins_h = bins_.GetHostMirrorAndCopy();
+  for (int c = 0; c < ncomp; ++c) {
+    for (int n = 0; n < nbins; ++n)
+      update[c * stride + offset::bins + n] = bins_h(c * nbins + n);
+  }
+
+#ifdef MPI_PARALLEL
+  MPI_Datatype sketch_type;
+  PARTHENON_MPI_CHECK(MPI_Type_contiguous(stride, MPI_PARTHENON_REAL, &sketch_type));
+  PARTHENON_MPI_CHECK(MPI_Type_commit(&sketch_type));
+  MPI_Op merge;
+  PARTHENON_MPI_CHECK(MPI_Op_create(MergeSketches, 1, &merge));
+  PARTHENON_MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, update.data(), ncomp, sketch_type,
+                                    merge, MPI_COMM_WORLD));
+  PARTHENON_MPI_CHECK(MPI_Op_free(&merge));
+  PARTHENON_MPI_CHECK(MPI_Type_free(&sketch_type));
+#endif // MPI_PARALLEL
+
+  if (accumulate_ && !sketches_.empty()) {
+    for (int c = 0; c < ncomp; ++c)
+      Merge(&update[c * stride], &sketches_[c * stride], stride);
+  } else {
+    sketches_ = std::move(update);
+  }
+  // Every rank has the same means to shift the next update by
+  for (int c = 0; c < ncomp; ++c) {
+    const Real mean = GetMoments(&sketches_[c * stride], shift_[c]).mean;
+    Recenter(&sketches_[c * stride], mean - shift_[c]);
+    shift_[c] = mean;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void StatisticsOutput::WriteOutputFile(Mesh *pm)
+//  \brief Appends a line with the statistics of all components to the statistics file
+void StatisticsOutput::WriteOutputFile(Mesh *pm, ParameterInput *pin, SimTime *tm,
+                                       const SignalHandler::OutputSignal signal) {
+  // As history outputs, not written for `output_now` file based outputs
+  if (signal == SignalHandler::OutputSignal::now) return;
+  using namespace StatsUtil;
+  UpdateSketches_(pm);
+
+  if (Globals::my_rank == 0) {
+    const std::string fname =
+        output_params.file_basename + "." + output_params.file_id + ".stats";
+    FILE *pfile = std::fopen(fname.c_str(), "a");
+    PARTHENON_REQUIRE_THROWS(pfile != nullptr,
+                             "Statistics file '" + fname + "' could not be opened");
+
+    const char *columns[] = {"count",  "mean",   "std",    "skew",   "kurt",
+                             "min",    "min_x1", "min_x2", "min_x3", "max",
+                             "max_x1", "max_x2", "max_x3"};
+    if (output_params.file_number == 0) {
+      int iout = 1;
+      std::fprintf(pfile, "#  Statistics%s\n", accumulate_ ? " (accumulated)" : "");
+      std::fprintf(pfile, "# [%d]=time    ", iout++);
+      std::fprintf(pfile, " [%d]=cycle   ", iout++);
+      for (const auto &label : labels_) {
+        for (const auto *column : columns)
+          std::fprintf(pfile, " [%d]=%s_%s", iout++, label.c_str(), column);
+        for (const auto p : percentiles_) {
+          std::stringstream name;
+          name << label << "_p" << p;
+          std::fprintf(pfile, " [%d]=%s", iout++, name.str().c_str());
+        }
+      }
+      std::fprintf(pfile, "\n");
+    }
+
+    const char *fmt = output_params.data_format.c_str();
+    std::fprintf(pfile, fmt, tm != nullptr ? tm->time : 0.0);
+    std::fprintf(pfile, " %12d", tm != nullptr ? tm->ncycle : 0);
+    const int stride = layout_.Stride();
+    for (int c = 0; c < labels_.size(); ++c) {
+      const Real *sketch = &sketches_[c * stride];
+      const auto moments = GetMoments(sketch, shift_[c]);
+      for (const Real value :
+           {sketch[offset::count], moments.mean, moments.stddev, moments.skewness,
+            moments.kurtosis}) {
+        std::fprintf(pfile, fmt, value);
+      }
+      for (int n = offset::min; n < offset::bins; ++n)
+        std::fprintf(pfile, fmt, sketch[n]);
+      for (const auto p : percentiles_)
+        std::fprintf(pfile, fmt, Quantile(sketch, layout_, p / 100.0));
+    }
+    std::fprintf(pfile, "\n");
+    std::fclose(pfile);
+  }
+
+  // advance output parameters
+  output_params.file_number++;
+  output_params.next_time += output_params.dt;
+  pin->SetInteger(output_params.block_name, "file_number", output_params.file_number);
+  pin->SetReal(output_params.block_name, "next_time", output_params.next_time);
+}
+
+} // namespace parthenon
@@ -0,0 +1,153 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef OUTPUTS_STATISTICS_SKETCH_HPP_
+#define OUTPUTS_STATISTICS_SKETCH_HPP_
+//! \file statistics_sketch.hpp
+//  \brief Mergeable sketches of the values of a variable for the statistics output
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "basic_types.hpp"
+#include "kokkos_abstraction.hpp"
+
+namespace parthenon {
+namespace StatsUtil {
+
+// A sketch is a flat array of Reals, so that the sketches of all variables can be merged
+// over ranks with a single reduction. It holds the count and the power sums
+// sum((x - shift)^p) for p = 1, ..., 4 of the values x about a shift, the minimum and
+// the maximum with the coordinates of their cells, and the counts of a logarithmic
+// histogram of the magnitudes with a fixed relative bin width (as in DDSketch), from
+// which quantiles are estimated with the relative accuracy of the bins.
+namespace offset {
+constexpr int count = 0;
+constexpr int sums = 1; // four power sums
+constexpr int min = 5;  // followed by the coordinates
+constexpr int max = 9;  // followed by the coordinates
+constexpr int bins = 13;
+} // namespace offset
+
+struct SketchLayout {
+  // The bins k = 0, ..., nbins - 1 of the magnitudes hold (min_magnitude * gamma^(k-1),
+  // min_magnitude * gamma^k], where the last one also holds all larger magnitudes.
+  // Negative values are counted in the first nbins bins, magnitudes below min_magnitude
+  // in the next one, and positive values in the last nbins bins.
+  int nbins = 0;
+  Real gamma = 1.0, log_gamma = 0.0, min_magnitude = 0.0;
+
+  SketchLayout() = default;
+  SketchLayout(const Real relative_accuracy, const Real min_magnitude,
+               const Real max_magnitude)
+      : gamma((1.0 + relative_accuracy) / (1.0 - relative_accuracy)),
+        log_gamma(std::log(gamma)), min_magnitude(min_magnitude) {
+    nbins = static_cast<int>(std::ceil(std::log(max_magnitude / min_magnitude) /
+                                       log_gamma)) +
+            1;
+  }
+
+  int NumBins() const { return 2 * nbins + 1; }
+  int Stride() const { return offset::bins + NumBins(); }
+
+  KOKKOS_INLINE_FUNCTION int Bin(const Real x) const {
+    const Real magnitude = Kokkos::abs(x);
+    if (!(magnitude >= min_magnitude)) return nbins;
+    const Real level = Kokkos::ceil(Kokkos::log(magnitude / min_magnitude) / log_gamma);
+    const int k = Kokkos::min(nbins - 1, static_cast<int>(level));
+    return x > 0.0 ? nbins + 1 + k : nbins - 1 - k;
+  }
+  // Value with the smallest maximum relative error of all values of the bin
+  Real Value(const int bin) const {
+    if (bin == nbins) return 0.0;
+    const int k = bin > nbins ? bin - nbins - 1 : nbins - 1 - bin;
+    const Real value = min_magnitude * 2.0 * std::pow(gamma, k) / (1.0 + gamma);
+    return bin > nbins ? value : -value;
+  }
+};
+
+// Empty sketch, i.e., the identity of Merge
+inline void Reset(Real *sketch, const int stride) {
+  std::fill(sketch, sketch + stride, 0.0);
+  sketch[offset::min] = std::numeric_limits<Real>::max();
+  sketch[offset::max] = std::numeric_limits<Real>::lowest();
+}
+
+// Merge the sketch in into inout, which have the same layout and shift
+inline void Merge(const Real *in, Real *inout, const int stride) {
+  for (int n = offset::count; n < offset::min; ++n)
+    inout[n] += in[n];
+  if (in[offset::min] < inout[offset::min])
+    std::copy(in + offset::min, in + offset::min + 4, inout + offset::min);
+  if (in[offset::max] > inout[offset::max])
+    std::copy(in + offset::max, in + offset::max + 4, inout + offset::max);
+  for (int n = offset::bins; n < stride; ++n)
+    inout[n] += in[n];
+}
+
+// Change the shift of the power sums by delta
+inline void Recenter(Real *sketch, const Real delta) {
+  const Real n = sketch[offset::count];
+  Real *s = sketch + offset::sums;
+  // sum((x - a - d)^p) = sum_q binomial(p, q) (-d)^(p - q) sum((x - a)^q)
+  const Real d = -delta;
+  const Real s4 = s[3] + 4 * d * s[2] + 6 * d * d * s[1] + 4 * d * d * d * s[0] +
+                  d * d * d * d * n;
+  const Real s3 = s[2] + 3 * d * s[1] + 3 * d * d * s[0] + d * d * d * n;
+  const Real s2 = s[1] + 2 * d * s[0] + d * d * n;
+  const Real s1 = s[0] + d * n;
+  s[0] = s1;
+  s[1] = s2;
+  s[2] = s3;
+  s[3] = s4;
+}
+
+struct Moments {
+  Real mean, stddev, skewness, kurtosis; // of the population, excess kurtosis
+};
+
+inline Moments GetMoments(const Real *sketch, const Real shift) {
+  const Real n = sketch[offset::count];
+  if (n == 0.0) return {0.0, 0.0, 0.0, 0.0};
+  const Real *s = sketch + offset::sums;
+  const Real m1 = s[0] / n, m2 = s[1] / n, m3 = s[2] / n, m4 = s[3] / n;
+  const Real var = std::max<Real>(0.0, m2 - m1 * m1);
+  const Real mu3 = m3 - 3 * m1 * m2 + 2 * m1 * m1 * m1;
+  const Real mu4 = m4 - 4 * m1 * m3 + 6 * m1 * m1 * m2 - 3 * m1 * m1 * m1 * m1;
+  Moments moments{shift + m1, std::sqrt(var), 0.0, 0.0};
+  if (var > 0.0) {
+    moments.skewness = mu3 / (var * std::sqrt(var));
+    moments.kurtosis = mu4 / (var * var) - 3.0;
+  }
+  return moments;
+}
+
+// Estimate of the q-quantile (0 <= q <= 1), limited to the minimum and maximum
+inline Real Quantile(const Real *sketch, const SketchLayout &layout, const Real q) {
+  const Real n = sketch[offset::count];
+  if (n == 0.0) return 0.0;
+  const Real rank = q * (n - 1);
+  const Real *bins = sketch + offset::bins;
+  Real cumulative = 0.0;
+  int bin = 0;
+  for (; bin < layout.NumBins() - 1; ++bin) {
+    cumulative += bins[bin];
+    if (cumulative > rank) break;
+  }
+  return std::min(sketch[offset::max], std::max(sketch[offset::min], layout.Value(bin)));
+}
+
+} // namespace StatsUtil
+} // namespace parthenon
+
+#endif // OUTPUTS_STATISTICS_SKETCH_HPP_
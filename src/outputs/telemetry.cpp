@@ -0,0 +1,211 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+//! \file telemetry.cpp
+//  \brief writes the per-cycle timing and memory breakdown collected by Telemetry
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "parthenon_mpi.hpp"
+
+#include "globals.hpp"
+#include "mesh/mesh.hpp"
+#include "outputs/outputs.hpp"
+#include "utils/error_checking.hpp"
+#include "utils/instrument.hpp"
+#include "utils/telemetry.hpp"
+
+namespace parthenon {
+
+namespace {
+// Every value is reduced as (min, max, sum, rank of the max)
+struct Stats {
+  double min, max, sum, max_rank;
+};
+
+#ifdef MPI_PARALLEL
+void ReduceStats(void *in, void *inout, int *len, MPI_Datatype *) {
+  auto *a = static_cast<Stats *>(in);
+  auto *b = static_cast<Stats *>(inout);
+  for (int i = 0; i < *len; ++i) {
+    b[i].min = std::min(a[i].min, b[i].min);
+    if (a[i].max > b[i].max || (a[i].max == b[i].max && a[i].max_rank < b[i].max_rank)) {
+      b[i].max = a[i].max;
+      b[i].max_rank = a[i].max_rank;
+    }
+    b[i].sum += a[i].sum;
+  }
+}
+#endif // MPI_PARALLEL
+
+void WriteStats(std::FILE *pfile, const Stats &s) {
+  std::fprintf(pfile, "{\"min\": %.6e, \"max\": %.6e, \"avg\": %.6e, \"max_rank\": %d}",
+               s.min, s.max, s.sum / Globals::nranks, static_cast<int>(s.max_rank));
+}
+
+void WriteEscaped(std::FILE *pfile, const std::string &str) {
+  std::fputc('"', pfile);
+  for (const char c : str) {
+    if (c == '"' || c == '\\') std::fputc('\\', pfile);
+    std::fputc(c, pfile);
+  }
+  std::fputc('"', pfile);
+}
+
+// Sums the synchronization counts by call site of every cycle over all ranks on rank 0.
+// The sites differ between ranks, so they are sent as lines "cycle count site".
+std::vector<std::map<std::string, std::int64_t>>
+GatherSyncSites(const std::vector<Telemetry::Cycle> &cycles) {
+  std::stringstream ss;
+  for (std::size_t c = 0; c < cycles.size(); ++c) {
+    for (const auto &[site, n] : cycles[c].sync_sites)
+      ss << c << " " << n << " " << site << "\n";
+  }
+  std::string text = ss.str();
+#ifdef MPI_PARALLEL
+  int nsend = static_cast<int>(text.size());
+  std::vector<int> counts(Globals::nranks), displs(Globals::nranks, 0);
+  PARTHENON_MPI_CHECK(
+      MPI_Gather(&nsend, 1, MPI_INT, counts.data(), 1, MPI_INT, 0, MPI_COMM_WORLD));
+  for (int r = 1; r < Globals::nranks; ++r)
+    displs[r] = displs[r - 1] + counts[r - 1];
+  std::string all(Globals::my_rank == 0 ? displs.back() + counts.back() : 0, ' ');
+  PARTHENON_MPI_CHECK(MPI_Gatherv(text.data(), nsend, MPI_CHAR, all.data(),
+                                  counts.data(), displs.data(), MPI_CHAR, 0,
+                                  MPI_COMM_WORLD));
+  text.swap(all);
+#endif // MPI_PARALLEL
+
+  std::vector<std::map<std::string, std::int64_t>> sites(cycles.size());
+  std::istringstream lines(text);
+  std::size_t c;
+  std::int64_t n;
+  std::string site;
+  while (lines >> c >> n && std::getline(lines >> std::ws, site)) {
+    if (c < sites.size()) sites[c][site] += n;
+  }
+  return sites;
+}
+} // namespace
+
+TelemetryOutput::TelemetryOutput(const OutputParameters &oparams) : OutputType(oparams) {
+  Telemetry::Instance().Enable(true);
+  if (!SyncTracker::Enable(true) && Globals::my_rank == 0) {
+    PARTHENON_WARN("Device synchronizations are not tracked by the telemetry output "
+                   "because a Kokkos Tools library is loaded.");
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void TelemetryOutput::WriteOutputFile()
+//  \brief Reduces the records of all cycles finished since the last output over the
+//  ranks and appends one JSON line per cycle to "file_basename.file_id.telemetry".
+//  All ranks execute the same task regions, so the records line up across ranks.
+
+void TelemetryOutput::WriteOutputFile(Mesh *pm, ParameterInput *pin, SimTime *tm,
+                                      const SignalHandler::OutputSignal signal) {
+  const auto cycles = Telemetry::Instance().TakeCycles();
+
+  std::vector<Stats> stats;
+  for (const auto &cycle : cycles) {
+    auto add = [&](const double val) {
+      stats.push_back({val, val, val, static_cast<double>(Globals::my_rank)});
+    };
+    add(cycle.wall);
+    for (const auto &t : cycle.timers)
+      add(t);
+    add(cycle.memory_hwm);
+    add(static_cast<double>(cycle.syncs));
+    for (const auto &r : cycle.regions)
+      add(r);
+  }
+
+#ifdef MPI_PARALLEL
+  // A single reduction for all values of all cycles
+  MPI_Datatype stats_type;
+  MPI_Op stats_op;
+  PARTHENON_MPI_CHECK(MPI_Type_contiguous(4, MPI_DOUBLE, &stats_type));
+  PARTHENON_MPI_CHECK(MPI_Type_commit(&stats_type));
+  PARTHENON_MPI_CHECK(MPI_Op_create(ReduceStats, true, &stats_op));
+  std::vector<Stats> reduced(stats.size());
+  PARTHENON_MPI_CHECK(MPI_Reduce(stats.data(), reduced.data(), stats.size(), stats_type,
+                                 stats_op, 0, MPI_COMM_WORLD));
+  PARTHENON_MPI_CHECK(MPI_Op_free(&stats_op));
+  PARTHENON_MPI_CHECK(MPI_Type_free(&stats_type));
+  stats.swap(reduced);
+#endif // MPI_PARALLEL
+  const auto sync_sites = GatherSyncSites(cycles);
+
+  if (Globals::my_rank == 0 && !cycles.empty()) {
+    std::string fname = output_params.file_basename + "." + output_params.file_id +
+                        ".telemetry";
+    std::FILE *pfile = std::fopen(fname.c_str(), "a");
+    if (pfile == nullptr) {
+      std::stringstream msg;
+      msg << "### FATAL ERROR in function [TelemetryOutput::WriteOutputFile]"
+          << std::endl
+          << "Output file '" << fname << "' could not be opened";
+      PARTHENON_FAIL(msg);
+    }
+    static const char *timer_names[] = {"wait", "remesh", "load_balance", "output"};
+    static_assert(sizeof(timer_names) / sizeof(timer_names[0]) == Telemetry::ntimers);
+    int n = 0;
+    for (std::size_t c = 0; c < cycles.size(); ++c) {
+      const auto &cycle = cycles[c];
+      std::fprintf(pfile, "{\"cycle\": %d, \"wall\": ", cycle.ncycle);
+      WriteStats(pfile, stats[n++]);
+      for (int t = 0; t < Telemetry::ntimers; ++t) {
+        std::fprintf(pfile, ", \"%s\": ", timer_names[t]);
+        WriteStats(pfile, stats[n++]);
+      }
+      std::fprintf(pfile, ", \"memory_hwm\": ");
+      WriteStats(pfile, stats[n++]);
+      std::fprintf(pfile, ", \"syncs\": ");
+      WriteStats(pfile, stats[n++]);
+      // Sites with the most synchronizations first
+      std::vector<std::pair<std::string, std::int64_t>> sites(sync_sites[c].begin(),
+                                                              sync_sites[c].end());
+      std::stable_sort(sites.begin(), sites.end(),
+                       [](const auto &a, const auto &b) { return a.second > b.second; });
+      std::fprintf(pfile, ", \"sync_sites\": {");
+      for (std::size_t s = 0; s < sites.size(); ++s) {
+        if (s > 0) std::fprintf(pfile, ", ");
+        WriteEscaped(pfile, sites[s].first);
+        std::fprintf(pfile, ": %lld", static_cast<long long>(sites[s].second));
+      }
+      std::fprintf(pfile, "}");
+      std::fprintf(pfile, ", \"regions\": [");
+      for (std::size_t r = 0; r < cycle.regions.size(); ++r) {
+        if (r > 0) std::fprintf(pfile, ", ");
+        WriteStats(pfile, stats[n++]);
+      }
+      std::fprintf(pfile, "]}\n");
+    }
+    std::fclose(pfile);
+  }
+
+  // advance output parameters
+  output_params.file_number++;
+  output_params.next_time += output_params.dt;
+  pin->SetInteger(output_params.block_name, "file_number", output_params.file_number);
+  pin->SetReal(output_params.block_name, "next_time", output_params.next_time);
+}
+
+} // namespace parthenon
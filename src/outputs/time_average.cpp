@@ -0,0 +1,235 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+//! \file time_average.cpp
+//  \brief Running time averages of variables, accumulated for all requested variables in
+//         a single kernel per partition after every step
+
+#include "outputs/time_average.hpp"
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "interface/metadata.hpp"
+#include "interface/packages.hpp"
+#include "interface/state_descriptor.hpp"
+#include "interface/variable_pack.hpp"
+#include "kokkos_abstraction.hpp"
+#include "mesh/mesh.hpp"
+#include "parameter_input.hpp"
+#include "utils/error_checking.hpp"
+#include "utils/instrument.hpp"
+
+namespace parthenon {
+namespace TimeAverage {
+namespace {
+constexpr char package_name[] = "parthenon::time_average";
+
+// The averages requested by one output block
+struct Averages {
+  int block_number;
+  std::vector<std::string> variables;
+  bool squares; // also average the squares of the variables
+  bool reset;   // restart the averages after every output of the block
+};
+
+std::string WeightName(const int block_number) {
+  return "weight_" + std::to_string(block_number);
+}
+
+const Metadata &SourceMetadata(const Packages_t &packages, const std::string &var) {
+  for (const auto &pkg : packages.AllPackages()) {
+    if (pkg.second->FieldPresent(var)) return pkg.second->FieldMetadata(var);
+  }
+  PARTHENON_THROW("Time average of unknown variable " + var + " requested");
+}
+} // namespace
+
+std::string FieldName(const int block_number, const std::string &var,
+                      const bool second_moment) {
+  return "tavg" + std::to_string(block_number) + (second_moment ? "_sq_" : "_") + var;
+}
+
+std::shared_ptr<StateDescriptor> Initialize(ParameterInput *pin,
+                                            const Packages_t &packages) {
+  std::vector<Averages> all_averages;
+  for (InputBlock *pib = pin->pfirst_block; pib != nullptr; pib = pib->pnext) {
+    const std::string &blk = pib->block_name;
+    if (blk.compare(0, 16, "parthenon/output") != 0 ||
+        !pin->DoesParameterExist(blk, "time_averages")) {
+      continue;
+    }
+    // soft-disabled outputs do not need their averages
+    if (pin->DoesParameterExist(blk, "dt") && pin->GetReal(blk, "dt") < 0.0) continue;
+    PARTHENON_REQUIRE_THROWS(pin->GetString(blk, "file_type") == "hdf5",
+                             "Time averages are only written by hdf5 outputs, but " +
+                                 blk + " requests some");
+    Averages averages;
+    averages.block_number = std::atoi(blk.substr(16).c_str());
+    averages.variables = pin->GetVector<std::string>(blk, "time_averages");
+    averages.squares = pin->GetOrAddBoolean(blk, "time_average_squares", false);
+    averages.reset = pin->GetOrAddBoolean(blk, "time_average_reset", true);
+    all_averages.push_back(averages);
+  }
+  if (all_averages.empty()) return nullptr;
+
+  auto pkg = std::make_shared<StateDescriptor>(package_name);
+  for (const auto &averages : all_averages) {
+    for (const auto &var : averages.variables) {
+      const auto &m = SourceMetadata(packages, var);
+      PARTHENON_REQUIRE_THROWS(m.IsSet(Metadata::Cell) && !m.IsSet(Metadata::Sparse),
+                               "Time averages are only supported for dense "
+                               "cell-centered variables, but " +
+                                   var + " is not one");
+      // The averages are moved (and prolongated or restricted) with their blocks and
+      // read back from restarts together with their weights
+      Metadata m_avg({Metadata::Cell, Metadata::Derived, Metadata::OneCopy,
+                      Metadata::Restart, Metadata::ForceRemeshComm},
+                     m.Shape());
+      pkg->AddField(FieldName(averages.block_number, var), m_avg);
+      if (averages.squares) {
+        pkg->AddField(FieldName(averages.block_number, var, true), m_avg);
+      }
+    }
+    // Time covered by the averages
+    pkg->AddParam(WeightName(averages.block_number), Real(0.0),
+                  Params::Mutability::Restart);
+  }
+  pkg->AddParam("averages", all_averages);
+  return pkg;
+}
+
+std::vector<std::string> FieldNames(const Packages_t &packages, const int block_number) {
+  std::vector<std::string> names;
+  if (packages.AllPackages().count(package_name) == 0) return names;
+  const auto &all_averages =
+      packages.Get(package_name)->Param<std::vector<Averages>>("averages");
+  for (const auto &averages : all_averages) {
+    if (averages.block_number != block_number) continue;
+    for (const auto &var : averages.variables) {
+      names.push_back(FieldName(block_number, var));
+      if (averages.squares) names.push_back(FieldName(block_number, var, true));
+    }
+  }
+  return names;
+}
+
+//! \fn void TimeAverage::Accumulate(Mesh *pm, const Real dt)
+//  \brief Updates the running means of all components of all averages with a single
+//  kernel per partition. Ghost zones are included so that the averages can be
+//  prolongated and restricted on remeshes.
+void Accumulate(Mesh *pm, const Real dt) {
+  if (pm->packages.AllPackages().count(package_name) == 0) return;
+  PARTHENON_INSTRUMENT
+  auto *pkg = pm->packages.Get(package_name).get();
+  const auto &all_averages = pkg->Param<std::vector<Averages>>("averages");
+
+  // The weight of the new state in the means, which is one on the first step after a
+  // reset, so that the fields never need to be cleared
+  std::vector<std::string> names;
+  std::vector<Real> block_factor;
+  for (const auto &averages : all_averages) {
+    const Real weight = pkg->Param<Real>(WeightName(averages.block_number)) + dt;
+    block_factor.push_back(weight > 0.0 ? dt / weight : 0.0);
+    pkg->UpdateParam(WeightName(averages.block_number), weight);
+    for (const auto &var : averages.variables) {
+      names.push_back(var);
+      names.push_back(FieldName(averages.block_number, var));
+      if (averages.squares) names.push_back(FieldName(averages.block_number, var, true));
+    }
+  }
+
+  ParArray1D<int> src, dst, dst_sq;
+  ParArray1D<Real> factor;
+  int ncomp = 0;
+  const auto base = pm->mesh_data.GetStageHandle("base");
+  const int npartitions = pm->GetDefaultBlockPartitions().size();
+  for (int ipart = 0; ipart < npartitions; ++ipart) {
+    auto &md = pm->mesh_data.GetOrAdd(base, ipart);
+    PackIndexMap imap;
+    const auto pack = md->PackVariables(names, imap);
+
+    // The components are the same on every partition, so they are set up once
+    if (ncomp == 0) {
+      std::vector<int> src_h, dst_h, dst_sq_h;
+      std::vector<Real> factor_h;
+      for (std::size_t a = 0; a < all_averages.size(); ++a) {
+        const auto &averages = all_averages[a];
+        if (block_factor[a] == 0.0) continue;
+        for (const auto &var : averages.variables) {
+          const auto &[lo, hi] = imap.get(var);
+          const int avg = imap.get(FieldName(averages.block_number, var)).first;
+          const int avg_sq =
+              averages.squares
+                  ? imap.get(FieldName(averages.block_number, var, true)).first
+                  : -1;
+          for (int v = 0; v <= hi - lo; ++v) {
+            src_h.push_back(lo + v);
+            dst_h.push_back(avg + v);
+            dst_sq_h.push_back(averages.squares ? avg_sq + v : -1);
+            factor_h.push_back(block_factor[a]);
+          }
+        }
+      }
+      ncomp = src_h.size();
+      if (ncomp == 0) return;
+      src = ParArray1D<int>("TimeAverage::src", ncomp);
+      dst = ParArray1D<int>("TimeAverage::dst", ncomp);
+      dst_sq = ParArray1D<int>("TimeAverage::dst_sq", ncomp);
+      factor = ParArray1D<Real>("TimeAverage::factor", ncomp);
+      auto src_m = src.GetHostMirror();
+      auto dst_m = dst.GetHostMirror();
+      auto dst_sq_m = dst_sq.GetHostMirror();
+      auto factor_m = factor.GetHostMirror();
+      for (int c = 0; c < ncomp; ++c) {
+        src_m(c) = src_h[c];
+        dst_m(c) = dst_h[c];
+        dst_sq_m(c) = dst_sq_h[c];
+        factor_m(c) = factor_h[c];
+      }
+      src.DeepCopy(src_m);
+      dst.DeepCopy(dst_m);
+      dst_sq.DeepCopy(dst_sq_m);
+      factor.DeepCopy(factor_m);
+    }
+
+    const auto ib = md->GetBoundsI(IndexDomain::entire);
+    const auto jb = md->GetBoundsJ(IndexDomain::entire);
+    const auto kb = md->GetBoundsK(IndexDomain::entire);
+    parthenon::par_for(
+        DEFAULT_LOOP_PATTERN, "TimeAverage::Accumulate", DevExecSpace(), 0,
+        pack.GetDim(5) - 1, 0, ncomp - 1, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+        KOKKOS_LAMBDA(const int b, const int c, const int k, const int j, const int i) {
+          const Real q = pack(b, src(c), k, j, i);
+          const Real f = factor(c);
+          pack(b, dst(c), k, j, i) += f * (q - pack(b, dst(c), k, j, i));
+          if (dst_sq(c) >= 0) {
+            pack(b, dst_sq(c), k, j, i) += f * (q * q - pack(b, dst_sq(c), k, j, i));
+          }
+        });
+  }
+}
+
+void Reset(Mesh *pm, const int block_number) {
+  if (pm->packages.AllPackages().count(package_name) == 0) return;
+  auto *pkg = pm->packages.Get(package_name).get();
+  for (const auto &averages : pkg->Param<std::vector<Averages>>("averages")) {
+    if (averages.block_number == block_number && averages.reset) {
+      pkg->UpdateParam(WeightName(block_number), Real(0.0));
+    }
+  }
+}
+
+} // namespace TimeAverage
+} // namespace parthenon
@@ -0,0 +1,58 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef OUTPUTS_TIME_AVERAGE_HPP_
+#define OUTPUTS_TIME_AVERAGE_HPP_
+//! \file time_average.hpp
+//  \brief Running time averages of variables requested by HDF5 output blocks
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "basic_types.hpp"
+
+namespace parthenon {
+
+class Mesh;
+class Packages_t;
+class ParameterInput;
+class StateDescriptor;
+
+namespace TimeAverage {
+// HDF5 output blocks can list cell-centered variables with time_averages. Their time
+// averages (and optionally the averages of their squares) over the steps since the
+// start or since the previous output of the block are kept in derived fields that are
+// only allocated when requested, updated for all of them at once after every step, and
+// written by the block like any other variable.
+
+// Name of the field with the average of var (or of its square) of output block
+std::string FieldName(int block_number, const std::string &var,
+                      bool second_moment = false);
+
+// Returns the package with the fields of all requested averages, or nullptr if no
+// output block requests any
+std::shared_ptr<StateDescriptor> Initialize(ParameterInput *pin,
+                                            const Packages_t &packages);
+
+// Names of the fields an output block has to write, empty if it requests no averages
+std::vector<std::string> FieldNames(const Packages_t &packages, int block_number);
+
+// Adds the state at the end of a step of length dt to all averages
+void Accumulate(Mesh *pm, Real dt);
+
+// Restarts the averages of an output block that resets them after it was written
+void Reset(Mesh *pm, int block_number);
+} // namespace TimeAverage
+} // namespace parthenon
+
+#endif // OUTPUTS_TIME_AVERAGE_HPP_
@@ -1,9 +1,9 @@
 //========================================================================================
-// Athena++ astrophysical MHD code
-// Copyright(C) 2014 James M. Stone <jmstone@princeton.edu> and other code contributors
+// Parthenon performance portable AMR framework
+// Copyright(C) 2024 The Parthenon collaboration
 // Licensed under the 3-clause BSD License, see LICENSE file for details
 //========================================================================================
-// (C) (or copyright) 2020-2021. Triad National Security, LLC. All rights reserved.
+// (C) (or copyright) 2020-2024. Triad National Security, LLC. All rights reserved.
 //
 // This program was produced under U.S. Government contract 89233218CNA000001 for Los
 // Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
@@ -15,226 +15,268 @@
 // the public, perform publicly and display publicly, and to permit others to do so.
 //========================================================================================
 //! \file vtk.cpp
-//  \brief writes output data in (legacy) vtk format.
-//  Data is written in RECTILINEAR_GRID geometry, in BINARY format, and in FLOAT type
-//  Writes one file per MeshBlock.
+//  \brief writes output data in the VTKHDF format as an overlapping AMR data set.
+//  All ranks write a single file collectively with parallel HDF5, which ParaView (5.12
+//  or newer) reads natively without an XDMF file.
 
-#include <algorithm>
-#include <cstdio>
-#include <cstdlib>
+// options for building
+#include "config.hpp"
+#include "globals.hpp"
+#include "utils/error_checking.hpp"
+
+// Only proceed if HDF5 output enabled
+#ifdef ENABLE_HDF5
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
 #include <iomanip>
-#include <iostream>
+#include <memory>
 #include <sstream>
-#include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 #include "coordinates/coordinates.hpp"
 #include "defs.hpp"
+#include "interface/metadata.hpp"
 #include "mesh/mesh.hpp"
 #include "mesh/meshblock.hpp"
+#include "outputs/async_writer.hpp"
+#include "outputs/output_utils.hpp"
 #include "outputs/outputs.hpp"
-#include "parthenon_arrays.hpp"
-#include "utils/error_checking.hpp"
+#include "outputs/parthenon_hdf5.hpp"
 
 namespace parthenon {
 
-//----------------------------------------------------------------------------------------
-// Functions to detect big endian machine, and to byte-swap 32-bit words.  The vtk
-// legacy format requires data to be stored as big-endian.
-
-int IsBigEndian() {
-  std::int32_t n = 1;
-  // careful! although int -> char * -> int round-trip conversion is safe,
-  // an arbitrary char* may not be converted to int*
-  char *ep = reinterpret_cast<char *>(&n);
-  return (*ep == 0); // Returns 1 (true) on a big endian machine
+namespace {
+// VTK only reads strings of a fixed length, while HDF5WriteAttribute writes variable
+// length strings
+void WriteFixedStringAttribute(const std::string &name, const std::string &value,
+                               hid_t location) {
+  using namespace HDF5;
+  const H5T type = H5T::FromHIDCheck(H5Tcopy(H5T_C_S1));
+  PARTHENON_HDF5_CHECK(H5Tset_size(type, value.size()));
+  PARTHENON_HDF5_CHECK(H5Tset_strpad(type, H5T_STR_NULLPAD));
+  const H5S space = H5S::FromHIDCheck(H5Screate(H5S_SCALAR));
+  const H5A attr = H5A::FromHIDCheck(
+      H5Acreate(location, name.c_str(), type, space, H5P_DEFAULT, H5P_DEFAULT));
+  PARTHENON_HDF5_CHECK(H5Awrite(attr, type, value.c_str()));
 }
-
-// namespace {
-// inline void Swap4Bytes(void *vdat) {
-//   char tmp, *dat = static_cast<char *>(vdat);
-//   tmp = dat[0];
-//   dat[0] = dat[3];
-//   dat[3] = tmp;
-//   tmp = dat[1];
-//   dat[1] = dat[2];
-//   dat[2] = tmp;
-// }
-// } // namespace
+} // namespace
 
 //----------------------------------------------------------------------------------------
-//! \fn void VTKOutput:::WriteOutputFile(Mesh *pm)
-//  \brief Cycles over all MeshBlocks and writes OutputData in (legacy) vtk format, one
-//         MeshBlock per file
-
-void VTKOutput::WriteContainer(SimTime &tm, Mesh *pm, ParameterInput *pin, bool flag) {
-  throw std::runtime_error(std::string(__func__) + " is not implemented");
-  /*
-  int big_end = IsBigEndian(); // =1 on big endian machine
-
-  // Loop over MeshBlocks
-  for (auto &pmb : pm->block_list) {
-    // set start/end array indices depending on whether ghost zones are included
-    IndexDomain domain = IndexDomain::interior;
-    if (output_params.include_ghost_zones) {
-      domain = IndexDomain::entire;
-    }
-    // build doubly linked list of OutputData nodes (setting data ptrs to appropriate
-    // quantity on MeshBlock for each node), then slice/sum as needed
-    // create filename: "file_basename"+ "."+"blockid"+"."+"file_id"+"."+XXXXX+".vtk",
-    // where XXXXX = 5-digit file_number
-    std::string fname;
-    char number[6];
-    std::snprintf(number, sizeof(number), "%05d", output_params.file_number);
-    char blockid[12];
-    std::snprintf(blockid, sizeof(blockid), "block%d", pmb->gid);
-
-    fname.assign(output_params.file_basename);
-    fname.append(".N.");
-    fname.append(blockid);
-    fname.append(".");
-    fname.append(output_params.file_id);
-    fname.append(".");
-    fname.append(number);
-    fname.append(".vtk");
-
-    // open file for output
-    FILE *pfile;
-    std::stringstream msg;
-    if ((pfile = std::fopen(fname.c_str(), "w")) == nullptr) {
-      msg << "### FATAL ERROR in function [VTKOutput::WriteOutputFile]" << std::endl
-          << "Output file '" << fname << "' could not be opened" << std::endl;
-      PARTHENON_FAIL(msg);
-    }
+//! \fn void VTKOutput:::WriteOutputFile(Mesh *pm, ParameterInput *pin, SimTime *tm,
+//                                         const SignalHandler::OutputSignal signal)
+//  \brief Writes the interior of all blocks as an overlapping AMR data set in VTKHDF
+//         format. Every level is a group with the index boxes of its blocks ("AMRBox")
+//         and one dataset per component of the cell-centered output variables, in which
+//         the blocks of a level are stored in the order of the ranks.
+void VTKOutput::WriteOutputFile(Mesh *pm, ParameterInput *pin, SimTime *tm,
+                                const SignalHandler::OutputSignal signal) {
+  using namespace HDF5;
+  using namespace OutputUtils;
+  // The boxes of the blocks are in the index space of a uniform grid on every level
+  PARTHENON_REQUIRE_THROWS((std::is_same<Coordinates_t, UniformCartesian>::value),
+                           "VTKHDF output requires uniform Cartesian coordinates");
+  PARTHENON_REQUIRE_THROWS(!output_params.include_ghost_zones,
+                           "VTKHDF output can't include ghost zones");
+  // The HDF5 library must not be used while a previous output is still being written
+  AsyncWriter::Instance().Wait();
+  Kokkos::Profiling::pushRegion("VTKHDF::WriteOutputFile");
 
-    // There are five basic parts to the VTK "legacy" file format.
-    //  1. Write file version and identifier
-    std::fprintf(pfile, "# vtk DataFile Version 2.0\n");
-
-    //  2. Header
-    std::fprintf(pfile, "# Athena++ data at time=%e", tm.time);
-    std::fprintf(pfile, "  cycle=%d", tm.ncycle);
-    std::fprintf(pfile, "  variables=%s \n", output_params.variable.c_str());
-
-    //  3. File format
-    std::fprintf(pfile, "BINARY\n");
-
-    //  4. Dataset structure
-    int ncells1 = pmb->cellbounds.ncellsi(domain);
-    int ncells2 = pmb->cellbounds.ncellsj(domain);
-    int ncells3 = pmb->cellbounds.ncellsk(domain);
-    int ncoord1 = ncells1;
-    if (ncells1 > 1) ncoord1++;
-    int ncoord2 = ncells2;
-    if (ncells2 > 1) ncoord2++;
-    int ncoord3 = ncells3;
-    if (ncells3 > 1) ncoord3++;
-
-    float *data;
-    int ndata = std::max(ncoord1, ncoord2);
-    ndata = std::max(ndata, ncoord3);
-    data = new float[3 * ndata + 1];
-
-    // Specify the type of data, dimensions, and coordinates.  If N>1, then write N+1
-    // cell faces as binary floats.  If N=1, then write 1 cell center position.
-    std::fprintf(pfile, "DATASET RECTILINEAR_GRID\n");
-    std::fprintf(pfile, "DIMENSIONS %d %d %d\n", ncoord1, ncoord2, ncoord3);
-
-    IndexRange out_ib = pmb->cellbounds.GetBoundsI(domain);
-    IndexRange out_jb = pmb->cellbounds.GetBoundsJ(domain);
-    IndexRange out_kb = pmb->cellbounds.GetBoundsK(domain);
-    // write x1-coordinates as binary float in big endian order
-    std::fprintf(pfile, "X_COORDINATES %d float\n", ncoord1);
-    if (ncells1 == 1) {
-      data[0] = static_cast<float>(pmb->coords.Xc<1>(out_ib.s));
-    } else {
-      for (int i = out_ib.s; i <= out_ib.e + 1; ++i) {
-        data[i - out_ib.s] = static_cast<float>(pmb->coords.Xf<1>(i));
-      }
-    }
-    if (!big_end) {
-      for (int i = 0; i < ncoord1; ++i)
-        Swap4Bytes(&data[i]);
+  const std::string filename = GenerateFilename_(pin, tm, signal);
+  H5P acc_file = H5P::FromHIDCheck(GenerateFileAccessProps());
+  H5F file;
+  try {
+    file = H5F::FromHIDCheck(
+        H5Fcreate(filename.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, acc_file));
+  } catch (std::exception &ex) {
+    std::stringstream err;
+    err << "### ERROR: Failed to create VTKHDF output file '" << filename
+        << "' with the following error:" << std::endl
+        << ex.what() << std::endl;
+    PARTHENON_THROW(err)
+  }
+  H5P pl_xfer = H5P::FromHIDCheck(H5Pcreate(H5P_DATASET_XFER));
+#ifdef MPI_PARALLEL
+  PARTHENON_HDF5_CHECK(H5Pset_dxpl_mpio(pl_xfer, H5FD_MPIO_COLLECTIVE));
+#endif
+
+  const auto &mesh_size = pm->mesh_size;
+  const std::array<Real, 3> origin{mesh_size.xmin(X1DIR), mesh_size.xmin(X2DIR),
+                                   mesh_size.xmin(X3DIR)};
+  const H5G root = MakeGroup(file, "/VTKHDF");
+  HDF5WriteAttribute("Version", std::vector<int>{2, 0}, root);
+  WriteFixedStringAttribute("Type", "OverlappingAMR", root);
+  HDF5WriteAttribute("Origin", std::vector<Real>(origin.begin(), origin.end()), root);
+  if (tm != nullptr) {
+    HDF5WriteAttribute("Time", tm->time, root);
+    HDF5WriteAttribute("NCycle", tm->ncycle, root);
+  }
+
+  auto const &first_block = *(pm->block_list.front());
+  const IndexDomain interior = IndexDomain::interior;
+  auto get_vars = [&](const std::shared_ptr<MeshBlock> &pmb) {
+    const auto &var_vec = pmb->meshblock_data.Get()->GetVariableVector();
+    VariableVector<Real> out;
+    for (const auto &v : GetAnyVariables(var_vec, output_params.variables)) {
+      if (v->IsSet(Metadata::Cell)) out.push_back(v);
     }
-    std::fwrite(data, sizeof(float), static_cast<std::size_t>(ncoord1), pfile);
-
-    // write x2-coordinates as binary float in big endian order
-    std::fprintf(pfile, "\nY_COORDINATES %d float\n", ncoord2);
-    if (ncells2 == 1) {
-      data[0] = static_cast<float>(pmb->coords.Xc<2>(out_jb.s));
-    } else {
-      for (int j = out_jb.s; j <= out_jb.e + 1; ++j) {
-        data[j - out_jb.s] = static_cast<float>(pmb->coords.Xf<2>(j));
-      }
+    return out;
+  };
+  const auto all_vars_info = VarInfo::GetAll(get_vars(pm->block_list.front()),
+                                             first_block.cellbounds,
+                                             first_block.f_cellbounds);
+  const int nx1 = first_block.cellbounds.ncellsi(interior);
+  const int nx2 = first_block.cellbounds.ncellsj(interior);
+  const int nx3 = first_block.cellbounds.ncellsk(interior);
+  const hsize_t block_cells = nx1 * nx2 * nx3;
+  const std::array<int, 3> mesh_nx{mesh_size.nx(X1DIR), mesh_size.nx(X2DIR),
+                                   mesh_size.nx(X3DIR)};
+
+  // Levels are relative to the coarsest possible level, which is the root grid unless
+  // blocks can be derefined below it, and every rank writes the levels up to the
+  // finest one of the mesh, even if it has no blocks on some of them
+  const int nlevels = pm->GetCurrentLevel() - pm->GetMinLevel() + 1;
+  const int nbelow_root = pm->GetRootLevel() - pm->GetMinLevel();
+  for (int level = 0; level < nlevels; ++level) {
+    std::vector<std::shared_ptr<MeshBlock>> blocks;
+    std::vector<VariableVector<Real>> block_vars;
+    for (const auto &pmb : pm->block_list) {
+      if (pmb->loc.level() - pm->GetMinLevel() != level) continue;
+      blocks.push_back(pmb);
+      block_vars.push_back(get_vars(pmb));
     }
-    if (!big_end) {
-      for (int i = 0; i < ncoord2; ++i)
-        Swap4Bytes(&data[i]);
+    std::size_t nblocks_level;
+    const hsize_t offset = MPIPrefixSum(blocks.size(), nblocks_level);
+    const hsize_t count = blocks.size();
+    const hsize_t total = nblocks_level;
+
+    const H5G level_group = MakeGroup(root, "Level" + std::to_string(level));
+    std::vector<Real> spacing(3);
+    for (int d = 0; d < 3; ++d) {
+      const auto dir = static_cast<CoordinateDirection>(d + 1);
+      const Real nx = std::ldexp(static_cast<Real>(mesh_nx[d]),
+                                 (d < pm->ndim) ? level - nbelow_root : 0);
+      spacing[d] = (mesh_size.xmax(dir) - mesh_size.xmin(dir)) / nx;
     }
-    std::fwrite(data, sizeof(float), static_cast<std::size_t>(ncoord2), pfile);
-
-    // write x3-coordinates as binary float in big endian order
-    std::fprintf(pfile, "\nZ_COORDINATES %d float\n", ncoord3);
-    if (ncells3 == 1) {
-      data[0] = static_cast<float>(pmb->coords.Xc<3>(out_kb.s));
-    } else {
-      for (int k = out_kb.s; k <= out_kb.e + 1; ++k) {
-        data[k - out_kb.s] = static_cast<float>(pmb->coords.Xf<3>(k));
+    HDF5WriteAttribute("Spacing", spacing, level_group);
+
+    // index boxes (imin, imax, jmin, jmax, kmin, kmax) of the cells of the blocks
+    std::vector<int> boxes(6 * count);
+    const std::array<int, 3> nx{nx1, nx2, nx3};
+    for (hsize_t b = 0; b < count; ++b) {
+      for (int d = 0; d < 3; ++d) {
+        const auto dir = static_cast<CoordinateDirection>(d + 1);
+        const int start = static_cast<int>(
+            std::lround((blocks[b]->block_size.xmin(dir) - origin[d]) / spacing[d]));
+        boxes[6 * b + 2 * d] = start;
+        boxes[6 * b + 2 * d + 1] = start + nx[d] - 1;
       }
     }
-    if (!big_end) {
-      for (int i = 0; i < ncoord3; ++i)
-        Swap4Bytes(&data[i]);
-    }
-    std::fwrite(data, sizeof(float), static_cast<std::size_t>(ncoord3), pfile);
-
-    //  5. Data.  An arbitrary number of scalars and vectors can be written (every node
-    //  in the OutputData doubly linked lists), all in binary floats format
-
-    std::fprintf(pfile, "\nCELL_DATA %d", pmb->cellbounds.GetTotal(domain));
-    // reset container iterator to point to current block data
-    auto ci =
-        MeshBlockDataIterator<Real>(pmb->meshblock_data.Get(), {Metadata::Graphics});
-    for (auto &v : ci.vars) {
-      if (!data) {
-        std::cout << "____________________SKIPPPING:" << v->label() << std::endl;
-        continue;
-      }
-      std::fprintf(pfile, "\nLOOKUP_TABLE default\n");
-      for (int k = out_kb.s; k <= out_kb.e; k++) {
-        for (int j = out_jb.s; j <= out_jb.e; j++) {
-          int index = 0;
-          for (int i = out_ib.s; i <= out_ib.e; i++, index++) {
-            data[(i - out_ib.s) + index] = (*v)(k, j, i);
-          }
-
-          // write data in big endian order
-          if (!big_end) {
-            for (int i = 0; i < (ncells1); ++i)
-              Swap4Bytes(&data[i]);
-          }
-          std::fwrite(data, sizeof(float), static_cast<std::size_t>(ncells1), pfile);
+    const hsize_t box_offset[2] = {offset, 0};
+    const hsize_t box_count[2] = {count, 6};
+    const hsize_t box_total[2] = {total, 6};
+    HDF5Write2D(level_group, "AMRBox", boxes.data(), box_offset, box_count, box_total,
+                pl_xfer);
+
+    const H5G cell_data = MakeGroup(level_group, "CellData");
+    const H5G point_data = MakeGroup(level_group, "PointData");
+    const H5G field_data = MakeGroup(level_group, "FieldData");
+
+    // Every component is a dataset of its own, in which the cells of a block are in
+    // the order of the data of the variable (x fastest) as VTK expects them
+    const hsize_t data_offset = offset * block_cells;
+    const hsize_t data_count = count * block_cells;
+    const hsize_t data_total = total * block_cells;
+    for (const auto &vinfo : all_vars_info) {
+      const int ncomp = vinfo.component_labels.size();
+      std::vector<std::vector<Real>> tmp_data(ncomp, std::vector<Real>(data_count, 0));
+      for (hsize_t b = 0; b < count; ++b) {
+        for (const auto &var : block_vars[b]) {
+          if (var->label() != vinfo.label || !var->IsAllocated()) continue;
+          auto v_h = var->data.GetHostMirrorAndCopy();
+          hsize_t index = 0;
+          PackOrUnpackVar(vinfo, false, index,
+                          [&](auto index, int topo, int t, int u, int v, int k, int j,
+                              int i) {
+                            tmp_data[index / block_cells][b * block_cells +
+                                                          index % block_cells] =
+                                v_h(topo, t, u, v, k, j, i);
+                          });
+          break;
         }
       }
+      for (int c = 0; c < ncomp; ++c) {
+        HDF5Write1D(cell_data, vinfo.component_labels[c], tmp_data[c].data(),
+                    &data_offset, &data_count, &data_total, pl_xfer);
+      }
     }
+  }
 
-    // don't forget to close the output file and clean up ptrs to data in OutputData
-    std::fclose(pfile);
-    delete[] data;
-  } // end loop over MeshBlocks
+  // close everything in the file before the file itself
+  root.Reset();
+  file.Reset();
+  if (Globals::my_rank == 0 && tm != nullptr) WriteSeries_(filename, tm->time);
+  Kokkos::Profiling::popRegion(); // VTKHDF::WriteOutputFile
+}
 
-  // increment counters
-  output_params.file_number++;
-  output_params.next_time += output_params.dt;
-  pin->SetInteger(output_params.block_name, "file_number", output_params.file_number);
-  pin->SetReal(output_params.block_name, "next_time", output_params.next_time);
+std::string VTKOutput::GenerateFilename_(ParameterInput *pin, SimTime *tm,
+                                         const SignalHandler::OutputSignal signal) {
+  auto filename = std::string(output_params.file_basename);
+  filename.append(".");
+  filename.append(output_params.file_id);
+  filename.append(".");
+  if (signal == SignalHandler::OutputSignal::now) {
+    filename.append("now");
+  } else if (signal == SignalHandler::OutputSignal::final &&
+             output_params.file_label_final) {
+    filename.append("final");
+    // default time based data dump
+  } else {
+    std::stringstream file_number;
+    file_number << std::setw(output_params.file_number_width) << std::setfill('0')
+                << output_params.file_number;
+    filename.append(file_number.str());
+  }
+  filename.append(".vtkhdf");
 
-  return;
-  */
+  if (signal == SignalHandler::OutputSignal::none) {
+    output_params.file_number++;
+    output_params.next_time += output_params.dt;
+    pin->SetInteger(output_params.block_name, "file_number", output_params.file_number);
+    pin->SetReal(output_params.block_name, "next_time", output_params.next_time);
+  }
+  return filename;
 }
-void VTKOutput::WriteOutputFile(Mesh *pm, ParameterInput *pin, SimTime *tm,
-                                const SignalHandler::OutputSignal signal) {
-  throw std::runtime_error(std::string(__func__) + " is not implemented");
+
+// ParaView reads a time series of files from a JSON file with the extension ".series"
+// next to the files. It is rewritten after every output and only lists the files written
+// (or rewritten) by this run.
+void VTKOutput::WriteSeries_(const std::string &filename, const Real time) {
+  const std::string name = filename.substr(filename.find_last_of('/') + 1);
+  bool found = false;
+  for (auto &[file, t] : series_) {
+    if (file == name) {
+      t = time;
+      found = true;
+    }
+  }
+  if (!found) series_.emplace_back(name, time);
+
+  std::ofstream out(output_params.file_basename + "." + output_params.file_id +
+                    ".vtkhdf.series");
+  out << std::setprecision(17) << "{\n  \"file-series-version\" : \"1.0\",\n"
+      << "  \"files\" : [\n";
+  for (std::size_t n = 0; n < series_.size(); ++n) {
+    out << "    { \"name\" : \"" << series_[n].first << "\", \"time\" : "
+        << series_[n].second << " }" << (n + 1 < series_.size() ? "," : "") << "\n";
+  }
+  out << "  ]\n}\n";
 }
 
 } // namespace parthenon
+
+#endif // ifdef ENABLE_HDF5
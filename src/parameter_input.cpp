@@ -50,6 +50,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <cstdlib>
 #include <fstream>
 #include <iomanip>
@@ -71,10 +72,7 @@ ParameterInput::ParameterInput() : pfirst_block{}, last_filename_{} {}
 
 ParameterInput::ParameterInput(std::string input_filename)
     : pfirst_block{}, last_filename_{} {
-  IOWrapper infile;
-  infile.Open(input_filename.c_str(), IOWrapper::FileMode::read);
-  LoadFromFile(infile);
-  infile.Close();
+  LoadFromFile(input_filename);
 }
 
 // ParameterInput destructor- iterates through nested singly linked lists of blocks/lines
@@ -254,6 +252,41 @@ void ParameterInput::LoadFromFile(IOWrapper &input) {
   return;
 }
 
+//----------------------------------------------------------------------------------------
+//! \fn  void ParameterInput::LoadFromFile(const std::string &filename)
+//  \brief Read the parameters from an input file, which only rank 0 opens and reads as
+//         a whole. Its contents are broadcast at once, so that large jobs don't have
+//         every rank open the file at the same time, and parsed on every rank.
+
+void ParameterInput::LoadFromFile(const std::string &filename) {
+  std::string contents;
+  int found = 1;
+  if (Globals::my_rank == 0) {
+    std::ifstream file(filename, std::ios::binary);
+    found = static_cast<bool>(file);
+    if (found) {
+      std::ostringstream ss;
+      ss << file.rdbuf();
+      contents = ss.str();
+    }
+  }
+#ifdef MPI_PARALLEL
+  std::uint64_t size = contents.size();
+  PARTHENON_MPI_CHECK(MPI_Bcast(&found, 1, MPI_INT, 0, MPI_COMM_WORLD));
+  PARTHENON_MPI_CHECK(MPI_Bcast(&size, 1, MPI_UINT64_T, 0, MPI_COMM_WORLD));
+  contents.resize(size);
+  PARTHENON_MPI_CHECK(MPI_Bcast(contents.data(), size, MPI_CHAR, 0, MPI_COMM_WORLD));
+#endif
+  if (!found) {
+    std::stringstream msg;
+    msg << "### FATAL ERROR in function [ParameterInput::LoadFromFile]" << std::endl
+        << "Input file '" << filename << "' could not be opened" << std::endl;
+    PARTHENON_FAIL(msg);
+  }
+  std::istringstream is(contents);
+  LoadFromStream(is);
+}
+
 //----------------------------------------------------------------------------------------
 //! \fn InputBlock* ParameterInput::FindOrAddBlock(const std::string & name)
 //  \brief find or add specified InputBlock.  Returns pointer to block.
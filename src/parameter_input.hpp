@@ -87,6 +87,7 @@ class ParameterInput {
   // functions
   void LoadFromStream(std::istream &is);
   void LoadFromFile(IOWrapper &input);
+  void LoadFromFile(const std::string &filename);
   void ModifyFromCmdline(int argc, char *argv[]);
   void ParameterDump(std::ostream &os);
   int DoesParameterExist(const std::string &block, const std::string &name);
@@ -46,6 +46,8 @@ using ::parthenon::BlockList_t;
 using ::parthenon::Driver;
 using ::parthenon::DriverStatus;
 using ::parthenon::EvolutionDriver;
+using ::parthenon::ImexDriver;
+using ::parthenon::ImexIntegrator;
 using ::parthenon::Mesh;
 using ::parthenon::MeshBlock;
 using ::parthenon::MeshBlockPack;
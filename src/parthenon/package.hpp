@@ -25,6 +25,8 @@
 #include <interface/sparse_pack.hpp>
 #include <interface/sparse_pool.hpp>
 #include <interface/state_descriptor.hpp>
+#include <interface/swarm_deposition.hpp>
+#include <interface/swarm_interpolation.hpp>
 #include <interface/swarm_pack.hpp>
 #include <interface/variable_pack.hpp>
 #include <kokkos_abstraction.hpp>
@@ -35,6 +37,7 @@
 #include <parthenon_manager.hpp>
 #include <utils/index_split.hpp>
 #include <utils/partition_stl_containers.hpp>
+#include <utils/random.hpp>
 
 // Local Includes
 #include "prelude.hpp"
@@ -47,6 +50,8 @@ using namespace ::parthenon::prelude;
 using ::parthenon::AmrTag;
 using ::parthenon::ApplicationInput;
 using ::parthenon::BlockList_t;
+using ::parthenon::DepositionShape;
+using ::parthenon::DepositionShapeFromString;
 using ::parthenon::DevExecSpace;
 using ::parthenon::HostExecSpace;
 using ::parthenon::IndexSplit;
@@ -60,11 +65,13 @@ using ::parthenon::PackIndexMap;
 using ::parthenon::par_for;
 using ::parthenon::ParameterInput;
 using ::parthenon::Params;
+using ::parthenon::RandomStreams;
 using ::parthenon::SparsePack;
 using ::parthenon::SparsePool;
 using ::parthenon::StateDescriptor;
 using ::parthenon::SwarmPack;
 using ::parthenon::TaskStatus;
+using ::parthenon::TimestepCriterion;
 using ::parthenon::VariableFluxPack;
 using ::parthenon::VariablePack;
 using ::parthenon::X1DIR;
@@ -18,9 +18,13 @@
 #include "parthenon_manager.hpp"
 
 #include <algorithm>
+#include <cctype>
 #include <exception>
+#include <iostream>
+#include <sstream>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -32,16 +36,74 @@
 #include "globals.hpp"
 #include "mesh/domain.hpp"
 #include "mesh/meshblock.hpp"
+#include "outputs/async_writer.hpp"
 #include "outputs/output_utils.hpp"
 #include "outputs/restart.hpp"
 #include "outputs/restart_hdf5.hpp"
+#include "outputs/time_average.hpp"
 #include "utils/error_checking.hpp"
+#include "utils/loop_autotune.hpp"
 #include "utils/utils.hpp"
 
 namespace fs = FS_NAMESPACE;
 
 namespace parthenon {
 
+namespace {
+// Restart outputs with a fast tier (see fast_dir) only write every fast_flush_every-th
+// restart file to the regular location and all others to fast_dir, so there may be a
+// newer restart file of the same output in fast_dir than the one we restart from.
+// Returns the newest one, as chosen by rank 0.
+std::string NewestRestartFile(const std::string &filename, ParameterInput *pin) {
+  std::string newest = filename;
+  if (Globals::my_rank == 0) {
+    // restart file names are <problem_id>.<id>.<file_number>.rhdf
+    const auto stem = fs::path(filename).stem().string();
+    const auto dot = stem.find_last_of('.');
+    const auto number = stem.substr(dot == std::string::npos ? 0 : dot + 1);
+    const bool numbered = dot != std::string::npos && !number.empty() &&
+                          std::all_of(number.begin(), number.end(), ::isdigit);
+    for (InputBlock *pib = pin->pfirst_block; numbered && pib != nullptr;
+         pib = pib->pnext) {
+      const auto &block = pib->block_name;
+      if (block.compare(0, 16, "parthenon/output") != 0) continue;
+      const auto id = pin->DoesParameterExist(block, "id")
+                          ? pin->GetString(block, "id")
+                          : "out" + block.substr(16);
+      const auto prefix = stem.substr(0, dot + 1);
+      if (!pin->DoesParameterExist(block, "fast_dir") ||
+          prefix.size() < id.size() + 1 ||
+          prefix.compare(prefix.size() - id.size() - 1, id.size(), id) != 0) {
+        continue;
+      }
+      const fs::path fast_dir = pin->GetString(block, "fast_dir");
+      if (!fs::is_directory(fast_dir)) continue;
+      // files are only renamed to their final name once they are complete
+      auto newest_number = std::stoll(number);
+      for (const auto &entry : fs::directory_iterator(fast_dir)) {
+        const auto &path = entry.path();
+        const auto candidate = path.stem().string();
+        if (path.extension() != ".rhdf" || candidate.compare(0, prefix.size(), prefix))
+          continue;
+        const auto n = candidate.substr(prefix.size());
+        if (n.empty() || !std::all_of(n.begin(), n.end(), ::isdigit)) continue;
+        if (std::stoll(n) > newest_number) {
+          newest_number = std::stoll(n);
+          newest = path.string();
+        }
+      }
+    }
+  }
+#ifdef MPI_PARALLEL
+  int size = newest.size();
+  PARTHENON_MPI_CHECK(MPI_Bcast(&size, 1, MPI_INT, 0, MPI_COMM_WORLD));
+  newest.resize(size);
+  PARTHENON_MPI_CHECK(MPI_Bcast(newest.data(), size, MPI_CHAR, 0, MPI_COMM_WORLD));
+#endif
+  return newest;
+}
+} // namespace
+
 ParthenonStatus ParthenonManager::ParthenonInitEnv(int argc, char *argv[]) {
   if (called_init_env_) {
     PARTHENON_THROW("ParthenonInitEnv called twice!");
@@ -50,7 +112,16 @@ ParthenonStatus ParthenonManager::ParthenonInitEnv(int argc, char *argv[]) {
 
   // initialize MPI
 #ifdef MPI_PARALLEL
-  if (MPI_SUCCESS != MPI_Init(&argc, &argv)) {
+  // Asynchronous outputs do MPI-IO on a background thread while the main thread keeps
+  // communicating, which requires full thread support that is only requested on demand
+  bool exists;
+  const bool thread_multiple =
+      Env::get<bool>("PARTHENON_MPI_THREAD_MULTIPLE", false, exists);
+  int thread_support;
+  if (MPI_SUCCESS != MPI_Init_thread(&argc, &argv,
+                                     thread_multiple ? MPI_THREAD_MULTIPLE
+                                                     : MPI_THREAD_SINGLE,
+                                     &thread_support)) {
     std::cout << "### FATAL ERROR in ParthenonInit" << std::endl
               << "MPI Initialization failed." << std::endl;
     return ParthenonStatus::error;
@@ -112,15 +183,25 @@ ParthenonStatus ParthenonManager::ParthenonInitEnv(int argc, char *argv[]) {
     auto inputString = restartReader->GetInputString();
     std::istringstream is(inputString);
     pinput->LoadFromStream(is);
+
+    // Transparently continue from the newest restart file of the fast tier
+    const auto newest = NewestRestartFile(arg.restart_filename, pinput.get());
+    if (newest != arg.restart_filename) {
+      if (Globals::my_rank == 0) {
+        std::cout << "Restarting from newer file " << newest << " in the fast tier"
+                  << std::endl;
+      }
+      restartReader = std::make_unique<RestartReaderHDF5>(newest.c_str());
+      pinput = std::make_unique<ParameterInput>();
+      std::istringstream newest_is(restartReader->GetInputString());
+      pinput->LoadFromStream(newest_is);
+    }
   }
   // If an input file was provided
   if (arg.input_filename != nullptr) {
     // Modify info read from restart file
     if (arg.res_flag != 0) {
-      IOWrapper infile;
-      infile.Open(arg.input_filename, IOWrapper::FileMode::read);
-      pinput->LoadFromFile(infile);
-      infile.Close();
+      pinput->LoadFromFile(std::string(arg.input_filename));
 
       // Populate new object for fresh simulation
     } else {
@@ -167,6 +248,16 @@ ParthenonStatus ParthenonManager::ParthenonInitEnv(int argc, char *argv[]) {
   Globals::refinement::min_num_bufs =
       pinput->GetOrAddReal("parthenon/mesh", "refinement_in_one_min_nbufs", 64);
 
+  // Loop patterns selected by loop_pattern_autotune_tag in earlier runs. The absolute
+  // path is kept since the run directory may still change.
+  LoopAutotuner::Instance().SetSamples(
+      pinput->GetOrAddInteger("parthenon/loops", "autotune_samples", 3));
+  if (pinput->DoesParameterExist("parthenon/loops", "autotune_file")) {
+    loop_autotune_file_ =
+        fs::absolute(pinput->GetString("parthenon/loops", "autotune_file")).string();
+    LoopAutotuner::Instance().Load(loop_autotune_file_);
+  }
+
   return ParthenonStatus::ok;
 }
 
@@ -186,6 +277,9 @@ void ParthenonManager::ParthenonInitPackagesAndMesh(
   auto packages = ProcessPackages(pinput);
   // always add the Refinement package
   packages.Add(Refinement::Initialize(pinput.get()));
+  // and the fields of time averages if any output requests them
+  auto time_average = TimeAverage::Initialize(pinput.get(), packages);
+  if (time_average != nullptr) packages.Add(time_average);
   if (forest_def) {
     pmesh = std::make_unique<Mesh>(pinput.get(), app_input.get(), packages, *forest_def);
   } else if (arg.res_flag == 0) {
@@ -229,6 +323,10 @@ void ParthenonManager::ParthenonInitPackagesAndMesh(
 }
 
 ParthenonStatus ParthenonManager::ParthenonFinalize() {
+  // Finish the last asynchronous output
+  AsyncWriter::Instance().Wait();
+  if (!loop_autotune_file_.empty() && Globals::my_rank == 0)
+    LoopAutotuner::Instance().Save(loop_autotune_file_);
   pmesh.reset();
   Kokkos::finalize();
 #ifdef MPI_PARALLEL
@@ -315,7 +413,16 @@ void ParthenonManager::RestartPackages(Mesh &rm, RestartReader &resfile) {
       num_sparse == sparse_info.num_sparse,
       "Mismatch between sparse fields in simulation and restart file");
 
-  std::vector<Real> tmp(static_cast<size_t>(nb) * max_fillsize);
+  // The ghost zones in the file can replace the initial boundary exchange if they were
+  // written and read for all variables that are communicated
+  // Raw block data always includes the ghost zones and is copied to the variables as is
+  const bool raw = resfile.HasRawBlockData();
+  std::unordered_set<std::string> ghosts_read;
+  const bool use_ghosts =
+      pinput->GetOrAddBoolean("parthenon/job", "restart_use_ghost_zones", false) &&
+      (resfile.HasGhost() != 0 || raw);
+
+  std::vector<Real> tmp(raw ? 0 : static_cast<size_t>(nb) * max_fillsize);
   for (const auto &v_info : all_vars_info) {
     const auto vlen = v_info.num_components * v_info.ntop_elems;
     const auto fill_size = v_info.FillSize(theDomain);
@@ -326,7 +433,7 @@ void ParthenonManager::RestartPackages(Mesh &rm, RestartReader &resfile) {
     }
     // Read relevant data from the hdf file, this works for dense and sparse variables
     try {
-      resfile.ReadBlocks(label, myBlocks, v_info, tmp, file_output_format_ver);
+      if (!raw) resfile.ReadBlocks(label, myBlocks, v_info, tmp, file_output_format_ver);
     } catch (std::exception &ex) {
       std::cout << "[" << Globals::my_rank << "] WARNING: Failed to read variable "
                 << label << " from restart file:" << std::endl
@@ -352,6 +459,10 @@ void ParthenonManager::RestartPackages(Mesh &rm, RestartReader &resfile) {
       }
 
       auto v = pmb->meshblock_data.Get()->GetVarPtr(label);
+      if (raw) {
+        resfile.ReadRawBlockData(label, pmb->gid, v->data.data(), v->data.size());
+        continue;
+      }
       auto v_h = v->data.GetHostMirror();
 
       // Double note that this also needs to be update in case
@@ -371,6 +482,19 @@ void ParthenonManager::RestartPackages(Mesh &rm, RestartReader &resfile) {
 
       v->data.DeepCopy(v_h);
     }
+    ghosts_read.insert(label);
+  }
+  if (use_ghosts) {
+    rm.restart_ghosts_valid = true;
+    for (const auto &v : mb.meshblock_data.Get()->GetVariableVector()) {
+      if (v->IsSet(Metadata::FillGhost) && ghosts_read.count(v->label()) == 0)
+        rm.restart_ghosts_valid = false;
+    }
+#ifdef MPI_PARALLEL
+    // Reading may have failed on some ranks only, but the exchange is collective
+    PARTHENON_MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, &rm.restart_ghosts_valid, 1,
+                                      MPI_CXX_BOOL, MPI_LAND, MPI_COMM_WORLD));
+#endif
   }
 
   // Swarm data
@@ -60,6 +60,8 @@ class ParthenonManager {
   ArgParse arg;
   bool called_init_env_ = false;
   bool called_init_packages_and_mesh_ = false;
+  // where the loop patterns selected by the LoopAutotuner are kept (if anywhere)
+  std::string loop_autotune_file_;
 
   template <typename T>
   void ReadSwarmVars_(const SP_Swarm &pswarm, const BlockList_t &block_list,
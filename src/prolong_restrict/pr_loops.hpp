@@ -67,7 +67,7 @@ KOKKOS_INLINE_FUNCTION void InnerProlongationRestrictionLoop(
   const auto &idxer = info(buf).idxer[static_cast<int>(CEL)];
   par_for_inner(
       inner_loop_pattern_tvr_tag, team_member, 0, idxer.size() - 1, [&](const int ii) {
-        const auto [t, u, v, k, j, i] = idxer(ii);
+        const auto [t, u, v, k, j, i] = idxer.template GetIndices<DIM>(ii);
         if (idxer.IsActive(k, j, i)) {
           Stencil::template Do<DIM, FEL, CEL>(t, u, v, k, j, i, ckb, cjb, cib, kb, jb, ib,
                                               info(buf).coords, info(buf).coarse_coords,
@@ -112,7 +112,8 @@ template <int DIM, class Stencil>
 inline void
 ProlongationRestrictionLoop(const ProResInfoArr_t &info, const Idx_t &buffer_idxs,
                             const IndexShape &cellbounds, const IndexShape &c_cellbounds,
-                            const RefinementOp_t op, const std::size_t nbuffers) {
+                            const RefinementOp_t op, const std::size_t nbuffers,
+                            const DevExecSpace &exec_space = DevExecSpace()) {
   PARTHENON_INSTRUMENT
   const IndexDomain interior = IndexDomain::interior;
   auto ckb = c_cellbounds.GetBoundsK(interior);
@@ -124,7 +125,7 @@ ProlongationRestrictionLoop(const ProResInfoArr_t &info, const Idx_t &buffer_idx
   const int scratch_level = 1; // 0 is actual scratch (tiny); 1 is HBM
   size_t scratch_size_in_bytes = 1;
   par_for_outer(
-      DEFAULT_OUTER_LOOP_PATTERN, PARTHENON_AUTO_LABEL, DevExecSpace(),
+      DEFAULT_OUTER_LOOP_PATTERN, PARTHENON_AUTO_LABEL, exec_space,
       scratch_size_in_bytes, scratch_level, 0, nbuffers - 1,
       KOKKOS_LAMBDA(team_mbr_t team_member, const int sub_idx) {
         const std::size_t buf = buffer_idxs(sub_idx);
@@ -163,7 +164,8 @@ inline void
 InnerHostProlongationRestrictionLoop(std::size_t buf, const ProResInfoArrHost_t &info,
                                      const IndexRange &ckb, const IndexRange &cjb,
                                      const IndexRange &cib, const IndexRange &kb,
-                                     const IndexRange &jb, const IndexRange &ib) {
+                                     const IndexRange &jb, const IndexRange &ib,
+                                     const DevExecSpace &exec_space) {
   PARTHENON_INSTRUMENT
   const auto &idxer = info(buf).idxer[static_cast<int>(CEL)];
   auto coords = info(buf).coords;
@@ -171,8 +173,9 @@ InnerHostProlongationRestrictionLoop(std::size_t buf, const ProResInfoArrHost_t
   auto coarse = info(buf).coarse;
   auto fine = info(buf).fine;
   par_for(
-      PARTHENON_AUTO_LABEL, 0, idxer.size() - 1, KOKKOS_LAMBDA(const int ii) {
-        const auto [t, u, v, k, j, i] = idxer(ii);
+      DEFAULT_LOOP_PATTERN, PARTHENON_AUTO_LABEL, exec_space, 0, idxer.size() - 1,
+      KOKKOS_LAMBDA(const int ii) {
+        const auto [t, u, v, k, j, i] = idxer.template GetIndices<DIM>(ii);
         if (idxer.IsActive(k, j, i)) {
           Stencil::template Do<DIM, FEL, CEL>(t, u, v, k, j, i, ckb, cjb, cib, kb, jb, ib,
                                               coords, coarse_coords, &coarse, &fine);
@@ -217,7 +220,8 @@ inline void
 ProlongationRestrictionLoop(const ProResInfoArrHost_t &info_h,
                             const IdxHost_t &buffer_idxs_h, const IndexShape &cellbounds,
                             const IndexShape &c_cellbounds, const RefinementOp_t op,
-                            const std::size_t nbuffers) {
+                            const std::size_t nbuffers,
+                            const DevExecSpace &exec_space = DevExecSpace()) {
   const IndexDomain interior = IndexDomain::interior;
   auto ckb =
       c_cellbounds.GetBoundsK(interior); // TODO(JMM): This may need some additional
@@ -233,28 +237,28 @@ ProlongationRestrictionLoop(const ProResInfoArrHost_t &info_h,
       using TE = TopologicalElement;
       if (info_h(buf).IncludeTopoEl(TE::CC))
         IterateInnerHostProlongationRestrictionLoop<DIM, Stencil, TE::CC>(
-            buf, info_h, ckb, cjb, cib, kb, jb, ib);
+            buf, info_h, ckb, cjb, cib, kb, jb, ib, exec_space);
       if (info_h(buf).IncludeTopoEl(TE::F1))
         IterateInnerHostProlongationRestrictionLoop<DIM, Stencil, TE::F1>(
-            buf, info_h, ckb, cjb, cib, kb, jb, ib);
+            buf, info_h, ckb, cjb, cib, kb, jb, ib, exec_space);
       if (info_h(buf).IncludeTopoEl(TE::F2))
         IterateInnerHostProlongationRestrictionLoop<DIM, Stencil, TE::F2>(
-            buf, info_h, ckb, cjb, cib, kb, jb, ib);
+            buf, info_h, ckb, cjb, cib, kb, jb, ib, exec_space);
       if (info_h(buf).IncludeTopoEl(TE::F3))
         IterateInnerHostProlongationRestrictionLoop<DIM, Stencil, TE::F3>(
-            buf, info_h, ckb, cjb, cib, kb, jb, ib);
+            buf, info_h, ckb, cjb, cib, kb, jb, ib, exec_space);
       if (info_h(buf).IncludeTopoEl(TE::E1))
         IterateInnerHostProlongationRestrictionLoop<DIM, Stencil, TE::E1>(
-            buf, info_h, ckb, cjb, cib, kb, jb, ib);
+            buf, info_h, ckb, cjb, cib, kb, jb, ib, exec_space);
       if (info_h(buf).IncludeTopoEl(TE::E2))
         IterateInnerHostProlongationRestrictionLoop<DIM, Stencil, TE::E2>(
-            buf, info_h, ckb, cjb, cib, kb, jb, ib);
+            buf, info_h, ckb, cjb, cib, kb, jb, ib, exec_space);
       if (info_h(buf).IncludeTopoEl(TE::E3))
         IterateInnerHostProlongationRestrictionLoop<DIM, Stencil, TE::E3>(
-            buf, info_h, ckb, cjb, cib, kb, jb, ib);
+            buf, info_h, ckb, cjb, cib, kb, jb, ib, exec_space);
       if (info_h(buf).IncludeTopoEl(TE::NN))
         IterateInnerHostProlongationRestrictionLoop<DIM, Stencil, TE::NN>(
-            buf, info_h, ckb, cjb, cib, kb, jb, ib);
+            buf, info_h, ckb, cjb, cib, kb, jb, ib, exec_space);
     }
   }
 }
@@ -264,13 +268,13 @@ ProlongationRestrictionLoop(const ProResInfoArr_t &info,
                             const ProResInfoArrHost_t &info_h, const Idx_t &buffer_idxs,
                             const IdxHost_t &buffer_idxs_h, const IndexShape &cellbounds,
                             const IndexShape &c_cellbounds, const RefinementOp_t op,
-                            const std::size_t nbuffers) {
+                            const std::size_t nbuffers, const DevExecSpace &exec_space) {
   if (nbuffers > Globals::refinement::min_num_bufs) {
     ProlongationRestrictionLoop<DIM, Stencil>(info, buffer_idxs, cellbounds, c_cellbounds,
-                                              op, nbuffers);
+                                              op, nbuffers, exec_space);
   } else {
     ProlongationRestrictionLoop<DIM, Stencil>(info_h, buffer_idxs_h, cellbounds,
-                                              c_cellbounds, op, nbuffers);
+                                              c_cellbounds, op, nbuffers, exec_space);
   }
 }
 
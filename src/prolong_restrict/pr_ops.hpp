@@ -22,6 +22,7 @@
 
 #include <algorithm>
 #include <cstring>
+#include <type_traits>
 
 #include "coordinates/coordinates.hpp"  // for coordinates
 #include "interface/variable_state.hpp" // For variable state in ParArray
@@ -73,6 +74,11 @@ namespace parthenon {
 namespace refinement_ops {
 
 namespace util {
+// On a uniform Cartesian mesh all fine elements of a given type have the same volume
+// and all coarse and fine centers are evenly spaced, so the ops below can use constant
+// weights instead of querying the coordinates cell by cell.
+constexpr bool uniform_coordinates = std::is_same_v<Coordinates_t, UniformCartesian>;
+
 // compute distances from cell center to the nearest center in the + or -
 // coordinate direction. Do so for both coarse and fine grids.
 template <int DIM, TopologicalElement EL>
@@ -80,16 +86,23 @@ KOKKOS_FORCEINLINE_FUNCTION void
 GetGridSpacings(const Coordinates_t &coords, const Coordinates_t &coarse_coords,
                 const IndexRange &cib, const IndexRange &ib, int i, int fi, Real *dxm,
                 Real *dxp, Real *dxfm, Real *dxfp) {
-  // here "f" signifies the fine grid, not face locations.
-  const Real xm = coarse_coords.X<DIM, EL>(i - 1);
-  const Real xc = coarse_coords.X<DIM, EL>(i);
-  const Real xp = coarse_coords.X<DIM, EL>(i + 1);
-  *dxm = xc - xm;
-  *dxp = xp - xc;
-  const Real fxm = coords.X<DIM, EL>(fi);
-  const Real fxp = coords.X<DIM, EL>(fi + 1);
-  *dxfm = xc - fxm;
-  *dxfp = fxp - xc;
+  if constexpr (uniform_coordinates) {
+    // Spacings in units of the coarse spacing, the slopes only enter as products with
+    // the fine offsets so the actual spacing drops out
+    *dxm = *dxp = 1.0;
+    *dxfm = *dxfp = 0.25;
+  } else {
+    // here "f" signifies the fine grid, not face locations.
+    const Real xm = coarse_coords.X<DIM, EL>(i - 1);
+    const Real xc = coarse_coords.X<DIM, EL>(i);
+    const Real xp = coarse_coords.X<DIM, EL>(i + 1);
+    *dxm = xc - xm;
+    *dxp = xp - xc;
+    const Real fxm = coords.X<DIM, EL>(fi);
+    const Real fxp = coords.X<DIM, EL>(fi + 1);
+    *dxfm = xc - fxm;
+    *dxfp = fxp - xc;
+  }
 }
 
 KOKKOS_FORCEINLINE_FUNCTION
@@ -132,6 +145,31 @@ struct RestrictAverage {
     const int j = (DIM > 1) ? (cj - cjb.s) * 2 + jb.s : jb.s;
     const int k = (DIM > 2) ? (ck - ckb.s) * 2 + kb.s : kb.s;
 
+    if constexpr (util::uniform_coordinates) {
+      // All fine volumes are equal, so this is a plain average
+      constexpr Real w = 1.0 / ((1 + INCLUDE_X3) * (1 + INCLUDE_X2) * (1 + INCLUDE_X1));
+      Real terms[2][2][2];
+      for (int ok = 0; ok < 2; ++ok) {
+        for (int oj = 0; oj < 2; ++oj) {
+          for (int oi = 0; oi < 2; ++oi) {
+            terms[ok][oj][oi] = 0;
+          }
+        }
+      }
+      for (int ok = 0; ok < 1 + INCLUDE_X3; ++ok) {
+        for (int oj = 0; oj < 1 + INCLUDE_X2; ++oj) {
+          for (int oi = 0; oi < 1 + INCLUDE_X1; ++oi) {
+            terms[ok][oj][oi] = fine(element_idx, l, m, n, k + ok, j + oj, i + oi);
+          }
+        }
+      }
+      // KGF: add the off-centered quantities first to preserve FP symmetry
+      coarse(element_idx, l, m, n, ck, cj, ci) =
+          w * (((terms[0][0][0] + terms[0][1][0]) + (terms[0][0][1] + terms[0][1][1])) +
+               ((terms[1][0][0] + terms[1][1][0]) + (terms[1][0][1] + terms[1][1][1])));
+      return;
+    }
+
     // JMM: If dimensionality is wrong, accesses are out of bounds. Only
     // access cells if dimensionality is correct.
     Real vol[2][2][2], terms[2][2][2]; // memset not available on all accelerators
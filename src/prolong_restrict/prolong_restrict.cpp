@@ -35,7 +35,8 @@ namespace refinement {
 // TODO(JMM): Add a prolongate when prolongation is called in-one
 // TODO(JMM): Is this actually the API we want?
 void Restrict(const StateDescriptor *resolved_packages, const ProResCache_t &cache,
-              const IndexShape &cellbnds, const IndexShape &c_cellbnds) {
+              const IndexShape &cellbnds, const IndexShape &c_cellbnds,
+              const DevExecSpace &exec_space) {
   const auto &ref_func_map = resolved_packages->RefinementFncsToIDs();
   for (const auto &[func, idx] : ref_func_map) {
     auto restrictor = func.restrictor;
@@ -44,13 +45,13 @@ void Restrict(const StateDescriptor *resolved_packages, const ProResCache_t &cac
     loops::IdxHost_t subset_h =
         Kokkos::subview(cache.buffer_subsets_h, idx, Kokkos::ALL());
     restrictor(cache.prores_info, cache.prores_info_h, subset, subset_h, cellbnds,
-               c_cellbnds, cache.buffer_subset_sizes[idx]);
+               c_cellbnds, cache.buffer_subset_sizes[idx], exec_space);
   }
 }
 
 void ProlongateShared(const StateDescriptor *resolved_packages,
                       const ProResCache_t &cache, const IndexShape &cellbnds,
-                      const IndexShape &c_cellbnds) {
+                      const IndexShape &c_cellbnds, const DevExecSpace &exec_space) {
   const auto &ref_func_map = resolved_packages->RefinementFncsToIDs();
   for (const auto &[func, idx] : ref_func_map) {
     auto prolongator = func.prolongator;
@@ -59,13 +60,13 @@ void ProlongateShared(const StateDescriptor *resolved_packages,
     loops::IdxHost_t subset_h =
         Kokkos::subview(cache.buffer_subsets_h, idx, Kokkos::ALL());
     prolongator(cache.prores_info, cache.prores_info_h, subset, subset_h, cellbnds,
-                c_cellbnds, cache.buffer_subset_sizes[idx]);
+                c_cellbnds, cache.buffer_subset_sizes[idx], exec_space);
   }
 }
 
 void ProlongateInternal(const StateDescriptor *resolved_packages,
                         const ProResCache_t &cache, const IndexShape &cellbnds,
-                        const IndexShape &c_cellbnds) {
+                        const IndexShape &c_cellbnds, const DevExecSpace &exec_space) {
   const auto &ref_func_map = resolved_packages->RefinementFncsToIDs();
   for (const auto &[func, idx] : ref_func_map) {
     auto internal_prolongator = func.internal_prolongator;
@@ -75,7 +76,8 @@ void ProlongateInternal(const StateDescriptor *resolved_packages,
     loops::IdxHost_t subset_h =
         Kokkos::subview(cache.buffer_subsets_h, idx, Kokkos::ALL());
     internal_prolongator(cache.prores_info, cache.prores_info_h, subset, subset_h,
-                         cellbnds, c_cellbnds, cache.buffer_subset_sizes[idx]);
+                         cellbnds, c_cellbnds, cache.buffer_subset_sizes[idx],
+                         exec_space);
   }
 }
 
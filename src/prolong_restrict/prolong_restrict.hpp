@@ -44,16 +44,21 @@ namespace refinement {
 
 // TODO(JMM): Add a prolongate when prolongation is called in-one
 // TODO(JMM): Is this actually the API we want?
+// The kernels are launched on exec_space, usually the execution space instance of the
+// MeshData object the cache belongs to.
 void Restrict(const StateDescriptor *resolved_packages, const ProResCache_t &cache,
-              const IndexShape &cellbnds, const IndexShape &c_cellbnds);
+              const IndexShape &cellbnds, const IndexShape &c_cellbnds,
+              const DevExecSpace &exec_space = DevExecSpace());
 
 void ProlongateShared(const StateDescriptor *resolved_packages,
                       const ProResCache_t &cache, const IndexShape &cellbnds,
-                      const IndexShape &c_cellbnds);
+                      const IndexShape &c_cellbnds,
+                      const DevExecSpace &exec_space = DevExecSpace());
 
 void ProlongateInternal(const StateDescriptor *resolved_packages,
                         const ProResCache_t &cache, const IndexShape &cellbnds,
-                        const IndexShape &c_cellbnds);
+                        const IndexShape &c_cellbnds,
+                        const DevExecSpace &exec_space = DevExecSpace());
 
 // std::function closures for the top-level restriction functions The
 // existence of host/device overloads here allows us to avoid a
@@ -65,13 +70,15 @@ void ProlongateInternal(const StateDescriptor *resolved_packages,
 
 using Restrictor_t = std::function<void(
     const ProResInfoArr_t &, const ProResInfoArrHost_t &, const loops::Idx_t &,
-    const loops::IdxHost_t &, const IndexShape &, const IndexShape &, const std::size_t)>;
+    const loops::IdxHost_t &, const IndexShape &, const IndexShape &, const std::size_t,
+    const DevExecSpace &)>;
 using RestrictorHost_t =
     std::function<void(const ProResInfoArrHost_t &, const loops::IdxHost_t &,
                        const IndexShape &, const IndexShape &, const std::size_t)>;
 using Prolongator_t = std::function<void(
     const ProResInfoArr_t &, const ProResInfoArrHost_t &, const loops::Idx_t &,
-    const loops::IdxHost_t &, const IndexShape &, const IndexShape &, const std::size_t)>;
+    const loops::IdxHost_t &, const IndexShape &, const IndexShape &, const std::size_t,
+    const DevExecSpace &)>;
 using ProlongatorHost_t =
     std::function<void(const ProResInfoArrHost_t &, const loops::IdxHost_t &,
                        const IndexShape &, const IndexShape &, const std::size_t)>;
@@ -101,10 +108,10 @@ struct RefinementFunctions_t {
     funcs.restrictor = [](const ProResInfoArr_t &info, const ProResInfoArrHost_t &info_h,
                           const loops::Idx_t &idxs, const loops::IdxHost_t &idxs_h,
                           const IndexShape &cellbnds, const IndexShape &c_cellbnds,
-                          const std::size_t nbuffers) {
+                          const std::size_t nbuffers, const DevExecSpace &exec_space) {
       loops::DoProlongationRestrictionOp<RestrictionOp>(
           cellbnds, info, info_h, idxs, idxs_h, cellbnds, c_cellbnds,
-          RefinementOp_t::Restriction, nbuffers);
+          RefinementOp_t::Restriction, nbuffers, exec_space);
     };
     funcs.restrictor_host = [](const ProResInfoArrHost_t &info_h,
                                const loops::IdxHost_t &idxs_h, const IndexShape &cellbnds,
@@ -116,10 +123,10 @@ struct RefinementFunctions_t {
     funcs.prolongator = [](const ProResInfoArr_t &info, const ProResInfoArrHost_t &info_h,
                            const loops::Idx_t &idxs, const loops::IdxHost_t &idxs_h,
                            const IndexShape &cellbnds, const IndexShape &c_cellbnds,
-                           const std::size_t nbuffers) {
+                           const std::size_t nbuffers, const DevExecSpace &exec_space) {
       loops::DoProlongationRestrictionOp<ProlongationOp>(
           cellbnds, info, info_h, idxs, idxs_h, cellbnds, c_cellbnds,
-          RefinementOp_t::Prolongation, nbuffers);
+          RefinementOp_t::Prolongation, nbuffers, exec_space);
     };
     funcs.prolongator_host = [](const ProResInfoArrHost_t &info_h,
                                 const loops::IdxHost_t &idxs_h,
@@ -133,10 +140,10 @@ struct RefinementFunctions_t {
         [](const ProResInfoArr_t &info, const ProResInfoArrHost_t &info_h,
            const loops::Idx_t &idxs, const loops::IdxHost_t &idxs_h,
            const IndexShape &cellbnds, const IndexShape &c_cellbnds,
-           const std::size_t nbuffers) {
+           const std::size_t nbuffers, const DevExecSpace &exec_space) {
           loops::DoProlongationRestrictionOp<InternalProlongationOp>(
               cellbnds, info, info_h, idxs, idxs_h, cellbnds, c_cellbnds,
-              RefinementOp_t::Prolongation, nbuffers);
+              RefinementOp_t::Prolongation, nbuffers, exec_space);
         };
     funcs.internal_prolongator_host =
         [](const ProResInfoArrHost_t &info_h, const loops::IdxHost_t &idxs_h,
@@ -0,0 +1,231 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef RECONSTRUCT_FLUX_KERNEL_HPP_
+#define RECONSTRUCT_FLUX_KERNEL_HPP_
+//! \file flux_kernel.hpp
+//  \brief fused reconstruction and Riemann solver kernels computing face fluxes
+
+#include <string>
+
+#include "basic_types.hpp"
+#include "defs.hpp"
+#include "interface/mesh_data.hpp"
+#include "kokkos_abstraction.hpp"
+#include "mesh/domain.hpp"
+#include "reconstruct/ppm_inline.hpp"
+#include "reconstruct/weno_inline.hpp"
+#include "utils/error_checking.hpp"
+#include "utils/instrument.hpp"
+
+namespace parthenon {
+
+// Reconstruction policies for CalculateFluxes. Faces reconstructs the values qm at the
+// lower and qp at the upper face of the cell with average q0 from the averages of the
+// cells around it, of which only the radius cells on either side are read. All
+// policies assume uniform mesh spacing.
+namespace reconstruction {
+struct DonorCell {
+  static constexpr int radius = 0;
+  KOKKOS_FORCEINLINE_FUNCTION static void Faces(const Real, const Real, const Real q0,
+                                                const Real, const Real, Real &qm,
+                                                Real &qp) {
+    qm = qp = q0;
+  }
+};
+
+// With the van Leer limiter, as the uniform mesh branch of PiecewiseLinearX1
+struct PiecewiseLinear {
+  static constexpr int radius = 1;
+  KOKKOS_FORCEINLINE_FUNCTION static void Faces(const Real, const Real qm1, const Real q0,
+                                                const Real qp1, const Real, Real &qm,
+                                                Real &qp) {
+    const Real dql = q0 - qm1;
+    const Real dqr = qp1 - q0;
+    const Real dq2 = dql * dqr;
+    const Real dqm = dq2 > 0.0 ? 2.0 * dq2 / (dql + dqr) : 0.0;
+    qm = q0 - 0.5 * dqm;
+    qp = q0 + 0.5 * dqm;
+  }
+};
+
+struct PiecewiseParabolic {
+  static constexpr int radius = 2;
+  KOKKOS_FORCEINLINE_FUNCTION static void Faces(const Real qm2, const Real qm1,
+                                                const Real q0, const Real qp1,
+                                                const Real qp2, Real &qm, Real &qp) {
+    PPM(qm2, qm1, q0, qp1, qp2, qm, qp);
+  }
+};
+
+template <bool z>
+struct WENO5Policy {
+  static constexpr int radius = 2;
+  KOKKOS_FORCEINLINE_FUNCTION static void Faces(const Real qm2, const Real qm1,
+                                                const Real q0, const Real qp1,
+                                                const Real qp2, Real &qm, Real &qp) {
+    WENO5<z>(qm2, qm1, q0, qp1, qp2, qm, qp);
+  }
+};
+using WENO5JS = WENO5Policy<false>;
+using WENOZ = WENO5Policy<true>;
+
+// Faces of variable n of the cell (k, j, i) of block b of a pack for direction DIR,
+// reading no cells outside of the radius of the policy
+template <class Recon, int DIR, class TPack>
+KOKKOS_FORCEINLINE_FUNCTION void CellFaces(const TPack &q, const int b, const int n,
+                                           const int k, const int j, const int i,
+                                           Real &qm, Real &qp) {
+  constexpr int di = DIR == X1DIR;
+  constexpr int dj = DIR == X2DIR;
+  constexpr int dk = DIR == X3DIR;
+  const Real q0 = q(b, n, k, j, i);
+  Real qm1 = q0, qp1 = q0, qm2 = q0, qp2 = q0;
+  if constexpr (Recon::radius > 0) {
+    qm1 = q(b, n, k - dk, j - dj, i - di);
+    qp1 = q(b, n, k + dk, j + dj, i + di);
+  }
+  if constexpr (Recon::radius > 1) {
+    qm2 = q(b, n, k - 2 * dk, j - 2 * dj, i - 2 * di);
+    qp2 = q(b, n, k + 2 * dk, j + 2 * dj, i + 2 * di);
+  }
+  Recon::Faces(qm2, qm1, q0, qp1, qp2, qm, qp);
+}
+} // namespace reconstruction
+
+// The reconstructed states on either side of the face (k, j, i) of block b normal to
+// direction dir, i.e. the face between the cells (k, j, i) and (k, j, i) - e_dir, as
+// passed to the Riemann solver of CalculateFluxes. L(n) and R(n) are the left and right
+// states and F(n) the flux of variable n of the pack, which the solver has to set for
+// the variables lo, ..., hi of the block.
+template <class TPack>
+struct RiemannFace {
+  KOKKOS_FORCEINLINE_FUNCTION
+  RiemannFace(const TPack &pack, const ScratchPad2D<Real> &ql,
+              const ScratchPad2D<Real> &qr, const int dir, const int b, const int lo,
+              const int hi, const int k, const int j, const int i)
+      : dir(dir), b(b), lo(lo), hi(hi), k(k), j(j), i(i), pack_(pack), ql_(ql), qr_(qr) {}
+
+  KOKKOS_FORCEINLINE_FUNCTION Real L(const int n) const { return ql_(n - lo, i); }
+  KOKKOS_FORCEINLINE_FUNCTION Real R(const int n) const { return qr_(n - lo, i); }
+  KOKKOS_FORCEINLINE_FUNCTION Real &F(const int n) const {
+    return pack_.flux(b, dir, n, k, j, i);
+  }
+
+  const int dir, b, lo, hi, k, j, i;
+
+ private:
+  const TPack &pack_;
+  const ScratchPad2D<Real> &ql_, &qr_;
+};
+
+// Computes the fluxes of all variables of a pack created with PDOpt::WithFluxes through
+// the interior faces of all blocks in every active direction in one kernel per
+// direction. Every team reconstructs one row of faces with the policy Recon into team
+// scratch, after which riemann(face) is called for every face of the row with a
+// RiemannFace as described above, e.g.
+//
+//   struct Upwind {
+//     Real v[3];
+//     template <class Face>
+//     KOKKOS_INLINE_FUNCTION void operator()(const Face &f) const {
+//       const Real vd = v[f.dir - 1];
+//       for (int n = f.lo; n <= f.hi; ++n)
+//         f.F(n) = vd * (vd > 0.0 ? f.L(n) : f.R(n));
+//     }
+//   };
+//   CalculateFluxes<reconstruction::PiecewiseLinear>(md, pack, Upwind{{vx, vy, vz}});
+//
+// Only the fluxes are written to memory. The reconstruction reads Recon::radius + 1
+// ghost cells beyond the interior in every active direction.
+template <class Recon, class TPack, class Riemann>
+void CalculateFluxes(MeshData<Real> *md, const TPack &pack, const Riemann &riemann,
+                     const int scratch_level = 1) {
+  PARTHENON_INSTRUMENT
+  const int nblocks = pack.GetNBlocks();
+  if (nblocks == 0) return;
+  const IndexRange ib = md->GetBoundsI(IndexDomain::interior);
+  const IndexRange jb = md->GetBoundsJ(IndexDomain::interior);
+  const IndexRange kb = md->GetBoundsK(IndexDomain::interior);
+  const int ndim = md->GetNDim();
+  PARTHENON_REQUIRE(ib.s >= Recon::radius + 1,
+                    "Not enough ghost cells for the reconstruction");
+
+  const int nvar = pack.GetMaxNumberOfVars();
+  // The left state of the last x1-face of a row is stored one past the cells
+  const int nx1 = md->GetBoundsI(IndexDomain::entire).e + 2;
+  using scratch_t = TeamScratchPads<2>;
+  const scratch_t scratch(nvar, nx1, scratch_level);
+
+  // x1-faces, reconstructing every cell of a row once
+  par_for_blocks_teams(
+      PARTHENON_AUTO_LABEL, scratch, 0, nblocks - 1, kb.s, kb.e, jb.s, jb.e,
+      KOKKOS_LAMBDA(team_mbr_t member, const int b, const int k, const int j,
+                    scratch_t::pads_t &pads) {
+        auto &ql = pads[0];
+        auto &qr = pads[1];
+        const int lo = pack.GetLowerBound(b);
+        const int hi = pack.GetUpperBound(b);
+        for (int n = lo; n <= hi; ++n) {
+          par_for_inner(member, ib.s - 1, ib.e + 1, [&](const int i) {
+            Real qm, qp;
+            reconstruction::CellFaces<Recon, X1DIR>(pack, b, n, k, j, i, qm, qp);
+            qr(n - lo, i) = qm;
+            ql(n - lo, i + 1) = qp;
+          });
+        }
+        member.team_barrier();
+        par_for_inner(member, ib.s, ib.e + 1, [&](const int i) {
+          riemann(RiemannFace<TPack>(pack, ql, qr, X1DIR, b, lo, hi, k, j, i));
+        });
+      });
+
+  // x2- and x3-faces, with rows of faces along x1 so that the inner loops stay
+  // contiguous in memory
+  for (int dir = X2DIR; dir <= ndim; ++dir) {
+    const int ke = kb.e + (dir == X3DIR);
+    const int je = jb.e + (dir == X2DIR);
+    par_for_blocks_teams(
+        PARTHENON_AUTO_LABEL, scratch, 0, nblocks - 1, kb.s, ke, jb.s, je,
+        KOKKOS_LAMBDA(team_mbr_t member, const int b, const int k, const int j,
+                      scratch_t::pads_t &pads) {
+          auto &ql = pads[0];
+          auto &qr = pads[1];
+          const int lo = pack.GetLowerBound(b);
+          const int hi = pack.GetUpperBound(b);
+          for (int n = lo; n <= hi; ++n) {
+            par_for_inner(member, ib.s, ib.e, [&](const int i) {
+              Real qm, qp, unused;
+              if (dir == X2DIR) {
+                reconstruction::CellFaces<Recon, X2DIR>(pack, b, n, k, j - 1, i, unused,
+                                                        qp);
+                reconstruction::CellFaces<Recon, X2DIR>(pack, b, n, k, j, i, qm, unused);
+              } else {
+                reconstruction::CellFaces<Recon, X3DIR>(pack, b, n, k - 1, j, i, unused,
+                                                        qp);
+                reconstruction::CellFaces<Recon, X3DIR>(pack, b, n, k, j, i, qm, unused);
+              }
+              ql(n - lo, i) = qp;
+              qr(n - lo, i) = qm;
+            });
+          }
+          member.team_barrier();
+          par_for_inner(member, ib.s, ib.e, [&](const int i) {
+            riemann(RiemannFace<TPack>(pack, ql, qr, dir, b, lo, hi, k, j, i));
+          });
+        });
+  }
+}
+
+} // namespace parthenon
+
+#endif // RECONSTRUCT_FLUX_KERNEL_HPP_
@@ -0,0 +1,113 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef RECONSTRUCT_PPM_INLINE_HPP_
+#define RECONSTRUCT_PPM_INLINE_HPP_
+//! \file ppm_inline.hpp
+//  \brief implements piecewise parabolic reconstruction for uniform meshes
+
+// REFERENCES:
+// (CW) P. Colella & P. Woodward, "The Piecewise Parabolic Method (PPM) for Gas-Dynamical
+// Simulations", JCP, 54, 174 (1984)
+
+#include <algorithm>
+
+#include "config.hpp"
+#include "kokkos_abstraction.hpp"
+
+namespace parthenon {
+
+//----------------------------------------------------------------------------------------
+//! \fn PPM()
+//  \brief reconstructs the values qm at the lower and qp at the upper face of the cell
+//  with average q0 from the averages of the two cells on either side. Assumes uniform
+//  mesh spacing.
+KOKKOS_FORCEINLINE_FUNCTION void PPM(const Real qm2, const Real qm1, const Real q0,
+                                     const Real qp1, const Real qp2, Real &qm, Real &qp) {
+  // Fourth order face values (CW eq 1.6), bounded by the neighboring averages
+  qm = (7.0 * (qm1 + q0) - (qm2 + qp1)) / 12.0;
+  qm = std::max(std::min(qm, std::max(qm1, q0)), std::min(qm1, q0));
+  qp = (7.0 * (q0 + qp1) - (qm1 + qp2)) / 12.0;
+  qp = std::max(std::min(qp, std::max(q0, qp1)), std::min(q0, qp1));
+
+  // Monotonize the parabola (CW eq 1.10)
+  if ((qp - q0) * (q0 - qm) <= 0.0) {
+    qm = qp = q0;
+    return;
+  }
+  const Real dq = qp - qm;
+  const Real q6 = 6.0 * (q0 - 0.5 * (qm + qp));
+  if (dq * q6 > dq * dq) {
+    qm = 3.0 * q0 - 2.0 * qp;
+  } else if (-dq * dq > dq * q6) {
+    qp = 3.0 * q0 - 2.0 * qm;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn PiecewiseParabolicX1()
+//  \brief reconstruct L/R surfaces of the i-th cells, requires two ghost cells on either
+//  side of [il, iu]
+template <typename T>
+KOKKOS_FORCEINLINE_FUNCTION void
+PiecewiseParabolicX1(parthenon::team_mbr_t const &member, const int k, const int j,
+                     const int il, const int iu, const T &q, ScratchPad2D<Real> &ql,
+                     ScratchPad2D<Real> &qr) {
+  const int nu = q.GetDim(4) - 1;
+  for (int n = 0; n <= nu; ++n) {
+    if (!q.IsAllocated(n)) continue;
+    parthenon::par_for_inner(member, il, iu, [&](const int i) {
+      PPM(q(n, k, j, i - 2), q(n, k, j, i - 1), q(n, k, j, i), q(n, k, j, i + 1),
+          q(n, k, j, i + 2), qr(n, i), ql(n, i + 1));
+    });
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn PiecewiseParabolicX2()
+//  \brief reconstruct the lower (qr) and upper (ql) surfaces of the cells in row j
+template <typename T>
+KOKKOS_FORCEINLINE_FUNCTION void
+PiecewiseParabolicX2(parthenon::team_mbr_t const &member, const int k, const int j,
+                     const int il, const int iu, const T &q, ScratchPad2D<Real> &ql,
+                     ScratchPad2D<Real> &qr) {
+  const int nu = q.GetDim(4) - 1;
+  for (int n = 0; n <= nu; ++n) {
+    if (!q.IsAllocated(n)) continue;
+    parthenon::par_for_inner(member, il, iu, [&](const int i) {
+      PPM(q(n, k, j - 2, i), q(n, k, j - 1, i), q(n, k, j, i), q(n, k, j + 1, i),
+          q(n, k, j + 2, i), qr(n, i), ql(n, i));
+    });
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn PiecewiseParabolicX3()
+//  \brief reconstruct the lower (qr) and upper (ql) surfaces of the cells in plane k
+template <typename T>
+KOKKOS_FORCEINLINE_FUNCTION void
+PiecewiseParabolicX3(parthenon::team_mbr_t const &member, const int k, const int j,
+                     const int il, const int iu, const T &q, ScratchPad2D<Real> &ql,
+                     ScratchPad2D<Real> &qr) {
+  const int nu = q.GetDim(4) - 1;
+  for (int n = 0; n <= nu; ++n) {
+    if (!q.IsAllocated(n)) continue;
+    parthenon::par_for_inner(member, il, iu, [&](const int i) {
+      PPM(q(n, k - 2, j, i), q(n, k - 1, j, i), q(n, k, j, i), q(n, k + 1, j, i),
+          q(n, k + 2, j, i), qr(n, i), ql(n, i));
+    });
+  }
+}
+
+} // namespace parthenon
+
+#endif // RECONSTRUCT_PPM_INLINE_HPP_
@@ -0,0 +1,155 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef RECONSTRUCT_WENO_INLINE_HPP_
+#define RECONSTRUCT_WENO_INLINE_HPP_
+//! \file weno_inline.hpp
+//  \brief implements fifth order WENO reconstruction for uniform meshes
+
+// REFERENCES:
+// (JS) G.-S. Jiang & C.-W. Shu, "Efficient Implementation of Weighted ENO Schemes",
+// JCP, 126, 202 (1996)
+// (Borges) R. Borges et al., "An improved weighted essentially non-oscillatory scheme
+// for hyperbolic conservation laws", JCP, 227, 3191 (2008)
+
+#include <cmath>
+
+#include "config.hpp"
+#include "kokkos_abstraction.hpp"
+
+namespace parthenon {
+
+//----------------------------------------------------------------------------------------
+//! \fn WENO5Face()
+//  \brief value at the face between the cells with averages q0 and qp1 reconstructed
+//  from the cell with average q0 and its neighbors. Uses the WENO-Z weights of Borges
+//  if z is true and the original weights of JS otherwise.
+template <bool z>
+KOKKOS_FORCEINLINE_FUNCTION Real WENO5Face(const Real qm2, const Real qm1, const Real q0,
+                                           const Real qp1, const Real qp2) {
+  // Smoothness indicators (JS eq 3.2-3.4)
+  const Real beta0 = (13.0 / 12.0) * SQR(qm2 - 2.0 * qm1 + q0) +
+                     0.25 * SQR(qm2 - 4.0 * qm1 + 3.0 * q0);
+  const Real beta1 = (13.0 / 12.0) * SQR(qm1 - 2.0 * q0 + qp1) + 0.25 * SQR(qm1 - qp1);
+  const Real beta2 = (13.0 / 12.0) * SQR(q0 - 2.0 * qp1 + qp2) +
+                     0.25 * SQR(3.0 * q0 - 4.0 * qp1 + qp2);
+
+  // Nonlinear weights for the linear weights 1/10, 6/10, 3/10
+  Real alpha0, alpha1, alpha2;
+  if constexpr (z) {
+    constexpr Real eps = 1.0e-40;
+    const Real tau5 = std::abs(beta0 - beta2);
+    alpha0 = 0.1 * (1.0 + tau5 / (beta0 + eps));
+    alpha1 = 0.6 * (1.0 + tau5 / (beta1 + eps));
+    alpha2 = 0.3 * (1.0 + tau5 / (beta2 + eps));
+  } else {
+    constexpr Real eps = 1.0e-6;
+    alpha0 = 0.1 / SQR(beta0 + eps);
+    alpha1 = 0.6 / SQR(beta1 + eps);
+    alpha2 = 0.3 / SQR(beta2 + eps);
+  }
+
+  // Third order values of the three substencils
+  const Real f0 = (2.0 * qm2 - 7.0 * qm1 + 11.0 * q0) / 6.0;
+  const Real f1 = (-qm1 + 5.0 * q0 + 2.0 * qp1) / 6.0;
+  const Real f2 = (2.0 * q0 + 5.0 * qp1 - qp2) / 6.0;
+  return (alpha0 * f0 + alpha1 * f1 + alpha2 * f2) / (alpha0 + alpha1 + alpha2);
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn WENO5()
+//  \brief reconstructs the values qm at the lower and qp at the upper face of the cell
+//  with average q0 from the averages of the two cells on either side
+template <bool z>
+KOKKOS_FORCEINLINE_FUNCTION void WENO5(const Real qm2, const Real qm1, const Real q0,
+                                       const Real qp1, const Real qp2, Real &qm,
+                                       Real &qp) {
+  qp = WENO5Face<z>(qm2, qm1, q0, qp1, qp2);
+  qm = WENO5Face<z>(qp2, qp1, q0, qm1, qm2);
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn WENO5X1()
+//  \brief reconstruct L/R surfaces of the i-th cells, requires two ghost cells on either
+//  side of [il, iu]. The WENOZ variants use the weights of Borges.
+template <bool z = false, typename T>
+KOKKOS_FORCEINLINE_FUNCTION void
+WENO5X1(parthenon::team_mbr_t const &member, const int k, const int j, const int il,
+        const int iu, const T &q, ScratchPad2D<Real> &ql, ScratchPad2D<Real> &qr) {
+  const int nu = q.GetDim(4) - 1;
+  for (int n = 0; n <= nu; ++n) {
+    if (!q.IsAllocated(n)) continue;
+    parthenon::par_for_inner(member, il, iu, [&](const int i) {
+      WENO5<z>(q(n, k, j, i - 2), q(n, k, j, i - 1), q(n, k, j, i), q(n, k, j, i + 1),
+               q(n, k, j, i + 2), qr(n, i), ql(n, i + 1));
+    });
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn WENO5X2()
+//  \brief reconstruct the lower (qr) and upper (ql) surfaces of the cells in row j
+template <bool z = false, typename T>
+KOKKOS_FORCEINLINE_FUNCTION void
+WENO5X2(parthenon::team_mbr_t const &member, const int k, const int j, const int il,
+        const int iu, const T &q, ScratchPad2D<Real> &ql, ScratchPad2D<Real> &qr) {
+  const int nu = q.GetDim(4) - 1;
+  for (int n = 0; n <= nu; ++n) {
+    if (!q.IsAllocated(n)) continue;
+    parthenon::par_for_inner(member, il, iu, [&](const int i) {
+      WENO5<z>(q(n, k, j - 2, i), q(n, k, j - 1, i), q(n, k, j, i), q(n, k, j + 1, i),
+               q(n, k, j + 2, i), qr(n, i), ql(n, i));
+    });
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn WENO5X3()
+//  \brief reconstruct the lower (qr) and upper (ql) surfaces of the cells in plane k
+template <bool z = false, typename T>
+KOKKOS_FORCEINLINE_FUNCTION void
+WENO5X3(parthenon::team_mbr_t const &member, const int k, const int j, const int il,
+        const int iu, const T &q, ScratchPad2D<Real> &ql, ScratchPad2D<Real> &qr) {
+  const int nu = q.GetDim(4) - 1;
+  for (int n = 0; n <= nu; ++n) {
+    if (!q.IsAllocated(n)) continue;
+    parthenon::par_for_inner(member, il, iu, [&](const int i) {
+      WENO5<z>(q(n, k - 2, j, i), q(n, k - 1, j, i), q(n, k, j, i), q(n, k + 1, j, i),
+               q(n, k + 2, j, i), qr(n, i), ql(n, i));
+    });
+  }
+}
+
+template <typename T>
+KOKKOS_FORCEINLINE_FUNCTION void
+WENOZX1(parthenon::team_mbr_t const &member, const int k, const int j, const int il,
+        const int iu, const T &q, ScratchPad2D<Real> &ql, ScratchPad2D<Real> &qr) {
+  WENO5X1<true>(member, k, j, il, iu, q, ql, qr);
+}
+
+template <typename T>
+KOKKOS_FORCEINLINE_FUNCTION void
+WENOZX2(parthenon::team_mbr_t const &member, const int k, const int j, const int il,
+        const int iu, const T &q, ScratchPad2D<Real> &ql, ScratchPad2D<Real> &qr) {
+  WENO5X2<true>(member, k, j, il, iu, q, ql, qr);
+}
+
+template <typename T>
+KOKKOS_FORCEINLINE_FUNCTION void
+WENOZX3(parthenon::team_mbr_t const &member, const int k, const int j, const int il,
+        const int iu, const T &q, ScratchPad2D<Real> &ql, ScratchPad2D<Real> &qr) {
+  WENO5X3<true>(member, k, j, il, iu, q, ql, qr);
+}
+
+} // namespace parthenon
+
+#endif // RECONSTRUCT_WENO_INLINE_HPP_
@@ -13,7 +13,9 @@
 #ifndef SOLVERS_BICGSTAB_SOLVER_HPP_
 #define SOLVERS_BICGSTAB_SOLVER_HPP_
 
+#include <algorithm>
 #include <memory>
+#include <numeric>
 #include <string>
 #include <utility>
 #include <vector>
@@ -38,6 +40,9 @@ struct BiCGSTABParams {
   bool precondition = true;
   bool print_per_step = false;
   bool relative_residual = false;
+  // Treat the components of multi-component fields as independent problems that are
+  // solved together, each of which has to reach the residual tolerance
+  bool batched = false;
   BiCGSTABParams() = default;
   BiCGSTABParams(ParameterInput *pin, const std::string &input_block) {
     max_iters = pin->GetOrAddInteger(input_block, "max_iterations", max_iters);
@@ -48,6 +53,7 @@ struct BiCGSTABParams {
     mg_params = MGParams(pin, input_block);
     relative_residual =
         pin->GetOrAddBoolean(input_block, "relative_residual", relative_residual);
+    batched = pin->GetOrAddBoolean(input_block, "batched", batched);
   }
 };
 
@@ -85,6 +91,18 @@ class BiCGSTABSolver {
       : preconditioner(pkg, params_in.mg_params, eq_in, shape), params_(params_in),
         iter_counter(0), eqs_(eq_in) {
     using namespace refinement_ops;
+    if (params_.batched) {
+      for (int n : shape)
+        nbatch_ *= n;
+    }
+    alpha_ = ParArray1D<Real>("bicgstab alpha", nbatch_);
+    omega_ = ParArray1D<Real>("bicgstab omega", nbatch_);
+    beta_ = ParArray1D<Real>("bicgstab beta", nbatch_);
+    beta_omega_ = ParArray1D<Real>("bicgstab beta omega", nbatch_);
+    alpha_h_ = Kokkos::create_mirror_view(Kokkos::HostSpace(), alpha_);
+    omega_h_ = Kokkos::create_mirror_view(Kokkos::HostSpace(), omega_);
+    beta_h_ = Kokkos::create_mirror_view(Kokkos::HostSpace(), beta_);
+    beta_omega_h_ = Kokkos::create_mirror_view(Kokkos::HostSpace(), beta_omega_);
     auto m_no_ghost =
         Metadata({Metadata::Cell, Metadata::Derived, Metadata::OneCopy}, shape);
     pkg->AddField(x::name(), m_no_ghost);
@@ -102,10 +120,13 @@ class BiCGSTABSolver {
     return preconditioner.AddSetupTasks(tl, dependence, partition, pmesh);
   }
 
+  void InvalidateSetup() { preconditioner.InvalidateSetup(); }
+
   TaskID AddTasks(TaskList &tl, TaskID dependence, Mesh *pmesh, const int partition) {
     using namespace utils;
     TaskID none;
-    auto &md = pmesh->mesh_data.GetOrAdd("base", partition);
+    auto &md =
+        pmesh->mesh_data.GetOrAdd(pmesh->mesh_data.GetStageHandle("base"), partition);
     std::string label = "bicg_comm_" + std::to_string(partition);
     auto &md_comm =
         pmesh->mesh_data.AddShallow(label, md, std::vector<std::string>{u::name()});
@@ -113,40 +134,36 @@ class BiCGSTABSolver {
     bool multilevel = pmesh->multilevel;
 
     // Initialization: x <- 0, r <- rhs, rhat0 <- rhs,
-    // rhat0r_old <- (rhat0, r), p <- r, u <- 0
+    // rhat0r_old <- (rhat0, r) = (rhs, rhs), p <- r, u <- 0
     auto zero_x = tl.AddTask(dependence, TF(SetToZero<x>), md);
     auto zero_u_init = tl.AddTask(dependence, TF(SetToZero<u>), md);
     auto copy_r = tl.AddTask(dependence, TF(CopyData<rhs, r>), md);
     auto copy_p = tl.AddTask(dependence, TF(CopyData<rhs, p>), md);
     auto copy_rhat0 = tl.AddTask(dependence, TF(CopyData<rhs, rhat0>), md);
-    auto get_rhat0r_init = DotProduct<rhat0, r>(dependence, tl, &rhat0r, md);
-    auto get_rhs2 = get_rhat0r_init;
-    if (params_.relative_residual)
-      get_rhs2 = DotProduct<rhs, rhs>(dependence, tl, &rhs2, md);
+    auto get_rhs2 = DotProducts<rhs, rhs>(dependence, tl, &rhs2, nbatch_, md);
     auto initialize = tl.AddTask(
         TaskQualifier::once_per_region | TaskQualifier::local_sync,
-        zero_x | zero_u_init | copy_r | copy_p | copy_rhat0 | get_rhat0r_init | get_rhs2,
-        "zero factors",
+        zero_x | zero_u_init | copy_r | copy_p | copy_rhat0 | get_rhs2, "zero factors",
         [](BiCGSTABSolver *solver) {
           solver->iter_counter = -1;
+          solver->rhat0r.val = solver->rhs2.val;
+          solver->converged_.assign(solver->nbatch_, false);
           return TaskStatus::complete;
         },
         this);
     tl.AddTask(
         TaskQualifier::once_per_region, initialize, "print to screen",
-        [&](BiCGSTABSolver *solver, std::shared_ptr<Real> res_tol,
-            bool relative_residual) {
-          if (Globals::my_rank == 0 && params_.print_per_step) {
-            Real tol =
-                relative_residual
-                    ? *res_tol * std::sqrt(solver->rhs2.val / pmesh->GetTotalCells())
-                    : *res_tol;
+        [](BiCGSTABSolver *solver, Mesh *pmesh) {
+          if (Globals::my_rank == 0 && solver->params_.print_per_step) {
+            Real tol = solver->GetTolerance(0, pmesh->GetTotalCells());
+            for (int c = 1; c < solver->nbatch_; ++c)
+              tol = std::min(tol, solver->GetTolerance(c, pmesh->GetTotalCells()));
             printf("# [0] v-cycle\n# [1] rms-residual (tol = %e) \n# [2] rms-error\n",
                    tol);
           }
           return TaskStatus::complete;
         },
-        this, params_.residual_tolerance, params_.relative_residual);
+        this, pmesh);
 
     // BEGIN ITERATIVE TASKS
     auto [itl, solver_id] = tl.AddSublist(initialize, {1, params_.max_iters});
@@ -178,40 +195,31 @@ class BiCGSTABSolver {
         AddBoundaryExchangeTasks<BoundaryType::any>(precon1, itl, md_comm, multilevel);
     auto get_v = eqs_.template Ax<u, v>(itl, comm, md);
 
-    // 3. rhat0v <- (rhat0, v)
-    auto get_rhat0v = DotProduct<rhat0, v>(get_v, itl, &rhat0v, md);
-
-    // 4. h <- x + alpha u (alpha = rhat0r_old / rhat0v)
-    auto correct_h = itl.AddTask(
-        get_rhat0v, "h <- x + alpha u",
-        [](BiCGSTABSolver *solver, std::shared_ptr<MeshData<Real>> &md) {
-          Real alpha = solver->rhat0r_old / solver->rhat0v.val;
-          return AddFieldsAndStore<x, u, h>(md, 1.0, alpha);
+    // 3. rhat0v <- (rhat0, v), alpha <- rhat0r_old / rhat0v
+    auto get_rhat0v = DotProducts<rhat0, v>(get_v, itl, &rhat0v, nbatch_, md);
+    auto get_alpha = itl.AddTask(
+        TaskQualifier::once_per_region | TaskQualifier::local_sync, get_rhat0v,
+        "alpha <- rhat0r_old / rhat0v",
+        [](BiCGSTABSolver *solver) {
+          for (int c = 0; c < solver->nbatch_; ++c)
+            solver->alpha_h_(c) = solver->converged_[c]
+                                      ? 0.0
+                                      : solver->rhat0r_old[c] / solver->rhat0v.val[c];
+          if (solver->nbatch_ > 1) Kokkos::deep_copy(solver->alpha_, solver->alpha_h_);
+          return TaskStatus::complete;
         },
-        this, md);
+        this);
 
-    // 5. s <- r - alpha v (alpha = rhat0r_old / rhat0v)
+    // 4. h <- x + alpha u
+    // 5. s <- r - alpha v
     auto correct_s = itl.AddTask(
-        get_rhat0v, "s <- r - alpha v",
+        get_alpha, "h <- x + alpha u, s <- r - alpha v",
         [](BiCGSTABSolver *solver, std::shared_ptr<MeshData<Real>> &md) {
-          Real alpha = solver->rhat0r_old / solver->rhat0v.val;
-          return AddFieldsAndStore<r, v, s>(md, 1.0, -alpha);
+          return solver->template UpdateTwice<x, u, h, r, v, s>(md, solver->alpha_,
+                                                                solver->alpha_h_);
         },
         this, md);
 
-    // Check and print out residual
-    auto get_res = DotProduct<s, s>(correct_s, itl, &residual, md);
-
-    auto print = itl.AddTask(
-        TaskQualifier::once_per_region, get_res,
-        [&](BiCGSTABSolver *solver, Mesh *pmesh) {
-          Real rms_res = std::sqrt(solver->residual.val / pmesh->GetTotalCells());
-          if (Globals::my_rank == 0 && solver->params_.print_per_step)
-            printf("%i %e\n", solver->iter_counter * 2 + 1, rms_res);
-          return TaskStatus::complete;
-        },
-        this, pmesh);
-
     // 6. u <- M s
     auto precon2 = correct_s;
     if (params_.precondition) {
@@ -228,96 +236,199 @@ class BiCGSTABSolver {
         AddBoundaryExchangeTasks<BoundaryType::any>(precon2, itl, md_comm, multilevel);
     auto get_t = eqs_.template Ax<u, t>(itl, pre_t_comm, md);
 
-    // 8. omega <- (t,s) / (t,t)
-    auto get_ts = DotProduct<t, s>(get_t, itl, &ts, md);
-    auto get_tt = DotProduct<t, t>(get_t, itl, &tt, md);
-
-    // 9. x <- h + omega u
-    auto correct_x = itl.AddTask(
-        get_tt | get_ts, "x <- h + omega u",
-        [](BiCGSTABSolver *solver, std::shared_ptr<MeshData<Real>> &md) {
-          Real omega = solver->ts.val / solver->tt.val;
-          return AddFieldsAndStore<h, u, x>(md, 1.0, omega);
+    // 8. omega <- (t,s) / (t,t), with the residual (s,s) of the half step in the same
+    //    reduction
+    const int nbatch = nbatch_;
+    auto get_omega_dots = MultiDotProduct(
+        get_t, itl, &omega_dots, 3 * nbatch, "(t,s), (t,t), (s,s)",
+        [nbatch](std::vector<Real> &dots, std::shared_ptr<MeshData<Real>> &md) {
+          AccumulateDotProducts<t, s>(md, &dots[0], nbatch);
+          AccumulateDotProducts<t, t>(md, &dots[nbatch], nbatch);
+          return AccumulateDotProducts<s, s>(md, &dots[2 * nbatch], nbatch);
         },
-        this, md);
+        md);
+    auto get_omega = itl.AddTask(
+        TaskQualifier::once_per_region | TaskQualifier::local_sync, get_omega_dots,
+        "omega <- (t,s) / (t,t)",
+        [](BiCGSTABSolver *solver, Mesh *pmesh) {
+          const int n = solver->nbatch_;
+          const auto &dots = solver->omega_dots.val;
+          Real res2 = 0.0;
+          for (int c = 0; c < n; ++c) {
+            solver->omega_h_(c) = solver->converged_[c] ? 0.0 : dots[c] / dots[n + c];
+            res2 = std::max(res2, dots[2 * n + c]);
+          }
+          if (n > 1) Kokkos::deep_copy(solver->omega_, solver->omega_h_);
+          Real rms_res = std::sqrt(res2 / pmesh->GetTotalCells());
+          if (Globals::my_rank == 0 && solver->params_.print_per_step)
+            printf("%i %e\n", solver->iter_counter * 2 + 1, rms_res);
+          return TaskStatus::complete;
+        },
+        this, pmesh);
 
+    // 9. x <- h + omega u
     // 10. r <- s - omega t
     auto correct_r = itl.AddTask(
-        get_tt | get_ts, "r <- s - omega t",
+        get_omega, "x <- h + omega u, r <- s - omega t",
         [](BiCGSTABSolver *solver, std::shared_ptr<MeshData<Real>> &md) {
-          Real omega = solver->ts.val / solver->tt.val;
-          return AddFieldsAndStore<s, t, r>(md, 1.0, -omega);
+          return solver->template UpdateTwice<h, u, x, s, t, r>(md, solver->omega_,
+                                                                solver->omega_h_);
         },
         this, md);
 
-    // Check and print out residual
-    auto get_res2 = DotProduct<r, r>(correct_r, itl, &residual, md);
+    // 11. rhat0r <- (rhat0, r), with the residual (r,r) in the same reduction
+    auto get_beta_dots = MultiDotProduct(
+        correct_r, itl, &beta_dots, 2 * nbatch, "(r,r), (rhat0,r)",
+        [nbatch](std::vector<Real> &dots, std::shared_ptr<MeshData<Real>> &md) {
+          AccumulateDotProducts<r, r>(md, &dots[0], nbatch);
+          return AccumulateDotProducts<rhat0, r>(md, &dots[nbatch], nbatch);
+        },
+        md);
 
-    get_res2 = itl.AddTask(
-        TaskQualifier::once_per_region, get_res2,
-        [&](BiCGSTABSolver *solver, Mesh *pmesh) {
-          Real rms_err = std::sqrt(solver->residual.val / pmesh->GetTotalCells());
+    // Check and print out residual, the problems that have converged are not updated
+    // anymore
+    // 12. beta <- rhat0r / rhat0r_old * alpha / omega
+    auto get_res2 = itl.AddTask(
+        TaskQualifier::once_per_region | TaskQualifier::local_sync, get_beta_dots,
+        [](BiCGSTABSolver *solver, Mesh *pmesh) {
+          const int n = solver->nbatch_;
+          const Real ncells = pmesh->GetTotalCells();
+          solver->residual.val.assign(solver->beta_dots.val.begin(),
+                                      solver->beta_dots.val.begin() + n);
+          solver->rhat0r.val.assign(solver->beta_dots.val.begin() + n,
+                                    solver->beta_dots.val.end());
+          Real rms_err = 0.0;
+          for (int c = 0; c < n; ++c) {
+            const Real rms_c = std::sqrt(solver->residual.val[c] / ncells);
+            rms_err = std::max(rms_err, rms_c);
+            solver->converged_[c] =
+                solver->converged_[c] || rms_c < solver->GetTolerance(c, ncells);
+            const Real beta = solver->converged_[c]
+                                  ? 0.0
+                                  : solver->rhat0r.val[c] / solver->rhat0r_old[c] *
+                                        solver->alpha_h_(c) / solver->omega_h_(c);
+            solver->beta_h_(c) = beta;
+            solver->beta_omega_h_(c) = beta * solver->omega_h_(c);
+          }
+          if (n > 1) {
+            Kokkos::deep_copy(solver->beta_, solver->beta_h_);
+            Kokkos::deep_copy(solver->beta_omega_, solver->beta_omega_h_);
+          }
+          solver->final_residual = rms_err;
           if (Globals::my_rank == 0 && solver->params_.print_per_step)
             printf("%i %e\n", solver->iter_counter * 2 + 2, rms_err);
           return TaskStatus::complete;
         },
         this, pmesh);
 
-    // 11. rhat0r <- (rhat0, r)
-    auto get_rhat0r = DotProduct<rhat0, r>(correct_r, itl, &rhat0r, md);
-
-    // 12. beta <- rhat0r / rhat0r_old * alpha / omega
     // 13. p <- r + beta * (p - omega * v)
     auto update_p = itl.AddTask(
-        get_rhat0r | get_res2, "p <- r + beta * (p - omega * v)",
+        get_res2, "p <- r + beta * (p - omega * v)",
         [](BiCGSTABSolver *solver, std::shared_ptr<MeshData<Real>> &md) {
-          Real alpha = solver->rhat0r_old / solver->rhat0v.val;
-          Real omega = solver->ts.val / solver->tt.val;
-          Real beta = solver->rhat0r.val / solver->rhat0r_old * alpha / omega;
-          AddFieldsAndStore<p, v, p>(md, 1.0, -omega);
-          return AddFieldsAndStore<r, p, p>(md, 1.0, beta);
-          return TaskStatus::complete;
+          if (solver->nbatch_ == 1) {
+            const Real beta = solver->beta_h_(0);
+            const Real beta_omega = solver->beta_omega_h_(0);
+            return AddThreeFieldsAndStore<r, p, v, p>(md, 1.0, beta, -beta_omega);
+          }
+          return AddThreeFieldsAndStore<r, p, v, p>(
+              md, 1.0, ComponentWeights{solver->beta_, 1.0},
+              ComponentWeights{solver->beta_omega_, -1.0});
         },
         this, md);
 
-    // 14. rhat0r_old <- rhat0r, zero all reductions
+    // 14. Check convergence of all problems
     auto check = itl.AddTask(
-        TaskQualifier::completion, update_p | correct_x, "rhat0r_old <- rhat0r",
-        [partition](BiCGSTABSolver *solver, Mesh *pmesh, int max_iter,
-                    std::shared_ptr<Real> res_tol, bool relative_residual) {
-          Real rms_res = std::sqrt(solver->residual.val / pmesh->GetTotalCells());
-          solver->final_residual = rms_res;
+        TaskQualifier::completion, update_p, "check convergence",
+        [](BiCGSTABSolver *solver, int max_iter) {
           solver->final_iteration = solver->iter_counter;
-          Real tol = relative_residual
-                         ? *res_tol * std::sqrt(solver->rhs2.val / pmesh->GetTotalCells())
-                         : *res_tol;
-          if (rms_res < tol || solver->iter_counter >= max_iter) {
-            solver->final_residual = rms_res;
-            solver->final_iteration = solver->iter_counter;
-            return TaskStatus::complete;
-          }
+          const bool converged = std::all_of(solver->converged_.begin(),
+                                             solver->converged_.end(),
+                                             [](bool conv) { return conv; });
+          if (converged || solver->iter_counter >= max_iter) return TaskStatus::complete;
           return TaskStatus::iterate;
         },
-        this, pmesh, params_.max_iters, params_.residual_tolerance,
-        params_.relative_residual);
+        this, params_.max_iters);
 
     return tl.AddTask(solver_id, TF(CopyData<x, u>), md);
   }
 
-  Real GetSquaredResidualSum() const { return residual.val; }
+  // Summed over the batched problems
+  Real GetSquaredResidualSum() const {
+    return std::accumulate(residual.val.begin(), residual.val.end(), 0.0);
+  }
   int GetCurrentIterations() const { return iter_counter; }
 
+  // Largest final residual of the batched problems
   Real GetFinalResidual() const { return final_residual; }
   int GetFinalIterations() const { return final_iteration; }
 
   BiCGSTABParams &GetParams() { return params_; }
 
  protected:
+  // Tolerance of the rms residual of problem c
+  Real GetTolerance(int c, Real ncells) const {
+    const Real tol = *params_.residual_tolerance;
+    return params_.relative_residual ? tol * std::sqrt(rhs2.val[c] / ncells) : tol;
+  }
+
+  // out1_t <- a_t + coeff b_t and out2_t <- c_t - coeff d_t with the coefficients of
+  // the batched problems
+  template <class a_t, class b_t, class out1_t, class c_t, class d_t, class out2_t>
+  TaskStatus UpdateTwice(std::shared_ptr<MeshData<Real>> &md,
+                         const ParArray1D<Real> &coeff,
+                         const typename ParArray1D<Real>::HostMirror &coeff_h) {
+    using namespace utils;
+    if (nbatch_ == 1)
+      return AddFieldsAndStoreTwice<a_t, b_t, out1_t, c_t, d_t, out2_t>(
+          md, 1.0, coeff_h(0), 1.0, -coeff_h(0));
+    return AddFieldsAndStoreTwice<a_t, b_t, out1_t, c_t, d_t, out2_t>(
+        md, 1.0, ComponentWeights{coeff, 1.0}, 1.0, ComponentWeights{coeff, -1.0});
+  }
+
+  // Zeroes n reduction values, calls accumulate(dots->val, md) on every partition and
+  // reduces all values with a single global reduction
+  template <class F>
+  TaskID MultiDotProduct(TaskID dependency, TaskList &tl,
+                         AllReduce<std::vector<Real>> *dots, int n,
+                         const std::string &label, F accumulate,
+                         std::shared_ptr<MeshData<Real>> &md) {
+    auto zero_dots = tl.AddTask(
+        TaskQualifier::once_per_region | TaskQualifier::local_sync, dependency,
+        [n](AllReduce<std::vector<Real>> *dots) {
+          dots->val.assign(n, 0.0);
+          return TaskStatus::complete;
+        },
+        dots);
+    auto get_dots = tl.AddTask(
+        TaskQualifier::local_sync, zero_dots, label,
+        [accumulate](AllReduce<std::vector<Real>> *dots,
+                     std::shared_ptr<MeshData<Real>> &md) {
+          return accumulate(dots->val, md);
+        },
+        dots, md);
+    auto start_dots =
+        tl.AddTask(TaskQualifier::once_per_region, get_dots,
+                   &AllReduce<std::vector<Real>>::StartReduce, dots, MPI_SUM);
+    return tl.AddTask(TaskQualifier::once_per_region | TaskQualifier::local_sync,
+                      start_dots, &AllReduce<std::vector<Real>>::CheckReduce, dots);
+  }
+
   MGSolver<u, rhs, equations> preconditioner;
   BiCGSTABParams params_;
   int iter_counter;
-  AllReduce<Real> rtr, pAp, rhat0v, rhat0r, ts, tt, residual, rhs2;
-  Real rhat0r_old;
+  // Number of independent problems solved together, one unless params_.batched
+  int nbatch_ = 1;
+  // Reductions hold one value for every batched problem
+  AllReduce<std::vector<Real>> rhat0v, rhat0r, residual, rhs2;
+  // (t,s), (t,t), (s,s) and (r,r), (rhat0,r) of an iteration, the n-th product of
+  // problem c is at n * nbatch_ + c
+  AllReduce<std::vector<Real>> omega_dots, beta_dots;
+  std::vector<Real> rhat0r_old;
+  // Coefficients of the batched problems on the host and (only used if nbatch_ > 1) on
+  // the device, which are zero for problems that have converged
+  ParArray1D<Real> alpha_, omega_, beta_, beta_omega_;
+  typename ParArray1D<Real>::HostMirror alpha_h_, omega_h_, beta_h_, beta_omega_h_;
+  std::vector<bool> converged_;
   equations eqs_;
   Real final_residual;
   int final_iteration;
@@ -14,8 +14,13 @@
 #define SOLVERS_MG_SOLVER_HPP_
 
 #include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
 #include <limits>
+#include <map>
 #include <memory>
+#include <numeric>
 #include <string>
 #include <utility>
 #include <vector>
@@ -26,6 +31,7 @@
 #include "kokkos_abstraction.hpp"
 #include "solvers/solver_utils.hpp"
 #include "tasks/tasks.hpp"
+#include "utils/concepts_lite.hpp"
 #include "utils/robust.hpp"
 
 namespace parthenon {
@@ -39,6 +45,39 @@ struct MGParams {
   std::string smoother = "SRJ2";
   bool two_by_two_diagonal = false;
   int max_coarsenings = std::numeric_limits<int>::max();
+  bool fused_smoother = true;
+  // Communicate the residual and error between levels in single precision
+  bool single_precision_comms = false;
+  // The matrix does not change between solves, so its diagonal (and the eigenvalue
+  // estimates of Chebyshev smoothers) are only recomputed after the block list changed
+  bool time_independent_operator = false;
+  // Chebyshev smoothers target the eigenvalues of D^-1 A in
+  // [chebyshev_lower, chebyshev_upper] times the largest one, which is estimated with
+  // chebyshev_power_iterations power iterations on every level during setup
+  int chebyshev_power_iterations = 8;
+  Real chebyshev_lower = 0.3;
+  Real chebyshev_upper = 1.1;
+  // Weight of the updates of the Gauss-Seidel and line smoothers (over-relaxation for
+  // values larger than one) and direction of the lines, zero to alternate
+  Real relaxation_weight = 1.0;
+  int line_direction = 1;
+  // Build the initial guess of a solve with a full multigrid cycle (requires do_FAS)
+  bool fmg = false;
+  // Initial guess of a solve from the solutions of the previous solves: "none" keeps the
+  // guess in u, "previous" uses the last solution, and "extrapolate" extrapolates
+  // linearly (in the times given by MGSolver::SetSolveTime) from the last two
+  std::string warm_start = "none";
+  // Treat the components of multi-component fields as independent problems that are
+  // solved together, each of which has to reach the residual tolerance
+  bool batched = false;
+  // Number of points (0, 7, or 27) of the stencil of A that is assembled during setup
+  // and stored on every level, zero to only apply A through the equations class. Coarse
+  // levels either assemble their stencil like the finest level or, with
+  // galerkin_coarse_operator, use the Galerkin product of the finer stencil, whose
+  // couplings are scaled by galerkin_coupling_scale.
+  int stencil_points = 0;
+  bool galerkin_coarse_operator = false;
+  Real galerkin_coupling_scale = 0.5;
 
   MGParams() = default;
   MGParams(ParameterInput *pin, const std::string &input_block) {
@@ -51,6 +90,64 @@ struct MGParams {
         pin->GetOrAddBoolean(input_block, "two_by_two_diagonal", two_by_two_diagonal);
     max_coarsenings =
         pin->GetOrAddInteger(input_block, "max_coarsenings", max_coarsenings);
+    fused_smoother = pin->GetOrAddBoolean(input_block, "fused_smoother", fused_smoother);
+    single_precision_comms = pin->GetOrAddBoolean(input_block, "single_precision_comms",
+                                                  single_precision_comms);
+    time_independent_operator = pin->GetOrAddBoolean(
+        input_block, "time_independent_operator", time_independent_operator);
+    chebyshev_power_iterations = pin->GetOrAddInteger(
+        input_block, "chebyshev_power_iterations", chebyshev_power_iterations);
+    chebyshev_lower = pin->GetOrAddReal(input_block, "chebyshev_lower", chebyshev_lower);
+    chebyshev_upper = pin->GetOrAddReal(input_block, "chebyshev_upper", chebyshev_upper);
+    relaxation_weight =
+        pin->GetOrAddReal(input_block, "relaxation_weight", relaxation_weight);
+    line_direction = pin->GetOrAddInteger(input_block, "line_direction", line_direction);
+    fmg = pin->GetOrAddBoolean(input_block, "fmg", fmg);
+    warm_start = pin->GetOrAddString(input_block, "warm_start", warm_start);
+    batched = pin->GetOrAddBoolean(input_block, "batched", batched);
+    stencil_points = pin->GetOrAddInteger(input_block, "stencil_points", stencil_points);
+    galerkin_coarse_operator = pin->GetOrAddBoolean(
+        input_block, "galerkin_coarse_operator", galerkin_coarse_operator);
+    galerkin_coupling_scale = pin->GetOrAddReal(input_block, "galerkin_coupling_scale",
+                                                galerkin_coupling_scale);
+    PARTHENON_REQUIRE_THROWS(stencil_points == 0 || stencil_points == 7 ||
+                                 stencil_points == 27,
+                             "stencil_points must be 0, 7, or 27.");
+    PARTHENON_REQUIRE_THROWS(!galerkin_coarse_operator || stencil_points > 0,
+                             "galerkin_coarse_operator requires a stored stencil.");
+    PARTHENON_REQUIRE_THROWS(!fmg || do_FAS, "fmg requires do_FAS.");
+    PARTHENON_REQUIRE_THROWS(warm_start == "none" || warm_start == "previous" ||
+                                 warm_start == "extrapolate",
+                             "Unknown warm_start " + warm_start);
+    PARTHENON_REQUIRE_THROWS(0.0 < relaxation_weight && relaxation_weight < 2.0,
+                             "relaxation_weight must be in (0, 2).");
+    PARTHENON_REQUIRE_THROWS(0 <= line_direction && line_direction <= 3,
+                             "line_direction must be 0, 1, 2, or 3.");
+    if (ChebyshevStages() > 0) {
+      PARTHENON_REQUIRE_THROWS(chebyshev_power_iterations > 0,
+                               "Chebyshev smoothers need at least one power iteration.");
+      PARTHENON_REQUIRE_THROWS(0.0 < chebyshev_lower && chebyshev_lower < chebyshev_upper,
+                               "Invalid Chebyshev eigenvalue bounds.");
+    }
+  }
+
+  // Number of stages of a "ChebyshevN" smoother and zero for all other smoothers
+  int ChebyshevStages() const { return PrefixedStages("Chebyshev"); }
+  // Number of sweeps of a red-black Gauss-Seidel "RBGSN" smoother, each of which needs
+  // two boundary exchanges
+  int RedBlackStages() const { return PrefixedStages("RBGS"); }
+  // Number of sweeps of a "LineN" smoother
+  int LineStages() const { return PrefixedStages("Line"); }
+
+ private:
+  int PrefixedStages(const std::string &prefix) const {
+    if (smoother.compare(0, prefix.size(), prefix) != 0) return 0;
+    const std::string n = smoother.substr(prefix.size());
+    PARTHENON_REQUIRE_THROWS(!n.empty() && n.find_first_not_of("0123456789") ==
+                                               std::string::npos &&
+                                 std::stoi(n) > 0,
+                             "Unknown smoother " + smoother);
+    return std::stoi(n);
   }
 };
 
@@ -68,22 +165,102 @@ struct MGParams {
 //
 // That stores the (possibly approximate) diagonal of matrix A in the field
 // associated with the type diag_t. This is used for Jacobi iteration.
+//
+// Optionally, the equations class can include a template method
+//
+//  template <class x_t>
+//  auto AxStencil(std::shared_ptr<MeshData<Real>> &md, std::vector<bool> &include_block)
+//
+// that returns a device copyable functor with a method
+//
+//  KOKKOS_INLINE_FUNCTION
+//  Real operator()(const int b, const int c, const int k, const int j, const int i)
+//
+// which evaluates component c of A x_t in a single cell of block b of the pack of md
+// with the given blocks. It must give the same result as Ax on two_level_composite
+// grids, only using the ghost zones of x_t. If it is available, the smoother evaluates
+// the matrix inside of the Jacobi kernel instead of storing A x_t first, which saves a
+// kernel launch and a write and read of a full field per smoothing stage.
+//
+// Besides the SRJ smoothers, a "ChebyshevN" smoother with N stages is available. It
+// reduces the error over the upper part of the spectrum of D^-1 A with a single
+// boundary exchange per stage, so that it can reach the smoothing of an SRJ smoother
+// with fewer stages, i.e. fewer gmg_same boundary exchanges per V-cycle, at the cost of
+// a few power iterations per level during setup.
+//
+// A "RBGSN" smoother does N red-black Gauss-Seidel sweeps, each a boundary exchange and
+// update of the cells with even i + j + k followed by the same for the odd cells. A
+// "LineN" smoother does N sweeps that solve the tridiagonal part of A along lines in
+// direction line_direction within every block exactly, which requires the equations
+// class to include a template method
+//
+//  template <class lo_t, class up_t>
+//  TaskStatus SetLineCoefficients(std::shared_ptr<MeshData<Real>> &md, int dir)
+//
+// that stores the coefficients of A coupling every cell to its lower and upper
+// neighbor in direction dir in the fields associated with lo_t and up_t.
+//
+// With stencil_points > 0, the operator of the multigrid levels is a stored stencil
+// (see utils::StencilOffset for the layout), which is assembled by the setup tasks and
+// requires the equations class to include a template method
+//
+//  template <class stencil_t>
+//  TaskStatus SetStencil(std::shared_ptr<MeshData<Real>> &md, int npoints)
+//
+// that stores the coefficients of A in the npoints components of the field associated
+// with stencil_t. The stencil is shared by all components of u, and the diagonal and
+// the line coefficients are taken from it. The residual of the solve itself is still
+// computed with Ax.
 template <class u, class rhs, class equations>
 class MGSolver {
+  struct has_ax_stencil {
+    template <class eq_t>
+    auto requires_(eq_t eq) -> void_t<decltype(eq.template AxStencil<u>(
+        std::declval<std::shared_ptr<MeshData<Real>> &>(),
+        std::declval<std::vector<bool> &>()))>;
+  };
+  struct has_line_coefficients {
+    template <class eq_t>
+    auto requires_(eq_t eq) -> void_t<decltype(eq.template SetLineCoefficients<u, u>(
+        std::declval<std::shared_ptr<MeshData<Real>> &>(), 1))>;
+  };
+  struct has_stencil {
+    template <class eq_t>
+    auto requires_(eq_t eq) -> void_t<decltype(eq.template SetStencil<u>(
+        std::declval<std::shared_ptr<MeshData<Real>> &>(), 7))>;
+  };
+
  public:
   PARTHENON_INTERNALSOLVERVARIABLE(
       u, res_err); // residual on the way up and error on the way down
   PARTHENON_INTERNALSOLVERVARIABLE(u, temp); // Temporary storage
   PARTHENON_INTERNALSOLVERVARIABLE(u, u0);   // Storage for initial solution during FAS
   PARTHENON_INTERNALSOLVERVARIABLE(u, D);    // Storage for (approximate) diagonal
+  PARTHENON_INTERNALSOLVERVARIABLE(u, cheb_d); // Update of the Chebyshev smoother
+  // Couplings along the lines and elimination factors of the line smoother
+  PARTHENON_INTERNALSOLVERVARIABLE(u, line_lo);
+  PARTHENON_INTERNALSOLVERVARIABLE(u, line_up);
+  PARTHENON_INTERNALSOLVERVARIABLE(u, line_c);
+  // Solutions of the last two solves for warm starts
+  PARTHENON_INTERNALSOLVERVARIABLE(u, u_prev1);
+  PARTHENON_INTERNALSOLVERVARIABLE(u, u_prev2);
+  // Stored stencil of A and contributions to the Galerkin stencil of the coarser level
+  PARTHENON_INTERNALSOLVERVARIABLE(u, stencil);
+  PARTHENON_INTERNALSOLVERVARIABLE(u, stencil_g);
   std::vector<std::string> GetInternalVariableNames() const {
-    return {res_err::name(), temp::name(), u0::name(), D::name()};
+    return {res_err::name(), temp::name(),    u0::name(),      D::name(),
+            cheb_d::name(),  line_lo::name(), line_up::name(), line_c::name(),
+            u_prev1::name(), u_prev2::name(), stencil::name(), stencil_g::name()};
   }
 
   MGSolver(StateDescriptor *pkg, MGParams params_in, equations eq_in = equations(),
            std::vector<int> shape = {})
       : params_(params_in), iter_counter(0), eqs_(eq_in) {
     using namespace parthenon::refinement_ops;
+    if (params_.batched) {
+      for (int n : shape)
+        nbatch_ *= n;
+    }
     // The ghost cells of res_err need to be filled, but this is accomplished by
     // copying res_err into u, communicating, then copying u back into res_err
     // across all zones in a block
@@ -92,6 +269,7 @@ class MGSolver {
                   Metadata::GMGProlongate, Metadata::OneCopy},
                  shape);
     mres_err.RegisterRefinementOps<ProlongateSharedLinear, RestrictAverage>();
+    if (params_.single_precision_comms) mres_err.Set(Metadata::SinglePrecisionComms);
     pkg->AddField(res_err::name(), mres_err);
 
     auto mtemp =
@@ -107,11 +285,66 @@ class MGSolver {
     }
     auto mD = Metadata({Metadata::Cell, Metadata::Derived, Metadata::OneCopy}, Dshape);
     pkg->AddField(D::name(), mD);
+
+    if (params_.ChebyshevStages() > 0) {
+      PARTHENON_REQUIRE_THROWS(!params_.two_by_two_diagonal,
+                               "Chebyshev smoothers require a scalar diagonal.");
+      auto md = Metadata({Metadata::Cell, Metadata::Derived, Metadata::OneCopy}, shape);
+      pkg->AddField(cheb_d::name(), md);
+    }
+    if (params_.RedBlackStages() > 0 || params_.LineStages() > 0)
+      PARTHENON_REQUIRE_THROWS(!params_.two_by_two_diagonal,
+                               "Gauss-Seidel and line smoothers require a scalar "
+                               "diagonal.");
+    if (params_.LineStages() > 0) {
+      PARTHENON_REQUIRE_THROWS(implements<has_line_coefficients(equations)>::value ||
+                                   params_.stencil_points > 0,
+                               "Line smoothers require equations::SetLineCoefficients "
+                               "or a stored stencil.");
+      auto ml = Metadata({Metadata::Cell, Metadata::Derived, Metadata::OneCopy}, shape);
+      pkg->AddField(line_lo::name(), ml);
+      pkg->AddField(line_up::name(), ml);
+      pkg->AddField(line_c::name(), ml);
+    }
+    if (params_.warm_start != "none") {
+      auto mp = Metadata({Metadata::Cell, Metadata::Derived, Metadata::OneCopy}, shape);
+      pkg->AddField(u_prev1::name(), mp);
+      if (params_.warm_start == "extrapolate") pkg->AddField(u_prev2::name(), mp);
+    }
+    if (params_.stencil_points > 0) {
+      PARTHENON_REQUIRE_THROWS(implements<has_stencil(equations)>::value,
+                               "Stored stencils require equations::SetStencil.");
+      PARTHENON_REQUIRE_THROWS(!params_.two_by_two_diagonal,
+                               "Stored stencils require a scalar diagonal.");
+      const std::vector<int> sshape{params_.stencil_points};
+      pkg->AddField(stencil::name(),
+                    Metadata({Metadata::Cell, Metadata::Derived, Metadata::OneCopy},
+                             sshape));
+      if (params_.galerkin_coarse_operator) {
+        auto mg = Metadata({Metadata::Cell, Metadata::Independent, Metadata::GMGRestrict,
+                            Metadata::OneCopy},
+                           sshape);
+        mg.RegisterRefinementOps<ProlongateSharedLinear, RestrictAverage>();
+        pkg->AddField(stencil_g::name(), mg);
+      }
+    }
   }
 
+  // Time of the next solve, used to weight the extrapolation of warm starts. Without it,
+  // the solves are assumed to be equally spaced.
+  void SetSolveTime(Real time) { solve_time_ = time; }
+
   TaskID AddTasks(TaskList &tl, TaskID dependence, Mesh *pmesh, const int partition) {
     using namespace utils;
     TaskID none;
+    auto partitions = pmesh->GetDefaultBlockPartitions(GridIdentifier::leaf());
+    if (partition >= partitions.size())
+      PARTHENON_FAIL("Does not work with non-default partitioning.");
+    auto &md = pmesh->mesh_data.Add("base", partitions[partition]);
+
+    if (params_.warm_start != "none")
+      dependence = AddWarmStartTasks(tl, dependence, md, pmesh);
+    if (params_.fmg) dependence = AddFMGTasks(tl, dependence, partition, pmesh);
     auto [itl, solve_id] = tl.AddSublist(dependence, {1, this->params_.max_iters});
     iter_counter = -1;
     auto update_iter = itl.AddTask(
@@ -125,22 +358,22 @@ class MGSolver {
         &iter_counter);
     auto mg_finest = AddLinearOperatorTasks(itl, update_iter, partition, pmesh);
 
-    auto partitions = pmesh->GetDefaultBlockPartitions(GridIdentifier::leaf());
-    if (partition >= partitions.size())
-      PARTHENON_FAIL("Does not work with non-default partitioning.");
-    auto &md = pmesh->mesh_data.Add("base", partitions[partition]);
     auto comm = AddBoundaryExchangeTasks<BoundaryType::any>(mg_finest, itl, md,
                                                             pmesh->multilevel);
     auto calc_pointwise_res = eqs_.template Ax<u, res_err>(itl, comm, md);
     calc_pointwise_res = itl.AddTask(
         calc_pointwise_res, TF(AddFieldsAndStoreInteriorSelect<rhs, res_err, res_err>),
         md, 1.0, -1.0, false);
-    auto get_res = DotProduct<res_err, res_err>(calc_pointwise_res, itl, &residual, md);
+    auto get_res = DotProducts<res_err, res_err>(calc_pointwise_res, itl, &residual,
+                                                 nbatch_, md);
 
     auto check = itl.AddTask(
         TaskQualifier::completion, get_res, "Check residual",
         [partition](MGSolver *solver, Mesh *pmesh) {
-          Real rms_res = std::sqrt(solver->residual.val / pmesh->GetTotalCells());
+          // The largest residual of the batched problems
+          Real res2 = *std::max_element(solver->residual.val.begin(),
+                                        solver->residual.val.end());
+          Real rms_res = std::sqrt(res2 / pmesh->GetTotalCells());
           if (Globals::my_rank == 0 && partition == 0)
             printf("%i %e\n", solver->iter_counter, rms_res);
           solver->final_residual = rms_res;
@@ -150,14 +383,49 @@ class MGSolver {
         },
         this, pmesh);
 
+    if (params_.warm_start != "none") return AddStoreSolutionTasks(tl, solve_id, md);
     return solve_id;
   }
 
+  // Tasks for a full multigrid cycle, which restricts the residual of u (in the FAS
+  // form) to all levels, smooths on the coarsest level, and then successively
+  // prolongates the correction to the next finer level and does a V-cycle on the
+  // hierarchy below it, up to the finest level
+  TaskID AddFMGTasks(TaskList &tl, TaskID dependence, int partition, Mesh *pmesh) {
+    using namespace utils;
+    pmesh->BuildGMGHierarchy();
+    int min_level = std::max(pmesh->GetGMGMaxLevel() - params_.max_coarsenings,
+                             pmesh->GetGMGMinLevel());
+    int max_level = pmesh->GetGMGMaxLevel();
+    // Partitions of different levels hold different blocks, see AddLinearOperatorTasks
+    auto sync = [&tl](TaskID depends_on) {
+      return tl.AddTask(TaskQualifier::local_sync, depends_on,
+                        []() { return TaskStatus::complete; });
+    };
+    auto task = sync(dependence);
+    auto restricted = task;
+    for (int level = max_level; level >= min_level; --level)
+      restricted = restricted | AddFMGRestrictionTasks(tl, task, partition, level,
+                                                       min_level, max_level, pmesh);
+    task = sync(restricted);
+    for (int top = min_level; top <= max_level; ++top) {
+      auto cycle = task;
+      for (int level = top; level >= min_level; --level)
+        cycle = cycle | AddMultiGridTasksPartitionLevel(tl, task, partition, level,
+                                                        min_level, top, pmesh, true);
+      task = sync(cycle);
+      if (top < max_level)
+        task = sync(AddFMGProlongationTasks(tl, task, partition, top, min_level, pmesh));
+    }
+    return task;
+  }
+
   TaskID AddLinearOperatorTasks(TaskList &tl, TaskID dependence, int partition,
                                 Mesh *pmesh) {
     using namespace utils;
     iter_counter = 0;
 
+    pmesh->BuildGMGHierarchy();
     int min_level = std::max(pmesh->GetGMGMaxLevel() - params_.max_coarsenings,
                              pmesh->GetGMGMinLevel());
     int max_level = pmesh->GetGMGMaxLevel();
@@ -182,31 +450,133 @@ class MGSolver {
   TaskID AddSetupTasks(TL_t &tl, TaskID dependence, int partition, Mesh *pmesh) {
     using namespace utils;
 
+    pmesh->BuildGMGHierarchy();
     int min_level = std::max(pmesh->GetGMGMaxLevel() - params_.max_coarsenings,
                              pmesh->GetGMGMinLevel());
     int max_level = pmesh->GetGMGMaxLevel();
 
+    // For time independent operators, the diagonal is set here once for every block list
+    // instead of in every V-cycle. This decision is made when the tasks are added, so it
+    // is the same for all lists.
+    const std::size_t generation = pmesh->GetBlockListGeneration();
+    const bool cached =
+        params_.time_independent_operator && cached_generation_ == generation;
+    const bool set_diagonal = params_.time_independent_operator && !cached;
+    // Stored stencils only change with the operator
+    const bool set_stencil = params_.stencil_points > 0 && !cached;
+
     auto mg_setup = dependence;
     for (int level = max_level; level >= min_level; --level) {
-      mg_setup =
-          mg_setup | AddMultiGridSetupPartitionLevel(tl, dependence, partition, level,
-                                                     min_level, max_level, pmesh);
+      mg_setup = mg_setup | AddMultiGridSetupPartitionLevel(
+                                tl, dependence, partition, level, min_level, max_level,
+                                pmesh, set_diagonal, set_stencil);
+    }
+    if (params_.ChebyshevStages() > 0 && !cached)
+      mg_setup = AddEigenvalueEstimateTasks(tl, mg_setup, partition, min_level, max_level,
+                                            pmesh);
+    if (set_diagonal) {
+      mg_setup = tl.AddTask(
+          mg_setup, "cache setup",
+          [](MGSolver *solver, std::size_t generation) {
+            solver->cached_generation_ = generation;
+            return TaskStatus::complete;
+          },
+          this, generation);
     }
     return mg_setup;
   }
 
-  Real GetSquaredResidualSum() const { return residual.val; }
+  // Redo the setup of a time independent operator in the next AddSetupTasks, e.g., after
+  // the time step of the implicit stages of an ImexIntegrator changed
+  void InvalidateSetup() { cached_generation_ = std::numeric_limits<std::size_t>::max(); }
+
+  // Summed over the batched problems
+  Real GetSquaredResidualSum() const {
+    return std::accumulate(residual.val.begin(), residual.val.end(), 0.0);
+  }
   int GetCurrentIterations() const { return iter_counter; }
+  // Largest final residual of the batched problems
   Real GetFinalResidual() const { return final_residual; }
   int GetFinalIterations() const { return final_iteration; }
 
+  // Wall times of the phases of the V-cycles on every level, for benchmarking. A phase
+  // is timed from when its first task starts until its device work is done, including
+  // the time spent waiting for messages, so the timers fence and slow down the solve.
+  // Whether the phases are timed is decided when the tasks are added.
+  enum class Phase {
+    smoothing,
+    restriction,
+    prolongation,
+    boundary_exchange,
+    coarse_solve
+  };
+  static constexpr int nphases = 5;
+  using phase_times_t = std::array<double, nphases>;
+  void TimePhases(const bool time_phases) { time_phases_ = time_phases; }
+  void ClearPhaseTimes() {
+    for (auto &[key, times] : phase_times_)
+      times.fill(0.0);
+  }
+  // Seconds by level, summed over the partitions of this rank and all V-cycles since the
+  // times were cleared
+  std::map<int, phase_times_t> GetPhaseTimes() const {
+    std::map<int, phase_times_t> by_level;
+    for (const auto &[key, times] : phase_times_) {
+      auto &sum = by_level.try_emplace(key.first, phase_times_t{}).first->second;
+      for (int p = 0; p < nphases; ++p)
+        sum[p] += times[p];
+    }
+    return by_level;
+  }
+
  protected:
   MGParams params_;
   int iter_counter;
-  AllReduce<Real> residual;
+  // Number of independent problems solved together, one unless params_.batched
+  int nbatch_ = 1;
+  // (res_err, res_err) of each of the batched problems
+  AllReduce<std::vector<Real>> residual;
   equations eqs_;
   Real final_residual;
   int final_iteration;
+  // Reductions for the estimate of the largest eigenvalue of D^-1 A on each level, which
+  // hold (x, D^-1 A x) and (x, x) once the setup is done. A map, since the reductions
+  // must not move while tasks hold pointers to them.
+  std::map<int, AllReduce<std::vector<Real>>> eigenvalue_estimates_;
+  // Block list generation for which the diagonal and eigenvalue estimates were set up
+  // last for a time independent operator
+  std::size_t cached_generation_ = std::numeric_limits<std::size_t>::max();
+  // Warm starts use the solutions of the last num_prev_solutions_ solves on the block
+  // list of warm_start_generation_, which were done at prev_solve_times_
+  int num_prev_solutions_ = 0;
+  std::size_t warm_start_generation_ = std::numeric_limits<std::size_t>::max();
+  Real solve_time_ = std::numeric_limits<Real>::quiet_NaN();
+  Real prev_solve_times_[2] = {std::numeric_limits<Real>::quiet_NaN(),
+                               std::numeric_limits<Real>::quiet_NaN()};
+  // Phase times by (level, partition). A map, since tasks hold pointers to the times.
+  bool time_phases_ = false;
+  std::map<std::pair<int, int>, phase_times_t> phase_times_;
+
+  // Adds the tasks add(depends_on) of a phase on a level and partition, timing them
+  // between two extra tasks if phases are timed
+  template <class add_t>
+  TaskID AddTimedPhase(TaskList &tl, TaskID depends_on, Phase phase, int level,
+                       int partition, add_t &&add) {
+    if (!time_phases_) return add(depends_on);
+    auto *times = &phase_times_.try_emplace({level, partition}, phase_times_t{})
+                       .first->second;
+    auto timer = std::make_shared<Kokkos::Timer>();
+    auto start = tl.AddTask(depends_on, "start phase timer", [timer]() {
+      timer->reset();
+      return TaskStatus::complete;
+    });
+    auto done = add(start);
+    return tl.AddTask(done, "stop phase timer", [timer, times, phase]() {
+      Kokkos::fence();
+      (*times)[static_cast<int>(phase)] += timer->seconds();
+      return TaskStatus::complete;
+    });
+  }
   // These functions apparently have to be public to compile with cuda since
   // they contain device side lambdas
  public:
@@ -287,6 +657,39 @@ class MGSolver {
     return TaskStatus::complete;
   }
 
+  // Jacobi update that evaluates A xold_t with the stencil of the equations
+  template <class rhs_t, class D_t, class xold_t, class xnew_t>
+  TaskStatus FusedJacobi(std::shared_ptr<MeshData<Real>> &md, double weight) {
+    using namespace parthenon;
+    using TE = parthenon::TopologicalElement;
+    TE te = TE::CC;
+    IndexRange ib = md->GetBoundsI(IndexDomain::interior, te);
+    IndexRange jb = md->GetBoundsJ(IndexDomain::interior, te);
+    IndexRange kb = md->GetBoundsK(IndexDomain::interior, te);
+
+    int nblocks = md->NumBlocks();
+    std::vector<bool> include_block(nblocks, true);
+
+    const auto stencil = eqs_.template AxStencil<xold_t>(md, include_block);
+    static auto desc = parthenon::MakePackDescriptor<xold_t, xnew_t, rhs_t, D_t>(md.get());
+    auto pack = desc.GetPack(md.get(), include_block);
+    parthenon::par_for(
+        "FusedJacobi", 0, pack.GetNBlocks() - 1, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+        KOKKOS_LAMBDA(const int b, const int k, const int j, const int i) {
+          const int nvars =
+              pack.GetUpperBound(b, xnew_t()) - pack.GetLowerBound(b, xnew_t()) + 1;
+          for (int c = 0; c < nvars; ++c) {
+            const Real diag = pack(b, te, D_t(c), k, j, i);
+            const Real xo = pack(b, te, xold_t(c), k, j, i);
+            const Real off_diag = stencil(b, c, k, j, i) - diag * xo;
+            const Real val = pack(b, te, rhs_t(c), k, j, i) - off_diag;
+            pack(b, te, xnew_t(c), k, j, i) =
+                weight * robust::ratio(val, diag) + (1.0 - weight) * xo;
+          }
+        });
+    return TaskStatus::complete;
+  }
+
   template <parthenon::BoundaryType comm_boundary, class in_t, class out_t, class TL_t>
   TaskID AddJacobiIteration(TL_t &tl, TaskID depends_on, bool multilevel, Real omega,
                             std::shared_ptr<MeshData<Real>> &md,
@@ -295,7 +698,14 @@ class MGSolver {
 
     auto comm =
         AddBoundaryExchangeTasks<comm_boundary>(depends_on, tl, md_comm, multilevel);
-    auto mat_mult = eqs_.template Ax<in_t, out_t>(tl, comm, md);
+    if constexpr (implements<has_ax_stencil(equations)>::value) {
+      if (params_.fused_smoother && !params_.two_by_two_diagonal &&
+          params_.stencil_points == 0) {
+        return tl.AddTask(comm, TF(&MGSolver::FusedJacobi<rhs, D, in_t, out_t>), this,
+                          md, omega);
+      }
+    }
+    auto mat_mult = AddAxTasks<in_t, out_t>(tl, comm, md);
     return tl.AddTask(mat_mult, TF(&MGSolver::Jacobi<rhs, out_t, D, in_t, out_t>), this,
                       md, omega);
   }
@@ -335,37 +745,543 @@ class MGSolver {
     return tl.AddTask(jacobi3, TF(CopyData<temp, u, true>), md);
   }
 
+  // Fill x_t with a checkerboard pattern, the starting vector of the power iteration
+  template <class x_t>
+  TaskStatus SetCheckerboard(std::shared_ptr<MeshData<Real>> &md) {
+    using TE = parthenon::TopologicalElement;
+    TE te = TE::CC;
+    IndexRange ib = md->GetBoundsI(IndexDomain::interior, te);
+    IndexRange jb = md->GetBoundsJ(IndexDomain::interior, te);
+    IndexRange kb = md->GetBoundsK(IndexDomain::interior, te);
+
+    static auto desc = parthenon::MakePackDescriptor<x_t>(md.get());
+    auto pack = desc.GetPack(md.get(), false);
+    parthenon::par_for(
+        "SetCheckerboard", 0, pack.GetNBlocks() - 1, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+        KOKKOS_LAMBDA(const int b, const int k, const int j, const int i) {
+          const int nvars = pack.GetUpperBound(b, x_t()) - pack.GetLowerBound(b, x_t()) + 1;
+          for (int c = 0; c < nvars; ++c)
+            pack(b, te, x_t(c), k, j, i) = ((i + j + k) % 2 == 0) ? 1.0 : -1.0;
+        });
+    return TaskStatus::complete;
+  }
+
+  // One step x_t <- D^-1 Ax_t of the power iteration. If dots is given, (x_t, D^-1 Ax_t)
+  // and (x_t, x_t) of the old x_t are added to its values.
+  template <class Ax_t, class D_t, class x_t>
+  TaskStatus PowerIteration(std::shared_ptr<MeshData<Real>> &md,
+                            AllReduce<std::vector<Real>> *dots) {
+    using TE = parthenon::TopologicalElement;
+    TE te = TE::CC;
+    IndexRange ib = md->GetBoundsI(IndexDomain::interior, te);
+    IndexRange jb = md->GetBoundsJ(IndexDomain::interior, te);
+    IndexRange kb = md->GetBoundsK(IndexDomain::interior, te);
+
+    static auto desc = parthenon::MakePackDescriptor<Ax_t, D_t, x_t>(md.get());
+    auto pack = desc.GetPack(md.get(), false);
+    if (dots != nullptr) {
+      for (int n = 0; n < 2; ++n) {
+        const bool rayleigh = (n == 0);
+        Real sum = 0.0;
+        parthenon::par_reduce(
+            parthenon::loop_pattern_mdrange_tag, "PowerIterationDots", DevExecSpace(), 0,
+            pack.GetNBlocks() - 1, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+            KOKKOS_LAMBDA(const int b, const int k, const int j, const int i,
+                          Real &lsum) {
+              const int nvars =
+                  pack.GetUpperBound(b, x_t()) - pack.GetLowerBound(b, x_t()) + 1;
+              for (int c = 0; c < nvars; ++c) {
+                const Real x = pack(b, te, x_t(c), k, j, i);
+                const Real y = rayleigh ? robust::ratio(pack(b, te, Ax_t(c), k, j, i),
+                                                        pack(b, te, D_t(c), k, j, i))
+                                        : x;
+                lsum += x * y;
+              }
+            },
+            Kokkos::Sum<Real>(sum));
+        dots->val[n] += sum;
+      }
+    }
+    parthenon::par_for(
+        "PowerIteration", 0, pack.GetNBlocks() - 1, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+        KOKKOS_LAMBDA(const int b, const int k, const int j, const int i) {
+          const int nvars = pack.GetUpperBound(b, x_t()) - pack.GetLowerBound(b, x_t()) + 1;
+          for (int c = 0; c < nvars; ++c)
+            pack(b, te, x_t(c), k, j, i) =
+                robust::ratio(pack(b, te, Ax_t(c), k, j, i), pack(b, te, D_t(c), k, j, i));
+        });
+    return TaskStatus::complete;
+  }
+
+  // Estimate the largest eigenvalue of D^-1 A on every level with a few power
+  // iterations. This temporarily overwrites u (saved in u0), so the levels, which can
+  // share blocks, are done one after the other. Every list has to add the same regional
+  // tasks for every level, even if its partition does not exist on that level.
+  template <class TL_t>
+  TaskID AddEigenvalueEstimateTasks(TL_t &tl, TaskID dependence, int partition,
+                                    int min_level, int max_level, Mesh *pmesh) {
+    using namespace utils;
+    using reduction_t = AllReduce<std::vector<Real>>;
+    auto task_out = dependence;
+    for (int level = max_level; level >= min_level; --level) {
+      auto *estimate = &eigenvalue_estimates_[level];
+      auto zero = tl.AddTask(
+          TaskQualifier::once_per_region | TaskQualifier::local_sync, task_out,
+          [](reduction_t *estimate) {
+            estimate->val.assign(2, 0.0);
+            return TaskStatus::complete;
+          },
+          estimate);
+
+      auto power = zero;
+      auto partitions =
+          pmesh->GetDefaultBlockPartitions(GridIdentifier::two_level_composite(level));
+      if (partition < partitions.size()) {
+        auto &md = pmesh->mesh_data.Add("base", partitions[partition]);
+        auto &md_comm = pmesh->mesh_data.AddShallow(
+            "mg_comm", md, std::vector<std::string>{u::name(), res_err::name()});
+        const bool multilevel = (level != min_level);
+        if (!params_.time_independent_operator)
+          power = AddSetDiagonalTasks(tl, power, md);
+        power = tl.AddTask(power, TF(CopyData<u, u0, false>), md);
+        power = tl.AddTask(power, TF(&MGSolver::SetCheckerboard<u>), this, md);
+        for (int n = 0; n < params_.chebyshev_power_iterations; ++n) {
+          const bool last = (n == params_.chebyshev_power_iterations - 1);
+          power = AddBoundaryExchangeTasks<BoundaryType::gmg_same>(power, tl, md_comm,
+                                                                   multilevel);
+          power = AddAxTasks<u, temp>(tl, power, md);
+          power = tl.AddTask(power, TF(&MGSolver::PowerIteration<temp, D, u>), this, md,
+                             last ? estimate : nullptr);
+        }
+        power = tl.AddTask(power, TF(CopyData<u0, u, false>), md);
+      }
+
+      auto accumulated = tl.AddTask(TaskQualifier::local_sync, power,
+                                    []() { return TaskStatus::complete; });
+      auto start = tl.AddTask(TaskQualifier::once_per_region, accumulated,
+                              TF(&reduction_t::StartReduce), estimate, MPI_SUM);
+      task_out = tl.AddTask(TaskQualifier::once_per_region | TaskQualifier::local_sync,
+                            start, TF(&reduction_t::CheckReduce), estimate);
+    }
+    return task_out;
+  }
+
+  // Largest eigenvalue of D^-1 A on level as estimated during setup
+  Real GetEigenvalueEstimate(int level) const {
+    auto it = eigenvalue_estimates_.find(level);
+    PARTHENON_REQUIRE(it != eigenvalue_estimates_.end() && it->second.val.size() == 2,
+                      "Chebyshev smoothers require the MG setup tasks.");
+    return robust::ratio(it->second.val[0], it->second.val[1]);
+  }
+
+  // Stage of the Chebyshev smoother, updates x_t by
+  //   d <- c_d d + c_r D^-1 (rhs - Ax_t),  x_t <- x_t + d
+  // where the coefficients follow from the three term recurrence of the Chebyshev
+  // polynomials on the interval of targeted eigenvalues
+  template <class rhs_t, class Ax_t, class D_t, class d_t, class x_t>
+  TaskStatus ChebyshevStage(std::shared_ptr<MeshData<Real>> &md, int level, int stage) {
+    using TE = parthenon::TopologicalElement;
+    TE te = TE::CC;
+    IndexRange ib = md->GetBoundsI(IndexDomain::interior, te);
+    IndexRange jb = md->GetBoundsJ(IndexDomain::interior, te);
+    IndexRange kb = md->GetBoundsK(IndexDomain::interior, te);
+
+    const Real lambda = GetEigenvalueEstimate(level);
+    const Real lmax = params_.chebyshev_upper * lambda;
+    const Real lmin = params_.chebyshev_lower * lambda;
+    const Real theta = 0.5 * (lmax + lmin);
+    const Real delta = 0.5 * (lmax - lmin);
+    const Real sigma = theta / delta;
+    Real rho = 1.0 / sigma;
+    Real c_d = 0.0;
+    Real c_r = 1.0 / theta;
+    for (int s = 1; s <= stage; ++s) {
+      const Real rho_new = 1.0 / (2.0 * sigma - rho);
+      c_d = rho_new * rho;
+      c_r = 2.0 * rho_new / delta;
+      rho = rho_new;
+    }
+
+    // Only update the fine blocks, the coarse blocks of the composite grid only provide
+    // boundary values
+    static auto desc =
+        parthenon::MakePackDescriptor<rhs_t, Ax_t, D_t, d_t, x_t>(md.get());
+    auto pack = desc.GetPack(md.get());
+    parthenon::par_for(
+        "ChebyshevStage", 0, pack.GetNBlocks() - 1, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+        KOKKOS_LAMBDA(const int b, const int k, const int j, const int i) {
+          const int nvars = pack.GetUpperBound(b, x_t()) - pack.GetLowerBound(b, x_t()) + 1;
+          for (int c = 0; c < nvars; ++c) {
+            const Real r = robust::ratio(
+                pack(b, te, rhs_t(c), k, j, i) - pack(b, te, Ax_t(c), k, j, i),
+                pack(b, te, D_t(c), k, j, i));
+            Real &d = pack(b, te, d_t(c), k, j, i);
+            d = c_d * d + c_r * r;
+            pack(b, te, x_t(c), k, j, i) += d;
+          }
+        });
+    return TaskStatus::complete;
+  }
+
+  template <parthenon::BoundaryType comm_boundary, class TL_t>
+  TaskID AddChebyshevIteration(TL_t &tl, TaskID depends_on, int stages, int level,
+                               bool multilevel, std::shared_ptr<MeshData<Real>> &md,
+                               std::shared_ptr<MeshData<Real>> &md_comm) {
+    for (int stage = 0; stage < stages; ++stage) {
+      auto comm =
+          AddBoundaryExchangeTasks<comm_boundary>(depends_on, tl, md_comm, multilevel);
+      auto mat_mult = AddAxTasks<u, temp>(tl, comm, md);
+      depends_on = tl.AddTask(
+          mat_mult, TF(&MGSolver::ChebyshevStage<rhs, temp, D, cheb_d, u>), this, md,
+          level, stage);
+    }
+    return depends_on;
+  }
+
+  // Half sweep of the red-black Gauss-Seidel smoother, updates the cells of x_t with
+  // (i + j + k) % 2 == color by x_t <- x_t + w D^-1 (rhs - Ax_t). Blocks with an even
+  // number of cells in every direction agree on the colors at their boundaries,
+  // otherwise neighboring cells of the same color in different blocks are updated at the
+  // same time, which is still a convergent smoother.
+  template <class rhs_t, class Ax_t, class D_t, class x_t>
+  TaskStatus RedBlackStage(std::shared_ptr<MeshData<Real>> &md, int color) {
+    using TE = parthenon::TopologicalElement;
+    TE te = TE::CC;
+    IndexRange ib = md->GetBoundsI(IndexDomain::interior, te);
+    IndexRange jb = md->GetBoundsJ(IndexDomain::interior, te);
+    IndexRange kb = md->GetBoundsK(IndexDomain::interior, te);
+
+    const Real weight = params_.relaxation_weight;
+    static auto desc = parthenon::MakePackDescriptor<rhs_t, Ax_t, D_t, x_t>(md.get());
+    auto pack = desc.GetPack(md.get());
+    parthenon::par_for(
+        "RedBlackStage", 0, pack.GetNBlocks() - 1, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+        KOKKOS_LAMBDA(const int b, const int k, const int j, const int i) {
+          if ((i + j + k) % 2 != color) return;
+          const int nvars =
+              pack.GetUpperBound(b, x_t()) - pack.GetLowerBound(b, x_t()) + 1;
+          for (int c = 0; c < nvars; ++c) {
+            pack(b, te, x_t(c), k, j, i) +=
+                weight * robust::ratio(pack(b, te, rhs_t(c), k, j, i) -
+                                           pack(b, te, Ax_t(c), k, j, i),
+                                       pack(b, te, D_t(c), k, j, i));
+          }
+        });
+    return TaskStatus::complete;
+  }
+
+  template <parthenon::BoundaryType comm_boundary, class TL_t>
+  TaskID AddRedBlackIteration(TL_t &tl, TaskID depends_on, int stages, bool multilevel,
+                              std::shared_ptr<MeshData<Real>> &md,
+                              std::shared_ptr<MeshData<Real>> &md_comm) {
+    for (int stage = 0; stage < stages; ++stage) {
+      for (int color = 0; color < 2; ++color) {
+        auto comm =
+            AddBoundaryExchangeTasks<comm_boundary>(depends_on, tl, md_comm, multilevel);
+        auto mat_mult = AddAxTasks<u, temp>(tl, comm, md);
+        depends_on = tl.AddTask(mat_mult,
+                                TF(&MGSolver::RedBlackStage<rhs, temp, D, u>), this, md,
+                                color);
+      }
+    }
+    return depends_on;
+  }
+
+  // Sweep of the line smoother in direction dir, updates x_t by x_t <- x_t + w T^-1 r,
+  // where r = rhs - Ax_t and T is the tridiagonal part of A along the lines within the
+  // block, with the Thomas algorithm. Ax_t is overwritten with intermediate results.
+  template <class rhs_t, class Ax_t, class D_t, class lo_t, class up_t, class c_t,
+            class x_t>
+  TaskStatus LineStage(std::shared_ptr<MeshData<Real>> &md, int dir) {
+    using TE = parthenon::TopologicalElement;
+    TE te = TE::CC;
+    IndexRange ib = md->GetBoundsI(IndexDomain::interior, te);
+    IndexRange jb = md->GetBoundsJ(IndexDomain::interior, te);
+    IndexRange kb = md->GetBoundsK(IndexDomain::interior, te);
+    // Range along the lines and the two transverse ranges
+    const IndexRange lb = dir == X1DIR ? ib : (dir == X2DIR ? jb : kb);
+    const IndexRange pb = dir == X3DIR ? jb : kb;
+    const IndexRange qb = dir == X1DIR ? jb : ib;
+
+    const Real weight = params_.relaxation_weight;
+    static auto desc =
+        parthenon::MakePackDescriptor<rhs_t, Ax_t, D_t, lo_t, up_t, c_t, x_t>(md.get());
+    auto pack = desc.GetPack(md.get());
+    parthenon::par_for(
+        "LineStage", 0, pack.GetNBlocks() - 1, pb.s, pb.e, qb.s, qb.e,
+        KOKKOS_LAMBDA(const int b, const int p, const int q) {
+          // Cell at position l along the line
+          auto cell = [&](const int l, int &k, int &j, int &i) {
+            k = dir == X3DIR ? l : p;
+            j = dir == X2DIR ? l : (dir == X3DIR ? p : q);
+            i = dir == X1DIR ? l : q;
+          };
+          const int nvars =
+              pack.GetUpperBound(b, x_t()) - pack.GetLowerBound(b, x_t()) + 1;
+          for (int c = 0; c < nvars; ++c) {
+            int k, j, i;
+            // Forward elimination, storing the modified right hand side in Ax_t
+            Real c_prev = 0.0;
+            Real d_prev = 0.0;
+            for (int l = lb.s; l <= lb.e; ++l) {
+              cell(l, k, j, i);
+              const Real lo = l > lb.s ? pack(b, te, lo_t(c), k, j, i) : 0.0;
+              const Real m = pack(b, te, D_t(c), k, j, i) - lo * c_prev;
+              const Real r =
+                  pack(b, te, rhs_t(c), k, j, i) - pack(b, te, Ax_t(c), k, j, i);
+              c_prev = robust::ratio(pack(b, te, up_t(c), k, j, i), m);
+              d_prev = robust::ratio(r - lo * d_prev, m);
+              pack(b, te, c_t(c), k, j, i) = c_prev;
+              pack(b, te, Ax_t(c), k, j, i) = d_prev;
+            }
+            // Back substitution and update
+            Real dx = 0.0;
+            for (int l = lb.e; l >= lb.s; --l) {
+              cell(l, k, j, i);
+              dx = pack(b, te, Ax_t(c), k, j, i) -
+                   (l < lb.e ? pack(b, te, c_t(c), k, j, i) * dx : 0.0);
+              pack(b, te, x_t(c), k, j, i) += weight * dx;
+            }
+          }
+        });
+    return TaskStatus::complete;
+  }
+
+  template <parthenon::BoundaryType comm_boundary, class TL_t>
+  TaskID AddLineIteration(TL_t &tl, TaskID depends_on, int stages, bool multilevel,
+                          std::shared_ptr<MeshData<Real>> &md,
+                          std::shared_ptr<MeshData<Real>> &md_comm) {
+    const int ndim = md->GetParentPointer()->ndim;
+    PARTHENON_REQUIRE(params_.line_direction <= ndim,
+                      "line_direction exceeds the number of dimensions.");
+    for (int stage = 0; stage < stages; ++stage) {
+      const int dir =
+          params_.line_direction > 0 ? params_.line_direction : stage % ndim + 1;
+      auto comm =
+          AddBoundaryExchangeTasks<comm_boundary>(depends_on, tl, md_comm, multilevel);
+      auto coeffs = AddLineCoefficientTasks(tl, comm, md, dir);
+      auto mat_mult = AddAxTasks<u, temp>(tl, comm, md);
+      depends_on = tl.AddTask(
+          mat_mult | coeffs,
+          TF(&MGSolver::LineStage<rhs, temp, D, line_lo, line_up, line_c, u>), this, md,
+          dir);
+    }
+    return depends_on;
+  }
+
+  // A x_t -> y_t with the stored stencil if there is one and the equations otherwise
+  template <class x_t, class y_t, class TL_t>
+  TaskID AddAxTasks(TL_t &tl, TaskID depends_on, std::shared_ptr<MeshData<Real>> &md) {
+    if (params_.stencil_points > 0)
+      return tl.AddTask(depends_on, TF(utils::StoredStencilAx<stencil, x_t, y_t>), md);
+    return eqs_.template Ax<x_t, y_t>(tl, depends_on, md);
+  }
+
+  template <class TL_t>
+  TaskID AddSetDiagonalTasks(TL_t &tl, TaskID depends_on,
+                             std::shared_ptr<MeshData<Real>> &md) {
+    if (params_.stencil_points > 0)
+      return tl.AddTask(depends_on, TF(utils::StoredStencilDiagonal<stencil, D>), md);
+    return tl.AddTask(depends_on, TF(&equations::template SetDiagonal<D>), &eqs_, md);
+  }
+
+  template <class TL_t>
+  TaskID AddLineCoefficientTasks(TL_t &tl, TaskID depends_on,
+                                 std::shared_ptr<MeshData<Real>> &md, int dir) {
+    if (params_.stencil_points > 0)
+      return tl.AddTask(
+          depends_on,
+          TF(utils::StoredStencilLineCoefficients<stencil, line_lo, line_up>), md, dir);
+    if constexpr (implements<has_line_coefficients(equations)>::value)
+      return tl.AddTask(depends_on,
+                        TF(&equations::template SetLineCoefficients<line_lo, line_up>),
+                        &eqs_, md, dir);
+    return depends_on;
+  }
+
+  // Assemble the stored stencil of a level or, with galerkin, replace it on the internal
+  // blocks by the Galerkin stencil restricted from the next finer level
+  template <class TL_t>
+  TaskID AddSetStencilTasks(TL_t &tl, TaskID depends_on,
+                            std::shared_ptr<MeshData<Real>> &md, bool galerkin) {
+    using namespace utils;
+    if (galerkin)
+      return tl.AddTask(depends_on, TF(SetGalerkinStencil<stencil_g, stencil>), md,
+                        params_.galerkin_coupling_scale);
+    if constexpr (implements<has_stencil(equations)>::value)
+      return tl.AddTask(depends_on, TF(&equations::template SetStencil<stencil>), &eqs_,
+                        md, params_.stencil_points);
+    return depends_on;
+  }
+
+  // Restriction of the first full multigrid pass, the down leg of a FAS V-cycle without
+  // smoothing, which sets u0 and rhs on all coarser levels
+  TaskID AddFMGRestrictionTasks(TaskList &tl, TaskID dependence, int partition,
+                                int level, int min_level, int max_level, Mesh *pmesh) {
+    using namespace utils;
+    auto partitions =
+        pmesh->GetDefaultBlockPartitions(GridIdentifier::two_level_composite(level));
+    if (partition >= partitions.size()) return dependence;
+    auto &md = pmesh->mesh_data.Add("base", partitions[partition]);
+    auto &md_comm = pmesh->mesh_data.AddShallow(
+        "mg_comm", md, std::vector<std::string>{u::name(), res_err::name()});
+    const bool multilevel = (level != min_level);
+
+    auto task = dependence;
+    if (level < max_level) {
+      task = tl.AddTask(task, TF(ReceiveBoundBufs<BoundaryType::gmg_restrict_recv>),
+                        md_comm);
+      task = tl.AddTask(task, TF(SetBounds<BoundaryType::gmg_restrict_recv>), md_comm);
+      task = tl.AddTask(task, TF(CopyData<u, u0, true>), md);
+    }
+    if (level > min_level || level < max_level) {
+      task = AddBoundaryExchangeTasks<BoundaryType::gmg_same>(task, tl, md_comm,
+                                                              multilevel);
+      task = AddAxTasks<u, temp>(tl, task, md);
+    }
+    // rhs <- A u0 + restricted residual on the internal blocks
+    if (level < max_level)
+      task = tl.AddTask(task,
+                        TF(AddFieldsAndStoreInteriorSelect<temp, res_err, rhs, true>), md,
+                        1.0, 1.0, true);
+    if (level > min_level) {
+      task = tl.AddTask(task,
+                        TF(AddFieldsAndStoreInteriorSelect<rhs, temp, res_err, true>), md,
+                        1.0, -1.0, false);
+      task = tl.AddTask(TaskQualifier::high_priority, task,
+                        TF(SendBoundBufs<BoundaryType::gmg_restrict_send>), md_comm);
+    }
+    return task;
+  }
+
+  // Prolongation of the correction u - u0 of the full multigrid cycle from level to the
+  // next finer level, as in the up leg of a FAS V-cycle
+  TaskID AddFMGProlongationTasks(TaskList &tl, TaskID dependence, int partition,
+                                 int level, int min_level, Mesh *pmesh) {
+    using namespace utils;
+    TaskID out = dependence;
+    auto coarse_partitions =
+        pmesh->GetDefaultBlockPartitions(GridIdentifier::two_level_composite(level));
+    if (partition < coarse_partitions.size()) {
+      auto &md = pmesh->mesh_data.Add("base", coarse_partitions[partition]);
+      auto &md_comm = pmesh->mesh_data.AddShallow(
+          "mg_comm", md, std::vector<std::string>{u::name(), res_err::name()});
+      auto task = tl.AddTask(dependence, TF(AddFieldsAndStore<u, u0, res_err, true>), md,
+                             1.0, -1.0);
+      // The boundaries of res_err have to be up to date for the prolongation
+      task = tl.AddTask(task, TF(CopyData<u, temp, false>), md);
+      task = tl.AddTask(task, TF(CopyData<res_err, u, false>), md);
+      task = AddBoundaryExchangeTasks<BoundaryType::gmg_same>(task, tl, md_comm,
+                                                              level != min_level);
+      task = tl.AddTask(task, TF(CopyData<u, res_err, true>), md);
+      task = tl.AddTask(task, TF(CopyData<temp, u, false>), md);
+      out = out | tl.AddTask(TaskQualifier::high_priority, task,
+                             TF(SendBoundBufs<BoundaryType::gmg_prolongate_send>), md);
+    }
+    auto fine_partitions =
+        pmesh->GetDefaultBlockPartitions(GridIdentifier::two_level_composite(level + 1));
+    if (partition < fine_partitions.size()) {
+      auto &md = pmesh->mesh_data.Add("base", fine_partitions[partition]);
+      auto &md_comm = pmesh->mesh_data.AddShallow(
+          "mg_comm", md, std::vector<std::string>{u::name(), res_err::name()});
+      auto task = tl.AddTask(
+          dependence, TF(ReceiveBoundBufs<BoundaryType::gmg_prolongate_recv>), md_comm);
+      task = tl.AddTask(task, TF(SetBounds<BoundaryType::gmg_prolongate_recv>), md_comm);
+      task = tl.AddTask(task, TF(ProlongateBounds<BoundaryType::gmg_prolongate_recv>),
+                        md_comm);
+      out = out |
+            tl.AddTask(task, TF(AddFieldsAndStore<u, res_err, u, true>), md, 1.0, 1.0);
+    }
+    return out;
+  }
+
+  // u <- the last solution, or the linear extrapolation of the last two, if they were
+  // computed on the current block list
+  TaskID AddWarmStartTasks(TaskList &tl, TaskID dependence,
+                           std::shared_ptr<MeshData<Real>> &md, Mesh *pmesh) {
+    using namespace utils;
+    const std::size_t generation = pmesh->GetBlockListGeneration();
+    if (generation != warm_start_generation_) {
+      warm_start_generation_ = generation;
+      num_prev_solutions_ = 0;
+    }
+    if (num_prev_solutions_ == 0) return dependence;
+    if (num_prev_solutions_ == 1 || params_.warm_start == "previous")
+      return tl.AddTask(dependence, TF(CopyData<u_prev1, u>), md);
+    // Equally spaced solves unless all times are known
+    Real w = 1.0;
+    if (std::isfinite(solve_time_) && std::isfinite(prev_solve_times_[0]) &&
+        std::isfinite(prev_solve_times_[1]) &&
+        prev_solve_times_[0] != prev_solve_times_[1])
+      w = (solve_time_ - prev_solve_times_[0]) /
+          (prev_solve_times_[0] - prev_solve_times_[1]);
+    return tl.AddTask(dependence, TF(AddFieldsAndStore<u_prev1, u_prev2, u>), md,
+                      1.0 + w, -w);
+  }
+
+  TaskID AddStoreSolutionTasks(TaskList &tl, TaskID dependence,
+                               std::shared_ptr<MeshData<Real>> &md) {
+    using namespace utils;
+    auto store = dependence;
+    if (params_.warm_start == "extrapolate")
+      store = tl.AddTask(store, TF(CopyData<u_prev1, u_prev2>), md);
+    store = tl.AddTask(store, TF(CopyData<u, u_prev1>), md);
+    return tl.AddTask(
+        TaskQualifier::once_per_region | TaskQualifier::local_sync, store,
+        "store solution",
+        [](MGSolver *solver) {
+          solver->num_prev_solutions_ = std::min(solver->num_prev_solutions_ + 1, 2);
+          solver->prev_solve_times_[1] = solver->prev_solve_times_[0];
+          solver->prev_solve_times_[0] = solver->solve_time_;
+          solver->solve_time_ = std::numeric_limits<Real>::quiet_NaN();
+          return TaskStatus::complete;
+        },
+        this);
+  }
+
   template <class TL_t>
   TaskID AddMultiGridSetupPartitionLevel(TL_t &tl, TaskID dependence, int partition,
                                          int level, int min_level, int max_level,
-                                         Mesh *pmesh) {
+                                         Mesh *pmesh, bool set_diagonal = false,
+                                         bool set_stencil = false) {
     using namespace utils;
 
     auto partitions =
         pmesh->GetDefaultBlockPartitions(GridIdentifier::two_level_composite(level));
     if (partition >= partitions.size()) return dependence;
     auto &md = pmesh->mesh_data.Add("base", partitions[partition]);
+    const bool galerkin = set_stencil && params_.galerkin_coarse_operator;
 
+    // The stencil is assembled on all blocks and then replaced on the internal blocks
+    // by the Galerkin stencil restricted from the finer level
     auto task_out = dependence;
+    if (set_stencil) task_out = AddSetStencilTasks(tl, task_out, md, false);
     if (level < max_level) {
       task_out =
           tl.AddTask(task_out, TF(ReceiveBoundBufs<BoundaryType::gmg_restrict_recv>), md);
       task_out = tl.AddTask(task_out, TF(SetBounds<BoundaryType::gmg_restrict_recv>), md);
+      if (galerkin) task_out = AddSetStencilTasks(tl, task_out, md, true);
     }
+    if (set_diagonal) task_out = AddSetDiagonalTasks(tl, task_out, md);
 
     // If we are finer than the coarsest level:
     if (level > min_level) {
-      task_out =
-          tl.AddTask(task_out, TF(SendBoundBufs<BoundaryType::gmg_restrict_send>), md);
+      if (galerkin)
+        task_out =
+            tl.AddTask(task_out, TF(GalerkinContributions<stencil, stencil_g>), md);
+      task_out = tl.AddTask(TaskQualifier::high_priority, task_out,
+                            TF(SendBoundBufs<BoundaryType::gmg_restrict_send>), md);
     }
 
     // The boundaries are not up to date on return
     return task_out;
   }
 
+  // With fmg_top, u0 of max_level keeps the restriction of the finer solution from the
+  // start of the full multigrid cycle
   TaskID AddMultiGridTasksPartitionLevel(TaskList &tl, TaskID dependence, int partition,
                                          int level, int min_level, int max_level,
-                                         Mesh *pmesh) {
+                                         Mesh *pmesh, bool fmg_top = false) {
     using namespace utils;
     auto smoother = params_.smoother;
     bool do_FAS = params_.do_FAS;
@@ -382,6 +1298,15 @@ class MGSolver {
     } else if (smoother == "SRJ3") {
       pre_stages = 3;
       post_stages = 3;
+    } else if (params_.ChebyshevStages() > 0) {
+      pre_stages = params_.ChebyshevStages();
+      post_stages = pre_stages;
+    } else if (params_.RedBlackStages() > 0) {
+      pre_stages = params_.RedBlackStages();
+      post_stages = pre_stages;
+    } else if (params_.LineStages() > 0) {
+      pre_stages = params_.LineStages();
+      post_stages = pre_stages;
     } else {
       PARTHENON_FAIL("Unknown solver type.");
     }
@@ -403,14 +1328,34 @@ class MGSolver {
     auto &md_comm = pmesh->mesh_data.AddShallow(
         "mg_comm", md, std::vector<std::string>{u::name(), res_err::name()});
 
+    auto smooth = [&](TaskID depends_on, int stages) {
+      if (params_.ChebyshevStages() > 0)
+        return AddChebyshevIteration<BoundaryType::gmg_same>(tl, depends_on, stages, level,
+                                                             multilevel, md, md_comm);
+      if (params_.RedBlackStages() > 0)
+        return AddRedBlackIteration<BoundaryType::gmg_same>(tl, depends_on, stages,
+                                                            multilevel, md, md_comm);
+      if (params_.LineStages() > 0)
+        return AddLineIteration<BoundaryType::gmg_same>(tl, depends_on, stages,
+                                                        multilevel, md, md_comm);
+      return AddSRJIteration<BoundaryType::gmg_same>(tl, depends_on, stages, multilevel,
+                                                     md, md_comm);
+    };
+    auto timed = [&](Phase phase, TaskID depends_on, auto &&add) {
+      return AddTimedPhase(tl, depends_on, phase, level, partition, add);
+    };
+
     // 0. Receive residual from coarser level if there is one
     auto set_from_finer = dependence;
     if (level < max_level) {
       // Fill fields with restricted values
-      auto recv_from_finer = tl.AddTask(
-          dependence, TF(ReceiveBoundBufs<BoundaryType::gmg_restrict_recv>), md_comm);
-      set_from_finer = tl.AddTask(
-          recv_from_finer, BTF(SetBounds<BoundaryType::gmg_restrict_recv>), md_comm);
+      auto recv_from_finer = timed(Phase::restriction, dependence, [&](TaskID start) {
+        auto recv = tl.AddTask(
+            start, TF(ReceiveBoundBufs<BoundaryType::gmg_restrict_recv>), md_comm);
+        return tl.AddTask(recv, BTF(SetBounds<BoundaryType::gmg_restrict_recv>),
+                          md_comm);
+      });
+      set_from_finer = recv_from_finer;
       // 1. Copy residual from dual purpose communication field to the rhs, should be
       // actual RHS for finest level
       if (!do_FAS) {
@@ -422,62 +1367,74 @@ class MGSolver {
         // to make sure that the boundaries of the restricted u are up to date before
         // calling Ax. That being said, at least in one case commenting this line out
         // didn't seem to impact the solution.
-        set_from_finer = AddBoundaryExchangeTasks<BoundaryType::gmg_same>(
-            set_from_finer, tl, md_comm, multilevel);
+        set_from_finer =
+            timed(Phase::boundary_exchange, set_from_finer, [&](TaskID start) {
+              return AddBoundaryExchangeTasks<BoundaryType::gmg_same>(start, tl, md_comm,
+                                                                      multilevel);
+            });
         set_from_finer = tl.AddTask(set_from_finer, BTF(CopyData<u, u0, true>), md);
         // This should set the rhs only in blocks that correspond to interior nodes, the
         // RHS of leaf blocks that are on this GMG level should have already been set on
         // entry into multigrid
-        set_from_finer = eqs_.template Ax<u, temp>(tl, set_from_finer, md);
+        set_from_finer = AddAxTasks<u, temp>(tl, set_from_finer, md);
         set_from_finer =
             tl.AddTask(set_from_finer,
                        BTF(AddFieldsAndStoreInteriorSelect<temp, res_err, rhs, true>), md,
                        1.0, 1.0, true);
       }
-    } else {
+    } else if (!fmg_top) {
       set_from_finer = tl.AddTask(set_from_finer, BTF(CopyData<u, u0, true>), md);
     }
 
     // 2. Do pre-smooth and fill solution on this level
-    set_from_finer =
-        tl.AddTask(set_from_finer, BTF(&equations::template SetDiagonal<D>), &eqs_, md);
-    auto pre_smooth = AddSRJIteration<BoundaryType::gmg_same>(
-        tl, set_from_finer, pre_stages, multilevel, md, md_comm);
+    if (!params_.time_independent_operator)
+      set_from_finer = AddSetDiagonalTasks(tl, set_from_finer, md);
+    // Smoothing on the coarsest level is its solve
+    const auto smoothing = multilevel ? Phase::smoothing : Phase::coarse_solve;
+    auto pre_smooth = timed(smoothing, set_from_finer,
+                            [&](TaskID start) { return smooth(start, pre_stages); });
     // If we are finer than the coarsest level:
     auto post_smooth = pre_smooth;
     if (level > min_level) {
       // 3. Communicate same level boundaries so that u is up to date everywhere
-      auto comm_u = AddBoundaryExchangeTasks<BoundaryType::gmg_same>(pre_smooth, tl,
-                                                                     md_comm, multilevel);
-
-      // 4. Caclulate residual and store in communication field
-      auto residual = eqs_.template Ax<u, temp>(tl, comm_u, md);
-      residual = tl.AddTask(
-          residual, BTF(AddFieldsAndStoreInteriorSelect<rhs, temp, res_err, true>), md,
-          1.0, -1.0, false);
-
-      // 5. Restrict communication field and send to next level
-      auto communicate_to_coarse = tl.AddTask(
-          residual, BTF(SendBoundBufs<BoundaryType::gmg_restrict_send>), md_comm);
-
-      // 6. Receive error field into communication field and prolongate
-      auto recv_from_coarser =
-          tl.AddTask(communicate_to_coarse,
-                     TF(ReceiveBoundBufs<BoundaryType::gmg_prolongate_recv>), md_comm);
-      auto set_from_coarser = tl.AddTask(
-          recv_from_coarser, BTF(SetBounds<BoundaryType::gmg_prolongate_recv>), md_comm);
-      auto prolongate =
-          tl.AddTask(set_from_coarser,
-                     BTF(ProlongateBounds<BoundaryType::gmg_prolongate_recv>), md_comm);
-
-      // 7. Correct solution on this level with res_err field and store in
-      //    communication field
-      auto update_sol = tl.AddTask(
-          prolongate, BTF(AddFieldsAndStore<u, res_err, u, true>), md, 1.0, 1.0);
+      auto comm_u = timed(Phase::boundary_exchange, pre_smooth, [&](TaskID start) {
+        return AddBoundaryExchangeTasks<BoundaryType::gmg_same>(start, tl, md_comm,
+                                                                multilevel);
+      });
+
+      auto communicate_to_coarse = timed(Phase::restriction, comm_u, [&](TaskID start) {
+        // 4. Caclulate residual and store in communication field
+        auto residual = AddAxTasks<u, temp>(tl, start, md);
+        residual = tl.AddTask(
+            residual, BTF(AddFieldsAndStoreInteriorSelect<rhs, temp, res_err, true>), md,
+            1.0, -1.0, false);
+
+        // 5. Restrict communication field and send to next level
+        return tl.AddTask(TaskQualifier::high_priority, residual,
+                          BTF(SendBoundBufs<BoundaryType::gmg_restrict_send>), md_comm);
+      });
+
+      auto update_sol =
+          timed(Phase::prolongation, communicate_to_coarse, [&](TaskID start) {
+            // 6. Receive error field into communication field and prolongate
+            auto recv_from_coarser = tl.AddTask(
+                start, TF(ReceiveBoundBufs<BoundaryType::gmg_prolongate_recv>), md_comm);
+            auto set_from_coarser =
+                tl.AddTask(recv_from_coarser,
+                           BTF(SetBounds<BoundaryType::gmg_prolongate_recv>), md_comm);
+            auto prolongate = tl.AddTask(
+                set_from_coarser,
+                BTF(ProlongateBounds<BoundaryType::gmg_prolongate_recv>), md_comm);
+
+            // 7. Correct solution on this level with res_err field and store in
+            //    communication field
+            return tl.AddTask(prolongate, BTF(AddFieldsAndStore<u, res_err, u, true>),
+                              md, 1.0, 1.0);
+          });
 
       // 8. Post smooth using communication field and stored RHS
-      post_smooth = AddSRJIteration<BoundaryType::gmg_same>(tl, update_sol, post_stages,
-                                                            multilevel, md, md_comm);
+      post_smooth = timed(Phase::smoothing, update_sol,
+                          [&](TaskID start) { return smooth(start, post_stages); });
 
     } else {
       post_smooth = tl.AddTask(pre_smooth, BTF(CopyData<u, res_err, true>), md);
@@ -499,12 +1456,16 @@ class MGSolver {
       // prolongation
       copy_over = tl.AddTask(copy_over, BTF(CopyData<u, temp, false>), md);
       copy_over = tl.AddTask(copy_over, BTF(CopyData<res_err, u, false>), md);
-      auto boundary = AddBoundaryExchangeTasks<BoundaryType::gmg_same>(
-          copy_over, tl, md_comm, multilevel);
+      auto boundary = timed(Phase::boundary_exchange, copy_over, [&](TaskID start) {
+        return AddBoundaryExchangeTasks<BoundaryType::gmg_same>(start, tl, md_comm,
+                                                                multilevel);
+      });
       auto copy_back = tl.AddTask(boundary, BTF(CopyData<u, res_err, true>), md);
       copy_back = tl.AddTask(copy_back, BTF(CopyData<temp, u, false>), md);
-      last_task = tl.AddTask(copy_back,
-                             BTF(SendBoundBufs<BoundaryType::gmg_prolongate_send>), md);
+      last_task = timed(Phase::prolongation, copy_back, [&](TaskID start) {
+        return tl.AddTask(TaskQualifier::high_priority, start,
+                          BTF(SendBoundBufs<BoundaryType::gmg_prolongate_send>), md);
+      });
     }
     // The boundaries are not up to date on return
     return last_task;
@@ -0,0 +1,306 @@
+//========================================================================================
+// (C) (or copyright) 2023-2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef SOLVERS_PIPELINED_CG_SOLVER_HPP_
+#define SOLVERS_PIPELINED_CG_SOLVER_HPP_
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "interface/mesh_data.hpp"
+#include "interface/meshblock_data.hpp"
+#include "interface/state_descriptor.hpp"
+#include "kokkos_abstraction.hpp"
+#include "solvers/mg_solver.hpp"
+#include "solvers/solver_utils.hpp"
+
+#include "tasks/tasks.hpp"
+
+namespace parthenon {
+
+namespace solvers {
+
+struct PipelinedCGParams {
+  MGParams mg_params;
+  int max_iters = 1000;
+  std::shared_ptr<Real> residual_tolerance = std::make_shared<Real>(1.e-12);
+  bool precondition = true;
+  bool print_per_step = false;
+  bool relative_residual = false;
+  PipelinedCGParams() = default;
+  PipelinedCGParams(ParameterInput *pin, const std::string &input_block) {
+    max_iters = pin->GetOrAddInteger(input_block, "max_iterations", max_iters);
+    *residual_tolerance =
+        pin->GetOrAddReal(input_block, "residual_tolerance", *residual_tolerance);
+    precondition = pin->GetOrAddBoolean(input_block, "precondition", precondition);
+    print_per_step = pin->GetOrAddBoolean(input_block, "print_per_step", print_per_step);
+    mg_params = MGParams(pin, input_block);
+    relative_residual =
+        pin->GetOrAddBoolean(input_block, "relative_residual", relative_residual);
+  }
+};
+
+// Preconditioned pipelined conjugate gradient method (Ghysels & Vanroose 2014) for
+// symmetric positive definite A (and M). All inner products of an iteration are
+// combined into a single non-blocking reduction, which is overlapped with the
+// application of the preconditioner and the matrix. This makes the method suited for
+// runs in which the solver is bound by the latency of global reductions rather than by
+// the cost of applying A, at the cost of a few more vectors and less favorable rounding
+// errors than standard CG.
+//
+// The equations class must include a template method
+//
+//   template <class x_t, class y_t, class TL_t>
+//   TaskID Ax(TL_t &tl, TaskID depends_on, std::shared_ptr<MeshData<Real>> &md)
+//
+// that takes a field associated with x_t and applies
+// the matrix A to it and stores the result in y_t.
+template <class u, class rhs, class equations>
+class PipelinedCGSolver {
+ public:
+  // Names follow Ghysels & Vanroose, except that the preconditioned residual (u there)
+  // is called pr, since u is used to apply the preconditioner and the matrix
+  PARTHENON_INTERNALSOLVERVARIABLE(u, x);
+  PARTHENON_INTERNALSOLVERVARIABLE(u, r);
+  PARTHENON_INTERNALSOLVERVARIABLE(u, pr);
+  PARTHENON_INTERNALSOLVERVARIABLE(u, w);
+  PARTHENON_INTERNALSOLVERVARIABLE(u, m);
+  PARTHENON_INTERNALSOLVERVARIABLE(u, n);
+  PARTHENON_INTERNALSOLVERVARIABLE(u, z);
+  PARTHENON_INTERNALSOLVERVARIABLE(u, q);
+  PARTHENON_INTERNALSOLVERVARIABLE(u, s);
+  PARTHENON_INTERNALSOLVERVARIABLE(u, p);
+
+  std::vector<std::string> GetInternalVariableNames() const {
+    std::vector<std::string> names{x::name(), r::name(), pr::name(), w::name(),
+                                   m::name(), n::name(), z::name(),  q::name(),
+                                   s::name(), p::name()};
+    if (params_.precondition) {
+      auto pre_names = preconditioner.GetInternalVariableNames();
+      names.insert(names.end(), pre_names.begin(), pre_names.end());
+    }
+    return names;
+  }
+
+  PipelinedCGSolver(StateDescriptor *pkg, PipelinedCGParams params_in,
+                    equations eq_in = equations(), std::vector<int> shape = {})
+      : preconditioner(pkg, params_in.mg_params, eq_in, shape), params_(params_in),
+        iter_counter(0), eqs_(eq_in) {
+    auto m_no_ghost =
+        Metadata({Metadata::Cell, Metadata::Derived, Metadata::OneCopy}, shape);
+    for (const auto &name : {x::name(), r::name(), pr::name(), w::name(), m::name(),
+                             n::name(), z::name(), q::name(), s::name(), p::name()})
+      pkg->AddField(name, m_no_ghost);
+  }
+
+  template <class TL_t>
+  TaskID AddSetupTasks(TL_t &tl, TaskID dependence, int partition, Mesh *pmesh) {
+    return preconditioner.AddSetupTasks(tl, dependence, partition, pmesh);
+  }
+
+  TaskID AddTasks(TaskList &tl, TaskID dependence, Mesh *pmesh, const int partition) {
+    using namespace utils;
+    TaskID none;
+    auto &md =
+        pmesh->mesh_data.GetOrAdd(pmesh->mesh_data.GetStageHandle("base"), partition);
+    std::string label = "pcg_comm_" + std::to_string(partition);
+    auto &md_comm =
+        pmesh->mesh_data.AddShallow(label, md, std::vector<std::string>{u::name()});
+    iter_counter = 0;
+    bool multilevel = pmesh->multilevel;
+
+    // Initialization: x <- 0, r <- rhs, pr <- M r, w <- A pr, z, q, s, p <- 0
+    auto zero_x = tl.AddTask(dependence, TF(SetToZero<x>), md);
+    auto zero_z = tl.AddTask(dependence, TF(SetToZero<z>), md);
+    auto zero_q = tl.AddTask(dependence, TF(SetToZero<q>), md);
+    auto zero_s = tl.AddTask(dependence, TF(SetToZero<s>), md);
+    auto zero_p = tl.AddTask(dependence, TF(SetToZero<p>), md);
+    auto copy_r = tl.AddTask(dependence, TF(CopyData<rhs, r>), md);
+    auto get_rhs2 = none;
+    if (params_.relative_residual)
+      get_rhs2 = DotProduct<rhs, rhs>(dependence, tl, &rhs2, md);
+    auto precon0 = AddPreconditionerTasks<r>(tl, copy_r | get_rhs2, partition, pmesh, md);
+    auto copy_pr = tl.AddTask(precon0, TF(CopyData<u, pr>), md);
+    auto comm0 =
+        AddBoundaryExchangeTasks<BoundaryType::any>(precon0, tl, md_comm, multilevel);
+    auto get_w = eqs_.template Ax<u, w>(tl, comm0, md);
+    auto initialize = tl.AddTask(
+        TaskQualifier::once_per_region | TaskQualifier::local_sync,
+        zero_x | zero_z | zero_q | zero_s | zero_p | copy_pr | get_w, "zero factors",
+        [](PipelinedCGSolver *solver) {
+          solver->iter_counter = -1;
+          return TaskStatus::complete;
+        },
+        this);
+    tl.AddTask(
+        TaskQualifier::once_per_region, initialize, "print to screen",
+        [&](PipelinedCGSolver *solver, std::shared_ptr<Real> res_tol,
+            bool relative_residual) {
+          if (Globals::my_rank == 0 && params_.print_per_step) {
+            Real tol =
+                relative_residual
+                    ? *res_tol * std::sqrt(solver->rhs2.val / pmesh->GetTotalCells())
+                    : *res_tol;
+            printf("# [0] iteration\n# [1] rms-residual (tol = %e) \n", tol);
+          }
+          return TaskStatus::complete;
+        },
+        this, params_.residual_tolerance, params_.relative_residual);
+
+    // BEGIN ITERATIVE TASKS
+    auto [itl, solver_id] = tl.AddSublist(initialize, {1, params_.max_iters});
+
+    auto sync = itl.AddTask(TaskQualifier::local_sync, none,
+                            []() { return TaskStatus::complete; });
+    auto reset = itl.AddTask(
+        TaskQualifier::once_per_region, sync, "update values",
+        [](PipelinedCGSolver *solver) {
+          solver->iter_counter++;
+          return TaskStatus::complete;
+        },
+        this);
+
+    // 1. gamma <- (r, pr), delta <- (w, pr), and (r, r) in a single reduction, which is
+    //    only waited for once m and n are known
+    auto zero_dots = itl.AddTask(
+        TaskQualifier::once_per_region | TaskQualifier::local_sync, reset,
+        [](AllReduce<std::vector<Real>> *dots) {
+          dots->val.assign(3, 0.0);
+          return TaskStatus::complete;
+        },
+        &dots);
+    auto get_dots = itl.AddTask(
+        TaskQualifier::local_sync, zero_dots, "local dot products",
+        [](AllReduce<std::vector<Real>> *dots, std::shared_ptr<MeshData<Real>> &md) {
+          AccumulateDotProduct<r, pr>(md, &dots->val[0]);
+          AccumulateDotProduct<w, pr>(md, &dots->val[1]);
+          return AccumulateDotProduct<r, r>(md, &dots->val[2]);
+        },
+        &dots, md);
+    auto start_dots = itl.AddTask(TaskQualifier::once_per_region, get_dots,
+                                  &AllReduce<std::vector<Real>>::StartReduce, &dots,
+                                  MPI_SUM);
+    auto finish_dots =
+        itl.AddTask(TaskQualifier::once_per_region | TaskQualifier::local_sync,
+                    start_dots, &AllReduce<std::vector<Real>>::CheckReduce, &dots);
+
+    // 2. m <- M w
+    auto precon = AddPreconditionerTasks<w>(itl, reset, partition, pmesh, md);
+    auto copy_m = itl.AddTask(precon, TF(CopyData<u, m>), md);
+
+    // 3. n <- A m
+    auto comm =
+        AddBoundaryExchangeTasks<BoundaryType::any>(precon, itl, md_comm, multilevel);
+    auto get_n = eqs_.template Ax<u, n>(itl, comm, md);
+
+    // 4. beta <- gamma / gamma_old, alpha <- gamma / (delta - beta gamma / alpha_old)
+    auto get_scalars = itl.AddTask(
+        TaskQualifier::once_per_region | TaskQualifier::local_sync, finish_dots,
+        "alpha, beta",
+        [](PipelinedCGSolver *solver) {
+          const Real gamma = solver->dots.val[0];
+          const Real delta = solver->dots.val[1];
+          if (solver->iter_counter == 0) {
+            solver->beta = 0.0;
+            solver->alpha = gamma / delta;
+          } else {
+            solver->beta = gamma / solver->gamma_old;
+            solver->alpha = gamma / (delta - solver->beta * gamma / solver->alpha_old);
+          }
+          solver->gamma_old = gamma;
+          solver->alpha_old = solver->alpha;
+          return TaskStatus::complete;
+        },
+        this);
+
+    // 5. z <- n + beta z, q <- m + beta q, s <- w + beta s, p <- pr + beta p
+    // 6. x <- x + alpha p, r <- r - alpha s, pr <- pr - alpha q, w <- w - alpha z
+    auto update = itl.AddTask(
+        get_scalars | get_n | copy_m, "update vectors",
+        [](PipelinedCGSolver *solver, std::shared_ptr<MeshData<Real>> &md) {
+          const Real alpha = solver->alpha;
+          const Real beta = solver->beta;
+          AddFieldsAndStore<n, z, z>(md, 1.0, beta);
+          AddFieldsAndStore<m, q, q>(md, 1.0, beta);
+          AddFieldsAndStore<w, s, s>(md, 1.0, beta);
+          AddFieldsAndStore<pr, p, p>(md, 1.0, beta);
+          AddFieldsAndStore<x, p, x>(md, 1.0, alpha);
+          AddFieldsAndStore<r, s, r>(md, 1.0, -alpha);
+          AddFieldsAndStore<pr, q, pr>(md, 1.0, -alpha);
+          return AddFieldsAndStore<w, z, w>(md, 1.0, -alpha);
+        },
+        this, md);
+
+    // 7. Check the residual, which is the one from the start of this iteration, so the
+    //    iteration stops once the residual of the (previous) iterate is small enough
+    auto check = itl.AddTask(
+        TaskQualifier::completion, update, "check residual",
+        [](PipelinedCGSolver *solver, Mesh *pmesh, int max_iter,
+           std::shared_ptr<Real> res_tol, bool relative_residual) {
+          Real rms_res = std::sqrt(solver->dots.val[2] / pmesh->GetTotalCells());
+          if (Globals::my_rank == 0 && solver->params_.print_per_step)
+            printf("%i %e\n", solver->iter_counter, rms_res);
+          solver->final_residual = rms_res;
+          solver->final_iteration = solver->iter_counter;
+          Real tol = relative_residual
+                         ? *res_tol * std::sqrt(solver->rhs2.val / pmesh->GetTotalCells())
+                         : *res_tol;
+          if (rms_res < tol || solver->iter_counter >= max_iter) {
+            return TaskStatus::complete;
+          }
+          return TaskStatus::iterate;
+        },
+        this, pmesh, params_.max_iters, params_.residual_tolerance,
+        params_.relative_residual);
+
+    return tl.AddTask(solver_id, TF(CopyData<x, u>), md);
+  }
+
+  Real GetSquaredResidualSum() const { return dots.val.size() > 2 ? dots.val[2] : 0.0; }
+  int GetCurrentIterations() const { return iter_counter; }
+
+  Real GetFinalResidual() const { return final_residual; }
+  int GetFinalIterations() const { return final_iteration; }
+
+  PipelinedCGParams &GetParams() { return params_; }
+
+ protected:
+  // u <- M in_t, or u <- in_t without preconditioning
+  template <class in_t>
+  TaskID AddPreconditionerTasks(TaskList &tl, TaskID dependence, const int partition,
+                                Mesh *pmesh, std::shared_ptr<MeshData<Real>> &md) {
+    using namespace utils;
+    if (!params_.precondition) return tl.AddTask(dependence, TF(CopyData<in_t, u>), md);
+    auto set_rhs = tl.AddTask(dependence, TF(CopyData<in_t, rhs>), md);
+    auto zero_u = tl.AddTask(dependence, TF(SetToZero<u>), md);
+    return preconditioner.AddLinearOperatorTasks(tl, set_rhs | zero_u, partition, pmesh);
+  }
+
+  MGSolver<u, rhs, equations> preconditioner;
+  PipelinedCGParams params_;
+  int iter_counter;
+  AllReduce<std::vector<Real>> dots;
+  AllReduce<Real> rhs2;
+  Real alpha, beta, alpha_old, gamma_old;
+  equations eqs_;
+  Real final_residual;
+  int final_iteration;
+};
+
+} // namespace solvers
+
+} // namespace parthenon
+
+#endif // SOLVERS_PIPELINED_CG_SOLVER_HPP_
@@ -226,6 +226,107 @@ TaskStatus AddFieldsAndStore(const std::shared_ptr<MeshData<Real>> &md, Real wa
       md, wa, wb, false);
 }
 
+// Weights scale * w(c) of the components c of fields, for batched solves of independent
+// problems that are stored in the components of the fields
+struct ComponentWeights {
+  ParArray1D<Real> w;
+  Real scale = 1.0;
+  KOKKOS_INLINE_FUNCTION Real operator()(const int c) const { return scale * w(c); }
+};
+KOKKOS_INLINE_FUNCTION Real WeightOf(const Real w, const int c) { return w; }
+KOKKOS_INLINE_FUNCTION Real WeightOf(const ComponentWeights &w, const int c) {
+  return w(c);
+}
+
+// out_t <- wa a_t + wb b_t + wc c_t in a single kernel, where the weights are either
+// Reals or ComponentWeights
+template <class a_t, class b_t, class c_t, class out_t,
+          bool only_fine_on_composite = true, class wa_t, class wb_t, class wc_t>
+TaskStatus AddThreeFieldsAndStore(const std::shared_ptr<MeshData<Real>> &md,
+                                  const wa_t &wa, const wb_t &wb, const wc_t &wc) {
+  using TE = parthenon::TopologicalElement;
+  TE te = TE::CC;
+  IndexRange ib = md->GetBoundsI(IndexDomain::entire, te);
+  IndexRange jb = md->GetBoundsJ(IndexDomain::entire, te);
+  IndexRange kb = md->GetBoundsK(IndexDomain::entire, te);
+
+  static auto desc = parthenon::MakePackDescriptor<a_t, b_t, c_t, out_t>(md.get());
+  auto pack = desc.GetPack(md.get(), only_fine_on_composite);
+  const int scratch_size = 0;
+  const int scratch_level = 0;
+  // Warning: This inner loop strategy only works because we are using IndexDomain::entire
+  const int npoints_inner = (kb.e - kb.s + 1) * (jb.e - jb.s + 1) * (ib.e - ib.s + 1);
+  parthenon::par_for_outer(
+      DEFAULT_OUTER_LOOP_PATTERN, "AddThreeFieldsAndStore", DevExecSpace(), scratch_size,
+      scratch_level, 0, pack.GetNBlocks() - 1,
+      KOKKOS_LAMBDA(parthenon::team_mbr_t member, const int b) {
+        const int nvars = pack.GetUpperBound(b, a_t()) - pack.GetLowerBound(b, a_t()) + 1;
+        for (int c = 0; c < nvars; ++c) {
+          Real *avar = &pack(b, te, a_t(c), kb.s, jb.s, ib.s);
+          Real *bvar = &pack(b, te, b_t(c), kb.s, jb.s, ib.s);
+          Real *cvar = &pack(b, te, c_t(c), kb.s, jb.s, ib.s);
+          Real *out = &pack(b, te, out_t(c), kb.s, jb.s, ib.s);
+          const Real wa_c = WeightOf(wa, c);
+          const Real wb_c = WeightOf(wb, c);
+          const Real wc_c = WeightOf(wc, c);
+          parthenon::par_for_inner(
+              DEFAULT_INNER_LOOP_PATTERN, member, 0, npoints_inner - 1,
+              [&](const int idx) {
+                out[idx] = wa_c * avar[idx] + wb_c * bvar[idx] + wc_c * cvar[idx];
+              });
+        }
+      });
+  return TaskStatus::complete;
+}
+
+// Two independent updates out1_t <- wa a_t + wb b_t and out2_t <- wc c_t + wd d_t in a
+// single kernel. out1_t must not be c_t or d_t. The weights are either Reals or
+// ComponentWeights.
+template <class a_t, class b_t, class out1_t, class c_t, class d_t, class out2_t,
+          bool only_fine_on_composite = true, class wa_t, class wb_t, class wc_t,
+          class wd_t>
+TaskStatus AddFieldsAndStoreTwice(const std::shared_ptr<MeshData<Real>> &md,
+                                  const wa_t &wa, const wb_t &wb, const wc_t &wc,
+                                  const wd_t &wd) {
+  using TE = parthenon::TopologicalElement;
+  TE te = TE::CC;
+  IndexRange ib = md->GetBoundsI(IndexDomain::entire, te);
+  IndexRange jb = md->GetBoundsJ(IndexDomain::entire, te);
+  IndexRange kb = md->GetBoundsK(IndexDomain::entire, te);
+
+  static auto desc =
+      parthenon::MakePackDescriptor<a_t, b_t, out1_t, c_t, d_t, out2_t>(md.get());
+  auto pack = desc.GetPack(md.get(), only_fine_on_composite);
+  const int scratch_size = 0;
+  const int scratch_level = 0;
+  // Warning: This inner loop strategy only works because we are using IndexDomain::entire
+  const int npoints_inner = (kb.e - kb.s + 1) * (jb.e - jb.s + 1) * (ib.e - ib.s + 1);
+  parthenon::par_for_outer(
+      DEFAULT_OUTER_LOOP_PATTERN, "AddFieldsAndStoreTwice", DevExecSpace(), scratch_size,
+      scratch_level, 0, pack.GetNBlocks() - 1,
+      KOKKOS_LAMBDA(parthenon::team_mbr_t member, const int b) {
+        const int nvars = pack.GetUpperBound(b, a_t()) - pack.GetLowerBound(b, a_t()) + 1;
+        for (int c = 0; c < nvars; ++c) {
+          Real *avar = &pack(b, te, a_t(c), kb.s, jb.s, ib.s);
+          Real *bvar = &pack(b, te, b_t(c), kb.s, jb.s, ib.s);
+          Real *out1 = &pack(b, te, out1_t(c), kb.s, jb.s, ib.s);
+          Real *cvar = &pack(b, te, c_t(c), kb.s, jb.s, ib.s);
+          Real *dvar = &pack(b, te, d_t(c), kb.s, jb.s, ib.s);
+          Real *out2 = &pack(b, te, out2_t(c), kb.s, jb.s, ib.s);
+          const Real wa_c = WeightOf(wa, c);
+          const Real wb_c = WeightOf(wb, c);
+          const Real wc_c = WeightOf(wc, c);
+          const Real wd_c = WeightOf(wd, c);
+          parthenon::par_for_inner(DEFAULT_INNER_LOOP_PATTERN, member, 0,
+                                   npoints_inner - 1, [&](const int idx) {
+                                     out1[idx] = wa_c * avar[idx] + wb_c * bvar[idx];
+                                     out2[idx] = wc_c * cvar[idx] + wd_c * dvar[idx];
+                                   });
+        }
+      });
+  return TaskStatus::complete;
+}
+
 template <class var, bool only_fine_on_composite = true>
 TaskStatus SetToZero(const std::shared_ptr<MeshData<Real>> &md) {
   int nblocks = md->NumBlocks();
@@ -241,7 +342,6 @@ TaskStatus SetToZero(const std::shared_ptr<MeshData<Real>> &md) {
       scratch_size_in_bytes, scratch_level, 0, pack.GetNBlocks() - 1,
       KOKKOS_LAMBDA(parthenon::team_mbr_t member, const int b) {
         auto cb = GetIndexShape(pack(b, te, 0), ng);
-        const auto &coords = pack.GetCoordinates(b);
         IndexRange ib = cb.GetBoundsI(IndexDomain::interior, te);
         IndexRange jb = cb.GetBoundsJ(IndexDomain::interior, te);
         IndexRange kb = cb.GetBoundsK(IndexDomain::interior, te);
@@ -256,9 +356,9 @@ TaskStatus SetToZero(const std::shared_ptr<MeshData<Real>> &md) {
   return TaskStatus::complete;
 }
 
+// Adds the local part of (a, b) to *adotb
 template <class a_t, class b_t>
-TaskStatus DotProductLocal(const std::shared_ptr<MeshData<Real>> &md,
-                           AllReduce<Real> *adotb) {
+TaskStatus AccumulateDotProduct(const std::shared_ptr<MeshData<Real>> &md, Real *adotb) {
   using TE = parthenon::TopologicalElement;
   TE te = TE::CC;
   IndexRange ib = md->GetBoundsI(IndexDomain::interior, te);
@@ -280,10 +380,69 @@ TaskStatus DotProductLocal(const std::shared_ptr<MeshData<Real>> &md,
           lsum += pack(b, te, a_t(c), k, j, i) * pack(b, te, b_t(c), k, j, i);
       },
       Kokkos::Sum<Real>(gsum));
-  adotb->val += gsum;
+  *adotb += gsum;
+  return TaskStatus::complete;
+}
+
+// Adds the local part of (a, b) restricted to component c to adotb[c] for all ncomp
+// components, or of all components to adotb[0] if ncomp is one
+template <class a_t, class b_t>
+TaskStatus AccumulateDotProducts(const std::shared_ptr<MeshData<Real>> &md, Real *adotb,
+                                 const int ncomp) {
+  if (ncomp == 1) return AccumulateDotProduct<a_t, b_t>(md, adotb);
+  using TE = parthenon::TopologicalElement;
+  TE te = TE::CC;
+  IndexRange ib = md->GetBoundsI(IndexDomain::interior, te);
+  IndexRange jb = md->GetBoundsJ(IndexDomain::interior, te);
+  IndexRange kb = md->GetBoundsK(IndexDomain::interior, te);
+
+  static auto desc = parthenon::MakePackDescriptor<a_t, b_t>(md.get());
+  auto pack = desc.GetPack(md.get());
+  for (int c = 0; c < ncomp; ++c) {
+    Real gsum(0);
+    parthenon::par_reduce(
+        parthenon::loop_pattern_mdrange_tag, "DotProducts", DevExecSpace(), 0,
+        pack.GetNBlocks() - 1, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+        KOKKOS_LAMBDA(const int b, const int k, const int j, const int i, Real &lsum) {
+          lsum += pack(b, te, a_t(c), k, j, i) * pack(b, te, b_t(c), k, j, i);
+        },
+        Kokkos::Sum<Real>(gsum));
+    adotb[c] += gsum;
+  }
   return TaskStatus::complete;
 }
 
+// (a, b) of each of the ncomp components (see AccumulateDotProducts) in adotb
+template <class a_t, class b_t>
+TaskID DotProducts(TaskID dependency_in, TaskList &tl,
+                   AllReduce<std::vector<Real>> *adotb, const int ncomp,
+                   const std::shared_ptr<MeshData<Real>> &md) {
+  using reduction_t = AllReduce<std::vector<Real>>;
+  auto zero_adotb = tl.AddTask(
+      TaskQualifier::once_per_region | TaskQualifier::local_sync, dependency_in,
+      [ncomp](reduction_t *r) {
+        r->val.assign(ncomp, 0.0);
+        return TaskStatus::complete;
+      },
+      adotb);
+  auto get_adotb = tl.AddTask(
+      TaskQualifier::local_sync, zero_adotb,
+      [ncomp](const std::shared_ptr<MeshData<Real>> &md, reduction_t *r) {
+        return AccumulateDotProducts<a_t, b_t>(md, r->val.data(), ncomp);
+      },
+      md, adotb);
+  auto start_global_adotb = tl.AddTask(TaskQualifier::once_per_region, get_adotb,
+                                       &reduction_t::StartReduce, adotb, MPI_SUM);
+  return tl.AddTask(TaskQualifier::once_per_region | TaskQualifier::local_sync,
+                    start_global_adotb, &reduction_t::CheckReduce, adotb);
+}
+
+template <class a_t, class b_t>
+TaskStatus DotProductLocal(const std::shared_ptr<MeshData<Real>> &md,
+                           AllReduce<Real> *adotb) {
+  return AccumulateDotProduct<a_t, b_t>(md, &(adotb->val));
+}
+
 template <class a_t, class b_t>
 TaskID DotProduct(TaskID dependency_in, TaskList &tl, AllReduce<Real> *adotb,
                   const std::shared_ptr<MeshData<Real>> &md) {
@@ -352,6 +511,205 @@ TaskID GlobalMin(TaskID dependency_in, TaskList &tl, AllReduce<Real> *amin,
                     start_global_amin, &AllReduce<Real>::CheckReduce, amin);
 }
 
+// Stored stencils of MGSolver hold the coefficients A_(i, i+d) of a cell i in the
+// components of a field. A 7-point stencil holds the center and the lower and upper
+// neighbors in x1, x2, and x3 in this order, a 27-point stencil the offsets
+// d = (dk, dj, di) in {-1, 0, 1}^3 at 9 (dk + 1) + 3 (dj + 1) + di + 1.
+KOKKOS_INLINE_FUNCTION void StencilOffset(const int npoints, const int n, int &dk,
+                                          int &dj, int &di) {
+  if (npoints == 27) {
+    di = n % 3 - 1;
+    dj = (n / 3) % 3 - 1;
+    dk = n / 9 - 1;
+    return;
+  }
+  di = (n == 1 || n == 2) ? 2 * n - 3 : 0;
+  dj = (n == 3 || n == 4) ? 2 * n - 7 : 0;
+  dk = (n == 5 || n == 6) ? 2 * n - 11 : 0;
+}
+
+// Index of offset (dk, dj, di) in a stored stencil, or -1 if it is not part of it
+KOKKOS_INLINE_FUNCTION int StencilIndex(const int npoints, const int dk, const int dj,
+                                        const int di) {
+  if (npoints == 27) return 9 * (dk + 1) + 3 * (dj + 1) + di + 1;
+  if (dj == 0 && dk == 0) return di == 0 ? 0 : (di < 0 ? 1 : 2);
+  if (di == 0 && dk == 0) return dj < 0 ? 3 : 4;
+  if (di == 0 && dj == 0) return dk < 0 ? 5 : 6;
+  return -1;
+}
+
+// Whether offset (dk, dj, di) reaches into a direction that does not exist
+KOKKOS_INLINE_FUNCTION bool StencilOffsetUnused(const int ndim, const int dk,
+                                                const int dj) {
+  return (ndim < 3 && dk != 0) || (ndim < 2 && dj != 0);
+}
+
+// y_t <- A x_t for every component of x_t with the stored stencil in stencil_t
+template <class stencil_t, class x_t, class y_t>
+TaskStatus StoredStencilAx(const std::shared_ptr<MeshData<Real>> &md) {
+  using TE = parthenon::TopologicalElement;
+  TE te = TE::CC;
+  IndexRange ib = md->GetBoundsI(IndexDomain::interior, te);
+  IndexRange jb = md->GetBoundsJ(IndexDomain::interior, te);
+  IndexRange kb = md->GetBoundsK(IndexDomain::interior, te);
+  const int ndim = md->GetMeshPointer()->ndim;
+
+  static auto desc = parthenon::MakePackDescriptor<stencil_t, x_t, y_t>(md.get());
+  auto pack = desc.GetPack(md.get());
+  parthenon::par_for(
+      "StoredStencilAx", 0, pack.GetNBlocks() - 1, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+      KOKKOS_LAMBDA(const int b, const int k, const int j, const int i) {
+        const int npoints =
+            pack.GetUpperBound(b, stencil_t()) - pack.GetLowerBound(b, stencil_t()) + 1;
+        const int nvars = pack.GetUpperBound(b, x_t()) - pack.GetLowerBound(b, x_t()) + 1;
+        for (int c = 0; c < nvars; ++c) {
+          Real ax = 0.0;
+          for (int n = 0; n < npoints; ++n) {
+            int dk, dj, di;
+            StencilOffset(npoints, n, dk, dj, di);
+            if (StencilOffsetUnused(ndim, dk, dj)) continue;
+            ax += pack(b, te, stencil_t(n), k, j, i) *
+                  pack(b, te, x_t(c), k + dk, j + dj, i + di);
+          }
+          pack(b, te, y_t(c), k, j, i) = ax;
+        }
+      });
+  return TaskStatus::complete;
+}
+
+// Every component of diag_t <- the center of the stored stencil in stencil_t
+template <class stencil_t, class diag_t>
+TaskStatus StoredStencilDiagonal(const std::shared_ptr<MeshData<Real>> &md) {
+  using TE = parthenon::TopologicalElement;
+  TE te = TE::CC;
+  IndexRange ib = md->GetBoundsI(IndexDomain::interior, te);
+  IndexRange jb = md->GetBoundsJ(IndexDomain::interior, te);
+  IndexRange kb = md->GetBoundsK(IndexDomain::interior, te);
+
+  static auto desc = parthenon::MakePackDescriptor<stencil_t, diag_t>(md.get());
+  auto pack = desc.GetPack(md.get());
+  parthenon::par_for(
+      "StoredStencilDiagonal", 0, pack.GetNBlocks() - 1, kb.s, kb.e, jb.s, jb.e, ib.s,
+      ib.e, KOKKOS_LAMBDA(const int b, const int k, const int j, const int i) {
+        const int npoints =
+            pack.GetUpperBound(b, stencil_t()) - pack.GetLowerBound(b, stencil_t()) + 1;
+        const int nvars =
+            pack.GetUpperBound(b, diag_t()) - pack.GetLowerBound(b, diag_t()) + 1;
+        const int center = StencilIndex(npoints, 0, 0, 0);
+        const Real diag = pack(b, te, stencil_t(center), k, j, i);
+        for (int c = 0; c < nvars; ++c)
+          pack(b, te, diag_t(c), k, j, i) = diag;
+      });
+  return TaskStatus::complete;
+}
+
+// Coefficients of the stored stencil in stencil_t coupling every cell to its lower and
+// upper neighbor in direction dir, see MGSolver::LineStage
+template <class stencil_t, class lo_t, class up_t>
+TaskStatus StoredStencilLineCoefficients(const std::shared_ptr<MeshData<Real>> &md,
+                                         int dir) {
+  using TE = parthenon::TopologicalElement;
+  TE te = TE::CC;
+  IndexRange ib = md->GetBoundsI(IndexDomain::interior, te);
+  IndexRange jb = md->GetBoundsJ(IndexDomain::interior, te);
+  IndexRange kb = md->GetBoundsK(IndexDomain::interior, te);
+  const int di = dir == X1DIR;
+  const int dj = dir == X2DIR;
+  const int dk = dir == X3DIR;
+
+  static auto desc = parthenon::MakePackDescriptor<stencil_t, lo_t, up_t>(md.get());
+  auto pack = desc.GetPack(md.get());
+  parthenon::par_for(
+      "StoredStencilLineCoefficients", 0, pack.GetNBlocks() - 1, kb.s, kb.e, jb.s, jb.e,
+      ib.s, ib.e, KOKKOS_LAMBDA(const int b, const int k, const int j, const int i) {
+        const int npoints =
+            pack.GetUpperBound(b, stencil_t()) - pack.GetLowerBound(b, stencil_t()) + 1;
+        pack(b, te, lo_t(), k, j, i) =
+            pack(b, te, stencil_t(StencilIndex(npoints, -dk, -dj, -di)), k, j, i);
+        pack(b, te, up_t(), k, j, i) =
+            pack(b, te, stencil_t(StencilIndex(npoints, dk, dj, di)), k, j, i);
+      });
+  return TaskStatus::complete;
+}
+
+// Contributions g_t of every cell to the coarse Galerkin operator R A P of the stored
+// stencil in stencil_t, where R is the average restriction and P the piecewise constant
+// prolongation. Coupling d of cell i goes to the coarse coupling between the parent of i
+// and the parent of i + d, so that the average restriction of g_t is the coarse stencil.
+// This requires an even number of cells per block in every direction.
+template <class stencil_t, class g_t>
+TaskStatus GalerkinContributions(const std::shared_ptr<MeshData<Real>> &md) {
+  using TE = parthenon::TopologicalElement;
+  TE te = TE::CC;
+  IndexRange ib = md->GetBoundsI(IndexDomain::interior, te);
+  IndexRange jb = md->GetBoundsJ(IndexDomain::interior, te);
+  IndexRange kb = md->GetBoundsK(IndexDomain::interior, te);
+  const int ndim = md->GetMeshPointer()->ndim;
+
+  // The coarse blocks of a two_level_composite grid belong to the next coarser level
+  static auto desc = parthenon::MakePackDescriptor<stencil_t, g_t>(md.get());
+  auto pack = desc.GetPack(md.get(), true);
+  parthenon::par_for(
+      "GalerkinContributions", 0, pack.GetNBlocks() - 1, kb.s, kb.e, jb.s, jb.e, ib.s,
+      ib.e, KOKKOS_LAMBDA(const int b, const int k, const int j, const int i) {
+        const int npoints =
+            pack.GetUpperBound(b, stencil_t()) - pack.GetLowerBound(b, stencil_t()) + 1;
+        // Position of the cell within its parent
+        const int pi = (i - ib.s) % 2;
+        const int pj = ndim > 1 ? (j - jb.s) % 2 : 0;
+        const int pk = ndim > 2 ? (k - kb.s) % 2 : 0;
+        for (int n = 0; n < npoints; ++n)
+          pack(b, te, g_t(n), k, j, i) = 0.0;
+        for (int n = 0; n < npoints; ++n) {
+          int dk, dj, di;
+          StencilOffset(npoints, n, dk, dj, di);
+          if (StencilOffsetUnused(ndim, dk, dj)) continue;
+          // Offset of the parent of i + d from the parent of i
+          const int m = StencilIndex(npoints, (pk + dk + 2) / 2 - 1,
+                                     (pj + dj + 2) / 2 - 1, (pi + di + 2) / 2 - 1);
+          pack(b, te, g_t(m), k, j, i) += pack(b, te, stencil_t(n), k, j, i);
+        }
+      });
+  return TaskStatus::complete;
+}
+
+// stencil_t <- the restricted Galerkin contributions in g_t on the internal blocks of a
+// two_level_composite grid, with the couplings, i.e. the part of the stencil with zero
+// row sum, scaled by coupling_scale
+template <class g_t, class stencil_t>
+TaskStatus SetGalerkinStencil(const std::shared_ptr<MeshData<Real>> &md,
+                              Real coupling_scale) {
+  using TE = parthenon::TopologicalElement;
+  TE te = TE::CC;
+  IndexRange ib = md->GetBoundsI(IndexDomain::interior, te);
+  IndexRange jb = md->GetBoundsJ(IndexDomain::interior, te);
+  IndexRange kb = md->GetBoundsK(IndexDomain::interior, te);
+
+  int nblocks = md->NumBlocks();
+  std::vector<bool> include_block(nblocks, true);
+  // The neighbors array will only be set for a block if its a leaf block
+  for (int b = 0; b < nblocks; ++b)
+    include_block[b] = md->GetBlockData(b)->GetBlockPointer()->neighbors.size() == 0;
+
+  static auto desc = parthenon::MakePackDescriptor<g_t, stencil_t>(md.get());
+  auto pack = desc.GetPack(md.get(), include_block, true);
+  parthenon::par_for(
+      "SetGalerkinStencil", 0, pack.GetNBlocks() - 1, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+      KOKKOS_LAMBDA(const int b, const int k, const int j, const int i) {
+        const int npoints =
+            pack.GetUpperBound(b, stencil_t()) - pack.GetLowerBound(b, stencil_t()) + 1;
+        const int center = StencilIndex(npoints, 0, 0, 0);
+        Real row_sum = 0.0;
+        for (int n = 0; n < npoints; ++n)
+          row_sum += pack(b, te, g_t(n), k, j, i);
+        for (int n = 0; n < npoints; ++n)
+          pack(b, te, stencil_t(n), k, j, i) =
+              coupling_scale * pack(b, te, g_t(n), k, j, i);
+        pack(b, te, stencil_t(center), k, j, i) += (1.0 - coupling_scale) * row_sum;
+      });
+  return TaskStatus::complete;
+}
+
 } // namespace utils
 
 } // namespace solvers
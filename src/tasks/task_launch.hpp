@@ -0,0 +1,77 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef TASKS_TASK_LAUNCH_HPP_
+#define TASKS_TASK_LAUNCH_HPP_
+
+#include <utility>
+#include <vector>
+
+#include "basic_types.hpp"
+#include "kokkos_abstraction.hpp"
+
+namespace parthenon {
+
+// Device work that a task left running when it returned. A task that enqueued kernels
+// (or copies) on an execution space instance can return without fencing it by
+// returning TaskLaunch::Launched(space) instead of TaskStatus::complete. Tasks that
+// depend on it and are qualified with TaskQualifier::stream_ordered, i.e., that only
+// enqueue more work on the same instances, then run right away. Any other task that
+// depends on it, directly or through stream ordered tasks, first fences the instances,
+// so that it can use the results on the host.
+class TaskLaunch {
+ public:
+  // Can be called several times by a task (or anything it calls) for the instances it
+  // launched work on
+  static TaskStatus Launched(const DevExecSpace &space) {
+    Current_().push_back(space);
+    return TaskStatus::complete;
+  }
+
+  // Called by the scheduler when task index of a compiled graph starts running, with
+  // the launches of its dependencies that remain to be fenced by its dependents
+  void Begin(const int index, std::vector<int> &&inherited) {
+    index_ = index;
+    pending_ = std::move(inherited);
+    Current_().clear();
+  }
+  // Called by the task before its status becomes visible to its dependents
+  void End() {
+    spaces_ = Current_();
+    if (!spaces_.empty()) pending_.push_back(index_);
+  }
+  void Clear() {
+    spaces_.clear();
+    pending_.clear();
+  }
+
+  // The tasks (including this one) whose launches the dependents of this task have to
+  // fence unless they are stream ordered themselves
+  const std::vector<int> &Pending() const { return pending_; }
+  void Fence() const {
+    for (const auto &space : spaces_)
+      space.fence();
+  }
+
+ private:
+  int index_ = 0;
+  std::vector<DevExecSpace> spaces_;
+  std::vector<int> pending_;
+  static std::vector<DevExecSpace> &Current_() {
+    static thread_local std::vector<DevExecSpace> current;
+    return current;
+  }
+};
+
+} // namespace parthenon
+
+#endif // TASKS_TASK_LAUNCH_HPP_
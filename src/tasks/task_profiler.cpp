@@ -0,0 +1,204 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "tasks/task_profiler.hpp"
+#include "tasks/tasks.hpp"
+#include "utils/error_checking.hpp"
+
+namespace parthenon {
+
+namespace {
+std::string EscapeJSON(const std::string &in) {
+  std::string out;
+  out.reserve(in.size());
+  for (const char c : in) {
+    if (c == '"' || c == '\\') out.push_back('\\');
+    if (c == '\n') {
+      out += "\\n";
+    } else {
+      out.push_back(c);
+    }
+  }
+  return out;
+}
+
+const char *StatusName(const TaskStatus status) {
+  switch (status) {
+  case TaskStatus::complete:
+    return "complete";
+  case TaskStatus::incomplete:
+    return "incomplete";
+  case TaskStatus::iterate:
+    return "iterate";
+  default:
+    return "fail";
+  }
+}
+} // namespace
+
+int TaskProfiler::ThreadIndex() {
+  // Only called with the mutex held
+  static thread_local int id = -1;
+  if (id < 0) id = nthreads_++;
+  return id;
+}
+
+int TaskProfiler::LabelIndex(const std::string &label) {
+  auto it = label_ids_.find(label);
+  if (it != label_ids_.end()) return it->second;
+  labels_.push_back(label);
+  label_ids_[label] = labels_.size() - 1;
+  return labels_.size() - 1;
+}
+
+void TaskProfiler::Record(Task *task, int list_id, TaskStatus status, double start,
+                          double end) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  raw_events_.push_back({task, list_id, ThreadIndex(), status, start, end});
+}
+
+void TaskProfiler::FinishRegion() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (raw_events_.size() == 0) return;
+
+  // Collect the span, number of calls and number of incomplete returns of every task
+  std::unordered_map<Task *, PathEntry> spans;
+  for (auto &ev : raw_events_) {
+    auto it = spans.find(ev.task);
+    if (it == spans.end()) {
+      spans[ev.task] = {-1, ev.list_id, 1, ev.status == TaskStatus::incomplete,
+                        ev.start, ev.end};
+    } else {
+      auto &span = it->second;
+      span.ncalls++;
+      span.nincomplete += (ev.status == TaskStatus::incomplete);
+      span.start = std::min(span.start, ev.start);
+      span.end = std::max(span.end, ev.end);
+    }
+  }
+
+  // Walk back from the task that finished last, always following the dependency that
+  // finished last, since that is the one that the task had to wait for
+  Task *cur =
+      std::max_element(spans.begin(), spans.end(), [](auto &a, auto &b) {
+        return a.second.end < b.second.end;
+      })->first;
+  std::vector<PathEntry> path;
+  std::unordered_set<Task *> visited;
+  while (cur != nullptr && visited.count(cur) == 0) {
+    visited.insert(cur);
+    auto entry = spans.at(cur);
+    entry.label = LabelIndex(cur->GetLabel());
+    path.push_back(entry);
+    Task *next = nullptr;
+    double next_end = -1.0;
+    for (auto dep : cur->GetDependencies()) {
+      auto it = spans.find(dep);
+      if (it == spans.end() || it->second.end > entry.end) continue;
+      if (it->second.end > next_end) {
+        next = dep;
+        next_end = it->second.end;
+      }
+    }
+    cur = next;
+  }
+  current_path_.insert(current_path_.end(), path.rbegin(), path.rend());
+
+  for (auto &ev : raw_events_) {
+    if (events_.size() >= max_events_) break;
+    events_.push_back({LabelIndex(ev.task->GetLabel()), ev.list_id, ev.thread, -1,
+                       ev.status, ev.start, ev.end});
+  }
+  raw_events_.clear();
+}
+
+void TaskProfiler::FinishCycle(const int cycle) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (std::size_t i = cycle_start_; i < events_.size(); ++i)
+    events_[i].cycle = cycle;
+  cycle_start_ = events_.size();
+  paths_.push_back({cycle, std::move(current_path_)});
+  current_path_.clear();
+}
+
+void TaskProfiler::WriteChromeTrace(const std::string &filename, const int rank) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::ofstream out(filename);
+  PARTHENON_REQUIRE_THROWS(out.is_open(), "Could not open task profile " + filename);
+  // Timestamps are in microseconds. The critical paths are shown on an extra thread.
+  const int path_tid = nthreads_;
+  out << std::setprecision(15) << "{\"traceEvents\":[\n";
+  out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << rank
+      << ",\"tid\":" << path_tid << ",\"args\":{\"name\":\"critical path\"}}";
+  for (auto &ev : events_) {
+    out << ",\n{\"name\":\"" << EscapeJSON(labels_[ev.label])
+        << "\",\"cat\":\"task\",\"ph\":\"X\",\"ts\":" << 1.e6 * ev.start
+        << ",\"dur\":" << 1.e6 * (ev.end - ev.start) << ",\"pid\":" << rank
+        << ",\"tid\":" << ev.thread << ",\"args\":{\"list\":" << ev.list_id
+        << ",\"cycle\":" << ev.cycle << ",\"status\":\"" << StatusName(ev.status)
+        << "\"}}";
+  }
+  for (auto &cp : paths_) {
+    for (auto &entry : cp.path) {
+      out << ",\n{\"name\":\"" << EscapeJSON(labels_[entry.label])
+          << "\",\"cat\":\"critical_path\",\"ph\":\"X\",\"ts\":" << 1.e6 * entry.start
+          << ",\"dur\":" << 1.e6 * (entry.end - entry.start) << ",\"pid\":" << rank
+          << ",\"tid\":" << path_tid << ",\"args\":{\"list\":" << entry.list_id
+          << ",\"cycle\":" << cp.cycle << ",\"calls\":" << entry.ncalls
+          << ",\"incomplete\":" << entry.nincomplete << "}}";
+    }
+  }
+  out << "\n]}\n";
+}
+
+void TaskProfiler::WriteCriticalPaths(const std::string &filename) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::ofstream out(filename);
+  PARTHENON_REQUIRE_THROWS(out.is_open(), "Could not open task profile " + filename);
+  // Tasks that returned incomplete at least once were (at least partly) waiting, e.g.
+  // polling for communication, the remaining ones were doing work
+  out << std::scientific << std::setprecision(4);
+  for (auto &cp : paths_) {
+    double total = 0.0, polling = 0.0;
+    for (auto &entry : cp.path) {
+      total += entry.end - entry.start;
+      if (entry.nincomplete > 0) polling += entry.end - entry.start;
+    }
+    out << "cycle " << cp.cycle << ": " << cp.path.size() << " tasks, " << total
+        << " s on critical path, " << polling << " s in polling tasks\n";
+    for (auto &entry : cp.path) {
+      out << "  " << entry.end - entry.start << " s  list " << entry.list_id << "  calls "
+          << entry.ncalls << "  incomplete " << entry.nincomplete << "  "
+          << labels_[entry.label] << "\n";
+    }
+  }
+}
+
+void TaskProfiler::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  raw_events_.clear();
+  events_.clear();
+  cycle_start_ = 0;
+  current_path_.clear();
+  paths_.clear();
+}
+
+} // namespace parthenon
@@ -0,0 +1,111 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef TASKS_TASK_PROFILER_HPP_
+#define TASKS_TASK_PROFILER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "basic_types.hpp"
+
+namespace parthenon {
+
+class Task;
+
+// Records every execution of a task (start and end time, thread, task list and returned
+// status) while enabled. At the end of the execution of every TaskRegion the critical
+// path through the region is computed by walking back from the task that finished last
+// to the dependency that finished last, and so on. The critical path of a cycle is the
+// concatenation of the critical paths of the regions executed during the cycle. The
+// recorded events can be written as Chrome trace JSON (readable by chrome://tracing and
+// Perfetto), and the critical paths as a text summary.
+class TaskProfiler {
+ public:
+  static TaskProfiler &Instance() {
+    static TaskProfiler profiler;
+    return profiler;
+  }
+
+  void Enable(const bool enable) { enabled_.store(enable, std::memory_order_relaxed); }
+  bool Enabled() const { return enabled_.load(std::memory_order_relaxed); }
+  // Limit the number of events that are kept for the trace, critical paths are always
+  // computed
+  void SetMaxEvents(const std::size_t max_events) { max_events_ = max_events; }
+
+  // Seconds since the profiler was created
+  double Now() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - epoch_)
+        .count();
+  }
+
+  void Record(Task *task, int list_id, TaskStatus status, double start, double end);
+
+  // Called at the end of TaskRegion::Execute while the tasks are still alive
+  void FinishRegion();
+  // Assign all regions finished since the previous call to the given cycle
+  void FinishCycle(int cycle);
+
+  void WriteChromeTrace(const std::string &filename, int rank) const;
+  void WriteCriticalPaths(const std::string &filename) const;
+  void Clear();
+
+ private:
+  TaskProfiler() : epoch_(std::chrono::steady_clock::now()) {}
+
+  struct RawEvent {
+    Task *task;
+    int list_id, thread;
+    TaskStatus status;
+    double start, end;
+  };
+  struct Event {
+    int label, list_id, thread, cycle;
+    TaskStatus status;
+    double start, end;
+  };
+  // A task on the critical path, spanning all its calls within the region
+  struct PathEntry {
+    int label, list_id, ncalls, nincomplete;
+    double start, end;
+  };
+  struct CyclePath {
+    int cycle;
+    std::vector<PathEntry> path;
+  };
+
+  int ThreadIndex();
+  int LabelIndex(const std::string &label);
+
+  std::atomic<bool> enabled_{false};
+  std::chrono::steady_clock::time_point epoch_;
+  std::size_t max_events_ = 10000000;
+  int nthreads_ = 0;
+
+  mutable std::mutex mutex_;
+  std::vector<RawEvent> raw_events_;
+  std::vector<Event> events_;
+  std::size_t cycle_start_ = 0;
+  std::vector<std::string> labels_;
+  std::unordered_map<std::string, int> label_ids_;
+  std::vector<PathEntry> current_path_;
+  std::vector<CyclePath> paths_;
+};
+
+} // namespace parthenon
+
+#endif // TASKS_TASK_PROFILER_HPP_
@@ -0,0 +1,98 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef TASKS_TASK_WAIT_HPP_
+#define TASKS_TASK_WAIT_HPP_
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "parthenon_mpi.hpp"
+#include "utils/error_checking.hpp"
+
+namespace parthenon {
+
+// What a task that returned TaskStatus::incomplete is waiting for. While a task runs,
+// it (or anything it calls) can register the MPI requests whose completion it is
+// waiting for with TaskWait::Request. The task is then not run again before one of these
+// requests completed, which is checked without completing them, or before a backoff
+// that doubles with every incomplete return passed. A task that registered no requests,
+// e.g., because it is waiting for a probed message, is retried after the backoff only.
+class TaskWait {
+ public:
+  // Minimum and maximum time between two runs of a task that keeps returning incomplete
+  static constexpr double min_backoff = 1.0e-6;
+  static constexpr double max_backoff = 5.0e-5;
+
+#ifdef MPI_PARALLEL
+  // The request has to stay valid (or be set to MPI_REQUEST_NULL) until the task has
+  // run again
+  static void Request(const MPI_Request *request) { Current_().push_back(request); }
+#endif
+
+  // Called by the scheduler before running a task and after it returned incomplete
+  void Begin() {
+#ifdef MPI_PARALLEL
+    Current_().clear();
+#endif
+  }
+  void Incomplete(const double now) {
+    backoff_ = std::min(max_backoff, backoff_ == 0.0 ? min_backoff : 2.0 * backoff_);
+    retry_at_ = now + backoff_;
+#ifdef MPI_PARALLEL
+    requests_ = Current_();
+#endif
+  }
+  void Completed() {
+    backoff_ = 0.0;
+#ifdef MPI_PARALLEL
+    requests_.clear();
+#endif
+  }
+
+  // Whether the task should run again at time now
+  bool Retry(const double now) const {
+    if (now >= retry_at_) return true;
+#ifdef MPI_PARALLEL
+    for (const auto *request : requests_) {
+      int flag;
+      PARTHENON_MPI_CHECK(MPI_Request_get_status(*request, &flag, MPI_STATUS_IGNORE));
+      if (flag) return true;
+    }
+#endif
+    return false;
+  }
+  double RetryAt() const { return retry_at_; }
+
+  // Seconds on a steady clock
+  static double Now() {
+    return std::chrono::duration<double>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+ private:
+  double backoff_ = 0.0;
+  double retry_at_ = 0.0;
+#ifdef MPI_PARALLEL
+  std::vector<const MPI_Request *> requests_;
+  static std::vector<const MPI_Request *> &Current_() {
+    static thread_local std::vector<const MPI_Request *> current;
+    return current;
+  }
+#endif
+};
+
+} // namespace parthenon
+
+#endif // TASKS_TASK_WAIT_HPP_
@@ -20,12 +20,16 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
+#include <cstdint>
 #include <functional>
+#include <limits>
 #include <list>
 #include <memory>
 #include <regex>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <unordered_map>
 #include <unordered_set>
@@ -36,9 +40,13 @@
 #include <parthenon_mpi.hpp>
 
 #include "globals.hpp"
+#include "task_launch.hpp"
+#include "task_profiler.hpp"
+#include "task_wait.hpp"
 #include "thread_pool.hpp"
 #include "utils/concepts_lite.hpp"
 #include "utils/error_checking.hpp"
+#include "utils/telemetry.hpp"
 
 // Macro for decorating functions passed to AddTask so that their names
 // are stored for outputing task graphs
@@ -66,11 +74,18 @@ class TaskQualifier {
   static inline constexpr qualifier_t global_sync{1 << 1};
   static inline constexpr qualifier_t completion{1 << 2};
   static inline constexpr qualifier_t once_per_region{1 << 3};
+  // Run the task before other ready tasks, e.g., to post sends and receives early
+  static inline constexpr qualifier_t high_priority{1 << 4};
+  // The task only enqueues device work on the execution space instances its
+  // dependencies launched work on, so it does not wait for that work, see TaskLaunch
+  static inline constexpr qualifier_t stream_ordered{1 << 5};
 
   bool LocalSync() const { return flags & local_sync; }
   bool GlobalSync() const { return flags & global_sync; }
   bool Completion() const { return flags & completion; }
   bool Once() const { return flags & once_per_region; }
+  bool HighPriority() const { return flags & high_priority; }
+  bool StreamOrdered() const { return flags & stream_ordered; }
 
  private:
   qualifier_t flags;
@@ -131,7 +146,25 @@ class Task {
   }
 
   TaskStatus operator()() {
-    auto status = f();
+    TaskStatus status;
+    auto &profiler = TaskProfiler::Instance();
+    const bool profile = profiler.Enabled();
+    const double start = profile ? profiler.Now() : 0.0;
+    auto &telemetry = Telemetry::Instance();
+    const double telemetry_start = telemetry.Enabled() ? telemetry.Now() : -1.0;
+    if (cost_func != nullptr && *cost_func) {
+      // Fence so that device work launched by this task is included in its cost
+      Kokkos::Timer timer;
+      status = f();
+      Kokkos::fence();
+      (*cost_func)(timer.seconds());
+    } else {
+      status = f();
+    }
+    if (profile) profiler.Record(this, list_id_, status, start, profiler.Now());
+    // Time spent in tasks that could not complete yet, typically polling for messages
+    if (telemetry_start >= 0.0 && status == TaskStatus::incomplete)
+      telemetry.Add(Telemetry::wait, telemetry.Now() - telemetry_start);
     if (verbose_level_ > 0)
       printf("%s [status = %i, rank = %i]\n", label_.c_str(), static_cast<int>(status),
              Globals::my_rank);
@@ -144,6 +177,8 @@ class Task {
       // enforce maximum number of iterations
       if (num_calls == exec_limits.second) status = TaskStatus::complete;
     }
+    // record the device work left running before dependents can see the status
+    if (launch_ != nullptr) launch_->End();
     // save the status in the Task object
     SetStatus(status);
     return status;
@@ -168,18 +203,30 @@ class Task {
   }
   void SetType(TaskType type) { task_type = type; }
   TaskType GetType() { return task_type; }
-  void SetStatus(TaskStatus status) {
-    std::lock_guard<std::mutex> lock(mutex);
-    task_status = status;
-  }
-  TaskStatus GetStatus() {
-    std::lock_guard<std::mutex> lock(mutex);
-    return task_status;
+  void SetStatus(TaskStatus status) { status_->store(status, std::memory_order_release); }
+  TaskStatus GetStatus() { return status_->load(std::memory_order_acquire); }
+  // Move the status of the task into external storage, used by CompiledTaskGraph to keep
+  // the statuses of all tasks of a region in one contiguous array
+  void BindStatus(std::atomic<TaskStatus> *status) {
+    status->store(GetStatus(), std::memory_order_relaxed);
+    status_ = status;
   }
+  void BindLaunch(TaskLaunch *launch) { launch_ = launch; }
   void reset_iteration() { num_calls = 0; }
+  void SetListID(const int id) { list_id_ = id; }
+  void SetCostFunction(std::function<void(double)> *func) { cost_func = func; }
+  // Among the tasks that are ready to run, those with a higher priority are run first.
+  // Tasks of the same priority are ordered by the length of the chain of tasks that
+  // depend on them, see CompiledTaskGraph.
+  void SetPriority(const int priority) { priority_ = priority; }
+  int GetPriority() const { return priority_; }
+  void SetStreamOrdered(const bool stream_ordered) { stream_ordered_ = stream_ordered; }
+  bool StreamOrdered() const { return stream_ordered_; }
 
  private:
   std::function<TaskStatus()> f;
+  // if set, called with the elapsed wall time every time the task is executed
+  std::function<void(double)> *cost_func = nullptr;
   // store a list of tasks that might be available to
   // run for each possible status this task returns
   std::array<std::vector<Task *>, 3> dependent;
@@ -187,10 +234,15 @@ class Task {
   std::pair<int, int> exec_limits;
   TaskType task_type = TaskType::normal;
   int num_calls = 0;
-  TaskStatus task_status = TaskStatus::incomplete;
-  std::mutex mutex;
+  std::atomic<TaskStatus> task_status{TaskStatus::incomplete};
+  std::atomic<TaskStatus> *status_ = &task_status;
+  TaskLaunch *launch_ = nullptr;
   int verbose_level_;
   std::string label_;
+  // id of the TaskList (within its TaskRegion) the task belongs to, used for profiling
+  int list_id_ = 0;
+  int priority_ = 0;
+  bool stream_ordered_ = false;
 };
 
 inline std::ostream &WriteTaskGraph(std::ostream &stream,
@@ -246,7 +298,8 @@ class TaskList {
  public:
   TaskList() : TaskList(TaskID(), {1, 1}) {}
   explicit TaskList(const TaskID &dep, std::pair<int, int> limits)
-      : dependency(dep), exec_limits(limits), graph_built{false} {
+      : dependency(dep), exec_limits(limits), graph_built{false},
+        cost_func(std::make_shared<std::function<void(double)>>()) {
     // make a trivial first_task after which others will get launched
     // simplifies logic for iteration and startup
     tasks.push_back(std::make_shared<Task>(
@@ -320,6 +373,8 @@ class TaskList {
 
     Task *my_task = tasks.back().get();
     TaskID id(my_task);
+    if (tq.HighPriority()) my_task->SetPriority(1);
+    if (tq.StreamOrdered()) my_task->SetStreamOrdered(true);
 
     if (tq.LocalSync() || tq.GlobalSync() || tq.Once()) {
       regional_tasks.push_back(my_task);
@@ -425,6 +480,7 @@ class TaskList {
     sublists.push_back(std::make_shared<TaskList>(dep, minmax_iters));
     auto &tl = *sublists.back();
     tl.SetID(unique_id);
+    tl.cost_func = cost_func;
     return std::make_pair(std::ref(tl), TaskID(tl.last_task));
   }
 
@@ -440,6 +496,11 @@ class TaskList {
     return list;
   }
 
+  // Register a function that is called with the elapsed wall time of every user task
+  // executed by this list (and its sublists), e.g., to measure block costs for load
+  // balancing
+  void SetCostFunction(const std::function<void(double)> &func) { *cost_func = func; }
+
  private:
   TaskID dependency;
   std::pair<int, int> exec_limits;
@@ -461,6 +522,8 @@ class TaskList {
   // a unique id to support tasks that should only get executed once per region
   int unique_id;
   bool graph_built;
+  // shared with sublists so that setting it after sublists are created still works
+  std::shared_ptr<std::function<void(double)>> cost_func;
 
   void GetAllTaskListsInternal(std::vector<TaskList *> &list) {
     list.emplace_back(this);
@@ -477,6 +540,8 @@ class TaskList {
 
   void SetGraphBuilt() {
     graph_built = true;
+    for (auto &t : tasks)
+      t->SetListID(unique_id);
     for (auto &tl : sublists)
       tl->SetGraphBuilt();
   }
@@ -519,6 +584,7 @@ class TaskList {
           return (obj->*func)(std::forward<Args2>(args)...);
         },
         exec_limits));
+    tasks.back()->SetCostFunction(cost_func.get());
   }
 
   template <class F, class... Args>
@@ -530,7 +596,175 @@ class TaskList {
           return func(std::forward<Args>(args)...);
         },
         exec_limits));
+    tasks.back()->SetCostFunction(cost_func.get());
+  }
+};
+
+// Flat representation of the task graph of a TaskRegion. Tasks are numbered
+// contiguously, their dependencies and dependents are stored in compressed sparse row
+// format, and the statuses and claims of all tasks live in contiguous arrays. Checking
+// whether a task is ready then only reads the statuses of its dependencies instead of
+// walking a hash set of pointers into tasks scattered across the heap. Every task also
+// gets a scheduling priority from its own priority and, to break ties, the length of
+// the longest chain of tasks that wait for it to complete, so that ready tasks on the
+// critical path of the region run first.
+class CompiledTaskGraph {
+ public:
+  CompiledTaskGraph() = default;
+  CompiledTaskGraph(const std::vector<Task *> &tasks, const std::vector<Task *> &startup)
+      : tasks_(tasks), status_(new std::atomic<TaskStatus>[tasks.size()]),
+        claimed_(new std::atomic<bool>[tasks.size()]), waits_(tasks.size()),
+        launches_(tasks.size()) {
+    std::unordered_map<Task *, int> index;
+    for (int i = 0; i < tasks_.size(); ++i)
+      index[tasks_[i]] = i;
+    auto get_index = [&index](Task *t) {
+      auto it = index.find(t);
+      PARTHENON_REQUIRE_THROWS(it != index.end(),
+                               "Task depends on a task outside of its TaskRegion.");
+      return it->second;
+    };
+
+    dep_offsets_.push_back(0);
+    for (auto &offsets : next_offsets_)
+      offsets.push_back(0);
+    for (int i = 0; i < tasks_.size(); ++i) {
+      Task *t = tasks_[i];
+      for (auto d : t->GetDependencies())
+        deps_.push_back(get_index(d));
+      dep_offsets_.push_back(deps_.size());
+      for (int s = 0; s < next_.size(); ++s) {
+        for (auto n : t->GetDependent(static_cast<TaskStatus>(s)))
+          next_[s].push_back(get_index(n));
+        next_offsets_[s].push_back(next_[s].size());
+      }
+      claimed_[i].store(false, std::memory_order_relaxed);
+      t->BindStatus(&status_[i]);
+      t->BindLaunch(&launches_[i]);
+    }
+    for (auto t : startup)
+      startup_.push_back(get_index(t));
+
+    // Longest chain of dependents of every task through complete edges, found by a
+    // depth first search. Edges back to a task that is still being visited, which only
+    // exist through iterations, are ignored.
+    const int ntasks = tasks_.size();
+    const auto &offsets = next_offsets_[static_cast<int>(TaskStatus::complete)];
+    const auto &next = next_[static_cast<int>(TaskStatus::complete)];
+    constexpr int unvisited = -1;
+    constexpr int visiting = -2;
+    std::vector<int> height(ntasks, unvisited);
+    std::vector<std::pair<int, int>> stack; // task and its next edge to follow
+    for (int r = 0; r < ntasks; ++r) {
+      if (height[r] != unvisited) continue;
+      height[r] = visiting;
+      stack.emplace_back(r, offsets[r]);
+      while (!stack.empty()) {
+        const int t = stack.back().first;
+        const int e = stack.back().second++;
+        if (e < offsets[t + 1]) {
+          const int n = next[e];
+          if (height[n] == unvisited) {
+            height[n] = visiting;
+            stack.emplace_back(n, offsets[n]);
+          }
+          continue;
+        }
+        int h = 0;
+        for (int m = offsets[t]; m < offsets[t + 1]; ++m)
+          h = std::max(h, height[next[m]] + 1);
+        height[t] = h;
+        stack.pop_back();
+      }
+    }
+    priority_.resize(ntasks);
+    for (int i = 0; i < ntasks; ++i)
+      priority_[i] = static_cast<std::int64_t>(tasks_[i]->GetPriority()) * (ntasks + 1) +
+                     height[i];
+  }
+
+  int size() const { return tasks_.size(); }
+  Task &operator[](const int i) { return *tasks_[i]; }
+  const std::vector<int> &StartupTasks() const { return startup_; }
+  std::int64_t Priority(const int i) const { return priority_[i]; }
+  // What task i waits for while it returns incomplete. Only accessed by the thread that
+  // runs (or claimed) the task.
+  TaskWait &Wait(const int i) { return waits_[i]; }
+  TaskLaunch &Launch(const int i) { return launches_[i]; }
+
+  // The tasks with device work still in flight that the results of the dependencies of
+  // task i depend on. Unless task i is stream ordered, their execution space instances
+  // are fenced and none are returned.
+  std::vector<int> SyncLaunches(const int i) const {
+    std::vector<int> pending;
+    for (int d = dep_offsets_[i]; d < dep_offsets_[i + 1]; ++d) {
+      const auto &p = launches_[deps_[d]].Pending();
+      pending.insert(pending.end(), p.begin(), p.end());
+    }
+    if (pending.empty()) return pending;
+    std::sort(pending.begin(), pending.end());
+    pending.erase(std::unique(pending.begin(), pending.end()), pending.end());
+    if (!tasks_[i]->StreamOrdered()) {
+      for (const int p : pending)
+        launches_[p].Fence();
+      pending.clear();
+    }
+    return pending;
+  }
+  // Wait for all device work left running by the tasks of the graph
+  void FenceLaunches() const {
+    for (const auto &launch : launches_)
+      launch.Fence();
+  }
+
+  bool Ready(const int i) const {
+    for (int d = dep_offsets_[i]; d < dep_offsets_[i + 1]; ++d) {
+      if (status_[deps_[d]].load(std::memory_order_acquire) == TaskStatus::incomplete)
+        return false;
+    }
+    return true;
   }
+
+  // Call f with the index of every task that might become ready once task i returned
+  // status. A failed task has no dependents.
+  template <typename F>
+  void ForEachNext(const int i, const TaskStatus status, F &&f) const {
+    const int s = static_cast<int>(status);
+    if (s >= next_.size()) return;
+    for (int n = next_offsets_[s][i]; n < next_offsets_[s][i + 1]; ++n)
+      f(next_[s][n]);
+  }
+
+  // With concurrent execution, several dependencies can complete at the same time and
+  // find a task ready. Only the one that claims it gets to queue it, and the claim is
+  // released once the task has run.
+  bool TryClaim(const int i) {
+    return !claimed_[i].exchange(true, std::memory_order_acq_rel);
+  }
+  void ReleaseClaim(const int i) { claimed_[i].store(false, std::memory_order_release); }
+
+  // Mark every task as not yet run so that the graph can be executed again
+  void Reset() {
+    for (int i = 0; i < tasks_.size(); ++i) {
+      status_[i].store(TaskStatus::incomplete, std::memory_order_relaxed);
+      claimed_[i].store(false, std::memory_order_relaxed);
+      waits_[i].Completed();
+      launches_[i].Clear();
+    }
+  }
+
+ private:
+  std::vector<Task *> tasks_;
+  std::vector<int> dep_offsets_, deps_;
+  // dependents of every task for each status that can release them
+  std::array<std::vector<int>, 3> next_offsets_, next_;
+  std::unique_ptr<std::atomic<TaskStatus>[]> status_;
+  std::unique_ptr<std::atomic<bool>[]> claimed_;
+  // the first_task of each top level list in the region
+  std::vector<int> startup_;
+  std::vector<std::int64_t> priority_;
+  std::vector<TaskWait> waits_;
+  std::vector<TaskLaunch> launches_;
 };
 
 class TaskCollection;
@@ -548,36 +782,55 @@ class TaskRegion {
     // for now, require a pool with one thread
     PARTHENON_REQUIRE_THROWS(pool.size() == 1,
                              "ThreadPool size != 1 is not currently supported.")
+    RegionTelemetry region_telemetry;
 
     // first, if needed, finish building the graph
-    if (!graph_built) BuildGraph();
-
-    // declare this so it can call itself
-    std::function<TaskStatus(Task *)> ProcessTask;
-    ProcessTask = [&pool, &ProcessTask](Task *task) -> TaskStatus {
-      auto status = task->operator()();
-      auto next_up = task->GetDependent(status);
-      for (auto t : next_up) {
-        if (t->ready()) {
-          pool.enqueue([t, &ProcessTask]() { return ProcessTask(t); });
-        }
-      }
-      return status;
-    };
+    Compile();
+    graph.Reset();
 
     // now enqueue the "first_task" for all task lists
-    for (auto &tl : task_lists) {
-      auto t = tl.GetStartupTask();
-      pool.enqueue([t, &ProcessTask]() { return ProcessTask(t); });
+    for (const int i : graph.StartupTasks()) {
+      pool.enqueue_with_priority(graph.Priority(i),
+                                 [this, i, &pool]() { return ProcessTask(i, pool); });
     }
 
     // then wait until everything is done
     pool.wait();
+    graph.FenceLaunches();
 
     // Check the results, so as to fire any exceptions from threads
     // Return failure if a task failed
-    return (pool.check_task_returns() == TaskStatus::complete) ? TaskListStatus::complete
-                                                               : TaskListStatus::fail;
+    const auto status = pool.check_task_returns();
+    if (TaskProfiler::Instance().Enabled()) TaskProfiler::Instance().FinishRegion();
+    return (status == TaskStatus::complete) ? TaskListStatus::complete
+                                            : TaskListStatus::fail;
+  }
+
+  // Execute the region on a pool with any number of threads. The tasks of different
+  // lists can run concurrently and therefore need to be thread-safe.
+  TaskListStatus Execute(WorkStealingPool &pool) {
+    RegionTelemetry region_telemetry;
+    Compile();
+    graph.Reset();
+
+    for (const int i : graph.StartupTasks()) {
+      graph.TryClaim(i);
+      pool.enqueue([this, i, &pool]() { return ProcessTask(i, pool); },
+                   graph.Priority(i));
+    }
+
+    const auto status = pool.check_task_returns();
+    graph.FenceLaunches();
+    if (TaskProfiler::Instance().Enabled()) TaskProfiler::Instance().FinishRegion();
+    return (status == TaskStatus::complete) ? TaskListStatus::complete
+                                            : TaskListStatus::fail;
+  }
+
+  // Freeze the task graph of the region into a CompiledTaskGraph. This happens
+  // automatically the first time the region is executed, after which no more tasks can
+  // be added. A compiled region can be executed any number of times.
+  void Compile() {
+    if (!graph_built) BuildGraph();
   }
 
   TaskList &operator[](const int i) { return task_lists[i]; }
@@ -591,11 +844,95 @@ class TaskRegion {
   }
 
  private:
+  // Reports the wall time of the region execution it is scoped to to the telemetry
+  struct RegionTelemetry {
+    double start = Telemetry::Instance().Enabled() ? Telemetry::Instance().Now() : -1.0;
+    ~RegionTelemetry() {
+      auto &telemetry = Telemetry::Instance();
+      if (start >= 0.0) telemetry.AddRegion(telemetry.Now() - start);
+    }
+  };
+
   std::vector<TaskList> task_lists;
   bool graph_built = false;
+  CompiledTaskGraph graph;
+
+  // Number of queued PollTask calls
+  std::atomic<int> npolling{0};
+
+  TaskStatus RunTask(const int i) {
+    auto &wait = graph.Wait(i);
+    wait.Begin();
+    graph.Launch(i).Begin(i, graph.SyncLaunches(i));
+    const auto status = graph[i]();
+    if (status == TaskStatus::incomplete) {
+      wait.Incomplete(TaskWait::Now());
+    } else {
+      wait.Completed();
+    }
+    return status;
+  }
+
+  // A task that returned incomplete, typically because it is waiting for messages, is
+  // queued behind all other ready tasks and only run again once what it waits for may
+  // have arrived, see TaskWait. When there is nothing else to do until then, the thread
+  // sleeps instead of spinning.
+  template <class Pool>
+  void EnqueuePoll(const int i, Pool &pool) {
+    npolling++;
+    auto poll = [this, i, &pool]() { return PollTask(i, pool); };
+    if constexpr (std::is_same_v<Pool, ThreadPool>) {
+      pool.enqueue_with_priority(std::numeric_limits<std::int64_t>::min(), poll);
+    } else {
+      pool.enqueue(poll, std::numeric_limits<std::int64_t>::min());
+    }
+  }
+
+  template <class Pool>
+  TaskStatus PollTask(const int i, Pool &pool) {
+    npolling--;
+    const auto &wait = graph.Wait(i);
+    const double now = TaskWait::Now();
+    if (wait.Retry(now)) return ProcessTask(i, pool);
+    if (pool.num_queued() <= npolling) {
+      const double sleep = std::min(wait.RetryAt() - now, TaskWait::max_backoff);
+      std::this_thread::sleep_for(std::chrono::duration<double>(sleep));
+    }
+    EnqueuePoll(i, pool);
+    return TaskStatus::incomplete;
+  }
+
+  TaskStatus ProcessTask(const int i, ThreadPool &pool) {
+    const auto status = RunTask(i);
+    graph.ForEachNext(i, status, [this, i, status, &pool](const int n) {
+      if (!graph.Ready(n)) return;
+      if (n == i && status == TaskStatus::incomplete) {
+        EnqueuePoll(n, pool);
+      } else {
+        pool.enqueue_with_priority(graph.Priority(n),
+                                   [this, n, &pool]() { return ProcessTask(n, pool); });
+      }
+    });
+    return status;
+  }
+
+  TaskStatus ProcessTask(const int i, WorkStealingPool &pool) {
+    const auto status = RunTask(i);
+    graph.ReleaseClaim(i);
+    graph.ForEachNext(i, status, [this, i, status, &pool](const int n) {
+      if (!graph.Ready(n) || !graph.TryClaim(n)) return;
+      if (n == i && status == TaskStatus::incomplete) {
+        EnqueuePoll(n, pool);
+      } else {
+        pool.enqueue([this, n, &pool]() { return ProcessTask(n, pool); },
+                     graph.Priority(n));
+      }
+    });
+    return status;
+  }
 
   void AppendTasks(std::vector<std::shared_ptr<Task>> &tasks_inout) {
-    BuildGraph();
+    Compile();
     for (const auto &tl : task_lists) {
       tl.AppendTasks(tasks_inout);
     }
@@ -654,6 +991,16 @@ class TaskRegion {
     for (auto &tl : task_lists) {
       tl.SetGraphBuilt();
     }
+
+    std::vector<Task *> tasks, startup;
+    for (auto &tl : task_lists) {
+      startup.push_back(tl.GetStartupTask());
+      for (auto ptl : tl.GetAllTaskLists()) {
+        for (auto &pt : ptl->tasks)
+          tasks.push_back(pt.get());
+      }
+    }
+    graph = CompiledTaskGraph(tasks, startup);
   }
 };
 
@@ -665,11 +1012,22 @@ class TaskCollection {
     regions.emplace_back(num_lists);
     return regions.back();
   }
+  template <typename F>
+  void ForEachRegion(F &&f) {
+    for (auto &region : regions)
+      f(region);
+  }
+  // Compile the task graphs of all regions up front, see TaskRegion::Compile
+  void Compile() {
+    for (auto &region : regions)
+      region.Compile();
+  }
   TaskListStatus Execute() {
     static ThreadPool pool(1);
     return Execute(pool);
   }
-  TaskListStatus Execute(ThreadPool &pool) {
+  template <class Pool>
+  TaskListStatus Execute(Pool &pool) {
     TaskListStatus status;
     for (auto &region : regions) {
       status = region.Execute(pool);
@@ -14,9 +14,15 @@
 #ifndef TASKS_THREAD_POOL_HPP_
 #define TASKS_THREAD_POOL_HPP_
 
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
 #include <functional>
 #include <future>
+#include <iterator>
 #include <memory>
 #include <mutex>
 #include <queue>
@@ -24,17 +30,21 @@
 #include <utility>
 #include <vector>
 
+#include "utils/affinity.hpp"
+
 namespace parthenon {
 
 class TaskList;
 
+// Queue of work for the threads of a ThreadPool. Work with a higher priority is popped
+// first, work of the same priority in the order it was pushed.
 template <typename T>
 class ThreadQueue {
  public:
   explicit ThreadQueue(const int num_workers) : nworkers(num_workers), nwaiting(0) {}
-  void push(T q) {
+  void push(T q, const std::int64_t priority = 0) {
     std::lock_guard<std::mutex> lock(mutex);
-    queue.push(q);
+    queue.push(Item{priority, npushed++, std::move(q)});
     cv.notify_one();
   }
   bool pop(T &q) {
@@ -49,13 +59,17 @@ class ThreadQueue {
       nwaiting--;
       if (exit) return true;
     }
-    q = queue.front();
+    q = queue.top().work;
     queue.pop();
     return false;
   }
+  std::size_t size() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return queue.size();
+  }
   void signal_kill() {
     std::lock_guard<std::mutex> lock(mutex);
-    std::queue<T>().swap(queue);
+    queue_t().swap(queue);
     complete = true;
     exit = true;
     cv.notify_all();
@@ -80,9 +94,21 @@ class ThreadQueue {
   }
 
  private:
+  struct Item {
+    std::int64_t priority;
+    std::uint64_t order;
+    T work;
+    bool operator<(const Item &other) const {
+      return priority != other.priority ? priority < other.priority
+                                        : order > other.order;
+    }
+  };
+  using queue_t = std::priority_queue<Item>;
+
   const int nworkers;
   int nwaiting;
-  std::queue<T> queue;
+  queue_t queue;
+  std::uint64_t npushed = 0;
   std::mutex mutex;
   std::condition_variable cv;
   std::condition_variable complete_cv;
@@ -122,12 +148,17 @@ class ThreadVector {
   std::mutex mutex;
 };
 
+// If cores is not empty, worker i of this or the WorkStealingPool is pinned to the core
+// cores[i % size], see affinity::GetAllowedCores and affinity::GetNUMADomains
 class ThreadPool {
  public:
-  explicit ThreadPool(const int numthreads = std::thread::hardware_concurrency())
+  explicit ThreadPool(const int numthreads = std::thread::hardware_concurrency(),
+                      const std::vector<int> &cores = {})
       : nthreads(numthreads), queue(nthreads) {
     for (int i = 0; i < nthreads; i++) {
-      auto worker = [&]() {
+      const int core = cores.empty() ? -1 : cores[i % cores.size()];
+      auto worker = [&, core]() {
+        if (core >= 0) affinity::PinCurrentThread({core});
         while (true) {
           std::function<void()> f;
           auto stop = queue.pop(f);
@@ -159,7 +190,18 @@ class ThreadPool {
     queue.push([task]() { (*task)(); });
   }
 
+  // Like enqueue, but ready work of a higher priority is run first
+  template <typename F>
+  void enqueue_with_priority(const std::int64_t priority, F &&f) {
+    using return_t = typename std::invoke_result_t<F>;
+    auto task = std::make_shared<std::packaged_task<return_t()>>(std::forward<F>(f));
+    if constexpr (std::is_same<return_t, TaskStatus>::value) run_tasks.push(task);
+    queue.push([task]() { (*task)(); }, priority);
+  }
+
   int size() const { return nthreads; }
+  // Number of functions waiting in the queue
+  int num_queued() { return queue.size(); }
 
   // Mostly this exists to throw any exceptions,
   // but we can check returns too.
@@ -183,6 +225,161 @@ class ThreadPool {
   ThreadVector<std::shared_ptr<std::packaged_task<TaskStatus()>>> run_tasks;
 };
 
+// Alternative to ThreadPool where every worker thread owns a deque of work. Work enqueued
+// from a worker goes to the back of its own deque, which it also pops from, so that
+// dependent tasks tend to run on the thread that made them ready. Idle workers steal
+// from the front of the deques of other workers. In contrast to the single queue of
+// ThreadPool, threads only contend when they access the same deque.
+class WorkStealingPool {
+ public:
+  explicit WorkStealingPool(const int numthreads = std::thread::hardware_concurrency(),
+                            const std::vector<int> &cores = {})
+      : nthreads(numthreads) {
+    for (int i = 0; i < nthreads; i++)
+      queues.emplace_back(std::make_unique<WorkerQueue>());
+    for (int i = 0; i < nthreads; i++) {
+      const int core = cores.empty() ? -1 : cores[i % cores.size()];
+      threads.emplace_back([this, i, core]() {
+        if (core >= 0) affinity::PinCurrentThread({core});
+        Worker(i);
+      });
+    }
+  }
+  ~WorkStealingPool() {
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex);
+      exit = true;
+    }
+    sleep_cv.notify_all();
+    for (auto &t : threads) {
+      t.join();
+    }
+  }
+
+  // Only parthenon tasks (or other functions returning a TaskStatus) are supported.
+  // Every deque is kept sorted by priority, so a worker runs its own work of the highest
+  // priority first and others steal the work of the lowest priority.
+  template <typename F>
+  void enqueue(F &&f, const std::int64_t priority = 0) {
+    npending++;
+    const int id = (current_pool() == this) ? current_worker() : next_queue++ % nthreads;
+    {
+      std::lock_guard<std::mutex> lock(queues[id]->mutex);
+      auto &work = queues[id]->work;
+      auto it = work.end();
+      while (it != work.begin() && std::prev(it)->priority > priority)
+        --it;
+      work.insert(it, Item{priority, std::forward<F>(f)});
+    }
+    nqueued++;
+    {
+      // Synchronize with workers that are about to go to sleep so the wake-up is not lost
+      std::lock_guard<std::mutex> lock(sleep_mutex);
+    }
+    sleep_cv.notify_one();
+  }
+
+  // Wait until all enqueued work (including work enqueued by that work) is done
+  void wait() {
+    std::unique_lock<std::mutex> lock(sleep_mutex);
+    done_cv.wait(lock, [this]() { return npending == 0; });
+  }
+
+  int size() const { return nthreads; }
+  // Number of functions waiting in the queues
+  int num_queued() const { return nqueued; }
+
+  // Rethrow the first exception thrown by any task and return whether any task failed
+  TaskStatus check_task_returns() {
+    wait();
+    if (exception) {
+      auto e = exception;
+      exception = nullptr;
+      failed = false;
+      std::rethrow_exception(e);
+    }
+    return failed.exchange(false) ? TaskStatus::fail : TaskStatus::complete;
+  }
+
+ private:
+  struct Item {
+    std::int64_t priority;
+    std::function<TaskStatus()> f;
+  };
+  struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<Item> work;
+  };
+
+  const int nthreads;
+  std::vector<std::unique_ptr<WorkerQueue>> queues;
+  std::vector<std::thread> threads;
+  // Number of functions that are queued or running, and that are only queued
+  std::atomic<int> npending{0};
+  std::atomic<int> nqueued{0};
+  std::atomic<unsigned int> next_queue{0};
+  std::atomic<bool> failed{false};
+  std::exception_ptr exception = nullptr;
+  std::mutex exception_mutex;
+  std::mutex sleep_mutex;
+  std::condition_variable sleep_cv;
+  std::condition_variable done_cv;
+  bool exit = false;
+
+  static WorkStealingPool *&current_pool() {
+    static thread_local WorkStealingPool *pool = nullptr;
+    return pool;
+  }
+  static int &current_worker() {
+    static thread_local int id = -1;
+    return id;
+  }
+
+  bool TryGetWork(const int id, std::function<TaskStatus()> &f) {
+    for (int n = 0; n < nthreads; ++n) {
+      const int victim = (id + n) % nthreads;
+      auto &q = *queues[victim];
+      std::lock_guard<std::mutex> lock(q.mutex);
+      if (q.work.empty()) continue;
+      if (victim == id) {
+        f = std::move(q.work.back().f);
+        q.work.pop_back();
+      } else {
+        f = std::move(q.work.front().f);
+        q.work.pop_front();
+      }
+      nqueued--;
+      return true;
+    }
+    return false;
+  }
+
+  void Worker(const int id) {
+    current_pool() = this;
+    current_worker() = id;
+    while (true) {
+      std::function<TaskStatus()> f;
+      if (TryGetWork(id, f)) {
+        try {
+          if (f() == TaskStatus::fail) failed = true;
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(exception_mutex);
+          if (!exception) exception = std::current_exception();
+        }
+        if (--npending == 0) {
+          std::lock_guard<std::mutex> lock(sleep_mutex);
+          done_cv.notify_all();
+        }
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(sleep_mutex);
+      if (exit) break;
+      sleep_cv.wait(lock, [this]() { return exit || nqueued > 0; });
+      if (exit && nqueued == 0) break;
+    }
+  }
+};
+
 } // namespace parthenon
 
 #endif // TASKS_THREAD_POOL_HPP_
@@ -11,12 +11,16 @@
 // the public, perform publicly and display publicly, and to permit others to do so.
 //========================================================================================
 
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
 #include "basic_types.hpp"
 #include "parameter_input.hpp"
 #include "staged_integrator.hpp"
+#include "utils/error_checking.hpp"
 
 namespace parthenon {
 
@@ -58,6 +62,7 @@ ButcherIntegrator::ButcherIntegrator(const std::string &name) : StagedIntegrator
     a[1] = {1, 0};
     b = {0, 1};
     c = {0, 1. / 3., 2. / 3.};
+    order = 2;
   } else if (name_ == "rk4") {
     // Classic RK4 because why not
     nstages = nbuffers = 4;
@@ -71,6 +76,87 @@ ButcherIntegrator::ButcherIntegrator(const std::string &name) : StagedIntegrator
     /* clang-format on */
     b = {1. / 6., 1. / 3., 1. / 3., 1. / 6.};
     c = {0, 0.5, 0.5, 1};
+    order = 4;
+  } else if (name_ == "bs3") {
+    // Bogacki and Shampine, Appl. Math. Lett. 2 (1989) 321-325. Third order with an
+    // embedded second order solution. The last stage is evaluated at the new solution
+    // (first same as last), but it is kept as a regular stage here.
+    nstages = nbuffers = 4;
+    Resize_(nstages);
+
+    /* clang-format off */
+    a[0] = {0,       0,       0,       0};
+    a[1] = {0.5,     0,       0,       0};
+    a[2] = {0,       0.75,    0,       0};
+    a[3] = {2. / 9., 1. / 3., 4. / 9., 0};
+    /* clang-format on */
+    b = {2. / 9., 1. / 3., 4. / 9., 0};
+    b_embedded = {7. / 24., 1. / 4., 1. / 3., 1. / 8.};
+    c = {0, 0.5, 0.75, 1};
+    order = 3;
+    embedded_order = 2;
+  } else if (name_ == "ck45") {
+    // Cash and Karp, ACM Trans. Math. Softw. 16 (1990) 201-222. Fifth order with an
+    // embedded fourth order solution.
+    nstages = nbuffers = 6;
+    Resize_(nstages);
+
+    // Resize_ zero initializes the matrix, only set the non-zero coeffs
+    a[1][0] = 1. / 5.;
+    a[2][0] = 3. / 40.;
+    a[2][1] = 9. / 40.;
+    a[3][0] = 3. / 10.;
+    a[3][1] = -9. / 10.;
+    a[3][2] = 6. / 5.;
+    a[4][0] = -11. / 54.;
+    a[4][1] = 5. / 2.;
+    a[4][2] = -70. / 27.;
+    a[4][3] = 35. / 27.;
+    a[5][0] = 1631. / 55296.;
+    a[5][1] = 175. / 512.;
+    a[5][2] = 575. / 13824.;
+    a[5][3] = 44275. / 110592.;
+    a[5][4] = 253. / 4096.;
+    b = {37. / 378., 0, 250. / 621., 125. / 594., 0, 512. / 1771.};
+    b_embedded = {2825. / 27648.,  0,           18575. / 48384.,
+                  13525. / 55296., 277. / 14336., 1. / 4.};
+    c = {0, 1. / 5., 3. / 10., 3. / 5., 1, 7. / 8.};
+    order = 5;
+    embedded_order = 4;
+  } else if (name_ == "dp45") {
+    // Dormand and Prince, J. Comput. Appl. Math. 6 (1980) 19-26. Fifth order with an
+    // embedded fourth order solution. As for bs3, the first same as last property is
+    // not exploited.
+    nstages = nbuffers = 7;
+    Resize_(nstages);
+
+    // Resize_ zero initializes the matrix, only set the non-zero coeffs
+    a[1][0] = 1. / 5.;
+    a[2][0] = 3. / 40.;
+    a[2][1] = 9. / 40.;
+    a[3][0] = 44. / 45.;
+    a[3][1] = -56. / 15.;
+    a[3][2] = 32. / 9.;
+    a[4][0] = 19372. / 6561.;
+    a[4][1] = -25360. / 2187.;
+    a[4][2] = 64448. / 6561.;
+    a[4][3] = -212. / 729.;
+    a[5][0] = 9017. / 3168.;
+    a[5][1] = -355. / 33.;
+    a[5][2] = 46732. / 5247.;
+    a[5][3] = 49. / 176.;
+    a[5][4] = -5103. / 18656.;
+    a[6][0] = 35. / 384.;
+    a[6][2] = 500. / 1113.;
+    a[6][3] = 125. / 192.;
+    a[6][4] = -2187. / 6784.;
+    a[6][5] = 11. / 84.;
+    b = {35. / 384., 0, 500. / 1113., 125. / 192., -2187. / 6784., 11. / 84., 0};
+    b_embedded = {5179. / 57600.,    0,            7571. / 16695., 393. / 640.,
+                  -92097. / 339200., 187. / 2100., 1. / 40.};
+    c = {0, 1. / 5., 3. / 10., 4. / 5., 8. / 9., 1, 1};
+    order = 5;
+    embedded_order = 4;
   } else if (name_ == "rk10") {
     // Feagin's family of high-order embedded methods as introduced in
     // Feagin, Neural, Parallel, and Scientific Computations 20 (2012)
@@ -91,6 +177,8 @@ ButcherIntegrator::ButcherIntegrator(const std::string &name) : StagedIntegrator
     nstages = nbuffers = 17;
     Resize_(nstages);
 
+    order = 10;
+
     // computed up to 60 digits
     c[0] = 0.000000000000000000000000000000000000000000000000000000000000;
     c[1] = 0.100000000000000000000000000000000000000000000000000000000000;
@@ -220,7 +308,11 @@ ButcherIntegrator::ButcherIntegrator(const std::string &name) : StagedIntegrator
     a[16][13] = -0.259111214548322744512977076191767379267783684543182428778156;
     a[16][14] = -0.342758159847189839942220553413850871742338734703958919937260;
     a[16][15] = -0.675000000000000000000000000000000000000000000000000000000000;
+  } else {
+    throw std::invalid_argument("Invalid selection for the time integrator: " + name_);
   }
+  MakeRegisterNames_(register_name, nstages);
+  AssignRhsRegisters_();
 }
 
 //----------------------------------------------------------------------------------------
@@ -228,7 +320,58 @@ ButcherIntegrator::ButcherIntegrator(const std::string &name) : StagedIntegrator
 //! \brief Constructs a ButcherIntegrator instance given ParameterInput *pin
 
 ButcherIntegrator::ButcherIntegrator(ParameterInput *pin)
-    : ButcherIntegrator(pin->GetOrAddString("parthenon/time", "integrator", "rk2")) {}
+    : ButcherIntegrator(pin->GetOrAddString("parthenon/time", "integrator", "rk2")) {
+  if (IsEmbedded()) {
+    atol = pin->GetOrAddReal("parthenon/time", "error_atol", atol);
+    rtol = pin->GetOrAddReal("parthenon/time", "error_rtol", rtol);
+    safety = pin->GetOrAddReal("parthenon/time", "error_safety", safety);
+    max_growth = pin->GetOrAddReal("parthenon/time", "error_max_growth", max_growth);
+    min_shrink = pin->GetOrAddReal("parthenon/time", "error_min_shrink", min_shrink);
+    max_rejections =
+        pin->GetOrAddInteger("parthenon/time", "error_max_rejections", max_rejections);
+    PARTHENON_REQUIRE_THROWS(atol > 0.0 || rtol > 0.0,
+                             "error_atol or error_rtol must be positive");
+    PARTHENON_REQUIRE_THROWS(0.0 < min_shrink && min_shrink < 1.0 && max_growth > 1.0,
+                             "error_min_shrink must be in (0, 1), error_max_growth > 1");
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn  Real ButcherIntegrator::ErrorControlledDt(Real dt) const
+//! \brief Standard controller dt_new = safety * dt * error^(-1 / (q + 1)), with q the
+//! lower of the two orders of an embedded pair, limited to [min_shrink, max_growth] * dt
+
+Real ButcherIntegrator::ErrorControlledDt(Real dt) const {
+  if (!IsEmbedded()) return dt;
+  if (error <= 0.0) return max_growth * dt;
+  const Real q = std::min(order, embedded_order);
+  const Real factor = safety * std::pow(error, -1.0 / (q + 1.0));
+  return dt * std::clamp(factor, min_shrink, max_growth);
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn  void ButcherIntegrator::AssignRhsRegisters_()
+//! \brief The right-hand side of stage j is needed from stage j until the last stage
+//! s with a[s + 1][j] != 0 (the new state is accumulated on the fly, so b doesn't
+//! extend this). Assign registers to these intervals greedily in the order of stages.
+
+void ButcherIntegrator::AssignRhsRegisters_() {
+  // For every register, the last stage that needs its current right-hand side
+  std::vector<int> busy_until;
+  rhs_register.assign(nstages, 0);
+  for (int j = 0; j < nstages; ++j) {
+    int last_use = j;
+    for (int i = j + 1; i < nstages; ++i) {
+      if (a[i][j] != 0.0) last_use = i - 1;
+    }
+    auto free = std::find_if(busy_until.begin(), busy_until.end(),
+                             [j](const int until) { return until < j; });
+    if (free == busy_until.end()) free = busy_until.insert(busy_until.end(), 0);
+    *free = last_use;
+    rhs_register[j] = free - busy_until.begin();
+  }
+  nrhs_registers = busy_until.size();
+}
 
 //----------------------------------------------------------------------------------------
 //! \fn  void ButcherIntegrator::Resize_(int nstages)
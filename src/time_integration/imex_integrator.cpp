@@ -0,0 +1,148 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "basic_types.hpp"
+#include "parameter_input.hpp"
+#include "staged_integrator.hpp"
+
+namespace parthenon {
+
+/*
+ * Implicit-explicit (IMEX) additive Runge-Kutta integrators for
+ *
+ * du/dt = E(u) + I(u)
+ *
+ * with the non-stiff part E treated explicitly and the stiff part I implicitly. Every
+ * stage i solves
+ *
+ * u_i - dt a_im[i][i] I(u_i) = u^n + dt sum_{j<i} (a_ex[i][j] E_j + a_im[i][j] I_j)
+ *
+ * and the step is u^{n+1} = u^n + dt sum_j (b_ex[j] E_j + b_im[j] I_j).
+ */
+
+//----------------------------------------------------------------------------------------
+//! \class ImexIntegrator::ImexIntegrator(const std::string &name)
+//! \brief Constructs an ImexIntegrator instance given a string (e.g., ars222, ssp2_222)
+
+ImexIntegrator::ImexIntegrator(const std::string &name) : StagedIntegrator(name) {
+  if (name_ == "ars222") {
+    // Ascher, Ruuth, and Spiteri, Appl. Numer. Math. 25 (1997) 151-167, section 2.6.
+    // The first stage is explicit and the method is stiffly accurate.
+    nstages = nbuffers = 3;
+    Resize_(nstages);
+
+    const Real gamma = 1. - 1. / std::sqrt(2.);
+    const Real delta = 1. - 1. / (2. * gamma);
+    a_ex[1][0] = gamma;
+    a_ex[2][0] = delta;
+    a_ex[2][1] = 1. - delta;
+    b_ex = {delta, 1. - delta, 0};
+    c_ex = {0, gamma, 1};
+
+    a_im[1][1] = gamma;
+    a_im[2][1] = 1. - gamma;
+    a_im[2][2] = gamma;
+    b_im = {0, 1. - gamma, gamma};
+    c_im = {0, gamma, 1};
+  } else if (name_ == "ars443") {
+    // Ascher, Ruuth, and Spiteri, Appl. Numer. Math. 25 (1997) 151-167, section 2.8.
+    // Third order, with an explicit first stage, and stiffly accurate.
+    nstages = nbuffers = 5;
+    Resize_(nstages);
+
+    a_ex[1][0] = 1. / 2.;
+    a_ex[2][0] = 11. / 18.;
+    a_ex[2][1] = 1. / 18.;
+    a_ex[3][0] = 5. / 6.;
+    a_ex[3][1] = -5. / 6.;
+    a_ex[3][2] = 1. / 2.;
+    a_ex[4][0] = 1. / 4.;
+    a_ex[4][1] = 7. / 4.;
+    a_ex[4][2] = 3. / 4.;
+    a_ex[4][3] = -7. / 4.;
+    b_ex = {1. / 4., 7. / 4., 3. / 4., -7. / 4., 0};
+    c_ex = {0, 1. / 2., 2. / 3., 1. / 2., 1};
+
+    a_im[1][1] = 1. / 2.;
+    a_im[2][1] = 1. / 6.;
+    a_im[2][2] = 1. / 2.;
+    a_im[3][1] = -1. / 2.;
+    a_im[3][2] = 1. / 2.;
+    a_im[3][3] = 1. / 2.;
+    a_im[4][1] = 3. / 2.;
+    a_im[4][2] = -3. / 2.;
+    a_im[4][3] = 1. / 2.;
+    a_im[4][4] = 1. / 2.;
+    b_im = {0, 3. / 2., -3. / 2., 1. / 2., 1. / 2.};
+    c_im = c_ex;
+  } else if (name_ == "ssp2_222") {
+    // Pareschi and Russo, J. Sci. Comput. 25 (2005) 129-155, SSP2(2,2,2). The explicit
+    // part is Heun's method, the implicit one an L-stable SDIRK method.
+    nstages = nbuffers = 2;
+    Resize_(nstages);
+
+    const Real gamma = 1. - 1. / std::sqrt(2.);
+    a_ex[1][0] = 1;
+    b_ex = {0.5, 0.5};
+    c_ex = {0, 1};
+
+    a_im[0][0] = gamma;
+    a_im[1][0] = 1. - 2. * gamma;
+    a_im[1][1] = gamma;
+    b_im = {0.5, 0.5};
+    c_im = {gamma, 1. - gamma};
+  } else {
+    throw std::invalid_argument("Invalid selection for the IMEX integrator: " + name_);
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//! \class ImexIntegrator::ImexIntegrator(ParameterInput *pin)
+//! \brief Constructs an ImexIntegrator instance given ParameterInput *pin
+
+ImexIntegrator::ImexIntegrator(ParameterInput *pin)
+    : ImexIntegrator(pin->GetOrAddString("parthenon/time", "integrator", "ars222")) {}
+
+//----------------------------------------------------------------------------------------
+//! \fn  bool ImexIntegrator::ImplicitOperatorChanged(int stage)
+//! \brief Whether the operator 1 - dt a_im[stage][stage] I of an implicit stage
+//! differs from the one of the last implicit stage this was called for, i.e., whether
+//! a solver setup computed for the latter has to be redone
+
+bool ImexIntegrator::ImplicitOperatorChanged(const int stage) {
+  const Real factor = ImplicitFactor(stage);
+  if (factor == 0.0) return false;
+  const bool changed = factor != last_implicit_factor_;
+  last_implicit_factor_ = factor;
+  return changed;
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn  void ImexIntegrator::Resize_(int nstages)
+//! \brief Resizes and zeros the ImexIntegrator tableaux given the number of stages
+
+void ImexIntegrator::Resize_(int nstages) {
+  a_ex.assign(nstages, std::vector<Real>(nstages, 0));
+  a_im.assign(nstages, std::vector<Real>(nstages, 0));
+  b_ex.assign(nstages, 0);
+  b_im.assign(nstages, 0);
+  c_ex.assign(nstages, 0);
+  c_im.assign(nstages, 0);
+}
+
+} // namespace parthenon
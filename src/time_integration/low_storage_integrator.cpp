@@ -158,6 +158,7 @@ LowStorageIntegrator::LowStorageIntegrator(const std::string &name)
   }
   MakePeriodicNames_(buffer_name, nbuffers);
   MakePeriodicNames_(stage_name, nstages);
+  MakeRegisterNames_(register_name, nstages);
 }
 
 //----------------------------------------------------------------------------------------
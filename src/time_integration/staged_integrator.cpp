@@ -29,4 +29,9 @@ void StagedIntegrator::MakePeriodicNames_(std::vector<std::string> &names, int n
   names[n] = names[0];
 }
 
+void StagedIntegrator::MakeRegisterNames_(std::vector<std::string> &names, int n) {
+  names.assign(n + 1, "1");
+  names[0] = names[n] = "base";
+}
+
 } // namespace parthenon
@@ -38,12 +38,19 @@ class StagedIntegrator {
   // Names of integration stages (for backwards compatibility)
   // TODO(JMM): Remove this eventually
   std::vector<std::string> stage_name;
+  // Like stage_name, the container holding the state after stage s (with "base" before
+  // the first and after the last stage), but intermediate states reuse the same
+  // register. The storage of the state then scales with the number of registers of the
+  // scheme rather than its number of stages. This requires the stage updates to work
+  // in place, i.e., out may be the same container as in.
+  std::vector<std::string> register_name;
 
   const std::string &GetName() const { return name_; }
 
  protected:
   std::string name_;
   void MakePeriodicNames_(std::vector<std::string> &names, int n);
+  void MakeRegisterNames_(std::vector<std::string> &names, int n);
 };
 
 class LowStorageIntegrator : public StagedIntegrator {
@@ -67,8 +74,59 @@ class ButcherIntegrator : public StagedIntegrator {
   std::vector<std::vector<Real>> a;
   std::vector<Real> b, c;
 
+  // Weights of the embedded solution of embedded tableaux (bs3, ck45, dp45), empty
+  // otherwise. The difference to the solution with b estimates the local error.
+  std::vector<Real> b_embedded;
+  int order = 1, embedded_order = 0;
+  bool IsEmbedded() const { return !b_embedded.empty(); }
+
+  // Step size control for embedded tableaux. The error of a step, normalized by
+  // atol + rtol * |u|, is accepted if it is at most one.
+  Real atol = 1.e-6, rtol = 1.e-6;
+  Real safety = 0.9, max_growth = 5.0, min_shrink = 0.2;
+  int max_rejections = 20;
+
+  // For Update::ButcherRegisterStage, which accumulates the new state while going
+  // through the stages, the right-hand side of stage s is stored in register
+  // rhs_register[s] of the nrhs_registers. Registers are reused once no later stage
+  // needs their right-hand side anymore, e.g., rk4 needs a single one.
+  std::vector<int> rhs_register;
+  int nrhs_registers = 0;
+  // Normalized error of the current attempt, maximized over the mesh by the application
+  // tasks (see Update::ButcherErrorEstimate) and reset by the driver before every attempt
+  Real error = 0.0;
+  bool StepAccepted() const { return error <= 1.0; }
+  // Step size for the next attempt (after a rejection) or step (after an acceptance)
+  Real ErrorControlledDt(Real dt) const;
+
  protected:
   void Resize_(int nstages);
+  void AssignRhsRegisters_();
+};
+
+// Additive implicit-explicit Runge-Kutta tableaux, see imex_integrator.cpp. All
+// tableaux are diagonally implicit with the same diagonal coefficient in all implicit
+// stages, so the operator of the implicit solves is the same across a step.
+class ImexIntegrator : public StagedIntegrator {
+ public:
+  ImexIntegrator() = default;
+  explicit ImexIntegrator(const std::string &name);
+  explicit ImexIntegrator(ParameterInput *pin);
+  // Explicit and implicit tableaux, a_im is lower triangular including the diagonal
+  std::vector<std::vector<Real>> a_ex, a_im;
+  std::vector<Real> b_ex, b_im, c_ex, c_im;
+
+  // The implicit solve of stage is (1 - ImplicitFactor(stage) I) u = rhs, no solve is
+  // needed if it vanishes
+  Real ImplicitFactor(int stage) const { return dt * a_im[stage][stage]; }
+  bool IsImplicitStage(int stage) const { return a_im[stage][stage] != 0.0; }
+  bool ImplicitOperatorChanged(int stage);
+
+ protected:
+  void Resize_(int nstages);
+
+ private:
+  Real last_implicit_factor_ = 0.0;
 };
 
 } // namespace parthenon
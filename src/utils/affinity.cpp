@@ -0,0 +1,211 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "utils/affinity.hpp"
+#include "utils/error_checking.hpp"
+
+namespace parthenon {
+namespace affinity {
+
+namespace {
+// Parses a Linux cpu list such as "0-3,8,10-11"
+std::vector<int> ParseCPUList(const std::string &list) {
+  std::vector<int> cores;
+  std::stringstream ss(list);
+  std::string range;
+  while (std::getline(ss, range, ',')) {
+    if (range.empty() || range == "\n") continue;
+    const auto dash = range.find('-');
+    const int first = std::stoi(range.substr(0, dash));
+    const int last =
+        dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+    for (int c = first; c <= last; ++c)
+      cores.push_back(c);
+  }
+  return cores;
+}
+} // namespace
+
+std::vector<int> GetAllowedCores() {
+  std::vector<int> cores;
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) != 0) return cores;
+  for (int c = 0; c < CPU_SETSIZE; ++c)
+    if (CPU_ISSET(c, &set)) cores.push_back(c);
+#endif
+  return cores;
+}
+
+std::vector<std::vector<int>> GetNUMADomains() {
+  const auto allowed = GetAllowedCores();
+  std::vector<std::vector<int>> domains;
+  for (int node = 0;; ++node) {
+    std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) +
+                       "/cpulist");
+    if (!file) break;
+    std::string list;
+    std::getline(file, list);
+    std::vector<int> cores;
+    for (const int c : ParseCPUList(list))
+      if (std::binary_search(allowed.begin(), allowed.end(), c)) cores.push_back(c);
+    if (!cores.empty()) domains.push_back(cores);
+  }
+  if (domains.empty()) domains.push_back(allowed);
+  return domains;
+}
+
+bool PinCurrentThread(const std::vector<int> &cores) {
+#ifdef __linux__
+  if (cores.empty()) return false;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (const int c : cores)
+    CPU_SET(c, &set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+  return false;
+#endif
+}
+
+void PinExecSpaceThreads(const DevExecSpace &exec_space, const std::vector<int> &cores) {
+  if constexpr (HostThreadsPinnable()) {
+    if (cores.empty()) return;
+    // With as many iterations as threads the static schedule gives every thread one
+    const int nthreads = exec_space.concurrency();
+    Kokkos::parallel_for(
+        "PinExecSpaceThreads", Kokkos::RangePolicy<DevExecSpace>(exec_space, 0, nthreads),
+        [=](const int t) { PinCurrentThread({cores[t % cores.size()]}); });
+    exec_space.fence();
+  }
+}
+
+#if defined(KOKKOS_ENABLE_CUDA)
+#define PARTHENON_GPU_CHECK(x) PARTHENON_REQUIRE_THROWS((x) == cudaSuccess, #x " failed")
+#elif defined(KOKKOS_ENABLE_HIP)
+#define PARTHENON_GPU_CHECK(x) PARTHENON_REQUIRE_THROWS((x) == hipSuccess, #x " failed")
+#endif
+
+int GetNumDevices() {
+  int ndevices = 1;
+  if constexpr (MultipleDevicesSupported()) {
+#if defined(KOKKOS_ENABLE_CUDA)
+    PARTHENON_GPU_CHECK(cudaGetDeviceCount(&ndevices));
+#elif defined(KOKKOS_ENABLE_HIP)
+    PARTHENON_GPU_CHECK(hipGetDeviceCount(&ndevices));
+#endif
+  }
+  return ndevices;
+}
+
+std::vector<DevExecSpace> CreateDeviceInstances(const int ndevices) {
+  PARTHENON_REQUIRE_THROWS(ndevices > 0, "Need at least one device");
+  if (ndevices == 1) return {DevExecSpace()};
+  PARTHENON_REQUIRE_THROWS(MultipleDevicesSupported(),
+                           "Multiple devices per rank need the CUDA or HIP backend of "
+                           "Kokkos 4.2 or newer");
+  const int nvisible = GetNumDevices();
+  PARTHENON_REQUIRE_THROWS(ndevices <= nvisible,
+                           "Requested more devices than are visible to the rank");
+  std::vector<DevExecSpace> instances;
+#if defined(KOKKOS_ENABLE_CUDA) || defined(KOKKOS_ENABLE_HIP)
+  if constexpr (MultipleDevicesSupported()) {
+    int first;
+#if defined(KOKKOS_ENABLE_CUDA)
+    PARTHENON_GPU_CHECK(cudaGetDevice(&first));
+#else
+    PARTHENON_GPU_CHECK(hipGetDevice(&first));
+#endif
+    for (int d = 0; d < ndevices; ++d) {
+      const int device = (first + d) % nvisible;
+#if defined(KOKKOS_ENABLE_CUDA)
+      PARTHENON_GPU_CHECK(cudaSetDevice(device));
+      for (int p = 0; p < ndevices; ++p) {
+        const int peer = (first + p) % nvisible;
+        int can_access = 0;
+        PARTHENON_GPU_CHECK(cudaDeviceCanAccessPeer(&can_access, device, peer));
+        // Enabling the access twice, e.g. after remeshing, returns an error but is
+        // harmless, so the error is cleared instead of checked
+        if (peer != device && can_access) {
+          if (cudaDeviceEnablePeerAccess(peer, 0) != cudaSuccess) cudaGetLastError();
+        }
+      }
+      cudaStream_t stream;
+      PARTHENON_GPU_CHECK(cudaStreamCreate(&stream));
+#else
+      PARTHENON_GPU_CHECK(hipSetDevice(device));
+      for (int p = 0; p < ndevices; ++p) {
+        const int peer = (first + p) % nvisible;
+        int can_access = 0;
+        PARTHENON_GPU_CHECK(hipDeviceCanAccessPeer(&can_access, device, peer));
+        if (peer != device && can_access) {
+          if (hipDeviceEnablePeerAccess(peer, 0) != hipSuccess) hipGetLastError();
+        }
+      }
+      hipStream_t stream;
+      PARTHENON_GPU_CHECK(hipStreamCreate(&stream));
+#endif
+      // Kokkos takes the device of an instance from its stream
+      instances.emplace_back(stream);
+    }
+    // Kernels launched without an instance keep running on the initial device
+#if defined(KOKKOS_ENABLE_CUDA)
+    PARTHENON_GPU_CHECK(cudaSetDevice(first));
+#else
+    PARTHENON_GPU_CHECK(hipSetDevice(first));
+#endif
+  }
+#endif
+  return instances;
+}
+
+void DestroyDeviceInstances(std::vector<DevExecSpace> &instances) {
+  if constexpr (MultipleDevicesSupported()) {
+    if (instances.size() < 2) return;
+#if defined(KOKKOS_ENABLE_CUDA) || defined(KOKKOS_ENABLE_HIP)
+    for (auto &instance : instances) {
+      instance.fence();
+#if defined(KOKKOS_ENABLE_CUDA)
+      cudaStream_t stream = instance.cuda_stream();
+#else
+      hipStream_t stream = instance.hip_stream();
+#endif
+      // The instances have to be gone before their streams are
+      instance = DevExecSpace();
+#if defined(KOKKOS_ENABLE_CUDA)
+      PARTHENON_GPU_CHECK(cudaStreamDestroy(stream));
+#else
+      PARTHENON_GPU_CHECK(hipStreamDestroy(stream));
+#endif
+    }
+#endif
+  }
+  instances.clear();
+}
+
+#undef PARTHENON_GPU_CHECK
+
+} // namespace affinity
+} // namespace parthenon
@@ -0,0 +1,75 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef UTILS_AFFINITY_HPP_
+#define UTILS_AFFINITY_HPP_
+//! \file affinity.hpp
+//  \brief Pinning of host threads to cores and NUMA domains and of partitions to devices
+
+#include <type_traits>
+#include <vector>
+
+#include "kokkos_abstraction.hpp"
+
+namespace parthenon {
+namespace affinity {
+
+// Whether kernels run on host threads that can be pinned, i.e. with the OpenMP backend
+constexpr bool HostThreadsPinnable() {
+#ifdef KOKKOS_ENABLE_OPENMP
+  return std::is_same<DevExecSpace, Kokkos::OpenMP>::value;
+#else
+  return false;
+#endif
+}
+
+// The cores the process may run on in increasing order, which respects the binding set
+// by the launcher (e.g. with srun --cpu-bind or mpirun --bind-to). Empty if unknown.
+std::vector<int> GetAllowedCores();
+
+// The allowed cores grouped by NUMA domain, skipping domains without allowed cores. On
+// systems without NUMA information (or other than Linux) this is a single domain.
+std::vector<std::vector<int>> GetNUMADomains();
+
+// Restricts the calling thread to cores, returns false if that is not supported
+bool PinCurrentThread(const std::vector<int> &cores);
+
+// Pins thread t of the host execution space instance exec_space to cores[t % size]. This
+// relies on the OpenMP runtime reusing its threads for later kernels of the instance,
+// which all common runtimes do. Does nothing for device execution spaces.
+void PinExecSpaceThreads(const DevExecSpace &exec_space, const std::vector<int> &cores);
+
+// Whether execution space instances can be created on other devices than the one the
+// rank was initialized on, i.e. with the CUDA or HIP backends of Kokkos 4.2 or newer
+constexpr bool MultipleDevicesSupported() {
+#if (defined(KOKKOS_ENABLE_CUDA) || defined(KOKKOS_ENABLE_HIP)) && KOKKOS_VERSION >= 40200
+  return std::is_same<DevExecSpace, Kokkos::DefaultExecutionSpace>::value;
+#else
+  return false;
+#endif
+}
+
+// The number of devices visible to the rank, one if not MultipleDevicesSupported()
+int GetNumDevices();
+
+// Creates one execution space instance with its own stream on each of the ndevices
+// devices starting at the current one and wrapping around the visible devices, and
+// enables peer access between all of them so that kernels on one device can access the
+// memory of the others. The instances have to be released with DestroyDeviceInstances
+// before Kokkos is finalized.
+std::vector<DevExecSpace> CreateDeviceInstances(const int ndevices);
+void DestroyDeviceInstances(std::vector<DevExecSpace> &instances);
+
+} // namespace affinity
+} // namespace parthenon
+
+#endif // UTILS_AFFINITY_HPP_
@@ -19,6 +19,8 @@
 #include <numeric>
 #include <queue>
 
+#include "utils/error_checking.hpp"
+
 namespace parthenon {
 namespace AliasMethod {
 
@@ -75,5 +77,118 @@ AliasMethod::AliasMethod(const std::vector<Real> &probabilities)
   Kokkos::deep_copy(alias_table, host_alias_table);
 }
 
+namespace {
+// First index in [lo, hi) with arr(index) >= val (strict selects arr(index) > val), or hi
+template <bool strict>
+KOKKOS_INLINE_FUNCTION int Search(const Kokkos::View<Real *> &arr, int lo, int hi,
+                                  const Real val) {
+  while (lo < hi) {
+    const int m = lo + (hi - lo) / 2;
+    if (strict ? arr(m) <= val : arr(m) < val) {
+      lo = m + 1;
+    } else {
+      hi = m;
+    }
+  }
+  return lo;
+}
+} // namespace
+
+AliasMethod::AliasMethod(const Kokkos::View<const Real *> &probabilities) {
+  Build(probabilities);
+}
+
+void AliasMethod::Build(const Kokkos::View<const Real *> &probabilities) {
+  const int n = probabilities.extent_int(0);
+  PARTHENON_REQUIRE_THROWS(n > 0, "AliasMethod requires at least one probability");
+  if (prob_table.extent_int(0) != n || bins_.extent_int(0) != n) {
+    prob_table = Kokkos::View<Real *>("prob_table", n);
+    alias_table = Kokkos::View<int *>("alias_table", n);
+    bins_ = Kokkos::View<int *>("alias_bins", n);
+    sums_ = Kokkos::View<Real *>("alias_sums", n + 2);
+  }
+  auto prob = prob_table;
+  auto alias = alias_table;
+  auto bins = bins_;
+  auto sums = sums_;
+
+  // explicitly using double for sum and casting result to Real
+  double prob_sum = 0.0;
+  par_reduce(
+      PARTHENON_AUTO_LABEL, 0, n - 1,
+      KOKKOS_LAMBDA(const int i, double &lsum) { lsum += probabilities(i); },
+      prob_sum);
+  PARTHENON_REQUIRE_THROWS(prob_sum > 0.0, "AliasMethod requires a positive sum");
+  const Real scale = Real(n) / static_cast<Real>(prob_sum);
+
+  // Scale to a mean of one and sort the underfull bins to the front and the overfull
+  // bins to the back of the bin list
+  int nunder = 0;
+  par_scan(
+      PARTHENON_AUTO_LABEL, 0, n - 1,
+      KOKKOS_LAMBDA(const int i, int &rank, const bool final) {
+        const Real p = scale * probabilities(i);
+        const bool under = p < 1.0;
+        if (final) {
+          prob(i) = p;
+          bins(under ? rank : n - 1 - (i - rank)) = i;
+        }
+        rank += under;
+      },
+      nunder);
+  const int nover = n - nunder;
+
+  // sums(k) for k in [0, nunder] is the probability missing in the first k underfull
+  // bins and sums(nunder + 1 + j) for j in [0, nover] the excess in the first j overfull
+  // bins, where the overfull bins are counted from the back of the bin list
+  Kokkos::deep_copy(sums, 0.0);
+  if (nunder > 0) {
+    par_scan(
+        PARTHENON_AUTO_LABEL, 0, nunder - 1,
+        KOKKOS_LAMBDA(const int k, Real &partial, const bool final) {
+          partial += 1.0 - prob(bins(k));
+          if (final) sums(k + 1) = partial;
+        });
+  }
+  if (nover > 0) {
+    par_scan(
+        PARTHENON_AUTO_LABEL, 0, nover - 1,
+        KOKKOS_LAMBDA(const int j, Real &partial, const bool final) {
+          partial += prob(bins(n - 1 - j)) - 1.0;
+          if (final) sums(nunder + 2 + j) = partial;
+        });
+  }
+
+  // Vose's algorithm fills the underfull bins in order from the current overfull bin
+  // and moves on to the next one once it becomes underfull itself, which it then fills.
+  // This means that an underfull bin is filled by the first overfull bin whose
+  // cumulative excess reaches the cumulative deficit up to it, and that an overfull
+  // bin drops out at the first underfull bin that exceeds its cumulative excess. Bins not
+  // paired because of round-off keep a probability of one, as in the host construction.
+  par_for(
+      PARTHENON_AUTO_LABEL, 0, n - 1, KOKKOS_LAMBDA(const int k) {
+        const int i = bins(k);
+        alias(i) = i;
+        if (k < nunder) {
+          const int j = Search<false>(sums, nunder + 2, n + 2, sums(k)) - (nunder + 2);
+          if (j < nover) {
+            alias(i) = bins(n - 1 - j);
+          } else {
+            prob(i) = 1.0;
+          }
+        } else {
+          const int j = n - 1 - k;
+          const Real excess = sums(nunder + 2 + j);
+          const int m = Search<true>(sums, 1, nunder + 1, excess);
+          if (j < nover - 1 && m <= nunder) {
+            prob(i) = Kokkos::max(Real(0.0), 1.0 + excess - sums(m));
+            alias(i) = bins(k - 1);
+          } else {
+            prob(i) = 1.0;
+          }
+        }
+      });
+}
+
 } // namespace AliasMethod
 } // namespace parthenon
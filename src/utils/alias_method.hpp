@@ -39,6 +39,14 @@ class AliasMethod {
 
   // Construct the AliasMethod with the given discrete probabilities
   explicit AliasMethod(const std::vector<Real> &probabilities);
+  // Construct the tables on device from (non-normalized) probabilities that already
+  // reside there, see Build
+  explicit AliasMethod(const Kokkos::View<const Real *> &probabilities);
+
+  // (Re)build the tables on device. This is a parallel formulation of Vose's algorithm
+  // that pairs the under- and overfull bins with prefix sums and binary searches instead
+  // of work queues. The storage is reused if the number of bins does not change.
+  void Build(const Kokkos::View<const Real *> &probabilities);
 
   // Sample from the discrete probability distribution defined by the probabilities given
   // to the constructor. The returned value is the zero-based index of the sampled
@@ -52,6 +60,42 @@ class AliasMethod {
     else
       return idx;
   }
+
+  // Same as above drawing the random numbers from a Kokkos random number generator,
+  // e.g., obtained from a Kokkos::Random_XorShift64_Pool
+  template <class Generator>
+  KOKKOS_INLINE_FUNCTION int Sample(Generator &rng) const {
+    const Real rand1 = rng.drand();
+    return Sample(rand1, rng.drand());
+  }
+
+  // Fill samples with independent samples on device. Every thread draws
+  // samples_per_thread consecutive samples from its own generator of pool, so that the
+  // cost of acquiring a generator is amortized.
+  template <class RandomPool>
+  void SampleBatch(const RandomPool &pool, const Kokkos::View<int *> &samples,
+                   const int samples_per_thread = 16) const {
+    const int nsamples = samples.extent_int(0);
+    if (nsamples == 0) return;
+    const int nthreads = (nsamples + samples_per_thread - 1) / samples_per_thread;
+    const AliasMethod table = *this;
+    par_for(
+        PARTHENON_AUTO_LABEL, 0, nthreads - 1, KOKKOS_LAMBDA(const int t) {
+          auto rng = pool.get_state();
+          const int end = Kokkos::min((t + 1) * samples_per_thread, nsamples);
+          for (int n = t * samples_per_thread; n < end; ++n) {
+            samples(n) = table.Sample(rng);
+          }
+          pool.free_state(rng);
+        });
+  }
+
+ private:
+  // Bins sorted into underfull (from the front) and overfull (from the back) ones
+  Kokkos::View<int *> bins_;
+  // Prefix sums of the missing probability of the underfull bins followed by those of
+  // the excess probability of the overfull bins
+  Kokkos::View<Real *> sums_;
 };
 
 } // namespace AliasMethod
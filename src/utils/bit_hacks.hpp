@@ -14,6 +14,12 @@
 #ifndef UTILS_BIT_HACKS_HPP_
 #define UTILS_BIT_HACKS_HPP_
 
+#include <cstdint>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
 namespace parthenon {
 namespace impl {
 template <int NDIM = 3>
@@ -39,6 +45,17 @@ inline constexpr uint64_t GetInterleaveConstant(int power) {
 
 template <int NDIM = 3, int N_VALID_BITS = 21>
 inline uint64_t InterleaveZeros(uint64_t x) {
+#if defined(__BMI2__)
+  // A single parallel bit deposit places the valid bits at every NDIM-th position. Note
+  // that pdep is microcoded and slower than the fallback on AMD CPUs before Zen 3.
+  if constexpr (NDIM * N_VALID_BITS <= 64 && N_VALID_BITS < 64) {
+    constexpr int NBITS = NDIM * N_VALID_BITS;
+    constexpr uint64_t valid = ~((~0ULL) << N_VALID_BITS);
+    constexpr uint64_t used = NBITS < 64 ? ~((~0ULL) << (NBITS % 64)) : ~0ULL;
+    constexpr uint64_t mask = impl::GetInterleaveConstant<NDIM>(1) & used;
+    return _pdep_u64(x & valid, mask);
+  }
+#endif
   // This is a standard bithack for interleaving zeros in binary numbers to make a Morton
   // number
   if constexpr (N_VALID_BITS >= 64)
@@ -88,6 +105,17 @@ inline int NumberOfBinaryTrailingZeros(std::uint64_t val) {
   return n;
 }
 
+inline int NumberOfSetBits(std::uint64_t val) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_popcountll(val);
+#else
+  int n = 0;
+  for (; val; val &= val - 1)
+    ++n;
+  return n;
+#endif
+}
+
 inline int MaximumPowerOf2Divisor(int in) { return in & (~(in - 1)); }
 
 inline uint IntegerLog2Ceil(uint in) {
@@ -0,0 +1,90 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+#include "utils/comm_statistics.hpp"
+#include "utils/error_checking.hpp"
+
+namespace parthenon {
+
+namespace {
+int Bucket(const double val, const int nbuckets) {
+  int b = 0;
+  for (double upper = 1.0; val >= upper && b < nbuckets - 1; upper *= 2.)
+    b++;
+  return b;
+}
+
+template <typename Histogram>
+void WriteHistogram(std::ostream &os, const std::string &name, const Histogram &h) {
+  os << "  " << std::setw(13) << name << ":";
+  for (const auto &n : h)
+    os << " " << n;
+  os << std::endl;
+}
+} // namespace
+
+void CommStatistics::AddSend(const int rank, const std::int64_t bytes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto &peer = peers_[rank];
+  peer.messages_sent++;
+  peer.bytes_sent += bytes;
+  peer.send_sizes[Bucket(bytes, nsize_buckets)]++;
+}
+
+void CommStatistics::AddReceive(const int rank, const std::int64_t bytes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto &peer = peers_[rank];
+  peer.messages_received++;
+  peer.bytes_received += bytes;
+  peer.receive_sizes[Bucket(bytes, nsize_buckets)]++;
+}
+
+void CommStatistics::AddWait(const int rank, const double seconds) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto &peer = peers_[rank];
+  peer.wait += seconds;
+  peer.waits[Bucket(seconds * 1e6, nwait_buckets)]++;
+}
+
+void CommStatistics::Write(std::ostream &os) {
+  const auto peers = GetPeers();
+  os << "# rank, messages sent, bytes sent, messages received, bytes received, "
+        "wait [s]"
+     << std::endl
+     << "# histograms: bucket 0 is zero bytes or waits below 1 us, bucket b > 0 is "
+        "[2^(b-1), 2^b) bytes or microseconds"
+     << std::endl;
+  for (const auto &[rank, peer] : peers) {
+    os << rank << " " << peer.messages_sent << " " << peer.bytes_sent << " "
+       << peer.messages_received << " " << peer.bytes_received << " " << std::scientific
+       << std::setprecision(6) << peer.wait << std::defaultfloat << std::endl;
+    WriteHistogram(os, "send_sizes", peer.send_sizes);
+    WriteHistogram(os, "receive_sizes", peer.receive_sizes);
+    WriteHistogram(os, "waits", peer.waits);
+  }
+}
+
+void CommStatistics::Write(const std::string &filename) {
+  std::ofstream file(filename);
+  PARTHENON_REQUIRE_THROWS(file.is_open(), "Could not open " + filename);
+  Write(file);
+}
+
+} // namespace parthenon
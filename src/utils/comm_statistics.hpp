@@ -0,0 +1,95 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef UTILS_COMM_STATISTICS_HPP_
+#define UTILS_COMM_STATISTICS_HPP_
+//! \file comm_statistics.hpp
+//  \brief Per rank pair statistics of the point to point messages of boundary buffers
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+namespace parthenon {
+
+// Counts the messages and bytes exchanged with every other rank and how long receives
+// had to wait for them, as histograms with logarithmic buckets. The wait of a receive is
+// the time between the first unsuccessful TryReceive of a buffer and its completion (zero
+// if the message was there at the first try). Collection is disabled by default and can
+// be called concurrently from the threads executing tasks.
+class CommStatistics {
+ public:
+  // Bucket 0 counts zero bytes (null messages) or waits below a microsecond, bucket
+  // b > 0 counts sizes in [2^(b-1), 2^b) bytes or waits in [2^(b-1), 2^b) microseconds,
+  // the last bucket is open ended
+  static constexpr int nsize_buckets = 32;
+  static constexpr int nwait_buckets = 24;
+
+  struct Peer {
+    std::int64_t messages_sent = 0;
+    std::int64_t bytes_sent = 0;
+    std::int64_t messages_received = 0;
+    std::int64_t bytes_received = 0;
+    double wait = 0.0; // [s]
+    std::array<std::int64_t, nsize_buckets> send_sizes{};
+    std::array<std::int64_t, nsize_buckets> receive_sizes{};
+    std::array<std::int64_t, nwait_buckets> waits{};
+  };
+
+  static CommStatistics &Instance() {
+    static CommStatistics statistics;
+    return statistics;
+  }
+
+  static void Enable(const bool enable) { enabled_ = enable; }
+  static bool Enabled() { return enabled_; }
+
+  // Seconds since an arbitrary time
+  static double Now() {
+    return std::chrono::duration<double>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  void AddSend(int rank, std::int64_t bytes);
+  void AddReceive(int rank, std::int64_t bytes);
+  void AddWait(int rank, double seconds);
+
+  // Statistics by the rank on the other end
+  std::map<int, Peer> GetPeers() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return peers_;
+  }
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    peers_.clear();
+  }
+
+  // Write a table of the totals and the histograms of every peer
+  void Write(std::ostream &os);
+  void Write(const std::string &filename);
+
+ private:
+  CommStatistics() = default;
+
+  static inline bool enabled_ = false;
+  std::mutex mutex_;
+  std::map<int, Peer> peers_;
+};
+
+} // namespace parthenon
+
+#endif // UTILS_COMM_STATISTICS_HPP_
@@ -18,15 +18,22 @@
 #ifndef UTILS_COMMUNICATION_BUFFER_HPP_
 #define UTILS_COMMUNICATION_BUFFER_HPP_
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
 #include <limits>
 #include <memory>
 #include <type_traits>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "globals.hpp"
 #include "parthenon_mpi.hpp"
+#include "tasks/task_wait.hpp"
+#include "utils/comm_statistics.hpp"
+#include "utils/host_staging.hpp"
 #include "utils/mpi_types.hpp"
 
 namespace parthenon {
@@ -39,6 +46,19 @@ enum class BufferState { stale, sending, sending_null, received, received_null }
 
 enum class BuffCommType { sender, receiver, both, sparse_receiver };
 
+// State of a channel between two ranks on the same node that lives in shared memory next
+// to the buffer data (see NodeSharedBuffers). The sender counts its sends and records
+// the size of the last one (zero for a null send), the receiver counts the messages it
+// has consumed, so the buffer can be written again once both counts agree. The counters
+// written by different ranks are kept on different cache lines.
+struct alignas(64) SharedChannelState {
+  std::atomic<std::int64_t> nsent{0};
+  std::atomic<std::int64_t> size{0};
+  alignas(64) std::atomic<std::int64_t> nconsumed{0};
+};
+static_assert(std::atomic<std::int64_t>::is_always_lock_free,
+              "Shared memory communication requires lock free 64 bit atomics.");
+
 template <class T>
 class CommBuffer {
  private:
@@ -51,6 +71,9 @@ class CommBuffer {
   std::shared_ptr<bool> started_irecv_;
   std::shared_ptr<int> nrecv_tries_;
   std::shared_ptr<mpi_request_t> my_request_;
+  std::shared_ptr<bool> expect_data_;
+  // Start of the current wait for a message, negative when not waiting
+  std::shared_ptr<double> wait_start_;
 
   int my_rank;
   int tag_;
@@ -61,11 +84,62 @@ class CommBuffer {
   using buf_base_t = std::remove_pointer_t<decltype(std::declval<T>().data())>;
   buf_base_t null_buf_ = std::numeric_limits<buf_base_t>::signaling_NaN();
   bool active_ = false;
+  // Coalesced buffers are not communicated individually, their data is exchanged as
+  // part of a single message per pair of ranks (see CoalescedBuffers)
+  bool coalesced_ = false;
+  // Persistent buffers set up their MPI request once (for a fixed buffer address and
+  // size) and restart it for every send or receive instead of posting a new one
+  struct PersistentRequest {
+#ifdef MPI_PARALLEL
+    mpi_request_t request = MPI_REQUEST_NULL;
+#endif
+    const void *data = nullptr;
+    std::size_t size = 0;
+    int tag = 0;
+  };
+  bool persistent_ = false;
+  std::shared_ptr<PersistentRequest> persistent_request_;
+  // For null masked buffers, null sends are only signalled through the per rank pair
+  // allocation masks (see SparseNullMasks) and receivers only look for a message once
+  // the mask has told them that real data is coming
+  bool null_masked_ = false;
+  // Node shared buffers of the sender and the receiver point at the same storage in a
+  // shared memory window and synchronize through shared_state_ instead of MPI messages
+  bool node_shared_ = false;
+  SharedChannelState *shared_state_ = nullptr;
+  // Stream ordered buffers are sent and received by StreamOrderedBuffers on the stream of
+  // the kernels that fill and read them, so their storage can be reused right away
+  bool stream_ordered_ = false;
+  // Host staged buffers are sent and received in chunks through pinned host memory (see
+  // HostStaging) instead of handing the device storage to MPI
+  struct StagedState {
+    HostStaging::host_buf_t host;
+#ifdef MPI_PARALLEL
+    std::vector<MPI_Request> requests;
+#endif
+    // next chunk to copy to the device on the receiving end
+    int next = 0;
+  };
+  HostStaging *staging_ = nullptr;
+  std::shared_ptr<StagedState> staged_state_;
 
   std::function<T()> get_resource_;
 
   T buf_;
 
+  bool TryReceiveImpl() noexcept;
+
+#ifdef MPI_PARALLEL
+  void StartPersistentRequest();
+  void EnsureStagingStorage();
+  bool TryReceiveStaged();
+  // Completed persistent requests become inactive rather than MPI_REQUEST_NULL, reset
+  // the handle by hand so that the rest of the logic does not need to distinguish them
+  void ResetPersistentRequest() {
+    if (persistent_) *my_request_ = MPI_REQUEST_NULL;
+  }
+#endif
+
  public:
   CommBuffer()
       : my_rank(0)
@@ -109,6 +183,56 @@ class CommBuffer {
 
   BufferState GetState() { return *state_; }
 
+  void SetCoalesced(bool coalesced) { coalesced_ = coalesced; }
+  bool IsCoalesced() const { return coalesced_; }
+  // The rank on the other end of the channel
+  int GetOtherRank() const { return my_rank == send_rank_ ? recv_rank_ : send_rank_; }
+  int GetSendRank() const { return send_rank_; }
+  int GetRecvRank() const { return recv_rank_; }
+  // Only used for buffers that are kept when the boundary buffers are rebuilt, the tag
+  // must not be changed while a message is in flight
+  void SetTag(int tag) { tag_ = tag; }
+  // Only used to update the state of coalesced buffers after their data has been
+  // packed into or unpacked from a combined message
+  void SetState(BufferState state) { *state_ = state; }
+
+  // Only meaningful for buffers whose message size does not change between
+  // communications, i.e. non-sparse buffers between different ranks
+  void SetPersistent(bool persistent) {
+    persistent_ = persistent;
+    if (persistent_ && !persistent_request_)
+      persistent_request_ = std::make_shared<PersistentRequest>();
+  }
+  bool IsPersistent() const { return persistent_; }
+
+  void SetNullMasked(bool null_masked) { null_masked_ = null_masked; }
+  bool IsNullMasked() const { return null_masked_; }
+
+  // Use storage in shared memory that the buffer on the other rank also points at
+  void SetNodeShared(const T &storage, SharedChannelState *shared_state) {
+    node_shared_ = true;
+    shared_state_ = shared_state;
+    get_resource_ = [storage]() { return storage; };
+    buf_ = storage;
+    active_ = true;
+  }
+  bool IsNodeShared() const { return node_shared_; }
+
+  void SetStreamOrdered(bool stream_ordered) { stream_ordered_ = stream_ordered; }
+  bool IsStreamOrdered() const { return stream_ordered_; }
+
+  // Only meaningful for non-sparse buffers between different ranks, whose message size
+  // is known to the receiver
+  void SetHostStaged(HostStaging *staging) {
+    staging_ = staging;
+    if (staging_ != nullptr && !staged_state_)
+      staged_state_ = std::make_shared<StagedState>();
+  }
+  bool IsHostStaged() const { return staging_ != nullptr; }
+  // Tell a null masked receiver that the next message on its channel contains data
+  void ExpectData() { *expect_data_ = true; }
+  bool IsExpectingData() const { return *expect_data_; }
+
   void Send() noexcept;
   void SendNull() noexcept;
 
@@ -139,8 +263,9 @@ CommBuffer<T>::CommBuffer(int tag, int send_rank, int recv_rank, mpi_comm_t comm
 #ifdef MPI_PARALLEL
       my_request_(std::make_shared<MPI_Request>(MPI_REQUEST_NULL)),
 #endif
-      tag_(tag), send_rank_(send_rank), recv_rank_(recv_rank), comm_(comm),
-      get_resource_(get_resource), buf_() {
+      expect_data_(std::make_shared<bool>(false)),
+      wait_start_(std::make_shared<double>(-1.0)), tag_(tag), send_rank_(send_rank),
+      recv_rank_(recv_rank), comm_(comm), get_resource_(get_resource), buf_() {
   my_rank = Globals::my_rank;
   if (send_rank == recv_rank) {
     assert(my_rank == send_rank);
@@ -161,8 +286,14 @@ template <class U>
 CommBuffer<T>::CommBuffer(const CommBuffer<U> &in)
     : buf_(in.buf_), state_(in.state_), comm_type_(in.comm_type_),
       started_irecv_(in.started_irecv_), nrecv_tries_(in.nrecv_tries_),
-      my_request_(in.my_request_), tag_(in.tag_), send_rank_(in.send_rank_),
-      recv_rank_(in.recv_rank_), comm_(in.comm_), active_(in.active_) {
+      my_request_(in.my_request_), expect_data_(in.expect_data_),
+      wait_start_(in.wait_start_), tag_(in.tag_),
+      send_rank_(in.send_rank_), recv_rank_(in.recv_rank_), comm_(in.comm_),
+      active_(in.active_), coalesced_(in.coalesced_), persistent_(in.persistent_),
+      persistent_request_(in.persistent_request_), null_masked_(in.null_masked_),
+      node_shared_(in.node_shared_), shared_state_(in.shared_state_),
+      stream_ordered_(in.stream_ordered_), staging_(in.staging_),
+      staged_state_(in.staged_state_) {
   my_rank = Globals::my_rank;
 }
 
@@ -183,6 +314,17 @@ CommBuffer<T>::~CommBuffer() {
         PARTHENON_MPI_CHECK(MPI_Wait(my_request_.get(), MPI_STATUS_IGNORE));
       }
     }
+    if (persistent_request_ && persistent_request_.use_count() == 1 &&
+        persistent_request_->request != MPI_REQUEST_NULL)
+      PARTHENON_MPI_CHECK(MPI_Request_free(&(persistent_request_->request)));
+    if (staged_state_ && staged_state_.use_count() == 1) {
+      for (auto &req : staged_state_->requests) {
+        if (req == MPI_REQUEST_NULL) continue;
+        if (*comm_type_ != BuffCommType::sender) PARTHENON_MPI_CHECK(MPI_Cancel(&req));
+        PARTHENON_MPI_CHECK(MPI_Wait(&req, MPI_STATUS_IGNORE));
+      }
+      staging_->Release(staged_state_->host);
+    }
   }
 #endif
 }
@@ -196,11 +338,22 @@ CommBuffer<T> &CommBuffer<T>::operator=(const CommBuffer<U> &in) {
   started_irecv_ = in.started_irecv_;
   nrecv_tries_ = in.nrecv_tries_;
   my_request_ = in.my_request_;
+  expect_data_ = in.expect_data_;
+  wait_start_ = in.wait_start_;
   tag_ = in.tag_;
   send_rank_ = in.send_rank_;
   recv_rank_ = in.recv_rank_;
   comm_ = in.comm_;
   active_ = in.active_;
+  coalesced_ = in.coalesced_;
+  persistent_ = in.persistent_;
+  persistent_request_ = in.persistent_request_;
+  null_masked_ = in.null_masked_;
+  node_shared_ = in.node_shared_;
+  shared_state_ = in.shared_state_;
+  stream_ordered_ = in.stream_ordered_;
+  staging_ = in.staging_;
+  staged_state_ = in.staged_state_;
   my_rank = Globals::my_rank;
   return *this;
 }
@@ -215,7 +368,26 @@ void CommBuffer<T>::Send() noexcept {
   PARTHENON_DEBUG_REQUIRE(*state_ == BufferState::stale,
                           "Trying to send from buffer that hasn't been staled.");
   *state_ = BufferState::sending;
-  if (*comm_type_ == BuffCommType::sender) {
+  if (*comm_type_ == BuffCommType::sender && node_shared_) {
+    // The data has already been packed into the shared storage
+    shared_state_->size.store(buf_.size(), std::memory_order_relaxed);
+    shared_state_->nsent.fetch_add(1, std::memory_order_release);
+    if (CommStatistics::Enabled())
+      CommStatistics::Instance().AddSend(recv_rank_, buf_.size() * sizeof(buf_base_t));
+  } else if (*comm_type_ == BuffCommType::sender && staging_ != nullptr) {
+#ifdef MPI_PARALLEL
+    auto &requests = staged_state_->requests;
+    PARTHENON_MPI_CHECK(MPI_Wait(my_request_.get(), MPI_STATUS_IGNORE));
+    PARTHENON_MPI_CHECK(
+        MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE));
+    requests.clear();
+    EnsureStagingStorage();
+    staging_->Isend(buf_.data(), buf_.size(), staged_state_->host, recv_rank_, tag_,
+                    comm_, requests);
+    if (CommStatistics::Enabled())
+      CommStatistics::Instance().AddSend(recv_rank_, buf_.size() * sizeof(buf_base_t));
+#endif
+  } else if (*comm_type_ == BuffCommType::sender && !coalesced_ && !stream_ordered_) {
 // Make sure that this request isn't still out,
 // this could be blocking
 #ifdef MPI_PARALLEL
@@ -223,9 +395,15 @@ void CommBuffer<T>::Send() noexcept {
         buf_.size() > 0,
         "Trying to send zero size buffer, which will be interpreted as sending_null.");
     PARTHENON_MPI_CHECK(MPI_Wait(my_request_.get(), MPI_STATUS_IGNORE));
-    PARTHENON_MPI_CHECK(MPI_Isend(buf_.data(), buf_.size(),
-                                  MPITypeMap<buf_base_t>::type(), recv_rank_, tag_, comm_,
-                                  my_request_.get()));
+    if (persistent_) {
+      StartPersistentRequest();
+    } else {
+      PARTHENON_MPI_CHECK(MPI_Isend(buf_.data(), buf_.size(),
+                                    MPITypeMap<buf_base_t>::type(), recv_rank_, tag_,
+                                    comm_, my_request_.get()));
+    }
+    if (CommStatistics::Enabled())
+      CommStatistics::Instance().AddSend(recv_rank_, buf_.size() * sizeof(buf_base_t));
 #endif
   }
   if (*comm_type_ == BuffCommType::receiver) {
@@ -239,13 +417,27 @@ void CommBuffer<T>::SendNull() noexcept {
   PARTHENON_DEBUG_REQUIRE(*state_ == BufferState::stale,
                           "Trying to send_null from buffer that hasn't been staled.");
   *state_ = BufferState::sending_null;
-  if (*comm_type_ == BuffCommType::sender) {
+  if (*comm_type_ == BuffCommType::sender && node_shared_) {
+    shared_state_->size.store(0, std::memory_order_relaxed);
+    shared_state_->nsent.fetch_add(1, std::memory_order_release);
+    if (CommStatistics::Enabled()) CommStatistics::Instance().AddSend(recv_rank_, 0);
+  } else if (*comm_type_ == BuffCommType::sender && !coalesced_ && !null_masked_ &&
+             !stream_ordered_) {
 // Make sure that this request isn't still out,
 // this could be blocking
 #ifdef MPI_PARALLEL
     PARTHENON_MPI_CHECK(MPI_Wait(my_request_.get(), MPI_STATUS_IGNORE));
+    if (staged_state_) {
+      auto &requests = staged_state_->requests;
+      PARTHENON_MPI_CHECK(
+          MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE));
+      requests.clear();
+    }
+    // Null messages always go through a regular send, the persistent request (if any)
+    // is kept for the next non-null send
     PARTHENON_MPI_CHECK(MPI_Isend(&null_buf_, 0, MPITypeMap<buf_base_t>::type(),
                                   recv_rank_, tag_, comm_, my_request_.get()));
+    if (CommStatistics::Enabled()) CommStatistics::Instance().AddSend(recv_rank_, 0);
 #endif
   }
   if (*comm_type_ == BuffCommType::receiver) {
@@ -254,6 +446,74 @@ void CommBuffer<T>::SendNull() noexcept {
   }
 }
 
+#ifdef MPI_PARALLEL
+// Start the persistent request of this buffer, (re)initializing it if the underlying
+// storage has changed since it was last set up (e.g. after a remesh or after the buffer
+// was returned to and retrieved from the pool)
+template <class T>
+void CommBuffer<T>::StartPersistentRequest() {
+  auto &preq = *persistent_request_;
+  if (preq.request == MPI_REQUEST_NULL || preq.data != buf_.data() ||
+      preq.size != buf_.size() || preq.tag != tag_) {
+    if (preq.request != MPI_REQUEST_NULL)
+      PARTHENON_MPI_CHECK(MPI_Request_free(&preq.request));
+    if (*comm_type_ == BuffCommType::sender) {
+      PARTHENON_MPI_CHECK(MPI_Send_init(buf_.data(), buf_.size(),
+                                        MPITypeMap<buf_base_t>::type(), recv_rank_, tag_,
+                                        comm_, &preq.request));
+    } else {
+      PARTHENON_MPI_CHECK(MPI_Recv_init(buf_.data(), buf_.size(),
+                                        MPITypeMap<buf_base_t>::type(), send_rank_, tag_,
+                                        comm_, &preq.request));
+    }
+    preq.data = buf_.data();
+    preq.size = buf_.size();
+    preq.tag = tag_;
+  }
+  PARTHENON_MPI_CHECK(MPI_Start(&preq.request));
+  *my_request_ = preq.request;
+}
+
+template <class T>
+void CommBuffer<T>::EnsureStagingStorage() {
+  auto &host = staged_state_->host;
+  if (host.size() >= buf_.size()) return;
+  staging_->Release(host);
+  host = staging_->Get(buf_.size());
+}
+
+// The first chunk of a message tells whether it is a null message, so only its receive
+// is posted up front and the receives of the remaining chunks once it has arrived
+template <class T>
+bool CommBuffer<T>::TryReceiveStaged() {
+  auto &st = *staged_state_;
+  if (st.next == 0) {
+    int flag;
+    MPI_Status status;
+    PARTHENON_MPI_CHECK(MPI_Test(&st.requests[0], &flag, &status));
+    if (!flag) {
+      TaskWait::Request(&st.requests[0]);
+      return false;
+    }
+    int size;
+    PARTHENON_MPI_CHECK(MPI_Get_count(&status, MPITypeMap<buf_base_t>::type(), &size));
+    if (size == 0) {
+      *state_ = BufferState::received_null;
+      return true;
+    }
+    staging_->Irecv(buf_.size(), 1, staging_->NumChunks(buf_.size()), st.host,
+                    send_rank_, tag_, comm_, st.requests);
+  }
+  if (!staging_->Progress(buf_.data(), buf_.size(), st.host, st.requests, st.next, false,
+                          DevExecSpace()))
+    return false;
+  // The buffer is read by kernels on other execution space instances
+  DevExecSpace().fence();
+  *state_ = BufferState::received;
+  return true;
+}
+#endif
+
 template <class T>
 bool CommBuffer<T>::IsAvailableForWrite() {
   if (*comm_type_ == BuffCommType::sender) {
@@ -262,12 +522,40 @@ bool CommBuffer<T>::IsAvailableForWrite() {
     // setting the buffer to stale, all we care about for a pure sender is wether
     // or not its last send message has been completed
     if (*state_ == BufferState::stale) return true;
+    // Later kernels on the stream can only run once the send is done
+    if (stream_ordered_) {
+      *state_ = BufferState::stale;
+      return true;
+    }
+    if (staging_ != nullptr) {
+      auto &requests = staged_state_->requests;
+      int flag;
+      PARTHENON_MPI_CHECK(MPI_Testall(requests.size(), requests.data(), &flag,
+                                      MPI_STATUSES_IGNORE));
+      if (flag && *my_request_ != MPI_REQUEST_NULL)
+        PARTHENON_MPI_CHECK(MPI_Test(my_request_.get(), &flag, MPI_STATUS_IGNORE));
+      if (!flag) return false;
+      requests.clear();
+      *state_ = BufferState::stale;
+      return true;
+    }
+    if (node_shared_) {
+      // The receiver reads straight from the storage, so it has to be done with it
+      if (shared_state_->nconsumed.load(std::memory_order_acquire) !=
+          shared_state_->nsent.load(std::memory_order_relaxed))
+        return false;
+      *state_ = BufferState::stale;
+      return true;
+    }
     if (*my_request_ == MPI_REQUEST_NULL) return true;
     int flag, test;
     PARTHENON_MPI_CHECK(MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &test,
                                    MPI_STATUS_IGNORE));
     PARTHENON_MPI_CHECK(MPI_Test(my_request_.get(), &flag, MPI_STATUS_IGNORE));
-    if (flag) *state_ = BufferState::stale;
+    if (flag) {
+      ResetPersistentRequest();
+      *state_ = BufferState::stale;
+    }
     return flag;
 #else
     PARTHENON_FAIL("Should not have a sending buffer when MPI is not enabled.");
@@ -282,17 +570,31 @@ bool CommBuffer<T>::IsAvailableForWrite() {
 template <class T>
 void CommBuffer<T>::TryStartReceive() noexcept {
 #ifdef MPI_PARALLEL
+  // Data for coalesced buffers is received by CoalescedBuffers and node shared buffers
+  // and stream ordered buffers don't post receives
+  if (coalesced_ || node_shared_ || stream_ordered_) return;
   if (*comm_type_ == BuffCommType::receiver && !*started_irecv_) {
     PARTHENON_REQUIRE(
         *my_request_ == MPI_REQUEST_NULL,
         "Cannot have another pending request in a buffer that is starting to receive.");
     if (!IsActive())
       Allocate(); // For early start of Irecv, always need storage space even if not used
-    PARTHENON_MPI_CHECK(MPI_Irecv(buf_.data(), buf_.size(),
-                                  MPITypeMap<buf_base_t>::type(), send_rank_, tag_, comm_,
-                                  my_request_.get()));
+    if (staging_ != nullptr) {
+      EnsureStagingStorage();
+      staged_state_->requests.clear();
+      staged_state_->next = 0;
+      staging_->Irecv(buf_.size(), 0, 1, staged_state_->host, send_rank_, tag_, comm_,
+                      staged_state_->requests);
+    } else if (persistent_) {
+      StartPersistentRequest();
+    } else {
+      PARTHENON_MPI_CHECK(MPI_Irecv(buf_.data(), buf_.size(),
+                                    MPITypeMap<buf_base_t>::type(), send_rank_, tag_,
+                                    comm_, my_request_.get()));
+    }
     *started_irecv_ = true;
-  } else if (*comm_type_ == BuffCommType::sparse_receiver && !*started_irecv_) {
+  } else if (*comm_type_ == BuffCommType::sparse_receiver && !*started_irecv_ &&
+             (!null_masked_ || *expect_data_)) {
     int test;
     MPI_Status status;
     // Check if our message is available so that we can use the correct buffer size
@@ -320,16 +622,54 @@ void CommBuffer<T>::TryStartReceive() noexcept {
 
 template <class T>
 bool CommBuffer<T>::TryReceive() noexcept {
+  const bool remote = *comm_type_ == BuffCommType::receiver ||
+                      *comm_type_ == BuffCommType::sparse_receiver;
+  if (!remote || !CommStatistics::Enabled()) return TryReceiveImpl();
+  if (*state_ == BufferState::received || *state_ == BufferState::received_null)
+    return true;
+
+  auto &statistics = CommStatistics::Instance();
+  if (!TryReceiveImpl()) {
+    if (*wait_start_ < 0.0) *wait_start_ = statistics.Now();
+    return false;
+  }
+  // The messages of coalesced buffers are counted by CoalescedBuffers
+  if (!coalesced_) {
+    statistics.AddReceive(send_rank_, *state_ == BufferState::received
+                                          ? buf_.size() * sizeof(buf_base_t)
+                                          : 0);
+  }
+  statistics.AddWait(send_rank_,
+                     *wait_start_ < 0.0 ? 0.0 : statistics.Now() - *wait_start_);
+  *wait_start_ = -1.0;
+  return true;
+}
+
+template <class T>
+bool CommBuffer<T>::TryReceiveImpl() noexcept {
   if (*state_ == BufferState::received || *state_ == BufferState::received_null)
     return true;
 
   if (*comm_type_ == BuffCommType::receiver ||
       *comm_type_ == BuffCommType::sparse_receiver) {
 #ifdef MPI_PARALLEL
+    if (coalesced_ || stream_ordered_) return false;
     (*nrecv_tries_)++;
     PARTHENON_REQUIRE(*nrecv_tries_ < 1e8,
                       "MPI probably hanging after 1e8 receive tries.");
 
+    if (node_shared_) {
+      if (shared_state_->nsent.load(std::memory_order_acquire) ==
+          shared_state_->nconsumed.load(std::memory_order_relaxed))
+        return false;
+      *nrecv_tries_ = 0;
+      if (shared_state_->size.load(std::memory_order_relaxed) > 0)
+        *state_ = BufferState::received;
+      else
+        *state_ = BufferState::received_null;
+      return true;
+    }
+
     TryStartReceive();
 
     if (*started_irecv_) {
@@ -362,6 +702,12 @@ bool CommBuffer<T>::TryReceive() noexcept {
       for (int i = 0; i < 1; ++i)
         PARTHENON_MPI_CHECK(MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &flag,
                                        MPI_STATUS_IGNORE));
+      if (staging_ != nullptr) {
+        if (!TryReceiveStaged()) return false;
+        *started_irecv_ = false;
+        *nrecv_tries_ = 0;
+        return true;
+      }
       PARTHENON_MPI_CHECK(MPI_Test(my_request_.get(), &flag, &status));
       if (flag) {
         // Check the size of the message, it will be zero if the sender wants you to use
@@ -370,11 +716,13 @@ bool CommBuffer<T>::TryReceive() noexcept {
         PARTHENON_MPI_CHECK(
             MPI_Get_count(&status, MPITypeMap<buf_base_t>::type(), &size));
 
+        ResetPersistentRequest();
         PARTHENON_REQUIRE(*my_request_ == MPI_REQUEST_NULL,
                           "MPI request should be finished to get here.");
         // Set flags based on a finished receive
         *started_irecv_ = false;
         *nrecv_tries_ = 0;
+        if (null_masked_) *expect_data_ = false;
         if (size > 0)
           *state_ = BufferState::received;
         else
@@ -382,6 +730,8 @@ bool CommBuffer<T>::TryReceive() noexcept {
 
         return true;
       }
+      // Let the receiving task sleep until the message arrived
+      TaskWait::Request(my_request_.get());
     }
     return false;
 #else
@@ -415,6 +765,10 @@ void CommBuffer<T>::Stale() {
   if (MPI_REQUEST_NULL != *my_request_)
     PARTHENON_WARN("Staling buffer with pending request.");
 #endif
+  // Give the storage back to the sender
+  if (node_shared_ &&
+      (*state_ == BufferState::received || *state_ == BufferState::received_null))
+    shared_state_->nconsumed.fetch_add(1, std::memory_order_release);
   *state_ = BufferState::stale;
 }
 
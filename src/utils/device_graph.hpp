@@ -0,0 +1,120 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef UTILS_DEVICE_GRAPH_HPP_
+#define UTILS_DEVICE_GRAPH_HPP_
+//! \file device_graph.hpp
+//  \brief Capture and replay of a sequence of kernels as a CUDA/HIP graph
+
+#include <cstddef>
+
+#include "kokkos_abstraction.hpp"
+#include "utils/error_checking.hpp"
+
+namespace parthenon {
+
+// Captures the kernels that a callable launches on an execution space instance into a
+// CUDA/HIP graph the first time it is called and replays the graph on later calls,
+// which replaces the launch latency of every kernel by that of a single graph launch.
+// The graph is captured again whenever the key passed to Launch changes, e.g., because
+// the block list changed and the captured views are no longer the ones in use.
+//
+// The callable must only enqueue device work on the given instance: no fences, no
+// blocking deep copies, no reductions into host scalars, no MPI calls and no host logic
+// that depends on the results of the kernels, since none of these are recorded. On
+// other backends, or if the stream can't be captured, the callable is simply called.
+class DeviceGraph {
+ public:
+  DeviceGraph() = default;
+  DeviceGraph(const DeviceGraph &) = delete;
+  DeviceGraph &operator=(const DeviceGraph &) = delete;
+  ~DeviceGraph() { Reset(); }
+
+  template <typename F>
+  void Launch(const DevExecSpace &exec_space, const std::size_t key, F &&f) {
+#if defined(KOKKOS_ENABLE_CUDA)
+    auto stream = exec_space.cuda_stream();
+    if (!captured_ || key != key_) {
+      Reset();
+      if (cudaStreamBeginCapture(stream, cudaStreamCaptureModeThreadLocal) !=
+          cudaSuccess) {
+        // e.g., the legacy default stream, which can't be captured
+        cudaGetLastError();
+        f();
+        return;
+      }
+      f();
+      cudaGraph_t graph;
+      PARTHENON_REQUIRE_THROWS(cudaStreamEndCapture(stream, &graph) == cudaSuccess,
+                               "Capturing the kernels of a device graph failed.");
+      PARTHENON_REQUIRE_THROWS(cudaGraphInstantiateWithFlags(&exec_, graph, 0) ==
+                                   cudaSuccess,
+                               "Instantiating a device graph failed.");
+      cudaGraphDestroy(graph);
+      captured_ = true;
+      key_ = key;
+    }
+    PARTHENON_REQUIRE_THROWS(cudaGraphLaunch(exec_, stream) == cudaSuccess,
+                             "Launching a device graph failed.");
+#elif defined(KOKKOS_ENABLE_HIP)
+    auto stream = exec_space.hip_stream();
+    if (!captured_ || key != key_) {
+      Reset();
+      if (hipStreamBeginCapture(stream, hipStreamCaptureModeThreadLocal) != hipSuccess) {
+        (void)hipGetLastError();
+        f();
+        return;
+      }
+      f();
+      hipGraph_t graph;
+      PARTHENON_REQUIRE_THROWS(hipStreamEndCapture(stream, &graph) == hipSuccess,
+                               "Capturing the kernels of a device graph failed.");
+      PARTHENON_REQUIRE_THROWS(hipGraphInstantiate(&exec_, graph, nullptr, nullptr, 0) ==
+                                   hipSuccess,
+                               "Instantiating a device graph failed.");
+      (void)hipGraphDestroy(graph);
+      captured_ = true;
+      key_ = key;
+    }
+    PARTHENON_REQUIRE_THROWS(hipGraphLaunch(exec_, stream) == hipSuccess,
+                             "Launching a device graph failed.");
+#else
+    f();
+#endif
+  }
+
+  bool Captured() const { return captured_; }
+
+  // Release the captured graph, the next launch captures it again
+  void Reset() {
+    if (!captured_) return;
+#if defined(KOKKOS_ENABLE_CUDA)
+    cudaGraphExecDestroy(exec_);
+#elif defined(KOKKOS_ENABLE_HIP)
+    (void)hipGraphExecDestroy(exec_);
+#endif
+    captured_ = false;
+  }
+
+ private:
+  bool captured_ = false;
+  std::size_t key_ = 0;
+#if defined(KOKKOS_ENABLE_CUDA)
+  cudaGraphExec_t exec_;
+#elif defined(KOKKOS_ENABLE_HIP)
+  hipGraphExec_t exec_;
+#endif
+};
+
+} // namespace parthenon
+
+#endif // UTILS_DEVICE_GRAPH_HPP_
@@ -18,6 +18,8 @@
 #ifndef UTILS_HASH_HPP_
 #define UTILS_HASH_HPP_
 
+#include <cstdint>
+#include <cstring>
 #include <functional>
 #include <tuple>
 
@@ -31,6 +33,30 @@ std::size_t hash_combine(std::size_t lhs, const T &v) {
   return lhs;
 }
 
+// Hash of the bytes of n values, e.g., to detect whether data changed bitwise. Mixes in
+// eight bytes at a time with the splitmix64 finalizer, which (unlike std::hash of
+// floating point values) distinguishes all bit patterns.
+template <class T>
+std::uint64_t hash_bytes(const T *data, std::size_t n, std::uint64_t seed = 0) {
+  auto mix = [](std::uint64_t h) {
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+    return h ^ (h >> 31);
+  };
+  const auto *bytes = reinterpret_cast<const unsigned char *>(data);
+  const std::size_t nbytes = n * sizeof(T);
+  std::uint64_t h = mix(seed + nbytes);
+  std::size_t i = 0;
+  for (; i + sizeof(std::uint64_t) <= nbytes; i += sizeof(std::uint64_t)) {
+    std::uint64_t word;
+    std::memcpy(&word, bytes + i, sizeof(word));
+    h = mix(h ^ word) + 0x9e3779b97f4a7c15ULL;
+  }
+  std::uint64_t tail = 0;
+  std::memcpy(&tail, bytes + i, nbytes - i);
+  return mix(h ^ tail);
+}
+
 template <class Tup, std::size_t I = std::tuple_size<Tup>::value - 1>
 struct TupHash {
   static std::size_t val(const Tup &tup, std::size_t seed = 0) {
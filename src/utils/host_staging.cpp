@@ -0,0 +1,129 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "utils/error_checking.hpp"
+#include "utils/host_staging.hpp"
+#include "utils/mpi_types.hpp"
+
+namespace parthenon {
+
+namespace {
+using dev_const_t = Kokkos::View<const Real *, LayoutWrapper, BufMemSpace, MemUnmanaged>;
+using dev_t = Kokkos::View<Real *, LayoutWrapper, BufMemSpace, MemUnmanaged>;
+
+std::pair<std::size_t, std::size_t> ChunkRange(int c, std::size_t chunk,
+                                               std::size_t size) {
+  return {c * chunk, std::min((c + 1) * chunk, size)};
+}
+} // namespace
+
+void HostStaging::Initialize(const bool enabled, const std::size_t chunk_bytes) {
+  enabled_ = enabled;
+  constexpr bool host_accessible =
+      Kokkos::SpaceAccessibility<Kokkos::HostSpace, BufMemSpace>::accessible;
+  if (enabled_ && host_accessible) {
+    PARTHENON_WARN("Communication buffers are already accessible from the host, "
+                   "host_staged_comms is ignored.");
+    enabled_ = false;
+  }
+  PARTHENON_REQUIRE_THROWS(!enabled_ || chunk_bytes >= sizeof(Real),
+                           "host_staging_chunk_bytes must hold at least one element.");
+  chunk_size_ = std::max<std::size_t>(chunk_bytes / sizeof(Real), 1);
+}
+
+HostStaging::host_buf_t HostStaging::Get(const std::size_t size) {
+  auto it = free_.lower_bound(size);
+  if (it != free_.end()) {
+    auto buf = std::move(it->second);
+    free_.erase(it);
+    return buf;
+  }
+  return host_buf_t(Kokkos::view_alloc(Kokkos::WithoutInitializing, "host staging"),
+                    size);
+}
+
+void HostStaging::Release(const host_buf_t &buf) {
+  if (buf.size() > 0) free_.emplace(buf.size(), buf);
+}
+
+std::size_t HostStaging::GetSizeInBytes() const {
+  std::size_t bytes = 0;
+  for (const auto &[size, buf] : free_)
+    bytes += size * sizeof(Real);
+  return bytes;
+}
+
+#ifdef MPI_PARALLEL
+void HostStaging::Isend(const Real *data, const std::size_t size, const host_buf_t &host,
+                        const int rank, const int tag, MPI_Comm comm,
+                        std::vector<MPI_Request> &requests) const {
+  PARTHENON_REQUIRE(host.size() >= size, "Host staging buffer is too small.");
+  dev_const_t dev(data, size);
+  const int nchunks = NumChunks(size);
+  DevExecSpace exec_space;
+  for (int c = 0; c < nchunks; ++c) {
+    const auto range = ChunkRange(c, chunk_size_, size);
+    Kokkos::deep_copy(exec_space, Kokkos::subview(host, range),
+                      Kokkos::subview(dev, range));
+    // The sends of the previous chunks progress while waiting for this copy
+    exec_space.fence();
+    requests.emplace_back();
+    PARTHENON_MPI_CHECK(MPI_Isend(host.data() + range.first, range.second - range.first,
+                                  MPITypeMap<Real>::type(), rank, tag, comm,
+                                  &requests.back()));
+  }
+}
+
+void HostStaging::Irecv(const std::size_t size, const int first, const int last,
+                        const host_buf_t &host, const int rank, const int tag,
+                        MPI_Comm comm, std::vector<MPI_Request> &requests) const {
+  PARTHENON_REQUIRE(host.size() >= size, "Host staging buffer is too small.");
+  if (requests.size() < static_cast<std::size_t>(last))
+    requests.resize(last, MPI_REQUEST_NULL);
+  for (int c = first; c < last; ++c) {
+    const auto range = ChunkRange(c, chunk_size_, size);
+    PARTHENON_MPI_CHECK(MPI_Irecv(host.data() + range.first, range.second - range.first,
+                                  MPITypeMap<Real>::type(), rank, tag, comm,
+                                  &requests[c]));
+  }
+}
+
+bool HostStaging::Progress(Real *data, const std::size_t size, const host_buf_t &host,
+                           std::vector<MPI_Request> &requests, int &next, const bool wait,
+                           const DevExecSpace &exec_space) const {
+  dev_t dev(data, size);
+  const int nchunks = NumChunks(size);
+  while (next < nchunks) {
+    int flag = 1;
+    if (wait) {
+      PARTHENON_MPI_CHECK(MPI_Wait(&requests[next], MPI_STATUS_IGNORE));
+    } else {
+      PARTHENON_MPI_CHECK(MPI_Test(&requests[next], &flag, MPI_STATUS_IGNORE));
+    }
+    if (!flag) return false;
+    // Overlaps with the receives of the remaining chunks
+    const auto range = ChunkRange(next, chunk_size_, size);
+    Kokkos::deep_copy(exec_space, Kokkos::subview(dev, range),
+                      Kokkos::subview(host, range));
+    ++next;
+  }
+  return true;
+}
+#endif
+
+} // namespace parthenon
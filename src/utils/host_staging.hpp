@@ -0,0 +1,95 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef UTILS_HOST_STAGING_HPP_
+#define UTILS_HOST_STAGING_HPP_
+//! \file host_staging.hpp
+//  \brief Pipelined staging of device messages through pinned host memory
+
+#include <cstddef>
+#include <map>
+#include <vector>
+
+#include "basic_types.hpp"
+#include "kokkos_abstraction.hpp"
+#include "parthenon_mpi.hpp"
+
+namespace parthenon {
+
+// With an MPI library that can't access device memory, messages of device buffers have
+// to be copied to the host before they are sent and back to the device after they were
+// received. Instead of copying a whole message and only then handing it to MPI, messages
+// are split into chunks of a fixed size that are sent as separate messages (which MPI
+// delivers in order) as soon as they arrived on the host, so the copy of a chunk
+// overlaps with the transfer of the chunks before it. Likewise, every received chunk is
+// copied to the device while the next ones are still on the way. Both ranks of a pair
+// need to use the same chunk size.
+//
+// The pinned host storage is expensive to allocate, so it is kept for reuse once it has
+// been released.
+class HostStaging {
+ public:
+  using host_buf_t = Kokkos::View<Real *, LayoutWrapper, HostPinnedMemSpace>;
+
+  HostStaging() = default;
+  HostStaging(const HostStaging &) = delete;
+  HostStaging &operator=(const HostStaging &) = delete;
+
+  // Staging is only enabled if the communication buffers are not accessible from the
+  // host anyway, chunk_bytes is rounded down to a multiple of the size of Real
+  void Initialize(bool enabled, std::size_t chunk_bytes);
+  bool Enabled() const { return enabled_; }
+
+  // Number of elements per chunk and number of chunks of a message of size elements
+  std::size_t ChunkSize() const { return chunk_size_; }
+  int NumChunks(std::size_t size) const {
+    return static_cast<int>((size + chunk_size_ - 1) / chunk_size_);
+  }
+
+  // Pinned storage of at least size elements
+  host_buf_t Get(std::size_t size);
+  void Release(const host_buf_t &buf);
+  // Free the storage that is currently not in use
+  void Trim() { free_.clear(); }
+  std::size_t GetSizeInBytes() const;
+
+#ifdef MPI_PARALLEL
+  // Copy the size elements at data (which have to be ready on the device) to host chunk
+  // by chunk and send every chunk right after it arrived. One request per chunk is
+  // appended to requests, host must be kept alive until they are completed.
+  void Isend(const Real *data, std::size_t size, const host_buf_t &host, int rank,
+             int tag, MPI_Comm comm, std::vector<MPI_Request> &requests) const;
+
+  // Post the receives of the chunks [first, last) of a message of size elements into
+  // host, the requests are stored at requests[first, last)
+  void Irecv(std::size_t size, int first, int last, const host_buf_t &host, int rank,
+             int tag, MPI_Comm comm, std::vector<MPI_Request> &requests) const;
+
+  // Start copying the chunks that have arrived to data in order, beginning with chunk
+  // next, which is advanced past the chunks that are done. Returns true once all chunks
+  // have arrived and all copies have been issued on exec_space. With wait, blocks until
+  // that is the case.
+  bool Progress(Real *data, std::size_t size, const host_buf_t &host,
+                std::vector<MPI_Request> &requests, int &next, bool wait,
+                const DevExecSpace &exec_space) const;
+#endif
+
+ private:
+  bool enabled_ = false;
+  std::size_t chunk_size_ = 1;
+  // unused storage by its number of elements
+  std::multimap<std::size_t, host_buf_t> free_;
+};
+
+} // namespace parthenon
+
+#endif // UTILS_HOST_STAGING_HPP_
@@ -14,6 +14,7 @@
 #define UTILS_INDEXER_HPP_
 
 #include <array>
+#include <cstdint>
 #include <string>
 #include <tuple>
 #include <type_traits>
@@ -67,10 +68,44 @@ struct block_ownership_t {
   bool ownership[3][3][3];
 };
 
+// Division of non-negative ints by an invariant divisor d with a multiplication and a
+// shift instead of an integer division, which is slow in particular on GPUs. With
+// l = ceil(log2(d)) and s = 31 + l, the multiplier m = ceil(2^s / d) gives
+// floor(n / d) = (n * m) >> s for all 0 <= n < 2^31 (Granlund and Montgomery, "Division
+// by invariant integers using multiplication", PLDI 1994), and n * m fits in 64 bits.
+struct FastDivisor {
+  KOKKOS_INLINE_FUNCTION
+  FastDivisor() : FastDivisor(1) {}
+
+  KOKKOS_INLINE_FUNCTION
+  explicit FastDivisor(const int d) : m_(0), s_(0), d_(d) {
+    // Empty index ranges give zero factors, which are never divided by
+    if (d < 1) return;
+    int l = 0;
+    while ((std::uint64_t(1) << l) < static_cast<std::uint64_t>(d))
+      ++l;
+    s_ = 31 + l;
+    m_ = ((std::uint64_t(1) << s_) + d - 1) / d;
+  }
+
+  KOKKOS_FORCEINLINE_FUNCTION
+  int Divide(const int n) const {
+    return static_cast<int>((static_cast<std::uint64_t>(n) * m_) >> s_);
+  }
+
+  KOKKOS_FORCEINLINE_FUNCTION
+  int Divisor() const { return d_; }
+
+ private:
+  std::uint64_t m_;
+  int s_;
+  int d_;
+};
+
 template <class... Ts>
 struct Indexer {
   KOKKOS_INLINE_FUNCTION
-  Indexer() : N{}, start{}, _size{} {};
+  Indexer() : N{}, div{}, start{}, _size{} {};
 
   std::string GetRangesString() const {
     std::string out;
@@ -84,6 +119,7 @@ struct Indexer {
   explicit Indexer(std::pair<Ts, Ts>... Ns)
       : N{GetFactors(std::make_tuple((Ns.second - Ns.first + 1)...),
                      std::make_index_sequence<sizeof...(Ts)>())},
+        div{GetDivisors(N, std::make_index_sequence<sizeof...(Ts)>())},
         start{Ns.first...}, end{Ns.second...}, _size(((Ns.second - Ns.first + 1) * ...)) {
   }
 
@@ -95,6 +131,14 @@ struct Indexer {
     return GetIndicesImpl(idx, std::make_index_sequence<sizeof...(Ts)>());
   }
 
+  // The same as operator(), for an indexer whose last three indices are k, j, and i of
+  // a mesh with DIM dimensions. The k index (and the j index for DIM = 1) is then known
+  // to be at its start, which saves the integer division for it.
+  template <int DIM>
+  KOKKOS_FORCEINLINE_FUNCTION std::tuple<Ts...> GetIndices(int idx) const {
+    return GetIndicesImpl<DIM>(idx, std::make_index_sequence<sizeof...(Ts)>());
+  }
+
   KOKKOS_FORCEINLINE_FUNCTION
   auto GetIdxArray(int idx) const {
     return get_array_from_tuple(
@@ -114,15 +158,26 @@ struct Indexer {
   static const constexpr std::size_t rank = sizeof...(Ts);
 
  protected:
-  template <std::size_t... Is>
+  // Whether index I is a spatial index that is trivial on a mesh with DIM dimensions
+  template <int DIM, std::size_t I>
+  static constexpr bool IsTrivialIndex() {
+    constexpr std::size_t R = sizeof...(Ts);
+    return R >= 3 && ((DIM < 3 && I == R - 3) || (DIM < 2 && I == R - 2));
+  }
+
+  template <int DIM = 3, std::size_t... Is>
   KOKKOS_FORCEINLINE_FUNCTION std::tuple<Ts...>
   GetIndicesImpl(int idx, std::index_sequence<Is...>) const {
     std::tuple<Ts...> idxs;
     (
         [&] {
-          std::get<Is>(idxs) = idx / std::get<Is>(N);
-          idx -= std::get<Is>(idxs) * std::get<Is>(N);
-          std::get<Is>(idxs) += std::get<Is>(start);
+          if constexpr (IsTrivialIndex<DIM, Is>()) {
+            std::get<Is>(idxs) = std::get<Is>(start);
+          } else {
+            std::get<Is>(idxs) = std::get<Is>(div).Divide(idx);
+            idx -= std::get<Is>(idxs) * std::get<Is>(N);
+            std::get<Is>(idxs) += std::get<Is>(start);
+          }
         }(),
         ...);
     return idxs;
@@ -143,7 +198,15 @@ struct Indexer {
     return N;
   }
 
+  template <std::size_t... Is>
+  KOKKOS_FORCEINLINE_FUNCTION static std::array<FastDivisor, sizeof...(Ts)>
+  GetDivisors(const std::array<int, sizeof...(Ts)> &N, std::index_sequence<Is...>) {
+    return {FastDivisor(std::get<Is>(N))...};
+  }
+
   std::array<int, sizeof...(Ts)> N;
+  // The flat index is divided by the factors N without integer divisions
+  std::array<FastDivisor, sizeof...(Ts)> div;
   std::array<int, sizeof...(Ts)> start;
   std::array<int, sizeof...(Ts)> end;
   std::size_t _size;
@@ -189,5 +252,21 @@ using Indexer8D = Indexer<int, int, int, int, int, int, int, int>;
 
 using SpatiallyMaskedIndexer6D = SpatiallyMaskedIndexer<int, int, int, int, int, int>;
 
+// Calls f(std::integral_constant<int, DIM>()) with DIM = ndim, so that a kernel can be
+// instantiated for the dimensionality of the mesh, e.g. to pass DIM on to
+// Indexer::GetIndices or to drop the loops over trivial k and j ranges at compile time.
+// The kernel has to be launched from a named function (template) called by f rather
+// than from f itself, since device lambdas cannot be defined inside generic lambdas.
+template <class F>
+inline void DispatchNDim(const int ndim, F &&f) {
+  if (ndim == 1) {
+    f(std::integral_constant<int, 1>());
+  } else if (ndim == 2) {
+    f(std::integral_constant<int, 2>());
+  } else {
+    f(std::integral_constant<int, 3>());
+  }
+}
+
 } // namespace parthenon
 #endif // UTILS_INDEXER_HPP_
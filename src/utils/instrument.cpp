@@ -0,0 +1,228 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "utils/instrument.hpp"
+
+namespace parthenon {
+
+namespace {
+struct Node {
+  int site;
+  int parent;
+  std::int64_t ns = 0;
+  std::int64_t calls = 0;
+  std::vector<int> children;
+};
+
+// The call tree of one thread, node 0 is the root
+struct ThreadTree {
+  std::vector<Node> nodes{Node{-1, -1}};
+  int current = 0;
+};
+
+std::mutex registry_mutex;
+std::vector<std::string> labels;
+std::unordered_map<std::string, int> label_ids;
+std::vector<std::shared_ptr<ThreadTree>> trees;
+
+ThreadTree &GetThreadTree() {
+  thread_local std::shared_ptr<ThreadTree> tree = []() {
+    auto t = std::make_shared<ThreadTree>();
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    trees.push_back(t);
+    return t;
+  }();
+  return *tree;
+}
+
+// Call tree of all threads merged by the labels along the call path
+struct MergedNode {
+  std::int64_t ns = 0;
+  std::int64_t calls = 0;
+  std::map<std::string, MergedNode> children;
+};
+
+void Merge(const ThreadTree &tree, const int n, MergedNode &merged) {
+  for (const int c : tree.nodes[n].children) {
+    auto &child = merged.children[labels[tree.nodes[c].site]];
+    child.ns += tree.nodes[c].ns;
+    child.calls += tree.nodes[c].calls;
+    Merge(tree, c, child);
+  }
+}
+
+void Print(std::ostream &os, const MergedNode &node, const int depth, const double total,
+           const double min_fraction) {
+  std::vector<std::pair<const std::string *, const MergedNode *>> children;
+  for (const auto &[label, child] : node.children) {
+    if (child.ns >= min_fraction * total) children.emplace_back(&label, &child);
+  }
+  std::sort(children.begin(), children.end(),
+            [](const auto &a, const auto &b) { return a.second->ns > b.second->ns; });
+  for (const auto &[label, child] : children) {
+    std::int64_t exclusive = child->ns;
+    for (const auto &[l, grandchild] : child->children)
+      exclusive -= grandchild.ns;
+    os << std::setw(12) << child->ns * 1e-9 << " " << std::setw(12) << exclusive * 1e-9
+       << " " << std::setw(8) << 100. * child->ns / total << " " << std::setw(12)
+       << child->calls << "  " << std::string(2 * depth, ' ') << *label << std::endl;
+    Print(os, *child, depth + 1, total, min_fraction);
+  }
+}
+
+// Stack of the sites of the open timers of this thread, for the sync tracker
+std::vector<int> &SyncStack() {
+  thread_local std::vector<int> stack;
+  return stack;
+}
+
+std::mutex sync_mutex;
+std::map<std::pair<int, std::string>, std::int64_t> sync_counts;
+
+void OnFence(const char *name, const std::uint32_t, std::uint64_t *) {
+  const auto &stack = SyncStack();
+  const int site = stack.empty() ? -1 : stack.back();
+  std::lock_guard<std::mutex> lock(sync_mutex);
+  sync_counts[{site, name}]++;
+}
+} // namespace
+
+int TimerRegistry::Intern(const std::string &label) {
+  // Labels that are not interned at their call site are looked up on every call, so
+  // avoid taking the lock for labels this thread has seen before
+  thread_local std::unordered_map<std::string, int> cache;
+  auto it = cache.find(label);
+  if (it != cache.end()) return it->second;
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  auto [id, inserted] = label_ids.emplace(label, static_cast<int>(labels.size()));
+  if (inserted) labels.push_back(label);
+  cache[label] = id->second;
+  return id->second;
+}
+
+std::int64_t TimerRegistry::Start(const int site) {
+  auto &tree = GetThreadTree();
+  int child = -1;
+  for (const int c : tree.nodes[tree.current].children) {
+    if (tree.nodes[c].site == site) {
+      child = c;
+      break;
+    }
+  }
+  if (child < 0) {
+    child = static_cast<int>(tree.nodes.size());
+    tree.nodes.push_back(Node{site, tree.current});
+    tree.nodes[tree.current].children.push_back(child);
+  }
+  tree.current = child;
+  return Now();
+}
+
+void TimerRegistry::Stop(const std::int64_t start) {
+  const std::int64_t stop = Now();
+  auto &tree = GetThreadTree();
+  auto &node = tree.nodes[tree.current];
+  node.ns += stop - start;
+  node.calls++;
+  tree.current = node.parent;
+}
+
+void TimerRegistry::Report(std::ostream &os, const double min_fraction) {
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  MergedNode root;
+  for (const auto &tree : trees)
+    Merge(*tree, 0, root);
+  double total = 0.0;
+  for (const auto &[label, child] : root.children)
+    total += child.ns;
+  if (total <= 0.0) return;
+
+  const auto flags = os.flags();
+  const auto precision = os.precision();
+  os << std::fixed << std::setprecision(4);
+  os << "Timers: inclusive [s], exclusive [s], % of total, calls, label" << std::endl;
+  Print(os, root, 0, total, min_fraction);
+  os.flags(flags);
+  os.precision(precision);
+}
+
+double TimerRegistry::Seconds(const std::string &label) {
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  const auto id = label_ids.find(label);
+  if (id == label_ids.end()) return 0.0;
+  std::int64_t ns = 0;
+  for (const auto &tree : trees) {
+    for (const auto &node : tree->nodes) {
+      if (node.site == id->second) ns += node.ns;
+    }
+  }
+  return ns * 1e-9;
+}
+
+bool SyncTracker::Enable(const bool enable) {
+  if (enable == enabled_) return enabled_;
+  if (enable) {
+    // Our callback would replace the one of the tool
+    if (Kokkos::Tools::profileLibraryLoaded()) return false;
+    Kokkos::Tools::Experimental::set_begin_fence_callback(OnFence);
+  } else {
+    Kokkos::Tools::Experimental::set_begin_fence_callback(nullptr);
+  }
+  enabled_ = enable;
+  return enabled_;
+}
+
+void SyncTracker::Push(const int site) { SyncStack().push_back(site); }
+
+void SyncTracker::Pop() {
+  auto &stack = SyncStack();
+  if (!stack.empty()) stack.pop_back();
+}
+
+std::map<std::string, std::int64_t> SyncTracker::TakeCounts() {
+  std::map<std::pair<int, std::string>, std::int64_t> counts;
+  {
+    std::lock_guard<std::mutex> lock(sync_mutex);
+    counts.swap(sync_counts);
+  }
+  std::map<std::string, std::int64_t> by_label;
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  for (const auto &[key, n] : counts) {
+    const auto &[site, fence] = key;
+    by_label[(site < 0 ? std::string("(no timer)") : labels[site]) + ": " + fence] += n;
+  }
+  return by_label;
+}
+
+void TimerRegistry::Clear() {
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  for (auto &tree : trees) {
+    tree->nodes.clear();
+    tree->nodes.push_back(Node{-1, -1});
+    tree->current = 0;
+  }
+}
+
+} // namespace parthenon
@@ -1,5 +1,5 @@
 //========================================================================================
-// (C) (or copyright) 2023. Triad National Security, LLC. All rights reserved.
+// (C) (or copyright) 2023-2024. Triad National Security, LLC. All rights reserved.
 //
 // This program was produced under U.S. Government contract 89233218CNA000001 for Los
 // Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
@@ -13,20 +13,32 @@
 #ifndef UTILS_INSTRUMENT_HPP_
 #define UTILS_INSTRUMENT_HPP_
 
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <ostream>
 #include <string>
 
 #include <Kokkos_Core.hpp>
 
 #define __UNIQUE_INST_VAR2(x, y) x##y
 #define __UNIQUE_INST_VAR(x, y) __UNIQUE_INST_VAR2(x, y)
+// The label of a call site is built once and kept in a function local static
 #define PARTHENON_INSTRUMENT                                                             \
-  KokkosTimer __UNIQUE_INST_VAR(internal_inst, __LINE__)(__FILE__, __LINE__, __func__);
+  static const parthenon::TimerSite __UNIQUE_INST_VAR(internal_site, __LINE__)(         \
+      __FILE__, __LINE__, __func__);                                                     \
+  parthenon::KokkosTimer __UNIQUE_INST_VAR(internal_inst, __LINE__)(                     \
+      __UNIQUE_INST_VAR(internal_site, __LINE__));
 #define PARTHENON_INSTRUMENT_REGION(name)                                                \
-  KokkosTimer __UNIQUE_INST_VAR(internal_inst_reg, __LINE__)(name);
+  parthenon::KokkosTimer __UNIQUE_INST_VAR(internal_inst_reg, __LINE__)(name);
 #define PARTHENON_INSTRUMENT_REGION_PUSH                                                 \
-  Kokkos::Profiling::pushRegion(build_auto_label(__FILE__, __LINE__, __func__));
+  Kokkos::Profiling::pushRegion(PARTHENON_AUTO_LABEL);
 #define PARTHENON_INSTRUMENT_REGION_POP Kokkos::Profiling::popRegion();
-#define PARTHENON_AUTO_LABEL parthenon::build_auto_label(__FILE__, __LINE__, __func__)
+#define PARTHENON_AUTO_LABEL                                                             \
+  ([](const char *file, const int line, const char *func) -> const std::string & {      \
+    static const std::string label = parthenon::build_auto_label(file, line, func);     \
+    return label;                                                                        \
+  })(__FILE__, __LINE__, __func__)
 
 namespace parthenon {
 
@@ -37,15 +49,103 @@ inline std::string build_auto_label(const std::string &fullpath, const int line,
   return file + "::" + std::to_string(line) + "::" + name;
 }
 
+// Built-in hierarchical timers. While enabled, every KokkosTimer also accumulates its
+// wall time and number of calls in a per-thread call tree, so that a report of where
+// the time went is available without an external Kokkos Tools library. The trees of
+// all threads are merged by call path in the report.
+class TimerRegistry {
+ public:
+  static void Enable(const bool enable) { enabled_ = enable; }
+  static bool Enabled() { return enabled_; }
+
+  // Unique id of a label, the same label always gets the same id
+  static int Intern(const std::string &label);
+
+  // Open the child node of the current node of this thread for site (creating it if
+  // needed) and close the current node again. Start returns the start time.
+  static std::int64_t Start(int site);
+  static void Stop(std::int64_t start);
+
+  // Write the merged call tree with calls, inclusive and exclusive times. Nodes that
+  // took less than min_fraction of the total are left out.
+  static void Report(std::ostream &os, double min_fraction = 0.001);
+  // Forget all accumulated times, must not be called while timers are open
+  static void Clear();
+  // Seconds accumulated by the timers with label, summed over all call paths and threads
+  static double Seconds(const std::string &label);
+
+  static std::int64_t Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+ private:
+  static inline bool enabled_ = false;
+};
+
+// Built-in tracker of device synchronizations. While enabled, every Kokkos fence,
+// including the ones hidden in deep_copy, host mirrors, and reductions into host
+// scalars, is counted and attributed to the innermost open KokkosTimer of the thread
+// that fenced. The tracker hooks into the Kokkos Tools fence callback, so it cannot be
+// enabled while a Kokkos Tools library is loaded (which sees the fences anyway).
+class SyncTracker {
+ public:
+  // Returns whether the tracker is enabled afterwards
+  static bool Enable(bool enable);
+  static bool Enabled() { return enabled_; }
+
+  // Open and close a timer with the id of site on this thread
+  static void Push(int site);
+  static void Pop();
+
+  // Number of synchronizations by "timer label: fence name" since the last call
+  static std::map<std::string, std::int64_t> TakeCounts();
+
+ private:
+  static inline bool enabled_ = false;
+};
+
+// A call site of PARTHENON_INSTRUMENT, the label and id are computed only once
+struct TimerSite {
+  TimerSite(const std::string &file, const int line, const std::string &name)
+      : label(build_auto_label(file, line, name)), id(TimerRegistry::Intern(label)) {}
+  std::string label;
+  int id;
+};
+
 struct KokkosTimer {
+  explicit KokkosTimer(const TimerSite &site) {
+    Kokkos::Profiling::pushRegion(site.label);
+    if (TimerRegistry::Enabled()) start_ = TimerRegistry::Start(site.id);
+    if (SyncTracker::Enabled()) {
+      SyncTracker::Push(site.id);
+      synced_ = true;
+    }
+  }
   KokkosTimer(const std::string &file, const int line, const std::string &name) {
     Push(build_auto_label(file, line, name));
   }
   explicit KokkosTimer(const std::string &name) { Push(name); }
-  ~KokkosTimer() { Kokkos::Profiling::popRegion(); }
+  ~KokkosTimer() {
+    if (start_ >= 0) TimerRegistry::Stop(start_);
+    if (synced_) SyncTracker::Pop();
+    Kokkos::Profiling::popRegion();
+  }
 
  private:
-  void Push(const std::string &name) { Kokkos::Profiling::pushRegion(name); }
+  void Push(const std::string &name) {
+    Kokkos::Profiling::pushRegion(name);
+    if (!TimerRegistry::Enabled() && !SyncTracker::Enabled()) return;
+    const int site = TimerRegistry::Intern(name);
+    if (TimerRegistry::Enabled()) start_ = TimerRegistry::Start(site);
+    if (SyncTracker::Enabled()) {
+      SyncTracker::Push(site);
+      synced_ = true;
+    }
+  }
+  std::int64_t start_ = -1;
+  bool synced_ = false;
 };
 
 } // namespace parthenon
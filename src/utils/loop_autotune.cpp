@@ -0,0 +1,94 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+#include "utils/error_checking.hpp"
+#include "utils/loop_autotune.hpp"
+
+namespace parthenon {
+
+const char *LoopAutotuner::Name(const Candidate c) {
+  static const char *names[] = {"flatrange", "mdrange",  "mdrange_default_tile",
+                                "tpttr",     "tptvr",    "tpttrtvr",
+                                "simdfor"};
+  static_assert(sizeof(names) / sizeof(names[0]) == ncandidates);
+  return names[c];
+}
+
+LoopAutotuner::Choice LoopAutotuner::Choose(const std::string &label,
+                                            const unsigned allowed) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto &entry = entries_[label];
+  // A winner loaded from file may not be valid for this kind of loop
+  if (entry.winner >= 0 && (allowed & Bit(Candidate(entry.winner))))
+    return {Candidate(entry.winner), false};
+  entry.winner = -1;
+  entry.allowed = allowed;
+  // Measure the allowed candidate with the fewest samples
+  int next = -1;
+  for (int c = 0; c < ncandidates; ++c) {
+    if ((allowed & Bit(Candidate(c))) && (next < 0 || entry.count[c] < entry.count[next]))
+      next = c;
+  }
+  PARTHENON_REQUIRE(next >= 0, "No loop pattern candidate for " + label);
+  return {Candidate(next), true};
+}
+
+void LoopAutotuner::Record(const std::string &label, const Candidate candidate,
+                           const double seconds) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto &entry = entries_[label];
+  if (entry.winner >= 0) return;
+  // The fastest sample is the least affected by warmup and noise
+  if (entry.count[candidate] == 0 || seconds < entry.best_time[candidate])
+    entry.best_time[candidate] = seconds;
+  entry.count[candidate]++;
+
+  int best = -1;
+  for (int c = 0; c < ncandidates; ++c) {
+    if (!(entry.allowed & Bit(Candidate(c)))) continue;
+    if (entry.count[c] < samples_) return;
+    if (best < 0 || entry.best_time[c] < entry.best_time[best]) best = c;
+  }
+  entry.winner = best;
+}
+
+void LoopAutotuner::Save(const std::string &filename) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::ofstream file(filename);
+  PARTHENON_REQUIRE_THROWS(file.is_open(), "Could not open " + filename);
+  for (const auto &[label, entry] : entries_) {
+    if (entry.winner >= 0) file << Name(Candidate(entry.winner)) << " " << label << "\n";
+  }
+}
+
+void LoopAutotuner::Load(const std::string &filename) {
+  std::ifstream file(filename);
+  if (!file.is_open()) return; // nothing tuned yet
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::string line;
+  while (std::getline(file, line)) {
+    const auto space = line.find(' ');
+    if (space == std::string::npos) continue;
+    const std::string name = line.substr(0, space);
+    for (int c = 0; c < ncandidates; ++c) {
+      if (name == Name(Candidate(c))) entries_[line.substr(space + 1)].winner = c;
+    }
+  }
+}
+
+} // namespace parthenon
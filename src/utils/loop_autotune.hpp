@@ -0,0 +1,83 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef UTILS_LOOP_AUTOTUNE_HPP_
+#define UTILS_LOOP_AUTOTUNE_HPP_
+//! \file loop_autotune.hpp
+//  \brief Runtime selection of the loop pattern of par_for and par_reduce per label
+
+#include <array>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace parthenon {
+
+// Used by par_dispatch with loop_pattern_autotune_tag. The first invocations of a
+// kernel label cycle through the candidate patterns, each one fenced and timed, until
+// every candidate was measured samples times. From then on the candidate with the
+// shortest time is used for the label. Every invocation runs the kernel exactly once,
+// so kernels need not be idempotent. Winners can be saved to and loaded from a file to
+// skip the measurements in later runs.
+class LoopAutotuner {
+ public:
+  enum Candidate : int {
+    flatrange = 0,
+    mdrange,              // MDRange with tiles spanning the innermost index
+    mdrange_default_tile, // MDRange with tiles chosen by Kokkos
+    tpttr,
+    tptvr,
+    tpttrtvr,
+    simdfor,
+    ncandidates
+  };
+  static constexpr unsigned Bit(const Candidate c) { return 1u << c; }
+
+  struct Choice {
+    Candidate candidate;
+    bool measure;
+  };
+
+  static LoopAutotuner &Instance() {
+    static LoopAutotuner tuner;
+    return tuner;
+  }
+
+  // Pattern for the next invocation of label among the allowed candidates (a bit mask)
+  Choice Choose(const std::string &label, unsigned allowed);
+  void Record(const std::string &label, Candidate candidate, double seconds);
+
+  void SetSamples(const int samples) { samples_ = samples; }
+  // Labels that are still measured are not saved, loaded labels are not measured again
+  void Save(const std::string &filename);
+  void Load(const std::string &filename);
+
+  static const char *Name(Candidate c);
+
+ private:
+  LoopAutotuner() = default;
+
+  struct Entry {
+    int winner = -1;
+    unsigned allowed = 0;
+    std::array<double, ncandidates> best_time{};
+    std::array<int, ncandidates> count{};
+  };
+
+  int samples_ = 3;
+  std::mutex mutex_;
+  std::unordered_map<std::string, Entry> entries_;
+};
+
+} // namespace parthenon
+
+#endif // UTILS_LOOP_AUTOTUNE_HPP_
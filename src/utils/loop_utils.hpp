@@ -74,8 +74,10 @@ inline auto func_caller(F func, Args &&...args) -> typename std::enable_if<
 // boundary looping that occurs in many places in the boundary communication
 // routines and allows for easy selection of a subset of the boundaries based
 // on the template parameter BoundaryType. [Really, this probably does not
-// need to be a template parameter, it could just be a function argument]
-template <BoundaryType bound = BoundaryType::any, class F>
+// need to be a template parameter, it could just be a function argument]. Ghost
+// exchanges skip variables that are not exchanged in the stage of md (see
+// Metadata::SetGhostExchangeStages) unless all_stages is true.
+template <BoundaryType bound = BoundaryType::any, bool all_stages = false, class F>
 inline void ForEachBoundary(std::shared_ptr<MeshData<Real>> &md, F func) {
   for (int block = 0; block < md->NumBlocks(); ++block) {
     auto &rc = md->GetBlockData(block);
@@ -134,6 +136,9 @@ inline void ForEachBoundary(std::shared_ptr<MeshData<Real>> &md, F func) {
         if (v->IsSet(Metadata::FillGhost) || v->IsSet(Metadata::Flux)) {
           [[maybe_unused]] constexpr bool flx_bound =
               bound == BoundaryType::flxcor_send || bound == BoundaryType::flxcor_recv;
+          if (!all_stages && !flx_bound &&
+              !v->metadata().ExchangesGhostsInStage(md->StageName()))
+            continue;
           for (auto &nb : pmb->neighbors) {
             if constexpr (bound == BoundaryType::local) {
               if (!v->IsSet(Metadata::FillGhost)) continue;
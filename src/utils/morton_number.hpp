@@ -13,7 +13,9 @@
 #ifndef UTILS_MORTON_NUMBER_HPP_
 #define UTILS_MORTON_NUMBER_HPP_
 
+#include <cstdint>
 #include <memory>
+#include <tuple>
 #include <vector>
 
 #include "utils/bit_hacks.hpp"
@@ -38,6 +40,34 @@ inline uint64_t GetMortonBits(int level, uint64_t x, uint64_t y, uint64_t z, int
   return InterleaveZeros<3, NBITS>(z) << 2 | InterleaveZeros<3, NBITS>(y) << 1 |
          InterleaveZeros<3, NBITS>(x);
 }
+
+// Transforms the nbits-bit coordinates X of a point in n dimensions into the transposed
+// Hilbert index in place, following J. Skilling, "Programming the Hilbert curve", AIP
+// Conference Proceedings 707, 381 (2004)
+inline void AxesToTranspose(uint64_t *X, int nbits, int n) {
+  const uint64_t M = uint64_t(1) << (nbits - 1);
+  // Inverse undo
+  for (uint64_t Q = M; Q > 1; Q >>= 1) {
+    const uint64_t P = Q - 1;
+    for (int i = 0; i < n; ++i) {
+      if (X[i] & Q) {
+        X[0] ^= P; // invert
+      } else {
+        const uint64_t t = (X[0] ^ X[i]) & P; // exchange
+        X[0] ^= t;
+        X[i] ^= t;
+      }
+    }
+  }
+  // Gray encode
+  for (int i = 1; i < n; ++i)
+    X[i] ^= X[i - 1];
+  uint64_t t = 0;
+  for (uint64_t Q = M; Q > 1; Q >>= 1)
+    if (X[n - 1] & Q) t ^= Q - 1;
+  for (int i = 0; i < n; ++i)
+    X[i] ^= t;
+}
 } // namespace impl
 
 struct MortonNumber {
@@ -73,6 +103,45 @@ inline bool operator!=(const MortonNumber &lhs, const MortonNumber &rhs) {
   return !(lhs == rhs);
 }
 
+// Position of the cell with index (x, y, z) on the given level along the Hilbert curve
+// through an ndim-dimensional domain, stored like a MortonNumber. The curve visits the
+// cells of every level as a contiguous range of the cell on the level above it, and the
+// key of a cell lies in that range, so non-overlapping cells of different levels (e.g.
+// the leaf blocks of a refined tree) are ordered along the curve by their keys. Unlike
+// Morton numbers, a key is not the smallest key of its children. The Hilbert curve
+// only steps between face neighbors on a uniform grid, which gives more compact ranges
+// of blocks, e.g. when partitioning a list of blocks among ranks. The unused directions
+// of a one- or two-dimensional domain should be zero.
+struct HilbertNumber {
+  // Bits of the Hilbert index going from most to least significant
+  uint64_t bits[3];
+
+  HilbertNumber(int ndim, int level, uint64_t x, uint64_t y, uint64_t z) {
+    constexpr int NBITS = 63;
+    uint64_t X[3] = {x << (NBITS - level), y << (NBITS - level), z << (NBITS - level)};
+    if (ndim > 1) impl::AxesToTranspose(X, NBITS, ndim);
+    // The transposed Hilbert index holds the (most significant) bits of the index in
+    // the order X[0], X[1], X[2], which corresponds to z, y, x of a Morton number
+    for (int chunk = 0; chunk < 3; ++chunk)
+      bits[chunk] = impl::GetMortonBits(NBITS, ndim > 2 ? X[2] : 0, ndim > 1 ? X[1] : 0,
+                                        X[0], 2 - chunk);
+  }
+};
+
+inline bool operator<(const HilbertNumber &lhs, const HilbertNumber &rhs) {
+  return std::tie(lhs.bits[0], lhs.bits[1], lhs.bits[2]) <
+         std::tie(rhs.bits[0], rhs.bits[1], rhs.bits[2]);
+}
+
+inline bool operator==(const HilbertNumber &lhs, const HilbertNumber &rhs) {
+  return (lhs.bits[2] == rhs.bits[2]) && (lhs.bits[1] == rhs.bits[1]) &&
+         (lhs.bits[0] == rhs.bits[0]);
+}
+
+inline bool operator!=(const HilbertNumber &lhs, const HilbertNumber &rhs) {
+  return !(lhs == rhs);
+}
+
 } // namespace parthenon
 
 #endif // UTILS_MORTON_NUMBER_HPP_
@@ -20,6 +20,7 @@
 
 #include <math.h>
 
+#include <cstddef>
 #include <cstdint>
 #include <iostream>
 #include <memory>
@@ -49,6 +50,9 @@ class ObjectPool {
   std::unordered_map<KEY_T, std::pair<weak_t, int>> inuse_;
   static const KEY_T default_key_ = KEY_T();
   KEY_T keyc_;
+  // Logical time of the last Get, shared by all pools so that they can be ordered by use
+  inline static std::uint64_t use_clock_ = 0;
+  std::uint64_t last_use_ = 0;
 
  public:
   template <class... Ts>
@@ -57,6 +61,17 @@ class ObjectPool {
 
   weak_t Get();
 
+  // Get an object restricted to its first n elements, which allows serving requests of
+  // different sizes up to the size of the objects from the same pool. The whole object
+  // is returned to the pool when it is freed.
+  weak_t Get(std::size_t n) {
+    weak_t out = Get();
+    static_cast<T &>(out) = T(out, std::make_pair(std::size_t(0), n));
+    return out;
+  }
+
+  std::uint64_t LastUse() const { return last_use_; }
+
   void PrintStatistics() const {
     std::cout << available_.size() << " unused objects." << std::endl;
     std::cout << inuse_.size() << " used objects." << std::endl;
@@ -72,6 +87,21 @@ class ObjectPool {
     return datum_size * object_size * (inuse_.size() + available_.size());
   }
 
+  std::uint64_t UnusedSizeInBytes() const {
+    if (available_.size() == 0) return 0;
+    constexpr std::uint64_t datum_size = sizeof(typename base_t::value_type);
+    return datum_size * available_.top().size() * available_.size();
+  }
+
+  // Drop all objects that are not in use and return their size. Note that objects created
+  // as views into a larger chunk only release their memory once no object of the chunk is
+  // in use anymore.
+  std::uint64_t ReleaseUnused() {
+    const std::uint64_t bytes = UnusedSizeInBytes();
+    available_ = std::stack<weak_t>();
+    return bytes;
+  }
+
   // This should be used with care since it can't generically be
   // checked that the input object has the same size as other objects
   // in the pool
@@ -228,6 +258,7 @@ class ObjectPool<T>::owner_t : public ObjectPool<T>::weak_t {
 template <class T>
 typename ObjectPool<T>::weak_t ObjectPool<T>::Get() {
   weak_t out;
+  last_use_ = ++use_clock_;
   if (available_.size() > 0) {
     out = available_.top();
     available_.pop();
@@ -248,6 +279,17 @@ typename ObjectPool<T>::weak_t ObjectPool<T>::Get() {
   return out;
 }
 
+// Round n up to a size class so that requests of similar sizes share a pool. Classes are
+// spaced by an eighth of the next lower power of two, which wastes at most 12.5%.
+inline std::size_t PoolSizeClass(const std::size_t n) {
+  if (n <= 8) return n;
+  std::size_t pow2 = 1;
+  while (2 * pow2 <= n)
+    pow2 *= 2;
+  const std::size_t step = pow2 / 8;
+  return ((n + step - 1) / step) * step;
+}
+
 template <class T, class U>
 bool UsingSameResource(const T &lhs, const U &rhs) {
   return lhs.GetKey() == rhs.GetKey();
@@ -0,0 +1,146 @@
+//========================================================================================
+// Parthenon performance portable AMR framework
+// Copyright(C) 2024 The Parthenon collaboration
+// Licensed under the 3-clause BSD License, see LICENSE file for details
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#ifndef UTILS_RANDOM_HPP_
+#define UTILS_RANDOM_HPP_
+//! \file random.hpp
+//  \brief Counter-based random numbers that need no stored generator state
+
+#include <cmath>
+#include <cstdint>
+
+#include <Kokkos_Core.hpp>
+
+#include "basic_types.hpp"
+
+namespace parthenon {
+namespace random {
+// One evaluation of the Philox4x32-10 bijection of Salmon et al., "Parallel random
+// numbers: as easy as 1, 2, 3" (SC11), encrypting the counter ctr with the key key
+KOKKOS_INLINE_FUNCTION void Philox4x32(std::uint32_t ctr[4], std::uint32_t k0,
+                                       std::uint32_t k1) {
+  constexpr std::uint64_t M0 = 0xD2511F53;
+  constexpr std::uint64_t M1 = 0xCD9E8D57;
+  for (int r = 0; r < 10; ++r) {
+    if (r > 0) {
+      k0 += 0x9E3779B9;
+      k1 += 0xBB67AE85;
+    }
+    const std::uint64_t p0 = M0 * ctr[0];
+    const std::uint64_t p1 = M1 * ctr[2];
+    const std::uint32_t c1 = ctr[1];
+    const std::uint32_t c3 = ctr[3];
+    ctr[0] = static_cast<std::uint32_t>(p1 >> 32) ^ c1 ^ k0;
+    ctr[1] = static_cast<std::uint32_t>(p1);
+    ctr[2] = static_cast<std::uint32_t>(p0 >> 32) ^ c3 ^ k1;
+    ctr[3] = static_cast<std::uint32_t>(p0);
+  }
+}
+} // namespace random
+
+// A random number generator for one (block, index, step) triple, e.g. a cell or a
+// particle of a block in one cycle. The numbers are a pure function of the seed and the
+// triple, so the generator is created where it is needed instead of being taken from a
+// pool, and the results are independent of the order of threads, the MPI decomposition,
+// and where blocks have been moved to. The interface follows the generators of the
+// Kokkos random pools, so it can be passed to e.g. AliasMethod::Sample. Up to 2^34
+// 32-bit numbers can be drawn from every generator.
+class CounterRNG {
+ public:
+  KOKKOS_INLINE_FUNCTION CounterRNG(const std::uint64_t key, const std::uint32_t block,
+                                    const std::uint32_t index, const std::uint32_t step)
+      : k0_(static_cast<std::uint32_t>(key)),
+        k1_(static_cast<std::uint32_t>(key >> 32)), block_(block), index_(index),
+        step_(step) {}
+
+  KOKKOS_INLINE_FUNCTION std::uint32_t urand() {
+    if (next_ == 4) {
+      out_[0] = draw_++;
+      out_[1] = step_;
+      out_[2] = index_;
+      out_[3] = block_;
+      random::Philox4x32(out_, k0_, k1_);
+      next_ = 0;
+    }
+    return out_[next_++];
+  }
+  KOKKOS_INLINE_FUNCTION std::uint32_t urand(const std::uint32_t range) {
+    return static_cast<std::uint32_t>((static_cast<std::uint64_t>(urand()) * range) >>
+                                      32);
+  }
+  KOKKOS_INLINE_FUNCTION std::uint64_t urand64() {
+    const std::uint64_t lo = urand();
+    return (static_cast<std::uint64_t>(urand()) << 32) | lo;
+  }
+
+  // Uniform in [0, 1), with a random bit for every bit of the mantissa
+  KOKKOS_INLINE_FUNCTION double drand() {
+    return static_cast<double>(urand64() >> 11) * 0x1.0p-53;
+  }
+  KOKKOS_INLINE_FUNCTION double drand(const double range) { return range * drand(); }
+  KOKKOS_INLINE_FUNCTION double drand(const double start, const double end) {
+    return start + (end - start) * drand();
+  }
+  KOKKOS_INLINE_FUNCTION float frand() {
+    return static_cast<float>(urand() >> 8) * 0x1.0p-24f;
+  }
+
+  // Normal distribution with the Box-Muller transform, discarding the second number
+  KOKKOS_INLINE_FUNCTION double normal() {
+    const double u = 1.0 - drand(); // in (0, 1]
+    return Kokkos::sqrt(-2.0 * Kokkos::log(u)) * Kokkos::cos(2.0 * M_PI * drand());
+  }
+  KOKKOS_INLINE_FUNCTION double normal(const double mean, const double std_dev) {
+    return mean + std_dev * normal();
+  }
+
+ private:
+  std::uint32_t k0_, k1_;
+  std::uint32_t block_, index_, step_;
+  std::uint32_t draw_ = 0;
+  std::uint32_t out_[4] = {0, 0, 0, 0};
+  int next_ = 4;
+};
+
+// The seed of a family of generators, stored e.g. as a package Param in place of a
+// Kokkos random pool. It is trivially copyable into kernels and has no state to
+// allocate, checkpoint, or move with blocks. Different streams of the same seed are
+// independent, e.g. to draw numbers for different purposes for the same cell and cycle.
+class RandomStreams {
+ public:
+  RandomStreams() = default;
+  explicit RandomStreams(const std::uint64_t seed, const std::uint32_t stream = 0)
+      : key_(seed ^ (static_cast<std::uint64_t>(stream) * 0x9E3779B97F4A7C15ull)) {}
+
+  // Generator for e.g. cell or particle index of the block with global id gid in cycle
+  // step. For particles, an id that is carried along with the particle keeps the
+  // numbers independent of the position of the particle in the pool.
+  KOKKOS_INLINE_FUNCTION CounterRNG Get(const int gid, const int index,
+                                        const int step) const {
+    return CounterRNG(key_, static_cast<std::uint32_t>(gid),
+                      static_cast<std::uint32_t>(index), static_cast<std::uint32_t>(step));
+  }
+
+  std::uint64_t Key() const { return key_; }
+
+ private:
+  std::uint64_t key_ = 0;
+};
+
+} // namespace parthenon
+
+#endif // UTILS_RANDOM_HPP_
@@ -13,6 +13,7 @@
 #ifndef UTILS_REDUCTIONS_HPP_
 #define UTILS_REDUCTIONS_HPP_
 
+#include <limits>
 #include <memory>
 #include <vector>
 
@@ -125,6 +126,164 @@ struct Reduce : public ReductionBase<T> {
   }
 };
 
+// Combines many small reductions, e.g., of the timestep, solver residuals, and package
+// diagnostics, into a single non-blocking allreduce per synchronization point. Lanes of
+// one or more values are added once, e.g., when setting up a driver, and then for every
+// reduction
+//   - Reset() sets all lanes to the identity of their operation,
+//   - Contribute() combines local values with a lane (any number of times, e.g., once
+//     per partition),
+//   - StartReduce() and CheckReduce() reduce all lanes at once, and
+//   - Get() returns the global results.
+// The lanes are reduced with a derived datatype and a user defined operation that
+// applies the operation of every lane, MPI_SUM, MPI_MIN, and MPI_MAX are supported.
+class AllReduceBatch {
+ public:
+  // Add a lane of n values that are reduced with op and return its index
+  int AddLane(MPI_Op op, const int n = 1) {
+    PARTHENON_REQUIRE_THROWS(!active_, "Cannot add lanes during a reduction");
+    PARTHENON_REQUIRE_THROWS(op == MPI_SUM || op == MPI_MIN || op == MPI_MAX,
+                             "Only MPI_SUM, MPI_MIN, and MPI_MAX lanes are supported");
+    PARTHENON_REQUIRE_THROWS(n > 0, "Lanes need at least one value");
+    const LaneOp lane_op = op == MPI_SUM   ? LaneOp::sum
+                           : op == MPI_MIN ? LaneOp::min
+                                           : LaneOp::max;
+    offsets_.push_back(vals_.size());
+    // Copies of the batch may still share the layout, so don't modify it in place
+    auto ops = std::make_shared<std::vector<LaneOp>>(*ops_);
+    ops->insert(ops->end(), n, lane_op);
+    ops_ = ops;
+    vals_.resize(vals_.size() + n, Identity(lane_op));
+#ifdef MPI_PARALLEL
+    ptype_.reset();
+#endif
+    return offsets_.size() - 1;
+  }
+
+  int NumLanes() const { return offsets_.size(); }
+
+  void Reset() {
+    for (int n = 0; n < vals_.size(); ++n)
+      vals_[n] = Identity((*ops_)[n]);
+  }
+
+  void Contribute(const int lane, const Real val, const int i = 0) {
+    PARTHENON_DEBUG_REQUIRE(!active_, "Cannot contribute during a reduction");
+    const int n = Index(lane, i);
+    Combine((*ops_)[n], val, vals_[n]);
+  }
+
+  Real Get(const int lane, const int i = 0) const {
+    PARTHENON_DEBUG_REQUIRE(!active_, "Reduction is still in progress");
+    return vals_[Index(lane, i)];
+  }
+
+  TaskStatus StartReduce() {
+    if (active_) return TaskStatus::complete;
+#ifdef MPI_PARALLEL
+    if (vals_.empty()) return TaskStatus::complete;
+    if (pcomm_ == nullptr) {
+      // Shared (and freed with the last copy of the batch) as in ReductionBase
+      pcomm_ = std::shared_ptr<MPI_Comm>(new MPI_Comm, MPI_Comm_disconnect);
+      PARTHENON_MPI_CHECK(MPI_Comm_dup(MPI_COMM_WORLD, pcomm_.get()));
+    }
+    if (ptype_ == nullptr) {
+      ptype_ = std::shared_ptr<MPI_Datatype>(new MPI_Datatype, [](MPI_Datatype *type) {
+        MPI_Type_free(type);
+        delete type;
+      });
+      PARTHENON_MPI_CHECK(
+          MPI_Type_contiguous(vals_.size(), MPI_PARTHENON_REAL, ptype_.get()));
+      PARTHENON_MPI_CHECK(MPI_Type_commit(ptype_.get()));
+      PARTHENON_MPI_CHECK(MPI_Type_set_attr(*ptype_, Keyval(), ops_.get()));
+    }
+    PARTHENON_MPI_CHECK(MPI_Iallreduce(MPI_IN_PLACE, vals_.data(), 1, *ptype_,
+                                       ReduceLanesOp(), *pcomm_, &req_));
+#endif
+    active_ = true;
+    return TaskStatus::complete;
+  }
+
+  TaskStatus CheckReduce() {
+    if (!active_) return TaskStatus::complete;
+    int check = 1;
+#ifdef MPI_PARALLEL
+    PARTHENON_MPI_CHECK(MPI_Test(&req_, &check, MPI_STATUS_IGNORE));
+#endif
+    if (check) {
+      active_ = false;
+      return TaskStatus::complete;
+    }
+    return TaskStatus::incomplete;
+  }
+
+ private:
+  enum class LaneOp : char { sum, min, max };
+
+  static Real Identity(const LaneOp op) {
+    if (op == LaneOp::sum) return 0;
+    return op == LaneOp::min ? std::numeric_limits<Real>::max()
+                             : std::numeric_limits<Real>::lowest();
+  }
+
+  static void Combine(const LaneOp op, const Real in, Real &inout) {
+    if (op == LaneOp::sum) {
+      inout += in;
+    } else if (op == LaneOp::min) {
+      inout = in < inout ? in : inout;
+    } else {
+      inout = in > inout ? in : inout;
+    }
+  }
+
+  int Index(const int lane, const int i) const {
+    PARTHENON_DEBUG_REQUIRE(lane >= 0 && lane < offsets_.size(), "Invalid lane");
+    return offsets_[lane] + i;
+  }
+
+#ifdef MPI_PARALLEL
+  // The operation of every value is attached to the datatype of the batch
+  static int Keyval() {
+    static int keyval = []() {
+      int k;
+      PARTHENON_MPI_CHECK(MPI_Type_create_keyval(MPI_TYPE_NULL_COPY_FN,
+                                                 MPI_TYPE_NULL_DELETE_FN, &k, nullptr));
+      return k;
+    }();
+    return keyval;
+  }
+
+  static void ReduceLanes(void *in, void *inout, int *len, MPI_Datatype *type) {
+    std::vector<LaneOp> *ops;
+    int found;
+    MPI_Type_get_attr(*type, Keyval(), &ops, &found);
+    auto *pin = static_cast<Real *>(in);
+    auto *pinout = static_cast<Real *>(inout);
+    for (int l = 0; l < *len; ++l) {
+      for (const auto op : *ops)
+        Combine(op, *(pin++), *(pinout++));
+    }
+  }
+
+  static MPI_Op ReduceLanesOp() {
+    static MPI_Op op = []() {
+      MPI_Op o;
+      PARTHENON_MPI_CHECK(MPI_Op_create(ReduceLanes, 1, &o));
+      return o;
+    }();
+    return op;
+  }
+
+  MPI_Request req_;
+  std::shared_ptr<MPI_Comm> pcomm_;
+  std::shared_ptr<MPI_Datatype> ptype_;
+#endif
+  bool active_ = false;
+  std::vector<Real> vals_;
+  std::vector<int> offsets_;
+  std::shared_ptr<std::vector<LaneOp>> ops_ = std::make_shared<std::vector<LaneOp>>();
+};
+
 } // namespace parthenon
 
 #endif // UTILS_REDUCTIONS_HPP_
@@ -0,0 +1,139 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef UTILS_SIMD_HPP_
+#define UTILS_SIMD_HPP_
+
+#include <cstddef>
+#include <type_traits>
+
+#include <Kokkos_Core.hpp>
+#include <Kokkos_SIMD.hpp>
+
+#include "basic_types.hpp"
+#include "kokkos_abstraction.hpp"
+
+namespace parthenon {
+namespace simd {
+
+// Explicit SIMD vectors of the native width of the CPU. On GPU builds the vectors have a
+// single lane, so that kernels written with them run everywhere and the (device)
+// threads provide the parallelism.
+#if defined(KOKKOS_ENABLE_CUDA) || defined(KOKKOS_ENABLE_HIP) || defined(KOKKOS_ENABLE_SYCL)
+template <typename T>
+using vector_t = Kokkos::Experimental::simd<T, Kokkos::Experimental::simd_abi::scalar>;
+#else
+template <typename T>
+using vector_t = Kokkos::Experimental::native_simd<T>;
+#endif
+template <typename T>
+using mask_t = typename vector_t<T>::mask_type;
+using Vector = vector_t<Real>;
+
+// Number of lanes of a vector
+template <typename T = Real>
+inline constexpr int width = static_cast<int>(vector_t<T>::size());
+
+namespace impl {
+#if KOKKOS_VERSION >= 40400
+inline constexpr auto element_aligned = Kokkos::Experimental::simd_flag_default;
+#else
+inline constexpr Kokkos::Experimental::element_aligned_tag element_aligned{};
+#endif
+
+// Mask of the first n lanes
+template <typename T>
+KOKKOS_FORCEINLINE_FUNCTION mask_t<T> FirstLanes(const int n) {
+  return vector_t<T>([](std::size_t l) { return static_cast<T>(l); }) <
+         vector_t<T>(static_cast<T>(n));
+}
+} // namespace impl
+
+// Load the width<T> consecutive values starting at ptr, or only the first nlanes of
+// them (the others are zero), e.g., in the tail of a loop
+template <typename T>
+KOKKOS_FORCEINLINE_FUNCTION vector_t<std::remove_const_t<T>> Load(T *ptr,
+                                                                 const int nlanes) {
+  using U = std::remove_const_t<T>;
+  vector_t<U> v(U(0));
+  if (nlanes >= width<U>) {
+    v.copy_from(ptr, impl::element_aligned);
+  } else {
+    where(impl::FirstLanes<U>(nlanes), v).copy_from(ptr, impl::element_aligned);
+  }
+  return v;
+}
+template <typename T>
+KOKKOS_FORCEINLINE_FUNCTION vector_t<std::remove_const_t<T>> Load(T *ptr) {
+  return Load(ptr, width<std::remove_const_t<T>>);
+}
+
+// Store the lanes of v to the consecutive values starting at ptr, or only the first
+// nlanes of them
+template <typename T>
+KOKKOS_FORCEINLINE_FUNCTION void Store(const vector_t<T> &v, T *ptr, const int nlanes) {
+  if (nlanes >= width<T>) {
+    v.copy_to(ptr, impl::element_aligned);
+  } else {
+    where(impl::FirstLanes<T>(nlanes), v).copy_to(ptr, impl::element_aligned);
+  }
+}
+template <typename T>
+KOKKOS_FORCEINLINE_FUNCTION void Store(const vector_t<T> &v, T *ptr) {
+  Store(v, ptr, width<T>);
+}
+} // namespace simd
+
+// Inner loop pattern that steps the innermost index by the width of simd::Vector. The
+// function gets the first index of every vector and the number of valid lanes, which is
+// the width except in the tail of the loop, so that it can use SparsePack::LoadSimd and
+// StoreSimd (or simd::Load and simd::Store) on rows in i with masked tails.
+// IMPORTANT: like InnerLoopPatternSimdFor, the loops run on a single thread of the team
+struct InnerLoopPatternSimdVector {};
+constexpr InnerLoopPatternSimdVector inner_loop_pattern_simdvector_tag;
+
+template <typename Function>
+KOKKOS_FORCEINLINE_FUNCTION void par_for_inner(InnerLoopPatternSimdVector,
+                                               team_mbr_t team_member, const int il,
+                                               const int iu, const Function &function) {
+  constexpr int w = simd::width<Real>;
+  for (int i = il; i <= iu; i += w) {
+    function(i, (iu - i + 1 < w) ? iu - i + 1 : w);
+  }
+}
+template <typename Function>
+KOKKOS_FORCEINLINE_FUNCTION void
+par_for_inner(InnerLoopPatternSimdVector, team_mbr_t team_member, const int jl,
+              const int ju, const int il, const int iu, const Function &function) {
+  for (int j = jl; j <= ju; ++j) {
+    par_for_inner(
+        inner_loop_pattern_simdvector_tag, team_member, il, iu,
+        [&](const int i, const int nlanes) { function(j, i, nlanes); });
+  }
+}
+template <typename Function>
+KOKKOS_FORCEINLINE_FUNCTION void
+par_for_inner(InnerLoopPatternSimdVector, team_mbr_t team_member, const int kl,
+              const int ku, const int jl, const int ju, const int il, const int iu,
+              const Function &function) {
+  for (int k = kl; k <= ku; ++k) {
+    for (int j = jl; j <= ju; ++j) {
+      par_for_inner(
+          inner_loop_pattern_simdvector_tag, team_member, il, iu,
+          [&](const int i, const int nlanes) { function(k, j, i, nlanes); });
+    }
+  }
+}
+
+} // namespace parthenon
+
+#endif // UTILS_SIMD_HPP_
@@ -1,5 +1,5 @@
 //========================================================================================
-// (C) (or copyright) 2021. Triad National Security, LLC. All rights reserved.
+// (C) (or copyright) 2021-2024. Triad National Security, LLC. All rights reserved.
 //
 // This program was produced under U.S. Government contract 89233218CNA000001 for Los
 // Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
@@ -18,16 +18,19 @@
 //  See tst/unit/test_unit_sort.cpp for example usage.
 
 #include "defs.hpp"
+#include "kokkos_abstraction.hpp"
 #include "parthenon_arrays.hpp"
 
 #include <Kokkos_Sort.hpp>
 
-#ifdef KOKKOS_ENABLE_CUDA
+#if defined(KOKKOS_ENABLE_CUDA) && !defined(__clang__)
 #include <thrust/device_ptr.h>
 #include <thrust/sort.h>
 #endif
 
 #include <algorithm>
+#include <type_traits>
+#include <utility>
 
 namespace parthenon {
 
@@ -56,61 +59,128 @@ KOKKOS_INLINE_FUNCTION int upper_bound(const T &arr, Real val) {
   return l;
 }
 
+namespace impl {
+// Device merge sort of the keys (and values) in [min_idx, max_idx] for backends without
+// a vendor sort. Every pass merges pairs of sorted runs, with every element finding its
+// position in the merged run by a binary search in the other run, so each pass is a
+// single flat kernel. The sort is stable and needs a buffer of the size of the range.
+template <bool WITH_VALUES, class Key, class Value, class KeyComparator>
+void MergeSort(ParArray1D<Key> keys, ParArray1D<Value> values, KeyComparator comparator,
+               size_t min_idx, size_t max_idx) {
+  const int n = max_idx - min_idx + 1;
+  if (n < 2) return;
+  ParArray1D<Key> keys_tmp("sort keys buffer", n);
+  ParArray1D<Value> values_tmp("sort values buffer", WITH_VALUES ? n : 0);
+  Key *ksrc = keys.data() + min_idx;
+  Key *kdst = keys_tmp.data();
+  Value *vsrc = WITH_VALUES ? values.data() + min_idx : nullptr;
+  Value *vdst = values_tmp.data();
+  for (int width = 1; width < n; width *= 2) {
+    par_for(
+        loop_pattern_flatrange_tag, PARTHENON_AUTO_LABEL, DevExecSpace(), 0, n - 1,
+        KOKKOS_LAMBDA(const int idx) {
+          KeyComparator comp = comparator;
+          const int start = (idx / (2 * width)) * (2 * width);
+          const int mid = Kokkos::min(start + width, n);
+          const int end = Kokkos::min(start + 2 * width, n);
+          const Key key = ksrc[idx];
+          // Elements of the left run precede equal elements of the right run
+          const bool left = idx < mid;
+          int lo = left ? mid : start;
+          int hi = left ? end : mid;
+          while (lo < hi) {
+            const int m = lo + (hi - lo) / 2;
+            if (left ? comp(ksrc[m], key) : !comp(key, ksrc[m])) {
+              lo = m + 1;
+            } else {
+              hi = m;
+            }
+          }
+          const int out = left ? idx + (lo - mid) : (idx - mid) + lo;
+          kdst[out] = key;
+          if constexpr (WITH_VALUES) vdst[out] = vsrc[idx];
+        });
+    std::swap(ksrc, kdst);
+    std::swap(vsrc, vdst);
+  }
+  if (ksrc != keys.data() + min_idx) {
+    Key *kout = keys.data() + min_idx;
+    Value *vout = WITH_VALUES ? values.data() + min_idx : nullptr;
+    par_for(
+        loop_pattern_flatrange_tag, PARTHENON_AUTO_LABEL, DevExecSpace(), 0, n - 1,
+        KOKKOS_LAMBDA(const int idx) {
+          kout[idx] = ksrc[idx];
+          if constexpr (WITH_VALUES) vout[idx] = vsrc[idx];
+        });
+  }
+}
+
+template <class Key>
+struct DefaultComparator {
+  KOKKOS_INLINE_FUNCTION bool operator()(const Key &a, const Key &b) const {
+    return a < b;
+  }
+};
+} // namespace impl
+
+// Sorts data in [min_idx, max_idx] on the device with thrust with nvcc, on the host
+// with std::sort if the device is the host, and with a built-in merge sort everywhere
+// else (HIP, SYCL, CUDA with clang)
 template <class Key, class KeyComparator>
 void sort(ParArray1D<Key> data, KeyComparator comparator, size_t min_idx,
           size_t max_idx) {
   PARTHENON_DEBUG_REQUIRE(min_idx < data.extent(0), "Invalid minimum sort index!");
   PARTHENON_DEBUG_REQUIRE(max_idx < data.extent(0), "Invalid maximum sort index!");
-#ifdef KOKKOS_ENABLE_CUDA
-#ifdef __clang__
-  PARTHENON_FAIL("sort is using thrust and there exists an incompatibility with clang, "
-                 "see https://github.com/lanl/parthenon/issues/647 for more details. We "
-                 "won't fix it because eventually the Parthenon sort should make use of "
-                 "Kokkos::sort once a performant implementation is availabe. If you see "
-                 "this message and need sort on CUDA devices with clang compiler please "
-                 "get in touch by opening an issue on the Parthenon GitHub repo.");
-#else
+#if defined(KOKKOS_ENABLE_CUDA) && !defined(__clang__)
   thrust::device_ptr<Key> first_d = thrust::device_pointer_cast(data.data()) + min_idx;
   thrust::device_ptr<Key> last_d = thrust::device_pointer_cast(data.data()) + max_idx + 1;
   thrust::sort(first_d, last_d, comparator);
-#endif
 #else
-  if (std::is_same<DevExecSpace, HostExecSpace>::value) {
+  if constexpr (std::is_same<DevExecSpace, HostExecSpace>::value) {
     std::sort(data.data() + min_idx, data.data() + max_idx + 1, comparator);
   } else {
-    PARTHENON_FAIL("sort is not supported outside of CPU or NVIDIA GPU. If you need sort "
-                   "support on other devices, e.g., AMD or Intel GPUs, please get in "
-                   "touch by opening an issue on the Parthenon GitHub.");
+    impl::MergeSort<false>(data, ParArray1D<int>(), comparator, min_idx, max_idx);
   }
-#endif // KOKKOS_ENABLE_CUDA
+#endif
 }
 
 template <class Key>
 void sort(ParArray1D<Key> data, size_t min_idx, size_t max_idx) {
+#if defined(KOKKOS_ENABLE_CUDA) && !defined(__clang__)
   PARTHENON_DEBUG_REQUIRE(min_idx < data.extent(0), "Invalid minimum sort index!");
   PARTHENON_DEBUG_REQUIRE(max_idx < data.extent(0), "Invalid maximum sort index!");
-#ifdef KOKKOS_ENABLE_CUDA
-#ifdef __clang__
-  PARTHENON_FAIL("sort is using thrust and there exists an incompatibility with clang, "
-                 "see https://github.com/lanl/parthenon/issues/647 for more details. We "
-                 "won't fix it because eventually the Parthenon sort should make use of "
-                 "Kokkos::sort once a performant implementation is availabe. If you see "
-                 "this message and need sort on CUDA devices with clang compiler please "
-                 "get in touch by opening an issue on the Parthenon GitHub repo.");
-#else
   thrust::device_ptr<Key> first_d = thrust::device_pointer_cast(data.data()) + min_idx;
   thrust::device_ptr<Key> last_d = thrust::device_pointer_cast(data.data()) + max_idx + 1;
   thrust::sort(first_d, last_d);
+#else
+  sort(data, impl::DefaultComparator<Key>(), min_idx, max_idx);
 #endif
+}
+
+// Sorts the keys in [min_idx, max_idx] and applies the same permutation to values, e.g.
+// to sort particle indices by cell. Unlike sort, this is stable on every backend.
+template <class Key, class Value, class KeyComparator>
+void sort_by_key(ParArray1D<Key> keys, ParArray1D<Value> values,
+                 KeyComparator comparator, size_t min_idx, size_t max_idx) {
+  PARTHENON_DEBUG_REQUIRE(min_idx < keys.extent(0), "Invalid minimum sort index!");
+  PARTHENON_DEBUG_REQUIRE(max_idx < keys.extent(0), "Invalid maximum sort index!");
+  PARTHENON_DEBUG_REQUIRE(values.extent(0) >= keys.extent(0),
+                          "Need a value for every key!");
+#if defined(KOKKOS_ENABLE_CUDA) && !defined(__clang__)
+  thrust::device_ptr<Key> first_d = thrust::device_pointer_cast(keys.data()) + min_idx;
+  thrust::device_ptr<Key> last_d = thrust::device_pointer_cast(keys.data()) + max_idx + 1;
+  thrust::device_ptr<Value> values_d =
+      thrust::device_pointer_cast(values.data()) + min_idx;
+  thrust::stable_sort_by_key(first_d, last_d, values_d, comparator);
 #else
-  if (std::is_same<DevExecSpace, HostExecSpace>::value) {
-    std::sort(data.data() + min_idx, data.data() + max_idx + 1);
-  } else {
-    PARTHENON_FAIL("sort is not supported outside of CPU or NVIDIA GPU. If you need sort "
-                   "support on other devices, e.g., AMD or Intel GPUs, please get in "
-                   "touch by opening an issue on the Parthenon GitHub.");
-  }
-#endif // KOKKOS_ENABLE_CUDA
+  impl::MergeSort<true>(keys, values, comparator, min_idx, max_idx);
+#endif
+}
+
+template <class Key, class Value>
+void sort_by_key(ParArray1D<Key> keys, ParArray1D<Value> values) {
+  if (keys.extent(0) == 0) return;
+  sort_by_key(keys, values, impl::DefaultComparator<Key>(), 0, keys.extent(0) - 1);
 }
 
 template <class Key, class KeyComparator>
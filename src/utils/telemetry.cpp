@@ -0,0 +1,62 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <sys/resource.h>
+
+#include <utility>
+#include <vector>
+
+#include "utils/instrument.hpp"
+#include "utils/telemetry.hpp"
+
+namespace parthenon {
+
+void Telemetry::FinishCycle(const int ncycle) {
+  if (!Enabled()) return;
+  const double now = Now();
+  Cycle cycle;
+  cycle.ncycle = ncycle;
+  cycle.wall = now - cycle_start_;
+  cycle_start_ = now;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cycle.regions = std::move(regions_);
+    regions_.clear();
+  }
+  for (int t = 0; t < ntimers; ++t)
+    cycle.timers[t] = ns_[t].exchange(0, std::memory_order_relaxed) * 1e-9;
+  if (SyncTracker::Enabled()) {
+    for (auto &[site, n] : SyncTracker::TakeCounts()) {
+      cycle.syncs += n;
+      cycle.sync_sites.emplace_back(site, n);
+    }
+  }
+
+  // ru_maxrss is in kilobytes on Linux (and in bytes on macOS)
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  cycle.memory_hwm = usage.ru_maxrss / (1024. * 1024.);
+#else
+  cycle.memory_hwm = usage.ru_maxrss / 1024.;
+#endif
+  cycles_.push_back(std::move(cycle));
+}
+
+std::vector<Telemetry::Cycle> Telemetry::TakeCycles() {
+  std::vector<Cycle> cycles;
+  cycles.swap(cycles_);
+  return cycles;
+}
+
+} // namespace parthenon
@@ -0,0 +1,96 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef UTILS_TELEMETRY_HPP_
+#define UTILS_TELEMETRY_HPP_
+//! \file telemetry.hpp
+//  \brief Per-cycle breakdown of the wall time for the telemetry output
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace parthenon {
+
+// Collects a breakdown of the wall time of every cycle on this rank, which the telemetry
+// output (file_type = telemetry) reduces over all ranks and writes. Collection is
+// disabled unless such an output exists. The Add functions can be called concurrently
+// from the threads executing tasks.
+class Telemetry {
+ public:
+  enum Timer : int { wait = 0, remesh, load_balance, output, ntimers };
+
+  struct Cycle {
+    int ncycle;
+    double wall;                 // wall time of the whole cycle
+    std::vector<double> regions; // wall time of every task region executed in the cycle
+    std::array<double, ntimers> timers;
+    double memory_hwm; // high-water mark of the resident set size of the rank [MB]
+    // Device synchronizations in the cycle, in total and by call site (see SyncTracker)
+    std::int64_t syncs = 0;
+    std::vector<std::pair<std::string, std::int64_t>> sync_sites;
+  };
+
+  static Telemetry &Instance() {
+    static Telemetry telemetry;
+    return telemetry;
+  }
+
+  void Enable(const bool enable) {
+    enabled_.store(enable, std::memory_order_relaxed);
+    cycle_start_ = Now();
+  }
+  bool Enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  // Seconds since the telemetry was created
+  double Now() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - epoch_)
+        .count();
+  }
+
+  void AddRegion(const double seconds) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    regions_.push_back(seconds);
+  }
+  void Add(const Timer timer, const double seconds) {
+    ns_[timer].fetch_add(static_cast<std::int64_t>(seconds * 1e9),
+                         std::memory_order_relaxed);
+  }
+
+  // Close the record of the current cycle, called by the driver at the end of a cycle
+  void FinishCycle(int ncycle);
+  // Hand out (and forget) the records of all cycles finished since the last call
+  std::vector<Cycle> TakeCycles();
+
+ private:
+  Telemetry() : epoch_(std::chrono::steady_clock::now()) {
+    for (auto &ns : ns_)
+      ns = 0;
+  }
+
+  std::atomic<bool> enabled_{false};
+  std::chrono::steady_clock::time_point epoch_;
+  double cycle_start_ = 0.0;
+  std::mutex mutex_;
+  std::vector<double> regions_;
+  std::array<std::atomic<std::int64_t>, ntimers> ns_;
+  std::vector<Cycle> cycles_;
+};
+
+} // namespace parthenon
+
+#endif // UTILS_TELEMETRY_HPP_
@@ -0,0 +1,180 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef UTILS_VIEW_POOL_HPP_
+#define UTILS_VIEW_POOL_HPP_
+//! \file view_pool.hpp
+//  \brief Recycling of Kokkos views with identical extents
+
+#include <array>
+#include <cstddef>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <exception>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <Kokkos_Core.hpp>
+
+#include "utils/hash.hpp"
+
+namespace parthenon {
+
+// Keeps managed Kokkos views that are no longer used around and hands them out again
+// instead of allocating a new view with the same extents. In AMR all blocks have the
+// same shape, so the storage of the variables of blocks that got derefined or moved to
+// another rank can be reused for the blocks created by the next refinement, which avoids
+// a device allocation and deallocation (each of which synchronizes the device) per
+// variable.
+//
+// A view is only recycled if nothing else references its storage anymore, so views
+// obtained from the pool are as safe to use as freshly allocated ones. Recycled views
+// are zero initialized like new views, but keep the label they were first created with.
+template <class View>
+class ViewPool {
+ public:
+  using extents_t = std::array<std::size_t, View::rank>;
+
+  struct Statistics {
+    std::size_t hits = 0;         // views handed out from the pool
+    std::size_t misses = 0;       // views that had to be allocated
+    std::size_t recycled = 0;     // views returned to the pool
+    std::size_t cached_views = 0; // views currently held by the pool
+    std::size_t cached_bytes = 0; // bytes currently held by the pool
+  };
+
+  ViewPool() = default;
+  ViewPool(const ViewPool &) = delete;
+  ViewPool &operator=(const ViewPool &) = delete;
+
+  // Return a zero initialized view with the given extents, which are expected to be
+  // given for all View::rank dimensions
+  template <class... Args>
+  View Get(const std::string &label, Args... args) {
+    static_assert(sizeof...(Args) == View::rank, "Extents must be given for all ranks");
+    const extents_t extents{static_cast<std::size_t>(args)...};
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      RegisterFinalizeHook();
+      auto it = free_.find(extents);
+      if (it != free_.end() && !it->second.empty()) {
+        View v = std::move(it->second.back());
+        it->second.pop_back();
+        stats_.hits++;
+        stats_.cached_views--;
+        stats_.cached_bytes -= v.span() * sizeof(typename View::value_type);
+        // Blocking so that kernels on other execution space instances that may still
+        // have been using the storage before it was released are done with it
+        Kokkos::deep_copy(v, typename View::value_type());
+        return v;
+      }
+      stats_.misses++;
+    }
+    try {
+      return View(label, args...);
+    } catch (const std::exception &) {
+      // Out of memory (reported as std::bad_alloc or std::runtime_error depending on the
+      // Kokkos version), so give the memory held by the pool back and try again
+      Clear();
+      return View(label, args...);
+    }
+  }
+
+  // Hand the storage of v to the pool if nothing else references it and reset v
+  void Release(View &v) {
+    if (!v.is_allocated()) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    const std::size_t bytes = v.span() * sizeof(typename View::value_type);
+    if (v.use_count() == 1 && stats_.cached_bytes + bytes <= max_bytes_) {
+      extents_t extents;
+      for (int d = 0; d < View::rank; ++d)
+        extents[d] = v.extent(d);
+      free_[extents].push_back(v);
+      stats_.recycled++;
+      stats_.cached_views++;
+      stats_.cached_bytes += bytes;
+    }
+    v = View();
+  }
+
+  // Deallocate all views held by the pool
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_.clear();
+    stats_.cached_views = 0;
+    stats_.cached_bytes = 0;
+  }
+
+  // Limit the memory held by the pool, views released beyond the limit are deallocated.
+  // A limit of zero disables recycling.
+  void SetMaxBytes(const std::size_t max_bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    max_bytes_ = max_bytes;
+    if (stats_.cached_bytes > max_bytes_) {
+      free_.clear();
+      stats_.cached_views = 0;
+      stats_.cached_bytes = 0;
+    }
+  }
+
+  Statistics GetStatistics() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+  }
+
+  void PrintStatistics() const {
+    const auto stats = GetStatistics();
+    std::cout << stats.hits << " views reused, " << stats.misses << " views allocated, "
+              << stats.cached_views << " views (" << stats.cached_bytes
+              << " bytes) cached." << std::endl;
+  }
+
+ private:
+  struct ExtentsHash {
+    std::size_t operator()(const extents_t &extents) const {
+      std::size_t h = 0;
+      for (const auto &e : extents)
+        h = impl::hash_combine(h, e);
+      return h;
+    }
+  };
+
+  // Pools stored in static variables outlive Kokkos, so make sure their views are
+  // deallocated first. Hooks can't be removed, so they only hold a weak reference in case
+  // the pool is destroyed before Kokkos is finalized.
+  void RegisterFinalizeHook() {
+    if (hook_registered_) return;
+    std::weak_ptr<ViewPool *> self = self_;
+    Kokkos::push_finalize_hook([self]() {
+      if (auto pool = self.lock()) {
+        (*pool)->Clear();
+        (*pool)->hook_registered_ = false;
+      }
+    });
+    hook_registered_ = true;
+  }
+
+  mutable std::mutex mutex_;
+  std::unordered_map<extents_t, std::vector<View>, ExtentsHash> free_;
+  Statistics stats_;
+  std::size_t max_bytes_ = std::numeric_limits<std::size_t>::max();
+  bool hook_registered_ = false;
+  std::shared_ptr<ViewPool *> self_ = std::make_shared<ViewPool *>(this);
+};
+
+} // namespace parthenon
+
+#endif // UTILS_VIEW_POOL_HPP_
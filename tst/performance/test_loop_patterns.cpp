@@ -0,0 +1,92 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <string>
+#include <type_traits>
+
+#include <catch2/catch.hpp>
+
+#include "basic_types.hpp"
+#include "config.hpp"
+#include "kokkos_abstraction.hpp"
+
+using parthenon::DevExecSpace;
+using parthenon::par_for;
+using parthenon::par_for_inner;
+using parthenon::par_for_outer;
+using parthenon::ParArray4D;
+using parthenon::Real;
+using parthenon::team_mbr_t;
+
+namespace {
+constexpr int N = 64;   // Cells per dimension
+constexpr int Nvar = 8; // Number of components
+constexpr int N_kernels_to_launch_per_test = 20;
+
+// Measure N_kernels_to_launch_per_test launches of kernel, including a fence
+template <typename Kernel>
+void BenchmarkKernel(const std::string &name, const Kernel &kernel) {
+  BENCHMARK_ADVANCED(name.c_str())(Catch::Benchmark::Chronometer meter) {
+    Kokkos::fence();
+    meter.measure([&]() {
+      for (int n = 0; n < N_kernels_to_launch_per_test; ++n)
+        kernel();
+      Kokkos::fence();
+    });
+  };
+}
+
+template <typename Pattern>
+void BenchmarkPattern(const std::string &name, Pattern pattern, ParArray4D<Real> &a,
+                      ParArray4D<Real> &b) {
+  BenchmarkKernel(name, [&]() {
+    par_for(
+        pattern, name, DevExecSpace(), 0, Nvar - 1, 0, N - 1, 0, N - 1, 0, N - 1,
+        KOKKOS_LAMBDA(const int l, const int k, const int j, const int i) {
+          b(l, k, j, i) = 0.5 * (a(l, k, j, i) + b(l, k, j, i));
+        });
+  });
+}
+} // namespace
+
+TEST_CASE("Loop pattern performance", "[LoopPatterns][performance]") {
+  ParArray4D<Real> a("a", Nvar, N, N, N);
+  ParArray4D<Real> b("b", Nvar, N, N, N);
+  Kokkos::deep_copy(a, 1.0);
+  Kokkos::deep_copy(b, 2.0);
+
+  SECTION("Tightly nested loops") {
+    BenchmarkPattern("par_for MDRange", parthenon::loop_pattern_mdrange_tag, a, b);
+    BenchmarkPattern("par_for FlatRange", parthenon::loop_pattern_flatrange_tag, a, b);
+    BenchmarkPattern("par_for TPTTR", parthenon::loop_pattern_tpttr_tag, a, b);
+    BenchmarkPattern("par_for TPTTRTVR", parthenon::loop_pattern_tpttrtvr_tag, a, b);
+    if constexpr (std::is_same<Kokkos::DefaultExecutionSpace,
+                               Kokkos::DefaultHostExecutionSpace>::value) {
+      BenchmarkPattern("par_for TPTVR", parthenon::loop_pattern_tptvr_tag, a, b);
+      BenchmarkPattern("par_for SimdFor", parthenon::loop_pattern_simdfor_tag, a, b);
+    }
+  }
+
+  SECTION("Hierarchical loops") {
+    BenchmarkKernel("par_for_outer/par_for_inner", [&]() {
+      par_for_outer(
+          DEFAULT_OUTER_LOOP_PATTERN, "par_for_outer/par_for_inner", DevExecSpace(), 0, 0,
+          0, Nvar - 1, 0, N - 1, 0, N - 1,
+          KOKKOS_LAMBDA(team_mbr_t member, const int l, const int k, const int j) {
+            par_for_inner(DEFAULT_INNER_LOOP_PATTERN, member, 0, N - 1, [&](const int i) {
+              b(l, k, j, i) = 0.5 * (a(l, k, j, i) + b(l, k, j, i));
+            });
+          });
+    });
+  }
+}
@@ -0,0 +1,93 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "basic_types.hpp"
+#include "interface/make_pack_descriptor.hpp"
+#include "interface/mesh_data.hpp"
+#include "interface/meshblock_data.hpp"
+#include "interface/metadata.hpp"
+#include "interface/sparse_pack.hpp"
+#include "interface/state_descriptor.hpp"
+#include "kokkos_abstraction.hpp"
+#include "mesh/mesh_refinement.hpp"
+#include "mesh/meshblock.hpp"
+
+using parthenon::BlockList_t;
+using parthenon::MeshBlock;
+using parthenon::MeshData;
+using parthenon::Metadata;
+using parthenon::Real;
+using parthenon::StateDescriptor;
+
+namespace {
+constexpr int N = 16;
+constexpr int NDIM = 3;
+constexpr int NBLOCKS = 64;
+constexpr int NVARS = 16;
+
+BlockList_t MakeBlockList(const std::shared_ptr<StateDescriptor> pkg) {
+  BlockList_t block_list;
+  block_list.reserve(NBLOCKS);
+  for (int i = 0; i < NBLOCKS; ++i) {
+    auto pmb = std::make_shared<MeshBlock>(N, NDIM);
+    auto &pmbd = pmb->meshblock_data.Get();
+    pmbd->Initialize(pkg, pmb);
+    block_list.push_back(pmb);
+  }
+  return block_list;
+}
+} // namespace
+
+TEST_CASE("Sparse pack performance", "[SparsePack][performance]") {
+  auto pkg = std::make_shared<StateDescriptor>("Test package");
+  Metadata m({Metadata::Independent, Metadata::WithFluxes}, std::vector<int>{N, N, N});
+  std::vector<std::string> names;
+  for (int n = 0; n < NVARS; ++n) {
+    names.push_back("v" + std::to_string(n));
+    pkg->AddField(names.back(), m);
+  }
+  BlockList_t block_list = MakeBlockList(pkg);
+  MeshData<Real> mesh_data("base");
+  mesh_data.Initialize(block_list, nullptr);
+
+  const auto desc = parthenon::MakePackDescriptor(pkg.get(), names);
+  const auto desc_flags = parthenon::MakePackDescriptor<parthenon::variable_names::any>(
+      pkg.get(), {Metadata::Independent});
+
+  BENCHMARK("Pack descriptor construction") {
+    return parthenon::MakePackDescriptor(pkg.get(), names);
+  };
+  BENCHMARK("Cached typed pack descriptor") {
+    return parthenon::MakePackDescriptor<parthenon::variable_names::any>(
+        pkg.get(), {Metadata::Independent});
+  };
+
+  // The first call builds the pack, later calls hit the cache of the MeshData
+  BENCHMARK("Pack cache lookup by name") { return desc.GetPack(&mesh_data); };
+  BENCHMARK("Pack cache lookup by flag") { return desc_flags.GetPack(&mesh_data); };
+
+  BENCHMARK_ADVANCED("Pack build")(Catch::Benchmark::Chronometer meter) {
+    std::vector<std::shared_ptr<MeshData<Real>>> mds(meter.runs());
+    for (auto &md : mds) {
+      md = std::make_shared<MeshData<Real>>("base");
+      md->Initialize(block_list, nullptr);
+    }
+    meter.measure([&](int i) { return desc.GetPack(mds[i].get()); });
+  };
+}
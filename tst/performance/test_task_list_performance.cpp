@@ -0,0 +1,70 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+
+#include <catch2/catch.hpp>
+
+#include "basic_types.hpp"
+#include "tasks/tasks.hpp"
+
+using parthenon::TaskCollection;
+using parthenon::TaskID;
+using parthenon::TaskListStatus;
+using parthenon::TaskRegion;
+using parthenon::TaskStatus;
+
+namespace {
+constexpr int nlists = 64;
+constexpr int ntasks = 16;
+
+// A region of nlists lists, each with a chain of ntasks trivial tasks and a final task
+// depending on all of them, so that the measured time is the scheduling overhead
+void AddTrivialTasks(TaskCollection &tc) {
+  TaskRegion &region = tc.AddRegion(nlists);
+  for (int i = 0; i < nlists; ++i) {
+    auto &tl = region[i];
+    TaskID dep, all;
+    for (int n = 0; n < ntasks; ++n) {
+      dep = tl.AddTask(dep, [] { return TaskStatus::complete; });
+      all = all | dep;
+    }
+    tl.AddTask(all, [] { return TaskStatus::complete; });
+  }
+}
+} // namespace
+
+TEST_CASE("Task list overhead", "[TaskList][performance]") {
+  BENCHMARK_ADVANCED("Build and execute")(Catch::Benchmark::Chronometer meter) {
+    meter.measure([&]() {
+      TaskCollection tc;
+      AddTrivialTasks(tc);
+      return tc.Execute();
+    });
+  };
+
+  BENCHMARK_ADVANCED("Execute compiled")(Catch::Benchmark::Chronometer meter) {
+    TaskCollection tc;
+    AddTrivialTasks(tc);
+    tc.Compile();
+    meter.measure([&]() { return tc.Execute(); });
+  };
+
+  BENCHMARK_ADVANCED("Execute compiled on 4 threads")
+  (Catch::Benchmark::Chronometer meter) {
+    TaskCollection tc;
+    AddTrivialTasks(tc);
+    tc.Compile();
+    parthenon::WorkStealingPool pool(4);
+    meter.measure([&]() { return tc.Execute(pool); });
+  };
+}
@@ -25,6 +25,7 @@
 
 #include "basic_types.hpp"
 #include "kokkos_abstraction.hpp"
+#include "utils/simd.hpp"
 
 using parthenon::DevExecSpace;
 using parthenon::ParArray1D;
@@ -404,6 +405,102 @@ bool test_wrapper_nested_4d(OuterLoopPattern outer_loop_pattern,
   return max_rel_err < rel_tol;
 }
 
+bool test_wrapper_blocks_teams(DevExecSpace exec_space) {
+  const int Nb = 3, Nv = 2, N = 8;
+  parthenon::ParArray5D<Real> dev_u("dev_u", Nb, Nv, N, N, N);
+  parthenon::ParArray5D<Real> dev_du("dev_du", Nb, Nv, N, N, N - 2);
+  auto host_u = Kokkos::create_mirror(dev_u);
+  auto host_du = Kokkos::create_mirror(dev_du);
+
+  for (int b = 0; b < Nb; b++)
+    for (int v = 0; v < Nv; v++)
+      for (int k = 0; k < N; k++)
+        for (int j = 0; j < N; j++)
+          for (int i = 0; i < N; i++)
+            host_u(b, v, k, j, i) = (b + 1) * (v + 2) * i * i + k - j;
+  Kokkos::deep_copy(dev_u, host_u);
+
+  // Load the rows of all variables into one pad and difference them into the other
+  using scratch_t = parthenon::TeamScratchPads<2>;
+  const scratch_t scratch(Nv, N);
+  parthenon::par_for_blocks_teams(
+      "unit test blocks teams", exec_space, scratch, 0, Nb - 1, 0, N - 1, 0, N - 1,
+      KOKKOS_LAMBDA(parthenon::team_mbr_t member, const int b, const int k, const int j,
+                    scratch_t::pads_t &pads) {
+        auto &q = pads[0];
+        auto &dq = pads[1];
+        for (int v = 0; v < Nv; v++) {
+          parthenon::par_for_inner(member, 0, N - 1,
+                                   [&](const int i) { q(v, i) = dev_u(b, v, k, j, i); });
+        }
+        member.team_barrier();
+        for (int v = 0; v < Nv; v++) {
+          parthenon::par_for_inner(member, 1, N - 2, [&](const int i) {
+            dq(v, i) = (q(v, i + 1) - q(v, i - 1)) / 2.;
+          });
+        }
+        member.team_barrier();
+        for (int v = 0; v < Nv; v++) {
+          parthenon::par_for_inner(member, 1, N - 2, [&](const int i) {
+            dev_du(b, v, k, j, i - 1) = dq(v, i);
+          });
+        }
+      });
+  Kokkos::deep_copy(host_du, dev_du);
+
+  bool all_same = true;
+  for (int b = 0; b < Nb; b++)
+    for (int v = 0; v < Nv; v++)
+      for (int k = 0; k < N; k++)
+        for (int j = 0; j < N; j++)
+          for (int i = 1; i < N - 1; i++)
+            all_same = all_same &&
+                       host_du(b, v, k, j, i - 1) == 2.0 * (b + 1) * (v + 2) * i;
+  return all_same;
+}
+
+bool test_wrapper_simd_vector(DevExecSpace exec_space) {
+  // An odd number of points, so that the rows end in a masked tail for any width
+  const int N = 19;
+  ParArray3D<Real> dev_u("dev_u", N, N, N);
+  ParArray3D<Real> dev_du("dev_du", N, N, N);
+  auto host_u = Kokkos::create_mirror(dev_u);
+  auto host_du = Kokkos::create_mirror(dev_du);
+
+  for (int k = 0; k < N; k++)
+    for (int j = 0; j < N; j++)
+      for (int i = 0; i < N; i++)
+        host_u(k, j, i) = (k + 1) * i * i - j;
+  Kokkos::deep_copy(dev_u, host_u);
+  Kokkos::deep_copy(dev_du, -1.0);
+
+  parthenon::par_for_outer(
+      parthenon::outer_loop_pattern_teams_tag, "unit test simd vector", exec_space, 0, 0,
+      0, N - 1,
+      KOKKOS_LAMBDA(parthenon::team_mbr_t member, const int k) {
+        parthenon::par_for_inner(
+            parthenon::inner_loop_pattern_simdvector_tag, member, 0, N - 1, 1, N - 2,
+            [&](const int j, const int i, const int nlanes) {
+              const auto up = parthenon::simd::Load(&dev_u(k, j, i + 1), nlanes);
+              const auto um = parthenon::simd::Load(&dev_u(k, j, i - 1), nlanes);
+              const parthenon::simd::Vector half(0.5);
+              parthenon::simd::Store((up - um) * half, &dev_du(k, j, i), nlanes);
+            });
+      });
+  Kokkos::deep_copy(host_du, dev_du);
+
+  // The derivative is written in the interior and the masked lanes leave the
+  // boundaries untouched
+  bool all_same = true;
+  for (int k = 0; k < N; k++)
+    for (int j = 0; j < N; j++)
+      for (int i = 0; i < N; i++)
+        all_same = all_same && host_du(k, j, i) == ((i == 0 || i == N - 1)
+                                                        ? -1.0
+                                                        : 2.0 * (k + 1) * i);
+  return all_same;
+}
+
 TEST_CASE("nested par_for loops", "[wrapper]") {
   auto default_exec_space = DevExecSpace();
 
@@ -420,6 +517,14 @@ TEST_CASE("nested par_for loops", "[wrapper]") {
     }
   }
 
+  SECTION("block teams with scratch pads") {
+    REQUIRE(test_wrapper_blocks_teams(default_exec_space) == true);
+  }
+
+  SECTION("explicit SIMD vectors with masked tails") {
+    REQUIRE(test_wrapper_simd_vector(default_exec_space) == true);
+  }
+
   SECTION("4D nested loops") {
     REQUIRE(test_wrapper_nested_4d(parthenon::outer_loop_pattern_teams_tag,
                                    parthenon::inner_loop_pattern_tvr_tag,
@@ -0,0 +1,94 @@
+//========================================================================================
+// Parthenon performance portable AMR framework
+// Copyright(C) 2024 The Parthenon collaboration
+// Licensed under the 3-clause BSD License, see LICENSE file for details
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <cmath>
+#include <vector>
+
+#include <Kokkos_Random.hpp>
+#include <catch2/catch.hpp>
+
+#include "kokkos_abstraction.hpp"
+#include "utils/alias_method.hpp"
+
+using parthenon::Real;
+using parthenon::AliasMethod::AliasMethod;
+
+// Probability of every bin implied by the tables
+std::vector<Real> ImpliedProbabilities(const AliasMethod &alias) {
+  auto prob = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), alias.prob_table);
+  auto idx = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), alias.alias_table);
+  const int n = prob.extent_int(0);
+  std::vector<Real> p(n, 0.0);
+  for (int i = 0; i < n; ++i) {
+    p[i] += prob(i) / n;
+    if (idx(i) != -1) p[idx(i)] += (1.0 - prob(i)) / n;
+  }
+  return p;
+}
+
+TEST_CASE("AliasMethod built on device", "[AliasMethod]") {
+  GIVEN("A skewed distribution") {
+    const int n = 1000;
+    std::vector<Real> weights(n);
+    Real sum = 0.0;
+    for (int i = 0; i < n; ++i) {
+      weights[i] = (i % 7 == 3) ? 0.0 : std::pow(i + 1.0, -1.5);
+      sum += weights[i];
+    }
+    Kokkos::View<Real *> weights_d("weights", n);
+    auto weights_h = Kokkos::create_mirror_view(weights_d);
+    for (int i = 0; i < n; ++i)
+      weights_h(i) = weights[i];
+    Kokkos::deep_copy(weights_d, weights_h);
+
+    WHEN("the tables are built on device") {
+      AliasMethod alias(weights_d);
+      THEN("they imply the same distribution as the host construction") {
+        const auto p_device = ImpliedProbabilities(alias);
+        const auto p_host = ImpliedProbabilities(AliasMethod(weights));
+        for (int i = 0; i < n; ++i) {
+          REQUIRE(p_device[i] == Approx(weights[i] / sum).margin(1.0e-12));
+          REQUIRE(p_host[i] == Approx(weights[i] / sum).margin(1.0e-12));
+        }
+      }
+      AND_WHEN("they are rebuilt for new weights") {
+        Kokkos::deep_copy(weights_d, 1.0);
+        alias.Build(weights_d);
+        THEN("they describe the new distribution") {
+          for (const auto &p : ImpliedProbabilities(alias))
+            REQUIRE(p == Approx(1.0 / n));
+        }
+      }
+      AND_WHEN("samples are drawn in a batch") {
+        Kokkos::Random_XorShift64_Pool<parthenon::DevExecSpace> pool(1234);
+        Kokkos::View<int *> samples("samples", 100000);
+        alias.SampleBatch(pool, samples);
+        auto samples_h = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), samples);
+        THEN("all are valid and bins without weight are never drawn") {
+          int ninvalid = 0, nfirst = 0;
+          for (int s = 0; s < samples_h.extent_int(0); ++s) {
+            const int b = samples_h(s);
+            ninvalid += (b < 0 || b >= n || weights[b] == 0.0);
+            nfirst += b == 0;
+          }
+          REQUIRE(ninvalid == 0);
+          REQUIRE(nfirst / 100000.0 == Approx(weights[0] / sum).margin(0.01));
+        }
+      }
+    }
+  }
+}
@@ -45,11 +45,13 @@ TEST_CASE("Adding MeshBlockData objects to a DataCollection", "[DataCollection]"
     std::vector<int> size(6, 1);
     Metadata m_ind({Metadata::Independent}, size);
     Metadata m_one({Metadata::OneCopy}, size);
+    Metadata m_der({Metadata::Derived}, size);
 
     auto pgk = std::make_shared<StateDescriptor>("DataCollection test");
     pgk->AddField("var1", m_ind);
     pgk->AddField("var2", m_one);
     pgk->AddField("var3", m_ind);
+    pgk->AddField("var4", m_der);
 
     auto &mbd = d.Get();
     mbd->Initialize(pgk, pmb);
@@ -117,6 +119,23 @@ TEST_CASE("Adding MeshBlockData objects to a DataCollection", "[DataCollection]"
         REQUIRE(hxv2(0) == hv2(0));
       }
     }
+    AND_WHEN("We add a MeshBlockData that shares its non-independent variables") {
+      auto x = d.AddSharing("shared", mbd);
+      THEN("Independent variables should have new storage") {
+        REQUIRE(x->Get("var1").data.data() != mbd->Get("var1").data.data());
+        REQUIRE(x->Get("var3").data.data() != mbd->Get("var3").data.data());
+      }
+      AND_THEN("Derived and OneCopy variables should share the storage of the source") {
+        REQUIRE(x->GetVarPtr("var2") == mbd->GetVarPtr("var2"));
+        REQUIRE(x->GetVarPtr("var4") == mbd->GetVarPtr("var4"));
+      }
+      AND_THEN("Other flags can select the variables with new storage") {
+        auto y = d.AddSharing("shared_derived", mbd,
+                              std::vector<parthenon::MetadataFlag>{Metadata::Derived});
+        REQUIRE(y->GetVarPtr("var1") == mbd->GetVarPtr("var1"));
+        REQUIRE(y->Get("var4").data.data() != mbd->Get("var4").data.data());
+      }
+    }
     AND_WHEN("We want only a subset of variables in a new MeshBlockData by UID") {
       // reset vars so that we can check this is overwritten/or is a
       // new stage
@@ -147,5 +166,17 @@ TEST_CASE("Adding MeshBlockData objects to a DataCollection", "[DataCollection]"
         REQUIRE(hxv2(0) == hv2(0));
       }
     }
+
+    AND_WHEN("We get handles of stage labels") {
+      const auto base = d.GetStageHandle("base");
+      const auto stage = d.GetStageHandle("stage");
+      THEN("Every label has its own handle, which stays the same") {
+        REQUIRE(base.idx != stage.idx);
+        REQUIRE(d.GetStageHandle("stage").idx == stage.idx);
+        d.PurgeNonBase();
+        REQUIRE(d.GetStageHandle("base").idx == base.idx);
+        REQUIRE(d.GetStageHandle("stage").idx == stage.idx);
+      }
+    }
   }
 }
@@ -21,6 +21,7 @@
 #include <catch2/catch.hpp>
 
 #include "kokkos_abstraction.hpp"
+#include "mesh/forest/block_locator.hpp"
 #include "mesh/forest/forest.hpp"
 
 using namespace parthenon::forest;
@@ -142,6 +143,13 @@ TEST_CASE("Simple forest construction", "[forest]") {
     locs = forest.GetMeshBlockListAndResolveGids();
     REQUIRE(locs.size() == 23);
 
+    // Lookups agree with the block list after the trees were modified
+    for (int gid = 0; gid < locs.size(); ++gid) {
+      REQUIRE(forest.count(locs[gid]) == 1);
+      REQUIRE(forest.count(locs[gid].GetParent()) == 0);
+      REQUIRE(forest.GetGid(locs[gid]) == gid);
+    }
+
     // Now flag all blocks for refinement and derefine employing
     // proper nesting. Should just be reverse of previous refinement
     // operations.
@@ -181,3 +189,168 @@ TEST_CASE("Singular forest construction", "[forest]") {
     REQUIRE(locs.size() == 93);
   }
 }
+
+TEST_CASE("Locating blocks by position", "[forest]") {
+  using parthenon::BoundaryFlag;
+  using parthenon::Real;
+  GIVEN("A refined hyper-rectangular forest with three by two root blocks") {
+    parthenon::RegionSize mesh_size({0.0, 0.0, 0.0}, {3.0, 2.0, 1.0}, {1.0, 1.0, 1.0},
+                                    {48, 32, 1});
+    parthenon::RegionSize block_size({0.0, 0.0, 0.0}, {1.0, 1.0, 1.0}, {1.0, 1.0, 1.0},
+                                     {16, 16, 1});
+    std::array<BoundaryFlag, parthenon::BOUNDARY_NFACES> bcs{
+        BoundaryFlag::periodic, BoundaryFlag::periodic, BoundaryFlag::outflow,
+        BoundaryFlag::outflow,  BoundaryFlag::periodic, BoundaryFlag::periodic};
+    auto forest = Forest::HyperRectangular(mesh_size, block_size, bcs);
+    auto locs = forest.GetMeshBlockListAndResolveGids();
+    forest.Refine(locs[4]);
+    locs = forest.GetMeshBlockListAndResolveGids();
+    for (const auto &loc : locs) {
+      if (loc.level() > locs[0].level()) {
+        forest.Refine(loc);
+        break;
+      }
+    }
+    locs = forest.GetMeshBlockListAndResolveGids();
+    std::vector<int> ranks(locs.size());
+    for (int gid = 0; gid < locs.size(); ++gid)
+      ranks[gid] = gid % 3;
+    BlockLocator locator(forest, locs, ranks, mesh_size, bcs, 2);
+    REQUIRE(locator.GetMaxDepth() == 2);
+
+    // Points far outside of the mesh along the periodic direction
+    const int npoints = 2000;
+    std::vector<std::array<Real, 2>> points(npoints);
+    for (int n = 0; n < npoints; ++n)
+      points[n] = {-7.3 + 0.01071 * n, -0.4 + 0.00137 * n};
+
+    THEN("every point is found in the block whose domain contains it") {
+      Kokkos::View<Real * [2]> points_d("points", npoints);
+      auto points_h = Kokkos::create_mirror_view(points_d);
+      for (int n = 0; n < npoints; ++n) {
+        points_h(n, 0) = points[n][0];
+        points_h(n, 1) = points[n][1];
+      }
+      Kokkos::deep_copy(points_d, points_h);
+      Kokkos::View<int *> gids_d("gids", npoints);
+      Kokkos::View<int *> ranks_d("ranks", npoints);
+      Kokkos::parallel_for(
+          "unit::BlockLocator", npoints, KOKKOS_LAMBDA(const int n) {
+            gids_d(n) = locator.FindGid(points_d(n, 0), points_d(n, 1), 0.5);
+            ranks_d(n) = gids_d(n) >= 0 ? locator.GetRank(gids_d(n)) : -1;
+          });
+      auto gids_h = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), gids_d);
+      auto ranks_h = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), ranks_d);
+
+      int nwrong = 0;
+      for (int n = 0; n < npoints; ++n) {
+        const Real x = points[n][0] - 3.0 * std::floor(points[n][0] / 3.0);
+        const Real y = points[n][1];
+        int expected = -1;
+        for (int gid = 0; gid < locs.size(); ++gid) {
+          const auto domain = forest.GetBlockDomain(locs[gid]);
+          if (x >= domain.xmin_[0] && x < domain.xmax_[0] && y >= domain.xmin_[1] &&
+              y < domain.xmax_[1])
+            expected = gid;
+        }
+        nwrong += gids_h(n) != expected;
+        nwrong += expected >= 0 && ranks_h(n) != expected % 3;
+      }
+      REQUIRE(nwrong == 0);
+    }
+  }
+}
+
+TEST_CASE("Derefinement below the root level", "[forest]") {
+  using parthenon::BoundaryFlag;
+  using parthenon::Real;
+  GIVEN("A hyper-rectangular forest with four by four root blocks") {
+    parthenon::RegionSize mesh_size({0.0, 0.0, 0.0}, {4.0, 4.0, 1.0}, {1.0, 1.0, 1.0},
+                                    {64, 64, 1});
+    parthenon::RegionSize block_size({0.0, 0.0, 0.0}, {1.0, 1.0, 1.0}, {1.0, 1.0, 1.0},
+                                     {16, 16, 1});
+    std::array<BoundaryFlag, parthenon::BOUNDARY_NFACES> bcs{
+        BoundaryFlag::outflow,  BoundaryFlag::outflow,  BoundaryFlag::outflow,
+        BoundaryFlag::outflow,  BoundaryFlag::periodic, BoundaryFlag::periodic};
+    auto forest = Forest::HyperRectangular(mesh_size, block_size, bcs);
+    REQUIRE(forest.root_level == 2);
+    auto locs = forest.GetMeshBlockListAndResolveGids();
+    REQUIRE(locs.size() == 16);
+
+    THEN("four root blocks can be replaced by one block of twice their extent") {
+      const auto coarse = locs[0].GetParent();
+      REQUIRE(forest.Derefine(coarse) == 3);
+      locs = forest.GetMeshBlockListAndResolveGids();
+      REQUIRE(locs.size() == 13);
+      const auto domain = forest.GetBlockDomain(coarse);
+      REQUIRE(domain.xmin_[0] == 0.0);
+      REQUIRE(domain.xmax_[0] == 2.0);
+      REQUIRE(domain.xmax_[1] == 2.0);
+
+      AND_THEN("the blocks are located relative to the coarsest level") {
+        std::vector<int> ranks(locs.size(), 0);
+        BlockLocator locator(forest, locs, ranks, mesh_size, bcs, 2);
+        REQUIRE(locator.GetMaxDepth() == 1);
+        int expected[2] = {-1, -1};
+        for (int gid = 0; gid < locs.size(); ++gid) {
+          if (locs[gid] == coarse) expected[0] = gid;
+          const auto d = forest.GetBlockDomain(locs[gid]);
+          if (d.xmin_[0] <= 3.5 && d.xmax_[0] > 3.5 && d.xmin_[1] <= 1.5 &&
+              d.xmax_[1] > 1.5)
+            expected[1] = gid;
+        }
+        Kokkos::View<int[2]> gids_d("gids");
+        Kokkos::parallel_for(
+            "unit::BlockLocator coarse", 1, KOKKOS_LAMBDA(const int) {
+              gids_d(0) = locator.FindGid(1.5, 0.5, 0.5);
+              gids_d(1) = locator.FindGid(3.5, 1.5, 0.5);
+            });
+        auto gids_h = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), gids_d);
+        REQUIRE(gids_h(0) == expected[0]);
+        REQUIRE(gids_h(1) == expected[1]);
+      }
+    }
+  }
+}
+
+TEST_CASE("Adding many blocks at once", "[forest]") {
+  using parthenon::BoundaryFlag;
+  using parthenon::LogicalLocation;
+  GIVEN("Two hyper-rectangular forests with three by two trees") {
+    parthenon::RegionSize mesh_size({0.0, 0.0, 0.0}, {3.0, 2.0, 1.0}, {1.0, 1.0, 1.0},
+                                    {48, 32, 1});
+    parthenon::RegionSize block_size({0.0, 0.0, 0.0}, {1.0, 1.0, 1.0}, {1.0, 1.0, 1.0},
+                                     {16, 16, 1});
+    std::array<BoundaryFlag, parthenon::BOUNDARY_NFACES> bcs{
+        BoundaryFlag::periodic, BoundaryFlag::periodic, BoundaryFlag::outflow,
+        BoundaryFlag::outflow,  BoundaryFlag::periodic, BoundaryFlag::periodic};
+    auto forest_seq = Forest::HyperRectangular(mesh_size, block_size, bcs);
+    auto forest_bulk = Forest::HyperRectangular(mesh_size, block_size, bcs);
+    REQUIRE(forest_bulk.CountTrees() == 6);
+
+    // A deep block in the corner of the domain, so that the nesting crosses the periodic
+    // boundary, one next to a tree boundary and a region at an intermediate level
+    const int rlev = forest_seq.root_level + forest_seq.forest_level.value();
+    std::vector<LogicalLocation> legacy_locs;
+    legacy_locs.emplace_back(rlev + 4, 0, 0, 0);
+    legacy_locs.emplace_back(rlev + 3, 15, 4, 0);
+    for (int j = 4; j < 8; j += 2)
+      for (int i = 4; i < 8; i += 2)
+        legacy_locs.emplace_back(rlev + 2, i, j, 0);
+    auto locs = forest_bulk.GetForestLocationsFromLegacyTreeLocations(legacy_locs);
+    REQUIRE(locs.size() == legacy_locs.size());
+
+    THEN("the result is the same as adding them one by one with proper nesting") {
+      for (const auto &loc : legacy_locs)
+        forest_seq.AddMeshBlock(forest_seq.GetForestLocationFromLegacyTreeLocation(loc));
+      const int added = forest_bulk.AddMeshBlocks(locs);
+      auto blocks_seq = forest_seq.GetMeshBlockListAndResolveGids();
+      auto blocks_bulk = forest_bulk.GetMeshBlockListAndResolveGids();
+      REQUIRE(added > 0);
+      REQUIRE(blocks_bulk.size() == 6 + added);
+      REQUIRE(blocks_bulk == blocks_seq);
+      for (const auto &loc : locs)
+        REQUIRE(forest_bulk.count(loc) == 1);
+    }
+  }
+}
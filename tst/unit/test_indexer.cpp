@@ -0,0 +1,69 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#include <cstdint>
+#include <tuple>
+#include <utility>
+
+#include <catch2/catch.hpp>
+
+#include "utils/indexer.hpp"
+
+using parthenon::FastDivisor;
+using parthenon::Indexer6D;
+
+TEST_CASE("Division by invariant integers", "[Indexer]") {
+  GIVEN("Small divisors") {
+    THEN("all small dividends are divided exactly") {
+      int nwrong = 0;
+      for (int d = 1; d < 1000; ++d) {
+        const FastDivisor div(d);
+        for (int n = 0; n < 20000; ++n)
+          nwrong += (div.Divide(n) != n / d);
+      }
+      REQUIRE(nwrong == 0);
+    }
+  }
+  GIVEN("Large divisors") {
+    THEN("dividends up to the largest int are divided exactly") {
+      int nwrong = 0;
+      for (const int d : {3, 7, 641, 65535, 65536, 65537, 1000003, 1 << 30, 2147483647}) {
+        const FastDivisor div(d);
+        for (std::int64_t n = 0; n < 2147483647; n += 104729)
+          nwrong += (div.Divide(static_cast<int>(n)) != n / d);
+        nwrong += (div.Divide(2147483647) != 2147483647 / d);
+      }
+      REQUIRE(nwrong == 0);
+    }
+  }
+}
+
+TEST_CASE("Indexer round trip", "[Indexer]") {
+  using p_t = std::pair<int, int>;
+  GIVEN("A six-dimensional index range of a two-dimensional mesh") {
+    Indexer6D idxer(p_t{0, 2}, p_t{1, 1}, p_t{2, 4}, p_t{0, 0}, p_t{3, 9}, p_t{-2, 13});
+    THEN("the flat indices map to the indices in row-major order") {
+      REQUIRE(idxer.size() == 3 * 3 * 7 * 16);
+      int nwrong = 0;
+      int n = 0;
+      for (int t = 0; t <= 2; ++t)
+        for (int v = 2; v <= 4; ++v)
+          for (int j = 3; j <= 9; ++j)
+            for (int i = -2; i <= 13; ++i, ++n) {
+              const auto expected = std::make_tuple(t, 1, v, 0, j, i);
+              nwrong += (idxer(n) != expected);
+              nwrong += (idxer.GetIndices<2>(n) != expected);
+            }
+      REQUIRE(nwrong == 0);
+    }
+  }
+}
@@ -0,0 +1,69 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <sstream>
+#include <string>
+
+#include <catch2/catch.hpp>
+
+#include "utils/instrument.hpp"
+
+using parthenon::TimerRegistry;
+
+namespace {
+void Inner() { PARTHENON_INSTRUMENT }
+
+void Outer() {
+  PARTHENON_INSTRUMENT
+  for (int i = 0; i < 3; ++i)
+    Inner();
+}
+} // namespace
+
+TEST_CASE("Built-in hierarchical timers", "[instrument]") {
+  GIVEN("Nested instrumented functions") {
+    TimerRegistry::Clear();
+    TimerRegistry::Enable(true);
+    Outer();
+    Outer();
+    TimerRegistry::Enable(false);
+
+    THEN("Auto labels are interned at their call site") {
+      const std::string *first = nullptr;
+      for (int i = 0; i < 2; ++i) {
+        const std::string &label = PARTHENON_AUTO_LABEL;
+        if (first == nullptr) first = &label;
+        REQUIRE(&label == first);
+      }
+    }
+
+    THEN("The report nests the inner calls below the outer ones and counts them") {
+      std::stringstream ss;
+      TimerRegistry::Report(ss, 0.0);
+      const std::string report = ss.str();
+      const auto outer = report.find("::Outer");
+      const auto inner = report.find("::Inner");
+      REQUIRE(outer != std::string::npos);
+      REQUIRE(inner != std::string::npos);
+      REQUIRE(inner > outer);
+      std::stringstream outer_line(report.substr(report.rfind('\n', outer) + 1));
+      std::stringstream inner_line(report.substr(report.rfind('\n', inner) + 1));
+      double incl, excl, percent;
+      int outer_calls, inner_calls;
+      outer_line >> incl >> excl >> percent >> outer_calls;
+      inner_line >> incl >> excl >> percent >> inner_calls;
+      REQUIRE(outer_calls == 2);
+      REQUIRE(inner_calls == 6);
+    }
+  }
+}
@@ -0,0 +1,179 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <algorithm>
+#include <initializer_list>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "mesh/load_balance.hpp"
+
+using namespace parthenon::loadbalance;
+
+using Assign_t = void (*)(std::vector<double> const &, int, std::vector<int> &);
+using AssignWeighted_t = void (*)(std::vector<double> const &, std::vector<double> const &,
+                                  std::vector<int> &);
+
+TEST_CASE("Block to rank partitioners", "[LoadBalance]") {
+  GIVEN("A list of blocks with uniform cost") {
+    constexpr int nranks = 4;
+    std::vector<double> costs(16, 1.0);
+    std::vector<int> ranklist, nslist, nblist;
+    THEN("The greedy and optimal partitioners give the same even split") {
+      for (auto assign :
+           std::initializer_list<Assign_t>{AssignBlocksGreedy, AssignBlocksOptimal}) {
+        assign(costs, nranks, ranklist);
+        REQUIRE(IsContiguous(ranklist, nranks));
+        UpdateBlockList(ranklist, nranks, nslist, nblist);
+        for (int r = 0; r < nranks; ++r) {
+          REQUIRE(nslist[r] == 4 * r);
+          REQUIRE(nblist[r] == 4);
+        }
+      }
+    }
+  }
+
+  GIVEN("A list of blocks with strongly varying cost") {
+    constexpr int nranks = 3;
+    std::vector<double> costs{10.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 10.0};
+    std::vector<int> ranklist, nslist, nblist;
+    THEN("The optimal partitioner achieves the best possible bottleneck") {
+      AssignBlocksOptimal(costs, nranks, ranklist);
+      REQUIRE(IsContiguous(ranklist, nranks));
+      // Brute force over all possible positions of the two rank boundaries
+      double best = 1.e100;
+      std::vector<int> trial(costs.size());
+      for (int b1 = 1; b1 < costs.size(); ++b1) {
+        for (int b2 = b1 + 1; b2 < costs.size(); ++b2) {
+          for (int b = 0; b < costs.size(); ++b)
+            trial[b] = (b >= b1) + (b >= b2);
+          best = std::min(best, MaxRankCost(costs, trial, nranks));
+        }
+      }
+      REQUIRE(MaxRankCost(costs, ranklist, nranks) == Approx(best));
+      AND_THEN("It does no worse than the greedy partitioner") {
+        std::vector<int> greedy;
+        AssignBlocksGreedy(costs, nranks, greedy);
+        REQUIRE(MaxRankCost(costs, ranklist, nranks) <=
+                MaxRankCost(costs, greedy, nranks));
+      }
+      AND_THEN("Every rank owns at least one block") {
+        UpdateBlockList(ranklist, nranks, nslist, nblist);
+        for (int r = 0; r < nranks; ++r)
+          REQUIRE(nblist[r] > 0);
+      }
+    }
+  }
+
+  GIVEN("Fewer blocks than ranks") {
+    constexpr int nranks = 5;
+    std::vector<double> costs(3, 1.0);
+    std::vector<int> ranklist, nslist, nblist;
+    THEN("The optimal partitioner still returns a contiguous assignment") {
+      AssignBlocksOptimal(costs, nranks, ranklist);
+      REQUIRE(IsContiguous(ranklist, nranks));
+      UpdateBlockList(ranklist, nranks, nslist, nblist);
+      int nblocks = 0;
+      for (int r = 0; r < nranks; ++r) {
+        REQUIRE(nblist[r] <= 1);
+        nblocks += nblist[r];
+      }
+      REQUIRE(nblocks == costs.size());
+    }
+  }
+
+  GIVEN("Ranks of different throughput") {
+    std::vector<double> weights{1.0, 3.0};
+    std::vector<double> costs(16, 1.0);
+    std::vector<int> ranklist, nslist, nblist;
+    THEN("Every rank receives a cost proportional to its weight") {
+      for (auto assign : std::initializer_list<AssignWeighted_t>{AssignBlocksGreedy,
+                                                                 AssignBlocksOptimal}) {
+        assign(costs, weights, ranklist);
+        REQUIRE(IsContiguous(ranklist, 2));
+        UpdateBlockList(ranklist, 2, nslist, nblist);
+        REQUIRE(nblist[0] == 4);
+        REQUIRE(nblist[1] == 12);
+      }
+    }
+  }
+
+  GIVEN("Ranks grouped into two nodes of different size") {
+    std::vector<int> node_sizes{1, 3};
+    std::vector<double> costs{4.0, 4.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 4.0, 4.0};
+    std::vector<int> ranklist, nslist, nblist;
+    THEN("The node boundary is placed first according to the size of the nodes") {
+      for (auto inner : {Partitioner::greedy, Partitioner::optimal}) {
+        AssignBlocksHierarchical(costs, node_sizes, std::vector<double>(4, 1.0), inner,
+                                 ranklist);
+        REQUIRE(IsContiguous(ranklist, 4));
+        UpdateBlockList(ranklist, 4, nslist, nblist);
+        // A quarter of the total cost of 24 goes to the first node
+        REQUIRE(nblist[0] == 2);
+        for (int r = 1; r < 4; ++r)
+          REQUIRE(nblist[r] > 0);
+      }
+    }
+  }
+
+  GIVEN("A non-monotonic rank list") {
+    std::vector<int> ranklist{0, 1, 0, 1};
+    THEN("It is not contiguous") { REQUIRE(!IsContiguous(ranklist, 2)); }
+  }
+}
+
+TEST_CASE("Incremental partitioner", "[LoadBalance]") {
+  constexpr int nranks = 4;
+  constexpr double tolerance = 0.1;
+  GIVEN("A balanced previous assignment") {
+    std::vector<double> costs(16, 1.0);
+    std::vector<int> prev, ranklist;
+    AssignBlocksOptimal(costs, nranks, prev);
+    THEN("It is kept as is") {
+      AssignBlocksIncremental(costs, prev, nranks, tolerance, ranklist);
+      REQUIRE(ranklist == prev);
+    }
+  }
+
+  GIVEN("A previous assignment that became unbalanced after refinement") {
+    // The blocks of rank 1 got refined and are now more expensive
+    std::vector<double> costs(16, 1.0);
+    for (int b = 4; b < 8; ++b)
+      costs[b] = 2.0;
+    std::vector<int> prev(16), ranklist, optimal;
+    for (int b = 0; b < 16; ++b)
+      prev[b] = b / 4;
+    AssignBlocksIncremental(costs, prev, nranks, tolerance, ranklist);
+    THEN("The result is contiguous and within the bound") {
+      REQUIRE(IsContiguous(ranklist, nranks));
+      AssignBlocksOptimal(costs, nranks, optimal);
+      const double avg = 20.0 / nranks;
+      REQUIRE(MaxRankCost(costs, ranklist, nranks) <=
+              std::max((1.0 + tolerance) * avg, MaxRankCost(costs, optimal, nranks)));
+      AND_THEN("It migrates no more blocks than the optimal partitioner") {
+        REQUIRE(CountMigratedBlocks(prev, ranklist) <= CountMigratedBlocks(prev, optimal));
+      }
+    }
+  }
+
+  GIVEN("No valid previous assignment") {
+    std::vector<double> costs{10.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 10.0};
+    std::vector<int> ranklist, optimal;
+    THEN("The optimal partitioner is used") {
+      AssignBlocksIncremental(costs, {}, nranks, tolerance, ranklist);
+      AssignBlocksOptimal(costs, nranks, optimal);
+      REQUIRE(ranklist == optimal);
+    }
+  }
+}
@@ -15,9 +15,14 @@
 // the public, perform publicly and display publicly, and to permit others to do so.
 //========================================================================================
 
+#include <algorithm>
+#include <array>
 #include <bitset>
+#include <cstdlib>
 #include <iostream>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <catch2/catch.hpp>
 
@@ -25,6 +30,7 @@
 #include "mesh/forest/block_ownership.hpp"
 #include "mesh/forest/logical_coordinate_transformation.hpp"
 #include "utils/indexer.hpp"
+#include "utils/morton_number.hpp"
 
 using namespace parthenon;
 
@@ -117,6 +123,49 @@ TEST_CASE("Morton Numbers", "[Morton Numbers]") {
   }
 }
 
+TEST_CASE("Hilbert Numbers", "[Morton Numbers]") {
+  for (int ndim = 1; ndim <= 3; ++ndim) {
+    GIVEN("All cells of a level in " + std::to_string(ndim) +
+          "D sorted by Hilbert number") {
+      const int level = 4;
+      const int n = 1 << level;
+      std::vector<std::pair<HilbertNumber, std::array<int, 3>>> cells;
+      for (int k = 0; k < (ndim > 2 ? n : 1); ++k)
+        for (int j = 0; j < (ndim > 1 ? n : 1); ++j)
+          for (int i = 0; i < n; ++i)
+            cells.emplace_back(HilbertNumber(ndim, level, i, j, k),
+                               std::array<int, 3>{i, j, k});
+      std::sort(cells.begin(), cells.end(),
+                [](const auto &a, const auto &b) { return a.first < b.first; });
+
+      THEN("consecutive cells are face neighbors") {
+        int nwrong = 0;
+        for (int m = 1; m < cells.size(); ++m) {
+          int dist = 0;
+          for (int d = 0; d < 3; ++d)
+            dist += std::abs(cells[m].second[d] - cells[m - 1].second[d]);
+          nwrong += (dist != 1);
+        }
+        REQUIRE(nwrong == 0);
+      }
+
+      THEN("the children of a cell are contiguous and bracket the key of the parent") {
+        const int nchild = 1 << ndim;
+        int nwrong = 0;
+        for (int m = 0; m < cells.size(); m += nchild) {
+          const auto &p = cells[m].second;
+          for (int c = 1; c < nchild; ++c)
+            for (int d = 0; d < 3; ++d)
+              nwrong += (cells[m + c].second[d] >> 1) != (p[d] >> 1);
+          HilbertNumber parent(ndim, level - 1, p[0] >> 1, p[1] >> 1, p[2] >> 1);
+          nwrong += (parent < cells[m].first) || (cells[m + nchild - 1].first < parent);
+        }
+        REQUIRE(nwrong == 0);
+      }
+    }
+  }
+}
+
 TEST_CASE("Logical Location", "[Logical Location]") {
   GIVEN("A refinement structure") {
     std::map<LogicalLocation, int> leaves;
@@ -0,0 +1,69 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <initializer_list>
+
+#include <catch2/catch.hpp>
+
+#include "basic_types.hpp"
+#include "kokkos_abstraction.hpp"
+#include "utils/object_pool.hpp"
+
+using parthenon::PoolSizeClass;
+using parthenon::Real;
+
+TEST_CASE("Pool size classes", "[ObjectPool]") {
+  THEN("Small sizes and powers of two are their own class") {
+    for (std::size_t n : {0, 1, 7, 8, 16, 1024})
+      REQUIRE(PoolSizeClass(n) == n);
+  }
+  THEN("Other sizes are rounded up by at most an eighth") {
+    for (std::size_t n = 9; n < 5000; ++n) {
+      const auto c = PoolSizeClass(n);
+      REQUIRE(c >= n);
+      REQUIRE(8 * (c - n) <= n);
+      REQUIRE(PoolSizeClass(c) == c);
+    }
+  }
+}
+
+TEST_CASE("Getting and releasing objects of a pool", "[ObjectPool]") {
+  using pool_t = parthenon::buf_pool_t<Real>;
+  constexpr int size = 16;
+  pool_t pool([](pool_t *) { return pool_t::base_t("pool buffer", size); });
+
+  GIVEN("An object restricted to fewer elements than the pool size") {
+    auto *obj = new pool_t::owner_t(pool.Get(10));
+    REQUIRE(obj->size() == 10);
+    REQUIRE(pool.SizeInBytes() == size * sizeof(Real));
+    REQUIRE(pool.UnusedSizeInBytes() == 0);
+    WHEN("It is released") {
+      delete obj;
+      THEN("The whole object is available again") {
+        REQUIRE(pool.UnusedSizeInBytes() == size * sizeof(Real));
+        auto other = pool_t::owner_t(pool.Get());
+        REQUIRE(other.size() == size);
+      }
+      THEN("Unused objects can be dropped") {
+        REQUIRE(pool.ReleaseUnused() == size * sizeof(Real));
+        REQUIRE(pool.SizeInBytes() == 0);
+      }
+    }
+    WHEN("Another object is taken from the pool") {
+      const auto last_use = pool.LastUse();
+      auto other = pool_t::owner_t(pool.Get());
+      THEN("The pool was used more recently") { REQUIRE(pool.LastUse() > last_use); }
+      delete obj;
+    }
+  }
+}
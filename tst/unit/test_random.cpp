@@ -0,0 +1,86 @@
+//========================================================================================
+// Parthenon performance portable AMR framework
+// Copyright(C) 2024 The Parthenon collaboration
+// Licensed under the 3-clause BSD License, see LICENSE file for details
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <cstdint>
+
+#include <catch2/catch.hpp>
+
+#include "kokkos_abstraction.hpp"
+#include "utils/random.hpp"
+
+using parthenon::CounterRNG;
+using parthenon::RandomStreams;
+using parthenon::Real;
+
+TEST_CASE("Philox4x32-10 known answers", "[random]") {
+  // Known answer tests of the Random123 distribution
+  std::uint32_t zero[4] = {0, 0, 0, 0};
+  parthenon::random::Philox4x32(zero, 0, 0);
+  REQUIRE(zero[0] == 0x6627e8d5);
+  REQUIRE(zero[1] == 0xe169c58d);
+  REQUIRE(zero[2] == 0xbc57ac4c);
+  REQUIRE(zero[3] == 0x9b00dbd8);
+
+  std::uint32_t pi[4] = {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344};
+  parthenon::random::Philox4x32(pi, 0xa4093822, 0x299f31d0);
+  REQUIRE(pi[0] == 0xd16cfe09);
+  REQUIRE(pi[1] == 0x94fdcceb);
+  REQUIRE(pi[2] == 0x5001e420);
+  REQUIRE(pi[3] == 0x24126ea1);
+}
+
+TEST_CASE("Counter-based random streams", "[random]") {
+  GIVEN("Generators of the same seed") {
+    RandomStreams streams(1234);
+    THEN("the same triple gives the same numbers and other triples different ones") {
+      auto a = streams.Get(3, 17, 5);
+      auto b = streams.Get(3, 17, 5);
+      auto c = streams.Get(3, 17, 6);
+      auto d = streams.Get(4, 17, 5);
+      auto e = RandomStreams(1234, 1).Get(3, 17, 5);
+      int ndiff = 0;
+      for (int n = 0; n < 10; ++n) {
+        const auto x = a.urand();
+        REQUIRE(x == b.urand());
+        ndiff += (x != c.urand()) + (x != d.urand()) + (x != e.urand());
+      }
+      REQUIRE(ndiff == 30);
+    }
+    THEN("uniform numbers drawn on device have the right moments") {
+      const int n = 1 << 20;
+      Real sum = 0.0;
+      Real sum2 = 0.0;
+      Kokkos::parallel_reduce(
+          Kokkos::RangePolicy<parthenon::DevExecSpace>(0, n),
+          KOKKOS_LAMBDA(const int i, Real &ls) {
+            auto rng = streams.Get(0, i, 0);
+            ls += rng.drand();
+          },
+          sum);
+      Kokkos::parallel_reduce(
+          Kokkos::RangePolicy<parthenon::DevExecSpace>(0, n),
+          KOKKOS_LAMBDA(const int i, Real &ls) {
+            auto rng = streams.Get(0, i, 0);
+            const Real x = rng.normal();
+            ls += x * x;
+          },
+          sum2);
+      REQUIRE(sum / n == Approx(0.5).margin(2.0e-3));
+      REQUIRE(sum2 / n == Approx(1.0).margin(1.0e-2));
+    }
+  }
+}
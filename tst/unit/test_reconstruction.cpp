@@ -0,0 +1,112 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <catch2/catch.hpp>
+
+#include "basic_types.hpp"
+#include "reconstruct/flux_kernel.hpp"
+#include "reconstruct/ppm_inline.hpp"
+#include "reconstruct/weno_inline.hpp"
+
+using parthenon::Real;
+
+TEST_CASE("Pointwise high order reconstruction", "[reconstruction]") {
+  GIVEN("The averages of a linear function") {
+    // Cell averages of 2 x + 1 on cells of width 1 centered at -2, ..., 2
+    const Real q[5] = {-3.0, -1.0, 1.0, 3.0, 5.0};
+    THEN("PPM recovers the face values") {
+      Real qm, qp;
+      parthenon::PPM(q[0], q[1], q[2], q[3], q[4], qm, qp);
+      REQUIRE(qm == Approx(0.0));
+      REQUIRE(qp == Approx(2.0));
+    }
+    THEN("WENO5 and WENOZ recover the face values") {
+      Real qm, qp;
+      parthenon::WENO5<false>(q[0], q[1], q[2], q[3], q[4], qm, qp);
+      REQUIRE(qm == Approx(0.0));
+      REQUIRE(qp == Approx(2.0));
+      parthenon::WENO5<true>(q[0], q[1], q[2], q[3], q[4], qm, qp);
+      REQUIRE(qm == Approx(0.0));
+      REQUIRE(qp == Approx(2.0));
+    }
+  }
+
+  GIVEN("The averages of a smooth quadratic function") {
+    // Cell averages of x^2 on cells of width 1 centered at -2, ..., 2, where the average
+    // of x^2 over [c - 1/2, c + 1/2] is c^2 + 1/12
+    Real q[5];
+    for (int n = 0; n < 5; ++n)
+      q[n] = (n - 2.0) * (n - 2.0) + 1.0 / 12.0;
+    THEN("WENOZ is accurate away from the extremum") {
+      // Shift the stencil so that it sits on the monotone part of the parabola
+      Real qs[5];
+      for (int n = 0; n < 5; ++n)
+        qs[n] = (n + 1.0) * (n + 1.0) + 1.0 / 12.0;
+      Real qm, qp;
+      parthenon::WENO5<true>(qs[0], qs[1], qs[2], qs[3], qs[4], qm, qp);
+      REQUIRE(qm == Approx(2.5 * 2.5).epsilon(1.0e-3));
+      REQUIRE(qp == Approx(3.5 * 3.5).epsilon(1.0e-3));
+    }
+    THEN("PPM flattens at the extremum") {
+      Real qm, qp;
+      parthenon::PPM(q[0], q[1], q[2], q[3], q[4], qm, qp);
+      REQUIRE(qm == Approx(q[2]));
+      REQUIRE(qp == Approx(q[2]));
+    }
+  }
+
+  GIVEN("The reconstruction policies of CalculateFluxes") {
+    const Real q[5] = {-3.0, -1.0, 1.0, 3.0, 5.0};
+    THEN("all but donor cell recover the face values of a linear function") {
+      using namespace parthenon::reconstruction;
+      Real qm, qp;
+      DonorCell::Faces(q[0], q[1], q[2], q[3], q[4], qm, qp);
+      REQUIRE(qm == Approx(1.0));
+      REQUIRE(qp == Approx(1.0));
+      PiecewiseLinear::Faces(q[0], q[1], q[2], q[3], q[4], qm, qp);
+      REQUIRE(qm == Approx(0.0));
+      REQUIRE(qp == Approx(2.0));
+      PiecewiseParabolic::Faces(q[0], q[1], q[2], q[3], q[4], qm, qp);
+      REQUIRE(qm == Approx(0.0));
+      REQUIRE(qp == Approx(2.0));
+      WENOZ::Faces(q[0], q[1], q[2], q[3], q[4], qm, qp);
+      REQUIRE(qm == Approx(0.0));
+      REQUIRE(qp == Approx(2.0));
+    }
+    THEN("piecewise linear is flat at an extremum") {
+      Real qm, qp;
+      parthenon::reconstruction::PiecewiseLinear::Faces(0.0, 1.0, 2.0, 1.0, 0.0, qm, qp);
+      REQUIRE(qm == Approx(2.0));
+      REQUIRE(qp == Approx(2.0));
+    }
+  }
+
+  GIVEN("A discontinuity") {
+    const Real q[6] = {1.0, 1.0, 1.0, 0.0, 0.0, 0.0};
+    THEN("The reconstructed values in the cells next to it do not overshoot") {
+      for (int c = 2; c <= 3; ++c) {
+        Real qm, qp;
+        parthenon::PPM(q[c - 2], q[c - 1], q[c], q[c + 1], q[c + 2], qm, qp);
+        REQUIRE(qm <= 1.0);
+        REQUIRE(qm >= 0.0);
+        REQUIRE(qp <= 1.0);
+        REQUIRE(qp >= 0.0);
+        parthenon::WENO5<true>(q[c - 2], q[c - 1], q[c], q[c + 1], q[c + 2], qm, qp);
+        REQUIRE(qm <= 1.0 + 1.0e-12);
+        REQUIRE(qm >= -1.0e-12);
+        REQUIRE(qp <= 1.0 + 1.0e-12);
+        REQUIRE(qp >= -1.0e-12);
+      }
+    }
+  }
+}
@@ -0,0 +1,67 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <catch2/catch.hpp>
+
+#include "basic_types.hpp"
+#include "utils/reductions.hpp"
+
+using parthenon::AllReduceBatch;
+using parthenon::Real;
+using parthenon::TaskStatus;
+
+TEST_CASE("Batching reductions with an AllReduceBatch", "[AllReduceBatch]") {
+  GIVEN("A batch with a sum, a min, and a max lane") {
+    AllReduceBatch batch;
+    const int sum = batch.AddLane(MPI_SUM, 2);
+    const int min = batch.AddLane(MPI_MIN);
+    const int max = batch.AddLane(MPI_MAX);
+    REQUIRE(batch.NumLanes() == 3);
+
+    THEN("Unsupported operations are rejected") {
+      REQUIRE_THROWS(batch.AddLane(MPI_PROD));
+      REQUIRE_THROWS(batch.AddLane(MPI_SUM, 0));
+    }
+
+    WHEN("Several contributions are made to every lane") {
+      for (const Real val : {3.0, -1.0, 2.0}) {
+        batch.Contribute(sum, val, 0);
+        batch.Contribute(sum, 2 * val, 1);
+        batch.Contribute(min, val);
+        batch.Contribute(max, val);
+      }
+      THEN("They are combined with the operation of the lane") {
+        REQUIRE(batch.Get(sum, 0) == Approx(4.0));
+        REQUIRE(batch.Get(sum, 1) == Approx(8.0));
+        REQUIRE(batch.Get(min) == -1.0);
+        REQUIRE(batch.Get(max) == 3.0);
+      }
+#ifndef MPI_PARALLEL
+      THEN("A reduction on a single rank keeps the local results") {
+        REQUIRE(batch.StartReduce() == TaskStatus::complete);
+        REQUIRE(batch.CheckReduce() == TaskStatus::complete);
+        REQUIRE(batch.Get(sum, 1) == Approx(8.0));
+        REQUIRE(batch.Get(max) == 3.0);
+      }
+#endif
+      THEN("Reset returns every lane to the identity of its operation") {
+        batch.Reset();
+        batch.Contribute(min, 5.0);
+        batch.Contribute(max, -5.0);
+        REQUIRE(batch.Get(sum, 0) == 0.0);
+        REQUIRE(batch.Get(min) == 5.0);
+        REQUIRE(batch.Get(max) == -5.0);
+      }
+    }
+  }
+}
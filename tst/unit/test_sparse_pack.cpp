@@ -208,6 +208,38 @@ TEST_CASE("Test behavior of sparse packs", "[SparsePack]") {
         REQUIRE(hi == 0); // hi is scalar. Only one value.
       }
 
+      THEN("Requesting the same pack again reuses the cached descriptor and pack") {
+        auto desc = parthenon::MakePackDescriptor<v1, v3>(pkg.get());
+        auto pack = desc.GetPack(&mesh_data);
+        const auto ncached = mesh_data.GetSparsePackCache().size();
+        auto desc2 = parthenon::MakePackDescriptor<v1, v3>(pkg.get());
+        REQUIRE(desc2.identifier == desc.identifier);
+        REQUIRE(desc2.identifier_hash == desc.identifier_hash);
+        auto pack2 = desc2.GetPack(&mesh_data);
+        REQUIRE(mesh_data.GetSparsePackCache().size() == ncached);
+        REQUIRE(pack2.GetSizeHost(1, v3()) == 3);
+        AND_THEN("Different options give a different descriptor") {
+          auto desc_flx =
+              parthenon::MakePackDescriptor<v1, v3>(pkg.get(), {}, {PDOpt::WithFluxes});
+          REQUIRE(desc_flx.identifier != desc.identifier);
+        }
+        AND_THEN("The cached pack is rebuilt after a deallocation") {
+          block_list[1]->DeallocateSparse("v3");
+          auto pack3 = desc2.GetPack(&mesh_data);
+          REQUIRE(!pack3.ContainsHost(1, v3()));
+          REQUIRE(pack3.ContainsHost(1, v1()));
+          AND_THEN("Only the block allocated again is updated") {
+            block_list[1]->AllocateSparse("v3");
+            auto pack4 = desc2.GetPack(&mesh_data);
+            REQUIRE(mesh_data.GetSparsePackCache().size() == ncached);
+            REQUIRE(pack4.GetSizeHost(1, v3()) == 3);
+            REQUIRE(pack4.GetSizeHost(0, v3()) == 3);
+            REQUIRE(!pack4.ContainsHost(2, v3()));
+            REQUIRE(pack4.GetUpperBoundHost(1) == 3);
+          }
+        }
+      }
+
       THEN("A sparse pack correctly loads this data and can report existence and "
            "nonexistence for variables on different blocks.") {
         auto desc = parthenon::MakePackDescriptor<v1, v3, v5>(pkg.get());
@@ -264,6 +296,32 @@ TEST_CASE("Test behavior of sparse packs", "[SparsePack]") {
         REQUIRE(nwrong == 0);
       }
 
+      THEN("A fixed extent sparse pack has compile time offsets and reads the same data") {
+        using fixed_pack_t = parthenon::FixedSparsePack<v1, v5>;
+        static_assert(fixed_pack_t::Offset<v1>() == 0);
+        static_assert(fixed_pack_t::Offset<v5>() == 1);
+        static_assert(fixed_pack_t::FixedSize() == 2);
+        auto desc = parthenon::MakeFixedPackDescriptor<v1, v5>(pkg.get());
+        auto pack = desc.GetPack(&mesh_data);
+        REQUIRE(pack.GetSizeHost(1, v5()) == 1);
+        int nwrong = 0;
+        par_reduce(
+            loop_pattern_mdrange_tag, "check fixed", DevExecSpace(), 0,
+            pack.GetNBlocks() - 1, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+            KOKKOS_LAMBDA(int b, int k, int j, int i, int &ltot) {
+              // v5 is the third variable in the loop above
+              Real n = i + 1e1 * j + 1e2 * k + 1e5 * 2 + 1e3 * b;
+              if (n != pack(b, v5(), k, j, i)) ltot += 1;
+              if (pack.GetIndex(b, v5()) != 1) ltot += 1;
+            },
+            nwrong);
+        REQUIRE(nwrong == 0);
+        AND_THEN("A variable that is unallocated on some block cannot be packed") {
+          auto desc3 = parthenon::MakeFixedPackDescriptor<v3, v5>(pkg.get());
+          REQUIRE_THROWS(desc3.GetPack(&mesh_data));
+        }
+      }
+
       THEN("A flattened sparse pack can correctly load this data in a unified outer "
            "index space") {
         using parthenon::PDOpt;
@@ -308,6 +366,38 @@ TEST_CASE("Test behavior of sparse packs", "[SparsePack]") {
         }
       }
 
+      THEN("A compact sparse pack lists only the allocated components of v3") {
+        using parthenon::PDOpt;
+        auto desc = parthenon::MakePackDescriptor<v3>(pkg.get(), {}, {PDOpt::Compact});
+        auto pack = desc.GetPack(&mesh_data);
+        REQUIRE(pack.IsCompact());
+        REQUIRE(pack.GetCompactSize() == 3 * (NBLOCKS - 1));
+        for (int p = 0; p < pack.GetCompactSize(); ++p) {
+          REQUIRE(pack.GetCompactBlockHost(p) != 2);
+          REQUIRE(pack.GetCompactIndexHost(p) < 3);
+        }
+        AND_THEN("par_for_compact only visits the allocated components") {
+          parthenon::par_for_compact(
+              "increment compact", pack, kb, jb, ib,
+              KOKKOS_LAMBDA(const int b, const int n, const int k, const int j,
+                            const int i) { pack(b, n, k, j, i) += 1.0; });
+          int nwrong = 0;
+          par_reduce(
+              loop_pattern_mdrange_tag, "check compact", DevExecSpace(), 0,
+              pack.GetNBlocks() - 1, kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+              KOKKOS_LAMBDA(int b, int k, int j, int i, int &ltot) {
+                const int lo = pack.GetLowerBound(b, v3());
+                const int hi = pack.GetUpperBound(b, v3());
+                for (int c = 0; c <= hi - lo; ++c) {
+                  Real n = i + 1e1 * j + 1e2 * k + 1e4 * c + 1e5 * 1 + 1e3 * b + 1.0;
+                  if (n != pack(b, lo + c, k, j, i)) ltot += 1;
+                }
+              },
+              nwrong);
+          REQUIRE(nwrong == 0);
+        }
+      }
+
       THEN("A sparse pack correctly loads this data and can be read from v3 on a single "
            "block") {
         auto desc = parthenon::MakePackDescriptor<v5, v3>(pkg.get());
@@ -28,6 +28,7 @@
 #include "interface/sparse_pool.hpp"
 #include "interface/state_descriptor.hpp"
 #include "interface/variable.hpp"
+#include "kokkos_abstraction.hpp"
 #include "prolong_restrict/pr_ops.hpp"
 #include "prolong_restrict/prolong_restrict.hpp"
 
@@ -606,3 +607,34 @@ TEST_CASE("Test getting a vector of variable names given criteria", "[StateDescr
     }
   }
 }
+
+namespace {
+struct Coefficients {
+  Real cfl;
+  int order;
+};
+} // namespace
+
+TEST_CASE("Device parameter blocks in StateDescriptor", "[StateDescriptor]") {
+  GIVEN("A package with a device parameter block") {
+    StateDescriptor pkg("test");
+    pkg.AddDeviceParams(Coefficients{0.5, 2});
+    auto params = pkg.DeviceParams<Coefficients>();
+    auto read = [&]() {
+      Real result;
+      Kokkos::parallel_reduce(
+          "read device params", Kokkos::RangePolicy<>(parthenon::DevExecSpace(), 0, 1),
+          KOKKOS_LAMBDA(const int, Real &sum) { sum += params().cfl * params().order; },
+          result);
+      return result;
+    };
+    THEN("kernels can read it") { REQUIRE(read() == Approx(1.0)); }
+    WHEN("it is updated") {
+      pkg.UpdateDeviceParams(Coefficients{0.25, 3});
+      THEN("kernels and the host see the new values") {
+        REQUIRE(read() == Approx(0.75));
+        REQUIRE(pkg.DeviceParamsHost<Coefficients>().order == 3);
+      }
+    }
+  }
+}
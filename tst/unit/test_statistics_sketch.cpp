@@ -0,0 +1,108 @@
+//========================================================================================
+// Parthenon performance portable AMR framework
+// Copyright(C) 2024 The Parthenon collaboration
+// Licensed under the 3-clause BSD License, see LICENSE file for details
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "basic_types.hpp"
+#include "outputs/statistics_sketch.hpp"
+
+using parthenon::Real;
+using namespace parthenon::StatsUtil;
+
+namespace {
+// Adds the values to the sketch as the statistics output does for the cells of a block
+void Add(const std::vector<Real> &values, const SketchLayout &layout, const Real shift,
+         std::vector<Real> &sketch) {
+  for (int n = 0; n < values.size(); ++n) {
+    const Real x = values[n], y = x - shift;
+    sketch[offset::count] += 1.0;
+    for (int p = 0; p < 4; ++p)
+      sketch[offset::sums + p] += std::pow(y, p + 1);
+    if (x < sketch[offset::min]) {
+      sketch[offset::min] = x;
+      sketch[offset::min + 1] = n;
+    }
+    if (x > sketch[offset::max]) {
+      sketch[offset::max] = x;
+      sketch[offset::max + 1] = n;
+    }
+    sketch[offset::bins + layout.Bin(x)] += 1.0;
+  }
+}
+} // namespace
+
+TEST_CASE("Mergeable statistics sketches", "[StatsUtil]") {
+  GIVEN("Sketches of two sets of values") {
+    const SketchLayout layout(0.01, 1.0e-6, 1.0e6);
+    const int stride = layout.Stride();
+    std::vector<Real> a, b;
+    for (int n = 0; n < 1000; ++n) {
+      a.push_back(100.0 + std::sin(0.1 * n) * std::exp(0.001 * n));
+      b.push_back(100.0 - 2.0 * std::cos(0.37 * n));
+    }
+    b.push_back(0.0);
+    b.push_back(-3.0);
+    std::vector<Real> sa(stride), sb(stride), sall(stride);
+    Reset(sa.data(), stride);
+    Reset(sb.data(), stride);
+    Reset(sall.data(), stride);
+    Add(a, layout, 100.0, sa);
+    Add(b, layout, 100.0, sb);
+    std::vector<Real> all = a;
+    all.insert(all.end(), b.begin(), b.end());
+    Add(all, layout, 100.0, sall);
+
+    THEN("merging them gives the sketch of all values") {
+      Merge(sb.data(), sa.data(), stride);
+      for (int n = 0; n < stride; ++n) {
+        if (n == offset::min + 1 || n == offset::max + 1) continue;
+        REQUIRE(sa[n] == Approx(sall[n]).margin(1.0e-8));
+      }
+      REQUIRE(sa[offset::min] == -3.0);
+      REQUIRE(sa[offset::max] == *std::max_element(all.begin(), all.end()));
+    }
+
+    THEN("the moments are those of all values and do not depend on the shift") {
+      Real mean = 0.0, var = 0.0, mu3 = 0.0;
+      for (const auto x : all)
+        mean += x / all.size();
+      for (const auto x : all) {
+        var += (x - mean) * (x - mean) / all.size();
+        mu3 += (x - mean) * (x - mean) * (x - mean) / all.size();
+      }
+      const auto moments = GetMoments(sall.data(), 100.0);
+      REQUIRE(moments.mean == Approx(mean));
+      REQUIRE(moments.stddev == Approx(std::sqrt(var)));
+      REQUIRE(moments.skewness == Approx(mu3 / std::pow(var, 1.5)));
+
+      Recenter(sall.data(), -100.0);
+      const auto unshifted = GetMoments(sall.data(), 0.0);
+      REQUIRE(unshifted.mean == Approx(moments.mean));
+      REQUIRE(unshifted.stddev == Approx(moments.stddev));
+      REQUIRE(unshifted.kurtosis == Approx(moments.kurtosis));
+    }
+
+    THEN("quantiles are within the relative accuracy of the sorted values") {
+      std::sort(all.begin(), all.end());
+      for (const Real q : {0.0, 0.01, 0.25, 0.5, 0.9, 0.99, 1.0}) {
+        const Real exact = all[static_cast<int>(q * (all.size() - 1))];
+        REQUIRE(std::abs(Quantile(sall.data(), layout, q) - exact) <=
+                0.01 * std::abs(exact) + 1.0e-12);
+      }
+    }
+  }
+}
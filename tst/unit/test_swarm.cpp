@@ -19,8 +19,10 @@
 
 #include <cmath>
 #include <iostream>
+#include <map>
 #include <random>
 #include <string>
+#include <vector>
 
 #include <catch2/catch.hpp>
 
@@ -31,6 +33,7 @@
 #include "interface/swarm_default_names.hpp"
 #include "kokkos_abstraction.hpp"
 #include "mesh/mesh.hpp"
+#include "outputs/output_utils.hpp"
 
 #include <parthenon/driver.hpp>
 #include <parthenon/package.hpp>
@@ -237,4 +240,91 @@ TEST_CASE("Swarm memory management", "[Swarm]") {
       });
   failures_h = failures_d.GetHostMirrorAndCopy();
   REQUIRE(failures_h(0) == 0);
+
+  // Shrink the pool to the remaining particles and grow it again
+  const int num_active = swarm->GetNumActive();
+  swarm->ShrinkPool(num_active);
+  REQUIRE(swarm->GetPoolMax() == num_active);
+  REQUIRE(swarm->GetNumActive() == num_active);
+  REQUIRE(swarm->GetMaxActiveIndex() == num_active - 1);
+  REQUIRE(swarm->GetPackingEfficiency() == 1.0);
+  swarm->ReservePool(1);
+  REQUIRE(swarm->GetPoolMax() == 2 * num_active);
+}
+
+TEST_CASE("Swarm output selection", "[Swarm]") {
+  std::stringstream is;
+  is << "<parthenon/mesh>" << endl;
+  is << "nx1 = 4" << endl;
+  is << "nx2 = 4" << endl;
+  is << "nx3 = 4" << endl;
+  is << "pack_size = 1" << endl;
+  auto pin = std::make_shared<ParameterInput>();
+  pin->LoadFromStream(is);
+  auto app_in = std::make_shared<ApplicationInput>();
+  Packages_t packages;
+  packages.Add(std::make_shared<parthenon::StateDescriptor>("test"));
+  auto meshblock = std::make_shared<MeshBlock>(1, 1);
+  auto mesh = std::make_shared<Mesh>(pin.get(), app_in.get(), packages, 1);
+  meshblock->loc = mesh->GetLocList()[0];
+  meshblock->pmy_mesh = mesh.get();
+
+  auto swarm = std::make_shared<Swarm>("test swarm", Metadata(), NUMINIT);
+  swarm->SetBlockPointer(meshblock);
+  swarm->Add("id", Metadata({Metadata::Integer, Metadata::Particle}));
+  swarm->AddEmptyParticles(NUMINIT);
+  auto x_d = swarm->Get<Real>(swarm_position::x::name()).Get();
+  auto id_d = swarm->Get<int>("id").Get();
+  meshblock->par_for(
+      "Set particles", 0, NUMINIT - 1, KOKKOS_LAMBDA(const int n) {
+        x_d(n) = 0.1 * n;
+        id_d(n) = n;
+      });
+
+  parthenon::OutputUtils::SwarmInfo info;
+  info.Add("id", swarm->GetP<int>("id"));
+  info.Add(swarm_position::x::name(), swarm->GetP<Real>(swarm_position::x::name()));
+
+  // Every third id, with x below 0.75
+  parthenon::SwarmSelection selection;
+  selection.subsample = 3;
+  selection.variable = swarm_position::x::name();
+  selection.max = 0.75;
+  info.AddOffsets(swarm, &selection);
+  info.global_offset = 0;
+  REQUIRE(info.counts[0] == 3);
+  REQUIRE(info.count_on_rank == 3);
+
+  std::map<std::string, std::size_t> var_offsets;
+  auto ids = info.FillHostBuffers<int>(var_offsets);
+  REQUIRE(ids == std::vector<int>{0, 3, 6});
+  auto xs = info.FillHostBuffers<Real>(var_offsets);
+  REQUIRE(xs.size() == 3);
+  REQUIRE(xs[2] == Approx(0.6));
+}
+
+TEST_CASE("Particle shape stencils", "[Swarm]") {
+  using parthenon::DepositionShape;
+  using parthenon::ParticleShapeStencil1D;
+  constexpr int base = 2;
+  for (const Real s : {0.5, 1.3, 2.75, 3.0}) {
+    for (const auto shape :
+         {DepositionShape::NGP, DepositionShape::CIC, DepositionShape::TSC}) {
+      int first;
+      Real w[3];
+      const int n = ParticleShapeStencil1D(shape, s, base, first, w);
+      Real sum = 0.0, mean = 0.0;
+      for (int c = 0; c < n; ++c) {
+        sum += w[c];
+        mean += w[c] * (first + c - base + 0.5);
+      }
+      REQUIRE(sum == Approx(1.0));
+      // CIC and TSC weights reproduce the position of the particle
+      if (shape != DepositionShape::NGP) REQUIRE(mean == Approx(s));
+      // The stencil always covers the cell of the particle
+      const int cell = static_cast<int>(std::floor(s)) + base;
+      REQUIRE(first <= cell);
+      REQUIRE(first + n - 1 >= cell);
+    }
+  }
 }
@@ -12,13 +12,16 @@
 //========================================================================================
 
 // STL Includes
+#include <atomic>
 #include <memory>
+#include <vector>
 
 // Third Party Includes
 #include <catch2/catch.hpp>
 
 // Internal Includes
 #include "basic_types.hpp"
+#include "kokkos_abstraction.hpp"
 #include "tasks/tasks.hpp"
 
 using parthenon::TaskID;
@@ -48,3 +51,220 @@ TEST_CASE("Task Object Lifecycle", "[TaskList][AddTask]") {
     REQUIRE(track_destruction.expired());
   }
 }
+
+TEST_CASE("Task execution time is reported to the cost function", "[TaskList][Cost]") {
+  GIVEN("A region with two task lists that have cost functions") {
+    using parthenon::TaskCollection;
+    using parthenon::TaskListStatus;
+    using parthenon::TaskRegion;
+    TaskCollection tc;
+    TaskRegion &region = tc.AddRegion(2);
+    std::vector<int> ncalls(2, 0);
+    std::vector<double> cost(2, 0.0);
+    for (int i = 0; i < 2; ++i) {
+      auto &tl = region[i];
+      auto t1 = tl.AddTask(TaskID{}, [] { return TaskStatus::complete; });
+      auto [sub, sub_id] = tl.AddSublist(t1, {1, 1});
+      sub.AddTask(parthenon::TaskQualifier::completion, TaskID{},
+                  [] { return TaskStatus::complete; });
+      tl.AddTask(sub_id, [] { return TaskStatus::complete; });
+      tl.SetCostFunction([&, i](double t) {
+        ncalls[i]++;
+        cost[i] += t;
+      });
+    }
+    THEN("Every user task, including those of sublists, is measured") {
+      REQUIRE(tc.Execute() == TaskListStatus::complete);
+      for (int i = 0; i < 2; ++i) {
+        REQUIRE(ncalls[i] == 3);
+        REQUIRE(cost[i] >= 0.0);
+      }
+    }
+  }
+}
+
+TEST_CASE("Task regions run on a work stealing pool", "[TaskList][WorkStealingPool]") {
+  GIVEN("A region with many lists of dependent and repeating tasks") {
+    using parthenon::TaskCollection;
+    using parthenon::TaskListStatus;
+    using parthenon::TaskRegion;
+    constexpr int nlists = 64;
+    constexpr int nretries = 3;
+    TaskCollection tc;
+    TaskRegion &region = tc.AddRegion(nlists);
+    std::atomic<int> nfirst{0}, nsecond{0}, nthird{0};
+    std::vector<int> tries(nlists, 0);
+    for (int i = 0; i < nlists; ++i) {
+      auto &tl = region[i];
+      auto t1 = tl.AddTask(TaskID{}, [&] {
+        nfirst++;
+        return TaskStatus::complete;
+      });
+      // Returns incomplete a few times, like a task polling for communication
+      auto t2 = tl.AddTask(TaskID{}, [&, i] {
+        if (++tries[i] < nretries) return TaskStatus::incomplete;
+        nsecond++;
+        return TaskStatus::complete;
+      });
+      tl.AddTask(t1 | t2, [&] {
+        nthird++;
+        return TaskStatus::complete;
+      });
+    }
+    THEN("Every task runs exactly once to completion") {
+      parthenon::WorkStealingPool pool(4);
+      REQUIRE(pool.size() == 4);
+      REQUIRE(tc.Execute(pool) == TaskListStatus::complete);
+      REQUIRE(nfirst == nlists);
+      REQUIRE(nsecond == nlists);
+      REQUIRE(nthird == nlists);
+      for (int i = 0; i < nlists; ++i)
+        REQUIRE(tries[i] == nretries);
+    }
+  }
+}
+
+TEST_CASE("A compiled task collection can be executed repeatedly", "[TaskList][Compile]") {
+  GIVEN("A region with synchronized lists and iterating sublists") {
+    using parthenon::TaskCollection;
+    using parthenon::TaskListStatus;
+    using parthenon::TaskQualifier;
+    using parthenon::TaskRegion;
+    constexpr int nlists = 4;
+    constexpr int niters = 3;
+    TaskCollection tc;
+    TaskRegion &region = tc.AddRegion(nlists);
+    std::atomic<int> nfirst{0}, nsync{0}, niterations{0}, nlast{0};
+    std::atomic<bool> out_of_order{false};
+    for (int i = 0; i < nlists; ++i) {
+      auto &tl = region[i];
+      auto t1 = tl.AddTask(TaskID{}, [&] {
+        nfirst++;
+        return TaskStatus::complete;
+      });
+      auto t2 = tl.AddTask(TaskQualifier::local_sync, t1, [&] {
+        nsync++;
+        return TaskStatus::complete;
+      });
+      auto [sub, sub_id] = tl.AddSublist(t2, {niters, niters});
+      sub.AddTask(TaskQualifier::completion, TaskID{}, [&] {
+        // every list has to be done with the synchronized task before any list gets here
+        if (nsync % nlists != 0) out_of_order = true;
+        niterations++;
+        return TaskStatus::complete;
+      });
+      tl.AddTask(sub_id, [&] {
+        nlast++;
+        return TaskStatus::complete;
+      });
+    }
+    tc.Compile();
+    THEN("Every execution runs every task the same number of times") {
+      constexpr int nexec = 3;
+      parthenon::WorkStealingPool pool(2);
+      for (int n = 1; n <= nexec; ++n) {
+        REQUIRE(tc.Execute() == TaskListStatus::complete);
+        REQUIRE(tc.Execute(pool) == TaskListStatus::complete);
+        REQUIRE(nfirst == 2 * n * nlists);
+        REQUIRE(nsync == 2 * n * nlists);
+        REQUIRE(niterations == 2 * n * nlists * niters);
+        REQUIRE(nlast == 2 * n * nlists);
+      }
+      REQUIRE(!out_of_order);
+    }
+  }
+}
+
+TEST_CASE("Ready tasks run in the order of their priorities", "[TaskList][Priority]") {
+  GIVEN("A list with independent tasks, a high priority one, and a long chain") {
+    using parthenon::TaskCollection;
+    using parthenon::TaskListStatus;
+    using parthenon::TaskQualifier;
+    using parthenon::TaskRegion;
+    TaskCollection tc;
+    TaskRegion &region = tc.AddRegion(1);
+    auto &tl = region[0];
+    std::vector<int> order;
+    auto record = [&order](const int n) {
+      order.push_back(n);
+      return TaskStatus::complete;
+    };
+    tl.AddTask(TaskID{}, record, 0);
+    tl.AddTask(TaskID{}, record, 1);
+    // heads a chain of three tasks
+    auto chain = tl.AddTask(TaskID{}, record, 2);
+    chain = tl.AddTask(chain, record, 3);
+    tl.AddTask(chain, record, 4);
+    tl.AddTask(TaskQualifier::high_priority, TaskID{}, record, 5);
+    THEN("The high priority task runs first, then the chain as long as it is longest") {
+      parthenon::ThreadPool pool(1);
+      REQUIRE(tc.Execute(pool) == TaskListStatus::complete);
+      REQUIRE(order == std::vector<int>{5, 2, 3, 0, 1, 4});
+    }
+  }
+}
+
+TEST_CASE("Tasks that keep returning incomplete back off", "[TaskList][TaskWait]") {
+  GIVEN("A task polling for 10 ms") {
+    using parthenon::TaskCollection;
+    using parthenon::TaskListStatus;
+    using parthenon::TaskRegion;
+    using parthenon::TaskWait;
+    TaskCollection tc;
+    TaskRegion &region = tc.AddRegion(1);
+    int ncalls = 0;
+    const double end = TaskWait::Now() + 1.0e-2;
+    region[0].AddTask(TaskID{}, [&ncalls, end] {
+      ++ncalls;
+      return TaskWait::Now() < end ? TaskStatus::incomplete : TaskStatus::complete;
+    });
+    THEN("It is run about once per maximum backoff instead of continuously") {
+      parthenon::ThreadPool pool(1);
+      REQUIRE(tc.Execute(pool) == TaskListStatus::complete);
+      REQUIRE(ncalls > 1);
+      REQUIRE(ncalls < 2.0e-2 / TaskWait::max_backoff);
+    }
+  }
+}
+
+TEST_CASE("Tasks can leave device work running for their dependents",
+          "[TaskList][TaskLaunch]") {
+  GIVEN("A kernel, a stream ordered kernel depending on it, and a task on the host") {
+    using parthenon::DevExecSpace;
+    using parthenon::TaskCollection;
+    using parthenon::TaskLaunch;
+    using parthenon::TaskListStatus;
+    using parthenon::TaskQualifier;
+    using parthenon::TaskRegion;
+    constexpr int n = 1000;
+    parthenon::ParArray1D<int> data("data", n);
+    TaskCollection tc;
+    TaskRegion &region = tc.AddRegion(1);
+    auto &tl = region[0];
+    const DevExecSpace space;
+    auto fill = tl.AddTask(TaskID{}, [=]() {
+      Kokkos::parallel_for(
+          Kokkos::RangePolicy<DevExecSpace>(space, 0, n),
+          KOKKOS_LAMBDA(const int i) { data(i) = i; });
+      return TaskLaunch::Launched(space);
+    });
+    auto add = tl.AddTask(TaskQualifier::stream_ordered, fill, [=]() {
+      Kokkos::parallel_for(
+          Kokkos::RangePolicy<DevExecSpace>(space, 0, n),
+          KOKKOS_LAMBDA(const int i) { data(i) += 1; });
+      return TaskLaunch::Launched(space);
+    });
+    int nwrong = -1;
+    tl.AddTask(add, [=, &nwrong]() {
+      auto data_h = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), data);
+      nwrong = 0;
+      for (int i = 0; i < n; ++i)
+        nwrong += data_h(i) != i + 1;
+      return TaskStatus::complete;
+    });
+    THEN("The task on the host sees the results of both kernels") {
+      REQUIRE(tc.Execute() == TaskListStatus::complete);
+      REQUIRE(nwrong == 0);
+    }
+  }
+}
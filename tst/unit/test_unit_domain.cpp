@@ -17,6 +17,7 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
 
 #include "mesh/domain.hpp"
 
@@ -455,3 +456,61 @@ TEST_CASE("Checking IndexShape cell counts", "[IndexShape]") {
     REQUIRE(shape.ncellsk(entire) == 1);
   }
 }
+
+TEST_CASE("Splitting an IndexShape into core and rim regions", "[IndexShape]") {
+  using parthenon::IndexRegion;
+  using parthenon::TopologicalElement;
+  const auto interior = parthenon::IndexDomain::interior;
+  GIVEN("A 3D Index Shape") {
+    const int nx3 = 6, nx2 = 8, nx1 = 10, num_ghost = 2;
+    parthenon::IndexShape shape(nx3, nx2, nx1, num_ghost);
+    for (auto el : {TopologicalElement::CC, TopologicalElement::F1}) {
+      const auto core = shape.GetCoreRegion(interior, num_ghost, el);
+      const auto rim = shape.GetRimRegions(interior, num_ghost, el);
+      THEN("The core is shrunk by the depth in every direction") {
+        REQUIRE(core.ib.s == shape.is(interior, el) + num_ghost);
+        REQUIRE(core.ib.e == shape.ie(interior, el) - num_ghost);
+        REQUIRE(core.jb.s == shape.js(interior, el) + num_ghost);
+        REQUIRE(core.kb.e == shape.ke(interior, el) - num_ghost);
+      }
+      THEN("Core and rim cover the interior exactly once") {
+        const int ni = shape.ncellsi(parthenon::IndexDomain::entire, el);
+        const int nj = shape.ncellsj(parthenon::IndexDomain::entire, el);
+        const int nk = shape.ncellsk(parthenon::IndexDomain::entire, el);
+        std::vector<int> count(ni * nj * nk, 0);
+        auto mark = [&](const IndexRegion &r) {
+          for (int k = r.kb.s; k <= r.kb.e; ++k)
+            for (int j = r.jb.s; j <= r.jb.e; ++j)
+              for (int i = r.ib.s; i <= r.ib.e; ++i)
+                count[i + ni * (j + nj * k)]++;
+        };
+        mark(core);
+        for (auto &r : rim)
+          mark(r);
+        REQUIRE(rim.size() == 6);
+        int total = 0;
+        for (int c : count) {
+          REQUIRE(c <= 1);
+          total += c;
+        }
+        REQUIRE(total == shape.GetTotal(interior, el));
+      }
+    }
+  }
+
+  GIVEN("A 2D Index Shape that is too small to have a core") {
+    parthenon::IndexShape shape(3, 8, 2);
+    const auto core = shape.GetCoreRegion(interior, 2);
+    const auto rim = shape.GetRimRegions(interior, 2);
+    THEN("The core is empty and the rim is the whole interior") {
+      REQUIRE(core.jb.e == core.jb.s - 1);
+      REQUIRE(core.kb.s == 0);
+      REQUIRE(core.kb.e == 0);
+      REQUIRE(rim.size() == 1);
+      REQUIRE(rim[0].ib.s == shape.is(interior));
+      REQUIRE(rim[0].ib.e == shape.ie(interior));
+      REQUIRE(rim[0].jb.s == shape.js(interior));
+      REQUIRE(rim[0].jb.e == shape.je(interior));
+    }
+  }
+}
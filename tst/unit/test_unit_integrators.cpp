@@ -15,6 +15,7 @@
 // the public, perform publicly and display publicly, and to permit others to do so.
 //========================================================================================
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <cmath>
@@ -30,6 +31,7 @@
 #include "time_integration/staged_integrator.hpp"
 
 using parthenon::ButcherIntegrator;
+using parthenon::ImexIntegrator;
 using parthenon::LowStorageIntegrator;
 using parthenon::ParameterInput;
 using parthenon::Real;
@@ -120,6 +122,90 @@ void StepButcher(const ButcherIntegrator &integrator, Real dt, State_t &u) {
   }
 }
 
+// Same as StepButcher, but with the right-hand sides stored in the registers given by
+// ButcherIntegrator::rhs_register and the final state accumulated on the fly, as done
+// by Update::ButcherRegisterStage
+void StepButcherRegisters(const ButcherIntegrator &integrator, Real dt, State_t &u) {
+  const int nstages = integrator.nstages;
+  std::vector<State_t> registers(integrator.nrhs_registers);
+  const State_t base = u;
+  State_t acc = base;
+  State_t scratch = base;
+  for (int stage = 0; stage < nstages; ++stage) {
+    State_t rhs;
+    GetRHS(scratch, rhs);
+    for (int v = 0; v < NVARS; ++v) {
+      acc[v] += dt * integrator.b[stage] * rhs[v];
+    }
+    if (stage == nstages - 1) break;
+    registers[integrator.rhs_register[stage]] = rhs;
+    for (int v = 0; v < NVARS; ++v) {
+      scratch[v] = base[v];
+      for (int prev = 0; prev <= stage; ++prev) {
+        if (integrator.a[stage + 1][prev] == 0.0) continue;
+        scratch[v] += dt * integrator.a[stage + 1][prev] *
+                      registers[integrator.rhs_register[prev]][v];
+      }
+    }
+  }
+  u = acc;
+}
+
+// Step with an embedded tableau, returning the normalized error estimate as computed
+// by Update::ButcherErrorEstimate
+Real StepButcherEmbedded(const ButcherIntegrator &integrator, Real dt, State_t &u) {
+  State_t u0 = u;
+  std::vector<State_t> K(integrator.nstages);
+  for (int stage = 0; stage < integrator.nstages; ++stage) {
+    State_t scratch = u0;
+    for (int prev = 0; prev < stage; ++prev) {
+      for (int v = 0; v < NVARS; ++v) {
+        scratch[v] += dt * integrator.a[stage][prev] * K[prev][v];
+      }
+    }
+    GetRHS(scratch, K[stage]);
+  }
+  Real error = 0;
+  for (int v = 0; v < NVARS; ++v) {
+    Real err = 0;
+    for (int stage = 0; stage < integrator.nstages; ++stage) {
+      u[v] += dt * integrator.b[stage] * K[stage][v];
+      err += dt * (integrator.b[stage] - integrator.b_embedded[stage]) * K[stage][v];
+    }
+    const Real scale =
+        integrator.atol + integrator.rtol * std::max(std::abs(u0[v]), std::abs(u[v]));
+    error = std::max(error, std::abs(err) / scale);
+  }
+  return error;
+}
+
+// IMEX step with the explicit right-hand side E(u) = (v, 0) and the implicit one
+// I(u) = (0, -k^2 u), so that the implicit solve of a stage is local
+void StepImex(const ImexIntegrator &integrator, Real dt, State_t &u) {
+  const int nstages = integrator.nstages;
+  std::vector<State_t> E(nstages), I(nstages);
+  for (int stage = 0; stage < nstages; ++stage) {
+    State_t rhs = u;
+    for (int prev = 0; prev < stage; ++prev) {
+      for (int v = 0; v < NVARS; ++v) {
+        rhs[v] += dt * (integrator.a_ex[stage][prev] * E[prev][v] +
+                        integrator.a_im[stage][prev] * I[prev][v]);
+      }
+    }
+    // (u, v) - gamma dt (0, -k^2 u) = rhs
+    const Real gamma_dt = dt * integrator.a_im[stage][stage];
+    State_t us{rhs[0], rhs[1] - gamma_dt * K * K * rhs[0]};
+    E[stage] = {us[1], 0};
+    I[stage] = {0, -K * K * us[0]};
+  }
+  for (int stage = 0; stage < nstages; ++stage) {
+    for (int v = 0; v < NVARS; ++v) {
+      u[v] += dt * (integrator.b_ex[stage] * E[stage][v] +
+                    integrator.b_im[stage] * I[stage][v]);
+    }
+  }
+}
+
 template <typename Integrator, typename Stepper>
 void Integrate(const Integrator &integrator, const Stepper &step, const Real tf, Real dt,
                State_t &u0) {
@@ -248,3 +334,122 @@ TEST_CASE("Low storage integrator", "[StagedIntegrator]") {
     }
   }
 }
+
+TEST_CASE("Integrator registers", "[StagedIntegrator]") {
+  GIVEN("A low storage integrator") {
+    auto integrator = MakeIntegrator<LowStorageIntegrator>("rk3");
+    THEN("All intermediate stages share a single register") {
+      REQUIRE(integrator.register_name ==
+              std::vector<std::string>{"base", "1", "1", "base"});
+    }
+  }
+  GIVEN("The classical rk4 tableau") {
+    auto integrator = MakeIntegrator<ButcherIntegrator>("rk4");
+    THEN("A single right-hand side register is needed") {
+      REQUIRE(integrator.nrhs_registers == 1);
+    }
+  }
+  GIVEN("A state with an initial condition") {
+    Real tf = 1.15;
+    for (const std::string name : {"rk1", "rk2", "rk4", "rk10"}) {
+      WHEN("We integrate with butcher " + name + " using registers") {
+        constexpr Real dt = 1e-2;
+        auto integrator = MakeIntegrator<ButcherIntegrator>(name);
+        REQUIRE(integrator.nrhs_registers <= integrator.nstages);
+        State_t u, ureg;
+        GetInitialData(u);
+        GetInitialData(ureg);
+        Integrate(integrator, StepButcher, tf, dt, u);
+        Integrate(integrator, StepButcherRegisters, tf, dt, ureg);
+        THEN("The result matches the integration that stores all stages") {
+          REQUIRE(std::abs(u[0] - ureg[0]) <= 1e-10 * std::abs(u[0]) + 1e-12);
+          REQUIRE(std::abs(u[1] - ureg[1]) <= 1e-10 * std::abs(u[1]) + 1e-12);
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("Embedded Butcher integrators", "[StagedIntegrator]") {
+  GIVEN("A state with an initial condition") {
+    Real tf = 1.15;
+    State_t ufinal;
+    GetTrueSolution(tf, ufinal);
+    for (const std::string name : {"bs3", "ck45", "dp45"}) {
+      auto integrator = MakeIntegrator<ButcherIntegrator>(name);
+      REQUIRE(integrator.IsEmbedded());
+      WHEN("We integrate with a fixed step with butcher " + name) {
+        constexpr Real dt = 1e-3;
+        State_t u;
+        GetInitialData(u);
+        Integrate(integrator, StepButcher, tf, dt, u);
+        THEN("The final state doesn't differ too much from the true solution") {
+          REQUIRE(std::abs(u[0] - ufinal[0]) <= 1e-6);
+          REQUIRE(std::abs(u[1] - ufinal[1]) <= 1e-6);
+        }
+      }
+      WHEN("We integrate with error control with butcher " + name) {
+        State_t u;
+        GetInitialData(u);
+        Real t = 0, dt = 1e-1;
+        int naccepted = 0, nrejected = 0;
+        while (t < tf) {
+          dt = std::min(dt, tf - t);
+          State_t unew = u;
+          integrator.error = StepButcherEmbedded(integrator, dt, unew);
+          const Real dt_new = integrator.ErrorControlledDt(dt);
+          if (integrator.StepAccepted()) {
+            u = unew;
+            t += dt;
+            naccepted++;
+          } else {
+            nrejected++;
+          }
+          REQUIRE(dt_new <= integrator.max_growth * dt);
+          REQUIRE(dt_new >= integrator.min_shrink * dt);
+          dt = dt_new;
+        }
+        THEN("The error is controlled with a moderate number of steps") {
+          REQUIRE(std::abs(u[0] - ufinal[0]) <= 1e-3);
+          REQUIRE(std::abs(u[1] - ufinal[1]) <= 1e-2);
+          REQUIRE(naccepted < 2000);
+          REQUIRE(nrejected < naccepted);
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("IMEX integrators", "[StagedIntegrator]") {
+  GIVEN("A state with an initial condition") {
+    Real tf = 1.15;
+    State_t ufinal;
+    GetTrueSolution(tf, ufinal);
+    for (const std::string name : {"ars222", "ars443", "ssp2_222"}) {
+      auto integrator = MakeIntegrator<ImexIntegrator>(name);
+      WHEN("We integrate with imex " + name) {
+        constexpr Real dt = 1e-3;
+        State_t u;
+        GetInitialData(u);
+        Integrate(integrator, StepImex, tf, dt, u);
+        THEN("The final state doesn't differ too much from the true solution") {
+          REQUIRE(std::abs(u[0] - ufinal[0]) <= 1e-4);
+          REQUIRE(std::abs(u[1] - ufinal[1]) <= 1e-4);
+        }
+      }
+      WHEN("We check the implicit stages of imex " + name) {
+        integrator.dt = 0.1;
+        THEN("All implicit stages share their operator") {
+          bool first = true;
+          for (int stage = 0; stage < integrator.nstages; ++stage) {
+            if (!integrator.IsImplicitStage(stage)) continue;
+            REQUIRE(integrator.ImplicitOperatorChanged(stage) == first);
+            first = false;
+          }
+          integrator.dt = 0.2;
+          REQUIRE(integrator.ImplicitOperatorChanged(integrator.nstages - 1));
+        }
+      }
+    }
+  }
+}
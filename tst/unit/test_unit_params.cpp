@@ -107,6 +107,40 @@ TEST_CASE("Add, Get, and Update are called", "[Add,Get,Update]") {
   }
 }
 
+TEST_CASE("Handles to params", "[Handle]") {
+  GIVEN("A mutable param and a handle to it") {
+    Params params;
+    params.Add("key", 1.0, true);
+    auto handle = params.GetHandle<double>("key");
+    REQUIRE(handle.IsValid());
+    REQUIRE(*handle == Approx(1.0));
+    WHEN("the param is updated") {
+      params.Update<double>("key", 3.0);
+      THEN("the handle sees the new value") { REQUIRE(handle.Get() == Approx(3.0)); }
+    }
+    WHEN("a handle with the wrong type is requested") {
+      THEN("an error is thrown") {
+        REQUIRE_THROWS_AS(params.GetHandle<int>("key"), std::runtime_error);
+      }
+    }
+    WHEN("a device copy is requested") {
+      auto device = params.GetDeviceHandle<double>("key");
+      Real result;
+      auto read = [&]() {
+        Kokkos::parallel_reduce(
+            "read device param", Kokkos::RangePolicy<>(parthenon::DevExecSpace(), 0, 1),
+            KOKKOS_LAMBDA(const int, Real &sum) { sum += device(); }, result);
+        return result;
+      };
+      THEN("kernels read the value and see updates") {
+        REQUIRE(read() == Approx(1.0));
+        params.Update<double>("key", 5.0);
+        REQUIRE(read() == Approx(5.0));
+      }
+    }
+  }
+}
+
 TEST_CASE("reset is called", "[reset]") {
   GIVEN("A key is added") {
     Params params;
@@ -44,8 +44,6 @@ struct KeyComparator {
 };
 
 TEST_CASE("Sorting", "[sort]") {
-// No sort support on HIP at the moment
-#if !defined(KOKKOS_ENABLE_HIP)
   GIVEN("An unordered list of integers") {
     ParArray1D<int> data("Data to sort", N);
 
@@ -93,5 +91,29 @@ TEST_CASE("Sorting", "[sort]") {
     REQUIRE(data_h(3).value_ == 4);
     REQUIRE(data_h(4).value_ == 5);
   }
-#endif // !defined(KOKKOS_ENABLE_HIP)
+
+  GIVEN("Keys with duplicates and a list of values") {
+    ParArray1D<int> keys("Keys to sort", N);
+    ParArray1D<int> values("Values to sort", N);
+
+    parthenon::par_for(
+        parthenon::loop_pattern_flatrange_tag, "initial data", parthenon::DevExecSpace(),
+        0, N - 1, KOKKOS_LAMBDA(const int n) {
+          keys(n) = (7 * n) % 10;
+          values(n) = n;
+        });
+
+    parthenon::sort_by_key(keys, values);
+
+    auto keys_h = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), keys);
+    auto values_h = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), values);
+
+    THEN("the keys are sorted and the values are permuted stably with them") {
+      for (int n = 0; n < N; n++) {
+        REQUIRE(keys_h(n) == n / (N / 10));
+        REQUIRE((7 * values_h(n)) % 10 == keys_h(n));
+        if (n > 0 && keys_h(n) == keys_h(n - 1)) REQUIRE(values_h(n) > values_h(n - 1));
+      }
+    }
+  }
 }
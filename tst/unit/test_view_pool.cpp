@@ -0,0 +1,70 @@
+//========================================================================================
+// (C) (or copyright) 2024. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <catch2/catch.hpp>
+
+#include "basic_types.hpp"
+#include "kokkos_abstraction.hpp"
+#include "utils/view_pool.hpp"
+
+using parthenon::DevExecSpace;
+using parthenon::Real;
+
+TEST_CASE("Recycling views with a ViewPool", "[ViewPool]") {
+  using view_t = Kokkos::View<Real **, parthenon::DevMemSpace>;
+  parthenon::ViewPool<view_t> pool;
+
+  GIVEN("A view taken from the pool and filled with data") {
+    auto v = pool.Get("v", 4, 8);
+    Kokkos::deep_copy(v, 1.0);
+    auto *ptr = v.data();
+    REQUIRE(pool.GetStatistics().misses == 1);
+
+    WHEN("It is released") {
+      pool.Release(v);
+      REQUIRE(!v.is_allocated());
+      REQUIRE(pool.GetStatistics().cached_views == 1);
+      THEN("The next view with the same extents reuses its zeroed storage") {
+        auto w = pool.Get("w", 4, 8);
+        REQUIRE(w.data() == ptr);
+        REQUIRE(pool.GetStatistics().hits == 1);
+        REQUIRE(pool.GetStatistics().cached_views == 0);
+        Real sum = 0.0;
+        Kokkos::parallel_reduce(
+            Kokkos::RangePolicy<>(DevExecSpace(), 0, 32),
+            KOKKOS_LAMBDA(const int n, Real &lsum) { lsum += w(n / 8, n % 8); }, sum);
+        REQUIRE(sum == 0.0);
+      }
+      THEN("A view with different extents is newly allocated") {
+        auto w = pool.Get("w", 8, 4);
+        REQUIRE(pool.GetStatistics().misses == 2);
+        REQUIRE(pool.GetStatistics().cached_views == 1);
+      }
+    }
+
+    WHEN("It is released while another copy is still alive") {
+      auto copy = v;
+      pool.Release(v);
+      THEN("It is not recycled") {
+        REQUIRE(pool.GetStatistics().cached_views == 0);
+        REQUIRE(copy.data() == ptr);
+      }
+    }
+
+    WHEN("The pool is not allowed to hold any memory") {
+      pool.SetMaxBytes(0);
+      pool.Release(v);
+      THEN("Nothing is recycled") { REQUIRE(pool.GetStatistics().cached_views == 0); }
+    }
+  }
+}